@@ -1347,6 +1347,36 @@ LLPolyMesh* LLAvatarAppearance::getUpperBodyMesh()
     return mMeshLOD[MESH_ID_UPPER_BODY]->mMeshParts[0]->getMesh();
 }
 
+//-----------------------------------------------------------------------------
+// LLAvatarAppearance::beginVisualParamsUpdate()
+// Morph targets applied until endVisualParamsUpdate() only accumulate their
+// deltas; each mesh rebuilds its normals once at the end.
+//-----------------------------------------------------------------------------
+void LLAvatarAppearance::beginVisualParamsUpdate()
+{
+    for (polymesh_map_t::value_type& mesh_pair : mPolyMeshes)
+    {
+        if (!mesh_pair.second->isLOD())
+        {
+            mesh_pair.second->beginMorphBatch();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// LLAvatarAppearance::endVisualParamsUpdate()
+//-----------------------------------------------------------------------------
+void LLAvatarAppearance::endVisualParamsUpdate()
+{
+    for (polymesh_map_t::value_type& mesh_pair : mPolyMeshes)
+    {
+        if (!mesh_pair.second->isLOD())
+        {
+            mesh_pair.second->endMorphBatch();
+        }
+    }
+}
+
 
 
 // virtual
@@ -99,6 +99,8 @@ public:
     /*virtual*/ S32             getCollisionVolumeID(std::string &name);
     /*virtual*/ LLPolyMesh*     getHeadMesh();
     /*virtual*/ LLPolyMesh*     getUpperBodyMesh();
+    /*virtual*/ void            beginVisualParamsUpdate();
+    /*virtual*/ void            endVisualParamsUpdate();
 
 /**                    Inherited
  **                                                                            **
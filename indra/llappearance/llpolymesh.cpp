@@ -759,6 +759,10 @@ LLPolyMesh::LLPolyMesh(LLPolyMeshSharedData *shared_data, LLPolyMesh *reference_
     mAvatarp = NULL;
     mVertexData = NULL;
 
+    mMorphBatchDepth = 0;
+    mMorphedBegin = 0;
+    mMorphedEnd = 0;
+
     mCurVertexCount = 0;
     mFaceIndexCount = 0;
     mFaceIndexOffset = 0;
@@ -1007,6 +1011,133 @@ LLPolyMorphData*        LLPolyMesh::getMorphData(const std::string& morph_name)
         return NULL;
 }
 
+//-----------------------------------------------------------------------------
+// getMorphDataList()
+//-----------------------------------------------------------------------------
+std::vector<LLPolyMorphData*> LLPolyMesh::getMorphDataList()
+{
+        std::vector<LLPolyMorphData*> morph_list;
+        if (mSharedData)
+        {
+                morph_list.assign(mSharedData->mMorphData.begin(), mSharedData->mMorphData.end());
+        }
+        return morph_list;
+}
+
+//-----------------------------------------------------------------------------
+// applyMorph()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::applyMorph(const LLPolyMorphData* morph_data, F32 delta_weight, const F32* mask_weights, bool clothing_morph)
+{
+    llassert(!isLOD());
+
+    const U32 num_indices = morph_data->mNumIndices;
+    if (!num_indices)
+    {
+        return;
+    }
+
+    LLVector4a* clothing_weights = clothing_morph ? mClothingWeights : NULL;
+    const bool batching = isMorphBatching();
+
+    for (U32 vert_index_morph = 0; vert_index_morph < num_indices; vert_index_morph++)
+    {
+        U32 vert_index_mesh = morph_data->mVertexIndices[vert_index_morph];
+
+        F32 mask_weight = mask_weights ? mask_weights[vert_index_morph] : 1.f;
+        F32 weight = delta_weight * mask_weight;
+
+        LLVector4a pos = morph_data->mCoords[vert_index_morph];
+        pos.mul(weight);
+        mCoords[vert_index_mesh].add(pos);
+
+        if (clothing_weights)
+        {
+            LLVector4a* clothing_weight = &clothing_weights[vert_index_mesh];
+            clothing_weight->add(pos);
+            clothing_weight->getF32ptr()[VW] = mask_weight;
+        }
+
+        LLVector4a norm = morph_data->mNormals[vert_index_morph];
+        norm.mul(weight * NORMAL_SOFTEN_FACTOR);
+        mScaledNormals[vert_index_mesh].add(norm);
+
+        LLVector4a binorm = morph_data->mBinormals[vert_index_morph];
+
+        // guard against degenerate input data before we create NaNs below!
+        //
+        if (!binorm.isFinite3() || (binorm.dot3(binorm).getF32() <= F_APPROXIMATELY_ZERO))
+        {
+            binorm.set(1,0,0,1);
+        }
+
+        binorm.mul(weight * NORMAL_SOFTEN_FACTOR);
+        mScaledBinormals[vert_index_mesh].add(binorm);
+
+        mTexCoords[vert_index_mesh] += morph_data->mTexCoords[vert_index_morph] * delta_weight * mask_weight;
+
+        if (batching)
+        {
+            mMorphedVertices[vert_index_mesh] = 1;
+        }
+        else
+        {
+            // calculate new normals based on half angles
+            updateMorphedNormals(vert_index_mesh);
+        }
+    }
+
+    if (batching)
+    {
+        // morph vertices are sorted by mesh vertex, see LLPolyMorphData::loadBinary()
+        mMorphedBegin = llmin(mMorphedBegin, morph_data->mVertexIndices[0]);
+        mMorphedEnd = llmax(mMorphedEnd, morph_data->mVertexIndices[num_indices - 1] + 1);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// beginMorphBatch()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::beginMorphBatch()
+{
+    llassert(!isLOD());
+
+    if (mMorphBatchDepth++ == 0)
+    {
+        // flags are cleared again as endMorphBatch() consumes them
+        mMorphedVertices.resize(mSharedData->mNumVertices, 0);
+        mMorphedBegin = mSharedData->mNumVertices;
+        mMorphedEnd = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// endMorphBatch()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::endMorphBatch()
+{
+    llassert(mMorphBatchDepth > 0);
+
+    if (--mMorphBatchDepth > 0)
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED;
+
+    U8* morphed = mMorphedVertices.data();
+    for (U32 vert = mMorphedBegin; vert < mMorphedEnd; vert++)
+    {
+        if (morphed[vert])
+        {
+            morphed[vert] = 0;
+            updateMorphedNormals(vert);
+        }
+    }
+    mMorphedBegin = 0;
+    mMorphedEnd = 0;
+}
+
 //-----------------------------------------------------------------------------
 // removeMorphData()
 //-----------------------------------------------------------------------------
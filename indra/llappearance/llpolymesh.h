@@ -29,6 +29,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include "llstl.h"
 
 #include "v3math.h"
@@ -307,6 +308,8 @@ public:
     }
 
     LLPolyMorphData*    getMorphData(const std::string& morph_name);
+    // all morph targets loaded for this mesh
+    std::vector<LLPolyMorphData*> getMorphDataList();
 //  void    removeMorphData(LLPolyMorphData *morph_target);
 //  void    deleteAllMorphData();
 
@@ -318,6 +321,20 @@ public:
 
     bool    isLOD() { return mSharedData && mSharedData->isLOD(); }
 
+    //--------------------------------------------------------------------
+    // Morphing
+    //--------------------------------------------------------------------
+    // Adds delta_weight of a morph target to the deformed vertices.
+    // mask_weights, if given, scales the delta per morph vertex.
+    void    applyMorph(const LLPolyMorphData* morph_data, F32 delta_weight, const F32* mask_weights, bool clothing_morph);
+
+    // Between beginMorphBatch() and endMorphBatch() applyMorph() only
+    // accumulates deltas; the output normals and binormals of the vertices
+    // it touched are rebuilt once, by the outermost endMorphBatch().
+    void    beginMorphBatch();
+    void    endMorphBatch();
+    bool    isMorphBatching() const { return mMorphBatchDepth > 0; }
+
     void setAvatar(LLAvatarAppearance* avatarp) { mAvatarp = avatarp; }
     LLAvatarAppearance* getAvatar() { return mAvatarp; }
 
@@ -331,6 +348,21 @@ public:
 private:
     void initializeForMorph();
 
+    // rebuilds the output normal and binormal of a vertex from its
+    // deformed ones
+    void updateMorphedNormals(U32 vert)
+    {
+        LLVector4a norm = mScaledNormals[vert];
+        norm.normalize3fast();
+        mNormals[vert] = norm;
+
+        LLVector4a tangent;
+        tangent.setCross3(mScaledBinormals[vert], norm);
+        LLVector4a& normalized_binormal = mBinormals[vert];
+        normalized_binormal.setCross3(norm, tangent);
+        normalized_binormal.normalize3fast();
+    }
+
     // Dumps diagnostic information about the global mesh table
     static void dumpDiagInfo();
 
@@ -356,6 +388,13 @@ protected:
 
     LLPolyMesh              *mReferenceMesh;
 
+    // morph batch nesting depth, and the vertices touched by the batch:
+    // a flag per vertex and the range holding the flagged ones
+    S32                     mMorphBatchDepth;
+    std::vector<U8>         mMorphedVertices;
+    U32                     mMorphedBegin;
+    U32                     mMorphedEnd;
+
     // global mesh list
     typedef std::map<std::string, LLPolyMeshSharedData*> LLPolyMeshSharedDataTable;
     static LLPolyMeshSharedDataTable sGlobalSharedMeshList;
@@ -39,7 +39,8 @@
 
 //#include "../tools/imdebug/imdebug.h"
 
-const F32 NORMAL_SOFTEN_FACTOR = 0.65f;
+#include <algorithm>
+#include <numeric>
 
 //-----------------------------------------------------------------------------
 // LLPolyMorphData()
@@ -213,9 +214,54 @@ bool LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
     mAvgDistortion.mul(1.f/(F32)mNumIndices);
     mAvgDistortion.normalize3fast();
 
+    sortByVertexIndex();
+
     return true;
 }
 
+//-----------------------------------------------------------------------------
+// sortByVertexIndex()
+// Orders the morph vertices by mesh vertex so that applying the morph walks
+// the mesh arrays forward.  Vertices listed more than once keep their order.
+//-----------------------------------------------------------------------------
+void LLPolyMorphData::sortByVertexIndex()
+{
+    if (std::is_sorted(mVertexIndices, mVertexIndices + mNumIndices))
+    {
+        return;
+    }
+
+    std::vector<U32> order(mNumIndices);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [this](U32 a, U32 b) { return mVertexIndices[a] < mVertexIndices[b]; });
+
+    U32 size = sizeof(LLVector4a)*mNumIndices;
+
+    LLVector4a* coords = static_cast<LLVector4a*>(ll_aligned_malloc_16(size));
+    LLVector4a* normals = static_cast<LLVector4a*>(ll_aligned_malloc_16(size));
+    LLVector4a* binormals = static_cast<LLVector4a*>(ll_aligned_malloc_16(size));
+    LLVector2* tex_coords = new LLVector2[mNumIndices];
+    U32* vertex_indices = new U32[mNumIndices];
+
+    for (U32 v = 0; v < mNumIndices; v++)
+    {
+        U32 from = order[v];
+        coords[v] = mCoords[from];
+        normals[v] = mNormals[from];
+        binormals[v] = mBinormals[from];
+        tex_coords[v] = mTexCoords[from];
+        vertex_indices[v] = mVertexIndices[from];
+    }
+
+    freeData();
+    mCoords = coords;
+    mNormals = normals;
+    mBinormals = binormals;
+    mTexCoords = tex_coords;
+    mVertexIndices = vertex_indices;
+}
+
 //-----------------------------------------------------------------------------
 // freeData()
 //-----------------------------------------------------------------------------
@@ -429,12 +475,12 @@ LLVector4a LLPolyMorphTarget::getVertexDistortion(S32 requested_index, LLPolyMes
 {
     if (!mMorphData || mMesh != mesh) return LLVector4a::getZero();
 
-    for(U32 index = 0; index < mMorphData->mNumIndices; index++)
+    const U32* begin = mMorphData->mVertexIndices;
+    const U32* end = begin + mMorphData->mNumIndices;
+    const U32* found = std::lower_bound(begin, end, (U32)requested_index);
+    if (found != end && *found == (U32)requested_index)
     {
-        if (mMorphData->mVertexIndices[index] == (U32)requested_index)
-        {
-            return mMorphData->mCoords[index];
-        }
+        return mMorphData->mCoords[found - begin];
     }
 
     return LLVector4a::getZero();
@@ -567,76 +613,9 @@ void LLPolyMorphTarget::apply( ESex avatar_sex )
 
     if (delta_weight != 0.f)
     {
-        llassert(!mMesh->isLOD());
-        LLVector4a *coords = mMesh->getWritableCoords();
-
-        LLVector4a *scaled_normals = mMesh->getScaledNormals();
-        LLVector4a *normals = mMesh->getWritableNormals();
-
-        LLVector4a *scaled_binormals = mMesh->getScaledBinormals();
-        LLVector4a *binormals = mMesh->getWritableBinormals();
-
-        LLVector4a *clothing_weights = mMesh->getWritableClothingWeights();
-        LLVector2 *tex_coords = mMesh->getWritableTexCoords();
-
         F32 *maskWeightArray = (mVertMask) ? mVertMask->getMorphMaskWeights() : NULL;
 
-        for(U32 vert_index_morph = 0; vert_index_morph < mMorphData->mNumIndices; vert_index_morph++)
-        {
-            S32 vert_index_mesh = mMorphData->mVertexIndices[vert_index_morph];
-
-            F32 maskWeight = 1.f;
-            if (maskWeightArray)
-            {
-                maskWeight = maskWeightArray[vert_index_morph];
-            }
-
-
-            LLVector4a pos = mMorphData->mCoords[vert_index_morph];
-            pos.mul(delta_weight*maskWeight);
-            coords[vert_index_mesh].add(pos);
-
-            if (getInfo()->mIsClothingMorph && clothing_weights)
-            {
-                LLVector4a clothing_offset = mMorphData->mCoords[vert_index_morph];
-                clothing_offset.mul(delta_weight * maskWeight);
-                LLVector4a* clothing_weight = &clothing_weights[vert_index_mesh];
-                clothing_weight->add(clothing_offset);
-                clothing_weight->getF32ptr()[VW] = maskWeight;
-            }
-
-            // calculate new normals based on half angles
-            LLVector4a norm = mMorphData->mNormals[vert_index_morph];
-            norm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
-            scaled_normals[vert_index_mesh].add(norm);
-            norm = scaled_normals[vert_index_mesh];
-
-            // guard against degenerate input data before we create NaNs below!
-            //
-            norm.normalize3fast();
-            normals[vert_index_mesh] = norm;
-
-            // calculate new binormals
-            LLVector4a binorm = mMorphData->mBinormals[vert_index_morph];
-
-            // guard against degenerate input data before we create NaNs below!
-            //
-            if (!binorm.isFinite3() || (binorm.dot3(binorm).getF32() <= F_APPROXIMATELY_ZERO))
-            {
-                binorm.set(1,0,0,1);
-            }
-
-            binorm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
-            scaled_binormals[vert_index_mesh].add(binorm);
-            LLVector4a tangent;
-            tangent.setCross3(scaled_binormals[vert_index_mesh], norm);
-            LLVector4a& normalized_binormal = binormals[vert_index_mesh];
-
-            normalized_binormal.setCross3(norm, tangent);
-            normalized_binormal.normalize3fast();
-
-            tex_coords[vert_index_mesh] += mMorphData->mTexCoords[vert_index_morph] * delta_weight * maskWeight;
-        }
+        mMesh->applyMorph(mMorphData, delta_weight, maskWeightArray, getInfo()->mIsClothingMorph);
 
         // now apply volume changes
         for(LLPolyVolumeMorph& volume_morph : mVolumeMorphs)
@@ -38,6 +38,9 @@ class LLVector2;
 class LLAvatarJointCollisionVolume;
 class LLWearable;
 
+// share of a morph's normal and binormal deltas applied to the mesh
+const F32 NORMAL_SOFTEN_FACTOR = 0.65f;
+
 //-----------------------------------------------------------------------------
 // LLPolyMorphData()
 //-----------------------------------------------------------------------------
@@ -55,7 +58,7 @@ public:
 public:
     std::string         mName;
 
-    // morphology
+    // morphology, sorted by mesh vertex index
     U32                 mNumIndices;
     U32*                mVertexIndices;
     U32                 mCurrentIndex;
@@ -71,6 +74,7 @@ public:
 
 private:
     void freeData();
+    void sortByVertexIndex();
 } LL_ALIGN_POSTFIX(16);
 
 
@@ -0,0 +1,247 @@
+/**
+ * @file llappearance/tests/llpolymesh_test.cpp
+ * @brief Tests for batched LLPolyMesh morphing
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llpolymesh.h"
+#include "../llpolymorph.h"
+#include "lldir.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+namespace
+{
+    // the meshes morph targets apply to; the rest are their LODs
+    const char* BASE_MESHES[] =
+    {
+        "avatar_head.llm",
+        "avatar_upper_body.llm",
+        "avatar_lower_body.llm",
+        "avatar_eye.llm",
+        "avatar_eyelashes.llm",
+        "avatar_hair.llm",
+        "avatar_skirt.llm",
+    };
+
+    typedef std::unique_ptr<LLPolyMesh> mesh_ptr_t;
+
+    // One morph of a shape change: how far it moves and, for some, a mask.
+    struct MorphStep
+    {
+        LLPolyMorphData* mMorphData;
+        F32 mDeltaWeight;
+        std::vector<F32> mMaskWeights;
+        bool mClothing;
+    };
+
+    std::vector<MorphStep> make_shape_change(LLPolyMesh* mesh, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<F32> weight(-1.f, 1.f);
+        std::uniform_real_distribution<F32> unit(0.f, 1.f);
+        std::vector<MorphStep> steps;
+        for (LLPolyMorphData* morph_data : mesh->getMorphDataList())
+        {
+            MorphStep step;
+            step.mMorphData = morph_data;
+            step.mDeltaWeight = weight(rng);
+            step.mClothing = (steps.size() % 3) == 0;
+            if ((steps.size() % 4) == 0)
+            {
+                for (U32 i = 0; i < morph_data->mNumIndices; ++i)
+                {
+                    step.mMaskWeights.push_back(unit(rng));
+                }
+            }
+            steps.push_back(step);
+        }
+        return steps;
+    }
+
+    void apply_shape_change(LLPolyMesh* mesh, const std::vector<MorphStep>& steps, bool batch)
+    {
+        if (batch)
+        {
+            mesh->beginMorphBatch();
+        }
+        for (const MorphStep& step : steps)
+        {
+            mesh->applyMorph(step.mMorphData, step.mDeltaWeight,
+                             step.mMaskWeights.empty() ? NULL : step.mMaskWeights.data(),
+                             step.mClothing);
+        }
+        if (batch)
+        {
+            mesh->endMorphBatch();
+        }
+    }
+
+    // first differing vertex array of two instances of a mesh, if any
+    std::string compare_meshes(LLPolyMesh* a, LLPolyMesh* b)
+    {
+        const size_t vec4_bytes = sizeof(LLVector4a) * a->getNumVertices();
+        if (memcmp(a->getCoords(), b->getCoords(), vec4_bytes))
+        {
+            return "coords";
+        }
+        if (memcmp(a->getNormals(), b->getNormals(), vec4_bytes))
+        {
+            return "normals";
+        }
+        if (memcmp(a->getBinormals(), b->getBinormals(), vec4_bytes))
+        {
+            return "binormals";
+        }
+        if (memcmp(a->getClothingWeights(), b->getClothingWeights(), vec4_bytes))
+        {
+            return "clothing weights";
+        }
+        if (memcmp(a->getTexCoords(), b->getTexCoords(), sizeof(LLVector2) * a->getNumVertices()))
+        {
+            return "tex coords";
+        }
+        return std::string();
+    }
+}
+
+namespace tut
+{
+    struct polymesh_data
+    {
+        polymesh_data()
+        {
+            // meshes load from the character folder of the viewer sources
+            boost::filesystem::path newview = boost::filesystem::path(__FILE__).parent_path() / ".." / ".." / "newview";
+            gDirUtilp->initAppDirs("SecondLife", newview.string());
+        }
+
+        ~polymesh_data()
+        {
+            mMeshes.clear();
+            LLPolyMesh::freeAllMeshes();
+        }
+
+        LLPolyMesh* loadMesh(const std::string& name)
+        {
+            LLPolyMesh* mesh = LLPolyMesh::getMesh(name);
+            if (mesh)
+            {
+                mMeshes.push_back(mesh_ptr_t(mesh));
+            }
+            return mesh;
+        }
+
+        std::vector<mesh_ptr_t> mMeshes;
+    };
+    typedef test_group<polymesh_data> polymesh_group;
+    typedef polymesh_group::object polymesh_object;
+    tut::polymesh_group polymesh_test("LLPolyMesh");
+
+    template<> template<>
+    void polymesh_object::test<1>()
+    {
+        set_test_name("batched morphs match morphs applied one at a time");
+        std::mt19937 rng(42);
+        S32 compared = 0;
+        for (const char* name : BASE_MESHES)
+        {
+            LLPolyMesh* single = loadMesh(name);
+            LLPolyMesh* batched = loadMesh(name);
+            if (!single || !batched)
+            {
+                continue;
+            }
+            for (S32 change = 0; change < 3; ++change)
+            {
+                std::vector<MorphStep> steps = make_shape_change(single, rng);
+                apply_shape_change(single, steps, false);
+                apply_shape_change(batched, steps, true);
+                std::string failure = compare_meshes(single, batched);
+                ensure(llformat("%s %s", name, failure.c_str()), failure.empty());
+            }
+            ++compared;
+        }
+        if (!compared)
+        {
+            skip("avatar meshes not found");
+        }
+    }
+
+    template<> template<>
+    void polymesh_object::test<2>()
+    {
+        set_test_name("nested morph batches finish with the outermost");
+        LLPolyMesh* single = loadMesh("avatar_head.llm");
+        LLPolyMesh* batched = loadMesh("avatar_head.llm");
+        if (!single || !batched)
+        {
+            skip("avatar meshes not found");
+        }
+        std::mt19937 rng(7);
+        std::vector<MorphStep> steps = make_shape_change(single, rng);
+        ensure("head has morphs", !steps.empty());
+        apply_shape_change(single, steps, false);
+
+        batched->beginMorphBatch();
+        apply_shape_change(batched, steps, true);
+        ensure("still batching", batched->isMorphBatching());
+        ensure("coords applied", !memcmp(single->getCoords(), batched->getCoords(), sizeof(LLVector4a) * single->getNumVertices()));
+        batched->endMorphBatch();
+        ensure("batch finished", !batched->isMorphBatching());
+        std::string failure = compare_meshes(single, batched);
+        ensure(failure, failure.empty());
+    }
+
+    template<> template<>
+    void polymesh_object::test<3>()
+    {
+        set_test_name("morph vertices are sorted by mesh vertex");
+        S32 checked = 0;
+        for (const char* name : BASE_MESHES)
+        {
+            LLPolyMesh* mesh = loadMesh(name);
+            if (!mesh)
+            {
+                continue;
+            }
+            for (LLPolyMorphData* morph_data : mesh->getMorphDataList())
+            {
+                for (U32 i = 1; i < morph_data->mNumIndices; ++i)
+                {
+                    ensure(morph_data->getName(), morph_data->mVertexIndices[i - 1] <= morph_data->mVertexIndices[i]);
+                }
+                ++checked;
+            }
+        }
+        if (!checked)
+        {
+            skip("avatar meshes not found");
+        }
+    }
+}
@@ -33,6 +33,7 @@
 #include "llcharacter.h"
 #include "llstring.h"
 #include "llfasttimer.h"
+#include "threadpool.h"
 
 #define SKEL_HEADER "Linden Skeleton 1.0"
 
@@ -50,7 +51,8 @@ LLCharacter::LLCharacter()
     mPreferredPelvisHeight( 0.f ),
     mSex( SEX_FEMALE ),
     mAppearanceSerialNum( 0 ),
-    mSkeletonSerialNum( 0 )
+    mSkeletonSerialNum( 0 ),
+    mVisualParamsUpdatePending( false )
 {
     llassert_always(sAllowInstancesChange) ;
 
@@ -191,6 +193,91 @@ void LLCharacter::updateMotions(e_update_t update_type)
     }
 }
 
+//-----------------------------------------------------------------------------
+// beginUpdateMotions()
+//-----------------------------------------------------------------------------
+bool LLCharacter::beginUpdateMotions(e_update_t update_type, bool defer_side_effects)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    if (update_type == HIDDEN_UPDATE)
+    {
+        mMotionController.updateMotionsMinimal();
+        return false;
+    }
+
+    // unpause if the number of outstanding pause requests has dropped to the initial one
+    if (mMotionController.isPaused() && mPauseRequest->getNumRefs() == 1)
+    {
+        mMotionController.unpauseAllMotions();
+    }
+    return mMotionController.beginUpdateMotions(update_type == FORCE_UPDATE, defer_side_effects);
+}
+
+//-----------------------------------------------------------------------------
+// evaluateMotions()
+//-----------------------------------------------------------------------------
+void LLCharacter::evaluateMotions()
+{
+    mMotionController.evaluateMotions();
+}
+
+//-----------------------------------------------------------------------------
+// finishUpdateMotions()
+//-----------------------------------------------------------------------------
+void LLCharacter::finishUpdateMotions()
+{
+    mMotionController.finishUpdateMotions();
+    if (mVisualParamsUpdatePending)
+    {
+        mVisualParamsUpdatePending = false;
+        updateVisualParams();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// evaluateMotions()
+//-----------------------------------------------------------------------------
+// static
+void LLCharacter::evaluateMotions(const std::vector<LLCharacter*>& characters, LL::ThreadPoolBase* pool)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    auto evaluate = [&characters](size_t i)
+    {
+        LLCharacter* character = characters[i];
+        character->evaluateMotions();
+        character->updateJointWorldMatrices();
+    };
+
+    if (pool && characters.size() > 1)
+    {
+        pool->forkJoin(characters.size(), evaluate);
+    }
+    else
+    {
+        for (size_t i = 0; i < characters.size(); ++i)
+        {
+            evaluate(i);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// requestVisualParamsUpdate()
+//-----------------------------------------------------------------------------
+void LLCharacter::requestVisualParamsUpdate()
+{
+    if (mMotionController.isDeferringUpdates())
+    {
+        // LLVOAvatar's override reaches into meshes and drawables shared with
+        // the render pipeline; wait for finishUpdateMotions()
+        mVisualParamsUpdatePending = true;
+    }
+    else
+    {
+        updateVisualParams();
+    }
+}
+
 
 //-----------------------------------------------------------------------------
 // deactivateAllMotions()
@@ -457,6 +544,7 @@ void LLCharacter::addVisualParam(LLVisualParam *param)
 //-----------------------------------------------------------------------------
 void LLCharacter::updateVisualParams()
 {
+    beginVisualParamsUpdate();
     for (LLVisualParam *param = getFirstVisualParam();
         param;
         param = getNextVisualParam())
@@ -472,6 +560,7 @@ void LLCharacter::updateVisualParams()
             param->apply( mSex );
         }
     }
+    endVisualParamsUpdate();
 }
 
 LLAnimPauseRequest LLCharacter::requestPause()
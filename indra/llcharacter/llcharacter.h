@@ -31,8 +31,10 @@
 // Header Files
 //-----------------------------------------------------------------------------
 #include <string>
+#include <vector>
 
 #include "lljoint.h"
+#include "lljointhierarchy.h"
 #include "llmotioncontroller.h"
 #include "llvisualparam.h"
 #include "llstringtable.h"
@@ -40,6 +42,7 @@
 #include "llrefcount.h"
 
 class LLPolyMesh;
+namespace LL { class ThreadPoolBase; }
 
 class LLPauseRequestHandle : public LLThreadSafeRefCount
 {
@@ -117,6 +120,15 @@ public:
     // updates all visual parameters for this character
     virtual void updateVisualParams();
 
+    // called around the params applied by updateVisualParams(), so that
+    // their work on shared data can be batched
+    virtual void beginVisualParamsUpdate() {}
+    virtual void endVisualParamsUpdate() {}
+
+    // for motions: updates visual parameters now, or once the deferred
+    // motion update in progress has finished
+    void requestVisualParamsUpdate();
+
     virtual void addDebugText( const std::string& text ) = 0;
 
     virtual std::string getDebugName() const { return getID().asString(); }
@@ -157,6 +169,23 @@ public:
     enum e_update_t { NORMAL_UPDATE, HIDDEN_UPDATE, FORCE_UPDATE };
     void updateMotions(e_update_t update_type);
 
+    // updateMotions() split so that several characters can be evaluated at
+    // once: begin on the main thread, evaluate anywhere (no two threads on
+    // the same character), finish on the main thread.  beginUpdateMotions()
+    // returns false when there is nothing to evaluate this frame.
+    bool beginUpdateMotions(e_update_t update_type, bool defer_side_effects);
+    void evaluateMotions();
+    void finishUpdateMotions();
+
+    // evaluates the motions of characters whose beginUpdateMotions()
+    // returned true and updates their joint world matrices, spreading them
+    // over pool (serially if pool is NULL)
+    static void evaluateMotions(const std::vector<LLCharacter*>& characters, LL::ThreadPoolBase* pool);
+
+    // brings the world matrices of the skeleton up to date in one pass over
+    // a flat joint array; same result as getRootJoint()->updateWorldMatrixChildren()
+    U32 updateJointWorldMatrices() { return mJointHierarchy.updateWorldMatrices(getRootJoint()); }
+
     LLAnimPauseRequest requestPause();
     bool areAnimationsPaused() const { return mMotionController.isPaused(); }
     void setAnimTimeFactor(F32 factor) { mMotionController.setTimeFactor(factor); }
@@ -292,6 +321,8 @@ protected:
     U32                 mAppearanceSerialNum;
     U32                 mSkeletonSerialNum;
     LLAnimPauseRequest  mPauseRequest;
+    bool                mVisualParamsUpdatePending;
+    LLJointHierarchy    mJointHierarchy;
 
 private:
     // visual parameter stuff
@@ -34,8 +34,8 @@
 #include "llmath.h"
 #include <boost/algorithm/string.hpp>
 
-S32 LLJoint::sNumUpdates = 0;
-S32 LLJoint::sNumTouches = 0;
+LLAtomicS32 LLJoint::sNumUpdates(0);
+LLAtomicS32 LLJoint::sNumTouches(0);
 
 template <class T>
 bool attachment_map_iter_compare_key(const T& a, const T& b)
@@ -108,6 +108,7 @@ void LLJoint::init()
     mXform.setScale(LLVector3(1.0f, 1.0f, 1.0f));
     mDirtyFlags = MATRIX_DIRTY | ROTATION_DIRTY | POSITION_DIRTY;
     mUpdateXform = true;
+    mTopologySerial = 0;
     mSupport = SUPPORT_BASE;
     mEnd = LLVector3(0.0f, 0.0f, 0.0f);
 }
@@ -271,6 +272,7 @@ void LLJoint::addChild(LLJoint* joint)
     joint->mXform.setParent(&mXform);
     joint->mParent = this;
     joint->touch();
+    getRoot()->mTopologySerial++;
 }
 
 
@@ -287,6 +289,7 @@ void LLJoint::removeChild(LLJoint* joint)
         joint->mXform.setParent(NULL);
         joint->mParent = NULL;
         joint->touch();
+        getRoot()->mTopologySerial++;
     }
 }
 
@@ -307,6 +310,7 @@ void LLJoint::removeAllChildren()
         }
     }
     mChildren.clear();
+    getRoot()->mTopologySerial++;
 }
 
 
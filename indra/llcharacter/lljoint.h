@@ -39,6 +39,7 @@
 #include "llquaternion.h"
 #include "xform.h"
 #include "llmatrix4a.h"
+#include "llatomic.h"
 
 constexpr S32 LL_CHARACTER_MAX_JOINTS_PER_MESH = 15;
 // Need to set this to count of animate-able joints,
@@ -135,6 +136,10 @@ public:
     U32             mDirtyFlags;
     bool            mUpdateXform;
 
+    // bumped on the root whenever a joint joins or leaves its tree, so
+    // LLJointHierarchy knows to rebuild
+    U32             mTopologySerial;
+
     // describes the skin binding pose
     LLVector3       mSkinOffset;
 
@@ -158,8 +163,9 @@ public:
 	joints_t mChildren;
 
     // debug statics
-    static S32      sNumTouches;
-    static S32      sNumUpdates;
+    // atomic: skeletons may be posed on several threads at once
+    static LLAtomicS32  sNumTouches;
+    static LLAtomicS32  sNumUpdates;
     typedef std::set<std::string> debug_joint_name_t;
     static debug_joint_name_t s_debugJointNames;
     static void setDebugJointNames(const debug_joint_name_t& names);
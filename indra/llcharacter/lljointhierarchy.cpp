@@ -0,0 +1,145 @@
+/**
+ * @file lljointhierarchy.cpp
+ * @brief Flat, depth first view of a joint tree for world matrix updates
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+//-----------------------------------------------------------------------------
+// Header Files
+//-----------------------------------------------------------------------------
+#include "linden_common.h"
+
+#include "lljointhierarchy.h"
+#include "lljoint.h"
+
+//-----------------------------------------------------------------------------
+// LLJointHierarchy()
+//-----------------------------------------------------------------------------
+LLJointHierarchy::LLJointHierarchy()
+:   mRoot(NULL),
+    mTopologySerial(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// clear()
+//-----------------------------------------------------------------------------
+void LLJointHierarchy::clear()
+{
+    mJoints.clear();
+    mParentIndex.clear();
+    mSubtreeEnd.clear();
+    mRoot = NULL;
+    mTopologySerial = 0;
+}
+
+//-----------------------------------------------------------------------------
+// build()
+//-----------------------------------------------------------------------------
+void LLJointHierarchy::build(LLJoint* root)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    mJoints.clear();
+    mParentIndex.clear();
+    mSubtreeEnd.clear();
+
+    // depth first, children in mChildren order, as the recursion visits them
+    struct Entry
+    {
+        LLJoint* mJoint;
+        S32 mParent;
+    };
+    std::vector<Entry> stack;
+    stack.push_back({ root, -1 });
+    while (!stack.empty())
+    {
+        Entry entry = stack.back();
+        stack.pop_back();
+
+        const S32 index = (S32)mJoints.size();
+        mJoints.push_back(entry.mJoint);
+        mParentIndex.push_back(entry.mParent);
+        mSubtreeEnd.push_back(0);
+
+        const LLJoint::joints_t& children = entry.mJoint->mChildren;
+        for (LLJoint::joints_t::const_reverse_iterator it = children.rbegin(); it != children.rend(); ++it)
+        {
+            stack.push_back({ *it, index });
+        }
+    }
+
+    // a subtree ends where the next joint that isn't a descendant starts;
+    // walk back so every child's end is known before its parent's
+    const U32 count = (U32)mJoints.size();
+    for (U32 i = count; i-- > 0; )
+    {
+        mSubtreeEnd[i] = llmax(mSubtreeEnd[i], i + 1);
+        if (mParentIndex[i] >= 0)
+        {
+            U32& parent_end = mSubtreeEnd[mParentIndex[i]];
+            parent_end = llmax(parent_end, mSubtreeEnd[i]);
+        }
+    }
+
+    mRoot = root;
+    mTopologySerial = root->mTopologySerial;
+}
+
+//-----------------------------------------------------------------------------
+// updateWorldMatrices()
+//-----------------------------------------------------------------------------
+U32 LLJointHierarchy::updateWorldMatrices(LLJoint* root)
+{
+    if (!root)
+    {
+        return 0;
+    }
+    if (root != mRoot || root->mTopologySerial != mTopologySerial)
+    {
+        build(root);
+    }
+
+    U32 recomputed = 0;
+    const U32 count = (U32)mJoints.size();
+    U32 i = 0;
+    while (i < count)
+    {
+        LLJoint* joint = mJoints[i];
+        if (!joint->mUpdateXform)
+        {
+            // as the recursion, skip the whole subtree
+            i = mSubtreeEnd[i];
+            continue;
+        }
+
+        // Only dirty joints, as the recursion: touch() already marks the
+        // descendants of a moved joint dirty.
+        if (joint->mDirtyFlags & LLJoint::MATRIX_DIRTY)
+        {
+            joint->updateWorldMatrix();
+            ++recomputed;
+        }
+        ++i;
+    }
+    return recomputed;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file lljointhierarchy.h
+ * @brief Flat, depth first view of a joint tree for world matrix updates
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLJOINTHIERARCHY_H
+#define LL_LLJOINTHIERARCHY_H
+
+//-----------------------------------------------------------------------------
+// Header Files
+//-----------------------------------------------------------------------------
+#include <vector>
+
+class LLJoint;
+
+//-----------------------------------------------------------------------------
+// class LLJointHierarchy
+// The joints of a skeleton (bones, collision volumes and attachment points)
+// in depth first order, each with the index of its parent and the end of
+// its subtree, so that updateWorldMatrices() can bring every world matrix
+// up to date in one linear pass instead of a recursion over mChildren.
+//
+// The pass recomputes a joint only when it is MATRIX_DIRTY, like the
+// recursion, so an idle skeleton costs one flag test per joint. The array
+// is rebuilt whenever joints are added to or removed from the tree (see
+// LLJoint::mTopologySerial).
+//-----------------------------------------------------------------------------
+class LLJointHierarchy
+{
+public:
+    LLJointHierarchy();
+
+    // Same result as root->updateWorldMatrixChildren(). Returns the number
+    // of joints whose world matrix was recomputed.
+    U32 updateWorldMatrices(LLJoint* root);
+
+    void clear();
+
+    U32 getNumJoints() const { return (U32)mJoints.size(); }
+    LLJoint* getJoint(U32 index) const { return mJoints[index]; }
+    // -1 for the root
+    S32 getParentIndex(U32 index) const { return mParentIndex[index]; }
+
+private:
+    void build(LLJoint* root);
+
+    std::vector<LLJoint*> mJoints;
+    std::vector<S32> mParentIndex;
+    std::vector<U32> mSubtreeEnd;   // one past the last descendant
+
+    LLJoint* mRoot;
+    U32 mTopologySerial;
+};
+
+#endif // LL_LLJOINTHIERARCHY_H
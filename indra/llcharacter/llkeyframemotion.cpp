@@ -61,6 +61,75 @@ static F32 MIN_ACCELERATION_SQUARED = 0.0005f * 0.0005f;
 
 static F32 MAX_CONSTRAINTS = 10;
 
+// size of one std::map node beyond its value: three links and a colour
+static const size_t KEY_MAP_NODE_OVERHEAD = 4 * sizeof(void*);
+
+namespace
+{
+    // Packs keys read from an asset into sorted, unique times and their
+    // values.  Matches inserting them into a map by time in order: the last
+    // key read wins among keys at the same time.
+    template<class VALUE>
+    void pack_keys(std::vector<std::pair<F32, VALUE> >& keys, std::vector<F32>& times, std::vector<VALUE>& values)
+    {
+        typedef std::pair<F32, VALUE> raw_key_t;
+        std::stable_sort(keys.begin(), keys.end(),
+                         [](const raw_key_t& a, const raw_key_t& b) { return a.first < b.first; });
+        size_t unique_keys = 0;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            if (i + 1 == keys.size() || keys[i + 1].first != keys[i].first)
+            {
+                ++unique_keys;
+            }
+        }
+        times.clear();
+        values.clear();
+        times.reserve(unique_keys);
+        values.reserve(unique_keys);
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            if (i + 1 == keys.size() || keys[i + 1].first != keys[i].first)
+            {
+                times.push_back(keys[i].first);
+                values.push_back(keys[i].second);
+            }
+        }
+    }
+
+    // Index of the first key at or after time, as std::lower_bound finds it.
+    // Playback mostly moves forward a little each frame, so with a cursor
+    // the answer is usually a step or two past the previous one; anything
+    // else (a loop wrapping round, a seek) falls back to a binary search.
+    S32 find_key(const std::vector<F32>& times, F32 time, U32* cursor)
+    {
+        const S32 count = (S32)times.size();
+        S32 index;
+        if (cursor && *cursor <= (U32)count && (*cursor == 0 || times[*cursor - 1] < time))
+        {
+            index = (S32)*cursor;
+            const S32 limit = llmin(index + 4, count);
+            while (index < limit && times[index] < time)
+            {
+                ++index;
+            }
+            if (index == limit && index < count && times[index] < time)
+            {
+                index = (S32)(std::lower_bound(times.begin() + index, times.end(), time) - times.begin());
+            }
+        }
+        else
+        {
+            index = (S32)(std::lower_bound(times.begin(), times.end(), time) - times.begin());
+        }
+        if (cursor)
+        {
+            *cursor = (U32)index;
+        }
+        return index;
+    }
+}
+
 //-----------------------------------------------------------------------------
 // JointMotionList
 //-----------------------------------------------------------------------------
@@ -104,16 +173,16 @@ U32 LLKeyframeMotion::JointMotionList::dumpDiagInfo()
         if (joint_motion_p->mUsage & LLJointState::ROT)
         {
             LL_INFOS() << "\t" << joint_motion_p->mRotationCurve.mNumKeys << " rotation keys at "
-            << joint_motion_p->mRotationCurve.mNumKeys * sizeof(RotationKey) << " bytes" << LL_ENDL;
+            << joint_motion_p->mRotationCurve.getKeyMemory() << " bytes" << LL_ENDL;
 
-            total_size += joint_motion_p->mRotationCurve.mNumKeys * sizeof(RotationKey);
+            total_size += (S32)joint_motion_p->mRotationCurve.getKeyMemory();
         }
         if (joint_motion_p->mUsage & LLJointState::POS)
         {
             LL_INFOS() << "\t" << joint_motion_p->mPositionCurve.mNumKeys << " position keys at "
-            << joint_motion_p->mPositionCurve.mNumKeys * sizeof(PositionKey) << " bytes" << LL_ENDL;
+            << joint_motion_p->mPositionCurve.getKeyMemory() << " bytes" << LL_ENDL;
 
-            total_size += joint_motion_p->mPositionCurve.mNumKeys * sizeof(PositionKey);
+            total_size += (S32)joint_motion_p->mPositionCurve.getKeyMemory();
         }
     }
     LL_INFOS() << "Size: " << total_size << " bytes" << LL_ENDL;
@@ -121,6 +190,27 @@ U32 LLKeyframeMotion::JointMotionList::dumpDiagInfo()
     return total_size;
 }
 
+size_t LLKeyframeMotion::JointMotionList::getKeyMemory() const
+{
+    size_t total_size = 0;
+    for (const JointMotion* joint_motion_p : mJointMotionArray)
+    {
+        total_size += joint_motion_p->mRotationCurve.getKeyMemory();
+        total_size += joint_motion_p->mPositionCurve.getKeyMemory();
+        total_size += joint_motion_p->mScaleCurve.mKeys.size() * (sizeof(ScaleCurve::key_map_t::value_type) + KEY_MAP_NODE_OVERHEAD);
+    }
+    return total_size;
+}
+
+void LLKeyframeMotion::JointMotionList::expandKeys()
+{
+    for (JointMotion* joint_motion_p : mJointMotionArray)
+    {
+        joint_motion_p->mRotationCurve.expandKeys();
+        joint_motion_p->mPositionCurve.expandKeys();
+    }
+}
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 // ****Curve classes
@@ -229,10 +319,38 @@ LLKeyframeMotion::RotationCurve::~RotationCurve()
 //-----------------------------------------------------------------------------
 // RotationCurve::getValue()
 //-----------------------------------------------------------------------------
-LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration)
+LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration, U32* cursor)
 {
     LLQuaternion value;
 
+    if (isPacked())
+    {
+        const S32 count = getNumPackedKeys();
+        const S32 right = find_key(mPackedTimes, time, cursor);
+        if (right == count)
+        {
+            // Past last key
+            value = getPackedRotation(count - 1);
+        }
+        else if (right == 0 || mPackedTimes[right] == time)
+        {
+            // Before first key or exactly on a key
+            value = getPackedRotation(right);
+        }
+        else
+        {
+            // Between two keys
+            F32 index_before = mPackedTimes[right - 1];
+            F32 index_after = mPackedTimes[right];
+            RotationKey rot_before(index_before, getPackedRotation(right - 1));
+            RotationKey rot_after(index_after, getPackedRotation(right));
+
+            F32 u = (time - index_before) / (index_after - index_before);
+            value = interp(u, rot_before, rot_after);
+        }
+        return value;
+    }
+
     if (mKeys.empty())
     {
         value = LLQuaternion::DEFAULT;
@@ -288,6 +406,29 @@ LLQuaternion LLKeyframeMotion::RotationCurve::interp(F32 u, RotationKey& before,
     }
 }
 
+//-----------------------------------------------------------------------------
+// RotationCurve::expandKeys()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::RotationCurve::expandKeys()
+{
+    for (S32 i = 0; i < getNumPackedKeys(); i++)
+    {
+        mKeys[mPackedTimes[i]] = RotationKey(mPackedTimes[i], getPackedRotation(i));
+    }
+    std::vector<F32>().swap(mPackedTimes);
+    std::vector<LLQuaternion>().swap(mPackedRotations);
+}
+
+//-----------------------------------------------------------------------------
+// RotationCurve::getKeyMemory()
+//-----------------------------------------------------------------------------
+size_t LLKeyframeMotion::RotationCurve::getKeyMemory() const
+{
+    return mPackedTimes.capacity() * sizeof(F32)
+        + mPackedRotations.capacity() * sizeof(LLQuaternion)
+        + mKeys.size() * (sizeof(key_map_t::value_type) + KEY_MAP_NODE_OVERHEAD);
+}
+
 
 //-----------------------------------------------------------------------------
 // PositionCurve::PositionCurve()
@@ -310,10 +451,41 @@ LLKeyframeMotion::PositionCurve::~PositionCurve()
 //-----------------------------------------------------------------------------
 // PositionCurve::getValue()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration)
+LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration, U32* cursor)
 {
     LLVector3 value;
 
+    if (isPacked())
+    {
+        const S32 count = getNumPackedKeys();
+        const S32 right = find_key(mPackedTimes, time, cursor);
+        if (right == count)
+        {
+            // Past last key
+            value = getPackedPosition(count - 1);
+        }
+        else if (right == 0 || mPackedTimes[right] == time)
+        {
+            // Before first key or exactly on a key
+            value = getPackedPosition(right);
+        }
+        else
+        {
+            // Between two keys
+            F32 index_before = mPackedTimes[right - 1];
+            F32 index_after = mPackedTimes[right];
+            PositionKey pos_before(index_before, getPackedPosition(right - 1));
+            PositionKey pos_after(index_after, getPackedPosition(right));
+
+            F32 u = (time - index_before) / (index_after - index_before);
+            value = interp(u, pos_before, pos_after);
+        }
+
+        llassert(value.isFinite());
+
+        return value;
+    }
+
     if (mKeys.empty())
     {
         value.clearVec();
@@ -371,6 +543,29 @@ LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, PositionKey& before, Po
     }
 }
 
+//-----------------------------------------------------------------------------
+// PositionCurve::expandKeys()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::PositionCurve::expandKeys()
+{
+    for (S32 i = 0; i < getNumPackedKeys(); i++)
+    {
+        mKeys[mPackedTimes[i]] = PositionKey(mPackedTimes[i], getPackedPosition(i));
+    }
+    std::vector<F32>().swap(mPackedTimes);
+    std::vector<LLVector3>().swap(mPackedPositions);
+}
+
+//-----------------------------------------------------------------------------
+// PositionCurve::getKeyMemory()
+//-----------------------------------------------------------------------------
+size_t LLKeyframeMotion::PositionCurve::getKeyMemory() const
+{
+    return mPackedTimes.capacity() * sizeof(F32)
+        + mPackedPositions.capacity() * sizeof(LLVector3)
+        + mKeys.size() * (sizeof(key_map_t::value_type) + KEY_MAP_NODE_OVERHEAD);
+}
+
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
@@ -381,7 +576,7 @@ LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, PositionKey& before, Po
 //-----------------------------------------------------------------------------
 // JointMotion::update()
 //-----------------------------------------------------------------------------
-void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time, F32 duration)
+void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time, F32 duration, U32* cursors)
 {
     // this value being 0 is the cause of https://jira.lindenlab.com/browse/SL-22678 but I haven't
     // managed to get a stack to see how it got here. Testing for 0 here will stop the crash.
@@ -405,7 +600,7 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
     //-------------------------------------------------------------------------
     if ((usage & LLJointState::ROT) && mRotationCurve.mNumKeys)
     {
-        joint_state->setRotation( mRotationCurve.getValue( time, duration ) );
+        joint_state->setRotation( mRotationCurve.getValue( time, duration, cursors ? &cursors[0] : NULL ) );
     }
 
     //-------------------------------------------------------------------------
@@ -413,7 +608,7 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
     //-------------------------------------------------------------------------
     if ((usage & LLJointState::POS) && mPositionCurve.mNumKeys)
     {
-        joint_state->setPosition( mPositionCurve.getValue( time, duration ) );
+        joint_state->setPosition( mPositionCurve.getValue( time, duration, cursors ? &cursors[1] : NULL ) );
     }
 }
 
@@ -736,11 +931,17 @@ bool LLKeyframeMotion::onUpdate(F32 time, U8* joint_mask)
 void LLKeyframeMotion::applyKeyframes(F32 time)
 {
     llassert_always (mJointMotionList->getNumJointMotions() <= mJointStates.size());
-    for (U32 i=0; i<mJointMotionList->getNumJointMotions(); i++)
+    U32 num_joint_motions = mJointMotionList->getNumJointMotions();
+    if (mCurveCursors.size() != num_joint_motions * 2)
+    {
+        mCurveCursors.assign(num_joint_motions * 2, 0);
+    }
+    for (U32 i=0; i<num_joint_motions; i++)
     {
         mJointMotionList->getJointMotion(i)->update(mJointStates[i],
                                                       time,
-                                                      mJointMotionList->mDuration );
+                                                      mJointMotionList->mDuration,
+                                                      &mCurveCursors[i * 2] );
     }
 
     LLJoint::JointPriority* pose_priority = (LLJoint::JointPriority* )mCharacter->getAnimationData("Hand Pose Priority");
@@ -1560,6 +1761,8 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
         // scan rotation curve keys
         //---------------------------------------------------------------------
         RotationCurve *rCurve = &joint_motion->mRotationCurve;
+        std::vector<std::pair<F32, LLQuaternion> > rot_keys;
+        rot_keys.reserve(rCurve->mNumKeys);
 
         for (S32 k = 0; k < joint_motion->mRotationCurve.mNumKeys; k++)
         {
@@ -1661,14 +1864,17 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
                 return false;
             }
 
-            rCurve->mKeys[time] = rot_key;
+            rot_keys.push_back(std::make_pair(time, rot_key.mRotation));
         }
 
-        if (joint_motion->mRotationCurve.mNumKeys > joint_motion->mRotationCurve.mKeys.size())
+        pack_keys(rot_keys, rCurve->mPackedTimes, rCurve->mPackedRotations);
+
+        S32 unique_rot_keys = rCurve->getNumPackedKeys();
+        if (joint_motion->mRotationCurve.mNumKeys > unique_rot_keys)
         {
             rotation_duplicates++;
             LL_INFOS() << "Motion " << asset() << " had duplicated rotation keys that were removed: "
-                << joint_motion->mRotationCurve.mNumKeys << " > " << joint_motion->mRotationCurve.mKeys.size()
+                << joint_motion->mRotationCurve.mNumKeys << " > " << unique_rot_keys
                 << " (" << rotation_duplicates << ")" << LL_ENDL;
         }
 
@@ -1693,6 +1899,8 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
         //---------------------------------------------------------------------
         PositionCurve *pCurve = &joint_motion->mPositionCurve;
         bool is_pelvis = joint_motion->mJointName == "mPelvis";
+        std::vector<std::pair<F32, LLVector3> > pos_keys;
+        pos_keys.reserve(pCurve->mNumKeys);
         for (S32 k = 0; k < joint_motion->mPositionCurve.mNumKeys; k++)
         {
             U16 time_short;
@@ -1770,7 +1978,7 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
                 return false;
             }
 
-            pCurve->mKeys[pos_key.mTime] = pos_key;
+            pos_keys.push_back(std::make_pair(pos_key.mTime, pos_key.mPosition));
 
             if (is_pelvis)
             {
@@ -1778,11 +1986,14 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
             }
         }
 
-        if (joint_motion->mPositionCurve.mNumKeys > joint_motion->mPositionCurve.mKeys.size())
+        pack_keys(pos_keys, pCurve->mPackedTimes, pCurve->mPackedPositions);
+
+        S32 unique_pos_keys = pCurve->getNumPackedKeys();
+        if (joint_motion->mPositionCurve.mNumKeys > unique_pos_keys)
         {
             position_duplicates++;
             LL_INFOS() << "Motion " << asset() << " had duplicated position keys that were removed: "
-                << joint_motion->mPositionCurve.mNumKeys << " > " << joint_motion->mPositionCurve.mKeys.size()
+                << joint_motion->mPositionCurve.mNumKeys << " > " << unique_pos_keys
                 << " (" << position_duplicates << ")" << LL_ENDL;
         }
 
@@ -2080,19 +2291,23 @@ bool LLKeyframeMotion::serialize(LLDataPacker& dp) const
         JointMotion* joint_motionp = mJointMotionList->getJointMotion(i);
         success &= dp.packString(joint_motionp->mJointName, "joint_name");
         success &= dp.packS32(joint_motionp->mPriority, "joint_priority");
-        success &= dp.packS32(static_cast<S32>(joint_motionp->mRotationCurve.mKeys.size()), "num_rot_keys");
+        const RotationCurve& rot_curve = joint_motionp->mRotationCurve;
+        const PositionCurve& pos_curve = joint_motionp->mPositionCurve;
+        S32 num_rot_keys = rot_curve.isPacked() ? rot_curve.getNumPackedKeys() : static_cast<S32>(rot_curve.mKeys.size());
+        S32 num_pos_keys = pos_curve.isPacked() ? pos_curve.getNumPackedKeys() : static_cast<S32>(pos_curve.mKeys.size());
+        success &= dp.packS32(num_rot_keys, "num_rot_keys");
 
         LL_DEBUGS("BVH") << "Joint " << i
             << " name: " << joint_motionp->mJointName
-            << " Rotation keys: " << joint_motionp->mRotationCurve.mKeys.size()
-            << " Position keys: " << joint_motionp->mPositionCurve.mKeys.size() << LL_ENDL;
-        for (RotationCurve::key_map_t::value_type& rot_pair : joint_motionp->mRotationCurve.mKeys)
+            << " Rotation keys: " << num_rot_keys
+            << " Position keys: " << num_pos_keys << LL_ENDL;
+
+        auto pack_rot_key = [&](F32 time, const LLQuaternion& rotation)
         {
-            RotationKey& rot_key = rot_pair.second;
-            U16 time_short = F32_to_U16(rot_key.mTime, 0.f, mJointMotionList->mDuration);
+            U16 time_short = F32_to_U16(time, 0.f, mJointMotionList->mDuration);
             success &= dp.packU16(time_short, "time");
 
-            LLVector3 rot_angles = rot_key.mRotation.packToVector3();
+            LLVector3 rot_angles = rotation.packToVector3();
 
             U16 x, y, z;
             rot_angles.quantize16(-1.f, 1.f, -1.f, 1.f);
@@ -2103,26 +2318,43 @@ bool LLKeyframeMotion::serialize(LLDataPacker& dp) const
             success &= dp.packU16(y, "rot_angle_y");
             success &= dp.packU16(z, "rot_angle_z");
 
-            LL_DEBUGS("BVH") << "  rot: t " << rot_key.mTime << " angles " << rot_angles.mV[VX] <<","<< rot_angles.mV[VY] <<","<< rot_angles.mV[VZ] << LL_ENDL;
+            LL_DEBUGS("BVH") << "  rot: t " << time << " angles " << rot_angles.mV[VX] <<","<< rot_angles.mV[VY] <<","<< rot_angles.mV[VZ] << LL_ENDL;
+        };
+        for (S32 k = 0; k < rot_curve.getNumPackedKeys(); k++)
+        {
+            pack_rot_key(rot_curve.mPackedTimes[k], rot_curve.mPackedRotations[k]);
+        }
+        for (RotationCurve::key_map_t::value_type& rot_pair : joint_motionp->mRotationCurve.mKeys)
+        {
+            pack_rot_key(rot_pair.second.mTime, rot_pair.second.mRotation);
         }
 
-        success &= dp.packS32(static_cast<S32>(joint_motionp->mPositionCurve.mKeys.size()), "num_pos_keys");
-        for (PositionCurve::key_map_t::value_type& pos_pair : joint_motionp->mPositionCurve.mKeys)
+        auto pack_pos_key = [&](F32 time, LLVector3& position)
         {
-            PositionKey& pos_key = pos_pair.second;
-            U16 time_short = F32_to_U16(pos_key.mTime, 0.f, mJointMotionList->mDuration);
+            U16 time_short = F32_to_U16(time, 0.f, mJointMotionList->mDuration);
             success &= dp.packU16(time_short, "time");
 
             U16 x, y, z;
-            pos_key.mPosition.quantize16(-LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
-            x = F32_to_U16(pos_key.mPosition.mV[VX], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
-            y = F32_to_U16(pos_key.mPosition.mV[VY], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
-            z = F32_to_U16(pos_key.mPosition.mV[VZ], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+            position.quantize16(-LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+            x = F32_to_U16(position.mV[VX], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+            y = F32_to_U16(position.mV[VY], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+            z = F32_to_U16(position.mV[VZ], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
             success &= dp.packU16(x, "pos_x");
             success &= dp.packU16(y, "pos_y");
             success &= dp.packU16(z, "pos_z");
 
-            LL_DEBUGS("BVH") << "  pos: t " << pos_key.mTime << " pos " << pos_key.mPosition.mV[VX] <<","<< pos_key.mPosition.mV[VY] <<","<< pos_key.mPosition.mV[VZ] << LL_ENDL;
+            LL_DEBUGS("BVH") << "  pos: t " << time << " pos " << position.mV[VX] <<","<< position.mV[VY] <<","<< position.mV[VZ] << LL_ENDL;
+        };
+        success &= dp.packS32(num_pos_keys, "num_pos_keys");
+        for (S32 k = 0; k < pos_curve.getNumPackedKeys(); k++)
+        {
+            // packed keys are shared playback data, quantize a copy
+            LLVector3 position = pos_curve.mPackedPositions[k];
+            pack_pos_key(pos_curve.mPackedTimes[k], position);
+        }
+        for (PositionCurve::key_map_t::value_type& pos_pair : joint_motionp->mPositionCurve.mKeys)
+        {
+            pack_pos_key(pos_pair.second.mTime, pos_pair.second.mPosition);
         }
     }
 
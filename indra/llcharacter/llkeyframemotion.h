@@ -320,6 +320,8 @@ public:
 
     //-------------------------------------------------------------------------
     // ScaleCurve
+    // The animation asset format has no scale keys, so these only ever come
+    // from the pose editor and are not packed like the other curves.
     //-------------------------------------------------------------------------
     class ScaleCurve
     {
@@ -345,15 +347,30 @@ public:
     public:
         RotationCurve();
         ~RotationCurve();
-        LLQuaternion getValue(F32 time, F32 duration);
+        // cursor, if given, is the caller's playback position in this
+        // curve; it turns the key search into a step forward from the
+        // previous sample
+        LLQuaternion getValue(F32 time, F32 duration, U32* cursor = NULL);
         LLQuaternion interp(F32 u, RotationKey& before, RotationKey& after);
 
+        // Keys loaded from an asset live in the packed arrays, not in
+        // mKeys: sorted unique key times and the rotation at each, so a
+        // sample reads two neighbouring entries instead of walking a tree.
+        // expandKeys() moves them into mKeys for editing.
+        bool isPacked() const { return !mPackedTimes.empty(); }
+        S32 getNumPackedKeys() const { return (S32)mPackedTimes.size(); }
+        const LLQuaternion& getPackedRotation(S32 index) const { return mPackedRotations[index]; }
+        void expandKeys();
+        size_t getKeyMemory() const;
+
         InterpolationType   mInterpolationType;
         S32                 mNumKeys;
         typedef std::map<F32, RotationKey> key_map_t;
         key_map_t       mKeys;
         RotationKey     mLoopInKey;
         RotationKey     mLoopOutKey;
+        std::vector<F32>    mPackedTimes;
+        std::vector<LLQuaternion>   mPackedRotations;
     };
 
     //-------------------------------------------------------------------------
@@ -364,15 +381,24 @@ public:
     public:
         PositionCurve();
         ~PositionCurve();
-        LLVector3 getValue(F32 time, F32 duration);
+        LLVector3 getValue(F32 time, F32 duration, U32* cursor = NULL);
         LLVector3 interp(F32 u, PositionKey& before, PositionKey& after);
 
+        // packed asset keys, as for RotationCurve
+        bool isPacked() const { return !mPackedTimes.empty(); }
+        S32 getNumPackedKeys() const { return (S32)mPackedTimes.size(); }
+        const LLVector3& getPackedPosition(S32 index) const { return mPackedPositions[index]; }
+        void expandKeys();
+        size_t getKeyMemory() const;
+
         InterpolationType   mInterpolationType;
         S32                 mNumKeys;
         typedef std::map<F32, PositionKey> key_map_t;
         key_map_t       mKeys;
         PositionKey     mLoopInKey;
         PositionKey     mLoopOutKey;
+        std::vector<F32>    mPackedTimes;
+        std::vector<LLVector3>      mPackedPositions;
     };
 
     //-------------------------------------------------------------------------
@@ -388,7 +414,9 @@ public:
         U32             mUsage;
         LLJoint::JointPriority  mPriority;
 
-        void update(LLJointState* joint_state, F32 time, F32 duration);
+        // cursors, if given, points at this joint's two playback cursors
+        // (rotation, position), see RotationCurve::getValue()
+        void update(LLJointState* joint_state, F32 time, F32 duration, U32* cursors = NULL);
     };
 
     //-------------------------------------------------------------------------
@@ -420,6 +448,10 @@ public:
         JointMotionList();
         ~JointMotionList();
         U32 dumpDiagInfo();
+        // bytes held by the key data of all curves
+        size_t getKeyMemory() const;
+        // moves packed asset keys into the editable key maps
+        void expandKeys();
         JointMotion* getJointMotion(U32 index) const { llassert(index < mJointMotionArray.size()); return mJointMotionArray[index]; }
         U32 getNumJointMotions() const { return static_cast<U32>(mJointMotionArray.size()); }
     };
@@ -431,6 +463,7 @@ protected:
 	typedef std::list<JointConstraint*>	constraint_list_t;
 	constraint_list_t				mConstraints;
 	U32								mLastSkeletonSerialNum;
+	std::vector<U32>				mCurveCursors;
 	F32								mLastUpdateTime;
 	F32								mLastLoopedTime;
 	AssetStatus						mAssetStatus;
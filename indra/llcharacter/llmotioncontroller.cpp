@@ -140,6 +140,7 @@ LLMotionController::LLMotionController()
       mTimeStepCount(0),
       mLastInterp(0.f),
       mIsSelf(false),
+      mDeferUpdates(false),
       mLastCountAfterPurge(0)
 {
 }
@@ -503,7 +504,7 @@ void LLMotionController::updateIdleMotion(LLMotion* motionp)
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
     if (motionp->isStopped() && mAnimTime > motionp->getStopTime() + motionp->getEaseOutDuration())
     {
-        deactivateMotionInstance(motionp);
+        deactivateFromUpdate(motionp);
     }
     else if (motionp->isStopped() && mAnimTime > motionp->getStopTime())
     {
@@ -520,8 +521,7 @@ void LLMotionController::updateIdleMotion(LLMotion* motionp)
         // this will only be called when an animation stops itself (runs out of time)
         if (mLastTime <= motionp->mSendStopTimestamp)
         {
-            mCharacter->requestStopMotion( motionp );
-            stopMotionInstance(motionp, false);
+            requestStopFromUpdate(motionp);
         }
     }
     else if (mAnimTime >= motionp->mActivationTimestamp)
@@ -622,8 +622,7 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
                 // this will only be called when an animation stops itself (runs out of time)
                 if (mLastTime <= motionp->mSendStopTimestamp)
                 {
-                    mCharacter->requestStopMotion( motionp );
-                    stopMotionInstance(motionp, false);
+                    requestStopFromUpdate(motionp);
                 }
             }
 
@@ -632,7 +631,7 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
                 if (motionp->isStopped() && mAnimTime > motionp->getStopTime() + motionp->getEaseOutDuration())
                 {
                     posep->setWeight(0.f);
-                    deactivateMotionInstance(motionp);
+                    deactivateFromUpdate(motionp);
                 }
                 continue;
             }
@@ -659,7 +658,7 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
             else
             {
                 posep->setWeight(0.f);
-                deactivateMotionInstance(motionp);
+                deactivateFromUpdate(motionp);
                 continue;
             }
         }
@@ -703,8 +702,7 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
                 // this will only be called when an animation stops itself (runs out of time)
                 if (mLastTime <= motionp->mSendStopTimestamp)
                 {
-                    mCharacter->requestStopMotion( motionp );
-                    stopMotionInstance(motionp, false);
+                    requestStopFromUpdate(motionp);
                 }
             }
 
@@ -749,8 +747,7 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
                 // animation has stopped itself due to internal logic
                 // propagate this to the network
                 // as not all viewers are guaranteed to have access to the same logic
-                mCharacter->requestStopMotion( motionp );
-                stopMotionInstance(motionp, false);
+                requestStopFromUpdate(motionp);
             }
 
         }
@@ -812,6 +809,19 @@ void LLMotionController::updateLoadingMotions()
 // updateMotion()
 //-----------------------------------------------------------------------------
 void LLMotionController::updateMotions(bool force_update)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    if (beginUpdateMotions(force_update, false))
+    {
+        evaluateMotions();
+    }
+    finishUpdateMotions();
+}
+
+//-----------------------------------------------------------------------------
+// beginUpdateMotions()
+//-----------------------------------------------------------------------------
+bool LLMotionController::beginUpdateMotions(bool force_update, bool defer_side_effects)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
     // SL-763: "Distant animated objects run at super fast speed"
@@ -820,6 +830,8 @@ void LLMotionController::updateMotions(bool force_update)
     // Currently setting mTimeStep to nonzero is disabled elsewhere.
     bool use_quantum = (mTimeStep != 0.f);
 
+    mDeferUpdates = defer_side_effects;
+
     // Always update mPrevTimerElapsed
     F32 cur_time = mTimer.getElapsedTimeF32();
     F32 delta_time = cur_time - mPrevTimerElapsed;
@@ -851,7 +863,7 @@ void LLMotionController::updateMotions(bool force_update)
 
                 updateLoadingMotions();
 
-                return;
+                return false;
             }
 
             // is calculating a new keyframe pose, make sure the last one gets applied
@@ -875,31 +887,97 @@ void LLMotionController::updateMotions(bool force_update)
     if (mPaused && !force_update)
     {
         updateIdleActiveMotions();
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// evaluateMotions()
+//-----------------------------------------------------------------------------
+void LLMotionController::evaluateMotions()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    // update additive motions
+    updateAdditiveMotions();
+
+    resetJointSignatures();
+
+    // update all regular motions
+    updateRegularMotions();
+
+    if (mTimeStep != 0.f)
+    {
+        mPoseBlender.blendAndCache(true);
     }
     else
     {
-        // update additive motions
-        updateAdditiveMotions();
-
-        resetJointSignatures();
+        mPoseBlender.blendAndApply();
+    }
+}
 
-        // update all regular motions
-        updateRegularMotions();
+//-----------------------------------------------------------------------------
+// finishUpdateMotions()
+//-----------------------------------------------------------------------------
+void LLMotionController::finishUpdateMotions()
+{
+    // run what evaluateMotions() could not do off the main thread, in the
+    // order it was encountered
+    for (LLMotion* motionp : mDeferredStopRequests)
+    {
+        mCharacter->requestStopMotion(motionp);
+    }
+    mDeferredStopRequests.clear();
 
-        if (use_quantum)
-        {
-            mPoseBlender.blendAndCache(true);
-        }
-        else
+    for (LLMotion* motionp : mDeferredDeactivations)
+    {
+        if (motionp->isActive())
         {
-            mPoseBlender.blendAndApply();
+            deactivateMotionInstance(motionp);
         }
     }
+    mDeferredDeactivations.clear();
 
+    mDeferUpdates = false;
     mHasRunOnce = true;
 //  LL_INFOS() << "Motion controller time " << motionTimer.getElapsedTimeF32() << LL_ENDL;
 }
 
+//-----------------------------------------------------------------------------
+// requestStopFromUpdate()
+// notify the character that a motion has stopped itself
+//-----------------------------------------------------------------------------
+void LLMotionController::requestStopFromUpdate(LLMotion* motionp)
+{
+    if (mDeferUpdates)
+    {
+        mDeferredStopRequests.push_back(motionp);
+    }
+    else
+    {
+        mCharacter->requestStopMotion(motionp);
+    }
+    stopMotionInstance(motionp, false);
+}
+
+//-----------------------------------------------------------------------------
+// deactivateFromUpdate()
+//-----------------------------------------------------------------------------
+void LLMotionController::deactivateFromUpdate(LLMotion* motionp)
+{
+    if (mDeferUpdates)
+    {
+        // deactivation runs the motion's callbacks; leave it in the active
+        // list with zero weight until finishUpdateMotions()
+        mDeferredDeactivations.push_back(motionp);
+    }
+    else
+    {
+        deactivateMotionInstance(motionp);
+    }
+}
+
 //-----------------------------------------------------------------------------
 // updateMotionsMinimal()
 // minimal update (e.g. while hidden)
@@ -33,6 +33,7 @@
 #include <string>
 #include <map>
 #include <deque>
+#include <vector>
 
 #include "llmotion.h"
 #include "llpose.h"
@@ -131,6 +132,20 @@ public:
     // deactivates terminated motions`
     void updateMotions(bool force_update = false);
 
+    // split form of updateMotions() used to evaluate many characters at once:
+    // beginUpdateMotions() advances timing and finishes loading motions and
+    // must be called on the main thread; it returns false when there is no
+    // pose to evaluate this frame.  evaluateMotions() samples and blends the
+    // active motions and may run on a worker thread concurrently with other
+    // characters' evaluation.  Anything with side effects outside this
+    // character (stop requests, deactivation callbacks) is queued when
+    // defer_side_effects is set and run by finishUpdateMotions() back on the
+    // main thread.
+    bool beginUpdateMotions(bool force_update, bool defer_side_effects);
+    void evaluateMotions();
+    void finishUpdateMotions();
+    bool isDeferringUpdates() const { return mDeferUpdates; }
+
     // minimal update (e.g. while hidden)
     void updateMotionsMinimal();
 
@@ -187,6 +202,8 @@ protected:
     void resetJointSignatures();
     void updateMotionsByType(LLMotion::LLMotionBlendType motion_type);
     void updateIdleMotion(LLMotion* motionp);
+    void requestStopFromUpdate(LLMotion* motionp);
+    void deactivateFromUpdate(LLMotion* motionp);
     void updateIdleActiveMotions();
     void purgeExcessMotions();
     void deactivateStoppedMotions();
@@ -227,6 +244,11 @@ protected:
     F32                 mLastInterp;
 
     U8                  mJointSignature[2][LL_CHARACTER_MAX_ANIMATED_JOINTS];
+
+    // state carried between beginUpdateMotions() and finishUpdateMotions()
+    bool                mDeferUpdates;
+    std::vector<LLMotion*> mDeferredStopRequests;
+    std::vector<LLMotion*> mDeferredDeactivations;
 private:
     U32                 mLastCountAfterPurge; //for logging and debugging purposes
 };
@@ -0,0 +1,229 @@
+/**
+ * @file lljointhierarchy_test.cpp
+ * @brief Tests for flat joint world matrix updates
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../lljoint.h"
+#include "../lljointhierarchy.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // bones, collision volumes and attachment points of a full avatar
+    const S32 NUM_JOINTS = 210;
+
+    // A skeleton of mostly long chains with some branching, like the
+    // avatar's, built from a seed so two of them are the same.
+    struct TestSkeleton
+    {
+        TestSkeleton(U32 seed)
+        {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<F32> offset(-0.2f, 0.2f);
+            mRoot.setup("mRoot");
+            for (S32 i = 0; i < NUM_JOINTS; ++i)
+            {
+                LLJoint* parent = &mRoot;
+                if (i > 0)
+                {
+                    parent = (rng() % 4) ? mJoints[i - 1].get() : mJoints[rng() % i].get();
+                }
+                mJoints.emplace_back(new LLJoint());
+                mJoints.back()->setup(llformat("joint%d", i), parent);
+                mJoints.back()->setPosition(LLVector3(offset(rng), offset(rng), offset(rng)));
+                mJoints.back()->setScale(LLVector3(1.f + offset(rng), 1.f + offset(rng), 1.f + offset(rng)));
+            }
+            mRoot.updateWorldMatrixChildren();
+        }
+
+        ~TestSkeleton()
+        {
+            for (S32 i = NUM_JOINTS - 1; i >= 0; --i)
+            {
+                mJoints[i].reset();
+            }
+        }
+
+        // Rotates every stride-th joint, as a motion blending a few joints
+        // does; stride 1 moves all of them.
+        void animate(U32 frame, U32 stride)
+        {
+            for (U32 i = frame % stride; i < (U32)NUM_JOINTS; i += stride)
+            {
+                F32 angle = 0.01f * (F32)(frame + i);
+                mJoints[i]->setRotation(LLQuaternion(angle, LLVector3(0.3f, 0.4f, 0.866f)));
+            }
+        }
+
+        LLJoint mRoot;
+        std::vector<std::unique_ptr<LLJoint> > mJoints;
+    };
+
+    bool same_world_matrices(TestSkeleton& a, TestSkeleton& b, std::string& failure)
+    {
+        for (S32 i = 0; i < NUM_JOINTS; ++i)
+        {
+            if (memcmp(a.mJoints[i]->getXform()->getWorldMatrix().mMatrix, b.mJoints[i]->getXform()->getWorldMatrix().mMatrix, sizeof(F32) * 16))
+            {
+                failure = llformat("joint %d world matrix", i);
+                return false;
+            }
+            if (a.mJoints[i]->mDirtyFlags != b.mJoints[i]->mDirtyFlags)
+            {
+                failure = llformat("joint %d dirty flags", i);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+namespace tut
+{
+    struct jointhierarchy_data
+    {
+    };
+    typedef test_group<jointhierarchy_data> jointhierarchy_group;
+    typedef jointhierarchy_group::object jointhierarchy_object;
+    tut::jointhierarchy_group jointhierarchy_test("LLJointHierarchy");
+
+    template<> template<>
+    void jointhierarchy_object::test<1>()
+    {
+        set_test_name("flat pass matches updateWorldMatrixChildren");
+        TestSkeleton recursive(1);
+        TestSkeleton flat(1);
+        LLJointHierarchy hierarchy;
+        ensure_equals("nothing dirty after setup", hierarchy.updateWorldMatrices(&flat.mRoot), 0U);
+        ensure_equals("joints", hierarchy.getNumJoints(), (U32)NUM_JOINTS + 1);
+        for (U32 i = 1; i < hierarchy.getNumJoints(); ++i)
+        {
+            ensure("parents come first", hierarchy.getParentIndex(i) >= 0 && hierarchy.getParentIndex(i) < (S32)i);
+            ensure("parent index", hierarchy.getJoint(hierarchy.getParentIndex(i)) == hierarchy.getJoint(i)->getParent());
+        }
+
+        for (U32 frame = 0; frame < 20; ++frame)
+        {
+            U32 stride = 1 + frame % 7;
+            recursive.animate(frame, stride);
+            flat.animate(frame, stride);
+            // position changes on a chain too
+            recursive.mJoints[frame * 3]->setPosition(LLVector3(0.f, 0.1f * frame, 0.f));
+            flat.mJoints[frame * 3]->setPosition(LLVector3(0.f, 0.1f * frame, 0.f));
+
+            S32 updates_before = LLJoint::sNumUpdates.CurrentValue();
+            recursive.mRoot.updateWorldMatrixChildren();
+            S32 recursive_updates = LLJoint::sNumUpdates.CurrentValue() - updates_before;
+
+            U32 flat_updates = hierarchy.updateWorldMatrices(&flat.mRoot);
+            ensure_equals(llformat("frame %u updates", frame), (S32)flat_updates, recursive_updates);
+
+            std::string failure;
+            bool same = same_world_matrices(recursive, flat, failure);
+            ensure(llformat("frame %u %s", frame, failure.c_str()), same);
+        }
+    }
+
+    template<> template<>
+    void jointhierarchy_object::test<2>()
+    {
+        set_test_name("joints without xform updates skip their subtree");
+        TestSkeleton recursive(2);
+        TestSkeleton flat(2);
+        LLJointHierarchy hierarchy;
+        hierarchy.updateWorldMatrices(&flat.mRoot);
+
+        for (TestSkeleton* skeleton : { &recursive, &flat })
+        {
+            skeleton->mJoints[5]->mUpdateXform = false;
+            skeleton->animate(0, 1);
+        }
+        recursive.mRoot.updateWorldMatrixChildren();
+        hierarchy.updateWorldMatrices(&flat.mRoot);
+
+        std::string failure;
+        bool same = same_world_matrices(recursive, flat, failure);
+        ensure(failure, same);
+        ensure("skipped joint still dirty", flat.mJoints[5]->mDirtyFlags & LLJoint::MATRIX_DIRTY);
+    }
+
+    template<> template<>
+    void jointhierarchy_object::test<3>()
+    {
+        set_test_name("adding and removing joints rebuilds the array");
+        TestSkeleton skeleton(3);
+        LLJointHierarchy hierarchy;
+        hierarchy.updateWorldMatrices(&skeleton.mRoot);
+        ensure_equals("initial joints", hierarchy.getNumJoints(), (U32)NUM_JOINTS + 1);
+
+        std::unique_ptr<LLJoint> attachment(new LLJoint());
+        attachment->setup("attachment", skeleton.mJoints[10].get());
+        attachment->setPosition(LLVector3(0.f, 0.f, 0.5f));
+        ensure_equals("new joint updated", hierarchy.updateWorldMatrices(&skeleton.mRoot), 1U);
+        ensure_equals("joint added", hierarchy.getNumJoints(), (U32)NUM_JOINTS + 2);
+
+        // joints scale their children's offsets
+        LLVector3 offset(0.f, 0.f, 0.5f);
+        offset.scaleVec(skeleton.mJoints[10]->getScale());
+        LLVector3 expected = skeleton.mJoints[10]->getWorldPosition() + offset * skeleton.mJoints[10]->getWorldRotation();
+        ensure("attachment world position", dist_vec(attachment->getXform()->getWorldPosition(), expected) < 1.0e-4f);
+
+        attachment.reset();
+        hierarchy.updateWorldMatrices(&skeleton.mRoot);
+        ensure_equals("joint removed", hierarchy.getNumJoints(), (U32)NUM_JOINTS + 1);
+
+        LLJointHierarchy other;
+        other.updateWorldMatrices(skeleton.mJoints[0].get());
+        ensure("subtree", other.getNumJoints() < hierarchy.getNumJoints() && other.getJoint(0) == skeleton.mJoints[0].get());
+    }
+
+    template<> template<>
+    void jointhierarchy_object::test<4>()
+    {
+        set_test_name("only dirty joints are recomputed, as by the recursion");
+        TestSkeleton recursive(5);
+        TestSkeleton flat(5);
+        LLJointHierarchy hierarchy;
+        hierarchy.updateWorldMatrices(&flat.mRoot);
+
+        // flagged without touch(), the children are not dirty
+        for (TestSkeleton* skeleton : { &recursive, &flat })
+        {
+            skeleton->mJoints[20]->getXform()->setPosition(LLVector3(0.f, 0.f, 0.3f));
+            skeleton->mJoints[20]->mDirtyFlags |= LLJoint::MATRIX_DIRTY;
+        }
+        recursive.mRoot.updateWorldMatrixChildren();
+        ensure_equals("one joint updated", hierarchy.updateWorldMatrices(&flat.mRoot), 1U);
+
+        std::string failure;
+        bool same = same_world_matrices(recursive, flat, failure);
+        ensure(failure, same);
+    }
+}
@@ -0,0 +1,387 @@
+/**
+ * @file llcharacter/tests/llkeyframemotion_test.cpp
+ * @brief Tests for packed LLKeyframeMotion curves
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llcharacter.h"
+#include "../llkeyframemotion.h"
+#include "lldatapacker.h"
+#include "llframetimer.h"
+#include "llquantize.h"
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+namespace
+{
+    // Headless character that makes up a joint for every name it is asked
+    // about, so that any animation loads with all of its curves.
+    class TestCharacter : public LLCharacter
+    {
+    public:
+        TestCharacter()
+        :   mRoot("mRoot")
+        {
+        }
+
+        ~TestCharacter()
+        {
+            flushAllMotions();
+        }
+
+        LLJoint* getJoint(std::string_view name) override
+        {
+            std::string key(name);
+            std::unique_ptr<LLJoint>& joint = mJoints[key];
+            if (!joint)
+            {
+                joint.reset(new LLJoint(key, &mRoot));
+                joint->setJointNum((S32) (mJoints.size() - 1) % LL_CHARACTER_MAX_ANIMATED_JOINTS);
+            }
+            return joint.get();
+        }
+
+        const char* getAnimationPrefix() override { return "avatar"; }
+        LLJoint* getRootJoint() override { return &mRoot; }
+        LLVector3 getCharacterPosition() override { return LLVector3::zero; }
+        LLQuaternion getCharacterRotation() override { return LLQuaternion::DEFAULT; }
+        LLVector3 getCharacterVelocity() override { return LLVector3::zero; }
+        LLVector3 getCharacterAngularVelocity() override { return LLVector3::zero; }
+        void getGround(const LLVector3& in_pos, LLVector3& out_pos, LLVector3& out_norm) override
+        {
+            out_pos.set(in_pos.mV[VX], in_pos.mV[VY], 0.f);
+            out_norm.set(0.f, 0.f, 1.f);
+        }
+        LLJoint* getCharacterJoint(U32 i) override { return NULL; }
+        F32 getTimeDilation() override { return 1.f; }
+        F32 getPixelArea() const override { return 100000.f; }
+        LLPolyMesh* getHeadMesh() override { return NULL; }
+        LLPolyMesh* getUpperBodyMesh() override { return NULL; }
+        LLVector3d getPosGlobalFromAgent(const LLVector3& position) override { return LLVector3d(position); }
+        LLVector3 getPosAgentFromGlobal(const LLVector3d& position) override { return LLVector3(position); }
+        void addDebugText(const std::string& text) override {}
+        const LLUUID& getID() const override { return LLUUID::null; }
+
+        LLJoint mRoot;
+        std::map<std::string, std::unique_ptr<LLJoint>> mJoints;
+    };
+
+    // A keyframe animation in the asset format with num_keys rotation keys
+    // on each joint and position keys on the first.  With duplicate_keys
+    // every key is written twice, the second time with a different value;
+    // with reversed the keys are written last to first.
+    std::vector<U8> make_anim(F32 duration, S32 num_joints, S32 num_keys, F32 phase,
+                              bool duplicate_keys = false, bool reversed = false)
+    {
+        const S32 copies = duplicate_keys ? 2 : 1;
+        std::vector<U8> buffer(128 + num_joints * (64 + num_keys * copies * 16));
+        LLDataPackerBinaryBuffer dp(buffer.data(), (S32) buffer.size());
+        dp.packU16(KEYFRAME_MOTION_VERSION, "version");
+        dp.packU16(KEYFRAME_MOTION_SUBVERSION, "sub_version");
+        dp.packS32(LLJoint::MEDIUM_PRIORITY, "base_priority");
+        dp.packF32(duration, "duration");
+        dp.packString("", "emote_name");
+        dp.packF32(0.f, "loop_in_point");
+        dp.packF32(duration, "loop_out_point");
+        dp.packS32(1, "loop");
+        dp.packF32(0.1f, "ease_in_duration");
+        dp.packF32(0.1f, "ease_out_duration");
+        dp.packU32(0, "hand_pose");
+        dp.packU32(num_joints, "num_joints");
+        for (S32 j = 0; j < num_joints; ++j)
+        {
+            dp.packString(llformat("mJoint%d", j), "joint_name");
+            dp.packS32(LLJoint::USE_MOTION_PRIORITY, "joint_priority");
+            dp.packS32(num_keys * copies, "num_rot_keys");
+            for (S32 i = 0; i < num_keys; ++i)
+            {
+                S32 k = reversed ? num_keys - 1 - i : i;
+                F32 t = (F32) k / (num_keys - 1);
+                for (S32 c = 0; c < copies; ++c)
+                {
+                    dp.packU16(F32_to_U16(t * duration, 0.f, duration), "time");
+                    F32 angle = 0.3f * sinf(phase + F_TWO_PI * t + (F32) j) + 0.1f * c;
+                    dp.packU16(F32_to_U16(angle, -1.f, 1.f), "rot_angle_x");
+                    dp.packU16(F32_to_U16(0.5f * angle, -1.f, 1.f), "rot_angle_y");
+                    dp.packU16(F32_to_U16(-angle, -1.f, 1.f), "rot_angle_z");
+                }
+            }
+            S32 num_pos_keys = (j == 0) ? num_keys : 0;
+            dp.packS32(num_pos_keys * copies, "num_pos_keys");
+            for (S32 i = 0; i < num_pos_keys; ++i)
+            {
+                S32 k = reversed ? num_keys - 1 - i : i;
+                F32 t = (F32) k / (num_keys - 1);
+                for (S32 c = 0; c < copies; ++c)
+                {
+                    dp.packU16(F32_to_U16(t * duration, 0.f, duration), "time");
+                    dp.packU16(F32_to_U16(0.1f * sinf(F_TWO_PI * t) + 0.1f * c, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET), "pos_x");
+                    dp.packU16(F32_to_U16(0.f, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET), "pos_y");
+                    dp.packU16(F32_to_U16(0.05f * cosf(F_TWO_PI * t), -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET), "pos_z");
+                }
+            }
+        }
+        dp.packS32(0, "num_constraints");
+        buffer.resize(dp.getCurrentSize());
+        return buffer;
+    }
+
+    typedef std::unique_ptr<LLKeyframeMotion> motion_ptr_t;
+
+    // Parses an animation; with expand the keys are moved back into the
+    // per curve maps, as the pose editor does.
+    motion_ptr_t load_motion(TestCharacter& character, const std::vector<U8>& data, bool expand)
+    {
+        motion_ptr_t motion(new LLKeyframeMotion(LLUUID::generateNewID()));
+        motion->setCharacter(&character);
+        LLDataPackerBinaryBuffer dp(const_cast<U8*>(data.data()), (S32) data.size());
+        if (!motion->deserialize(dp, motion->getID()))
+        {
+            return motion_ptr_t();
+        }
+        if (expand)
+        {
+            motion->getJointMotionList()->expandKeys();
+        }
+        return motion;
+    }
+
+    // Animation assets to measure: files from $LL_ANIM_CORPUS if set,
+    // otherwise synthetic ones.
+    std::vector<std::vector<U8>> load_corpus()
+    {
+        std::vector<std::vector<U8>> anims;
+        const char* corpus = getenv("LL_ANIM_CORPUS");
+        if (corpus)
+        {
+            boost::filesystem::path dir(corpus);
+            for (boost::filesystem::directory_iterator it(dir), end; it != end; ++it)
+            {
+                if (it->path().extension() == ".anim")
+                {
+                    std::ifstream in(it->path().string(), std::ios::binary);
+                    anims.emplace_back((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+                }
+            }
+        }
+        if (anims.empty())
+        {
+            for (S32 i = 0; i < 8; ++i)
+            {
+                anims.push_back(make_anim(1.f + 0.75f * i, 20 + 4 * i, 10 + 15 * i, (F32) i));
+            }
+        }
+        return anims;
+    }
+
+    // Not sized with getFileSize(): serializing keyed maps quantizes their
+    // positions in place, so measuring first would quantize them twice.
+    std::vector<U8> serialize_motion(LLKeyframeMotion& motion, size_t max_size)
+    {
+        std::vector<U8> buffer(max_size);
+        LLDataPackerBinaryBuffer dp(buffer.data(), (S32) buffer.size());
+        if (!motion.serialize(dp))
+        {
+            buffer.clear();
+        }
+        buffer.resize(dp.getCurrentSize());
+        return buffer;
+    }
+
+    // Samples every curve of two loaded copies of an animation at the given
+    // times and reports the first difference.
+    std::string compare_samples(LLKeyframeMotion& packed, LLKeyframeMotion& expanded,
+                                const std::vector<F32>& times, bool use_cursor)
+    {
+        LLKeyframeMotion::JointMotionList* packed_list = packed.getJointMotionList();
+        LLKeyframeMotion::JointMotionList* expanded_list = expanded.getJointMotionList();
+        const F32 duration = packed_list->mDuration;
+        for (U32 j = 0; j < packed_list->getNumJointMotions(); ++j)
+        {
+            LLKeyframeMotion::JointMotion* a = packed_list->getJointMotion(j);
+            LLKeyframeMotion::JointMotion* b = expanded_list->getJointMotion(j);
+            U32 cursors[2] = { 0, 0 };
+            for (F32 time : times)
+            {
+                LLQuaternion rot_a = a->mRotationCurve.getValue(time, duration, use_cursor ? &cursors[0] : NULL);
+                LLQuaternion rot_b = b->mRotationCurve.getValue(time, duration);
+                if (memcmp(rot_a.mQ, rot_b.mQ, sizeof(rot_a.mQ)) != 0)
+                {
+                    return llformat("rotation of %s at %f", a->mJointName.c_str(), time);
+                }
+                LLVector3 pos_a = a->mPositionCurve.getValue(time, duration, use_cursor ? &cursors[1] : NULL);
+                LLVector3 pos_b = b->mPositionCurve.getValue(time, duration);
+                if (memcmp(pos_a.mV, pos_b.mV, sizeof(pos_a.mV)) != 0)
+                {
+                    return llformat("position of %s at %f", a->mJointName.c_str(), time);
+                }
+            }
+        }
+        return std::string();
+    }
+
+    // Frame times of a few loops of playback at 60fps.
+    std::vector<F32> playback_times(F32 duration, S32 loops)
+    {
+        std::vector<F32> times;
+        for (F32 t = 0.f; t < duration * loops; t += 1.f / 60.f)
+        {
+            times.push_back(fmodf(t, duration));
+        }
+        return times;
+    }
+}
+
+namespace tut
+{
+    struct keyframe_motion_data
+    {
+        keyframe_motion_data()
+        {
+            LLFrameTimer::updateFrameTime();
+        }
+
+        ~keyframe_motion_data()
+        {
+            LLKeyframeDataCache::clear();
+        }
+
+        TestCharacter mCharacter;
+    };
+    typedef test_group<keyframe_motion_data> keyframe_motion_group;
+    typedef keyframe_motion_group::object keyframe_motion_object;
+    tut::keyframe_motion_group keyframe_motion_test("LLKeyframeMotion");
+
+    template<> template<>
+    void keyframe_motion_object::test<1>()
+    {
+        set_test_name("packed curves sample exactly as keyed maps");
+        std::vector<std::vector<U8>> anims = load_corpus();
+        anims.push_back(make_anim(2.f, 3, 12, 0.f, true, false));
+        anims.push_back(make_anim(2.f, 3, 12, 0.f, false, true));
+        anims.push_back(make_anim(2.f, 3, 1, 0.f));
+
+        std::mt19937 rng(1234);
+        S32 compared = 0;
+        for (const std::vector<U8>& data : anims)
+        {
+            motion_ptr_t packed = load_motion(mCharacter, data, false);
+            motion_ptr_t expanded = load_motion(mCharacter, data, true);
+            if (!packed)
+            {
+                continue;
+            }
+            ensure("expanded copy loads", (bool) expanded);
+            const F32 duration = packed->getJointMotionList()->mDuration;
+
+            // playback with the cursor, including wrapping round the loop
+            std::vector<F32> times = playback_times(duration, 3);
+            times.push_back(-1.f);
+            times.push_back(duration + 1.f);
+            std::string failure = compare_samples(*packed, *expanded, times, true);
+            ensure(failure, failure.empty());
+
+            // seeking about with and without the cursor
+            std::uniform_real_distribution<F32> any_time(0.f, duration);
+            for (F32& time : times)
+            {
+                time = any_time(rng);
+            }
+            failure = compare_samples(*packed, *expanded, times, true);
+            ensure(failure, failure.empty());
+            failure = compare_samples(*packed, *expanded, times, false);
+            ensure(failure, failure.empty());
+            ++compared;
+        }
+        ensure("animations compared", compared > 0);
+    }
+
+    template<> template<>
+    void keyframe_motion_object::test<2>()
+    {
+        set_test_name("duplicated and unordered keys");
+        // a map keyed by time keeps the last key read at each time, in order
+        std::vector<U8> data = make_anim(2.f, 2, 8, 0.f, true, true);
+        motion_ptr_t packed = load_motion(mCharacter, data, false);
+        ensure("loaded", (bool) packed);
+        LLKeyframeMotion::JointMotion* joint_motion = packed->getJointMotionList()->getJointMotion(0);
+        ensure_equals("keys read", joint_motion->mRotationCurve.mNumKeys, 16);
+        ensure_equals("rotation keys kept", joint_motion->mRotationCurve.getNumPackedKeys(), 8);
+        ensure_equals("position keys kept", joint_motion->mPositionCurve.getNumPackedKeys(), 8);
+        for (S32 k = 1; k < 8; ++k)
+        {
+            ensure("rotation keys sorted", joint_motion->mRotationCurve.mPackedTimes[k - 1] < joint_motion->mRotationCurve.mPackedTimes[k]);
+        }
+        ensure_equals("last written value kept",
+                      joint_motion->mPositionCurve.getPackedPosition(0).mV[VX],
+                      U16_to_F32(F32_to_U16(0.1f, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET), -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET));
+    }
+
+    template<> template<>
+    void keyframe_motion_object::test<3>()
+    {
+        set_test_name("packed curves serialize as keyed maps do");
+        std::vector<U8> data = make_anim(3.f, 6, 40, 1.f);
+        motion_ptr_t packed = load_motion(mCharacter, data, false);
+        motion_ptr_t expanded = load_motion(mCharacter, data, true);
+        ensure("loaded", packed && expanded);
+        std::vector<U8> packed_saved = serialize_motion(*packed, data.size() * 2);
+        std::vector<U8> expanded_saved = serialize_motion(*expanded, data.size() * 2);
+        ensure("serialized", !packed_saved.empty());
+        ensure_equals("size", packed_saved.size(), expanded_saved.size());
+        ensure("bytes", memcmp(packed_saved.data(), expanded_saved.data(), packed_saved.size()) == 0);
+
+        // saving leaves the shared playback data as it was
+        std::vector<U8> saved_again = serialize_motion(*packed, data.size() * 2);
+        ensure("saved twice", packed_saved == saved_again);
+    }
+
+    template<> template<>
+    void keyframe_motion_object::test<4>()
+    {
+        set_test_name("packed curves take less key memory than keyed maps");
+        std::vector<std::vector<U8>> anims = load_corpus();
+        size_t packed_bytes = 0;
+        size_t expanded_bytes = 0;
+        for (const std::vector<U8>& data : anims)
+        {
+            motion_ptr_t packed = load_motion(mCharacter, data, false);
+            if (packed)
+            {
+                motion_ptr_t expanded = load_motion(mCharacter, data, true);
+                packed_bytes += packed->getJointMotionList()->getKeyMemory();
+                expanded_bytes += expanded->getJointMotionList()->getKeyMemory();
+            }
+        }
+        ensure("animations loaded", expanded_bytes > 0);
+        ensure("packed is smaller", packed_bytes < expanded_bytes);
+    }
+}
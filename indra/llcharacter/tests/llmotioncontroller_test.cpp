@@ -0,0 +1,380 @@
+/**
+ * @file llcharacter/tests/llmotioncontroller_test.cpp
+ * @brief Tests for batched LLCharacter motion evaluation
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llcharacter.h"
+#include "../llkeyframemotion.h"
+#include "lldatapacker.h"
+#include "llframetimer.h"
+#include "llquantize.h"
+#include "threadpool.h"
+
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+namespace
+{
+    // joint name, parent index, offset from parent
+    struct JointDesc
+    {
+        const char* mName;
+        S32 mParent;
+        F32 mOffset[3];
+    };
+
+    const JointDesc SKELETON[] =
+    {
+        { "mPelvis",        -1, { 0.f,    0.f,    1.067f } },
+        { "mTorso",          0, { 0.f,    0.f,    0.084f } },
+        { "mChest",          1, { -0.015f, 0.f,   0.205f } },
+        { "mNeck",           2, { -0.01f, 0.f,    0.251f } },
+        { "mHead",           3, { 0.f,    0.f,    0.076f } },
+        { "mSkull",          4, { 0.f,    0.f,    0.079f } },
+        { "mEyeRight",       4, { 0.098f, -0.036f, 0.079f } },
+        { "mEyeLeft",        4, { 0.098f, 0.036f, 0.079f } },
+        { "mCollarLeft",     2, { -0.021f, 0.085f, 0.165f } },
+        { "mShoulderLeft",   8, { 0.f,    0.079f, 0.f } },
+        { "mElbowLeft",      9, { 0.f,    0.248f, 0.f } },
+        { "mWristLeft",     10, { 0.f,    0.205f, 0.f } },
+        { "mCollarRight",    2, { -0.021f, -0.085f, 0.165f } },
+        { "mShoulderRight", 12, { 0.f,    -0.079f, 0.f } },
+        { "mElbowRight",    13, { 0.f,    -0.248f, 0.f } },
+        { "mWristRight",    14, { 0.f,    -0.205f, 0.f } },
+        { "mHipRight",       0, { 0.034f, -0.129f, -0.041f } },
+        { "mKneeRight",     16, { -0.001f, 0.049f, -0.491f } },
+        { "mAnkleRight",    17, { -0.029f, 0.f,   -0.468f } },
+        { "mFootRight",     18, { 0.112f, 0.f,    -0.061f } },
+        { "mToeRight",      19, { 0.109f, 0.f,    0.f } },
+        { "mHipLeft",        0, { 0.034f, 0.127f, -0.041f } },
+        { "mKneeLeft",      21, { -0.001f, -0.046f, -0.491f } },
+        { "mAnkleLeft",     22, { -0.029f, 0.001f, -0.468f } },
+        { "mFootLeft",      23, { 0.112f, 0.f,    -0.061f } },
+        { "mToeLeft",       24, { 0.109f, 0.f,    0.f } },
+    };
+    const S32 NUM_JOINTS = LL_ARRAY_SIZE(SKELETON);
+
+    // Minimal headless character: a system-avatar shaped skeleton, no
+    // meshes or visual parameters, flat ground at z = 0.
+    class TestCharacter : public LLCharacter
+    {
+    public:
+        TestCharacter(const LLUUID& id)
+        :   mID(id),
+            mRoot("mRoot"),
+            mStopRequests(0)
+        {
+            for (S32 i = 0; i < NUM_JOINTS; ++i)
+            {
+                const JointDesc& desc = SKELETON[i];
+                LLJoint* parent = desc.mParent < 0 ? &mRoot : mJoints[desc.mParent].get();
+                mJoints.emplace_back(new LLJoint(desc.mName, parent));
+                mJoints.back()->setJointNum(i);
+                mJoints.back()->setPosition(LLVector3(desc.mOffset));
+            }
+            mRoot.updateWorldMatrixChildren();
+        }
+
+        ~TestCharacter()
+        {
+            // joints go before the motions that reference them
+            flushAllMotions();
+            for (S32 i = NUM_JOINTS - 1; i >= 0; --i)
+            {
+                mJoints[i].reset();
+            }
+        }
+
+        const char* getAnimationPrefix() override { return "avatar"; }
+        LLJoint* getRootJoint() override { return &mRoot; }
+        LLVector3 getCharacterPosition() override { return LLVector3::zero; }
+        LLQuaternion getCharacterRotation() override { return LLQuaternion::DEFAULT; }
+        LLVector3 getCharacterVelocity() override { return LLVector3::zero; }
+        LLVector3 getCharacterAngularVelocity() override { return LLVector3::zero; }
+        void getGround(const LLVector3& in_pos, LLVector3& out_pos, LLVector3& out_norm) override
+        {
+            out_pos.set(in_pos.mV[VX], in_pos.mV[VY], 0.f);
+            out_norm.set(0.f, 0.f, 1.f);
+        }
+        LLJoint* getCharacterJoint(U32 i) override
+        {
+            return i < (U32) NUM_JOINTS ? mJoints[i].get() : NULL;
+        }
+        F32 getTimeDilation() override { return 1.f; }
+        F32 getPixelArea() const override { return 100000.f; }
+        LLPolyMesh* getHeadMesh() override { return NULL; }
+        LLPolyMesh* getUpperBodyMesh() override { return NULL; }
+        LLVector3d getPosGlobalFromAgent(const LLVector3& position) override { return LLVector3d(position); }
+        LLVector3 getPosAgentFromGlobal(const LLVector3d& position) override { return LLVector3(position); }
+        void addDebugText(const std::string& text) override {}
+        const LLUUID& getID() const override { return mID; }
+        void requestStopMotion(LLMotion* motion) override { ++mStopRequests; }
+
+        LLUUID mID;
+        LLJoint mRoot;
+        std::vector<std::unique_ptr<LLJoint>> mJoints;
+        S32 mStopRequests;
+    };
+
+    // A keyframe animation in the asset format, with num_keys rotation keys
+    // on each of the first num_joints joints and a swaying pelvis.
+    std::vector<U8> make_anim(F32 duration, bool loop, S32 num_joints, S32 num_keys, F32 phase)
+    {
+        std::vector<U8> buffer(128 + num_joints * (64 + num_keys * 16));
+        LLDataPackerBinaryBuffer dp(buffer.data(), (S32) buffer.size());
+        dp.packU16(KEYFRAME_MOTION_VERSION, "version");
+        dp.packU16(KEYFRAME_MOTION_SUBVERSION, "sub_version");
+        dp.packS32(LLJoint::MEDIUM_PRIORITY, "base_priority");
+        dp.packF32(duration, "duration");
+        dp.packString("", "emote_name");
+        dp.packF32(0.f, "loop_in_point");
+        dp.packF32(duration, "loop_out_point");
+        dp.packS32(loop ? 1 : 0, "loop");
+        dp.packF32(0.1f, "ease_in_duration");
+        dp.packF32(0.1f, "ease_out_duration");
+        dp.packU32(0, "hand_pose");
+        dp.packU32(num_joints, "num_joints");
+        for (S32 j = 0; j < num_joints; ++j)
+        {
+            dp.packString(SKELETON[j].mName, "joint_name");
+            dp.packS32(LLJoint::USE_MOTION_PRIORITY, "joint_priority");
+            dp.packS32(num_keys, "num_rot_keys");
+            for (S32 k = 0; k < num_keys; ++k)
+            {
+                F32 t = (F32) k / (num_keys - 1);
+                dp.packU16(F32_to_U16(t * duration, 0.f, duration), "time");
+                F32 angle = 0.3f * sinf(phase + F_TWO_PI * t + (F32) j);
+                dp.packU16(F32_to_U16(angle, -1.f, 1.f), "rot_angle_x");
+                dp.packU16(F32_to_U16(0.5f * angle, -1.f, 1.f), "rot_angle_y");
+                dp.packU16(F32_to_U16(-angle, -1.f, 1.f), "rot_angle_z");
+            }
+            S32 num_pos_keys = (j == 0) ? num_keys : 0;
+            dp.packS32(num_pos_keys, "num_pos_keys");
+            for (S32 k = 0; k < num_pos_keys; ++k)
+            {
+                F32 t = (F32) k / (num_keys - 1);
+                dp.packU16(F32_to_U16(t * duration, 0.f, duration), "time");
+                dp.packU16(F32_to_U16(0.1f * sinf(F_TWO_PI * t), -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET), "pos_x");
+                dp.packU16(F32_to_U16(0.f, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET), "pos_y");
+                dp.packU16(F32_to_U16(0.05f * cosf(F_TWO_PI * t), -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET), "pos_z");
+            }
+        }
+        dp.packS32(0, "num_constraints");
+        buffer.resize(dp.getCurrentSize());
+        return buffer;
+    }
+
+    // Parses an animation into the shared keyframe cache, where every
+    // character's LLKeyframeMotion::onInitialize() finds it without an
+    // asset fetch.
+    bool cache_anim(TestCharacter& character, const LLUUID& id, std::vector<U8>& data)
+    {
+        LLKeyframeMotion loader(id);
+        loader.setCharacter(&character);
+        LLDataPackerBinaryBuffer dp(data.data(), (S32) data.size());
+        return loader.deserialize(dp, id);
+    }
+
+    // Looping animations to play: files from $LL_ANIM_CORPUS if set,
+    // otherwise synthetic ones.
+    std::vector<LLUUID> load_anims(TestCharacter& character)
+    {
+        std::vector<LLUUID> ids;
+        const char* corpus = getenv("LL_ANIM_CORPUS");
+        if (corpus)
+        {
+            boost::filesystem::path dir(corpus);
+            for (boost::filesystem::directory_iterator it(dir), end; it != end; ++it)
+            {
+                if (it->path().extension() != ".anim")
+                {
+                    continue;
+                }
+                std::ifstream in(it->path().string(), std::ios::binary);
+                std::vector<U8> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+                LLUUID id;
+                id.generate(it->path().filename().string());
+                if (!data.empty() && cache_anim(character, id, data))
+                {
+                    ids.push_back(id);
+                }
+            }
+        }
+        if (ids.empty())
+        {
+            for (S32 i = 0; i < 6; ++i)
+            {
+                std::vector<U8> data = make_anim(2.f + 0.5f * i, true, NUM_JOINTS - 2 * i, 30, (F32) i);
+                LLUUID id;
+                id.generate(llformat("synthetic anim %d", i));
+                if (cache_anim(character, id, data))
+                {
+                    ids.push_back(id);
+                }
+            }
+        }
+        return ids;
+    }
+
+    typedef std::vector<std::unique_ptr<TestCharacter>> characters_t;
+
+    characters_t make_characters(S32 count, const std::vector<LLUUID>& anims, S32 anims_each)
+    {
+        characters_t characters;
+        for (S32 i = 0; i < count; ++i)
+        {
+            characters.emplace_back(new TestCharacter(LLUUID::generateNewID(llformat("character %d", i))));
+            for (S32 a = 0; a < anims_each; ++a)
+            {
+                characters.back()->startMotion(anims[(i + a) % anims.size()]);
+            }
+        }
+        return characters;
+    }
+
+    // One frame through the batched path
+    void update_batched(characters_t& characters, LL::ThreadPoolBase* pool)
+    {
+        std::vector<LLCharacter*> evaluate;
+        for (auto& character : characters)
+        {
+            if (character->beginUpdateMotions(LLCharacter::NORMAL_UPDATE, true))
+            {
+                evaluate.push_back(character.get());
+            }
+        }
+        LLCharacter::evaluateMotions(evaluate, pool);
+        for (auto& character : characters)
+        {
+            character->finishUpdateMotions();
+        }
+    }
+
+    void update_serial(characters_t& characters)
+    {
+        for (auto& character : characters)
+        {
+            character->updateMotions(LLCharacter::NORMAL_UPDATE);
+            character->getRootJoint()->updateWorldMatrixChildren();
+        }
+    }
+}
+
+namespace tut
+{
+    struct motion_controller_data
+    {
+        motion_controller_data()
+        {
+            LLFrameTimer::updateFrameTime();
+        }
+
+        ~motion_controller_data()
+        {
+            LLKeyframeDataCache::clear();
+        }
+    };
+    typedef test_group<motion_controller_data> motion_controller_group;
+    typedef motion_controller_group::object motion_controller_object;
+    tut::motion_controller_group motion_controller_test("LLMotionController");
+
+    template<> template<>
+    void motion_controller_object::test<1>()
+    {
+        set_test_name("batched evaluation matches updateMotions()");
+        TestCharacter loader(LLUUID::generateNewID("loader"));
+        std::vector<LLUUID> anims = load_anims(loader);
+        ensure("animations loaded", !anims.empty());
+
+        // created in the same frame, so both sets see identical timers
+        characters_t serial = make_characters(8, anims, 3);
+        characters_t batched = make_characters(8, anims, 3);
+        LL::ThreadPool pool("LLMotionController test", 3);
+        pool.start();
+
+        for (S32 frame = 0; frame < 20; ++frame)
+        {
+            LLFrameTimer::updateFrameTime();
+            update_serial(serial);
+            update_batched(batched, &pool);
+            for (size_t c = 0; c < serial.size(); ++c)
+            {
+                for (S32 j = 0; j < NUM_JOINTS; ++j)
+                {
+                    const LLMatrix4& a = serial[c]->mJoints[j]->getWorldMatrix();
+                    const LLMatrix4& b = batched[c]->mJoints[j]->getWorldMatrix();
+                    ensure(llformat("frame %d character %u joint %s", frame, (U32) c, SKELETON[j].mName),
+                           memcmp(a.mMatrix, b.mMatrix, sizeof(a.mMatrix)) == 0);
+                }
+            }
+            ms_sleep(2);
+        }
+    }
+
+    template<> template<>
+    void motion_controller_object::test<2>()
+    {
+        set_test_name("stop requests wait for finishUpdateMotions()");
+        TestCharacter character(LLUUID::generateNewID("stopping"));
+        std::vector<U8> data = make_anim(0.2f, false, 4, 5, 0.f);
+        LLUUID id = LLUUID::generateNewID("one shot");
+        ensure("animation loaded", cache_anim(character, id, data));
+
+        character.setAnimTimeFactor(10.f);
+        character.startMotion(id);
+        std::vector<LLCharacter*> evaluate(1, &character);
+        for (S32 frame = 0; frame < 500 && character.mStopRequests == 0; ++frame)
+        {
+            ms_sleep(2);
+            LLFrameTimer::updateFrameTime();
+            bool needs_evaluate = character.beginUpdateMotions(LLCharacter::NORMAL_UPDATE, true);
+            if (needs_evaluate)
+            {
+                LLCharacter::evaluateMotions(evaluate, NULL);
+            }
+            ensure_equals("no stop request during evaluation", character.mStopRequests, 0);
+            character.finishUpdateMotions();
+        }
+        ensure_equals("one stop request", character.mStopRequests, 1);
+
+        // the expired motion is deactivated once its ease out has run
+        for (S32 frame = 0; frame < 500 && character.isMotionActive(id); ++frame)
+        {
+            ms_sleep(2);
+            LLFrameTimer::updateFrameTime();
+            if (character.beginUpdateMotions(LLCharacter::NORMAL_UPDATE, true))
+            {
+                LLCharacter::evaluateMotions(evaluate, NULL);
+                ensure("deactivation deferred", character.isMotionActive(id));
+            }
+            character.finishUpdateMotions();
+        }
+        ensure("deactivated", !character.isMotionActive(id));
+    }
+}
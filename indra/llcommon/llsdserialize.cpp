@@ -379,7 +379,7 @@ static const char BINARY_FALSE_SERIAL = '0';
  * LLSDParser
  */
 LLSDParser::LLSDParser()
-    : mCheckLimits(true), mMaxBytesLeft(0), mParseLines(false)
+    : mCheckLimits(true), mMaxBytesLeft(0), mParseLines(false), mHandler(nullptr)
 {
 }
 
@@ -394,6 +394,18 @@ S32 LLSDParser::parse(std::istream& istr, LLSD& data, llssize max_bytes, S32 max
     return doParse(istr, data, max_depth);
 }
 
+S32 LLSDParser::parse(std::istream& istr, LLSDParseHandler& handler, llssize max_bytes, S32 max_depth)
+{
+    mCheckLimits = LLSDSerialize::SIZE_UNLIMITED != max_bytes;
+    mMaxBytesLeft = max_bytes;
+    mHandler = &handler;
+    // only scalars pass through here while a handler is set
+    LLSD scratch;
+    S32 parse_count = doParse(istr, scratch, max_depth);
+    mHandler = nullptr;
+    return parse_count;
+}
+
 
 // Parse using routine to get() lines, faster than parse()
 S32 LLSDParser::parseLines(std::istream& istr, LLSD& data)
@@ -504,6 +516,7 @@ S32 LLSDNotationParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) c
     {
         return 0;
     }
+    const bool is_container = (c == '{') || (c == '[');
     S32 parse_count = 1;
     switch(c)
     {
@@ -730,6 +743,10 @@ S32 LLSDNotationParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) c
     {
         data.clear();
     }
+    else if(mHandler && !is_container && !mHandler->value(std::move(data)))
+    {
+        parse_count = PARSE_FAILURE;
+    }
     return parse_count;
 }
 
@@ -742,6 +759,10 @@ S32 LLSDNotationParser::parseMap(std::istream& istr, LLSD& map, S32 max_depth) c
     char c = get(istr);
     if(c == '{')
     {
+        if(mHandler && !mHandler->beginMap())
+        {
+            return PARSE_FAILURE;
+        }
         // eat commas, white
         bool found_name = false;
         std::string name;
@@ -768,6 +789,10 @@ S32 LLSDNotationParser::parseMap(std::istream& istr, LLSD& map, S32 max_depth) c
                     continue;
                 }
                 putback(istr, c);
+                if(mHandler && !mHandler->key(name))
+                {
+                    return PARSE_FAILURE;
+                }
                 LLSD child;
                 S32 count = doParse(istr, child, max_depth);
                 if(count > 0)
@@ -775,7 +800,10 @@ S32 LLSDNotationParser::parseMap(std::istream& istr, LLSD& map, S32 max_depth) c
                     // There must be a value for every key, thus
                     // child_count must be greater than 0.
                     parse_count += count;
-                    map.insert(std::move(name), std::move(child)); // Move as name will be filled on next iteration
+                    if(!mHandler)
+                    {
+                        map.insert(std::move(name), std::move(child)); // Move as name will be filled on next iteration
+                    }
                     name.clear();
                 }
                 else
@@ -791,6 +819,10 @@ S32 LLSDNotationParser::parseMap(std::istream& istr, LLSD& map, S32 max_depth) c
             map.clear();
             return PARSE_FAILURE;
         }
+        if(mHandler && !mHandler->endMap())
+        {
+            return PARSE_FAILURE;
+        }
     }
     return parse_count;
 }
@@ -804,6 +836,10 @@ S32 LLSDNotationParser::parseArray(std::istream& istr, LLSD& array, S32 max_dept
     char c = get(istr);
     if(c == '[')
     {
+        if(mHandler && !mHandler->beginArray())
+        {
+            return PARSE_FAILURE;
+        }
         // eat commas, white
         c = get(istr);
         while((c != ']') && istr.good())
@@ -823,7 +859,10 @@ S32 LLSDNotationParser::parseArray(std::istream& istr, LLSD& array, S32 max_dept
             else
             {
                 parse_count += count;
-                array.append(std::move(child));
+                if(!mHandler)
+                {
+                    array.append(std::move(child));
+                }
             }
             c = get(istr);
         }
@@ -831,6 +870,10 @@ S32 LLSDNotationParser::parseArray(std::istream& istr, LLSD& array, S32 max_dept
         {
             return PARSE_FAILURE;
         }
+        if(mHandler && !mHandler->endArray())
+        {
+            return PARSE_FAILURE;
+        }
     }
     return parse_count;
 }
@@ -978,6 +1021,7 @@ S32 LLSDBinaryParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) con
     {
         return PARSE_FAILURE;
     }
+    const bool is_container = (c == '{') || (c == '[');
     S32 parse_count = 1;
     switch(c)
     {
@@ -1180,6 +1224,10 @@ S32 LLSDBinaryParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) con
     {
         data.clear();
     }
+    else if(mHandler && !is_container && !mHandler->value(std::move(data)))
+    {
+        parse_count = PARSE_FAILURE;
+    }
     return parse_count;
 }
 
@@ -1189,6 +1237,10 @@ S32 LLSDBinaryParser::parseMap(std::istream& istr, LLSD& map, S32 max_depth) con
     U32 value_nbo = 0;
     read(istr, (char*)&value_nbo, sizeof(U32));      /*Flawfinder: ignore*/
     S32 size = (S32)ntohl(value_nbo);
+    if(mHandler && !mHandler->beginMap())
+    {
+        return PARSE_FAILURE;
+    }
     S32 parse_count = 0;
     S32 count = 0;
     char c = get(istr);
@@ -1212,6 +1264,10 @@ S32 LLSDBinaryParser::parseMap(std::istream& istr, LLSD& map, S32 max_depth) con
             break;
         }
         }
+        if(mHandler && !mHandler->key(name))
+        {
+            return PARSE_FAILURE;
+        }
         LLSD child;
         S32 child_count = doParse(istr, child, max_depth);
         if(child_count > 0)
@@ -1219,7 +1275,10 @@ S32 LLSDBinaryParser::parseMap(std::istream& istr, LLSD& map, S32 max_depth) con
             // There must be a value for every key, thus child_count
             // must be greater than 0.
             parse_count += child_count;
-            map.insert(std::move(name), std::move(child));
+            if(!mHandler)
+            {
+                map.insert(std::move(name), std::move(child));
+            }
         }
         else
         {
@@ -1234,6 +1293,10 @@ S32 LLSDBinaryParser::parseMap(std::istream& istr, LLSD& map, S32 max_depth) con
         // as were said to be there.
         return PARSE_FAILURE;
     }
+    if(mHandler && !mHandler->endMap())
+    {
+        return PARSE_FAILURE;
+    }
     return parse_count;
 }
 
@@ -1243,8 +1306,20 @@ S32 LLSDBinaryParser::parseArray(std::istream& istr, LLSD& array, S32 max_depth)
     read(istr, (char*)&value_nbo, sizeof(U32));      /*Flawfinder: ignore*/
     S32 size = (S32)ntohl(value_nbo);
 
-    // Preallocate array to avoid incremental allocation
-    array = LLSD::emptyReservedArray(size);
+    if(mHandler)
+    {
+        // the elements go to the handler, not into array
+        array = LLSD::emptyArray();
+        if(!mHandler->beginArray())
+        {
+            return PARSE_FAILURE;
+        }
+    }
+    else
+    {
+        // Preallocate array to avoid incremental allocation
+        array = LLSD::emptyReservedArray(size);
+    }
 
     S32 parse_count = 0;
     S32 count = 0;
@@ -1260,7 +1335,10 @@ S32 LLSDBinaryParser::parseArray(std::istream& istr, LLSD& array, S32 max_depth)
         if(child_count)
         {
             parse_count += child_count;
-            array.append(std::move(child));
+            if(!mHandler)
+            {
+                array.append(std::move(child));
+            }
         }
         ++count;
         c = istr.peek();
@@ -1272,6 +1350,10 @@ S32 LLSDBinaryParser::parseArray(std::istream& istr, LLSD& array, S32 max_depth)
         // as were said to be there.
         return PARSE_FAILURE;
     }
+    if(mHandler && !mHandler->endArray())
+    {
+        return PARSE_FAILURE;
+    }
     return parse_count;
 }
 
@@ -1292,6 +1374,558 @@ bool LLSDBinaryParser::parseString(
     return true;
 }
 
+namespace
+{
+/**
+ * Bounds checked cursor over an in-memory binary LLSD blob. This is the
+ * buffer counterpart of LLSDBinaryParser::doParse() and friends, and
+ * follows their rules exactly, but reads fields in place instead of
+ * pulling them through an istream one get() at a time. Strings, keys and
+ * binary values are constructed directly from the buffer, so the only
+ * allocations made are for the resulting LLSD itself.
+ */
+class LLSDBinaryBufferReader
+{
+public:
+    LLSDBinaryBufferReader(const U8* buf, size_t len)
+        : mCur(buf), mEnd(buf + len)
+    {
+    }
+
+    size_t remaining() const { return mEnd - mCur; }
+    const U8* position() const { return mCur; }
+
+    S32 parseValue(LLSD& data, S32 max_depth);
+
+private:
+    bool get(char& c)
+    {
+        if (mCur >= mEnd) return false;
+        c = (char)*mCur++;
+        return true;
+    }
+
+    bool read(void* out, size_t size)
+    {
+        if (remaining() < size) return false;
+        memcpy(out, mCur, size);
+        mCur += size;
+        return true;
+    }
+
+    bool readSize(S32& size)
+    {
+        U32 value_nbo = 0;
+        if (!read(&value_nbo, sizeof(U32))) return false;
+        size = (S32)ntohl(value_nbo);
+        return size >= 0;
+    }
+
+    // 's', 'l' and 'k' payload: 4 byte size followed by the bytes
+    bool parseSizedString(std::string_view& value)
+    {
+        S32 size = 0;
+        if (!readSize(size) || remaining() < (size_t)size) return false;
+        value = std::string_view((const char*)mCur, size);
+        mCur += size;
+        return true;
+    }
+
+    bool parseDelimitedString(char delim, std::string& value);
+    S32 parseMap(LLSD& map, S32 max_depth);
+    S32 parseArray(LLSD& array, S32 max_depth);
+
+    const U8* mCur;
+    const U8* mEnd;
+};
+
+bool LLSDBinaryBufferReader::parseDelimitedString(char delim, std::string& value)
+{
+    const U8* close = (const U8*)memchr(mCur, delim, remaining());
+    if (!close)
+    {
+        return false;
+    }
+    if (!memchr(mCur, '\\', close - mCur))
+    {
+        // Nothing escaped, which is the usual case: take it as is.
+        value.assign((const char*)mCur, close - mCur);
+        mCur = close + 1;
+        return true;
+    }
+    // Escapes are rare enough in binary LLSD to hand them to the notation
+    // unescaper rather than duplicating it here.
+    boost::iostreams::stream<boost::iostreams::array_source> istr((const char*)mCur, remaining());
+    llssize count = deserialize_string_delim(istr, value, delim);
+    if (LLSDParser::PARSE_FAILURE == count)
+    {
+        return false;
+    }
+    mCur += count;
+    return true;
+}
+
+S32 LLSDBinaryBufferReader::parseValue(LLSD& data, S32 max_depth)
+{
+    char c;
+    if (!get(c))
+    {
+        return 0;
+    }
+    if (max_depth == 0)
+    {
+        return LLSDParser::PARSE_FAILURE;
+    }
+    S32 parse_count = 1;
+    switch(c)
+    {
+    case '{':
+    {
+        S32 child_count = parseMap(data, max_depth - 1);
+        if ((child_count == LLSDParser::PARSE_FAILURE) || data.isUndefined())
+        {
+            parse_count = LLSDParser::PARSE_FAILURE;
+        }
+        else
+        {
+            parse_count += child_count;
+        }
+        break;
+    }
+
+    case '[':
+    {
+        S32 child_count = parseArray(data, max_depth - 1);
+        if ((child_count == LLSDParser::PARSE_FAILURE) || data.isUndefined())
+        {
+            parse_count = LLSDParser::PARSE_FAILURE;
+        }
+        else
+        {
+            parse_count += child_count;
+        }
+        break;
+    }
+
+    case '!':
+        data.clear();
+        break;
+
+    case '0':
+        data = false;
+        break;
+
+    case '1':
+        data = true;
+        break;
+
+    case 'i':
+    {
+        U32 value_nbo = 0;
+        if (read(&value_nbo, sizeof(U32)))
+        {
+            data = (S32)ntohl(value_nbo);
+        }
+        else
+        {
+            parse_count = LLSDParser::PARSE_FAILURE;
+        }
+        break;
+    }
+
+    case 'r':
+    {
+        F64 real_nbo = 0.0;
+        if (read(&real_nbo, sizeof(F64)))
+        {
+            data = ll_ntohd(real_nbo);
+        }
+        else
+        {
+            parse_count = LLSDParser::PARSE_FAILURE;
+        }
+        break;
+    }
+
+    case 'u':
+    {
+        LLUUID id;
+        if (read(id.mData, UUID_BYTES))
+        {
+            data = id;
+        }
+        else
+        {
+            parse_count = LLSDParser::PARSE_FAILURE;
+        }
+        break;
+    }
+
+    case '\'':
+    case '"':
+    {
+        std::string value;
+        if (parseDelimitedString(c, value))
+        {
+            data = std::move(value);
+        }
+        else
+        {
+            parse_count = LLSDParser::PARSE_FAILURE;
+        }
+        break;
+    }
+
+    case 's':
+    {
+        std::string_view value;
+        if (parseSizedString(value))
+        {
+            data = std::string(value);
+        }
+        else
+        {
+            parse_count = LLSDParser::PARSE_FAILURE;
+        }
+        break;
+    }
+
+    case 'l':
+    {
+        std::string_view value;
+        if (parseSizedString(value))
+        {
+            data = LLURI(std::string(value));
+        }
+        else
+        {
+            parse_count = LLSDParser::PARSE_FAILURE;
+        }
+        break;
+    }
+
+    case 'd':
+    {
+        F64 real = 0.0;
+        if (read(&real, sizeof(F64)))
+        {
+            data = LLDate(real);
+        }
+        else
+        {
+            parse_count = LLSDParser::PARSE_FAILURE;
+        }
+        break;
+    }
+
+    case 'b':
+    {
+        S32 size = 0;
+        if (readSize(size) && remaining() >= (size_t)size)
+        {
+            data = LLSD::Binary(mCur, mCur + size);
+            mCur += size;
+        }
+        else
+        {
+            parse_count = LLSDParser::PARSE_FAILURE;
+        }
+        break;
+    }
+
+    default:
+        parse_count = LLSDParser::PARSE_FAILURE;
+        LL_INFOS() << "Unrecognized character while parsing: int(" << int(c)
+            << ")" << LL_ENDL;
+        break;
+    }
+    if (LLSDParser::PARSE_FAILURE == parse_count)
+    {
+        data.clear();
+    }
+    return parse_count;
+}
+
+S32 LLSDBinaryBufferReader::parseMap(LLSD& map, S32 max_depth)
+{
+    map = LLSD::emptyMap();
+    S32 size = 0;
+    if (!readSize(size))
+    {
+        return LLSDParser::PARSE_FAILURE;
+    }
+    S32 parse_count = 0;
+    S32 count = 0;
+    char c = 0;
+    bool good = get(c);
+    while (good && (c != '}') && (count < size))
+    {
+        std::string_view name;
+        std::string unescaped;
+        switch(c)
+        {
+        case 'k':
+            if (!parseSizedString(name))
+            {
+                return LLSDParser::PARSE_FAILURE;
+            }
+            break;
+        case '\'':
+        case '"':
+            if (!parseDelimitedString(c, unescaped))
+            {
+                return LLSDParser::PARSE_FAILURE;
+            }
+            name = unescaped;
+            break;
+        }
+        LLSD child;
+        S32 child_count = parseValue(child, max_depth);
+        if (child_count > 0)
+        {
+            // There must be a value for every key, thus child_count
+            // must be greater than 0.
+            parse_count += child_count;
+            map.insert(name, std::move(child));
+        }
+        else
+        {
+            return LLSDParser::PARSE_FAILURE;
+        }
+        ++count;
+        good = get(c);
+    }
+    if (!good || (c != '}') || (count < size))
+    {
+        // Make sure it is correctly terminated and we parsed as many
+        // as were said to be there.
+        return LLSDParser::PARSE_FAILURE;
+    }
+    return parse_count;
+}
+
+S32 LLSDBinaryBufferReader::parseArray(LLSD& array, S32 max_depth)
+{
+    S32 size = 0;
+    if (!readSize(size))
+    {
+        return LLSDParser::PARSE_FAILURE;
+    }
+
+    // Every element takes at least one byte, so a declared size beyond
+    // what is left is malformed; don't let it drive the reservation.
+    array = LLSD::emptyReservedArray(llmin((size_t)size, remaining()));
+
+    S32 parse_count = 0;
+    S32 count = 0;
+    while ((mCur < mEnd) && (*mCur != ']') && (count < size))
+    {
+        LLSD child;
+        S32 child_count = parseValue(child, max_depth);
+        if (LLSDParser::PARSE_FAILURE == child_count)
+        {
+            return LLSDParser::PARSE_FAILURE;
+        }
+        if (child_count)
+        {
+            parse_count += child_count;
+            array.append(std::move(child));
+        }
+        ++count;
+    }
+    char c = 0;
+    if (!get(c) || (c != ']') || (count < size))
+    {
+        // Make sure it is correctly terminated and we parsed as many
+        // as were said to be there.
+        return LLSDParser::PARSE_FAILURE;
+    }
+    return parse_count;
+}
+} // anonymous namespace
+
+S32 LLSDBinaryParser::parseBuffer(const U8* buf, size_t len, LLSD& data, S32 max_depth, size_t* consumed) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+    LLSDBinaryBufferReader reader(buf, len);
+    S32 parse_count = reader.parseValue(data, max_depth);
+    if (consumed)
+    {
+        *consumed = reader.position() - buf;
+    }
+    return parse_count;
+}
+
+
+/**
+ * LLSDParseBuilder
+ */
+LLSD& LLSDParseBuilder::place(LLSD&& value)
+{
+    if (mStack.empty())
+    {
+        mResult = std::move(value);
+        return mResult;
+    }
+    LLSD& parent = *mStack.back();
+    if (parent.isMap())
+    {
+        LLSD& slot = parent[mKey];
+        slot = std::move(value);
+        return slot;
+    }
+    return parent.append(std::move(value));
+}
+
+bool LLSDParseBuilder::beginMap()
+{
+    // Only ancestors of the container being filled are on the stack, and
+    // those are never appended to while it is open, so the pointers stay
+    // valid.
+    mStack.push_back(&place(LLSD::emptyMap()));
+    return true;
+}
+
+bool LLSDParseBuilder::endMap()
+{
+    mStack.pop_back();
+    mComplete = mStack.empty();
+    return true;
+}
+
+bool LLSDParseBuilder::beginArray()
+{
+    mStack.push_back(&place(LLSD::emptyArray()));
+    return true;
+}
+
+bool LLSDParseBuilder::endArray()
+{
+    mStack.pop_back();
+    mComplete = mStack.empty();
+    return true;
+}
+
+bool LLSDParseBuilder::key(const std::string& key)
+{
+    mKey = key;
+    return true;
+}
+
+bool LLSDParseBuilder::value(LLSD&& value)
+{
+    place(std::move(value));
+    mComplete = mStack.empty();
+    return true;
+}
+
+void LLSDParseBuilder::reset()
+{
+    mResult.clear();
+    mStack.clear();
+    mKey.clear();
+    mComplete = false;
+}
+
+/**
+ * LLSDArrayElementHandler
+ */
+LLSDArrayElementHandler::LLSDArrayElementHandler(const callback_t& callback)
+    : mCallback(callback), mBuilding(false)
+{
+}
+
+bool LLSDArrayElementHandler::isElement(bool is_array) const
+{
+    switch (mOuter.size())
+    {
+    case 0:
+        // the document itself
+        return false;
+    case 1:
+        // entries of a top level array, or non-array entries of a top
+        // level map
+        return mOuter.front() || !is_array;
+    default:
+        // entries of an array under the top level map
+        return true;
+    }
+}
+
+bool LLSDArrayElementHandler::deliver()
+{
+    mBuilding = false;
+    bool keep_going = mCallback(mKey, mBuilder.getResult());
+    mBuilder.reset();
+    return keep_going;
+}
+
+bool LLSDArrayElementHandler::beginMap()
+{
+    if (!mBuilding && !isElement(false))
+    {
+        mOuter.push_back(false);
+        return true;
+    }
+    mBuilding = true;
+    return mBuilder.beginMap();
+}
+
+bool LLSDArrayElementHandler::endMap()
+{
+    if (!mBuilding)
+    {
+        mOuter.pop_back();
+        return true;
+    }
+    mBuilder.endMap();
+    return !mBuilder.isComplete() || deliver();
+}
+
+bool LLSDArrayElementHandler::beginArray()
+{
+    if (!mBuilding && !isElement(true))
+    {
+        mOuter.push_back(true);
+        return true;
+    }
+    mBuilding = true;
+    return mBuilder.beginArray();
+}
+
+bool LLSDArrayElementHandler::endArray()
+{
+    if (!mBuilding)
+    {
+        mOuter.pop_back();
+        return true;
+    }
+    mBuilder.endArray();
+    return !mBuilder.isComplete() || deliver();
+}
+
+bool LLSDArrayElementHandler::key(const std::string& key)
+{
+    if (mBuilding)
+    {
+        return mBuilder.key(key);
+    }
+    if (mOuter.size() == 1)
+    {
+        mKey = key;
+    }
+    return true;
+}
+
+bool LLSDArrayElementHandler::value(LLSD&& value)
+{
+    if (mBuilding)
+    {
+        return mBuilder.value(std::move(value));
+    }
+    // a scalar at element level (or a scalar document) is already complete
+    return mCallback(mKey, value);
+}
 
 /**
  * LLSDFormatter
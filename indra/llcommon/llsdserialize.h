@@ -29,11 +29,108 @@
 #ifndef LL_LLSDSERIALIZE_H
 #define LL_LLSDSERIALIZE_H
 
+#include <functional>
 #include <iosfwd>
+#include <vector>
 #include "llpointer.h"
 #include "llrefcount.h"
 #include "llsd.h"
 
+/**
+ * @class LLSDParseHandler
+ * @brief Receives a parsed LLSD document as a sequence of events.
+ *
+ * Pass one of these to LLSDParser::parse() to see the structure of a
+ * document as it is read instead of getting one LLSD holding all of it,
+ * so a consumer can build its own structures without the whole tree in
+ * memory. A map produces beginMap(), then key() followed by that entry's
+ * value for each entry, then endMap(). Arrays are the same without the
+ * keys. Every other value is delivered whole through value(). Returning
+ * false from any callback stops the parse, which then fails.
+ */
+class LL_COMMON_API LLSDParseHandler
+{
+public:
+    virtual ~LLSDParseHandler() {}
+
+    virtual bool beginMap() = 0;
+    virtual bool endMap() = 0;
+    virtual bool beginArray() = 0;
+    virtual bool endArray() = 0;
+    virtual bool key(const std::string& key) = 0;
+    virtual bool value(LLSD&& value) = 0;
+};
+
+/**
+ * @class LLSDParseBuilder
+ * @brief LLSDParseHandler which assembles the events back into an LLSD.
+ *
+ * Mostly useful as a building block for handlers that want part of a
+ * document as LLSD, see LLSDArrayElementHandler.
+ */
+class LL_COMMON_API LLSDParseBuilder : public LLSDParseHandler
+{
+public:
+    bool beginMap() override;
+    bool endMap() override;
+    bool beginArray() override;
+    bool endArray() override;
+    bool key(const std::string& key) override;
+    bool value(LLSD&& value) override;
+
+    /// true once a complete value has been built
+    bool isComplete() const { return mComplete; }
+    LLSD& getResult() { return mResult; }
+    void reset();
+
+private:
+    LLSD& place(LLSD&& value);
+
+    LLSD mResult;
+    std::vector<LLSD*> mStack;
+    std::string mKey;
+    bool mComplete = false;
+};
+
+/**
+ * @class LLSDArrayElementHandler
+ * @brief Hands over the elements of top level arrays one at a time.
+ *
+ * Meant for documents such as the inventory cache, which are shaped like
+ * { "categories": [ {...}, ... ], "items": [ {...}, ... ] }. Each element
+ * of an array under the top level map is built as an LLSD and passed to
+ * the callback along with the array's key, then discarded, so only one
+ * element is in memory at a time. Top level map values that are not
+ * arrays are passed to the callback whole. If the document is itself an
+ * array its elements are passed with an empty key.
+ */
+class LL_COMMON_API LLSDArrayElementHandler : public LLSDParseHandler
+{
+public:
+    /// return false to stop the parse
+    typedef std::function<bool(const std::string& key, LLSD& element)> callback_t;
+
+    LLSDArrayElementHandler(const callback_t& callback);
+
+    bool beginMap() override;
+    bool endMap() override;
+    bool beginArray() override;
+    bool endArray() override;
+    bool key(const std::string& key) override;
+    bool value(LLSD&& value) override;
+
+private:
+    bool isElement(bool is_array) const;
+    bool deliver();
+
+    callback_t mCallback;
+    LLSDParseBuilder mBuilder;
+    // containers open above the element level, true for arrays
+    std::vector<bool> mOuter;
+    std::string mKey;
+    bool mBuilding;
+};
+
 /**
  * @class LLSDParser
  * @brief Abstract base class for LLSD parsers.
@@ -79,6 +176,21 @@ public:
      */
     S32 parse(std::istream& istr, LLSD& data, llssize max_bytes, S32 max_depth = -1);
 
+    /**
+     * @brief Parse a stream, reporting its contents to handler.
+     *
+     * Same as parse() above, except no LLSD is built: the document
+     * is passed to handler as a sequence of events as it is read.
+     * @param istr The input stream.
+     * @param handler Receives the parsed document.
+     * @param max_bytes The maximum number of bytes that will be in
+     * the stream. Pass in LLSDSerialize::SIZE_UNLIMITED (-1) to set no
+     * byte limit.
+     * @return Returns the number of LLSD objects parsed. Returns
+     * PARSE_FAILURE (-1) on parse failure or if handler stopped the parse.
+     */
+    S32 parse(std::istream& istr, LLSDParseHandler& handler, llssize max_bytes, S32 max_depth = -1);
+
     /** Like parse(), but uses a different call (istream.getline()) to read by lines
      *  This API is better suited for XML, where the parse cannot tell
      *  where the document actually ends.
@@ -211,6 +323,11 @@ protected:
      * @brief Use line-based reading to get text
      */
     bool mParseLines;
+
+    /**
+     * @brief When set, report the document here instead of building an LLSD.
+     */
+    LLSDParseHandler* mHandler;
 };
 
 /**
@@ -358,6 +475,28 @@ public:
      */
     LLSDBinaryParser();
 
+    /**
+     * @brief Parse binary LLSD straight out of a contiguous buffer.
+     *
+     * Produces the same result as parse() over a stream of the same
+     * bytes, without the istream: fields are read in place, strings and
+     * map keys are built directly from the buffer and arrays are sized
+     * from their declared length up front. Prefer this when the whole
+     * payload is already in memory, e.g. a mesh header or HTTP body.
+     * The buffer is bounds checked, so no max_bytes is needed. This
+     * always builds an LLSD, parse events are only available from a stream.
+     * @param buf The start of the serialized data.
+     * @param len The number of bytes available at buf.
+     * @param data[out] The newly parse structured data.
+     * @param max_depth Max depth parser will check before exiting
+     *  with parse error, -1 - unlimited.
+     * @param consumed[out] If not null, receives the number of bytes
+     *  making up the parsed object.
+     * @return Returns the number of LLSD objects parsed into
+     * data. Returns -1 on parse failure.
+     */
+    S32 parseBuffer(const U8* buf, size_t len, LLSD& data, S32 max_depth = -1, size_t* consumed = nullptr) const;
+
 protected:
     /**
      * @brief Call this method to parse a stream for LLSD.
@@ -778,6 +917,11 @@ public:
                          LLSDFormatter::EFormatterOptions(LLSDFormatter::OPTIONS_PRETTY |
                                                           LLSDFormatter::OPTIONS_PRETTY_BINARY));
     }
+    static S32 fromNotation(LLSDParseHandler& handler, std::istream& str, llssize max_bytes)
+    {
+        LLPointer<LLSDNotationParser> p = new LLSDNotationParser;
+        return p->parse(str, handler, max_bytes);
+    }
     static S32 fromNotation(LLSD& sd, std::istream& str, llssize max_bytes)
     {
         LLPointer<LLSDNotationParser> p = new LLSDNotationParser;
@@ -825,6 +969,11 @@ public:
         return fromXMLEmbedded(sd, str, emit_errors);
 //      return fromXMLDocument(sd, str, emit_errors);
     }
+    static S32 fromXML(LLSDParseHandler& handler, std::istream& str, bool emit_errors=true)
+    {
+        LLPointer<LLSDXMLParser> p = new LLSDXMLParser(emit_errors);
+        return p->parse(str, handler, LLSDSerialize::SIZE_UNLIMITED);
+    }
 
     /*
      * Binary Methods
@@ -846,6 +995,16 @@ public:
         (void)p->parse(str, sd, max_bytes, max_depth);
         return sd;
     }
+    static S32 fromBinary(LLSDParseHandler& handler, std::istream& str, llssize max_bytes, S32 max_depth = -1)
+    {
+        LLPointer<LLSDBinaryParser> p = new LLSDBinaryParser;
+        return p->parse(str, handler, max_bytes, max_depth);
+    }
+    static S32 fromBinary(LLSD& sd, const U8* buf, size_t len, S32 max_depth = -1, size_t* consumed = nullptr)
+    {
+        LLPointer<LLSDBinaryParser> p = new LLSDBinaryParser;
+        return p->parseBuffer(buf, len, sd, max_depth, consumed);
+    }
 };
 
 class LL_COMMON_API LLUZipHelper : public LLRefCount
@@ -266,6 +266,8 @@ public:
 
     void reset();
 
+    void setHandler(LLSDParseHandler* handler) { mHandler = handler; }
+
 private:
     void startElementHandler(const XML_Char* name, const XML_Char** attributes);
     void endElementHandler(const XML_Char* name);
@@ -279,6 +281,7 @@ private:
         void* userData, const XML_Char* data, int length);
 
     void startSkipping();
+    void stopForHandler();
 
     enum Element {
         ELEMENT_LLSD,
@@ -319,11 +322,18 @@ private:
 
     std::string mCurrentKey;        // Current XML <tag>
     std::string mCurrentContent;    // String data between <tag> and </tag>
+
+    // When set, values are reported here as they complete and
+    // mHandlerValues holds just the open values, one per level.
+    LLSDParseHandler* mHandler;
+    std::deque<LLSD> mHandlerValues;
+    bool mHandlerStopped;
 };
 
 
 LLSDXMLParser::Impl::Impl(bool emit_errors)
-    : mEmitErrors(emit_errors)
+    : mEmitErrors(emit_errors),
+      mHandler(nullptr)
 {
     mParser = XML_ParserCreate(NULL);
     reset();
@@ -400,6 +410,11 @@ S32 LLSDXMLParser::Impl::parse(std::istream& input, LLSD& data)
     // futhermore, it isn't clear that the expat buffer semantics are
     // preserved
 
+    if (mHandlerStopped)
+    {
+        return LLSDParser::PARSE_FAILURE;
+    }
+
     status = XML_ParseBuffer(mParser, 0, true);
     if (status == XML_STATUS_ERROR && !mGracefullStop)
     {
@@ -486,6 +501,11 @@ S32 LLSDXMLParser::Impl::parseLines(std::istream& input, LLSD& data)
         }
     }
 
+    if (mHandlerStopped)
+    {
+        return LLSDParser::PARSE_FAILURE;
+    }
+
     if (status != XML_STATUS_ERROR
         && !mGracefullStop)
     {   // Parse last bit
@@ -524,6 +544,9 @@ void LLSDXMLParser::Impl::reset()
 
     mCurrentKey.clear();
 
+    mHandlerValues.clear();
+    mHandlerStopped = false;
+
     XML_ParserReset(mParser, "utf-8");
     XML_SetUserData(mParser, this);
     XML_SetElementHandler(mParser, sStartElementHandler, sEndElementHandler);
@@ -537,6 +560,12 @@ void LLSDXMLParser::Impl::startSkipping()
     mSkipThrough = mDepth;
 }
 
+void LLSDXMLParser::Impl::stopForHandler()
+{
+    mHandlerStopped = true;
+    XML_StopParser(mParser, false);
+}
+
 const XML_Char*
 LLSDXMLParser::Impl::findAttribute(const XML_Char* name, const XML_Char** pairs)
 {
@@ -600,7 +629,7 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
     #endif // XML_PARSER_PERFORMANCE_TESTS
 
     ++mDepth;
-    if (mSkipping)
+    if (mSkipping || mHandlerStopped)
     {
         return;
     }
@@ -640,24 +669,39 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
 
     if (mStack.empty())
     {
-        mStack.push_back(&mResult);
+        mStack.push_back(mHandler ? &mHandlerValues.emplace_back() : &mResult);
     }
     else if (mStack.back()->isMap())
     {
         if (mCurrentKey.empty()) { return startSkipping(); }
 
-        LLSD& map = *mStack.back();
-        LLSD& newElement = map[std::move(mCurrentKey)];
-        mStack.push_back(&newElement);
+        if (mHandler)
+        {
+            if (!mHandler->key(mCurrentKey)) { return stopForHandler(); }
+            mStack.push_back(&mHandlerValues.emplace_back());
+        }
+        else
+        {
+            LLSD& map = *mStack.back();
+            LLSD& newElement = map[std::move(mCurrentKey)];
+            mStack.push_back(&newElement);
+        }
 
         mCurrentKey.clear();
     }
     else if (mStack.back()->isArray())
     {
-        LLSD& array = *mStack.back();
-        array.append(LLSD());
-        LLSD& newElement = array[array.size()-1];
-        mStack.push_back(&newElement);
+        if (mHandler)
+        {
+            mStack.push_back(&mHandlerValues.emplace_back());
+        }
+        else
+        {
+            LLSD& array = *mStack.back();
+            array.append(LLSD());
+            LLSD& newElement = array[array.size()-1];
+            mStack.push_back(&newElement);
+        }
     }
     else {
         // improperly nested value in a non-structure
@@ -669,10 +713,12 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
     {
         case ELEMENT_MAP:
             *mStack.back() = LLSD::emptyMap();
+            if (mHandler && !mHandler->beginMap()) { return stopForHandler(); }
             break;
 
         case ELEMENT_ARRAY:
             *mStack.back() = LLSD::emptyArray();
+            if (mHandler && !mHandler->beginArray()) { return stopForHandler(); }
             break;
 
         default:
@@ -688,6 +734,10 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
     #endif // XML_PARSER_PERFORMANCE_TESTS
 
     --mDepth;
+    if (mHandlerStopped)
+    {
+        return;
+    }
     if (mSkipping)
     {
         if (mDepth < mSkipThrough)
@@ -818,6 +868,28 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
             break;
     }
 
+    if (mHandler)
+    {
+        bool keep_going;
+        switch (element)
+        {
+            case ELEMENT_MAP:
+                keep_going = mHandler->endMap();
+                break;
+            case ELEMENT_ARRAY:
+                keep_going = mHandler->endArray();
+                break;
+            default:
+                keep_going = mHandler->value(std::move(value));
+                break;
+        }
+        mHandlerValues.pop_back();
+        if (!keep_going)
+        {
+            stopForHandler();
+        }
+    }
+
     mCurrentContent.clear();
 }
 
@@ -946,6 +1018,7 @@ S32 LLSDXMLParser::doParse(std::istream& input, LLSD& data, S32 max_depth) const
     XML_Timer timer( &parseTime );
     #endif  // XML_PARSER_PERFORMANCE_TESTS
 
+    impl.setHandler(mHandler);
     if (mParseLines)
     {
         // Use line-based reading (faster code)
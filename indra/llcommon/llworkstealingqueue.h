@@ -0,0 +1,302 @@
+/**
+ * @file llworkstealingqueue.h
+ * @brief Per-worker deques with stealing, for ThreadPool workers
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLWORKSTEALINGQUEUE_H
+#define LL_LLWORKSTEALINGQUEUE_H
+
+#include "llthreadsafequeue.h"      // LLThreadSafeQueueInterrupt
+#include "llexception.h"
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*****************************************************************************
+*   LLWorkStealingQueue
+*****************************************************************************/
+/**
+ * Multi-producer, multi-consumer container with one deque per worker thread.
+ *
+ * A worker pushes to and pops from the back of its own deque, so work it
+ * spawns runs next, while its inputs are still hot in cache. When its own
+ * deque runs dry it steals from the front of its siblings' deques. Producers
+ * that are not workers (NO_WORKER) are spread round-robin across the deques,
+ * inserting at the front: with a single worker and only outside producers
+ * the queue is therefore still strictly FIFO.
+ *
+ * Each deque has its own lock, so workers only contend with one another
+ * while stealing. The shared lock is only taken to park an idle worker or to
+ * wake one up.
+ *
+ * The API mirrors the subset of LLThreadSafeQueue used by WorkQueue, with an
+ * extra worker index argument. Unlike LLThreadSafeQueue, pushIfOpen() never
+ * blocks on capacity: a worker blocked pushing into its own pool could
+ * deadlock that pool.
+ */
+template <typename ElementT>
+class LLWorkStealingQueue
+{
+public:
+    typedef ElementT value_type;
+    static constexpr size_t NO_WORKER = size_t(-1);
+
+    LLWorkStealingQueue(size_t workers, size_t capacity = 1024);
+
+    // Number of per-worker deques; valid worker indices are [0, workers()).
+    size_t workers() const { return mDeques.size(); }
+
+    // Add an element to the queue. Returns false if the queue is closed.
+    template <typename T>
+    bool pushIfOpen(T&& element, size_t worker = NO_WORKER);
+
+    // Add an element to the queue unless it is closed or has reached
+    // capacity. Returns true only if the element was actually added.
+    template <typename T>
+    bool tryPush(T&& element, size_t worker = NO_WORKER);
+
+    // Pop the next element for this worker, stealing if its own deque is
+    // empty and blocking if every deque is empty. Once the queue is closed
+    // and drained, throws LLThreadSafeQueueInterrupt.
+    ElementT pop(size_t worker = NO_WORKER);
+
+    // Pop an element if there is one available, without blocking. Returns
+    // true only if an element was popped.
+    bool tryPop(ElementT& element, size_t worker = NO_WORKER);
+
+    // Approximate number of pending elements across all deques.
+    size_t size() { return mPending.load(); }
+
+    size_t capacity() const { return mCapacity; }
+
+    // Same semantics as LLThreadSafeQueue::close(): subsequent pushes fail,
+    // pops succeed until the queue is drained.
+    void close();
+
+    // producer end: are we prevented from pushing any additional items?
+    bool isClosed() { return mClosed.load(); }
+    // consumer end: are we done, is the queue entirely drained?
+    bool done() { return mClosed.load() && mPending.load() == 0; }
+
+    // Number of elements a worker took from a deque other than its own.
+    U64 getStealCount() const { return mSteals.load(std::memory_order_relaxed); }
+
+private:
+    // Keep each deque (and its lock) on its own cache line.
+    struct alignas(64) Deque
+    {
+        std::mutex mLock;
+        std::deque<ElementT> mStorage;
+    };
+
+    bool take(ElementT& element, size_t worker);
+    void wake();
+
+    std::vector<std::unique_ptr<Deque>> mDeques;
+    size_t mCapacity;
+    std::atomic<size_t> mPending{ 0 };
+    std::atomic<size_t> mNextDeque{ 0 };
+    std::atomic<U64> mSteals{ 0 };
+    std::atomic<bool> mClosed{ false };
+
+    // idle workers park here
+    boost::fibers::mutex mIdleLock;
+    typedef std::unique_lock<decltype(mIdleLock)> lock_t;
+    boost::fibers::condition_variable_any mIdleCond;
+    std::atomic<size_t> mSleepers{ 0 };
+};
+
+/*****************************************************************************
+*   LLWorkStealingQueue implementation
+*****************************************************************************/
+template <typename ElementT>
+LLWorkStealingQueue<ElementT>::LLWorkStealingQueue(size_t workers, size_t capacity):
+    mCapacity(capacity)
+{
+    // always have at least one deque, even for a zero-width pool
+    mDeques.resize(workers? workers : 1);
+    for (auto& deque : mDeques)
+    {
+        deque = std::make_unique<Deque>();
+    }
+}
+
+template <typename ElementT>
+template <typename T>
+bool LLWorkStealingQueue<ElementT>::pushIfOpen(T&& element, size_t worker)
+{
+    if (mClosed.load())
+    {
+        return false;
+    }
+
+    // Count the element before it becomes visible, so a popper that sees
+    // it can never drive mPending below zero. Any element pushed while a
+    // concurrent close() is in progress is still counted, hence drained.
+    mPending.fetch_add(1);
+    if (worker < mDeques.size())
+    {
+        Deque& deque{ *mDeques[worker] };
+        std::lock_guard<std::mutex> lock(deque.mLock);
+        deque.mStorage.push_back(std::forward<T>(element));
+    }
+    else
+    {
+        Deque& deque{ *mDeques[mNextDeque.fetch_add(1, std::memory_order_relaxed) % mDeques.size()] };
+        std::lock_guard<std::mutex> lock(deque.mLock);
+        deque.mStorage.push_front(std::forward<T>(element));
+    }
+    wake();
+    return true;
+}
+
+template <typename ElementT>
+template <typename T>
+bool LLWorkStealingQueue<ElementT>::tryPush(T&& element, size_t worker)
+{
+    if (mPending.load() >= mCapacity)
+    {
+        return false;
+    }
+    return pushIfOpen(std::forward<T>(element), worker);
+}
+
+template <typename ElementT>
+ElementT LLWorkStealingQueue<ElementT>::pop(size_t worker)
+{
+    ElementT element;
+    for (;;)
+    {
+        if (take(element, worker))
+        {
+            return element;
+        }
+
+        lock_t lock(mIdleLock);
+        // Registering as a sleeper before rechecking mPending pairs with
+        // wake(), which bumps mPending before checking mSleepers: at least
+        // one side is guaranteed to see the other.
+        mSleepers.fetch_add(1);
+        while (mPending.load() == 0 && ! mClosed.load())
+        {
+            mIdleCond.wait(lock);
+        }
+        mSleepers.fetch_sub(1);
+        if (mPending.load() == 0)
+        {
+            // closed and drained
+            LLTHROW(LLThreadSafeQueueInterrupt());
+        }
+        // Otherwise something is pending: go look for it. It may still be
+        // in flight from a pusher, in which case we simply loop again.
+    }
+}
+
+template <typename ElementT>
+bool LLWorkStealingQueue<ElementT>::tryPop(ElementT& element, size_t worker)
+{
+    return take(element, worker);
+}
+
+template <typename ElementT>
+void LLWorkStealingQueue<ElementT>::close()
+{
+    mClosed.store(true);
+    lock_t lock(mIdleLock);
+    mIdleCond.notify_all();
+}
+
+template <typename ElementT>
+bool LLWorkStealingQueue<ElementT>::take(ElementT& element, size_t worker)
+{
+    size_t count = mDeques.size();
+    size_t start;
+    if (worker < count)
+    {
+        // own deque first, newest first
+        Deque& own{ *mDeques[worker] };
+        std::lock_guard<std::mutex> lock(own.mLock);
+        if (! own.mStorage.empty())
+        {
+            element = std::move(own.mStorage.back());
+            own.mStorage.pop_back();
+            mPending.fetch_sub(1);
+            return true;
+        }
+        start = worker + 1;
+    }
+    else
+    {
+        start = mNextDeque.load(std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t victim = (start + i) % count;
+        if (victim == worker)
+        {
+            continue;
+        }
+        Deque& other{ *mDeques[victim] };
+        std::lock_guard<std::mutex> lock(other.mLock);
+        if (other.mStorage.empty())
+        {
+            continue;
+        }
+        if (worker < count)
+        {
+            // thieves work the end opposite the owner
+            element = std::move(other.mStorage.front());
+            other.mStorage.pop_front();
+            mSteals.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            // outside consumers see outside producers' posts in FIFO order
+            element = std::move(other.mStorage.back());
+            other.mStorage.pop_back();
+        }
+        mPending.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+template <typename ElementT>
+void LLWorkStealingQueue<ElementT>::wake()
+{
+    if (mSleepers.load() > 0)
+    {
+        // Taking the lock ensures a worker between registering as a sleeper
+        // and actually waiting can't miss this notification.
+        lock_t lock(mIdleLock);
+        mIdleCond.notify_one();
+    }
+}
+
+#endif // LL_LLWORKSTEALINGQUEUE_H
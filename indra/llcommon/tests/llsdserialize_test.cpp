@@ -45,6 +45,8 @@ typedef U32 uint32_t;
 #endif
 
 #include "boost/range.hpp"
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
 
 #include "llsd.h"
 #include "llsdserialize.h"
@@ -57,7 +59,10 @@ typedef U32 uint32_t;
 #include "../test/namedtempfile.h"
 #include "stringize.h"
 #include "StringVec.h"
+#include <atomic>
+#include <cstddef>
 #include <functional>
+#include <new>
 
 typedef std::function<void(const LLSD& data, std::ostream& str)> FormatterFunction;
 typedef std::function<bool(std::istream& istr, LLSD& data, llssize max_bytes)> ParserFunction;
@@ -67,6 +72,45 @@ std::vector<U8> string_to_vector(const std::string& str)
     return std::vector<U8>(str.begin(), str.end());
 }
 
+// Heap accounting for the parse event memory benchmark. Every allocation
+// carries a header recording its size so the live total can be tracked.
+namespace
+{
+    const size_t HEAP_HEADER = alignof(std::max_align_t);
+    std::atomic<size_t> sHeapLive{ 0 };
+    std::atomic<size_t> sHeapPeak{ 0 };
+}
+
+void* operator new(size_t size)
+{
+    void* block = malloc(size + HEAP_HEADER);
+    if (!block)
+    {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(block) = size;
+    size_t live = sHeapLive += size;
+    size_t peak = sHeapPeak;
+    while (live > peak && !sHeapPeak.compare_exchange_weak(peak, live))
+        ;
+    return static_cast<char*>(block) + HEAP_HEADER;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr)
+    {
+        void* block = static_cast<char*>(ptr) - HEAP_HEADER;
+        sHeapLive -= *static_cast<size_t*>(block);
+        free(block);
+    }
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+
 namespace tut
 {
     struct sd_xml_data
@@ -585,6 +629,19 @@ namespace tut
         doRoundTripTests("LLSDXMLFormatter -> deserialize");
     };
 
+    template<> template<>
+    void TestLLSDSerializeObject::test<11>()
+    {
+        setFormatterParser(new LLSDBinaryFormatter(), new LLSDBinaryParser());
+        // parse the same bytes from memory instead of through the stream
+        mParser = [](std::istream& istr, LLSD& data, llssize)
+        {
+            std::string buffer{ std::istreambuf_iterator<char>(istr), {} };
+            return LLSDSerialize::fromBinary(data, (const U8*)buffer.data(), buffer.size()) > 0;
+        };
+        doRoundTripTests("binary buffer parsing");
+    }
+
 /*==========================================================================*|
     // We do not expect this test to succeed. Without a header, neither
     // notation LLSD nor binary LLSD reliably start with a distinct character,
@@ -1584,12 +1641,129 @@ namespace tut
             1);
     }
 
-/*
     template<> template<>
     void TestLLSDBinaryParsingObject::test<11>()
     {
+        set_test_name("parseBuffer() bounds and consumed bytes");
+        LLSD sd = LLSD::emptyMap();
+        sd["id"] = LLUUID::generateNewID();
+        sd["name"] = "a somewhat longer string value to avoid SSO";
+        sd["list"].append(1);
+        sd["list"].append(2.5);
+        sd["blob"] = LLSD::Binary(37, 0x5a);
+        std::stringstream str;
+        LLSDSerialize::toBinary(sd, str);
+        std::string bytes = str.str();
+        // trailing data after the object must be left alone
+        std::string padded = bytes + "trailing";
+
+        LLSD parsed;
+        size_t consumed = 0;
+        S32 count = mParser->parseBuffer((const U8*)padded.data(), padded.size(), parsed, -1, &consumed);
+        ensure_equals("buffer parse result", parsed, sd);
+        ensure_equals("buffer parse consumed", consumed, bytes.size());
+        ensure_equals("buffer parse count", count, LLSDSerialize::toBinary(sd, str));
+
+        // every truncation of a valid blob must fail cleanly
+        for (size_t len = 1; len < bytes.size(); ++len)
+        {
+            LLSD truncated;
+            count = mParser->parseBuffer((const U8*)bytes.data(), len, truncated);
+            ensure_equals(STRINGIZE("truncated at " << len), count, LLSDParser::PARSE_FAILURE);
+            ensure(STRINGIZE("truncated at " << len << " undefined"), truncated.isUndefined());
+        }
+
+        // depth limit
+        LLSD nested;
+        nested[0][0][0] = 1;
+        std::stringstream nested_str;
+        LLSDSerialize::toBinary(nested, nested_str);
+        std::string nested_bytes = nested_str.str();
+        ensure_equals("within depth",
+                      mParser->parseBuffer((const U8*)nested_bytes.data(), nested_bytes.size(), parsed, 4), 4);
+        ensure_equals("beyond depth",
+                      mParser->parseBuffer((const U8*)nested_bytes.data(), nested_bytes.size(), parsed, 2),
+                      LLSDParser::PARSE_FAILURE);
+    }
+
+    // Representative payloads for the benchmark below.
+    static LLSD make_mesh_header()
+    {
+        LLSD header = LLSD::emptyMap();
+        header["version"] = 1;
+        header["creator"] = LLUUID::generateNewID();
+        header["date"] = LLDate::now();
+        const char* lods[] = { "lowest_lod", "low_lod", "medium_lod", "high_lod", "physics_convex", "physics_mesh", "skin" };
+        S32 offset = 0;
+        for (const char* lod : lods)
+        {
+            header[lod]["offset"] = offset;
+            header[lod]["size"] = 4096 + offset / 3;
+            offset += 8192;
+        }
+        return header;
+    }
+
+    static LLSD make_ais_response(S32 items)
+    {
+        LLSD response = LLSD::emptyMap();
+        response["_base_uri"] = "/category/00000000-0000-0000-0000-000000000000";
+        LLSD& contents = response["_embedded"]["items"];
+        for (S32 i = 0; i < items; ++i)
+        {
+            LLSD item = LLSD::emptyMap();
+            item["item_id"] = LLUUID::generateNewID();
+            item["parent_id"] = LLUUID::generateNewID();
+            item["asset_id"] = LLUUID::generateNewID();
+            item["name"] = llformat("Inventory item number %d", i);
+            item["desc"] = "(No Description)";
+            item["type"] = i % 20;
+            item["inv_type"] = i % 18;
+            item["flags"] = 0;
+            item["created_at"] = 1700000000 + i;
+            item["permissions"]["owner_id"] = LLUUID::generateNewID();
+            item["permissions"]["base_mask"] = (S32)0x7fffffff;
+            item["permissions"]["owner_mask"] = (S32)0x7fffffff;
+            item["permissions"]["group_mask"] = 0;
+            item["permissions"]["everyone_mask"] = 0;
+            item["permissions"]["next_owner_mask"] = (S32)0x82000;
+            item["sale_info"]["sale_type"] = 0;
+            item["sale_info"]["sale_price"] = 10;
+            contents.append(item);
+        }
+        return response;
+    }
+
+    template<> template<>
+    void TestLLSDBinaryParsingObject::test<12>()
+    {
+        set_test_name("buffer parser matches stream parser on real payloads");
+        struct Payload { const char* mName; LLSD mData; };
+        Payload payloads[] = {
+            { "mesh header", make_mesh_header() },
+            { "AIS response", make_ais_response(500) },
+        };
+
+        for (const Payload& payload : payloads)
+        {
+            std::stringstream str;
+            LLSDSerialize::toBinary(payload.mData, str);
+            const std::string bytes = str.str();
+
+            boost::iostreams::stream<boost::iostreams::array_source> istr(bytes.data(), bytes.size());
+            LLSD streamed;
+            mParser->reset();
+            S32 stream_count = mParser->parse(istr, streamed, bytes.size());
+
+            LLSD parsed;
+            mParser->reset();
+            S32 buffer_count = mParser->parseBuffer((const U8*)bytes.data(), bytes.size(), parsed);
+
+            ensure_equals(STRINGIZE(payload.mName << " stream result"), streamed, payload.mData);
+            ensure_equals(STRINGIZE(payload.mName << " buffer result"), parsed, payload.mData);
+            ensure_equals(STRINGIZE(payload.mName << " count"), buffer_count, stream_count);
+        }
     }
-*/
 
    /**
      * @class TestLLSDCrossCompatible
@@ -2194,4 +2368,247 @@ namespace tut
                         { return LLSDSerialize::fromBinary(data, istr, max_bytes) > 0; });
     }
 |*==========================================================================*/
+
+    /**
+     * @class TestLLSDParseEvents
+     * @brief Tests for LLSDParser::parse() with an LLSDParseHandler
+     */
+    class TestLLSDParseEvents
+    {
+    public:
+        TestLLSDParseEvents()
+        {
+            mSample = LLSD::emptyMap();
+            mSample["name"] = "parse events";
+            mSample["id"] = LLUUID::generateNewID();
+            mSample["when"] = LLDate("2002-12-07T05:07:15.00Z");
+            mSample["where"] = LLURI("http://slurl.com/secondlife/Ambleside/57/104/26/");
+            mSample["blob"] = LLSD::Binary(13, 0x2a);
+            mSample["nothing"] = LLSD();
+            mSample["list"].append(1);
+            mSample["list"].append(2.5);
+            mSample["list"].append(true);
+            mSample["list"].append(LLSD::emptyArray());
+            mSample["list"].append(LLSD::emptyMap());
+            mSample["nested"]["a"]["b"][2] = "deep";
+        }
+
+        typedef std::function<S32(std::istream&, LLSDParseHandler&)> event_parser_t;
+        typedef std::function<S32(std::istream&, LLSD&)> tree_parser_t;
+
+        struct Format
+        {
+            const char* mName;
+            std::function<void(const LLSD&, std::ostream&)> mFormat;
+            event_parser_t mParseEvents;
+            tree_parser_t mParseTree;
+        };
+
+        static std::vector<Format> formats()
+        {
+            return {
+                { "xml",
+                  [](const LLSD& sd, std::ostream& str) { LLSDSerialize::toXML(sd, str); },
+                  [](std::istream& str, LLSDParseHandler& h) { return LLSDSerialize::fromXML(h, str); },
+                  [](std::istream& str, LLSD& sd) { return LLSDSerialize::fromXML(sd, str); } },
+                { "notation",
+                  [](const LLSD& sd, std::ostream& str) { LLSDSerialize::toNotation(sd, str); },
+                  [](std::istream& str, LLSDParseHandler& h)
+                  { return LLSDSerialize::fromNotation(h, str, LLSDSerialize::SIZE_UNLIMITED); },
+                  [](std::istream& str, LLSD& sd)
+                  { return LLSDSerialize::fromNotation(sd, str, LLSDSerialize::SIZE_UNLIMITED); } },
+                { "binary",
+                  [](const LLSD& sd, std::ostream& str) { LLSDSerialize::toBinary(sd, str); },
+                  [](std::istream& str, LLSDParseHandler& h)
+                  { return LLSDSerialize::fromBinary(h, str, LLSDSerialize::SIZE_UNLIMITED); },
+                  [](std::istream& str, LLSD& sd)
+                  { return LLSDSerialize::fromBinary(sd, str, LLSDSerialize::SIZE_UNLIMITED); } },
+            };
+        }
+
+        LLSD mSample;
+    };
+
+    typedef tut::test_group<TestLLSDParseEvents> TestLLSDParseEventsGroup;
+    typedef TestLLSDParseEventsGroup::object TestLLSDParseEventsObject;
+    TestLLSDParseEventsGroup gTestLLSDParseEventsGroup("llsd parse events");
+
+    template<> template<>
+    void TestLLSDParseEventsObject::test<1>()
+    {
+        set_test_name("events rebuild the same LLSD");
+        for (const Format& format : formats())
+        {
+            std::stringstream str;
+            format.mFormat(mSample, str);
+            std::istringstream tree_str(str.str());
+            LLSD tree;
+            S32 tree_count = format.mParseTree(tree_str, tree);
+
+            std::istringstream event_str(str.str());
+            LLSDParseBuilder builder;
+            S32 event_count = format.mParseEvents(event_str, builder);
+            ensure(STRINGIZE(format.mName << " complete"), builder.isComplete());
+            ensure_equals(STRINGIZE(format.mName << " result"), builder.getResult(), tree);
+            ensure_equals(STRINGIZE(format.mName << " result vs sample"), builder.getResult(), mSample);
+            ensure_equals(STRINGIZE(format.mName << " count"), event_count, tree_count);
+        }
+    }
+
+    template<> template<>
+    void TestLLSDParseEventsObject::test<2>()
+    {
+        set_test_name("LLSDArrayElementHandler");
+        LLSD doc = LLSD::emptyMap();
+        doc["version"] = 3;
+        for (S32 i = 0; i < 5; ++i)
+        {
+            doc["categories"][i]["name"] = llformat("category %d", i);
+            doc["items"][i]["name"] = llformat("item %d", i);
+            doc["items"][i]["flags"].append(i);
+        }
+
+        for (const Format& format : formats())
+        {
+            std::stringstream str;
+            format.mFormat(doc, str);
+            LLSD seen = LLSD::emptyMap();
+            LLSDArrayElementHandler handler([&seen](const std::string& key, LLSD& element)
+                                            {
+                                                if (key == "version")
+                                                {
+                                                    seen[key] = element;
+                                                }
+                                                else
+                                                {
+                                                    seen[key].append(element);
+                                                }
+                                                return true;
+                                            });
+            ensure(STRINGIZE(format.mName << " parse"), format.mParseEvents(str, handler) > 0);
+            ensure_equals(STRINGIZE(format.mName << " elements"), seen, doc);
+        }
+
+        // a top level array is streamed with an empty key
+        LLSD list;
+        list.append("one");
+        list.append(LLSD().with("two", 2));
+        std::stringstream str;
+        LLSDSerialize::toBinary(list, str);
+        LLSD seen;
+        LLSDArrayElementHandler handler([&seen](const std::string& key, LLSD& element)
+                                        {
+                                            ensure("top level array key", key.empty());
+                                            seen.append(element);
+                                            return true;
+                                        });
+        ensure("array parse", LLSDSerialize::fromBinary(handler, str, LLSDSerialize::SIZE_UNLIMITED) > 0);
+        ensure_equals("array elements", seen, list);
+    }
+
+    template<> template<>
+    void TestLLSDParseEventsObject::test<3>()
+    {
+        set_test_name("handler can stop the parse");
+        for (const Format& format : formats())
+        {
+            std::stringstream str;
+            format.mFormat(mSample, str);
+            S32 calls = 0;
+            LLSDArrayElementHandler handler([&calls](const std::string&, LLSD&)
+                                            {
+                                                return ++calls < 2;
+                                            });
+            ensure_equals(STRINGIZE(format.mName << " stopped"),
+                          format.mParseEvents(str, handler), S32(LLSDParser::PARSE_FAILURE));
+            ensure_equals(STRINGIZE(format.mName << " no calls after stop"), calls, 2);
+        }
+    }
+
+    template<> template<>
+    void TestLLSDParseEventsObject::test<4>()
+    {
+        set_test_name("element events use less memory than the tree");
+        // Shaped like the inventory cache written by LLInventoryModel
+        const S32 CATEGORY_COUNT = 500;
+        const S32 ITEM_COUNT = 10000;
+        std::stringstream str;
+        {
+            LLSD inventory = LLSD::emptyMap();
+            LLSD& categories = inventory["categories"];
+            for (S32 i = 0; i < CATEGORY_COUNT; ++i)
+            {
+                LLSD cat = LLSD::emptyMap();
+                cat["cat_id"] = LLUUID::generateNewID();
+                cat["parent_id"] = LLUUID::generateNewID();
+                cat["name"] = llformat("Category %d", i);
+                cat["type_default"] = -1;
+                cat["version"] = i;
+                categories.append(cat);
+            }
+            LLSD& items = inventory["items"];
+            for (S32 i = 0; i < ITEM_COUNT; ++i)
+            {
+                LLSD item = LLSD::emptyMap();
+                item["item_id"] = LLUUID::generateNewID();
+                item["parent_id"] = LLUUID::generateNewID();
+                item["asset_id"] = LLUUID::generateNewID();
+                item["name"] = llformat("Inventory item number %d", i);
+                item["desc"] = "(No Description)";
+                item["type"] = i % 20;
+                item["inv_type"] = i % 18;
+                item["flags"] = 0;
+                item["created_at"] = 1700000000 + i;
+                item["permissions"]["creator_id"] = LLUUID::generateNewID();
+                item["permissions"]["owner_id"] = LLUUID::generateNewID();
+                item["permissions"]["base_mask"] = (S32)0x7fffffff;
+                item["permissions"]["owner_mask"] = (S32)0x7fffffff;
+                item["permissions"]["next_owner_mask"] = (S32)0x82000;
+                item["sale_info"]["sale_type"] = 0;
+                item["sale_info"]["sale_price"] = 10;
+                items.append(item);
+            }
+            LLSDSerialize::toBinary(inventory, str);
+        }
+        const std::string bytes = str.str();
+
+        // whole tree, then walk it
+        S32 tree_items = 0;
+        size_t base = sHeapLive;
+        sHeapPeak = base;
+        {
+            boost::iostreams::stream<boost::iostreams::array_source> istr(bytes.data(), bytes.size());
+            LLSD inventory;
+            LLSDSerialize::fromBinary(inventory, istr, LLSDSerialize::SIZE_UNLIMITED);
+            for (const LLSD& item : llsd::inArray(inventory["items"]))
+            {
+                tree_items += item.has("item_id");
+            }
+        }
+        size_t tree_peak = sHeapPeak - base;
+
+        // one element at a time
+        S32 event_items = 0;
+        base = sHeapLive;
+        sHeapPeak = base;
+        {
+            boost::iostreams::stream<boost::iostreams::array_source> istr(bytes.data(), bytes.size());
+            LLSDArrayElementHandler handler([&event_items](const std::string& key, LLSD& element)
+                                            {
+                                                event_items += (key == "items") && element.has("item_id");
+                                                return true;
+                                            });
+            LLSDSerialize::fromBinary(handler, istr, LLSDSerialize::SIZE_UNLIMITED);
+        }
+        size_t event_peak = sHeapPeak - base;
+
+        ensure_equals("tree items", tree_items, ITEM_COUNT);
+        ensure_equals("event items", event_items, ITEM_COUNT);
+        // Only meaningful where the parser's allocations come through the
+        // operator new above, i.e. when llcommon is linked statically.
+        if (tree_peak)
+        {
+            ensure("events use less memory", event_peak < tree_peak / 4);
+        }
+    }
 }
@@ -0,0 +1,176 @@
+/**
+ * @file   threadpool_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for threadpool, work-stealing mode in particular.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "threadpool.h"
+// STL headers
+// std headers
+#include <atomic>
+#include <chrono>
+#include <thread>
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+#include "llworkstealingqueue.h"
+
+using namespace LL;
+using namespace std::literals::chrono_literals; // ms suffix
+
+namespace
+{
+    // Spin until counter reaches target or the timeout expires; returns
+    // whether it got there.
+    bool waitFor(const std::atomic<size_t>& counter, size_t target,
+                 std::chrono::steady_clock::duration timeout = 10s)
+    {
+        auto until{ std::chrono::steady_clock::now() + timeout };
+        while (counter.load() < target)
+        {
+            if (std::chrono::steady_clock::now() > until)
+            {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+} // anonymous namespace
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct threadpool_data
+    {
+    };
+    typedef test_group<threadpool_data> threadpool_group;
+    typedef threadpool_group::object object;
+    threadpool_group threadpoolgrp("threadpool");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("work-stealing queue ordering and close");
+        // one worker, only outside producers: strictly FIFO
+        LLWorkStealingQueue<int> queue(1, 4);
+        for (int i = 0; i < 4; ++i)
+        {
+            ensure("push failed", queue.tryPush(i));
+        }
+        ensure("tryPush should respect capacity", ! queue.tryPush(99));
+        ensure_equals("size", queue.size(), 4);
+        ensure_equals("first", queue.pop(0), 0);
+        ensure_equals("second", queue.pop(0), 1);
+
+        // work the worker spawns itself runs next
+        ensure("worker push failed", queue.pushIfOpen(42, 0));
+        ensure_equals("own work first", queue.pop(0), 42);
+
+        queue.close();
+        ensure("not closed", queue.isClosed());
+        ensure("push after close", ! queue.pushIfOpen(7));
+        ensure("drained too soon", ! queue.done());
+        ensure_equals("drain third", queue.pop(0), 2);
+        int last = -1;
+        ensure("tryPop failed", queue.tryPop(last, 0));
+        ensure_equals("drain fourth", last, 3);
+        ensure("not done", queue.done());
+        bool threw = false;
+        try
+        {
+            queue.pop(0);
+        }
+        catch (const LLThreadSafeQueueInterrupt&)
+        {
+            threw = true;
+        }
+        ensure("pop on drained queue should throw", threw);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("work-stealing queue stealing");
+        LLWorkStealingQueue<int> queue(2);
+        // worker 0 spawns work on its own deque; worker 1 has none
+        for (int i = 0; i < 3; ++i)
+        {
+            queue.pushIfOpen(i, 0);
+        }
+        int stolen = -1;
+        ensure("worker 1 should steal", queue.tryPop(stolen, 1));
+        ensure_equals("thief takes the far end", stolen, 0);
+        ensure_equals("steal count", queue.getStealCount(), 1);
+        ensure_equals("owner takes newest", queue.pop(0), 2);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("work-stealing ThreadPool runs everything");
+        ThreadPool pool("stealing", 4);
+        pool.setWorkStealing(true);
+        pool.start();
+        auto& queue{ pool.getQueue() };
+        ensure("not in work-stealing mode", queue.isWorkStealing());
+
+        // Root tasks from this thread, each of which posts children from its
+        // worker thread.
+        constexpr size_t roots = 500, children = 8;
+        std::atomic<size_t> ran{ 0 };
+        for (size_t r = 0; r < roots; ++r)
+        {
+            queue.post([&queue, &ran]()
+            {
+                for (size_t c = 0; c < children; ++c)
+                {
+                    queue.post([&ran](){ ++ran; });
+                }
+                ++ran;
+            });
+        }
+        ensure("tasks didn't all run", waitFor(ran, roots * (1 + children)));
+        pool.close();
+        ensure("queue not drained", queue.done());
+        ensure_equals("extra tasks ran", ran.load(), roots * (1 + children));
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("postTo from a work-stealing ThreadPool");
+        WorkQueue main("threadpool_test main");
+        ThreadPool pool("stealing postTo", 2);
+        pool.setWorkStealing(true);
+        pool.start();
+
+        std::atomic<size_t> replies{ 0 };
+        size_t sum = 0;
+        for (size_t i = 1; i <= 10; ++i)
+        {
+            // the callback runs on this thread when we service 'main'
+            main.postTo(pool.getQueue().getWeak(),
+                        [i](){ return i * i; },
+                        [&sum, &replies](size_t result){ sum += result; ++replies; });
+        }
+        auto until{ std::chrono::steady_clock::now() + 10s };
+        while (replies.load() < 10 && std::chrono::steady_clock::now() < until)
+        {
+            main.runPending();
+            std::this_thread::yield();
+        }
+        ensure_equals("missing replies", replies.load(), 10);
+        ensure_equals("bad sum of squares", sum, 385);
+    }
+} // namespace tut
@@ -15,6 +15,9 @@
 #include "threadpool.h"
 // STL headers
 // std headers
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 // external library headers
 // other Linden headers
 #include "commoncontrol.h"
@@ -66,19 +69,44 @@ LL::ThreadPoolBase::ThreadPoolBase(const std::string& name,
                                    bool auto_shutdown):
     super(name),
     mName("ThreadPool:" + name),
-    mThreadCount(getConfiguredWidth(name, threads)),
+    mThreadCount(threads),
+    mWorkStealing(false),
     mQueue(queue),
     mAutomaticShutdown(auto_shutdown)
-{}
+{
+    // Fetch this pool's "ThreadPoolSizes" entry once for both settings.
+    LLSD sizeSpec{ getConfiguredSpec(name) };
+    mThreadCount = widthFromSpec(sizeSpec, threads);
+    mWorkStealing = workStealingFromSpec(sizeSpec, false);
+}
 
 void LL::ThreadPoolBase::start()
 {
+    WorkQueue* stealing = nullptr;
+    if (mWorkStealing)
+    {
+        stealing = dynamic_cast<WorkQueue*>(mQueue.get());
+        if (stealing)
+        {
+            stealing->enableWorkStealing(mThreadCount);
+        }
+        else
+        {
+            LL_WARNS("ThreadPool") << mName << " ignoring work_stealing: only supported on WorkQueue"
+                                   << LL_ENDL;
+        }
+    }
+
     for (size_t i = 0; i < mThreadCount; ++i)
     {
         std::string tname{ stringize(mName, ':', (i+1), '/', mThreadCount) };
-        mThreads.emplace_back(tname, [this, tname]()
+        mThreads.emplace_back(tname, [this, tname, stealing, i]()
             {
                 LL_PROFILER_SET_THREAD_NAME(tname.c_str());
+                if (stealing)
+                {
+                    stealing->bindWorker(i);
+                }
                 run(tname);
             });
     }
@@ -151,8 +179,67 @@ void LL::ThreadPoolBase::run()
     mQueue->runUntilClose();
 }
 
+namespace
+{
+    // Shared between forkJoin() and its helper tasks. Helpers hold it by
+    // shared_ptr because one may only get to run after forkJoin() returned,
+    // in which case it finds nothing left to claim and never touches fn.
+    struct ForkJoinState
+    {
+        ForkJoinState(size_t count, const std::function<void(size_t)>& fn):
+            mCount(count),
+            mFn(fn)
+        {}
+
+        // claim and run items until none are left
+        void drain()
+        {
+            for (size_t i; (i = mNext.fetch_add(1)) < mCount; )
+            {
+                mFn(i);
+                if (mFinished.fetch_add(1) + 1 == mCount)
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mDone.notify_all();
+                }
+            }
+        }
+
+        const size_t mCount;
+        const std::function<void(size_t)>& mFn;
+        std::atomic<size_t> mNext{ 0 };
+        std::atomic<size_t> mFinished{ 0 };
+        std::mutex mMutex;
+        std::condition_variable mDone;
+    };
+} // anonymous namespace
+
+void LL::ThreadPoolBase::forkJoin(size_t count, const std::function<void(size_t)>& fn)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    auto state{ std::make_shared<ForkJoinState>(count, fn) };
+    size_t helpers = llmin(count - 1, mThreads.size());
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        // If the queue is closed we simply do all the work ourselves.
+        if (! mQueue->post([state](){ state->drain(); }))
+        {
+            break;
+        }
+    }
+
+    state->drain();
+
+    std::unique_lock<std::mutex> lock(state->mMutex);
+    state->mDone.wait(lock, [&state](){ return state->mFinished.load() == state->mCount; });
+}
+
 //static
-size_t LL::ThreadPoolBase::getConfiguredWidth(const std::string& name, size_t dft)
+LLSD LL::ThreadPoolBase::getConfiguredSpec(const std::string& name)
 {
     LLSD poolSizes;
     try
@@ -186,10 +273,39 @@ size_t LL::ThreadPoolBase::getConfiguredWidth(const std::string& name, size_t df
     LL_DEBUGS("ThreadPool") << "ThreadPoolSizes = " << poolSizes << LL_ENDL;
     // LLSD treats an undefined value as an empty map when asked to retrieve a
     // key, so we don't need this to be conditional.
-    LLSD sizeSpec{ poolSizes[name] };
+    return poolSizes[name];
+}
+
+//static
+size_t LL::ThreadPoolBase::widthFromSpec(const LLSD& sizeSpec, size_t dft)
+{
     // We retrieve sizeSpec as LLSD, rather than immediately as LLSD::Integer,
-    // so we can distinguish the case when it's undefined.
-    return sizeSpec.isInteger() ? sizeSpec.asInteger() : dft;
+    // so we can distinguish the case when it's undefined. The entry may be
+    // either a bare integer or a map with a "threads" key.
+    LLSD threads{ sizeSpec.isMap()? sizeSpec["threads"] : sizeSpec };
+    return threads.isInteger() ? threads.asInteger() : dft;
+}
+
+//static
+bool LL::ThreadPoolBase::workStealingFromSpec(const LLSD& sizeSpec, bool dft)
+{
+    if (! sizeSpec.isMap() || ! sizeSpec.has("work_stealing"))
+    {
+        return dft;
+    }
+    return sizeSpec["work_stealing"].asBoolean();
+}
+
+//static
+size_t LL::ThreadPoolBase::getConfiguredWidth(const std::string& name, size_t dft)
+{
+    return widthFromSpec(getConfiguredSpec(name), dft);
+}
+
+//static
+bool LL::ThreadPoolBase::getConfiguredWorkStealing(const std::string& name, bool dft)
+{
+    return workStealingFromSpec(getConfiguredSpec(name), dft);
 }
 
 //static
@@ -15,6 +15,8 @@
 
 #include "threadpool_fwd.h"
 #include "workqueue.h"
+#include "llsd.h"
+#include <functional>               // std::function
 #include <memory>                   // std::unique_ptr
 #include <string>
 #include <thread>
@@ -66,6 +68,16 @@ namespace LL
          */
         virtual void run();
 
+        /**
+         * forkJoin() calls fn(0) through fn(count-1), posting up to
+         * getWidth() helper tasks to this pool to share the calls, and
+         * returns once every call has completed. The calling thread claims
+         * items too, and only ever waits for items already running on a
+         * helper, so it is safe to call from one of this pool's own workers.
+         * fn must not throw.
+         */
+        void forkJoin(size_t count, const std::function<void(size_t)>& fn);
+
         /**
          * getConfiguredWidth() returns the setting, if any, for the specified
          * ThreadPool name. Returns dft if the "ThreadPoolSizes" map does not
@@ -74,6 +86,25 @@ namespace LL
         static
         size_t getConfiguredWidth(const std::string& name, size_t dft=0);
 
+        /**
+         * A "ThreadPoolSizes" entry may also be a map, e.g.
+         * {"threads": 4, "work_stealing": true}. getConfiguredWorkStealing()
+         * returns that "work_stealing" flag for the specified ThreadPool
+         * name, or dft if it isn't specified.
+         */
+        static
+        bool getConfiguredWorkStealing(const std::string& name, bool dft=false);
+
+        /**
+         * With work stealing, each worker thread gets its own deque of work
+         * and steals from its siblings when that runs dry, instead of all
+         * workers contending for one shared queue. This only applies to a
+         * ThreadPool built on WorkQueue, and must be set before start(). The
+         * default comes from getConfiguredWorkStealing().
+         */
+        void setWorkStealing(bool enable) { mWorkStealing = enable; }
+        bool getWorkStealing() const { return mWorkStealing; }
+
         /**
          * This getWidth() returns the width of the instantiated ThreadPool
          * with the specified name, if any. If no instance exists, returns its
@@ -93,8 +124,14 @@ namespace LL
     private:
         void run(const std::string& name);
 
+        /// this pool's raw "ThreadPoolSizes" entry, possibly undefined
+        static LLSD getConfiguredSpec(const std::string& name);
+        static size_t widthFromSpec(const LLSD& sizeSpec, size_t dft);
+        static bool workStealingFromSpec(const LLSD& sizeSpec, bool dft);
+
         std::string mName;
         size_t mThreadCount;
+        bool mWorkStealing;
     };
 
     /**
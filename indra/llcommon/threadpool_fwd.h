@@ -16,6 +16,8 @@
 
 namespace LL
 {
+    class ThreadPoolBase;
+
     template <class QUEUE>
     struct ThreadPoolUsing;
 
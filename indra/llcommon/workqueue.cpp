@@ -253,6 +253,14 @@ void LL::WorkQueueBase::checkCoroutine(const std::string& method)
 /*****************************************************************************
 *   WorkQueue
 *****************************************************************************/
+namespace
+{
+    // Which WorkQueue, if any, this thread is bound to as a work-stealing
+    // worker, and with what index. A thread serves at most one pool.
+    thread_local const LL::WorkQueue* sBoundQueue = nullptr;
+    thread_local size_t sBoundIndex = 0;
+} // anonymous namespace
+
 LL::WorkQueue::WorkQueue(const std::string& name, size_t capacity, bool auto_shutdown):
     super(name, auto_shutdown),
     mQueue(capacity)
@@ -261,29 +269,45 @@ LL::WorkQueue::WorkQueue(const std::string& name, size_t capacity, bool auto_shu
 
 void LL::WorkQueue::close()
 {
+    if (Stealing* stealing = mStealing.load())
+    {
+        stealing->close();
+    }
     mQueue.close();
 }
 
 size_t LL::WorkQueue::size()
 {
-    return mQueue.size();
+    Stealing* stealing = mStealing.load();
+    return stealing? stealing->size() : mQueue.size();
 }
 
 bool LL::WorkQueue::isClosed()
 {
-    return mQueue.isClosed();
+    Stealing* stealing = mStealing.load();
+    return stealing? stealing->isClosed() : mQueue.isClosed();
 }
 
 bool LL::WorkQueue::done()
 {
-    return mQueue.done();
+    Stealing* stealing = mStealing.load();
+    return stealing? stealing->done() : mQueue.done();
 }
 
 bool LL::WorkQueue::post(const Work& callable)
 {
     try
     {
-        return mQueue.pushIfOpen(callable);
+        if (Stealing* stealing = mStealing.load())
+        {
+            return stealing->pushIfOpen(callable, workerIndex());
+        }
+        if (! mQueue.pushIfOpen(callable))
+        {
+            return false;
+        }
+        carryOver();
+        return true;
     }
     catch (std::bad_alloc&)
     {
@@ -297,7 +321,16 @@ bool LL::WorkQueue::tryPost(const Work& callable)
 {
     try
     {
-        return mQueue.tryPush(callable);
+        if (Stealing* stealing = mStealing.load())
+        {
+            return stealing->tryPush(callable, workerIndex());
+        }
+        if (! mQueue.tryPush(callable))
+        {
+            return false;
+        }
+        carryOver();
+        return true;
     }
     catch (std::bad_alloc&)
     {
@@ -307,13 +340,80 @@ bool LL::WorkQueue::tryPost(const Work& callable)
     }
 }
 
+void LL::WorkQueue::enableWorkStealing(size_t workers)
+{
+    auto stealing = std::make_unique<Stealing>(workers, mQueue.capacity());
+    Stealing* expected = nullptr;
+    if (! mStealing.compare_exchange_strong(expected, stealing.get()))
+    {
+        return;
+    }
+    mStealingQueue = std::move(stealing);
+    // carry over anything posted before the switch
+    carryOver();
+    LL_DEBUGS("WorkQueue") << getKey() << " using work stealing across "
+                           << workers << " workers" << LL_ENDL;
+}
+
+void LL::WorkQueue::carryOver()
+{
+    // A post() that saw no stealing queue may push to mQueue after
+    // enableWorkStealing() has drained it. Every such post() comes back here
+    // once its item is in mQueue. mStealing is sequentially consistent and
+    // mQueue is locked, so either this load sees the published queue or the
+    // drain in enableWorkStealing() comes after the push and moves the item.
+    Stealing* stealing = mStealing.load();
+    if (! stealing)
+    {
+        return;
+    }
+    // tryPop() also fails when it cannot get the lock, so only an empty
+    // size() ends the drain.
+    for (Work work; ; )
+    {
+        if (mQueue.tryPop(work))
+        {
+            stealing->pushIfOpen(std::move(work));
+        }
+        else if (! mQueue.size())
+        {
+            break;
+        }
+    }
+}
+
+void LL::WorkQueue::bindWorker(size_t index)
+{
+    sBoundQueue = this;
+    sBoundIndex = index;
+}
+
+U64 LL::WorkQueue::getStealCount() const
+{
+    Stealing* stealing = mStealing.load();
+    return stealing? stealing->getStealCount() : 0;
+}
+
+size_t LL::WorkQueue::workerIndex() const
+{
+    return (sBoundQueue == this)? sBoundIndex : Stealing::NO_WORKER;
+}
+
 LL::WorkQueue::Work LL::WorkQueue::pop_()
 {
+    if (Stealing* stealing = mStealing.load())
+    {
+        return stealing->pop(workerIndex());
+    }
     return mQueue.pop();
 }
 
 bool LL::WorkQueue::tryPop_(Work& work)
 {
+    if (Stealing* stealing = mStealing.load())
+    {
+        return stealing->tryPop(work, workerIndex());
+    }
     return mQueue.tryPop(work);
 }
 
@@ -16,10 +16,13 @@
 #include "llexception.h"
 #include "llinstancetracker.h"
 #include "llinstancetrackersubclass.h"
+#include "llworkstealingqueue.h"
 #include "threadsafeschedule.h"
+#include <atomic>
 #include <chrono>
 #include <exception>                // std::current_exception
 #include <functional>               // std::function
+#include <memory>                   // std::unique_ptr
 #include <string>
 
 namespace LL
@@ -259,9 +262,43 @@ namespace LL
          */
         bool tryPost(const Work&) override;
 
+        /*-------------------------- work stealing -------------------------*/
+
+        /**
+         * Replace the single shared FIFO with an LLWorkStealingQueue holding
+         * one deque per worker thread. Call this before any worker starts,
+         * passing the number of workers that will call bindWorker(). Other
+         * threads may keep posting meanwhile: work posted before or during
+         * the switch is carried over. Only the first call has any effect.
+         * ThreadPool calls this when its "ThreadPoolSizes" entry requests
+         * work stealing.
+         */
+        void enableWorkStealing(size_t workers);
+        bool isWorkStealing() const { return mStealing.load() != nullptr; }
+
+        /**
+         * Called on a worker thread before it starts servicing this queue,
+         * with a distinct index in [0, workers). Work that a bound worker
+         * posts to this queue lands on its own deque.
+         */
+        void bindWorker(size_t index);
+
+        /// number of work items a worker took from a sibling's deque
+        U64 getStealCount() const;
+
     private:
         using Queue = LLThreadSafeQueue<Work>;
         Queue mQueue;
+        using Stealing = LLWorkStealingQueue<Work>;
+        std::unique_ptr<Stealing> mStealingQueue;
+        // mStealingQueue once enableWorkStealing() publishes it, read
+        // without a lock by every post and pop
+        std::atomic<Stealing*> mStealing{ nullptr };
+
+        // this thread's bindWorker() index, or Stealing::NO_WORKER
+        size_t workerIndex() const;
+        // moves anything left in mQueue to the stealing queue, if there is one
+        void carryOver();
 
         Work pop_() override;
         bool tryPop_(Work&) override;
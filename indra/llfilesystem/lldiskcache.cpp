@@ -36,6 +36,7 @@
 #include "lldir.h"
 #include <boost/filesystem.hpp>
 #include <chrono>
+#include <unordered_set>
 
 #include "lldiskcache.h"
 
@@ -49,13 +50,37 @@
   */
 static const std::string CACHE_FILENAME_PREFIX("sl_cache");
 
+/**
+ * How often purge() walks the cache directory again to pick up files
+ * that were written or removed without going through LLFileSystem.
+ */
+static constexpr std::time_t INDEX_RESCAN_INTERVAL = 60 * 60;
+
 std::string LLDiskCache::sCacheDir;
 
+/**
+ * Extract the asset ID from a file name built by metaDataToFilepath()
+ */
+static bool cache_filename_to_id(const std::string& filename, LLUUID& id)
+{
+    const size_t id_start = CACHE_FILENAME_PREFIX.length() + 1;
+    const size_t id_length = UUID_STR_LENGTH - 1;
+    if (filename.compare(0, CACHE_FILENAME_PREFIX.length(), CACHE_FILENAME_PREFIX) != 0
+        || filename.length() < id_start + id_length)
+    {
+        return false;
+    }
+    return id.set(filename.substr(id_start, id_length), false);
+}
+
 LLDiskCache::LLDiskCache(const std::string& cache_dir,
                          const uintmax_t max_size_bytes,
                          const bool enable_cache_debug_info) :
     mMaxSizeBytes(max_size_bytes),
-    mEnableCacheDebugInfo(enable_cache_debug_info)
+    mEnableCacheDebugInfo(enable_cache_debug_info),
+    mIndexSize(0),
+    mIndexReady(false),
+    mLastScanTime(0)
 {
     sCacheDir = cache_dir;
     LLFile::mkdir(cache_dir);
@@ -93,16 +118,55 @@ void LLDiskCache::purge()
 {
     LL_PROFILE_ZONE_SCOPED;
 
+    std::lock_guard<std::mutex> purge_lock(mPurgeMutex);
+
     if (mEnableCacheDebugInfo)
     {
         LL_INFOS() << "Total dir size before purge is " << dirFileSize(sCacheDir) << LL_ENDL;
     }
 
-    boost::system::error_code ec;
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    typedef std::pair<std::time_t, std::pair<uintmax_t, std::string>> file_info_t;
+    // Walking a large cache directory costs seconds of disk I/O, so it is
+    // only done to build the index and then once in a while to pick up
+    // anything that was changed behind our back.
+    const std::time_t cur_time = std::time(nullptr);
+    if (!mIndexReady || cur_time - mLastScanTime > INDEX_RESCAN_INTERVAL)
+    {
+        scanCacheDir();
+        if (!LLApp::isRunning())
+        {
+            return;
+        }
+        mLastScanTime = cur_time;
+        mIndexReady = true;
+    }
+
+    LL_INFOS() << "Purging cache to a maximum of " << mMaxSizeBytes << " bytes" << LL_ENDL;
+
+    size_t evicted = evictFiles(mMaxSizeBytes);
+
+    if (mEnableCacheDebugInfo)
+    {
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+
+        LL_INFOS() << "Total dir size after purge is " << dirFileSize(sCacheDir) << LL_ENDL;
+        LL_INFOS() << "Cache purge took " << execute_time << " ms to evict " << evicted << " files" << LL_ENDL;
+    }
+}
+
+void LLDiskCache::scanCacheDir()
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    boost::system::error_code ec;
+
+    typedef std::pair<std::time_t, std::pair<uintmax_t, LLUUID>> file_info_t;
     std::vector<file_info_t> file_info;
+    bool scanned_all = false;
+    // files written or used from now on may be missed by the walk
+    const std::time_t scan_start = std::time(nullptr);
 
 #if LL_WINDOWS
     std::wstring cache_path(ll_convert<std::wstring>(sCacheDir));
@@ -125,91 +189,283 @@ void LLDiskCache::purge()
                     uintmax_t file_size = boost::filesystem::file_size(*iter, ec);
                     if (ec.failed())
                     {
+                        iter.increment(ec);
                         continue;
                     }
-                    const std::string file_path = (*iter).path().string();
                     const std::time_t file_time = boost::filesystem::last_write_time(*iter, ec);
                     if (ec.failed())
                     {
+                        iter.increment(ec);
                         continue;
                     }
 
-                    file_info.push_back(file_info_t(file_time, { file_size, file_path }));
+                    // the index is keyed by id, files named otherwise are left alone
+                    LLUUID id;
+                    if (cache_filename_to_id((*iter).path().filename().string(), id))
+                    {
+                        file_info.push_back(file_info_t(file_time, { file_size, id }));
+                    }
                 }
             }
             iter.increment(ec);
         }
+        scanned_all = !ec.failed();
     }
 
+    // Newest first: pushing each entry to the front of its shard leaves the
+    // oldest files at the front, but behind nothing we saw being used already.
     std::sort(file_info.begin(), file_info.end(), [](file_info_t& x, file_info_t& y)
     {
         return x.first > y.first;
     });
 
-    LL_INFOS() << "Purging cache to a maximum of " << mMaxSizeBytes << " bytes" << LL_ENDL;
+    for (const file_info_t& info : file_info)
+    {
+        const LLUUID& id = info.second.second;
+        const uintmax_t file_size = info.second.first;
 
-    std::vector<bool> file_removed;
-    if (mEnableCacheDebugInfo)
+        IndexShard& shard = getShard(id);
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+
+        auto iter = shard.mEntries.find(id);
+        if (iter == shard.mEntries.end())
+        {
+            shard.mLRU.push_front(id);
+            shard.mEntries.emplace(id, IndexEntry{ file_size, info.first, shard.mLRU.begin() });
+            mIndexSize += file_size;
+        }
+        else if (iter->second.mSize != file_size)
+        {
+            // the file on disk is the authority on the size
+            mIndexSize -= iter->second.mSize;
+            mIndexSize += file_size;
+            iter->second.mSize = file_size;
+        }
+    }
+
+    if (!scanned_all)
     {
-        file_removed.reserve(file_info.size());
+        return;
     }
-    uintmax_t file_size_total = 0;
-    for (file_info_t& entry : file_info)
+
+    // Drop the files that were removed behind our back, unless they were
+    // used after the walk started.
+    std::unordered_set<LLUUID> seen;
+    seen.reserve(file_info.size());
+    for (const file_info_t& info : file_info)
+    {
+        seen.insert(info.second.second);
+    }
+
+    for (IndexShard& shard : mIndexShards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        for (auto iter = shard.mEntries.begin(); iter != shard.mEntries.end(); )
+        {
+            if (iter->second.mLastAccess < scan_start && seen.find(iter->first) == seen.end())
+            {
+                mIndexSize -= iter->second.mSize;
+                shard.mLRU.erase(iter->second.mLRUPos);
+                iter = shard.mEntries.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+    }
+}
+
+size_t LLDiskCache::evictFiles(uintmax_t max_size)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    boost::system::error_code ec;
+    size_t evicted = 0;
+
+    while (mIndexSize > max_size)
     {
         if (!LLApp::isRunning())
         {
-            return;
+            break;
         }
-        file_size_total += entry.second.first;
 
-        bool should_remove = file_size_total > mMaxSizeBytes;
-        if (mEnableCacheDebugInfo)
+        // Each shard is in LRU order, the oldest file is at the front of one of them.
+        IndexShard* oldest_shard = nullptr;
+        std::time_t oldest_time = 0;
+        for (IndexShard& shard : mIndexShards)
         {
-            file_removed.push_back(should_remove);
+            std::lock_guard<std::mutex> lock(shard.mMutex);
+            if (!shard.mLRU.empty())
+            {
+                const std::time_t access_time = shard.mEntries[shard.mLRU.front()].mLastAccess;
+                if (!oldest_shard || access_time < oldest_time)
+                {
+                    oldest_shard = &shard;
+                    oldest_time = access_time;
+                }
+            }
         }
-        if (should_remove)
+
+        if (!oldest_shard)
+        {
+            break;
+        }
+
+        LLUUID id;
+        uintmax_t file_size = 0;
         {
-            boost::filesystem::remove(entry.second.second, ec);
-            if (ec.failed())
+            std::lock_guard<std::mutex> lock(oldest_shard->mMutex);
+            if (oldest_shard->mLRU.empty())
             {
-                LL_WARNS() << "Failed to delete cache file " << entry.second.second << ": " << ec.message() << LL_ENDL;
+                continue;
             }
+            id = oldest_shard->mLRU.front();
+            file_size = oldest_shard->mEntries[id].mSize;
+            oldest_shard->mEntries.erase(id);
+            oldest_shard->mLRU.pop_front();
+            mIndexSize -= file_size;
+        }
+
+        // remove the file outside of the lock, fetch threads may be waiting on this shard
+        const std::string file_path = metaDataToFilepath(id, LLAssetType::AT_NONE);
+#if LL_WINDOWS
+        boost::filesystem::remove(ll_convert<std::wstring>(file_path), ec);
+#else
+        boost::filesystem::remove(file_path, ec);
+#endif
+        if (ec.failed())
+        {
+            LL_WARNS() << "Failed to delete cache file " << file_path << ": " << ec.message() << LL_ENDL;
         }
+        else if (mEnableCacheDebugInfo)
+        {
+            LL_INFOS() << "DELETE:  " << oldest_time << "  " << file_size << "  " << file_path << " (" << mIndexSize << "/" << max_size << ")" << LL_ENDL;
+        }
+        ++evicted;
     }
 
-    if (mEnableCacheDebugInfo)
+    return evicted;
+}
+
+void LLDiskCache::updateEntry(const LLUUID& id, uintmax_t size, bool grow_only)
+{
+    IndexShard& shard = getShard(id);
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+
+    const std::time_t cur_time = std::time(nullptr);
+    auto iter = shard.mEntries.find(id);
+    if (iter == shard.mEntries.end())
     {
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        shard.mLRU.push_back(id);
+        shard.mEntries.emplace(id, IndexEntry{ size, cur_time, std::prev(shard.mLRU.end()) });
+        mIndexSize += size;
+    }
+    else
+    {
+        IndexEntry& entry = iter->second;
+        const uintmax_t new_size = grow_only ? llmax(entry.mSize, size) : size;
+        mIndexSize -= entry.mSize;
+        mIndexSize += new_size;
+        entry.mSize = new_size;
+        entry.mLastAccess = cur_time;
+        shard.mLRU.splice(shard.mLRU.end(), shard.mLRU, entry.mLRUPos);
+    }
+}
+
+void LLDiskCache::touchEntry(const LLUUID& id)
+{
+    IndexShard& shard = getShard(id);
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+
+    auto iter = shard.mEntries.find(id);
+    if (iter != shard.mEntries.end())
+    {
+        iter->second.mLastAccess = std::time(nullptr);
+        shard.mLRU.splice(shard.mLRU.end(), shard.mLRU, iter->second.mLRUPos);
+    }
+}
+
+bool LLDiskCache::removeEntry(const LLUUID& id, uintmax_t* size)
+{
+    IndexShard& shard = getShard(id);
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+
+    auto iter = shard.mEntries.find(id);
+    if (iter == shard.mEntries.end())
+    {
+        return false;
+    }
 
-        // Log afterward so it doesn't affect the time measurement
-        // Logging thousands of file results can take hundreds of milliseconds
-        for (size_t i = 0; i < file_info.size(); ++i)
+    if (size)
+    {
+        *size = iter->second.mSize;
+    }
+    mIndexSize -= iter->second.mSize;
+    shard.mLRU.erase(iter->second.mLRUPos);
+    shard.mEntries.erase(iter);
+    return true;
+}
+
+void LLDiskCache::clearIndex()
+{
+    for (IndexShard& shard : mIndexShards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        for (const auto& entry : shard.mEntries)
         {
-            if (!LLApp::isRunning())
-            {
-                return;
-            }
-            const file_info_t& entry = file_info[i];
-            const bool removed = file_removed[i];
-            const std::string action = removed ? "DELETE:" : "KEEP:";
-
-            // have to do this because of LL_INFO/LL_END weirdness
-            std::ostringstream line;
-
-            line << action << "  ";
-            line << entry.first << "  ";
-            line << entry.second.first << "  ";
-            line << entry.second.second;
-            line << " (" << file_size_total << "/" << mMaxSizeBytes << ")";
-            LL_INFOS() << line.str() << LL_ENDL;
+            mIndexSize -= entry.second.mSize;
         }
+        shard.mEntries.clear();
+        shard.mLRU.clear();
+    }
+}
 
-        LL_INFOS() << "Total dir size after purge is " << dirFileSize(sCacheDir) << LL_ENDL;
-        LL_INFOS() << "Cache purge took " << execute_time << " ms to execute for " << file_info.size() << " files" << LL_ENDL;
+// static
+void LLDiskCache::onFileWritten(const LLUUID& id, uintmax_t size, bool grow_only)
+{
+    if (instanceExists())
+    {
+        getInstance()->updateEntry(id, size, grow_only);
     }
 }
 
+// static
+void LLDiskCache::onFileRead(const LLUUID& id)
+{
+    if (instanceExists())
+    {
+        getInstance()->touchEntry(id);
+    }
+}
+
+// static
+void LLDiskCache::onFileRemoved(const LLUUID& id)
+{
+    if (instanceExists())
+    {
+        getInstance()->removeEntry(id);
+    }
+}
+
+// static
+void LLDiskCache::onFileRenamed(const LLUUID& old_id, const LLUUID& new_id)
+{
+    if (instanceExists())
+    {
+        uintmax_t size = 0;
+        if (getInstance()->removeEntry(old_id, &size))
+        {
+            getInstance()->updateEntry(new_id, size, false);
+        }
+    }
+}
+
+uintmax_t LLDiskCache::getCacheSize()
+{
+    return mIndexReady ? mIndexSize.load() : dirFileSize(sCacheDir);
+}
+
 const std::string LLDiskCache::metaDataToFilepath(const LLUUID& id, LLAssetType::EType at)
 {
     return llformat("%s%s%s_%s_0.asset", sCacheDir.c_str(), gDirUtilp->getDirDelimiter().c_str(), CACHE_FILENAME_PREFIX.c_str(), id.asString().c_str());
@@ -220,7 +476,7 @@ const std::string LLDiskCache::getCacheInfo()
     std::ostringstream cache_info;
 
     F32 max_in_mb = (F32)mMaxSizeBytes / (1024.0f * 1024.0f);
-    F32 percent_used = ((F32)dirFileSize(sCacheDir) / (F32)mMaxSizeBytes) * 100.0f;
+    F32 percent_used = ((F32)getCacheSize() / (F32)mMaxSizeBytes) * 100.0f;
 
     cache_info << std::fixed;
     cache_info << std::setprecision(1);
@@ -263,6 +519,8 @@ void LLDiskCache::clearCache()
             iter.increment(ec);
         }
     }
+
+    clearIndex();
 }
 
 void LLDiskCache::removeOldVFSFiles()
@@ -28,6 +28,11 @@
  *    directory, sorts them by date of last access (write) and then
  *    deletes any files based on age until the total size of all
  *    the files is less than the maximum size specified.
+ *    That directory walk is now only done once per session (and
+ *    periodically after that to catch files we did not see being
+ *    written) to build an in-memory index of the cache. LLFileSystem
+ *    keeps the index up to date as files are written, read, renamed
+ *    and removed, so a purge only touches the files it deletes.
  * 4/ An LLSingleton idiom is used since there will only ever be
  *    a single cache and we want to access it from numerous places.
  * 5/ Performance on my modest system seems very acceptable. For
@@ -63,6 +68,13 @@
 #define _LLDISKCACHE
 
 #include "llsingleton.h"
+#include "lluuid.h"
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 class LLDiskCache :
     public LLParamSingleton<LLDiskCache>
@@ -133,6 +145,23 @@ class LLDiskCache :
 
         void removeOldVFSFiles();
 
+        /**
+         * Total size of the cache files according to the index. Until the
+         * index has been built by the first purge, this walks the directory.
+         */
+        uintmax_t getCacheSize();
+
+        /**
+         * Hooks used by LLFileSystem to keep the index up to date. They can
+         * be called from any thread and do nothing if the cache does not
+         * exist (unit tests, tools). If grow_only is set the recorded size
+         * of the file is only ever increased (partial in place writes).
+         */
+        static void onFileWritten(const LLUUID& id, uintmax_t size, bool grow_only);
+        static void onFileRead(const LLUUID& id);
+        static void onFileRemoved(const LLUUID& id);
+        static void onFileRenamed(const LLUUID& old_id, const LLUUID& new_id);
+
     private:
         /**
          * Utility function to gather the total size the files in a given
@@ -141,6 +170,64 @@ class LLDiskCache :
          */
         uintmax_t dirFileSize(const std::string& dir);
 
+        /**
+         * Walk the cache directory and merge what is found on disk into the
+         * index. Entries already in the index keep their access time since
+         * it is more recent than the one on disk. Entries whose file is gone
+         * are dropped, and files not named by metaDataToFilepath() are
+         * ignored.
+         */
+        void scanCacheDir();
+
+        /**
+         * Drop the least recently used files until the cache fits in max_size.
+         * Returns the number of files evicted.
+         */
+        size_t evictFiles(uintmax_t max_size);
+
+        void updateEntry(const LLUUID& id, uintmax_t size, bool grow_only);
+        void touchEntry(const LLUUID& id);
+        bool removeEntry(const LLUUID& id, uintmax_t* size = nullptr);
+        void clearIndex();
+
+    private:
+        struct IndexEntry
+        {
+            uintmax_t                   mSize;
+            std::time_t                 mLastAccess;
+            std::list<LLUUID>::iterator mLRUPos;
+        };
+
+        /**
+         * The index is split in shards, each with its own lock, so that the
+         * fetch threads reading and writing different assets rarely contend.
+         */
+        struct IndexShard
+        {
+            std::mutex                              mMutex;
+            std::unordered_map<LLUUID, IndexEntry>  mEntries;
+            std::list<LLUUID>                       mLRU; // least recently used first
+        };
+
+        static constexpr size_t INDEX_SHARD_COUNT = 16;
+
+        IndexShard& getShard(const LLUUID& id) { return mIndexShards[std::hash<LLUUID>()(id) % INDEX_SHARD_COUNT]; }
+
+        std::array<IndexShard, INDEX_SHARD_COUNT> mIndexShards;
+        std::atomic<uintmax_t> mIndexSize;
+        std::atomic<bool> mIndexReady;
+
+        /**
+         * Time of the last directory walk, only used by purge()
+         */
+        std::time_t mLastScanTime;
+
+        /**
+         * purge() runs on LLPurgeDiskCacheThread but can also be invoked from
+         * the main thread (startup, debug menu)
+         */
+        std::mutex mPurgeMutex;
+
     private:
         /**
          * The maximum size of the cache in bytes. After purge is called, the
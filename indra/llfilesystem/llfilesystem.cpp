@@ -67,6 +67,7 @@ LLFileSystem::LLFileSystem(const LLUUID& file_id, const LLAssetType::EType file_
         if (exists)
         {
             updateFileAccessTime(filename);
+            LLDiskCache::onFileRead(mFileID);
         }
     }
 }
@@ -91,6 +92,7 @@ bool LLFileSystem::removeFile(const LLUUID& file_id, const LLAssetType::EType fi
     const std::string filename = LLDiskCache::metaDataToFilepath(file_id, file_type);
 
     LLFile::remove(filename.c_str(), suppress_error);
+    LLDiskCache::onFileRemoved(file_id);
 
     return true;
 }
@@ -110,6 +112,10 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
         //return false;
         LL_WARNS() << "Failed to rename " << old_file_id << " to " << new_file_id << " reason: " << strerror(errno) << LL_ENDL;
     }
+    else
+    {
+        LLDiskCache::onFileRenamed(old_file_id, new_file_id);
+    }
 
     return true;
 }
@@ -187,6 +193,7 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
             mPosition = (S32)ofs.tellp();
 
             success = true;
+            LLDiskCache::onFileWritten(mFileID, mPosition, false);
         }
     }
     else if (mMode == READ_WRITE)
@@ -199,6 +206,7 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
             ofs.write((const char*)buffer, bytes);
             mPosition += bytes;
             success = true;
+            LLDiskCache::onFileWritten(mFileID, mPosition, true);
         }
         else
         {
@@ -209,6 +217,7 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
                 ofs.write((const char*)buffer, bytes);
                 mPosition += bytes;
                 success = true;
+                LLDiskCache::onFileWritten(mFileID, mPosition, false);
             }
         }
     }
@@ -222,6 +231,8 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
             mPosition += bytes;
 
             success = true;
+            // every write in this mode truncates the file
+            LLDiskCache::onFileWritten(mFileID, bytes, false);
         }
     }
 
@@ -0,0 +1,309 @@
+/**
+ * @file llmappedfile.cpp
+ * @brief Read-only memory mapped view of a file on disk.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmappedfile.h"
+
+#if LL_WINDOWS
+#include "llwin32headers.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+LLMappedFile::LLMappedFile()
+:   mData(nullptr),
+    mSize(0),
+    mWritable(false),
+#if LL_WINDOWS
+    mFileHandle(INVALID_HANDLE_VALUE),
+    mMappingHandle(NULL)
+#else
+    mFD(-1)
+#endif
+{
+}
+
+LLMappedFile::~LLMappedFile()
+{
+    close();
+}
+
+#if LL_WINDOWS
+
+bool LLMappedFile::open(const std::string& filename)
+{
+    close();
+
+    // Share everything: the owner of the file keeps appending to it and may
+    // rename a compacted copy over it while older mappings are still alive.
+    std::wstring utf16filename = ll_convert<std::wstring>(filename);
+    HANDLE file = CreateFileW(utf16filename.c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping)
+    {
+        LL_WARNS() << "CreateFileMapping failed for " << filename << ": " << GetLastError() << LL_ENDL;
+        CloseHandle(file);
+        return false;
+    }
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data)
+    {
+        LL_WARNS() << "MapViewOfFile failed for " << filename << ": " << GetLastError() << LL_ENDL;
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    mFileHandle = file;
+    mMappingHandle = mapping;
+    mData = (const U8*)data;
+    mSize = (size_t)size.QuadPart;
+    mFilename = filename;
+    return true;
+}
+
+bool LLMappedFile::openWritable(const std::string& filename, size_t size)
+{
+    close();
+
+    std::wstring utf16filename = ll_convert<std::wstring>(filename);
+    HANDLE file = CreateFileW(utf16filename.c_str(), GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+    if ((size_t)file_size.QuadPart < size)
+    {
+        file_size.QuadPart = (LONGLONG)size;
+        if (!SetFilePointerEx(file, file_size, NULL, FILE_BEGIN) || !SetEndOfFile(file))
+        {
+            LL_WARNS() << "Failed to resize " << filename << ": " << GetLastError() << LL_ENDL;
+            CloseHandle(file);
+            return false;
+        }
+    }
+    if (file_size.QuadPart <= 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READWRITE, 0, 0, NULL);
+    if (!mapping)
+    {
+        LL_WARNS() << "CreateFileMapping failed for " << filename << ": " << GetLastError() << LL_ENDL;
+        CloseHandle(file);
+        return false;
+    }
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0);
+    if (!data)
+    {
+        LL_WARNS() << "MapViewOfFile failed for " << filename << ": " << GetLastError() << LL_ENDL;
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    mFileHandle = file;
+    mMappingHandle = mapping;
+    mData = (const U8*)data;
+    mSize = (size_t)file_size.QuadPart;
+    mWritable = true;
+    mFilename = filename;
+    return true;
+}
+
+bool LLMappedFile::flush()
+{
+    if (!mData || !mWritable)
+    {
+        return false;
+    }
+    return FlushViewOfFile((LPCVOID)mData, 0) && FlushFileBuffers((HANDLE)mFileHandle);
+}
+
+void LLMappedFile::close()
+{
+    if (mData)
+    {
+        UnmapViewOfFile((LPCVOID)mData);
+        mData = nullptr;
+    }
+    if (mMappingHandle)
+    {
+        CloseHandle((HANDLE)mMappingHandle);
+        mMappingHandle = NULL;
+    }
+    if (mFileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle((HANDLE)mFileHandle);
+        mFileHandle = INVALID_HANDLE_VALUE;
+    }
+    mSize = 0;
+    mWritable = false;
+    mFilename.clear();
+}
+
+#else // !LL_WINDOWS
+
+bool LLMappedFile::open(const std::string& filename)
+{
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    struct stat file_status;
+    if (::fstat(fd, &file_status) != 0 || file_status.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)file_status.st_size;
+    void* data = ::mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        LL_WARNS() << "mmap failed for " << filename << ": " << errno << LL_ENDL;
+        ::close(fd);
+        return false;
+    }
+
+    mFD = fd;
+    mData = (const U8*)data;
+    mSize = size;
+    mFilename = filename;
+    return true;
+}
+
+bool LLMappedFile::openWritable(const std::string& filename, size_t size)
+{
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    struct stat file_status;
+    if (::fstat(fd, &file_status) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    size_t file_size = (size_t)file_status.st_size;
+    if (file_size < size)
+    {
+        if (::ftruncate(fd, (off_t)size) != 0)
+        {
+            LL_WARNS() << "Failed to resize " << filename << ": " << errno << LL_ENDL;
+            ::close(fd);
+            return false;
+        }
+        file_size = size;
+    }
+    if (file_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* data = ::mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        LL_WARNS() << "mmap failed for " << filename << ": " << errno << LL_ENDL;
+        ::close(fd);
+        return false;
+    }
+
+    mFD = fd;
+    mData = (const U8*)data;
+    mSize = file_size;
+    mWritable = true;
+    mFilename = filename;
+    return true;
+}
+
+bool LLMappedFile::flush()
+{
+    if (!mData || !mWritable)
+    {
+        return false;
+    }
+    return ::msync((void*)mData, mSize, MS_SYNC) == 0;
+}
+
+void LLMappedFile::close()
+{
+    if (mData)
+    {
+        ::munmap((void*)mData, mSize);
+        mData = nullptr;
+    }
+    if (mFD != -1)
+    {
+        ::close(mFD);
+        mFD = -1;
+    }
+    mSize = 0;
+    mWritable = false;
+    mFilename.clear();
+}
+
+#endif // LL_WINDOWS
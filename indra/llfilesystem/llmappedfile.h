@@ -0,0 +1,80 @@
+/**
+ * @file llmappedfile.h
+ * @brief Memory mapped view of a file on disk, read-only or read-write.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMAPPEDFILE_H
+#define LL_LLMAPPEDFILE_H
+
+#include <string>
+
+// Maps the whole of a file into the address space of the process: read-only
+// with open(), read-write with openWritable().
+// The mapping is a snapshot of the file length when it was opened: data
+// appended to the file afterwards is only visible after re-opening it.
+// Pointers returned by getData() and getWritableData() stay valid until
+// close() or destruction, so callers handing out views into the mapping
+// usually hold it by shared_ptr.
+class LLMappedFile
+{
+public:
+    LLMappedFile();
+    ~LLMappedFile();
+
+    LLMappedFile(const LLMappedFile&) = delete;
+    LLMappedFile& operator=(const LLMappedFile&) = delete;
+
+    // Returns false if the file does not exist, is empty or cannot be mapped.
+    bool open(const std::string& filename);
+
+    // Maps the file read-write, creating it or growing it to at least size
+    // bytes first (size 0 maps an existing file as is). Stores through
+    // getWritableData() land in the page cache, so they survive the process
+    // being killed; flush() forces them out to disk.
+    bool openWritable(const std::string& filename, size_t size);
+    bool flush();
+
+    void close();
+
+    bool isOpen() const         { return mData != nullptr; }
+    bool isWritable() const     { return mWritable; }
+    const U8* getData() const   { return mData; }
+    U8* getWritableData() const { return mWritable ? const_cast<U8*>(mData) : nullptr; }
+    size_t getSize() const      { return mSize; }
+    const std::string& getFilename() const { return mFilename; }
+
+private:
+    const U8*   mData;
+    size_t      mSize;
+    bool        mWritable;
+    std::string mFilename;
+#if LL_WINDOWS
+    void*       mFileHandle;
+    void*       mMappingHandle;
+#else
+    int         mFD;
+#endif
+};
+
+#endif // LL_LLMAPPEDFILE_H
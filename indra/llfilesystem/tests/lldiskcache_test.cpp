@@ -0,0 +1,172 @@
+/**
+ * @file lldiskcache_test.cpp
+ * @brief Test the disk cache index and purge
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "lltut.h"
+#include "../test/lltestapp.h"
+
+#include "../llfilesystem.h"
+#include "../lldiskcache.h"
+#include "lldir.h"
+#include "lltimer.h"
+
+namespace tut
+{
+    struct LLDiskCacheFixture
+    {
+        LLDiskCacheFixture()
+        {
+            mCacheDir = gDirUtilp->add(LLFile::tmpdir(), llformat("lldiskcache_test_%d", (S32)LLTimer::getTotalTime()));
+        }
+
+        ~LLDiskCacheFixture()
+        {
+            if (LLDiskCache::instanceExists())
+            {
+                LLDiskCache::getInstance()->clearCache();
+                LLDiskCache::deleteSingleton();
+            }
+            LLFile::rmdir(mCacheDir);
+        }
+
+        LLDiskCache& initCache(uintmax_t max_size_bytes)
+        {
+            return LLDiskCache::initParamSingleton(mCacheDir, max_size_bytes, false);
+        }
+
+        void writeFile(const LLUUID& id, S32 size)
+        {
+            std::vector<U8> data(size, 0xa5);
+            LLFileSystem file(id, LLAssetType::AT_TEXTURE, LLFileSystem::WRITE);
+            file.write(data.data(), size);
+        }
+
+        LLTestApp mApp;
+        std::string mCacheDir;
+    };
+    typedef test_group<LLDiskCacheFixture> LLDiskCacheTest_factory;
+    typedef LLDiskCacheTest_factory::object LLDiskCacheTest_t;
+    LLDiskCacheTest_factory tf("LLDiskCache");
+
+    template<> template<>
+    void LLDiskCacheTest_t::test<1>()
+    {
+        set_test_name("index follows LLFileSystem and purges least recently used first");
+
+        LLDiskCache& cache = initCache(2500);
+
+        LLUUID ids[4];
+        for (LLUUID& id : ids)
+        {
+            id.generate();
+            writeFile(id, 1000);
+        }
+        ensure_equals("index size before first purge", cache.getCacheSize(), 4000);
+
+        // reading the first file makes the second the oldest one
+        LLFileSystem reader(ids[0], LLAssetType::AT_TEXTURE, LLFileSystem::READ);
+
+        cache.purge();
+        ensure_equals("index size after purge", cache.getCacheSize(), 2000);
+        ensure("recently read file kept", LLFileSystem::getExists(ids[0], LLAssetType::AT_TEXTURE));
+        ensure("oldest file evicted", !LLFileSystem::getExists(ids[1], LLAssetType::AT_TEXTURE));
+        ensure("second oldest file evicted", !LLFileSystem::getExists(ids[2], LLAssetType::AT_TEXTURE));
+        ensure("newest file kept", LLFileSystem::getExists(ids[3], LLAssetType::AT_TEXTURE));
+
+        LLFileSystem::removeFile(ids[3], LLAssetType::AT_TEXTURE);
+        ensure_equals("index size after remove", cache.getCacheSize(), 1000);
+    }
+
+    template<> template<>
+    void LLDiskCacheTest_t::test<2>()
+    {
+        set_test_name("index is rebuilt from the cache directory");
+
+        {
+            initCache(1000000);
+            for (S32 i = 0; i < 10; ++i)
+            {
+                writeFile(LLUUID::generateNewID(), 100);
+            }
+            LLDiskCache::deleteSingleton();
+        }
+
+        LLDiskCache& cache = initCache(1000000);
+        cache.purge();
+        ensure_equals("index size after scan", cache.getCacheSize(), 1000);
+    }
+
+    template<> template<>
+    void LLDiskCacheTest_t::test<3>()
+    {
+        set_test_name("purge evicts entries known only to the index");
+
+        const S32 NUM_ENTRIES = 2000;
+        const uintmax_t ENTRY_SIZE = 64 * 1024;
+
+        LLDiskCache& cache = initCache(NUM_ENTRIES * ENTRY_SIZE / 2);
+        cache.purge(); // build the (empty) index
+
+        // fake entries, as if written by the fetch threads
+        for (S32 i = 0; i < NUM_ENTRIES; ++i)
+        {
+            LLDiskCache::onFileWritten(LLUUID::generateNewID(), ENTRY_SIZE, false);
+        }
+
+        cache.purge();
+        ensure_equals("cache size after purge", cache.getCacheSize(), NUM_ENTRIES * ENTRY_SIZE / 2);
+        cache.purge();
+        ensure_equals("nothing more to evict", cache.getCacheSize(), NUM_ENTRIES * ENTRY_SIZE / 2);
+    }
+
+    template<> template<>
+    void LLDiskCacheTest_t::test<4>()
+    {
+        set_test_name("scan drops files removed behind our back and leaves unknown files alone");
+
+        LLDiskCache& cache = initCache(1000000);
+        LLUUID ids[4];
+        for (LLUUID& id : ids)
+        {
+            id.generate();
+            writeFile(id, 100);
+        }
+
+        const std::string unknown_file = gDirUtilp->add(mCacheDir, "sl_cache_not_an_asset");
+        {
+            llofstream unknown(unknown_file.c_str(), std::ios::binary);
+            unknown << "kept";
+        }
+
+        LLFile::remove(LLDiskCache::metaDataToFilepath(ids[1], LLAssetType::AT_TEXTURE));
+        // entries used since the scan started are kept, the access time has a one second resolution
+        ms_sleep(1100);
+        cache.purge();
+        ensure_equals("index size after scan", cache.getCacheSize(), 300);
+        ensure("unknown file kept", LLFile::isfile(unknown_file));
+        LLFile::remove(unknown_file);
+    }
+}
@@ -30,6 +30,11 @@
 #include "llimage.h"
 
 #include "llmath.h"
+#include "llsimdmath.h"
+#include "threadpool.h"
+#if defined(__SSE4_1__) && !LL_ARM64
+#include <smmintrin.h>
+#endif
 #include "v4coloru.h"
 #include "v3color.h"
 
@@ -42,6 +47,7 @@
 #include "llmemory.h"
 
 #include <boost/preprocessor.hpp>
+#include <thread>
 
 //..................................................................................
 //..................................................................................
@@ -220,16 +226,16 @@ private:
 };
 
 
+// Scalar reference scaler: fills destination rows [y_begin, y_end).
 template<U8 ch>
-inline void bilinear_scale(
-    const U8 *src, U32 srcW, U32 srcH, U32 srcStride
-    , U8 *dst, U32 dstW, U32 dstH, U32 dstStride
+inline void bilinear_scale_rows(
+    const scale_info<ch> &info, U32 srcStride
+    , U8 *dst, U32 dstW, U32 dstStride
+    , U32 y_begin, U32 y_end
     )
 {
     typedef scale_info<ch> scale_info_t;
 
-    scale_info_t info(src, srcW, srcH, dstW, dstH, srcStride);
-
     const U8 *sptr;
     U8 *dptr;
     U32 x, y;
@@ -240,7 +246,7 @@ inline void bilinear_scale(
 
     if(3 == info.xup_yup)
     { //scale x/y - up
-        for(y = 0; y < dstH; ++y)
+        for(y = y_begin; y < y_end; ++y)
         {
             dptr = dst + (y * dstStride);
             sptr = info.ystrides[y];
@@ -329,7 +335,7 @@ inline void bilinear_scale(
         S32 Cy, j;
         S32 yap;
 
-        for(y = 0; y < dstH; y++)
+        for(y = y_begin; y < y_end; y++)
         {
             Cy = info.yapoints[y] >> 16;
             yap = info.yapoints[y] & 0xffff;
@@ -396,7 +402,7 @@ inline void bilinear_scale(
         S32 Cx, j;
         S32 xap;
 
-        for(y = 0; y < dstH; y++)
+        for(y = y_begin; y < y_end; y++)
         {
             dptr = dst + (y * dstStride);
 
@@ -463,7 +469,7 @@ inline void bilinear_scale(
         S32 Cx, Cy, i, j;
         S32 xap, yap;
 
-        for(y = 0; y < dstH; y++)
+        for(y = y_begin; y < y_end; y++)
         {
             Cy = info.yapoints[y] >> 16;
             yap = info.yapoints[y] & 0xffff;
@@ -557,6 +563,426 @@ inline void bilinear_scale(
     } //else
 }
 
+//..................................................................................
+// Vectorized kernels.  One pixel's channels sit in the four 32 bit lanes of an
+// SSE2 register, and every step does exactly the integer (or float) arithmetic
+// of the scalar code above, so results are bit-identical; the scalar versions
+// stay as the reference (see LLImage::setUseVectorKernels()).
+//..................................................................................
+
+namespace
+{
+    // Widens one pixel to S32 lanes.  Reads exactly ch bytes.
+    template<U8 ch>
+    inline __m128i load_px(const U8 *pix)
+    {
+        U32 packed;
+        if (ch == 4)
+        {
+            memcpy(&packed, pix, 4);
+        }
+        else
+        {
+            packed = pix[0] | (pix[1] << 8) | (pix[2] << 16);
+        }
+        const __m128i zero = _mm_setzero_si128();
+        return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+    }
+
+    // Writes the low byte of each lane, like the scalar "*dptr++ = comp[c]&0xff".
+    template<U8 ch>
+    inline void store_px(U8 *&dptr, __m128i comp)
+    {
+        comp = _mm_and_si128(comp, _mm_set1_epi32(0xff));
+        comp = _mm_packs_epi32(comp, comp);
+        const U32 packed = _mm_cvtsi128_si32(_mm_packus_epi16(comp, comp));
+        if (ch == 4)
+        {
+            memcpy(dptr, &packed, 4);
+        }
+        else
+        {
+            dptr[0] = U8(packed);
+            dptr[1] = U8(packed >> 8);
+            dptr[2] = U8(packed >> 16);
+        }
+        dptr += ch;
+    }
+
+    // Lanes of a widened pixel (0..255) times val, 0 <= val < 32768.
+    inline __m128i mul_px(__m128i px, S32 val)
+    {
+        return _mm_madd_epi16(px, _mm_set1_epi32(val));
+    }
+
+    // Full 32 bit lane multiply for accumulators that outgrow 16 bits.
+    inline __m128i mul_acc(__m128i acc, S32 val)
+    {
+        const __m128i v = _mm_set1_epi32(val);
+#if defined(__SSE4_1__)
+        return _mm_mullo_epi32(acc, v);
+#else
+        const __m128i even = _mm_mul_epu32(acc, v);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(acc, 32), _mm_srli_epi64(v, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+    }
+
+    // Area weighted sum along a run of pixels step bytes apart, as in the
+    // scalar downscaling loops: first pixel by ap, then C each until the
+    // 1<<14 budget is spent.
+    template<U8 ch>
+    inline __m128i sum_run(const U8 *pix, S32 step, S32 ap, S32 C)
+    {
+        __m128i sum = mul_px(load_px<ch>(pix), ap);
+        pix += step;
+        S32 j;
+        for (j = (1 << 14) - ap; j > C; j -= C, pix += step)
+        {
+            sum = _mm_add_epi32(sum, mul_px(load_px<ch>(pix), C));
+        }
+        if (j > 0)
+        {
+            sum = _mm_add_epi32(sum, mul_px(load_px<ch>(pix), j));
+        }
+        return sum;
+    }
+}
+
+// Vector counterpart of bilinear_scale_rows() for 3 and 4 channels.
+template<U8 ch>
+void bilinear_scale_rows_simd(
+    const scale_info<ch> &info, U32 srcStride
+    , U8 *dst, U32 dstW, U32 dstStride
+    , U32 y_begin, U32 y_end
+    )
+{
+    const S32 stride = (S32)srcStride;
+
+    if (3 == info.xup_yup)
+    { //scale x/y - up
+        for (U32 y = y_begin; y < y_end; ++y)
+        {
+            U8 *dptr = dst + (y * dstStride);
+            const U8 *sptr = info.ystrides[y];
+            const S32 yap = info.yapoints[y];
+
+            for (U32 x = 0; x < dstW; ++x)
+            {
+                const S32 xap = info.xapoints[x];
+                const U8 *pix = sptr + info.xpoints[x] * ch;
+                if (0 < yap)
+                {
+                    if (0 < xap)
+                    {
+                        __m128i comp = _mm_add_epi32(mul_px(load_px<ch>(pix), 256 - xap), mul_px(load_px<ch>(pix + ch), xap));
+                        pix += stride;
+                        __m128i cx = _mm_add_epi32(mul_px(load_px<ch>(pix + ch), xap), mul_px(load_px<ch>(pix), 256 - xap));
+                        comp = _mm_srai_epi32(_mm_add_epi32(mul_acc(cx, yap), mul_acc(comp, 256 - yap)), 16);
+                        store_px<ch>(dptr, comp);
+                    }
+                    else
+                    {
+                        __m128i comp = mul_px(load_px<ch>(pix), 256 - yap);
+                        comp = _mm_srai_epi32(_mm_add_epi32(comp, mul_px(load_px<ch>(pix + stride), yap)), 8);
+                        store_px<ch>(dptr, comp);
+                    }
+                }
+                else
+                {
+                    // the scalar code blends the pixel with itself here,
+                    // which is a plain copy
+                    store_px<ch>(dptr, load_px<ch>(pix));
+                }
+            }
+        }
+    }
+    else if (info.xup_yup == 1)
+    { //scaling down vertically
+        for (U32 y = y_begin; y < y_end; ++y)
+        {
+            const S32 Cy = info.yapoints[y] >> 16;
+            const S32 yap = info.yapoints[y] & 0xffff;
+            U8 *dptr = dst + (y * dstStride);
+
+            for (U32 x = 0; x < dstW; ++x)
+            {
+                const U8 *pix = info.ystrides[y] + info.xpoints[x] * ch;
+                __m128i comp = sum_run<ch>(pix, stride, yap, Cy);
+                const S32 xap = info.xapoints[x];
+                if (xap > 0)
+                {
+                    __m128i cx = sum_run<ch>(pix + ch, stride, yap, Cy);
+                    comp = _mm_srai_epi32(_mm_add_epi32(mul_acc(comp, 256 - xap), mul_acc(cx, xap)), 12);
+                }
+                else
+                {
+                    comp = _mm_srai_epi32(comp, 4);
+                }
+                store_px<ch>(dptr, _mm_srai_epi32(comp, 10));
+            }
+        }
+    }
+    else if (info.xup_yup == 2)
+    { // scaling down horizontally
+        for (U32 y = y_begin; y < y_end; ++y)
+        {
+            const S32 yap = info.yapoints[y];
+            U8 *dptr = dst + (y * dstStride);
+
+            for (U32 x = 0; x < dstW; ++x)
+            {
+                const S32 Cx = info.xapoints[x] >> 16;
+                const S32 xap = info.xapoints[x] & 0xffff;
+                const U8 *pix = info.ystrides[y] + info.xpoints[x] * ch;
+                __m128i comp = sum_run<ch>(pix, ch, xap, Cx);
+                if (yap > 0)
+                {
+                    __m128i cx = sum_run<ch>(pix + stride, ch, xap, Cx);
+                    comp = _mm_srai_epi32(_mm_add_epi32(mul_acc(comp, 256 - yap), mul_acc(cx, yap)), 12);
+                }
+                else
+                {
+                    comp = _mm_srai_epi32(comp, 4);
+                }
+                store_px<ch>(dptr, _mm_srai_epi32(comp, 10));
+            }
+        }
+    }
+    else
+    { //scale x/y - down
+        for (U32 y = y_begin; y < y_end; ++y)
+        {
+            const S32 Cy = info.yapoints[y] >> 16;
+            const S32 yap = info.yapoints[y] & 0xffff;
+            U8 *dptr = dst + (y * dstStride);
+
+            for (U32 x = 0; x < dstW; ++x)
+            {
+                const S32 Cx = info.xapoints[x] >> 16;
+                const S32 xap = info.xapoints[x] & 0xffff;
+
+                const U8 *sptr = info.ystrides[y] + info.xpoints[x] * ch;
+                __m128i cx = sum_run<ch>(sptr, ch, xap, Cx);
+                sptr += stride;
+                __m128i comp = mul_acc(_mm_srai_epi32(cx, 5), yap);
+
+                S32 j;
+                for (j = (1 << 14) - yap; j > Cy; j -= Cy, sptr += stride)
+                {
+                    cx = sum_run<ch>(sptr, ch, xap, Cx);
+                    comp = _mm_add_epi32(comp, mul_acc(_mm_srai_epi32(cx, 5), Cy));
+                }
+                if (j > 0)
+                {
+                    cx = sum_run<ch>(sptr, ch, xap, Cx);
+                    comp = _mm_add_epi32(comp, mul_acc(_mm_srai_epi32(cx, 5), j));
+                }
+
+                store_px<ch>(dptr, _mm_srai_epi32(comp, 23));
+            }
+        }
+    }
+}
+
+// Calls fn(begin, end) over bands covering [0, rows).  Images of at least
+// PARALLEL_MIN_BYTES are split across LLImage's worker pool, if there is
+// one and more than one core to run it on; the calling thread always takes
+// part.
+template<typename FN>
+static void for_each_row_band(U32 rows, U32 row_bytes, const FN& fn)
+{
+    constexpr U32 PARALLEL_MIN_BYTES = 256 * 1024;
+    static const bool multi_core = std::thread::hardware_concurrency() > 1;
+
+    LL::ThreadPoolBase* pool = LLImage::getThreadPool();
+    if (!pool || !multi_core || rows < 2 || (U64)rows * row_bytes < PARALLEL_MIN_BYTES)
+    {
+        fn(0, rows);
+        return;
+    }
+
+    // a few bands per thread evens out rows of unequal cost
+    const U32 bands = llmin(rows, (U32)(pool->getWidth() + 1) * 4);
+    pool->forkJoin(bands, [&](size_t band)
+                   {
+                       fn(U32(rows * band / bands), U32(rows * (band + 1) / bands));
+                   });
+}
+
+template<U8 ch>
+inline void bilinear_scale(
+    const U8 *src, U32 srcW, U32 srcH, U32 srcStride
+    , U8 *dst, U32 dstW, U32 dstH, U32 dstStride
+    )
+{
+    const scale_info<ch> info(src, srcW, srcH, dstW, dstH, srcStride);
+    const bool vector = LLImage::useVectorKernels();
+
+    for_each_row_band(dstH, dstW * ch, [&](U32 y_begin, U32 y_end)
+                      {
+                          if constexpr (ch > 1)
+                          {
+                              if (vector)
+                              {
+                                  bilinear_scale_rows_simd<ch>(info, srcStride, dst, dstW, dstStride, y_begin, y_end);
+                                  return;
+                              }
+                          }
+                          bilinear_scale_rows<ch>(info, srcStride, dst, dstW, dstStride, y_begin, y_end);
+                      });
+}
+
+namespace
+{
+    template<U8 ch>
+    inline __m128 load_px_f(const U8 *pix)
+    {
+        return _mm_cvtepi32_ps(load_px<ch>(pix));
+    }
+
+    // Box filtered pixel over input pixels index0..index1 (step bytes
+    // apart), weighted, normalized and rounded the way copyLineScaled()
+    // does it per channel.  The sums are never negative, so truncating
+    // after adding a half is ll_round().
+    template<U8 ch>
+    inline __m128i box_px(const U8 *in, S32 step, S32 in_pixel_len, S32 index0, S32 index1, F32 fract0, F32 fract1, F32 norm_factor)
+    {
+        __m128 acc = _mm_mul_ps(load_px_f<ch>(in + index0 * step), _mm_set1_ps(fract0));
+        for (S32 u = index0 + 1; u < index1; u++)
+        {
+            acc = _mm_add_ps(acc, load_px_f<ch>(in + u * step));
+        }
+        if (fract1 && index1 < in_pixel_len)
+        {
+            acc = _mm_add_ps(acc, _mm_mul_ps(load_px_f<ch>(in + index1 * step), _mm_set1_ps(fract1)));
+        }
+        acc = _mm_mul_ps(acc, _mm_set1_ps(norm_factor));
+        return _mm_cvttps_epi32(_mm_add_ps(acc, _mm_set1_ps(0.5f)));
+    }
+
+    template<U8 ch>
+    void copy_line_scaled_simd(const U8 *in, U8 *out, S32 in_pixel_len, S32 out_pixel_len, S32 in_step, S32 out_step)
+    {
+        const F32 ratio = F32(in_pixel_len) / out_pixel_len; // ratio of old to new
+        const F32 norm_factor = 1.f / ratio;
+
+        for (S32 x = 0; x < out_pixel_len; x++)
+        {
+            const F32 sample0 = x * ratio;
+            const F32 sample1 = (x+1) * ratio;
+            const S32 index0 = llfloor(sample0);
+            const S32 index1 = llfloor(sample1);
+            const F32 fract0 = 1.f - (sample0 - F32(index0));
+            const F32 fract1 = sample1 - F32(index1);
+
+            U8 *outp = out + x * out_step;
+            if (index0 == index1)
+            {
+                memcpy(outp, in + index0 * in_step, ch);
+            }
+            else
+            {
+                store_px<ch>(outp, box_px<ch>(in, in_step, in_pixel_len, index0, index1, fract0, fract1, norm_factor));
+            }
+        }
+    }
+
+    // Sixteen bytes widened to float lanes.
+    inline void load16_f(const U8 *p, __m128 f[4])
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i v = _mm_loadu_si128((const __m128i*) p);
+        const __m128i lo = _mm_unpacklo_epi8(v, zero);
+        const __m128i hi = _mm_unpackhi_epi8(v, zero);
+        f[0] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+        f[1] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+        f[2] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+        f[3] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+    }
+
+    // Vertical box filter a whole row at a time: output rows
+    // [y_begin, y_end) of a row_bytes wide image.  Each byte goes through the
+    // same float steps as copyLineScaled() would give it walking down its
+    // column, but the loads are contiguous.
+    void box_scale_rows(const U8 *in, S32 in_rows, U8 *out, S32 out_rows, U32 row_bytes, U32 y_begin, U32 y_end)
+    {
+        const F32 ratio = F32(in_rows) / out_rows; // ratio of old to new
+        const F32 norm_factor = 1.f / ratio;
+        const __m128 norm4 = _mm_set1_ps(norm_factor);
+        const __m128 half4 = _mm_set1_ps(0.5f);
+
+        for (U32 y = y_begin; y < y_end; ++y)
+        {
+            const F32 sample0 = y * ratio;
+            const F32 sample1 = (y+1) * ratio;
+            const S32 index0 = llfloor(sample0);
+            const S32 index1 = llfloor(sample1);
+            const F32 fract0 = 1.f - (sample0 - F32(index0));
+            const F32 fract1 = sample1 - F32(index1);
+            const bool right = fract1 && index1 < in_rows;
+
+            U8 *outp = out + y * row_bytes;
+            if (index0 == index1)
+            {
+                memcpy(outp, in + index0 * row_bytes, row_bytes);
+                continue;
+            }
+
+            const __m128 fract0_4 = _mm_set1_ps(fract0);
+            const __m128 fract1_4 = _mm_set1_ps(fract1);
+            U32 i = 0;
+            for (; i + 16 <= row_bytes; i += 16)
+            {
+                __m128 acc[4], px[4];
+                load16_f(in + index0 * row_bytes + i, px);
+                for (S32 k = 0; k < 4; ++k)
+                {
+                    acc[k] = _mm_mul_ps(px[k], fract0_4);
+                }
+                for (S32 u = index0 + 1; u < index1; u++)
+                {
+                    load16_f(in + u * row_bytes + i, px);
+                    for (S32 k = 0; k < 4; ++k)
+                    {
+                        acc[k] = _mm_add_ps(acc[k], px[k]);
+                    }
+                }
+                if (right)
+                {
+                    load16_f(in + index1 * row_bytes + i, px);
+                    for (S32 k = 0; k < 4; ++k)
+                    {
+                        acc[k] = _mm_add_ps(acc[k], _mm_mul_ps(px[k], fract1_4));
+                    }
+                }
+                __m128i q[4];
+                for (S32 k = 0; k < 4; ++k)
+                {
+                    q[k] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(acc[k], norm4), half4));
+                }
+                const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(q[0], q[1]), _mm_packs_epi32(q[2], q[3]));
+                _mm_storeu_si128((__m128i*) (outp + i), packed);
+            }
+            for (; i < row_bytes; ++i)
+            {
+                F32 r = in[index0 * row_bytes + i] * fract0;
+                for (S32 u = index0 + 1; u < index1; u++)
+                {
+                    r += in[u * row_bytes + i];
+                }
+                if (right)
+                {
+                    r += in[index1 * row_bytes + i] * fract1;
+                }
+                r *= norm_factor;
+                outp[i] = U8(ll_round(r));
+            }
+        }
+    }
+}
+
 //wrapper
 static void bilinear_scale(const U8 *src, U32 srcW, U32 srcH, U32 srcCh, U32 srcStride, U8 *dst, U32 dstW, U32 dstH, U32 dstCh, U32 dstStride)
 {
@@ -588,6 +1014,8 @@ static void bilinear_scale(const U8 *src, U32 srcW, U32 srcH, U32 srcCh, U32 src
 thread_local std::string LLImage::sLastThreadErrorMessage;
 bool LLImage::sUseNewByteRange = false;
 S32  LLImage::sMinimalReverseByteRangePercent = 75;
+std::atomic<LL::ThreadPoolBase*> LLImage::sThreadPool{ nullptr };
+std::atomic<bool> LLImage::sUseVectorKernels{ true };
 
 //static
 void LLImage::initClass(bool use_new_byte_range, S32 minimal_reverse_byte_range_percent)
@@ -1242,21 +1670,44 @@ void LLImageRaw::compositeScaled4onto3(const LLImageRaw* src)
 
     llassert( (4 == src->getComponents()) && (3 == dst->getComponents()) );
 
-    S32 temp_data_size = src->getWidth() * dst->getHeight() * src->getComponents();
-    llassert_always(temp_data_size > 0);
-    std::vector<U8> temp_buffer(temp_data_size);
+    // The intermediate image carries the source's 4 components, so the
+    // vertical pass below steps through the source with the right pixel size.
+    LLPointer<LLImageRaw> temp = new LLImageRaw(src->getWidth(), dst->getHeight(), src->getComponents());
+    if (temp->isBufferInvalid())
+    {
+        LL_WARNS() << "Failed to allocate temporary image buffer" << LL_ENDL;
+        return;
+    }
+    U8* temp_buffer = temp->getData();
+
+    const U32 src_row_bytes = src->getComponents() * src->getWidth();
+    const U32 dst_row_bytes = dst->getComponents() * dst->getWidth();
 
     // Vertical: scale but no composite
-    for( S32 col = 0; col < src->getWidth(); col++ )
+    if (LLImage::useVectorKernels())
     {
-        copyLineScaled( src->getData() + (src->getComponents() * col), &temp_buffer[0] + (src->getComponents() * col), src->getHeight(), dst->getHeight(), src->getWidth(), src->getWidth() );
+        // whole rows at a time rather than walking down each column
+        for_each_row_band(dst->getHeight(), src_row_bytes, [&](U32 y_begin, U32 y_end)
+                          {
+                              box_scale_rows(src->getData(), src->getHeight(), temp_buffer, dst->getHeight(), src_row_bytes, y_begin, y_end);
+                          });
     }
-
-    // Horizontal: scale and composite
-    for( S32 row = 0; row < dst->getHeight(); row++ )
+    else
     {
-        compositeRowScaled4onto3( &temp_buffer[0] + (src->getComponents() * src->getWidth() * row), dst->getData() + (dst->getComponents() * dst->getWidth() * row), src->getWidth(), dst->getWidth() );
+        for( S32 col = 0; col < src->getWidth(); col++ )
+        {
+            temp->copyLineScaled( src->getData() + (src->getComponents() * col), temp_buffer + (src->getComponents() * col), src->getHeight(), dst->getHeight(), src->getWidth(), src->getWidth() );
+        }
     }
+
+    // Horizontal: scale and composite
+    for_each_row_band(dst->getHeight(), dst_row_bytes, [&](U32 y_begin, U32 y_end)
+                      {
+                          for( U32 row = y_begin; row < y_end; row++ )
+                          {
+                              compositeRowScaled4onto3( temp_buffer + (src_row_bytes * row), dst->getData() + (dst_row_bytes * row), src->getWidth(), dst->getWidth() );
+                          }
+                      });
 }
 
 
@@ -1488,7 +1939,16 @@ void LLImageRaw::copyScaled4onto3(const LLImageRaw* src)
 {
     llassert( (4 == src->getComponents()) && (3 == getComponents()) );
 
-    // Slow, but simple.  Optimize later if needed.
+    // Channels scale independently, so drop alpha on whichever side of the
+    // scale has fewer pixels.
+    if (getWidth() * getHeight() < src->getWidth() * src->getHeight())
+    {
+        LLImageRaw temp( getWidth(), getHeight(), 4);
+        temp.copyScaled( src );
+        copyUnscaled4onto3( &temp );
+        return;
+    }
+
     LLImageRaw temp( src->getWidth(), src->getHeight(), 3);
     temp.copyUnscaled4onto3( src );
     copyScaled( &temp );
@@ -1734,6 +2194,19 @@ void LLImageRaw::copyLineScaled( const U8* in, U8* out, S32 in_pixel_len, S32 ou
     const S32 components = getComponents();
     llassert( components >= 1 && components <= 4 );
 
+    if (LLImage::useVectorKernels() && (components == 3 || components == 4))
+    {
+        if (components == 4)
+        {
+            copy_line_scaled_simd<4>(in, out, in_pixel_len, out_pixel_len, in_pixel_step * 4, out_pixel_step * 4);
+        }
+        else
+        {
+            copy_line_scaled_simd<3>(in, out, in_pixel_len, out_pixel_len, in_pixel_step * 3, out_pixel_step * 3);
+        }
+        return;
+    }
+
     const F32 ratio = F32(in_pixel_len) / out_pixel_len; // ratio of old to new
     const F32 norm_factor = 1.f / ratio;
 
@@ -1875,9 +2348,19 @@ void LLImageRaw::compositeRowScaled4onto3( const U8* in, U8* out, S32 in_pixel_l
             // Interval is embedded in one input pixel
             S32 t1 = index0 * IN_COMPONENTS;
             in_scaled_r = in[t1 + 0];
-            in_scaled_g = in[t1 + 0];
-            in_scaled_b = in[t1 + 0];
-            in_scaled_a = in[t1 + 0];
+            in_scaled_g = in[t1 + 1];
+            in_scaled_b = in[t1 + 2];
+            in_scaled_a = in[t1 + 3];
+        }
+        else if (LLImage::useVectorKernels())
+        {
+            U8 scaled[IN_COMPONENTS];
+            U8* scaledp = scaled;
+            store_px<IN_COMPONENTS>(scaledp, box_px<IN_COMPONENTS>(in, IN_COMPONENTS, in_pixel_len, index0, index1, fract0, fract1, norm_factor));
+            in_scaled_r = scaled[0];
+            in_scaled_g = scaled[1];
+            in_scaled_b = scaled[2];
+            in_scaled_a = scaled[3];
         }
         else
         {
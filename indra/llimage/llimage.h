@@ -33,6 +33,8 @@
 #include "lltrace.h"
 #include "lluuid.h"
 
+namespace LL { class ThreadPoolBase; }
+
 constexpr S32 MIN_IMAGE_MIP =  2; // 4x4, only used for expand/contract power of 2
 constexpr S32 MAX_IMAGE_MIP = 12; // 4096x4096
 
@@ -103,10 +105,22 @@ public:
     static bool useNewByteRange() { return sUseNewByteRange; }
     static S32  getReverseByteRangePercent() { return sMinimalReverseByteRangePercent; }
 
+    // Pool over which large scale and composite operations are split by
+    // rows; null (the default) keeps them on the calling thread.
+    static void setThreadPool(LL::ThreadPoolBase* pool) { sThreadPool = pool; }
+    static LL::ThreadPoolBase* getThreadPool() { return sThreadPool; }
+
+    // The SSE2 scale and composite kernels are used by default; the scalar
+    // ones remain as the reference they must match bit for bit.
+    static void setUseVectorKernels(bool use) { sUseVectorKernels = use; }
+    static bool useVectorKernels() { return sUseVectorKernels; }
+
 protected:
     static thread_local std::string sLastThreadErrorMessage;
     static bool sUseNewByteRange;
     static S32  sMinimalReverseByteRangePercent;
+    static std::atomic<LL::ThreadPoolBase*> sThreadPool;
+    static std::atomic<bool> sUseVectorKernels;
 };
 
 //============================================================================
@@ -69,11 +69,18 @@ LLImageDecodeThread::LLImageDecodeThread(bool /*threaded*/)
 {
     mThreadPool = std::make_unique<LL::ThreadPool>("ImageDecode", 8);
     mThreadPool->start();
+    // large scales and composites borrow the decode workers
+    LLImage::setThreadPool(mThreadPool.get());
 }
 
 //virtual
 LLImageDecodeThread::~LLImageDecodeThread()
-{}
+{
+    if (LLImage::getThreadPool() == mThreadPool.get())
+    {
+        LLImage::setThreadPool(nullptr);
+    }
+}
 
 // MAIN THREAD
 // virtual
@@ -119,6 +126,7 @@ LLImageDecodeThread::handle_t LLImageDecodeThread::decodeImage(
 
 void LLImageDecodeThread::shutdown()
 {
+    LLImage::setThreadPool(nullptr);
     mThreadPool->close();
 }
 
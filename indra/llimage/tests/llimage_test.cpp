@@ -0,0 +1,192 @@
+/**
+ * @file   llimage_test.cpp
+ * @brief LLImageRaw scale and composite kernel tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llimage.h"
+#include "threadpool.h"
+#include "../test/lltut.h"
+
+namespace
+{
+    LLPointer<LLImageRaw> make_noise(S32 width, S32 height, S8 components, U32 seed)
+    {
+        LLPointer<LLImageRaw> image = new LLImageRaw(width, height, components);
+        U8* data = image->getData();
+        for (S32 i = 0; i < image->getDataSize(); ++i)
+        {
+            seed = seed * 1664525 + 1013904223;
+            data[i] = U8(seed >> 24);
+        }
+        return image;
+    }
+
+    LLPointer<LLImageRaw> copy_of(const LLImageRaw* src)
+    {
+        LLPointer<LLImageRaw> image = new LLImageRaw(src->getWidth(), src->getHeight(), src->getComponents());
+        memcpy(image->getData(), src->getData(), src->getDataSize());
+        return image;
+    }
+
+    bool same_pixels(const LLImageRaw* a, const LLImageRaw* b)
+    {
+        return a->getWidth() == b->getWidth() && a->getHeight() == b->getHeight()
+            && a->getComponents() == b->getComponents()
+            && memcmp(a->getData(), b->getData(), a->getDataSize()) == 0;
+    }
+
+    // exposes the protected line and channel conversion helpers
+    class TestImage : public LLImageRaw
+    {
+    public:
+        TestImage(U16 width, U16 height, S8 components): LLImageRaw(width, height, components) {}
+        using LLImageRaw::copyLineScaled;
+        using LLImageRaw::copyScaled4onto3;
+    };
+
+    // sizes covering up and down scaling on each axis, including odd and
+    // non-integer ratios
+    const S32 SIZES[][4] = {
+        { 64, 64, 32, 32 },
+        { 64, 64, 128, 128 },
+        { 37, 53, 100, 21 },
+        { 100, 21, 37, 53 },
+        { 256, 128, 75, 75 },
+        { 17, 9, 17, 40 },
+        { 300, 200, 299, 201 },
+    };
+}
+
+namespace tut
+{
+    struct image_data
+    {
+        ~image_data()
+        {
+            LLImage::setUseVectorKernels(true);
+            LLImage::setThreadPool(nullptr);
+        }
+    };
+    typedef test_group<image_data> image_group;
+    typedef image_group::object image_object;
+    tut::image_group tut_image_test("LLImageRaw");
+
+    template<> template<>
+    void image_object::test<1>()
+    {
+        set_test_name("vector scale matches scalar");
+        for (S8 components : { 1, 3, 4 })
+        {
+            for (const auto& size : SIZES)
+            {
+                LLPointer<LLImageRaw> src = make_noise(size[0], size[1], components, size[0] * 31 + components);
+
+                LLImage::setUseVectorKernels(false);
+                LLPointer<LLImageRaw> expected = src->scaled(size[2], size[3]);
+                LLImage::setUseVectorKernels(true);
+                LLPointer<LLImageRaw> actual = src->scaled(size[2], size[3]);
+
+                ensure(llformat("%dx%dx%d -> %dx%d", size[0], size[1], components, size[2], size[3]),
+                       same_pixels(expected, actual));
+            }
+        }
+    }
+
+    template<> template<>
+    void image_object::test<2>()
+    {
+        set_test_name("vector composite matches scalar");
+        for (const auto& size : SIZES)
+        {
+            LLPointer<LLImageRaw> src = make_noise(size[0], size[1], 4, size[1] * 17);
+            LLPointer<LLImageRaw> base = make_noise(size[2], size[3], 3, size[3] * 5);
+
+            LLImage::setUseVectorKernels(false);
+            LLPointer<LLImageRaw> expected = copy_of(base);
+            expected->composite(src);
+            LLImage::setUseVectorKernels(true);
+            LLPointer<LLImageRaw> actual = copy_of(base);
+            actual->composite(src);
+
+            ensure(llformat("%dx%d onto %dx%d", size[0], size[1], size[2], size[3]), same_pixels(expected, actual));
+        }
+    }
+
+    template<> template<>
+    void image_object::test<3>()
+    {
+        set_test_name("copyLineScaled and 4 onto 3 copies match scalar");
+        for (const auto& size : SIZES)
+        {
+            for (S8 components : { 3, 4 })
+            {
+                LLPointer<LLImageRaw> src = make_noise(size[0], 1, components, size[0]);
+                LLPointer<TestImage> expected = new TestImage(size[2], 1, components);
+                LLPointer<TestImage> actual = new TestImage(size[2], 1, components);
+                LLImage::setUseVectorKernels(false);
+                expected->copyLineScaled(src->getData(), expected->getData(), size[0], size[2], 1, 1);
+                LLImage::setUseVectorKernels(true);
+                actual->copyLineScaled(src->getData(), actual->getData(), size[0], size[2], 1, 1);
+                ensure(llformat("line %d -> %d x%d", size[0], size[2], components), same_pixels(expected, actual));
+            }
+
+            // the old route: drop alpha at full size, then scale
+            LLPointer<LLImageRaw> src = make_noise(size[0], size[1], 4, size[0] + size[1]);
+            LLPointer<LLImageRaw> rgb = new LLImageRaw(size[0], size[1], 3);
+            rgb->copyUnscaled4onto3(src);
+            LLPointer<LLImageRaw> expected = new LLImageRaw(size[2], size[3], 3);
+            expected->copyScaled(rgb);
+            LLPointer<TestImage> actual = new TestImage(size[2], size[3], 3);
+            actual->copyScaled4onto3(src);
+            ensure(llformat("4 onto 3 %dx%d -> %dx%d", size[0], size[1], size[2], size[3]), same_pixels(expected, actual));
+        }
+    }
+
+    template<> template<>
+    void image_object::test<4>()
+    {
+        set_test_name("row parallel scale and composite match serial");
+        LL::ThreadPool pool("LLImage test", 3);
+        pool.start();
+
+        LLPointer<LLImageRaw> src = make_noise(1024, 768, 4, 99);
+        LLPointer<LLImageRaw> base = make_noise(700, 500, 3, 7);
+
+        LLPointer<LLImageRaw> down = src->scaled(700, 500);
+        LLPointer<LLImageRaw> up = src->scaled(1500, 1100);
+        LLPointer<LLImageRaw> composited = copy_of(base);
+        composited->composite(src);
+
+        LLImage::setThreadPool(&pool);
+        ensure("downscale", same_pixels(down, src->scaled(700, 500)));
+        ensure("upscale", same_pixels(up, src->scaled(1500, 1100)));
+        LLPointer<LLImageRaw> parallel = copy_of(base);
+        parallel->composite(src);
+        ensure("composite", same_pixels(composited, parallel));
+        LLImage::setThreadPool(nullptr);
+        pool.close();
+    }
+}
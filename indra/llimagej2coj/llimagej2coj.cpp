@@ -30,9 +30,15 @@
  // this is defined so that we get static linking.
 #include "openjpeg.h"
 
+#include "hbxxh.h"
 #include "lltimer.h"
 //#include "llmemory.h"
 
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 // Factory function: see declaration in llimagej2c.cpp
 LLImageJ2CImpl* fallbackCreateLLImageJ2CImpl()
 {
@@ -93,6 +99,161 @@ int ceildivpow2(int a, int b)
     return (a + (1 << b) - 1) >> b;
 }
 
+// OpenJPEG cannot carry on a decode at a finer resolution level, so each
+// step down in discard level decodes the codestream from scratch. What we
+// can avoid is decoding the same data again: textures are re-decoded at the
+// same level when reloaded from the texture cache or when the discard bias
+// goes back down. Those are served from a copy of the earlier decode.
+namespace
+{
+    const size_t DEFAULT_DECODE_CACHE_BUDGET = 32 * 1024 * 1024;
+    // one 1024x1024 RGBA texture, bigger ones would flush everything else
+    const size_t MAX_DECODE_CACHE_ENTRY = 4 * 1024 * 1024;
+
+    class LLJ2CDecodeCache
+    {
+    public:
+        static LLJ2CDecodeCache& instance()
+        {
+            static LLJ2CDecodeCache cache;
+            return cache;
+        }
+
+        // Identifies one decode: the whole codestream and how it is decoded.
+        // Entries also keep the decode parameters, which fetch() compares.
+        static U64 makeKey(const U8* data, S32 data_size, S32 reduce, S32 first_channel, S32 max_channel_count)
+        {
+            const S32 params[] = { data_size, reduce, first_channel, max_channel_count };
+            HBXXH64 hash(data, data_size, false);
+            hash.update(params, sizeof(params));
+            return hash.digest();
+        }
+
+        // Fills raw_image from an earlier decode of the same data with the
+        // same parameters.
+        bool fetch(U64 key, S32 data_size, S32 reduce, S32 first_channel, S32 max_channel_count, LLImageRaw& raw_image);
+        void store(U64 key, S32 data_size, S32 reduce, S32 first_channel, S32 max_channel_count, const LLImageRaw& raw_image);
+        void setBudget(size_t bytes);
+
+    private:
+        struct Entry
+        {
+            U64 mKey;
+            S32 mDataSize;
+            S32 mReduce;
+            S32 mFirstChannel;
+            S32 mMaxChannelCount;
+            S32 mWidth;
+            S32 mHeight;
+            S32 mChannels;
+            std::shared_ptr<const std::vector<U8> > mPixels;
+        };
+        typedef std::list<Entry> entry_list_t;
+
+        void trim();
+
+        std::mutex mMutex;
+        entry_list_t mEntries; // most recently used first
+        std::unordered_map<U64, entry_list_t::iterator> mEntryMap;
+        size_t mBytes = 0;
+        size_t mBudget = DEFAULT_DECODE_CACHE_BUDGET;
+    };
+
+    bool LLJ2CDecodeCache::fetch(U64 key, S32 data_size, S32 reduce, S32 first_channel, S32 max_channel_count, LLImageRaw& raw_image)
+    {
+        Entry entry;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto found = mEntryMap.find(key);
+            if (found == mEntryMap.end())
+            {
+                return false;
+            }
+            entry = *found->second;
+            if (entry.mDataSize != data_size
+                || entry.mReduce != reduce
+                || entry.mFirstChannel != first_channel
+                || entry.mMaxChannelCount != max_channel_count)
+            {
+                return false;
+            }
+            mEntries.splice(mEntries.begin(), mEntries, found->second);
+        }
+
+        if (!raw_image.resize(entry.mWidth, entry.mHeight, entry.mChannels) || !raw_image.getData())
+        {
+            return false;
+        }
+        memcpy(raw_image.getData(), entry.mPixels->data(), entry.mPixels->size());
+        return true;
+    }
+
+    void LLJ2CDecodeCache::store(U64 key, S32 data_size, S32 reduce, S32 first_channel, S32 max_channel_count, const LLImageRaw& raw_image)
+    {
+        size_t size = (size_t)raw_image.getWidth() * raw_image.getHeight() * raw_image.getComponents();
+        if (size > MAX_DECODE_CACHE_ENTRY || raw_image.getComponents() > 4 || !raw_image.getData())
+        {
+            return;
+        }
+
+        Entry entry;
+        entry.mKey = key;
+        entry.mDataSize = data_size;
+        entry.mReduce = reduce;
+        entry.mFirstChannel = first_channel;
+        entry.mMaxChannelCount = max_channel_count;
+        entry.mWidth = raw_image.getWidth();
+        entry.mHeight = raw_image.getHeight();
+        entry.mChannels = raw_image.getComponents();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (size > mBudget)
+        {
+            return;
+        }
+        // copy outside of the map updates but under the lock, so a budget
+        // change cannot slip in between
+        entry.mPixels = std::make_shared<const std::vector<U8> >(raw_image.getData(), raw_image.getData() + size);
+
+        auto found = mEntryMap.find(key);
+        if (found != mEntryMap.end())
+        {
+            // decoded twice at once, or a key collision: keep the latest
+            mBytes -= found->second->mPixels->size();
+            mEntries.erase(found->second);
+        }
+        mEntries.push_front(std::move(entry));
+        mEntryMap[key] = mEntries.begin();
+        mBytes += size;
+        trim();
+    }
+
+    void LLJ2CDecodeCache::setBudget(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBudget = bytes;
+        trim();
+    }
+
+    // mMutex must be locked
+    void LLJ2CDecodeCache::trim()
+    {
+        while (mBytes > mBudget && !mEntries.empty())
+        {
+            const Entry& oldest = mEntries.back();
+            mBytes -= oldest.mPixels->size();
+            mEntryMap.erase(oldest.mKey);
+            mEntries.pop_back();
+        }
+    }
+}
+
+//static
+void LLImageJ2COJ::setDecodeCacheBudget(size_t bytes)
+{
+    LLJ2CDecodeCache::instance().setBudget(bytes);
+}
+
 
 LLImageJ2COJ::LLImageJ2COJ()
     : LLImageJ2CImpl()
@@ -124,6 +285,13 @@ bool LLImageJ2COJ::decodeImpl(LLImageJ2C& base, LLImageRaw& raw_image, F32 decod
 
     LLTimer decode_timer;
 
+    S32 reduce = base.getRawDiscardLevel();
+    U64 cache_key = LLJ2CDecodeCache::makeKey(base.getData(), base.getDataSize(), reduce, first_channel, max_channel_count);
+    if (LLJ2CDecodeCache::instance().fetch(cache_key, base.getDataSize(), reduce, first_channel, max_channel_count, raw_image))
+    {
+        return true; // done
+    }
+
     opj_dparameters_t parameters;	/* decompression parameters */
     opj_event_mgr_t event_mgr = { };		/* event manager */
     opj_image_t* image = nullptr;
@@ -140,7 +308,7 @@ bool LLImageJ2COJ::decodeImpl(LLImageJ2C& base, LLImageRaw& raw_image, F32 decod
     /* set decoding parameters to default values */
     opj_set_default_decoder_parameters(&parameters);
 
-    parameters.cp_reduce = base.getRawDiscardLevel();
+    parameters.cp_reduce = reduce;
 
     /* decode the code-stream */
     /* ---------------------- */
@@ -263,6 +431,8 @@ bool LLImageJ2COJ::decodeImpl(LLImageJ2C& base, LLImageRaw& raw_image, F32 decod
     /* free image data structure */
     opj_image_destroy(image);
 
+    LLJ2CDecodeCache::instance().store(cache_key, base.getDataSize(), reduce, first_channel, max_channel_count, raw_image);
+
     return true; // done
 }
 
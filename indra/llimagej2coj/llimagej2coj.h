@@ -34,6 +34,10 @@ class LLImageJ2COJ : public LLImageJ2CImpl
 public:
     LLImageJ2COJ();
     virtual ~LLImageJ2COJ();
+
+    // Bytes of recently decoded images kept to serve repeated decodes of
+    // the same texture. 0 disables the cache.
+    static void setDecodeCacheBudget(size_t bytes);
 protected:
     virtual bool getMetadata(LLImageJ2C& base);
     virtual bool decodeImpl(LLImageJ2C& base, LLImageRaw& raw_image, F32 decode_time, S32 first_channel, S32 max_channel_count);
@@ -0,0 +1,182 @@
+/**
+ * @file llimagej2coj_test.cpp
+ * @brief OpenJPEG decode cache tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llimagej2coj.h"
+#include "llimagej2c.h"
+#include "../test/lltut.h"
+
+#include <vector>
+
+namespace
+{
+    // smooth enough to compress like a real texture, with some noise
+    LLPointer<LLImageRaw> make_texture(S32 width, S32 height, S8 components, U32 seed)
+    {
+        LLPointer<LLImageRaw> image = new LLImageRaw(width, height, components);
+        U8* data = image->getData();
+        for (S32 y = 0; y < height; ++y)
+        {
+            for (S32 x = 0; x < width; ++x)
+            {
+                for (S32 c = 0; c < components; ++c)
+                {
+                    seed = seed * 1664525 + 1013904223;
+                    S32 value = (x * (c + 1) + y * (3 - c)) * 248 / (4 * width + 3 * height);
+                    *data++ = (U8)(value + (seed >> 29));
+                }
+            }
+        }
+        return image;
+    }
+
+    LLPointer<LLImageJ2C> encode(const LLImageRaw* raw)
+    {
+        LLPointer<LLImageJ2C> j2c = new LLImageJ2C;
+        if (!j2c->encode(raw, 0.f))
+        {
+            return nullptr;
+        }
+        return j2c;
+    }
+
+    // the codestream truncated to the byte range fetched for discard
+    LLPointer<LLImageJ2C> truncated(LLImageJ2C* full, S32 discard)
+    {
+        LLPointer<LLImageJ2C> part = new LLImageJ2C;
+        S32 size = llmin(full->calcDataSize(discard), full->getDataSize());
+        memcpy(part->allocateData(size), full->getData(), size);
+        part->updateData();
+        part->setDiscardLevel(discard);
+        return part;
+    }
+
+    LLPointer<LLImageRaw> decode(LLImageJ2C* j2c)
+    {
+        LLPointer<LLImageRaw> raw = new LLImageRaw;
+        if (!j2c->decode(raw, 0.f))
+        {
+            return nullptr;
+        }
+        return raw;
+    }
+
+    bool same_pixels(const LLImageRaw* a, const LLImageRaw* b)
+    {
+        return a->getWidth() == b->getWidth() && a->getHeight() == b->getHeight()
+            && a->getComponents() == b->getComponents()
+            && memcmp(a->getData(), b->getData(), a->getDataSize()) == 0;
+    }
+
+}
+
+namespace tut
+{
+    struct j2coj_data
+    {
+        j2coj_data()
+        {
+            LLImage::initClass();
+            LLImageJ2COJ::setDecodeCacheBudget(0);
+        }
+        ~j2coj_data()
+        {
+            LLImageJ2COJ::setDecodeCacheBudget(32 * 1024 * 1024);
+            LLImage::cleanupClass();
+        }
+    };
+    typedef test_group<j2coj_data> j2coj_group;
+    typedef j2coj_group::object j2coj_object;
+    tut::j2coj_group tut_j2coj_test("LLImageJ2COJ");
+
+    template<> template<>
+    void j2coj_object::test<1>()
+    {
+        set_test_name("cached decodes match fresh decodes");
+        LLPointer<LLImageJ2C> full = encode(make_texture(300, 200, 4, 7));
+        ensure("encode", full.notNull());
+
+        std::vector<LLPointer<LLImageRaw> > expected;
+        for (S32 discard = 0; discard <= 5; ++discard)
+        {
+            expected.push_back(decode(truncated(full, discard)));
+            ensure(llformat("decode at %d", discard), expected.back().notNull());
+        }
+
+        LLImageJ2COJ::setDecodeCacheBudget(32 * 1024 * 1024);
+        LLPointer<LLImageRaw> fine = decode(truncated(full, 0));
+        ensure("fresh decode through the cache", same_pixels(expected[0], fine));
+        ensure("repeated decode", same_pixels(expected[0], decode(truncated(full, 0))));
+
+        // coarser levels are decoded, not derived from the finer decode
+        for (S32 discard = 1; discard <= 5; ++discard)
+        {
+            ensure(llformat("pixels at %d", discard), same_pixels(expected[discard], decode(truncated(full, discard))));
+        }
+        for (S32 discard = 0; discard <= 5; ++discard)
+        {
+            ensure(llformat("cached at %d", discard), same_pixels(expected[discard], decode(truncated(full, discard))));
+        }
+    }
+
+    template<> template<>
+    void j2coj_object::test<2>()
+    {
+        set_test_name("channel subsets are kept apart");
+        LLPointer<LLImageJ2C> full = encode(make_texture(128, 128, 4, 11));
+        ensure("encode", full.notNull());
+
+        LLImageJ2COJ::setDecodeCacheBudget(32 * 1024 * 1024);
+        LLPointer<LLImageRaw> rgba = decode(full);
+        LLPointer<LLImageRaw> alpha = new LLImageRaw;
+        full->decodeChannels(alpha, 0.f, 3, 1);
+        ensure_equals("alpha channels", (S32)alpha->getComponents(), 1);
+        for (S32 i = 0; i < alpha->getWidth() * alpha->getHeight(); ++i)
+        {
+            ensure_equals("alpha", alpha->getData()[i], rgba->getData()[i * 4 + 3]);
+        }
+    }
+
+    template<> template<>
+    void j2coj_object::test<3>()
+    {
+        set_test_name("textures sharing their first packets are kept apart");
+        LLPointer<LLImageRaw> raw = make_texture(256, 256, 3, 13);
+        LLPointer<LLImageJ2C> first = encode(raw);
+        // same main header and coarse packets, only the finest level differs
+        raw->getData()[raw->getDataSize() - 1] ^= 0x80;
+        LLPointer<LLImageJ2C> second = encode(raw);
+        ensure("encode", first.notNull() && second.notNull());
+        ensure("streams differ", first->getDataSize() != second->getDataSize()
+               || memcmp(first->getData(), second->getData(), first->getDataSize()) != 0);
+
+        LLPointer<LLImageRaw> expected = decode(second);
+        LLImageJ2COJ::setDecodeCacheBudget(32 * 1024 * 1024);
+        decode(first);
+        ensure("second texture", same_pixels(expected, decode(second)));
+    }
+}
@@ -0,0 +1,198 @@
+/**
+ * @file llmeshdequantize.cpp
+ * @brief Batched dequantization of the U16 vertex arrays in mesh LOD blocks
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmath.h"
+#include "llmeshdequantize.h"
+
+namespace
+{
+    // Widen eight U16s at p to two float quads.
+    inline void load8(const U16* p, LLQuad& lo, LLQuad& hi)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i v = _mm_loadu_si128((const __m128i*) p);
+        lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero));
+        hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero));
+    }
+
+    // Widen four U16s at p to one float quad.
+    inline LLQuad load4(const U16* p)
+    {
+        __m128i v = _mm_loadl_epi64((const __m128i*) p);
+        return _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, _mm_setzero_si128()));
+    }
+
+    // Expand count packed xyz triples, applying out = in/65535 * scale + bias
+    // per component. Four vertices (12 U16s) load as three quads laid out
+    // xyzx yzxy zxyz, so each quad gets a correspondingly rotated copy of
+    // scale and bias; then shuffles regroup them into one quad per vertex,
+    // with w taken from w_value.
+    void expand_xyz(const U16* in, U32 count, const LLVector4a& scale,
+                    const LLVector4a& bias, const LLVector4a& w_value, LLVector4a* out)
+    {
+        const LLQuad div = _mm_set1_ps(65535.f);
+        const LLQuad s0 = (LLQuad) scale;
+        const LLQuad b0 = (LLQuad) bias;
+        // rotations matching the xyzx, yzxy, zxyz lanes
+        const LLQuad sa = _mm_shuffle_ps(s0, s0, _MM_SHUFFLE(0, 2, 1, 0));
+        const LLQuad sb = _mm_shuffle_ps(s0, s0, _MM_SHUFFLE(1, 0, 2, 1));
+        const LLQuad sc = _mm_shuffle_ps(s0, s0, _MM_SHUFFLE(2, 1, 0, 2));
+        const LLQuad ba = _mm_shuffle_ps(b0, b0, _MM_SHUFFLE(0, 2, 1, 0));
+        const LLQuad bb = _mm_shuffle_ps(b0, b0, _MM_SHUFFLE(1, 0, 2, 1));
+        const LLQuad bc = _mm_shuffle_ps(b0, b0, _MM_SHUFFLE(2, 1, 0, 2));
+
+        // w is a constant: clear the computed lane and or in the wanted one
+        const LLQuad xyz_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+        const LLQuad w_bits = _mm_andnot_ps(xyz_mask, (LLQuad) w_value);
+
+        U32 i = 0;
+        for (; i + 4 <= count; i += 4, in += 12, out += 4)
+        {
+            LLQuad a, b;
+            load8(in, a, b);
+            LLQuad c = load4(in + 8);
+
+            a = _mm_add_ps(_mm_mul_ps(_mm_div_ps(a, div), sa), ba);
+            b = _mm_add_ps(_mm_mul_ps(_mm_div_ps(b, div), sb), bb);
+            c = _mm_add_ps(_mm_mul_ps(_mm_div_ps(c, div), sc), bc);
+
+            // v0 = a0 a1 a2, v1 = a3 b0 b1, v2 = b2 b3 c0, v3 = c1 c2 c3
+            LLQuad t = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 3, 3));
+            LLQuad v0 = a;
+            LLQuad v1 = _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 3, 2, 0));
+            LLQuad v2 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 0, 3, 2));
+            LLQuad v3 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 3, 2, 1));
+
+            out[0] = _mm_or_ps(_mm_and_ps(v0, xyz_mask), w_bits);
+            out[1] = _mm_or_ps(_mm_and_ps(v1, xyz_mask), w_bits);
+            out[2] = _mm_or_ps(_mm_and_ps(v2, xyz_mask), w_bits);
+            out[3] = _mm_or_ps(_mm_and_ps(v3, xyz_mask), w_bits);
+        }
+
+        // remainder, one vertex at a time
+        for (; i < count; ++i, in += 3, ++out)
+        {
+            LLVector4a v;
+            v.set((F32) in[0], (F32) in[1], (F32) in[2]);
+            v.div(65535.f);
+            v.mul(scale);
+            v.add(bias);
+            *out = _mm_or_ps(_mm_and_ps((LLQuad) v, xyz_mask), w_bits);
+        }
+    }
+} // anonymous namespace
+
+void LLMeshDequantize::positions(const U16* in, U32 count, const LLVector4a& min,
+                                 const LLVector4a& range, LLVector4a* out)
+{
+    // The scalar path leaves w = 0/65535 * range.w + min.w.
+    LLVector4a w_value;
+    w_value.setMul(LLVector4a::getZero(), range);
+    w_value.add(min);
+    expand_xyz(in, count, range, min, w_value, out);
+}
+
+void LLMeshDequantize::normals(const U16* in, U32 count, LLVector4a* out)
+{
+    LLVector4a scale(2.f);
+    LLVector4a bias(-1.f);
+    // The scalar path leaves w = 0/65535 * 2 - 1.
+    LLVector4a w_value(-1.f);
+    expand_xyz(in, count, scale, bias, w_value, out);
+}
+
+void LLMeshDequantize::texCoords(const U16* in, U32 count, const LLVector4a& min,
+                                 const LLVector4a& range, LLVector4a* out)
+{
+    const LLQuad div = _mm_set1_ps(65535.f);
+    const LLQuad scale = (LLQuad) range;
+    const LLQuad bias = (LLQuad) min;
+
+    // four texture coordinates (eight U16s) make two output quads
+    U32 i = 0;
+    for (; i + 4 <= count; i += 4, in += 8, out += 2)
+    {
+        LLQuad lo, hi;
+        load8(in, lo, hi);
+        out[0] = _mm_add_ps(_mm_mul_ps(_mm_div_ps(lo, div), scale), bias);
+        out[1] = _mm_add_ps(_mm_mul_ps(_mm_div_ps(hi, div), scale), bias);
+    }
+
+    texCoordsScalar(in, count - i, min, range, out);
+}
+
+void LLMeshDequantize::positionsScalar(const U16* in, U32 count, const LLVector4a& min,
+                                       const LLVector4a& range, LLVector4a* out)
+{
+    for (U32 j = 0; j < count; ++j)
+    {
+        out->set((F32) in[0], (F32) in[1], (F32) in[2]);
+        out->div(65535.f);
+        out->mul(range);
+        out->add(min);
+        out++;
+        in += 3;
+    }
+}
+
+void LLMeshDequantize::normalsScalar(const U16* in, U32 count, LLVector4a* out)
+{
+    for (U32 j = 0; j < count; ++j)
+    {
+        out->set((F32) in[0], (F32) in[1], (F32) in[2]);
+        out->div(65535.f);
+        out->mul(2.f);
+        out->sub(1.f);
+        out++;
+        in += 3;
+    }
+}
+
+void LLMeshDequantize::texCoordsScalar(const U16* in, U32 count, const LLVector4a& min,
+                                       const LLVector4a& range, LLVector4a* out)
+{
+    for (U32 j = 0; j < count; j += 2)
+    {
+        if (j < count - 1)
+        {
+            out->set((F32) in[0], (F32) in[1], (F32) in[2], (F32) in[3]);
+        }
+        else
+        {
+            out->set((F32) in[0], (F32) in[1], 0.f, 0.f);
+        }
+
+        in += 4;
+
+        out->div(65535.f);
+        out->mul(range);
+        out->add(min);
+
+        out++;
+    }
+}
@@ -0,0 +1,62 @@
+/**
+ * @file llmeshdequantize.h
+ * @brief Batched dequantization of the U16 vertex arrays in mesh LOD blocks
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESHDEQUANTIZE_H
+#define LL_LLMESHDEQUANTIZE_H
+
+#include "llvector4a.h"
+
+// Mesh LOD blocks store positions, normals and texture coordinates as
+// packed arrays of U16, each component scaled into [0, 65535] over a known
+// domain. These routines expand those arrays four vertices per iteration
+// straight from the binary payload. Their results are bit-identical to the
+// per-vertex LLVector4a code they replace (same divide, multiply and add per
+// lane), so callers may mix the two freely.
+namespace LLMeshDequantize
+{
+    // in: count * 3 U16s (x,y,z). out[i] = in/65535 * range + min, w = 0.
+    void positions(const U16* in, U32 count, const LLVector4a& min,
+                   const LLVector4a& range, LLVector4a* out);
+
+    // in: count * 3 U16s (x,y,z). out[i] = in/65535 * 2 - 1, w = -1.
+    void normals(const U16* in, U32 count, LLVector4a* out);
+
+    // in: count * 2 U16s (s,t). out holds two texture coordinates per
+    // LLVector4a, as LLVolumeFace::mTexCoords does; an odd final texture
+    // coordinate is padded with zeros. min and range are (s,t,s,t).
+    void texCoords(const U16* in, U32 count, const LLVector4a& min,
+                   const LLVector4a& range, LLVector4a* out);
+
+    // Scalar reference versions of the above, kept for tests and for
+    // benchmarking against.
+    void positionsScalar(const U16* in, U32 count, const LLVector4a& min,
+                         const LLVector4a& range, LLVector4a* out);
+    void normalsScalar(const U16* in, U32 count, LLVector4a* out);
+    void texCoordsScalar(const U16* in, U32 count, const LLVector4a& min,
+                         const LLVector4a& range, LLVector4a* out);
+}
+
+#endif // LL_LLMESHDEQUANTIZE_H
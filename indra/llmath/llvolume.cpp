@@ -33,6 +33,7 @@
 #endif
 #include <cmath>
 #include <unordered_map>
+#include <atomic>
 
 #include "llerror.h"
 
@@ -45,6 +46,8 @@
 #include "llmatrix3a.h"
 #include "lloctree.h"
 #include "llvolume.h"
+#include "llvolumebvh.h"
+#include "llmeshdequantize.h"
 #include "llstl.h"
 #include "llsdserialize.h"
 #include "llvector4a.h"
@@ -52,6 +55,7 @@
 #include "llmeshoptimizer.h"
 #include "lltimer.h"
 #include "llvolumeoctree.h"
+#include "threadpool.h"
 
 #include "mikktspace/mikktspace.hh"
 
@@ -2310,7 +2314,7 @@ bool LLVolumeFace::VertexData::compareNormal(const LLVolumeFace::VertexData& rhs
     return retval;
 }
 
-bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
+bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size, LL::ThreadPoolBase* pool)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
 
@@ -2323,10 +2327,10 @@ bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
         LL_DEBUGS("MeshStreaming") << "Failed to unzip LLSD blob for LoD with code " << uzip_result << " , will probably fetch from sim again." << LL_ENDL;
         return false;
     }
-    return unpackVolumeFacesInternal(mdl);
+    return unpackVolumeFacesInternal(mdl, pool);
 }
 
-bool LLVolume::unpackVolumeFaces(U8* in_data, S32 size)
+bool LLVolume::unpackVolumeFaces(U8* in_data, S32 size, LL::ThreadPoolBase* pool)
 {
     //input data is now pointing at a zlib compressed block of LLSD
     //decompress block
@@ -2337,10 +2341,10 @@ bool LLVolume::unpackVolumeFaces(U8* in_data, S32 size)
         LL_DEBUGS("MeshStreaming") << "Failed to unzip LLSD blob for LoD with code " << uzip_result << " , will probably fetch from sim again." << LL_ENDL;
         return false;
     }
-    return unpackVolumeFacesInternal(mdl);
+    return unpackVolumeFacesInternal(mdl, pool);
 }
 
-bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
+bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl, LL::ThreadPoolBase* pool)
 {
     {
         auto face_count = mdl.size();
@@ -2397,11 +2401,7 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
                 continue;
             }
 
-            U16* indices = (U16*) &(idx[0]);
-            for (U32 j = 0; j < num_indices; ++j)
-            {
-                face.mIndices[j] = indices[j];
-            }
+            memcpy(face.mIndices, &(idx[0]), num_indices * sizeof(U16));
 
             //copy out vertices
             U32 num_verts = static_cast<U32>(pos.size())/(3*2);
@@ -2450,41 +2450,18 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
             LLVector4a* norm_out = face.mNormals;
             LLVector4a* tc_out = (LLVector4a*) face.mTexCoords;
 
-            {
-                U16* v = (U16*) &(pos[0]);
-                for (U32 j = 0; j < num_verts; ++j)
-                {
-                    pos_out->set((F32) v[0], (F32) v[1], (F32) v[2]);
-                    pos_out->div(65535.f);
-                    pos_out->mul(pos_range);
-                    pos_out->add(min_pos);
-                    pos_out++;
-                    v += 3;
-                }
+            // Expand the quantized arrays straight from the binary payload.
+            LLMeshDequantize::positions((const U16*) &(pos[0]), num_verts, min_pos, pos_range, pos_out);
 
+            if (norm.size() >= num_verts * 3 * sizeof(U16))
+            {
+                LLMeshDequantize::normals((const U16*) &(norm[0]), num_verts, norm_out);
             }
-
+            else
             {
-                if (!norm.empty())
-                {
-                    U16* n = (U16*) &(norm[0]);
-                    for (U32 j = 0; j < num_verts; ++j)
-                    {
-                        norm_out->set((F32) n[0], (F32) n[1], (F32) n[2]);
-                        norm_out->div(65535.f);
-                        norm_out->mul(2.f);
-                        norm_out->sub(1.f);
-                        norm_out++;
-                        n += 3;
-                    }
-                }
-                else
+                for (U32 j = 0; j < num_verts; ++j)
                 {
-                    for (U32 j = 0; j < num_verts; ++j)
-                    {
-                        norm_out->clear();
-                        norm_out++; // or just norm_out[j].clear();
-                    }
+                    norm_out[j].clear();
                 }
             }
 
@@ -2516,37 +2493,16 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
             }
 #endif
 
+            if (tc.size() >= num_verts * 2 * sizeof(U16))
             {
-                if (!tc.empty())
-                {
-                    U16* t = (U16*) &(tc[0]);
-                    for (U32 j = 0; j < num_verts; j+=2)
-                    {
-                        if (j < num_verts-1)
-                        {
-                            tc_out->set((F32) t[0], (F32) t[1], (F32) t[2], (F32) t[3]);
-                        }
-                        else
-                        {
-                            tc_out->set((F32) t[0], (F32) t[1], 0.f, 0.f);
-                        }
-
-                        t += 4;
-
-                        tc_out->div(65535.f);
-                        tc_out->mul(tc_range);
-                        tc_out->add(min_tc4);
-
-                        tc_out++;
-                    }
-                }
-                else
+                LLMeshDequantize::texCoords((const U16*) &(tc[0]), num_verts, min_tc4, tc_range, tc_out);
+            }
+            else
+            {
+                for (U32 j = 0; j < num_verts; j += 2)
                 {
-                    for (U32 j = 0; j < num_verts; j += 2)
-                    {
-                        tc_out->clear();
-                        tc_out++;
-                    }
+                    tc_out->clear();
+                    tc_out++;
                 }
             }
 
@@ -2719,7 +2675,7 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
         }
     }
 
-    if (!cacheOptimize(true))
+    if (!cacheOptimize(true, pool))
     {
         // Out of memory?
         LL_WARNS() << "Failed to optimize!" << LL_ENDL;
@@ -2733,6 +2689,212 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
 }
 
 
+namespace
+{
+    const U32 DECODED_FACES_MAGIC = 0x444d4c4c; // "LLMD"
+
+    enum
+    {
+        DECODED_FACE_TANGENTS = 0x1,
+        DECODED_FACE_WEIGHTS = 0x2,
+    };
+
+    // Fixed size per-face record; the vertex and index arrays follow it,
+    // each padded to 16 bytes.
+    struct DecodedFaceRecord
+    {
+        S32 mNumVertices;
+        S32 mNumIndices;
+        U32 mFlags;
+        F32 mNormalizedScale[3];
+        F32 mTexCoordExtents[4];
+        F32 mExtents[12]; // min, max, center
+    };
+
+    void append_padded(std::vector<U8>& out, const void* src, size_t bytes)
+    {
+        const size_t padded = (bytes + 0xF) & ~size_t(0xF);
+        const size_t at = out.size();
+        out.resize(at + padded, 0);
+        if (bytes)
+        {
+            memcpy(out.data() + at, src, bytes);
+        }
+    }
+
+    class DecodedReader
+    {
+    public:
+        DecodedReader(const U8* data, size_t size) : mData(data), mSize(size), mPos(0) {}
+
+        bool read(void* dst, size_t bytes)
+        {
+            const size_t padded = (bytes + 0xF) & ~size_t(0xF);
+            if (padded > mSize - mPos)
+            {
+                return false;
+            }
+            if (bytes)
+            {
+                memcpy(dst, mData + mPos, bytes);
+            }
+            mPos += padded;
+            return true;
+        }
+
+        bool atEnd() const { return mPos == mSize; }
+
+    private:
+        const U8* mData;
+        size_t mSize;
+        size_t mPos;
+    };
+}
+
+bool LLVolume::packDecodedFaces(std::vector<U8>& out) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+
+    if (mVolumeFaces.empty() || mVolumeFaces.size() > (size_t)LL_SCULPT_MESH_MAX_FACES)
+    {
+        return false;
+    }
+
+    size_t total = 16;
+    for (const LLVolumeFace& face : mVolumeFaces)
+    {
+        total += sizeof(DecodedFaceRecord) + 16 + face.mNumVertices * (sizeof(LLVector4a) * 4 + sizeof(LLVector2))
+            + face.mNumIndices * sizeof(U16) + 64;
+    }
+    out.reserve(out.size() + total);
+
+    const U32 preamble[4] = { DECODED_FACES_MAGIC, DECODED_FACES_VERSION, (U32)mVolumeFaces.size(), 0 };
+    append_padded(out, preamble, sizeof(preamble));
+
+    for (const LLVolumeFace& face : mVolumeFaces)
+    {
+        const S32 num_verts = face.mPositions ? face.mNumVertices : 0;
+        const S32 num_indices = face.mIndices ? face.mNumIndices : 0;
+
+        DecodedFaceRecord rec;
+        rec.mNumVertices = num_verts;
+        rec.mNumIndices = num_indices;
+        rec.mFlags = 0;
+        if (num_verts && face.mTangents)
+        {
+            rec.mFlags |= DECODED_FACE_TANGENTS;
+        }
+        if (num_verts && face.mWeights)
+        {
+            rec.mFlags |= DECODED_FACE_WEIGHTS;
+        }
+        memcpy(rec.mNormalizedScale, face.mNormalizedScale.mV, sizeof(rec.mNormalizedScale));
+        memcpy(rec.mTexCoordExtents, face.mTexCoordExtents[0].mV, sizeof(F32) * 2);
+        memcpy(rec.mTexCoordExtents + 2, face.mTexCoordExtents[1].mV, sizeof(F32) * 2);
+        memcpy(rec.mExtents, face.mExtents, sizeof(rec.mExtents));
+        append_padded(out, &rec, sizeof(rec));
+
+        append_padded(out, face.mPositions, num_verts * sizeof(LLVector4a));
+        append_padded(out, face.mNormals, num_verts * sizeof(LLVector4a));
+        append_padded(out, face.mTexCoords, num_verts * sizeof(LLVector2));
+        if (rec.mFlags & DECODED_FACE_TANGENTS)
+        {
+            append_padded(out, face.mTangents, num_verts * sizeof(LLVector4a));
+        }
+        if (rec.mFlags & DECODED_FACE_WEIGHTS)
+        {
+            append_padded(out, face.mWeights, num_verts * sizeof(LLVector4a));
+        }
+        append_padded(out, face.mIndices, num_indices * sizeof(U16));
+    }
+
+    return true;
+}
+
+bool LLVolume::unpackDecodedFaces(const U8* data, size_t size)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+
+    DecodedReader reader(data, size);
+
+    U32 preamble[4];
+    if (!data || !reader.read(preamble, sizeof(preamble))
+        || preamble[0] != DECODED_FACES_MAGIC
+        || preamble[1] != DECODED_FACES_VERSION
+        || preamble[2] == 0 || preamble[2] > (U32)LL_SCULPT_MESH_MAX_FACES)
+    {
+        return false;
+    }
+
+    mVolumeFaces.clear();
+    mVolumeFaces.resize(preamble[2]);
+
+    bool ok = true;
+    for (LLVolumeFace& face : mVolumeFaces)
+    {
+        DecodedFaceRecord rec;
+        if (!reader.read(&rec, sizeof(rec))
+            || rec.mNumVertices < 0 || rec.mNumVertices > 65536
+            || rec.mNumIndices < 0 || rec.mNumIndices % 3 != 0)
+        {
+            ok = false;
+            break;
+        }
+
+        const S32 num_verts = rec.mNumVertices;
+        face.resizeVertices(num_verts);
+        face.resizeIndices(rec.mNumIndices);
+        if ((num_verts && !face.mPositions) || (rec.mNumIndices && !face.mIndices))
+        {
+            LL_WARNS() << "Failed to allocate decoded face with " << num_verts << " vertices" << LL_ENDL;
+            ok = false;
+            break;
+        }
+
+        face.mNormalizedScale.set(rec.mNormalizedScale);
+        face.mTexCoordExtents[0].set(rec.mTexCoordExtents[0], rec.mTexCoordExtents[1]);
+        face.mTexCoordExtents[1].set(rec.mTexCoordExtents[2], rec.mTexCoordExtents[3]);
+        memcpy(face.mExtents, rec.mExtents, sizeof(rec.mExtents));
+
+        ok = reader.read(face.mPositions, num_verts * sizeof(LLVector4a))
+            && reader.read(face.mNormals, num_verts * sizeof(LLVector4a))
+            && reader.read(face.mTexCoords, num_verts * sizeof(LLVector2));
+
+        if (ok && (rec.mFlags & DECODED_FACE_TANGENTS))
+        {
+            face.allocateTangents(num_verts);
+            ok = face.mTangents && reader.read(face.mTangents, num_verts * sizeof(LLVector4a));
+        }
+        if (ok && (rec.mFlags & DECODED_FACE_WEIGHTS))
+        {
+            face.allocateWeights(num_verts);
+            ok = face.mWeights && reader.read(face.mWeights, num_verts * sizeof(LLVector4a));
+        }
+        ok = ok && reader.read(face.mIndices, rec.mNumIndices * sizeof(U16));
+
+        // an out of range index would read past the vertex arrays at render time
+        for (S32 i = 0; ok && i < rec.mNumIndices; ++i)
+        {
+            ok = face.mIndices[i] < num_verts;
+        }
+        if (!ok)
+        {
+            break;
+        }
+
+        face.mOptimized = true;
+    }
+
+    if (!ok || !reader.atEnd())
+    {
+        mVolumeFaces.clear();
+        return false;
+    }
+
+    mSculptLevel = 0;
+    return true;
+}
+
 bool LLVolume::isMeshAssetLoaded() const
 {
     return mIsMeshAssetLoaded;
@@ -2778,8 +2940,38 @@ void LLVolume::copyVolumeFaces(const LLVolume* volume)
     mSculptLevel = 0;
 }
 
-bool LLVolume::cacheOptimize(bool gen_tangents)
+// Below this many indices in total, handing faces to other threads costs more
+// than optimizing them in place.
+constexpr S32 PARALLEL_OPTIMIZE_MIN_INDICES = 3000;
+
+bool LLVolume::cacheOptimize(bool gen_tangents, LL::ThreadPoolBase* pool)
 {
+    if (pool && mVolumeFaces.size() > 1)
+    {
+        S32 total_indices = 0;
+        for (const LLVolumeFace& face : mVolumeFaces)
+        {
+            total_indices += face.mNumIndices;
+        }
+
+        if (total_indices >= PARALLEL_OPTIMIZE_MIN_INDICES)
+        {
+            LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+            // Faces are independent: each one gets its own task, and any face
+            // failing fails the whole volume, as in the serial loop below.
+            std::atomic<bool> success{ true };
+            pool->forkJoin(mVolumeFaces.size(),
+                           [this, gen_tangents, &success](size_t i)
+                           {
+                               if (success && !mVolumeFaces[i].cacheOptimize(gen_tangents))
+                               {
+                                   success = false;
+                               }
+                           });
+            return success;
+        }
+    }
+
     for (S32 i = 0; i < mVolumeFaces.size(); ++i)
     {
         if (!mVolumeFaces[i].cacheOptimize(gen_tangents))
@@ -4237,6 +4429,70 @@ void LLVolume::generateSilhouetteVertices(std::vector<LLVector3> &vertices,
     }
 }
 
+// Fills in the attributes of a segment hit at barycentric a, b on the
+// triangle idx0, idx1, idx2 of face
+static void set_segment_hit(const LLVolumeFace& face, U16 idx0, U16 idx1, U16 idx2, F32 a, F32 b, F32 t,
+                            const LLVector4a& start, const LLVector4a& dir,
+                            LLVector4a* intersection, LLVector2* tex_coord, LLVector4a* normal, LLVector4a* tangent_out)
+{
+    if (intersection != NULL)
+    {
+        LLVector4a intersect = dir;
+        intersect.mul(t);
+        intersect.add(start);
+        *intersection = intersect;
+    }
+
+    if (tex_coord != NULL && face.mTexCoords)
+    {
+        LLVector2* tc = (LLVector2*) face.mTexCoords;
+        *tex_coord = ((1.f - a - b)  * tc[idx0] +
+            a              * tc[idx1] +
+            b              * tc[idx2]);
+
+    }
+
+    if (normal != NULL && face.mNormals)
+    {
+        LLVector4a* norm = face.mNormals;
+
+        LLVector4a n1,n2,n3;
+        n1 = norm[idx0];
+        n1.mul(1.f-a-b);
+
+        n2 = norm[idx1];
+        n2.mul(a);
+
+        n3 = norm[idx2];
+        n3.mul(b);
+
+        n1.add(n2);
+        n1.add(n3);
+
+        *normal     = n1;
+    }
+
+    if (tangent_out != NULL && face.mTangents)
+    {
+        LLVector4a* tangents = face.mTangents;
+
+        LLVector4a t1,t2,t3;
+        t1 = tangents[idx0];
+        t1.mul(1.f-a-b);
+
+        t2 = tangents[idx1];
+        t2.mul(a);
+
+        t3 = tangents[idx2];
+        t3.mul(b);
+
+        t1.add(t2);
+        t1.add(t3);
+
+        *tangent_out = t1;
+    }
+}
+
 S32 LLVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a& end,
                                    S32 face,
                                    LLVector4a* intersection,LLVector2* tex_coord, LLVector4a* normal, LLVector4a* tangent_out)
@@ -4307,80 +4563,23 @@ S32 LLVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a& en
                         {
                             closest_t = t;
                             hit_face = i;
-
-                            if (intersection != NULL)
-                            {
-                                LLVector4a intersect = dir;
-                                intersect.mul(closest_t);
-                                intersect.add(start);
-                                *intersection = intersect;
-                            }
-
-
-                            if (tex_coord != NULL)
-                            {
-                                LLVector2* tc = (LLVector2*) face.mTexCoords;
-                                *tex_coord = ((1.f - a - b)  * tc[idx0] +
-                                    a              * tc[idx1] +
-                                    b              * tc[idx2]);
-
-                            }
-
-                            if (normal!= NULL)
-                            {
-                                LLVector4a* norm = face.mNormals;
-
-                                LLVector4a n1,n2,n3;
-                                n1 = norm[idx0];
-                                n1.mul(1.f-a-b);
-
-                                n2 = norm[idx1];
-                                n2.mul(a);
-
-                                n3 = norm[idx2];
-                                n3.mul(b);
-
-                                n1.add(n2);
-                                n1.add(n3);
-
-                                *normal     = n1;
-                            }
-
-                            if (tangent_out != NULL)
-                            {
-                                LLVector4a* tangents = face.mTangents;
-
-                                LLVector4a t1,t2,t3;
-                                t1 = tangents[idx0];
-                                t1.mul(1.f-a-b);
-
-                                t2 = tangents[idx1];
-                                t2.mul(a);
-
-                                t3 = tangents[idx2];
-                                t3.mul(b);
-
-                                t1.add(t2);
-                                t1.add(t3);
-
-                                *tangent_out = t1;
-                            }
+                            set_segment_hit(face, idx0, idx1, idx2, a, b, t, start, dir,
+                                            intersection, tex_coord, normal, tangent_out);
                         }
                     }
                 }
             }
             else
             {
-                if (!face.getOctree())
-                {
-                    face.createOctree();
-                }
+                const LLVolumeBVH* bvh = face.updateBVH();
 
-                LLOctreeTriangleRayIntersect intersect(start, dir, &face, &closest_t, intersection, tex_coord, normal, tangent_out);
-                intersect.traverse(face.getOctree());
-                if (intersect.mHitFace)
+                U32 first_index;
+                F32 a, b;
+                if (bvh->intersect(start, dir, closest_t, first_index, a, b))
                 {
                     hit_face = i;
+                    set_segment_hit(face, face.mIndices[first_index], face.mIndices[first_index + 1], face.mIndices[first_index + 2],
+                                    a, b, closest_t, start, dir, intersection, tex_coord, normal, tangent_out);
                 }
             }
         }
@@ -4926,6 +5125,7 @@ LLVolumeFace::LLVolumeFace() :
     mTexCoords(NULL),
     mIndices(NULL),
     mWeights(NULL),
+    mWeightsSerial(0),
 #if USE_SEPARATE_JOINT_INDICES_AND_WEIGHTS
     mJustWeights(NULL),
     mJointIndices(NULL),
@@ -4933,6 +5133,8 @@ LLVolumeFace::LLVolumeFace() :
     mWeightsScrubbed(false),
     mOctree(NULL),
     mOctreeTriangles(NULL),
+    mBVH(NULL),
+    mBVHDirty(false),
     mOptimized(false)
 {
     mExtents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*3);
@@ -4957,13 +5159,16 @@ LLVolumeFace::LLVolumeFace(const LLVolumeFace& src)
     mTexCoords(NULL),
     mIndices(NULL),
     mWeights(NULL),
+    mWeightsSerial(0),
 #if USE_SEPARATE_JOINT_INDICES_AND_WEIGHTS
     mJustWeights(NULL),
     mJointIndices(NULL),
 #endif
     mWeightsScrubbed(false),
     mOctree(NULL),
-    mOctreeTriangles(NULL)
+    mOctreeTriangles(NULL),
+    mBVH(NULL),
+    mBVHDirty(false)
 {
     try
     {
@@ -5043,6 +5248,7 @@ LLVolumeFace& LLVolumeFace::operator=(const LLVolumeFace& src)
         {
             ll_aligned_free_16(mWeights);
             mWeights = NULL;
+            mWeightsSerial = 0;
             mWeightsScrubbed = false;
         }
 
@@ -5105,6 +5311,7 @@ void LLVolumeFace::freeData()
     mTangents = NULL;
     ll_aligned_free_16(mWeights);
     mWeights = NULL;
+    mWeightsSerial = 0;
 
 #if USE_SEPARATE_JOINT_INDICES_AND_WEIGHTS
     ll_aligned_free_16(mJointIndices);
@@ -5114,6 +5321,7 @@ void LLVolumeFace::freeData()
 #endif
 
     destroyOctree();
+    destroyBVH();
 }
 
 bool LLVolumeFace::create(LLVolume* volume, bool partial_build)
@@ -5122,6 +5330,7 @@ bool LLVolumeFace::create(LLVolume* volume, bool partial_build)
 
     //tree for this face is no longer valid
     destroyOctree();
+    destroyBVH();
 
     LL_CHECK_MEMORY
     bool ret = false ;
@@ -5947,9 +6156,34 @@ const LLVolumeOctree* LLVolumeFace::getOctree() const
     return mOctree;
 }
 
+const LLVolumeBVH* LLVolumeFace::updateBVH()
+{
+    if (!mBVH)
+    {
+        mBVH = new LLVolumeBVH();
+        mBVH->build(*this);
+    }
+    else if (mBVHDirty && !mBVH->refit(*this))
+    {
+        // triangles changed, not just positions
+        mBVH->build(*this);
+    }
+    mBVHDirty = false;
+    return mBVH;
+}
+
+void LLVolumeFace::destroyBVH()
+{
+    delete mBVH;
+    mBVH = nullptr;
+    mBVHDirty = false;
+}
+
 
 void LLVolumeFace::swapData(LLVolumeFace& rhs)
 {
+    destroyBVH();
+    rhs.destroyBVH();
     llswap(rhs.mPositions, mPositions);
     llswap(rhs.mNormals, mNormals);
     llswap(rhs.mTangents, mTangents);
@@ -6697,9 +6931,12 @@ void LLVolumeFace::allocateTangents(S32 num_verts)
 
 void LLVolumeFace::allocateWeights(S32 num_verts)
 {
+    // faces are decoded on mesh threads
+    static std::atomic<U64> next_serial(1);
+
     ll_aligned_free_16(mWeights);
     mWeights = (LLVector4a*)ll_aligned_malloc_16(sizeof(LLVector4a)*num_verts);
-
+    mWeightsSerial = next_serial++;
 }
 
 void LLVolumeFace::allocateJointIndices(S32 num_verts)
@@ -42,6 +42,12 @@ class LLVolumeFace;
 class LLVolume;
 class LLVolumeTriangle;
 class LLVolumeOctree;
+class LLVolumeBVH;
+
+namespace LL
+{
+    class ThreadPoolBase;
+}
 
 #include "lluuid.h"
 #include "v4color.h"
@@ -917,6 +923,15 @@ public:
     // Get a reference to the octree, which may be null
     const LLVolumeOctree* getOctree() const;
 
+    // Ray cast acceleration structure. updateBVH() builds it on first use
+    // and refits it after dirtyBVH(); call dirtyBVH() whenever positions
+    // change but the triangles do not (e.g. re-skinning a rigged face).
+    const LLVolumeBVH* updateBVH();
+    void dirtyBVH() { mBVHDirty = true; }
+    void destroyBVH();
+    // Get a reference to the BVH, which may be null or out of date
+    const LLVolumeBVH* getBVH() const { return mBVH; }
+
     // Part of silhouette generation (used by selection outlines)
     // Populates the provided edge array with numbers corresponding to
     // *partial* logic of whether a particular index should be rendered
@@ -975,6 +990,10 @@ public:
     // format is mWeights[vertex_index].mV[influence] = <joint_index>.<weight>
     // mWeights.size() should be empty or match mVertices.size()
     LLVector4a* mWeights;
+    // Taken from a process wide counter each time mWeights is allocated, so
+    // data derived from the weights can tell a new allocation from the one it
+    // was built from even when both sit at the same address. 0 without weights.
+    U64 mWeightsSerial;
 
 #if USE_SEPARATE_JOINT_INDICES_AND_WEIGHTS
     LLVector4a* mJustWeights;
@@ -998,6 +1017,8 @@ public:
 private:
     LLVolumeOctree* mOctree;
     LLVolumeTriangle* mOctreeTriangles;
+    LLVolumeBVH* mBVH;
+    bool mBVHDirty;
 
     bool createUnCutCubeCap(LLVolume* volume, bool partial_build = false);
     bool createCap(LLVolume* volume, bool partial_build = false);
@@ -1102,7 +1123,8 @@ public:
 
     // use meshoptimizer to optimize index buffer for vertex shader cache
     //  gen_tangents - if true, generate MikkTSpace tangents if needed before optimizing index buffer
-    bool cacheOptimize(bool gen_tangents = false);
+    //  pool - if not null, optimize faces in parallel on this ThreadPool (joined before returning)
+    bool cacheOptimize(bool gen_tangents = false, LL::ThreadPoolBase* pool = nullptr);
 
 private:
     void sculptGenerateMapVertices(U16 sculpt_width, U16 sculpt_height, S8 sculpt_components, const U8* sculpt_data, U8 sculpt_type);
@@ -1114,10 +1136,22 @@ protected:
     bool generate();
     void createVolumeFaces();
 public:
-    bool unpackVolumeFaces(std::istream& is, S32 size);
-    bool unpackVolumeFaces(U8* in_data, S32 size);
+    // pool, if given, is passed through to cacheOptimize()
+    bool unpackVolumeFaces(std::istream& is, S32 size, LL::ThreadPoolBase* pool = nullptr);
+    bool unpackVolumeFaces(U8* in_data, S32 size, LL::ThreadPoolBase* pool = nullptr);
+
+    // Appends a flat binary image of faces that have already been through
+    // unpackVolumeFaces() to out, so a decoded mesh can be cached and restored
+    // without inflating, parsing and optimizing it again.  Bump
+    // DECODED_FACES_VERSION whenever the layout, or the processing that
+    // produces the faces, changes.
+    static const U32 DECODED_FACES_VERSION = 1;
+    bool packDecodedFaces(std::vector<U8>& out) const;
+    // Validates everything it reads; returns false (leaving no faces) on
+    // truncated or inconsistent data.
+    bool unpackDecodedFaces(const U8* data, size_t size);
 private:
-    bool unpackVolumeFacesInternal(const LLSD& mdl);
+    bool unpackVolumeFacesInternal(const LLSD& mdl, LL::ThreadPoolBase* pool);
 
 public:
     virtual void setMeshAssetLoaded(bool loaded);
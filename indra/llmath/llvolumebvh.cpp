@@ -0,0 +1,501 @@
+/**
+ * @file llvolumebvh.cpp
+ * @brief Flat bounding volume hierarchy for ray casts against an LLVolumeFace
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llvolumebvh.h"
+#include "llmath.h"
+#include "llvolume.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    const U32 LEAF_SIZE = 4;
+    const U32 NUM_BINS = 16;
+    // past this depth nodes split at the median, which bounds the depth
+    // of the tree and so the traversal stack
+    const U32 MAX_SAH_DEPTH = 40;
+    const U32 MAX_STACK = 96;
+    const U32 NO_TRIANGLE = 0xFFFFFFFF;
+
+    F32 half_area(const LLVector4a& min, const LLVector4a& max)
+    {
+        LLVector4a size;
+        size.setSub(max, min);
+        const F32* s = size.getF32ptr();
+        return s[VX] * s[VY] + s[VY] * s[VZ] + s[VZ] * s[VX];
+    }
+
+    struct BuildTask
+    {
+        U32 mNode;
+        U32 mBegin;
+        U32 mEnd;
+        U32 mDepth;
+    };
+
+    // Entry distance of the segment into a box, or a value > limit if it
+    // misses. inv_dir has no zero components.
+    inline F32 box_entry(const LLVector4a& min, const LLVector4a& max,
+                         const LLVector4a& start, const LLVector4a& inv_dir, F32 limit)
+    {
+        static const LLQuad xyz_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+
+        LLVector4a t0, t1;
+        t0.setSub(min, start);
+        t0.mul(inv_dir);
+        t1.setSub(max, start);
+        t1.mul(inv_dir);
+
+        // w of near is 0, the start of the segment; w of far is the limit
+        LLQuad near_t = _mm_and_ps(_mm_min_ps(t0, t1), xyz_mask);
+        LLQuad far_t = _mm_max_ps(t0, t1);
+        far_t = _mm_or_ps(_mm_and_ps(far_t, xyz_mask), _mm_andnot_ps(xyz_mask, _mm_set1_ps(limit)));
+
+        near_t = _mm_max_ps(near_t, _mm_shuffle_ps(near_t, near_t, _MM_SHUFFLE(1, 0, 3, 2)));
+        near_t = _mm_max_ps(near_t, _mm_shuffle_ps(near_t, near_t, _MM_SHUFFLE(2, 3, 0, 1)));
+        far_t = _mm_min_ps(far_t, _mm_shuffle_ps(far_t, far_t, _MM_SHUFFLE(1, 0, 3, 2)));
+        far_t = _mm_min_ps(far_t, _mm_shuffle_ps(far_t, far_t, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        F32 entry = _mm_cvtss_f32(near_t);
+        F32 exit = _mm_cvtss_f32(far_t);
+        return entry <= exit ? entry : limit + 1.f;
+    }
+}
+
+LLVolumeBVH::LLVolumeBVH()
+:   mNumTriangles(0)
+{
+}
+
+size_t LLVolumeBVH::getMemoryUsage() const
+{
+    return mNodes.capacity() * sizeof(Node) + mPackets.capacity() * sizeof(TrianglePacket);
+}
+
+void LLVolumeBVH::build(const LLVolumeFace& face)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+
+    mNodes.clear();
+    mPackets.clear();
+    mNumTriangles = face.mNumIndices / 3;
+    if (!mNumTriangles)
+    {
+        return;
+    }
+
+    // bounds and centroid of every triangle
+    std::vector<LLVector4a> tri_min(mNumTriangles);
+    std::vector<LLVector4a> tri_max(mNumTriangles);
+    std::vector<LLVector4a> centroid(mNumTriangles);
+    for (U32 i = 0; i < mNumTriangles; ++i)
+    {
+        const LLVector4a& v0 = face.mPositions[face.mIndices[i * 3 + 0]];
+        const LLVector4a& v1 = face.mPositions[face.mIndices[i * 3 + 1]];
+        const LLVector4a& v2 = face.mPositions[face.mIndices[i * 3 + 2]];
+        tri_min[i].setMin(v0, v1);
+        tri_min[i].setMin(tri_min[i], v2);
+        tri_max[i].setMax(v0, v1);
+        tri_max[i].setMax(tri_max[i], v2);
+        centroid[i].setAdd(tri_min[i], tri_max[i]);
+        centroid[i].mul(0.5f);
+    }
+
+    std::vector<U32> tris(mNumTriangles);
+    std::iota(tris.begin(), tris.end(), 0);
+
+    mNodes.reserve(mNumTriangles / 2 + 1);
+    mPackets.reserve(mNumTriangles / 2 + 1);
+    mNodes.push_back(Node());
+
+    std::vector<BuildTask> tasks;
+    tasks.push_back({ 0, 0, mNumTriangles, 0 });
+    while (!tasks.empty())
+    {
+        BuildTask task = tasks.back();
+        tasks.pop_back();
+        const U32 count = task.mEnd - task.mBegin;
+
+        if (count <= LEAF_SIZE)
+        {
+            Node& leaf = mNodes[task.mNode];
+            leaf.mIndex = (U32)mPackets.size();
+            leaf.mCount = 1;
+            TrianglePacket packet;
+            for (U32 lane = 0; lane < 4; ++lane)
+            {
+                packet.mFirstIndex[lane] = lane < count ? tris[task.mBegin + lane] * 3 : NO_TRIANGLE;
+            }
+            mPackets.push_back(packet);
+            continue;
+        }
+
+        U32 mid = task.mBegin + count / 2;
+
+        LLVector4a cmin = centroid[tris[task.mBegin]];
+        LLVector4a cmax = cmin;
+        for (U32 i = task.mBegin + 1; i < task.mEnd; ++i)
+        {
+            cmin.setMin(cmin, centroid[tris[i]]);
+            cmax.setMax(cmax, centroid[tris[i]]);
+        }
+
+        S32 best_axis = -1;
+        U32 best_split = 0;
+        F32 best_cost = F32_MAX;
+        if (task.mDepth < MAX_SAH_DEPTH)
+        {
+            for (S32 axis = 0; axis < 3; ++axis)
+            {
+                const F32 lo = cmin[axis];
+                const F32 extent = cmax[axis] - lo;
+                if (extent <= 0.f)
+                {
+                    continue;
+                }
+                const F32 scale = NUM_BINS / extent;
+
+                U32 bin_count[NUM_BINS] = { 0 };
+                LLVector4a bin_min[NUM_BINS];
+                LLVector4a bin_max[NUM_BINS];
+                for (U32 i = task.mBegin; i < task.mEnd; ++i)
+                {
+                    U32 tri = tris[i];
+                    U32 bin = llmin((U32)((centroid[tri][axis] - lo) * scale), NUM_BINS - 1);
+                    if (bin_count[bin]++)
+                    {
+                        bin_min[bin].setMin(bin_min[bin], tri_min[tri]);
+                        bin_max[bin].setMax(bin_max[bin], tri_max[tri]);
+                    }
+                    else
+                    {
+                        bin_min[bin] = tri_min[tri];
+                        bin_max[bin] = tri_max[tri];
+                    }
+                }
+
+                // cost of every split between bins: sweep the left side
+                // forward, then the right side back
+                F32 left_cost[NUM_BINS];
+                LLVector4a acc_min, acc_max;
+                U32 acc_count = 0;
+                for (U32 b = 0; b + 1 < NUM_BINS; ++b)
+                {
+                    if (bin_count[b])
+                    {
+                        acc_min = acc_count ? acc_min : bin_min[b];
+                        acc_max = acc_count ? acc_max : bin_max[b];
+                        acc_min.setMin(acc_min, bin_min[b]);
+                        acc_max.setMax(acc_max, bin_max[b]);
+                        acc_count += bin_count[b];
+                    }
+                    left_cost[b] = acc_count ? half_area(acc_min, acc_max) * acc_count : 0.f;
+                }
+                acc_count = 0;
+                for (U32 b = NUM_BINS - 1; b > 0; --b)
+                {
+                    if (bin_count[b])
+                    {
+                        acc_min = acc_count ? acc_min : bin_min[b];
+                        acc_max = acc_count ? acc_max : bin_max[b];
+                        acc_min.setMin(acc_min, bin_min[b]);
+                        acc_max.setMax(acc_max, bin_max[b]);
+                        acc_count += bin_count[b];
+                    }
+                    // split after bin b - 1
+                    F32 cost = left_cost[b - 1] + (acc_count ? half_area(acc_min, acc_max) * acc_count : 0.f);
+                    if (acc_count && acc_count < count && cost < best_cost)
+                    {
+                        best_cost = cost;
+                        best_axis = axis;
+                        best_split = b;
+                    }
+                }
+            }
+        }
+
+        if (best_axis >= 0)
+        {
+            const F32 lo = cmin[best_axis];
+            const F32 scale = NUM_BINS / (cmax[best_axis] - lo);
+            U32* split = std::partition(tris.data() + task.mBegin, tris.data() + task.mEnd,
+                [&](U32 tri)
+                {
+                    U32 bin = llmin((U32)((centroid[tri][best_axis] - lo) * scale), NUM_BINS - 1);
+                    return bin < best_split;
+                });
+            mid = (U32)(split - tris.data());
+        }
+        if (mid == task.mBegin || mid == task.mEnd)
+        {
+            mid = task.mBegin + count / 2;
+        }
+
+        U32 left = (U32)mNodes.size();
+        mNodes.push_back(Node());
+        mNodes.push_back(Node());
+        mNodes[task.mNode].mIndex = left;
+        mNodes[task.mNode].mCount = 0;
+        tasks.push_back({ left + 1, mid, task.mEnd, task.mDepth + 1 });
+        tasks.push_back({ left, task.mBegin, mid, task.mDepth + 1 });
+    }
+
+    refit(face);
+}
+
+bool LLVolumeBVH::refit(const LLVolumeFace& face)
+{
+    if (face.mNumIndices / 3 != mNumTriangles)
+    {
+        return false;
+    }
+
+    // children always come after their parent
+    for (S32 i = (S32)mNodes.size() - 1; i >= 0; --i)
+    {
+        Node& node = mNodes[i];
+        if (node.mCount)
+        {
+            refitPacket(face, node);
+        }
+        else
+        {
+            const Node& left = mNodes[node.mIndex];
+            const Node& right = mNodes[node.mIndex + 1];
+            node.mMin.setMin(left.mMin, right.mMin);
+            node.mMax.setMax(left.mMax, right.mMax);
+        }
+    }
+    return true;
+}
+
+void LLVolumeBVH::refitPacket(const LLVolumeFace& face, Node& node)
+{
+    TrianglePacket& packet = mPackets[node.mIndex];
+
+    LL_ALIGN_16(F32 v0[3][4]) = {};
+    LL_ALIGN_16(F32 edge1[3][4]) = {};
+    LL_ALIGN_16(F32 edge2[3][4]) = {};
+
+    for (U32 lane = 0; lane < 4; ++lane)
+    {
+        U32 first = packet.mFirstIndex[lane];
+        if (first == NO_TRIANGLE)
+        {
+            continue;
+        }
+        const LLVector4a& p0 = face.mPositions[face.mIndices[first + 0]];
+        const LLVector4a& p1 = face.mPositions[face.mIndices[first + 1]];
+        const LLVector4a& p2 = face.mPositions[face.mIndices[first + 2]];
+
+        // same arithmetic as LLTriangleRayIntersect()
+        LLVector4a e1, e2;
+        e1.setSub(p1, p0);
+        e2.setSub(p2, p0);
+        for (S32 c = 0; c < 3; ++c)
+        {
+            v0[c][lane] = p0[c];
+            edge1[c][lane] = e1[c];
+            edge2[c][lane] = e2[c];
+        }
+
+        if (lane == 0)
+        {
+            node.mMin.setMin(p0, p1);
+            node.mMax.setMax(p0, p1);
+        }
+        else
+        {
+            node.mMin.setMin(node.mMin, p0);
+            node.mMin.setMin(node.mMin, p1);
+            node.mMax.setMax(node.mMax, p0);
+            node.mMax.setMax(node.mMax, p1);
+        }
+        node.mMin.setMin(node.mMin, p2);
+        node.mMax.setMax(node.mMax, p2);
+    }
+
+    for (S32 c = 0; c < 3; ++c)
+    {
+        packet.mV0[c].load4a(v0[c]);
+        packet.mEdge1[c].load4a(edge1[c]);
+        packet.mEdge2[c].load4a(edge2[c]);
+    }
+}
+
+bool LLVolumeBVH::intersect(const LLVector4a& start, const LLVector4a& dir, F32& closest_t,
+                            U32& first_index, F32& a, F32& b) const
+{
+    if (mNodes.empty())
+    {
+        return false;
+    }
+
+    // a zero direction component would make 0 * inf in the slab test
+    LLVector4a inv_dir;
+    for (S32 c = 0; c < 3; ++c)
+    {
+        F32 d = dir[c];
+        if (fabsf(d) < 1.0e-20f)
+        {
+            d = d < 0.f ? -1.0e-20f : 1.0e-20f;
+        }
+        inv_dir.getF32ptr()[c] = 1.f / d;
+    }
+    inv_dir.getF32ptr()[VW] = 1.f;
+
+    const LLQuad dx = _mm_set1_ps(dir[VX]);
+    const LLQuad dy = _mm_set1_ps(dir[VY]);
+    const LLQuad dz = _mm_set1_ps(dir[VZ]);
+    const LLQuad ox = _mm_set1_ps(start[VX]);
+    const LLQuad oy = _mm_set1_ps(start[VY]);
+    const LLQuad oz = _mm_set1_ps(start[VZ]);
+    const LLQuad epsilon = _mm_set1_ps(LLVector4a::getEpsilon()[0]);
+    const LLQuad zero = _mm_setzero_ps();
+    const LLQuad one = _mm_set1_ps(1.f);
+
+    // hits must have t <= 1 and t < closest_t, as in LLVolume::lineSegmentIntersect()
+    F32 best_t = closest_t;
+    bool hit = false;
+
+    U32 stack[MAX_STACK];
+    F32 stack_entry[MAX_STACK];
+    U32 depth = 0;
+
+    const F32 root_limit = llmin(best_t, 1.f);
+    F32 root_entry = box_entry(mNodes[0].mMin, mNodes[0].mMax, start, inv_dir, root_limit);
+    if (root_entry <= root_limit)
+    {
+        stack[0] = 0;
+        stack_entry[0] = root_entry;
+        depth = 1;
+    }
+
+    while (depth)
+    {
+        --depth;
+        if (stack_entry[depth] > best_t)
+        {
+            // a closer hit was found since this node was pushed
+            continue;
+        }
+        const Node& node = mNodes[stack[depth]];
+
+        if (node.mCount)
+        {
+            const TrianglePacket& packet = mPackets[node.mIndex];
+            const LLQuad e1x = packet.mEdge1[VX], e1y = packet.mEdge1[VY], e1z = packet.mEdge1[VZ];
+            const LLQuad e2x = packet.mEdge2[VX], e2y = packet.mEdge2[VY], e2z = packet.mEdge2[VZ];
+
+            // pvec = dir x edge2, det = edge1 . pvec
+            LLQuad px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+            LLQuad py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+            LLQuad pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+            LLQuad det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+
+            // tvec = start - v0, u = tvec . pvec
+            LLQuad tx = _mm_sub_ps(ox, packet.mV0[VX]);
+            LLQuad ty = _mm_sub_ps(oy, packet.mV0[VY]);
+            LLQuad tz = _mm_sub_ps(oz, packet.mV0[VZ]);
+            LLQuad u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz));
+
+            // qvec = tvec x edge1, v = dir . qvec, t = edge2 . qvec / det
+            LLQuad qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+            LLQuad qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+            LLQuad qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+            LLQuad v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz));
+            LLQuad t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz));
+            t = _mm_div_ps(t, det);
+
+            LLQuad mask = _mm_cmpge_ps(det, epsilon);
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+            mask = _mm_and_ps(mask, _mm_cmple_ps(u, det));
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+            mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), det));
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(t, zero));
+            mask = _mm_and_ps(mask, _mm_cmple_ps(t, one));
+
+            S32 lanes = _mm_movemask_ps(mask);
+            if (lanes)
+            {
+                LL_ALIGN_16(F32 t_lanes[4]);
+                LL_ALIGN_16(F32 u_lanes[4]);
+                LL_ALIGN_16(F32 v_lanes[4]);
+                LL_ALIGN_16(F32 det_lanes[4]);
+                _mm_store_ps(t_lanes, t);
+                _mm_store_ps(u_lanes, u);
+                _mm_store_ps(v_lanes, v);
+                _mm_store_ps(det_lanes, det);
+                for (U32 lane = 0; lane < 4; ++lane)
+                {
+                    if ((lanes & (1 << lane)) && t_lanes[lane] < best_t)
+                    {
+                        best_t = t_lanes[lane];
+                        a = u_lanes[lane] / det_lanes[lane];
+                        b = v_lanes[lane] / det_lanes[lane];
+                        first_index = packet.mFirstIndex[lane];
+                        hit = true;
+                    }
+                }
+            }
+            continue;
+        }
+
+        const Node& left = mNodes[node.mIndex];
+        const Node& right = mNodes[node.mIndex + 1];
+        const F32 limit = llmin(best_t, 1.f);
+        F32 left_entry = box_entry(left.mMin, left.mMax, start, inv_dir, limit);
+        F32 right_entry = box_entry(right.mMin, right.mMax, start, inv_dir, limit);
+
+        // push the farther child first so the nearer one is visited first
+        U32 near_node = node.mIndex;
+        U32 far_node = node.mIndex + 1;
+        if (right_entry < left_entry)
+        {
+            std::swap(near_node, far_node);
+            std::swap(left_entry, right_entry);
+        }
+        if (right_entry <= limit && depth < MAX_STACK)
+        {
+            stack[depth] = far_node;
+            stack_entry[depth++] = right_entry;
+        }
+        if (left_entry <= limit && depth < MAX_STACK)
+        {
+            stack[depth] = near_node;
+            stack_entry[depth++] = left_entry;
+        }
+    }
+
+    if (hit)
+    {
+        closest_t = best_t;
+    }
+    return hit;
+}
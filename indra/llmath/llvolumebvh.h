@@ -0,0 +1,96 @@
+/**
+ * @file llvolumebvh.h
+ * @brief Flat bounding volume hierarchy for ray casts against an LLVolumeFace
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVOLUMEBVH_H
+#define LL_LLVOLUMEBVH_H
+
+#include "llvector4a.h"
+
+#include <vector>
+
+class LLVolumeFace;
+
+// A binary BVH over the triangles of one LLVolumeFace, kept in two flat
+// arrays: nodes in depth first order, and the triangles of each leaf as one
+// packet of four laid out across SSE lanes, so a leaf is tested against a
+// ray in a single pass.
+//
+// The tree is built once per triangle list with a binned surface area
+// heuristic. When only the positions move (a rigged mesh taking a new
+// pose) refit() recomputes the bounds and packets in place without
+// changing the tree.
+class LLVolumeBVH
+{
+public:
+    LLVolumeBVH();
+
+    void build(const LLVolumeFace& face);
+
+    // Returns false if the face no longer has the triangles the tree was
+    // built for, in which case it must be rebuilt.
+    bool refit(const LLVolumeFace& face);
+
+    // Closest triangle hit by the segment start + t * dir, with
+    // 0 <= t <= 1 and t < closest_t. On a hit sets closest_t, the index of
+    // the triangle's first vertex index in the face, and the barycentric
+    // coordinates a and b of the hit, as LLTriangleRayIntersect() does.
+    bool intersect(const LLVector4a& start, const LLVector4a& dir, F32& closest_t,
+                   U32& first_index, F32& a, F32& b) const;
+
+    U32 getNumTriangles() const { return mNumTriangles; }
+    U32 getNumNodes() const { return (U32)mNodes.size(); }
+    size_t getMemoryUsage() const;
+
+private:
+    // Internal nodes have mCount 0 and their children at mIndex and
+    // mIndex + 1; leaves hold the packet at mIndex.
+    struct alignas(16) Node
+    {
+        LLVector4a mMin;
+        LLVector4a mMax;
+        U32 mIndex;
+        U32 mCount;
+    };
+
+    // Up to four triangles, component by component: lane i of mV0[VX] is
+    // the x coordinate of the first vertex of triangle i. Unused lanes are
+    // zero, which no ray can hit.
+    struct alignas(16) TrianglePacket
+    {
+        LLVector4a mV0[3];
+        LLVector4a mEdge1[3];
+        LLVector4a mEdge2[3];
+        U32 mFirstIndex[4];
+    };
+
+    void refitPacket(const LLVolumeFace& face, Node& node);
+
+    std::vector<Node> mNodes;
+    std::vector<TrianglePacket> mPackets;
+    U32 mNumTriangles;
+};
+
+#endif // LL_LLVOLUMEBVH_H
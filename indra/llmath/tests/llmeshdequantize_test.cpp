@@ -0,0 +1,181 @@
+/**
+ * @file   llmeshdequantize_test.cpp
+ * @brief Tests for batched mesh LOD dequantization
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llmath.h"
+#include "../llmeshdequantize.h"
+#include "../llvolume.h"
+#include "llsdserialize.h"
+
+#include <vector>
+
+namespace
+{
+    // Deterministic pseudo-random U16 payload.
+    std::vector<U16> make_payload(size_t count, U32 seed)
+    {
+        std::vector<U16> out(count);
+        for (auto& v : out)
+        {
+            seed = seed * 1664525 + 1013904223;
+            v = (U16) (seed >> 16);
+        }
+        return out;
+    }
+
+    bool same_bits(const LLVector4a& a, const LLVector4a& b)
+    {
+        return memcmp(a.getF32ptr(), b.getF32ptr(), sizeof(F32) * 4) == 0;
+    }
+
+    LLSD::Binary to_binary(const std::vector<U16>& v)
+    {
+        const U8* p = (const U8*) v.data();
+        return LLSD::Binary(p, p + v.size() * sizeof(U16));
+    }
+
+    // One mesh LOD block, as the mesh repository receives it: a zipped
+    // array of faces with quantized Position/Normal/TexCoord0 arrays.
+    std::string make_lod_block(U32 faces, U32 verts_per_face, U32 seed)
+    {
+        LLSD mdl = LLSD::emptyArray();
+        for (U32 f = 0; f < faces; ++f)
+        {
+            LLSD face;
+            face["Position"] = to_binary(make_payload(verts_per_face * 3, seed + f));
+            face["Normal"] = to_binary(make_payload(verts_per_face * 3, seed + f + 100));
+            face["TexCoord0"] = to_binary(make_payload(verts_per_face * 2, seed + f + 200));
+            std::vector<U16> tris;
+            for (U32 t = 0; t + 2 < verts_per_face; ++t)
+            {
+                tris.push_back((U16) t);
+                tris.push_back((U16) (t + 1));
+                tris.push_back((U16) (t + 2));
+            }
+            face["TriangleList"] = to_binary(tris);
+            face["PositionDomain"]["Min"] = LLVector3(-0.5f, -0.5f, -0.5f).getValue();
+            face["PositionDomain"]["Max"] = LLVector3(0.5f, 0.5f, 0.5f).getValue();
+            face["TexCoord0Domain"]["Min"] = LLVector2(0.f, 0.f).getValue();
+            face["TexCoord0Domain"]["Max"] = LLVector2(1.f, 1.f).getValue();
+            mdl.append(face);
+        }
+        return zip_llsd(mdl);
+    }
+
+    LLPointer<LLVolume> make_volume()
+    {
+        LLVolumeParams params;
+        params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
+        params.setSculptID(LLUUID::null, LL_SCULPT_TYPE_MESH);
+        return new LLVolume(params, 0.f);
+    }
+}
+
+namespace tut
+{
+    struct meshdequantize_data
+    {
+    };
+    typedef test_group<meshdequantize_data> meshdequantize_group;
+    typedef meshdequantize_group::object meshdequantize_object;
+    tut::meshdequantize_group tut_meshdequantize_test("LLMeshDequantize");
+
+    template<> template<>
+    void meshdequantize_object::test<1>()
+    {
+        set_test_name("batched kernels match the scalar path bit for bit");
+        LLVector4a min(-3.5f, 0.25f, 7.f);
+        LLVector4a range(10.f, 0.5f, 123.456f);
+        LLVector4a min_tc(-1.f, 0.5f, -1.f, 0.5f);
+        LLVector4a range_tc(4.f, 2.f, 4.f, 2.f);
+
+        // cover every remainder of the four-at-a-time loops
+        for (U32 count = 0; count < 23; ++count)
+        {
+            std::vector<U16> xyz = make_payload(count * 3 + 1, count);
+            std::vector<U16> st = make_payload(count * 2 + 2, count + 50);
+            std::vector<LLVector4a> fast(count + 1), slow(count + 1);
+
+            LLMeshDequantize::positions(xyz.data(), count, min, range, fast.data());
+            LLMeshDequantize::positionsScalar(xyz.data(), count, min, range, slow.data());
+            for (U32 i = 0; i < count; ++i)
+            {
+                ensure(llformat("position %u of %u", i, count), same_bits(fast[i], slow[i]));
+            }
+
+            LLMeshDequantize::normals(xyz.data(), count, fast.data());
+            LLMeshDequantize::normalsScalar(xyz.data(), count, slow.data());
+            for (U32 i = 0; i < count; ++i)
+            {
+                ensure(llformat("normal %u of %u", i, count), same_bits(fast[i], slow[i]));
+            }
+
+            LLMeshDequantize::texCoords(st.data(), count, min_tc, range_tc, fast.data());
+            LLMeshDequantize::texCoordsScalar(st.data(), count, min_tc, range_tc, slow.data());
+            for (U32 i = 0; i < (count + 1) / 2; ++i)
+            {
+                ensure(llformat("texcoord pair %u of %u", i, count), same_bits(fast[i], slow[i]));
+            }
+        }
+    }
+
+    template<> template<>
+    void meshdequantize_object::test<2>()
+    {
+        set_test_name("unpackVolumeFaces dequantizes into the volume");
+        const U32 verts = 7;
+        std::string block = make_lod_block(1, verts, 11);
+        LLPointer<LLVolume> volume = make_volume();
+        ensure("unpack failed", volume->unpackVolumeFaces((U8*) block.data(), (S32) block.size()));
+        ensure_equals("face count", volume->getNumVolumeFaces(), 1);
+
+        const LLVolumeFace& face = volume->getVolumeFace(0);
+        ensure_equals("vertex count", face.mNumVertices, (S32) verts);
+        ensure_equals("index count", face.mNumIndices, (S32) ((verts - 2) * 3));
+
+        // unpackVolumeFaces() cache-optimizes the face afterwards, which may
+        // reorder vertices: match each one against the expected set.
+        std::vector<U16> pos = make_payload(verts * 3, 11);
+        std::vector<U16> st = make_payload(verts * 2, 211);
+        for (S32 i = 0; i < face.mNumVertices; ++i)
+        {
+            const F32* p = face.mPositions[i].getF32ptr();
+            const LLVector2& tc = face.mTexCoords[i];
+            bool found = false;
+            for (U32 j = 0; j < verts && !found; ++j)
+            {
+                found = fabsf(p[0] - (pos[j * 3] / 65535.f - 0.5f)) < 1.e-5f
+                     && fabsf(p[1] - (pos[j * 3 + 1] / 65535.f - 0.5f)) < 1.e-5f
+                     && fabsf(p[2] - (pos[j * 3 + 2] / 65535.f - 0.5f)) < 1.e-5f
+                     && fabsf(tc.mV[0] - st[j * 2] / 65535.f) < 1.e-5f
+                     && fabsf(tc.mV[1] - st[j * 2 + 1] / 65535.f) < 1.e-5f;
+            }
+            ensure(llformat("vertex %d doesn't match any input vertex", i), found);
+        }
+    }
+}
@@ -0,0 +1,207 @@
+/**
+ * @file   llvolume_test.cpp
+ * @brief Tests for parallel LLVolume cache optimization
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llmath.h"
+#include "../llvolume.h"
+#include "threadpool.h"
+
+#include <vector>
+
+namespace
+{
+    // A rippled grid of side x side vertices, as one unoptimized face.
+    LLVolumeFace make_grid_face(S32 side, F32 phase)
+    {
+        LLVolumeFace face;
+        face.resizeVertices(side * side);
+        face.resizeIndices((side - 1) * (side - 1) * 6);
+        for (S32 y = 0; y < side; ++y)
+        {
+            for (S32 x = 0; x < side; ++x)
+            {
+                S32 v = y * side + x;
+                F32 fx = (F32) x / side, fy = (F32) y / side;
+                face.mPositions[v].set(fx, fy, 0.05f * sinf(phase + 10.f * fx * fy));
+                face.mNormals[v].set(0.f, 0.f, 1.f);
+                face.mTexCoords[v].set(fx, fy);
+            }
+        }
+        U16* idx = face.mIndices;
+        for (S32 y = 0; y + 1 < side; ++y)
+        {
+            for (S32 x = 0; x + 1 < side; ++x)
+            {
+                U16 v = (U16) (y * side + x);
+                *idx++ = v;
+                *idx++ = v + 1;
+                *idx++ = (U16) (v + side);
+                *idx++ = v + 1;
+                *idx++ = (U16) (v + side + 1);
+                *idx++ = (U16) (v + side);
+            }
+        }
+        return face;
+    }
+
+    LLPointer<LLVolume> make_volume(const std::vector<LLVolumeFace>& faces)
+    {
+        LLVolumeParams params;
+        params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
+        params.setSculptID(LLUUID::null, LL_SCULPT_TYPE_MESH);
+        LLPointer<LLVolume> volume = new LLVolume(params, 0.f);
+        volume->copyFacesFrom(faces);
+        return volume;
+    }
+}
+
+namespace tut
+{
+    struct volume_data
+    {
+    };
+    typedef test_group<volume_data> volume_group;
+    typedef volume_group::object volume_object;
+    tut::volume_group tut_volume_test("LLVolume");
+
+    template<> template<>
+    void volume_object::test<1>()
+    {
+        set_test_name("parallel cacheOptimize matches serial");
+        std::vector<LLVolumeFace> faces;
+        for (S32 f = 0; f < 6; ++f)
+        {
+            faces.push_back(make_grid_face(40 + f * 5, (F32) f));
+        }
+
+        LL::ThreadPool pool("LLVolume test", 3);
+        pool.start();
+
+        LLPointer<LLVolume> serial = make_volume(faces);
+        LLPointer<LLVolume> parallel = make_volume(faces);
+        ensure("serial optimize failed", serial->cacheOptimize(true));
+        ensure("parallel optimize failed", parallel->cacheOptimize(true, &pool));
+
+        ensure_equals("face count", parallel->getNumVolumeFaces(), serial->getNumVolumeFaces());
+        for (S32 f = 0; f < serial->getNumVolumeFaces(); ++f)
+        {
+            const LLVolumeFace& a = serial->getVolumeFace(f);
+            const LLVolumeFace& b = parallel->getVolumeFace(f);
+            ensure_equals(llformat("face %d vertices", f), b.mNumVertices, a.mNumVertices);
+            ensure_equals(llformat("face %d indices", f), b.mNumIndices, a.mNumIndices);
+            ensure(llformat("face %d index buffer", f),
+                   memcmp(a.mIndices, b.mIndices, a.mNumIndices * sizeof(U16)) == 0);
+            ensure(llformat("face %d positions", f),
+                   memcmp(a.mPositions, b.mPositions, a.mNumVertices * sizeof(LLVector4a)) == 0);
+            ensure_equals(llformat("face %d tangents", f), b.mTangents != nullptr, a.mTangents != nullptr);
+        }
+    }
+
+    template<> template<>
+    void volume_object::test<2>()
+    {
+        set_test_name("forkJoin runs every item once");
+        LL::ThreadPool pool("LLVolume forkJoin", 4);
+        pool.start();
+        std::vector<std::atomic<S32>> hits(1000);
+        pool.forkJoin(hits.size(), [&hits](size_t i){ ++hits[i]; });
+        for (size_t i = 0; i < hits.size(); ++i)
+        {
+            ensure_equals(llformat("item %u", (U32) i), hits[i].load(), 1);
+        }
+
+        // nested use from one of the pool's own workers must not deadlock
+        std::atomic<S32> inner{ 0 };
+        pool.forkJoin(4, [&pool, &inner](size_t)
+                      {
+                          pool.forkJoin(8, [&inner](size_t){ ++inner; });
+                      });
+        ensure_equals("nested items", inner.load(), 32);
+    }
+
+
+    template<> template<>
+    void volume_object::test<4>()
+    {
+        set_test_name("decoded faces round trip");
+        std::vector<LLVolumeFace> faces;
+        faces.push_back(make_grid_face(20, 0.f));
+        faces.push_back(make_grid_face(7, 1.f));
+        LLPointer<LLVolume> source = make_volume(faces);
+        ensure("optimize failed", source->cacheOptimize(true));
+        source->getVolumeFace(1).allocateWeights(source->getVolumeFace(1).mNumVertices);
+        for (S32 v = 0; v < source->getVolumeFace(1).mNumVertices; ++v)
+        {
+            source->getVolumeFace(1).mWeights[v].set(1.5f, 2.25f, 0.f, 0.f);
+        }
+
+        std::vector<U8> image(4, 0xAB); // packing appends after whatever is there
+        ensure("pack failed", source->packDecodedFaces(image));
+
+        LLPointer<LLVolume> restored = make_volume(std::vector<LLVolumeFace>());
+        ensure("unpack failed", restored->unpackDecodedFaces(image.data() + 4, image.size() - 4));
+        ensure_equals("face count", restored->getNumVolumeFaces(), source->getNumVolumeFaces());
+        for (S32 f = 0; f < source->getNumVolumeFaces(); ++f)
+        {
+            const LLVolumeFace& a = source->getVolumeFace(f);
+            const LLVolumeFace& b = restored->getVolumeFace(f);
+            ensure_equals(llformat("face %d vertices", f), b.mNumVertices, a.mNumVertices);
+            ensure_equals(llformat("face %d indices", f), b.mNumIndices, a.mNumIndices);
+            ensure(llformat("face %d indices", f), memcmp(a.mIndices, b.mIndices, a.mNumIndices * sizeof(U16)) == 0);
+            ensure(llformat("face %d positions", f), memcmp(a.mPositions, b.mPositions, a.mNumVertices * sizeof(LLVector4a)) == 0);
+            ensure(llformat("face %d normals", f), memcmp(a.mNormals, b.mNormals, a.mNumVertices * sizeof(LLVector4a)) == 0);
+            ensure(llformat("face %d texcoords", f), memcmp(a.mTexCoords, b.mTexCoords, a.mNumVertices * sizeof(LLVector2)) == 0);
+            ensure(llformat("face %d extents", f), memcmp(a.mExtents, b.mExtents, 3 * sizeof(LLVector4a)) == 0);
+            ensure_equals(llformat("face %d tangents", f), b.mTangents != nullptr, a.mTangents != nullptr);
+            if (a.mTangents)
+            {
+                ensure(llformat("face %d tangent data", f), memcmp(a.mTangents, b.mTangents, a.mNumVertices * sizeof(LLVector4a)) == 0);
+            }
+            ensure_equals(llformat("face %d weights", f), b.mWeights != nullptr, a.mWeights != nullptr);
+            if (a.mWeights)
+            {
+                ensure(llformat("face %d weight data", f), memcmp(a.mWeights, b.mWeights, a.mNumVertices * sizeof(LLVector4a)) == 0);
+                ensure(llformat("face %d weights serial", f), b.mWeightsSerial != a.mWeightsSerial);
+            }
+            ensure(llformat("face %d optimized", f), b.mOptimized);
+        }
+
+        // damaged images are rejected rather than half loaded
+        const U8* body = image.data() + 4;
+        const size_t size = image.size() - 4;
+        ensure("truncated image accepted", !restored->unpackDecodedFaces(body, size - 16));
+        ensure_equals("faces left after failure", restored->getNumVolumeFaces(), 0);
+        std::vector<U8> bad_version(body, body + size);
+        bad_version[4] ^= 0xFF;
+        ensure("wrong version accepted", !restored->unpackDecodedFaces(bad_version.data(), bad_version.size()));
+        std::vector<U8> bad_index(body, body + size);
+        U16 out_of_range = 0xFFFF;
+        memcpy(&bad_index[bad_index.size() - 16], &out_of_range, sizeof(out_of_range));
+        ensure("out of range index accepted", !restored->unpackDecodedFaces(bad_index.data(), bad_index.size()));
+    }
+}
@@ -0,0 +1,220 @@
+/**
+ * @file llvolumebvh_test.cpp
+ * @brief Tests for LLVolumeBVH ray casts
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llmath.h"
+#include "../llvolume.h"
+#include "../llvolumebvh.h"
+#include "../llvolumeoctree.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+    const S32 GRID_SIDE = 250;
+
+    // Positions of a rippled side x side grid in the unit square
+    void set_grid_positions(LLVolumeFace& face, S32 side, F32 phase)
+    {
+        for (S32 y = 0; y < side; ++y)
+        {
+            for (S32 x = 0; x < side; ++x)
+            {
+                F32 fx = (F32) x / side, fy = (F32) y / side;
+                face.mPositions[y * side + x].set(fx - 0.5f, fy - 0.5f, 0.1f * sinf(phase + 20.f * fx * fy));
+            }
+        }
+    }
+
+    LLVolumeFace make_grid_face(S32 side, F32 phase)
+    {
+        LLVolumeFace face;
+        face.resizeVertices(side * side);
+        face.resizeIndices((side - 1) * (side - 1) * 6);
+        set_grid_positions(face, side, phase);
+        for (S32 v = 0; v < side * side; ++v)
+        {
+            face.mNormals[v].set(0.f, 0.f, 1.f);
+            face.mTexCoords[v].set((F32) (v % side) / side, (F32) (v / side) / side);
+        }
+        U16* idx = face.mIndices;
+        for (S32 y = 0; y + 1 < side; ++y)
+        {
+            for (S32 x = 0; x + 1 < side; ++x)
+            {
+                U16 v = (U16) (y * side + x);
+                *idx++ = v;
+                *idx++ = v + 1;
+                *idx++ = (U16) (v + side);
+                *idx++ = v + 1;
+                *idx++ = (U16) (v + side + 1);
+                *idx++ = (U16) (v + side);
+            }
+        }
+        return face;
+    }
+
+    struct Segment
+    {
+        LLVector4a mStart;
+        LLVector4a mDir;
+    };
+
+    // Segments from above and below the grid, some of them missing it
+    std::vector<Segment> make_segments(S32 count, U32 seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<F32> pos(-0.7f, 0.7f);
+        std::vector<Segment> segments(count);
+        for (S32 i = 0; i < count; ++i)
+        {
+            F32 side = (i & 1) ? 1.f : -1.f;
+            LLVector4a end;
+            segments[i].mStart.set(pos(rng), pos(rng), side);
+            end.set(pos(rng), pos(rng), -side);
+            segments[i].mDir.setSub(end, segments[i].mStart);
+        }
+        return segments;
+    }
+
+    bool octree_cast(LLVolumeFace& face, const Segment& segment, F32& t)
+    {
+        t = 2.f;
+        LLOctreeTriangleRayIntersect intersect(segment.mStart, segment.mDir, &face, &t, NULL, NULL, NULL, NULL);
+        intersect.traverse(face.getOctree());
+        return intersect.mHitFace;
+    }
+
+    // Compares every segment against the octree of the face; returns the
+    // number of hits
+    S32 compare_with_octree(LLVolumeFace& face, const LLVolumeBVH& bvh, const std::vector<Segment>& segments)
+    {
+        face.destroyOctree();
+        face.createOctree();
+        S32 hits = 0;
+        for (size_t i = 0; i < segments.size(); ++i)
+        {
+            F32 octree_t;
+            bool octree_hit = octree_cast(face, segments[i], octree_t);
+
+            F32 t = 2.f, a, b;
+            U32 first_index;
+            bool hit = bvh.intersect(segments[i].mStart, segments[i].mDir, t, first_index, a, b);
+            tut::ensure_equals(llformat("segment %u hit", (U32) i), hit, octree_hit);
+            if (hit)
+            {
+                tut::ensure_approximately_equals(llformat("segment %u t", (U32) i).c_str(), t, octree_t, 18);
+                tut::ensure(llformat("segment %u triangle", (U32) i), first_index % 3 == 0 && first_index < (U32) face.mNumIndices);
+                tut::ensure(llformat("segment %u barycentric", (U32) i), a >= 0.f && b >= 0.f && a + b <= 1.0001f);
+                ++hits;
+            }
+        }
+        return hits;
+    }
+}
+
+namespace tut
+{
+    struct volumebvh_data
+    {
+    };
+    typedef test_group<volumebvh_data> volumebvh_group;
+    typedef volumebvh_group::object volumebvh_object;
+    tut::volumebvh_group tut_volumebvh_test("LLVolumeBVH");
+
+    template<> template<>
+    void volumebvh_object::test<1>()
+    {
+        set_test_name("BVH ray casts match the octree");
+        LLVolumeFace face = make_grid_face(GRID_SIDE, 0.f);
+        LLVolumeBVH bvh;
+        bvh.build(face);
+        ensure_equals("triangles", bvh.getNumTriangles(), (U32) face.mNumIndices / 3);
+
+        std::vector<Segment> segments = make_segments(2000, 3);
+        S32 hits = compare_with_octree(face, bvh, segments);
+        ensure("some segments hit", hits > 0);
+        ensure("some segments miss", hits < (S32) segments.size());
+
+        // closest_t limits the search
+        F32 t = 2.f, a, b;
+        U32 first_index;
+        for (const Segment& segment : segments)
+        {
+            if (bvh.intersect(segment.mStart, segment.mDir, t, first_index, a, b))
+            {
+                F32 limit = t * 0.5f;
+                F32 closer = limit;
+                ensure("nothing closer than the closest hit", !bvh.intersect(segment.mStart, segment.mDir, closer, first_index, a, b));
+                ensure_equals("closest_t untouched on a miss", closer, limit);
+                break;
+            }
+        }
+    }
+
+    template<> template<>
+    void volumebvh_object::test<2>()
+    {
+        set_test_name("refit after moving positions matches a fresh build");
+        LLVolumeFace face = make_grid_face(GRID_SIDE, 0.f);
+        LLVolumeBVH refitted;
+        refitted.build(face);
+
+        std::vector<Segment> segments = make_segments(1000, 11);
+        for (S32 frame = 1; frame <= 3; ++frame)
+        {
+            set_grid_positions(face, GRID_SIDE, frame * 1.3f);
+            ensure("refit", refitted.refit(face));
+            compare_with_octree(face, refitted, segments);
+        }
+
+        // a new triangle count can't be refit
+        face.resizeIndices(face.mNumIndices - 6);
+        ensure("refit with fewer triangles", !refitted.refit(face));
+    }
+
+    template<> template<>
+    void volumebvh_object::test<3>()
+    {
+        set_test_name("LLVolumeFace keeps its BVH until dirtied");
+        LLVolumeFace face = make_grid_face(64, 0.f);
+        const LLVolumeBVH* bvh = face.updateBVH();
+        ensure("built", bvh != NULL);
+        ensure("same BVH", face.updateBVH() == bvh);
+
+        std::vector<Segment> segments = make_segments(200, 5);
+        set_grid_positions(face, 64, 2.f);
+        face.dirtyBVH();
+        ensure("refit in place", face.updateBVH() == bvh);
+        compare_with_octree(face, *bvh, segments);
+
+        face.destroyBVH();
+        ensure("destroyed", face.getBVH() == NULL);
+    }
+}
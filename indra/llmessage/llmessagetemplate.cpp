@@ -190,3 +190,115 @@ void LLMessageTemplate::banUdp()
     }
 }
 
+
+// LLMessageDecodePlan functions
+
+void LLMessageDecodePlan::clear()
+{
+    mBlocks.clear();
+    mVariables.clear();
+    mSlots.clear();
+    mSlotMask = 0;
+    mBuilt = false;
+}
+
+void LLMessageDecodePlan::build(const LLMessageTemplate& msg_template)
+{
+    clear();
+
+    for (LLMessageTemplate::message_block_map_t::const_iterator iter = msg_template.mMemberBlocks.begin();
+         iter != msg_template.mMemberBlocks.end(); ++iter)
+    {
+        const LLMessageBlock* blockp = *iter;
+        if (blockp->mType != MBT_SINGLE
+            && blockp->mType != MBT_MULTIPLE
+            && blockp->mType != MBT_VARIABLE)
+        {
+            LL_ERRS() << "Unknown block type for " << blockp->mName
+                << " in message " << msg_template.mName << LL_ENDL;
+        }
+
+        Block block;
+        block.mName = blockp->mName;
+        block.mType = blockp->mType;
+        block.mNumber = blockp->mNumber;
+        block.mFirstVariable = (U32)mVariables.size();
+
+        for (LLMessageBlock::message_variable_map_t::const_iterator var_iter = blockp->mMemberVariables.begin();
+             var_iter != blockp->mMemberVariables.end(); ++var_iter)
+        {
+            const LLMessageVariable* varp = *var_iter;
+            Variable var;
+            var.mName = varp->getName();
+            var.mType = varp->getType();
+            var.mSize = varp->getSize();
+            var.mBlock = (U32)mBlocks.size();
+            mVariables.push_back(var);
+        }
+
+        block.mNumVariables = (U32)mVariables.size() - block.mFirstVariable;
+        mBlocks.push_back(block);
+    }
+
+    // keep the table at most half full so probes stay short and always end
+    U32 num_slots = 8;
+    while (num_slots < 2 * (U32)(mBlocks.size() + mVariables.size()))
+    {
+        num_slots *= 2;
+    }
+    Slot empty = { NULL, NULL, -1 };
+    mSlots.assign(num_slots, empty);
+    mSlotMask = num_slots - 1;
+
+    for (U32 i = 0; i < (U32)mBlocks.size(); ++i)
+    {
+        insertSlot(mBlocks[i].mName, NULL, (S32)i);
+    }
+    for (U32 i = 0; i < (U32)mVariables.size(); ++i)
+    {
+        insertSlot(mBlocks[mVariables[i].mBlock].mName, mVariables[i].mName, (S32)i);
+    }
+
+    mBuilt = true;
+}
+
+U32 LLMessageDecodePlan::hashSlot(const char* block, const char* var) const
+{
+    // names are interned, so their addresses are the keys
+    U64 key = (U64)(uintptr_t)block * 0x9E3779B97F4A7C15ULL;
+    key ^= (U64)(uintptr_t)var * 0xC2B2AE3D27D4EB4FULL;
+    return (U32)(key >> 32) & mSlotMask;
+}
+
+void LLMessageDecodePlan::insertSlot(const char* block, const char* var, S32 index)
+{
+    U32 slot = hashSlot(block, var);
+    while (mSlots[slot].mBlock)
+    {
+        slot = (slot + 1) & mSlotMask;
+    }
+    mSlots[slot].mBlock = block;
+    mSlots[slot].mVariable = var;
+    mSlots[slot].mIndex = index;
+}
+
+S32 LLMessageDecodePlan::findSlot(const char* block, const char* var) const
+{
+    if (mSlots.empty() || !block)
+    {
+        return -1;
+    }
+
+    for (U32 slot = hashSlot(block, var); ; slot = (slot + 1) & mSlotMask)
+    {
+        const Slot& entry = mSlots[slot];
+        if (!entry.mBlock)
+        {
+            return -1;
+        }
+        if (entry.mBlock == block && entry.mVariable == var)
+        {
+            return entry.mIndex;
+        }
+    }
+}
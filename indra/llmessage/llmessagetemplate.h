@@ -264,6 +264,65 @@ enum EMsgDeprecation
 };
 
 
+class LLMessageTemplate;
+
+// Flat tables of a template's blocks and variables in the order they appear
+// on the wire, built once when the template is loaded, so that a received
+// message is decoded without walking the template's maps and any of its
+// fields is found from its (interned) block and variable names with a
+// single hashed probe.
+class LLMessageDecodePlan
+{
+public:
+    struct Block
+    {
+        char                *mName;
+        EMsgBlockType       mType;
+        S32                 mNumber;        // repeat count of an MBT_MULTIPLE block
+        U32                 mFirstVariable; // index into mVariables
+        U32                 mNumVariables;
+    };
+
+    struct Variable
+    {
+        char                *mName;
+        EMsgVariableType    mType;
+        S32                 mSize;          // bytes of the length prefix for MVT_VARIABLE
+        U32                 mBlock;         // index into mBlocks
+    };
+
+    LLMessageDecodePlan() : mSlotMask(0), mBuilt(false) {}
+
+    void build(const LLMessageTemplate& msg_template);
+    void clear();
+    bool isBuilt() const                            { return mBuilt; }
+
+    // -1 if the template has no such block, or no such variable in it
+    S32 findBlock(const char* block) const          { return findSlot(block, NULL); }
+    S32 findVariable(const char* block, const char* var) const { return findSlot(block, var); }
+
+    std::vector<Block>      mBlocks;
+    std::vector<Variable>   mVariables;
+
+private:
+    // open addressing on the name pointers; blocks are keyed with a NULL
+    // variable name
+    struct Slot
+    {
+        const char          *mBlock;
+        const char          *mVariable;
+        S32                 mIndex;
+    };
+
+    U32 hashSlot(const char* block, const char* var) const;
+    void insertSlot(const char* block, const char* var, S32 index);
+    S32 findSlot(const char* block, const char* var) const;
+
+    std::vector<Slot>       mSlots;
+    U32                     mSlotMask;
+    bool                    mBuilt;
+};
+
 class LLMessageTemplate
 {
 public:
@@ -317,6 +376,7 @@ public:
         {
             mTotalSize = -1;
         }
+        mDecodePlan.clear();
     }
 
     LLMessageBlock *getBlock(char *name)
@@ -391,6 +451,22 @@ public:
         return iter != mMemberBlocks.end()? *iter : NULL;
     }
 
+    // LLMessageSystem::addTemplate() builds the plan once the template is
+    // complete; templates put together by hand get theirs on first use.
+    void buildDecodePlan()
+    {
+        mDecodePlan.build(*this);
+    }
+
+    const LLMessageDecodePlan& getDecodePlan()
+    {
+        if (!mDecodePlan.isBuilt())
+        {
+            buildDecodePlan();
+        }
+        return mDecodePlan;
+    }
+
 public:
     typedef LLIndexedVector<LLMessageBlock*, char*, 8> message_block_map_t;
     message_block_map_t                     mMemberBlocks;
@@ -413,6 +489,8 @@ public:
     bool                                    mBanFromUntrusted;
 
 private:
+    LLMessageDecodePlan                     mDecodePlan;
+
     // message handler function (this is set by each application)
     void                                    (*mHandlerFunc)(LLMessageSystem *msgsystem, void **user_data);
     void                                    **mUserData;
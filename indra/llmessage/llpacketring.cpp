@@ -46,6 +46,118 @@
 constexpr S16 MAX_BUFFER_RING_SIZE = 1024;
 constexpr S16 DEFAULT_BUFFER_RING_SIZE = 256;
 
+// room for a SOCKS-wrapped datagram
+constexpr S32 RECEIVE_SLOT_SIZE = NET_BUFFER_SIZE + SOCKS_HEADER_SIZE;
+// how long the receive thread blocks before checking for shutdown
+constexpr S32 RECEIVE_WAIT_MS = 50;
+
+LLPacketReceiveThread::LLPacketReceiveThread(S32 socket)
+    : mSocket(socket),
+      mBuffers((size_t)NUM_SLOTS * RECEIVE_SLOT_SIZE),
+      mSlots(NUM_SLOTS)
+{
+    for (U32 i = 0; i < NUM_SLOTS; ++i)
+    {
+        LLReceivedDatagram& slot = mSlots[i];
+        slot.mData = &mBuffers[(size_t)i * RECEIVE_SLOT_SIZE];
+        slot.mCapacity = RECEIVE_SLOT_SIZE;
+        slot.mSize = 0;
+        slot.mSenderIP = INVALID_HOST_IP_ADDRESS;
+        slot.mSenderPort = 0;
+        slot.mReceivingIF = INVALID_HOST_IP_ADDRESS;
+    }
+    mThread = std::thread(&LLPacketReceiveThread::run, this);
+}
+
+LLPacketReceiveThread::~LLPacketReceiveThread()
+{
+    mStop = true;
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+void LLPacketReceiveThread::run()
+{
+    LL_PROFILER_SET_THREAD_NAME("UDP Receive");
+
+    U32 tail = mTail.load(std::memory_order_relaxed);
+    while (!mStop.load(std::memory_order_relaxed))
+    {
+        U32 free_slots = NUM_SLOTS - (tail - mCachedHead);
+        if (free_slots == 0)
+        {
+            mCachedHead = mHead.load(std::memory_order_acquire);
+            free_slots = NUM_SLOTS - (tail - mCachedHead);
+            if (free_slots == 0)
+            {
+                // Main thread is behind, let the socket buffer absorb the
+                // backlog until it catches up.
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+        }
+
+        if (!wait_for_packet(mSocket, RECEIVE_WAIT_MS))
+        {
+            continue;
+        }
+
+        // receive straight into the contiguous run of free slots
+        U32 index = tail & SLOT_MASK;
+        S32 count = (S32)llmin(free_slots, NUM_SLOTS - index);
+        S32 received = receive_packets(mSocket, &mSlots[index], count);
+        if (received > 0)
+        {
+            tail += received;
+            mTail.store(tail, std::memory_order_release);
+        }
+    }
+}
+
+const LLReceivedDatagram* LLPacketReceiveThread::front()
+{
+    if (mLocalHead == mCachedTail)
+    {
+        // current batch is used up, hand its slots back and pick up the next
+        releaseConsumed();
+        mCachedTail = mTail.load(std::memory_order_acquire);
+        if (mLocalHead == mCachedTail)
+        {
+            return nullptr;
+        }
+    }
+    return &mSlots[mLocalHead & SLOT_MASK];
+}
+
+void LLPacketReceiveThread::pop()
+{
+    llassert(mLocalHead != mCachedTail);
+    ++mLocalHead;
+}
+
+void LLPacketReceiveThread::releaseConsumed()
+{
+    mHead.store(mLocalHead, std::memory_order_release);
+}
+
+S32 LLPacketReceiveThread::getNumQueued() const
+{
+    return (S32)(mTail.load(std::memory_order_acquire) - mLocalHead);
+}
+
+S32 LLPacketReceiveThread::getNumQueuedBytes() const
+{
+    S32 bytes = 0;
+    U32 tail = mTail.load(std::memory_order_acquire);
+    for (U32 i = mLocalHead; i != tail; ++i)
+    {
+        bytes += mSlots[i & SLOT_MASK].mSize;
+    }
+    return bytes;
+}
+
 LLPacketRing::LLPacketRing ()
     : mPacketRing(DEFAULT_BUFFER_RING_SIZE, nullptr)
 {
@@ -58,6 +170,7 @@ LLPacketRing::LLPacketRing ()
 
 LLPacketRing::~LLPacketRing ()
 {
+    stopReceiveThread();
     for (auto packet : mPacketRing)
     {
         delete packet;
@@ -71,8 +184,13 @@ LLPacketRing::~LLPacketRing ()
 S32 LLPacketRing::receivePacket (S32 socket, char *datap)
 {
     bool drop = computeDrop();
-    return (mNumBufferedPackets > 0) ?
-        receiveOrDropBufferedPacket(datap, drop) :
+    if (mNumBufferedPackets > 0)
+    {
+        // left over from before the receive thread was started
+        return receiveOrDropBufferedPacket(datap, drop);
+    }
+    return mReceiveThread ?
+        receiveOrDropQueuedPacket(datap, drop) :
         receiveOrDropPacket(socket, datap, drop);
 }
 
@@ -225,6 +343,55 @@ S32 LLPacketRing::receiveOrDropBufferedPacket(char *datap, bool drop)
     return packet_size;
 }
 
+S32 LLPacketRing::receiveOrDropQueuedPacket(char *datap, bool drop)
+{
+    const LLReceivedDatagram* dgram = mReceiveThread->front();
+    if (!dgram)
+    {
+        mNumQueuedPackets = 0;
+        mNumQueuedBytes = 0;
+        return 0;
+    }
+
+    S32 packet_size = dgram->mSize;
+    mActualBytesIn += packet_size;
+    mNumQueuedPackets = llmax(mNumQueuedPackets - 1, 0);
+    mNumQueuedBytes = llmax(mNumQueuedBytes - packet_size, 0);
+
+    if (drop)
+    {
+        packet_size = 0;
+    }
+    else if (LLProxy::isSOCKSProxyEnabled())
+    {
+        if (packet_size > SOCKS_HEADER_SIZE)
+        {
+            // *FIX We are assuming ATYP is 0x01 (IPv4), not 0x03 (hostname) or 0x04 (IPv6)
+            packet_size = llmin(packet_size - SOCKS_HEADER_SIZE, NET_BUFFER_SIZE);
+            memcpy(datap, dgram->mData + SOCKS_HEADER_SIZE, packet_size);
+            const proxywrap_t * header = static_cast<const proxywrap_t*>(static_cast<const void*>(dgram->mData));
+            mLastSender.setAddress(header->addr);
+            mLastSender.setPort(ntohs(header->port));
+            mLastReceivingIF = LLHost(dgram->mReceivingIF, INVALID_PORT);
+        }
+        else
+        {
+            packet_size = 0;
+        }
+    }
+    else
+    {
+        // receive_packet() truncates to NET_BUFFER_SIZE, match it
+        packet_size = llmin(packet_size, NET_BUFFER_SIZE);
+        memcpy(datap, dgram->mData, packet_size);
+        mLastSender = LLHost(dgram->mSenderIP, dgram->mSenderPort);
+        mLastReceivingIF = LLHost(dgram->mReceivingIF, INVALID_PORT);
+    }
+
+    mReceiveThread->pop();
+    return packet_size;
+}
+
 S32 LLPacketRing::bufferInboundPacket(S32 socket)
 {
     if (mNumBufferedPackets == mPacketRing.size() && mNumBufferedPackets < MAX_BUFFER_RING_SIZE)
@@ -298,6 +465,16 @@ S32 LLPacketRing::bufferInboundPacket(S32 socket)
 
 S32 LLPacketRing::drainSocket(S32 socket)
 {
+    if (mReceiveThread)
+    {
+        // The receive thread keeps the socket drained, just catch up on what
+        // it has queued so far.
+        mReceiveThread->releaseConsumed();
+        mNumQueuedPackets = mReceiveThread->getNumQueued();
+        mNumQueuedBytes = mReceiveThread->getNumQueuedBytes();
+        return getNumBufferedPackets();
+    }
+
     // drain into buffer
     S32 packet_size = 1;
     S32 num_loops = 0;
@@ -317,6 +494,37 @@ S32 LLPacketRing::drainSocket(S32 socket)
     return (S32)(mNumBufferedPackets);
 }
 
+bool LLPacketRing::startReceiveThread(S32 socket)
+{
+    if (mReceiveThread)
+    {
+        return true;
+    }
+
+    try
+    {
+        mReceiveThread = std::make_unique<LLPacketReceiveThread>(socket);
+    }
+    catch (const std::system_error& e)
+    {
+        LL_WARNS("Messaging") << "Failed to start UDP receive thread: " << e.what() << LL_ENDL;
+        return false;
+    }
+    LL_INFOS("Messaging") << "Started UDP receive thread" << LL_ENDL;
+    return true;
+}
+
+void LLPacketRing::stopReceiveThread()
+{
+    if (mReceiveThread)
+    {
+        mReceiveThread.reset();
+        mNumQueuedPackets = 0;
+        mNumQueuedBytes = 0;
+        LL_INFOS("Messaging") << "Stopped UDP receive thread" << LL_ENDL;
+    }
+}
+
 bool LLPacketRing::expandRing()
 {
     // compute larger size
@@ -353,15 +561,16 @@ bool LLPacketRing::expandRing()
 F32 LLPacketRing::getBufferLoadRate() const
 {
     // goes up to MAX_BUFFER_RING_SIZE
-    return (F32)mNumBufferedPackets / (F32)DEFAULT_BUFFER_RING_SIZE;
+    return (F32)getNumBufferedPackets() / (F32)DEFAULT_BUFFER_RING_SIZE;
 }
 
 void LLPacketRing::dumpPacketRingStats()
 {
     mNumDroppedPacketsTotal += mNumDroppedPackets;
     LL_INFOS("Messaging") << "Packet ring stats: " << std::endl
-                          << "Buffered packets: " << mNumBufferedPackets << std::endl
-                          << "Buffered bytes: " << mNumBufferedBytes << std::endl
+                          << "Buffered packets: " << getNumBufferedPackets() << std::endl
+                          << "Buffered bytes: " << getNumBufferedBytes() << std::endl
+                          << "Receive thread: " << (mReceiveThread ? "on" : "off") << std::endl
                           << "Dropped packets current: " << mNumDroppedPackets << std::endl
                           << "Dropped packets total: " << mNumDroppedPacketsTotal << std::endl
                           << "Dropped packets percentage: " << mDropPercentage << "%" << std::endl
@@ -27,12 +27,52 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <thread>
 #include <vector>
 
 #include "llhost.h"
 #include "llpacketbuffer.h"
 #include "llthrottle.h"
 
+// Single-producer/single-consumer queue of preallocated datagram slots, filled
+// by a dedicated receive thread so the main thread never blocks in recv().
+// The producer publishes whole recvmmsg() batches with one release store and
+// the consumer hands its reclaimed slots back once per consumed batch.
+class LLPacketReceiveThread
+{
+public:
+    LLPacketReceiveThread(S32 socket);
+    ~LLPacketReceiveThread();
+
+    // consumer side, main thread only
+    const LLReceivedDatagram* front();
+    void pop();
+    void releaseConsumed();
+    S32 getNumQueued() const;
+    S32 getNumQueuedBytes() const;
+
+private:
+    void run();
+
+    static constexpr U32 NUM_SLOTS = 1024; // power of two
+    static constexpr U32 SLOT_MASK = NUM_SLOTS - 1;
+
+    S32 mSocket;
+    std::vector<char> mBuffers;
+    std::vector<LLReceivedDatagram> mSlots;
+
+    alignas(64) std::atomic<U32> mTail { 0 };   // written by the receive thread
+    U32 mCachedHead { 0 };                      // receive thread's view of mHead
+    alignas(64) std::atomic<U32> mHead { 0 };   // written by the main thread
+    U32 mLocalHead { 0 };                       // main thread's unpublished mHead
+    U32 mCachedTail { 0 };                      // main thread's view of mTail
+
+    alignas(64) std::atomic<bool> mStop { false };
+    std::thread mThread;
+};
+
 
 class LLPacketRing
 {
@@ -49,6 +89,12 @@ public:
     // drains packets from socket and returns final mNumBufferedPackets
     S32 drainSocket(S32 socket);
 
+    // Hands socket reads to a dedicated thread. receivePacket() and
+    // drainSocket() then consume what it has queued without any syscalls.
+    bool startReceiveThread(S32 socket);
+    void stopReceiveThread();
+    bool isReceiveThreadRunning() const { return mReceiveThread != nullptr; }
+
     void dropPackets(U32);
     void setDropPercentage (F32 percent_to_drop);
 
@@ -60,8 +106,8 @@ public:
     S32 getAndResetActualInBits()   { S32 bits = mActualBytesIn * 8; mActualBytesIn = 0; return bits;}
     S32 getAndResetActualOutBits()  { S32 bits = mActualBytesOut * 8; mActualBytesOut = 0; return bits;}
 
-    S32 getNumBufferedPackets() const { return (S32)(mNumBufferedPackets); }
-    S32 getNumBufferedBytes() const { return mNumBufferedBytes; }
+    S32 getNumBufferedPackets() const { return (S32)(mNumBufferedPackets) + mNumQueuedPackets; }
+    S32 getNumBufferedBytes() const { return mNumBufferedBytes + mNumQueuedBytes; }
     S32 getNumDroppedPackets() const { return mNumDroppedPacketsTotal + mNumDroppedPackets; }
 
     F32 getBufferLoadRate() const; // from 0 to 4 (0 - empty, 1 - default size is full)
@@ -73,6 +119,7 @@ protected:
     // returns packet_size of received packet, zero or less if no packet found
     S32 receiveOrDropPacket(S32 socket, char *datap, bool drop);
     S32 receiveOrDropBufferedPacket(char *datap, bool drop);
+    S32 receiveOrDropQueuedPacket(char *datap, bool drop);
 
     // returns packet_size of packet buffered
     S32 bufferInboundPacket(S32 socket);
@@ -93,6 +140,10 @@ protected:
     F32 mDropPercentage { 0.0f };   // % of inbound packets to drop
     U32 mPacketsToDrop { 0 };       // drop next inbound n packets
 
+    std::unique_ptr<LLPacketReceiveThread> mReceiveThread;
+    S32 mNumQueuedPackets { 0 };    // as of the last receivePacket()/drainSocket()
+    S32 mNumQueuedBytes { 0 };
+
     // These are the sender and receiving_interface for the last packet delivered by receivePacket()
     LLHost mLastSender;
     LLHost mLastReceivingIF;
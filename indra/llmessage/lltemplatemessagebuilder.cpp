@@ -31,6 +31,7 @@
 #include "llmessagetemplate.h"
 #include "llmath.h"
 #include "llquaternion.h"
+#include "llzerocode.h"
 #include "u64.h"
 #include "v3dmath.h"
 #include "v3math.h"
@@ -494,81 +495,34 @@ void LLTemplateMessageBuilder::addUUID(const char *varname, const LLUUID& uuid)
 
 static S32 zero_code(U8 **data, U32 *data_size)
 {
-    // Encoded send buffer needs to be slightly larger since the zero
-    // coding can potentially increase the size of the send data.
-    static U8 encodedSendBuffer[2 * MAX_BUFFER_SIZE];
+    // Only an encoding smaller than the send data is ever kept.
+    static U8 encodedSendBuffer[MAX_BUFFER_SIZE];
 
-    S32 count = *data_size;
+    // skip the packet id field
+    memcpy(encodedSendBuffer, *data, LL_PACKET_ID_SIZE);
 
-    S32 net_gain = 0;
-    U8 num_zeroes = 0;
-
-    U8 *inptr = (U8 *)*data;
-    U8 *outptr = (U8 *)encodedSendBuffer;
-
-// skip the packet id field
-
-    for (U32 ii = 0; ii < LL_PACKET_ID_SIZE ; ++ii)
-    {
-        count--;
-        *outptr++ = *inptr++;
-    }
-
-// build encoded packet, keeping track of net size gain
-
-// sequential zero bytes are encoded as 0 [U8 count]
-// with 0 0 [count] representing wrap (>256 zeroes)
-
-    while (count--)
+    // only worth sending encoded if it comes out smaller, so give up as
+    // soon as it can't
+    S32 body_size = (S32)*data_size - LL_PACKET_ID_SIZE;
+    S32 encoded_size = LLZeroCode::encode(*data + LL_PACKET_ID_SIZE, body_size,
+                                          encodedSendBuffer + LL_PACKET_ID_SIZE, body_size - 1);
+    if (encoded_size < 0 || encoded_size >= body_size)
     {
-        if (!(*inptr))   // in a zero count
-        {
-            if (num_zeroes)
-            {
-                if (++num_zeroes > 254)
-                {
-                    *outptr++ = num_zeroes;
-                    num_zeroes = 0;
-                }
-                net_gain--;   // subseqent zeroes save one
-            }
-            else
-            {
-                *outptr++ = 0;
-                net_gain++;  // starting a zero count adds one
-                num_zeroes = 1;
-            }
-            inptr++;
-        }
-        else
-        {
-            if (num_zeroes)
-            {
-                *outptr++ = num_zeroes;
-                num_zeroes = 0;
-            }
-            *outptr++ = *inptr++;
-        }
+        return 0;
     }
 
-    if (num_zeroes)
-    {
-        *outptr++ = num_zeroes;
-    }
+    S32 net_gain = encoded_size - body_size;
 
-    if (net_gain < 0)
-    {
-        // TODO: babbage: reinstate stat collecting...
-        //mCompressedPacketsOut++;
-        //mUncompressedBytesOut += *data_size;
+    // TODO: babbage: reinstate stat collecting...
+    //mCompressedPacketsOut++;
+    //mUncompressedBytesOut += *data_size;
 
-        *data = encodedSendBuffer;
-        *data_size += net_gain;
-        encodedSendBuffer[0] |= LL_ZERO_CODE_FLAG;          // set the head bit to indicate zero coding
+    *data = encodedSendBuffer;
+    *data_size += net_gain;
+    encodedSendBuffer[0] |= LL_ZERO_CODE_FLAG;          // set the head bit to indicate zero coding
 
-        //mCompressedBytesOut += *data_size;
+    //mCompressedBytesOut += *data_size;
 
-    }
     //mTotalBytesOut += *data_size;
 
     return(net_gain);
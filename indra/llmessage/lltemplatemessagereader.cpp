@@ -42,7 +42,7 @@ LLTemplateMessageReader::LLTemplateMessageReader(message_template_number_map_t&
                                                  number_template_map) :
     mReceiveSize(0),
     mCurrentRMessageTemplate(NULL),
-    mCurrentRMessageData(NULL),
+    mCurrentRMessagePlan(NULL),
     mMessageNumbers(number_template_map)
 {
 }
@@ -50,8 +50,6 @@ LLTemplateMessageReader::LLTemplateMessageReader(message_template_number_map_t&
 //virtual
 LLTemplateMessageReader::~LLTemplateMessageReader()
 {
-    delete mCurrentRMessageData;
-    mCurrentRMessageData = NULL;
 }
 
 //virtual
@@ -59,8 +57,31 @@ void LLTemplateMessageReader::clearMessage()
 {
     mReceiveSize = -1;
     mCurrentRMessageTemplate = NULL;
-    delete mCurrentRMessageData;
-    mCurrentRMessageData = NULL;
+    mCurrentRMessagePlan = NULL;
+}
+
+S32 LLTemplateMessageReader::findField(const char* blockname, S32 blocknum, const char* varname) const
+{
+    const LLMessageDecodePlan& plan = *mCurrentRMessagePlan;
+    S32 var_index = plan.findVariable(blockname, varname);
+    if (var_index < 0)
+    {
+        S32 block_index = plan.findBlock(blockname);
+        if (block_index < 0 || blocknum < 0 || blocknum >= mBlockCounts[block_index])
+        {
+            return LL_BLOCK_NOT_IN_MESSAGE;
+        }
+        return LL_VARIABLE_NOT_IN_BLOCK;
+    }
+
+    const LLMessageDecodePlan::Variable& var = plan.mVariables[var_index];
+    const LLMessageDecodePlan::Block& block = plan.mBlocks[var.mBlock];
+    if (blocknum < 0 || blocknum >= mBlockCounts[var.mBlock])
+    {
+        return LL_BLOCK_NOT_IN_MESSAGE;
+    }
+    return (S32)(mBlockFields[var.mBlock] + blocknum * block.mNumVariables
+                 + (var_index - block.mFirstVariable));
 }
 
 void LLTemplateMessageReader::getData(const char *blockname, const char *varname, void *datap, S32 size, S32 blocknum, S32 max_size)
@@ -72,79 +93,55 @@ void LLTemplateMessageReader::getData(const char *blockname, const char *varname
         return;
     }
 
-    if (!mCurrentRMessageData)
+    if (!mCurrentRMessagePlan)
     {
-        LL_ERRS() << "Invalid mCurrentMessageData in getData!" << LL_ENDL;
+        LL_ERRS() << "Invalid mCurrentRMessagePlan in getData!" << LL_ENDL;
         return;
     }
 
-    char *bnamep = (char *)blockname + blocknum; // this works because it's just a hash.  The bnamep is never derefference
-    char *vnamep = (char *)varname;
-
-    LLMsgData::msg_blk_data_map_t::const_iterator iter = mCurrentRMessageData->mMemberBlocks.find(bnamep);
-
-    if (iter == mCurrentRMessageData->mMemberBlocks.end())
+    S32 field_index = findField(blockname, blocknum, varname);
+    if (field_index == LL_BLOCK_NOT_IN_MESSAGE)
     {
         LL_ERRS() << "Block " << blockname << " #" << blocknum
-            << " not in message " << mCurrentRMessageData->mName << LL_ENDL;
+            << " not in message " << mCurrentRMessageTemplate->mName << LL_ENDL;
         return;
     }
-
-    LLMsgBlkData *msg_block_data = iter->second;
-    LLMsgBlkData::msg_var_data_map_t &var_data_map = msg_block_data->mMemberVarData;
-
-    if (var_data_map.find(vnamep) == var_data_map.end())
+    if (field_index == LL_VARIABLE_NOT_IN_BLOCK)
     {
-        LL_ERRS() << "Variable "<< vnamep << " not in message "
-            << mCurrentRMessageData->mName<< " block " << bnamep << LL_ENDL;
+        LL_ERRS() << "Variable "<< varname << " not in message "
+            << mCurrentRMessageTemplate->mName << " block " << blockname << LL_ENDL;
         return;
     }
 
-    LLMsgVarData& vardata = msg_block_data->mMemberVarData[vnamep];
+    const DecodedField& field = mFields[field_index];
+    const U8* vardata = mDecodeBuffer.data() + field.mOffset;
 
-    if (size && size != vardata.getSize())
+    if (size && size != field.mSize)
     {
-        LL_ERRS() << "Msg " << mCurrentRMessageData->mName
-            << " variable " << vnamep
-            << " is size " << vardata.getSize()
+        LL_ERRS() << "Msg " << mCurrentRMessageTemplate->mName
+            << " variable " << varname
+            << " is size " << field.mSize
             << " but copying into buffer of size " << size
             << LL_ENDL;
         return;
     }
 
 
-    const S32 vardata_size = vardata.getSize();
+    const S32 vardata_size = field.mSize;
     if( max_size >= vardata_size )
     {
-        switch( vardata_size )
-        {
-        case 1:
-            *((U8*)datap) = *((U8*)vardata.getData());
-            break;
-        case 2:
-            *((U16*)datap) = *((U16*)vardata.getData());
-            break;
-        case 4:
-            *((U32*)datap) = *((U32*)vardata.getData());
-            break;
-        case 8:
-            ((U32*)datap)[0] = ((U32*)vardata.getData())[0];
-            ((U32*)datap)[1] = ((U32*)vardata.getData())[1];
-            break;
-        default:
-            memcpy(datap, vardata.getData(), vardata_size);
-            break;
-        }
+        // packet data has no alignment, so no sized stores here
+        memcpy(datap, vardata, vardata_size);
     }
     else
     {
-        LL_WARNS() << "Msg " << mCurrentRMessageData->mName
-            << " variable " << vnamep
-            << " is size " << vardata.getSize()
+        LL_WARNS() << "Msg " << mCurrentRMessageTemplate->mName
+            << " variable " << varname
+            << " is size " << field.mSize
             << " but truncated to max size of " << max_size
             << LL_ENDL;
 
-        memcpy(datap, vardata.getData(), max_size);
+        memcpy(datap, vardata, max_size);
     }
 }
 
@@ -157,22 +154,19 @@ S32 LLTemplateMessageReader::getNumberOfBlocks(const char *blockname)
         return -1;
     }
 
-    if (!mCurrentRMessageData)
+    if (!mCurrentRMessagePlan)
     {
-        LL_ERRS() << "Invalid mCurrentRMessageData in getData!" << LL_ENDL;
+        LL_ERRS() << "Invalid mCurrentRMessagePlan in getData!" << LL_ENDL;
         return -1;
     }
 
-    char *bnamep = (char *)blockname;
-
-    LLMsgData::msg_blk_data_map_t::const_iterator iter = mCurrentRMessageData->mMemberBlocks.find(bnamep);
-
-    if (iter == mCurrentRMessageData->mMemberBlocks.end())
+    S32 block_index = mCurrentRMessagePlan->findBlock(blockname);
+    if (block_index < 0)
     {
         return 0;
     }
 
-    return (iter->second)->mBlockNumber;
+    return mBlockCounts[block_index];
 }
 
 S32 LLTemplateMessageReader::getSize(const char *blockname, const char *varname)
@@ -184,43 +178,35 @@ S32 LLTemplateMessageReader::getSize(const char *blockname, const char *varname)
         return LL_MESSAGE_ERROR;
     }
 
-    if (!mCurrentRMessageData)
+    if (!mCurrentRMessagePlan)
     {   // This is a serious error - crash
-        LL_ERRS() << "Invalid mCurrentRMessageData in getData!" << LL_ENDL;
+        LL_ERRS() << "Invalid mCurrentRMessagePlan in getData!" << LL_ENDL;
         return LL_MESSAGE_ERROR;
     }
 
-    char *bnamep = (char *)blockname;
-
-    LLMsgData::msg_blk_data_map_t::const_iterator iter = mCurrentRMessageData->mMemberBlocks.find(bnamep);
-
-    if (iter == mCurrentRMessageData->mMemberBlocks.end())
+    S32 field_index = findField(blockname, 0, varname);
+    if (field_index == LL_BLOCK_NOT_IN_MESSAGE)
     {   // don't crash
-        LL_INFOS() << "Block " << bnamep << " not in message "
-            << mCurrentRMessageData->mName << LL_ENDL;
+        LL_INFOS() << "Block " << blockname << " not in message "
+            << mCurrentRMessageTemplate->mName << LL_ENDL;
         return LL_BLOCK_NOT_IN_MESSAGE;
     }
-
-    char *vnamep = (char *)varname;
-
-    LLMsgBlkData* msg_data = iter->second;
-    LLMsgVarData& vardata = msg_data->mMemberVarData[vnamep];
-
-    if (!vardata.getName())
+    if (field_index == LL_VARIABLE_NOT_IN_BLOCK)
     {   // don't crash
         LL_INFOS() << "Variable " << varname << " not in message "
-            << mCurrentRMessageData->mName << " block " << bnamep << LL_ENDL;
+            << mCurrentRMessageTemplate->mName << " block " << blockname << LL_ENDL;
         return LL_VARIABLE_NOT_IN_BLOCK;
     }
 
-    if (mCurrentRMessageTemplate->mMemberBlocks[bnamep]->mType != MBT_SINGLE)
+    S32 block_index = mCurrentRMessagePlan->findBlock(blockname);
+    if (mCurrentRMessagePlan->mBlocks[block_index].mType != MBT_SINGLE)
     {   // This is a serious error - crash
-        LL_ERRS() << "Block " << bnamep << " isn't type MBT_SINGLE,"
+        LL_ERRS() << "Block " << blockname << " isn't type MBT_SINGLE,"
             " use getSize with blocknum argument!" << LL_ENDL;
         return LL_MESSAGE_ERROR;
     }
 
-    return vardata.getSize();
+    return mFields[field_index].mSize;
 }
 
 S32 LLTemplateMessageReader::getSize(const char *blockname, S32 blocknum, const char *varname)
@@ -232,35 +218,27 @@ S32 LLTemplateMessageReader::getSize(const char *blockname, S32 blocknum, const
         return LL_MESSAGE_ERROR;
     }
 
-    if (!mCurrentRMessageData)
+    if (!mCurrentRMessagePlan)
     {   // This is a serious error - crash
-        LL_ERRS() << "Invalid mCurrentRMessageData in getData!" << LL_ENDL;
+        LL_ERRS() << "Invalid mCurrentRMessagePlan in getData!" << LL_ENDL;
         return LL_MESSAGE_ERROR;
     }
 
-    char *bnamep = (char *)blockname + blocknum;
-    char *vnamep = (char *)varname;
-
-    LLMsgData::msg_blk_data_map_t::const_iterator iter = mCurrentRMessageData->mMemberBlocks.find(bnamep);
-
-    if (iter == mCurrentRMessageData->mMemberBlocks.end())
+    S32 field_index = findField(blockname, blocknum, varname);
+    if (field_index == LL_BLOCK_NOT_IN_MESSAGE)
     {   // don't crash
-        LL_INFOS() << "Block " << bnamep << " not in message "
-            << mCurrentRMessageData->mName << LL_ENDL;
+        LL_INFOS() << "Block " << blockname << " #" << blocknum << " not in message "
+            << mCurrentRMessageTemplate->mName << LL_ENDL;
         return LL_BLOCK_NOT_IN_MESSAGE;
     }
-
-    LLMsgBlkData* msg_data = iter->second;
-    LLMsgVarData& vardata = msg_data->mMemberVarData[vnamep];
-
-    if (!vardata.getName())
+    if (field_index == LL_VARIABLE_NOT_IN_BLOCK)
     {   // don't crash
-        LL_INFOS() << "Variable " << vnamep << " not in message "
-            <<  mCurrentRMessageData->mName << " block " << bnamep << LL_ENDL;
+        LL_INFOS() << "Variable " << varname << " not in message "
+            <<  mCurrentRMessageTemplate->mName << " block " << blockname << LL_ENDL;
         return LL_VARIABLE_NOT_IN_BLOCK;
     }
 
-    return vardata.getSize();
+    return mFields[field_index].mSize;
 }
 
 void LLTemplateMessageReader::getBinaryData(const char *blockname,
@@ -519,17 +497,29 @@ void LLTemplateMessageReader::logRanOffEndOfPacket( const LLHost& host, const S3
             << " bytes at position " << where
             << " going past packet end at " << mReceiveSize
             << LL_ENDL;
-    if(gMessageSystem->mVerboseLog)
+    LLMessageSystem* msg_system = gMessageSystem;
+    if (!msg_system)
+    {
+        return;
+    }
+    if(msg_system->mVerboseLog)
     {
         LL_INFOS() << "MSG: -> " << host << "\tREAD PAST END:\t"
 //              << mCurrentRecvPacketID << " "
                 << getMessageName() << LL_ENDL;
     }
-    gMessageSystem->callExceptionFunc(MX_RAN_OFF_END_OF_PACKET);
+    msg_system->callExceptionFunc(MX_RAN_OFF_END_OF_PACKET);
 }
 
 static LLTrace::BlockTimerStatHandle FTM_PROCESS_MESSAGES("Process Messages");
 
+U32 LLTemplateMessageReader::appendZeroes(S32 size)
+{
+    U32 offset = (U32)mDecodeBuffer.size();
+    mDecodeBuffer.resize(offset + size, 0);
+    return offset;
+}
+
 // decode a given message
 bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender )
 {
@@ -537,40 +527,42 @@ bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 
     llassert( mReceiveSize >= 0 );
     llassert( mCurrentRMessageTemplate);
-    llassert( !mCurrentRMessageData );
-    delete mCurrentRMessageData; // just to make sure
+
+    const LLMessageDecodePlan& plan = mCurrentRMessageTemplate->getDecodePlan();
 
     // The offset tells us how may bytes to skip after the end of the
     // message name.
     U8 offset = buffer[PHL_OFFSET];
     S32 decode_pos = LL_PACKET_ID_SIZE + (S32)(mCurrentRMessageTemplate->mFrequency) + offset;
 
-    // create base working data set
-    mCurrentRMessageData = new LLMsgData(mCurrentRMessageTemplate->mName);
+    // fields point into a copy of the packet, so they stay valid however
+    // the caller reuses its receive buffer
+    mDecodeBuffer.assign(buffer, buffer + mReceiveSize);
+    mFields.clear();
+    const U32 num_blocks = (U32)plan.mBlocks.size();
+    mBlockCounts.resize(num_blocks);
+    mBlockFields.resize(num_blocks);
 
-    // loop through the template building the data structure as we go
-    LLMessageTemplate::message_block_map_t::const_iterator iter;
-    for(iter = mCurrentRMessageTemplate->mMemberBlocks.begin();
-        iter != mCurrentRMessageTemplate->mMemberBlocks.end();
-        ++iter)
+    // walk the plan recording where each variable's data is
+    bool have_blocks = false;
+    for (U32 block_index = 0; block_index < num_blocks; ++block_index)
     {
-        LLMessageBlock* mbci = *iter;
+        const LLMessageDecodePlan::Block& block = plan.mBlocks[block_index];
         U8  repeat_number;
-        S32 i;
 
         // how many of this block?
 
-        if (mbci->mType == MBT_SINGLE)
+        if (block.mType == MBT_SINGLE)
         {
             // just one
             repeat_number = 1;
         }
-        else if (mbci->mType == MBT_MULTIPLE)
+        else if (block.mType == MBT_MULTIPLE)
         {
             // a known number
-            repeat_number = mbci->mNumber;
+            repeat_number = block.mNumber;
         }
-        else if (mbci->mType == MBT_VARIABLE)
+        else if (block.mType == MBT_VARIABLE)
         {
             // need to read the number from the message
             // repeat number is a single byte
@@ -595,42 +587,25 @@ bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
             return false;
         }
 
-        LLMsgBlkData* cur_data_block = NULL;
+        mBlockCounts[block_index] = repeat_number;
+        mBlockFields[block_index] = (U32)mFields.size();
+        have_blocks |= repeat_number > 0;
 
         // now loop through the block
-        for (i = 0; i < repeat_number; i++)
+        for (S32 i = 0; i < repeat_number; i++)
         {
-            if (i)
-            {
-                // build new name to prevent collisions
-                // TODO: This should really change to a vector
-                cur_data_block = new LLMsgBlkData(mbci->mName, repeat_number);
-                cur_data_block->mName = mbci->mName + i;
-            }
-            else
-            {
-                cur_data_block = new LLMsgBlkData(mbci->mName, repeat_number);
-            }
-
-            // add the block to the message
-            mCurrentRMessageData->addBlock(cur_data_block);
-
             // now read the variables
-            for (LLMessageBlock::message_variable_map_t::const_iterator iter =
-                     mbci->mMemberVariables.begin();
-                 iter != mbci->mMemberVariables.end(); iter++)
+            for (U32 var_index = block.mFirstVariable;
+                 var_index < block.mFirstVariable + block.mNumVariables; ++var_index)
             {
-                const LLMessageVariable& mvci = **iter;
-
-                // ok, build out the variables
-                // add variable block
-                cur_data_block->addVariable(mvci.getName(), mvci.getType());
+                const LLMessageDecodePlan::Variable& var = plan.mVariables[var_index];
+                DecodedField field;
 
                 // what type of variable?
-                if (mvci.getType() == MVT_VARIABLE)
+                if (var.mType == MVT_VARIABLE)
                 {
                     // variable, get the number of bytes to read from the template
-                    S32 data_size = mvci.getSize();
+                    S32 data_size = var.mSize;
                     U8 tsizeb = 0;
                     U16 tsizeh = 0;
                     U32 tsize = 0;
@@ -664,38 +639,46 @@ bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
                     }
                     decode_pos += data_size;
 
-                    cur_data_block->addData(mvci.getName(), &buffer[decode_pos], tsize, mvci.getType());
-                    decode_pos += tsize;
+                    field.mSize = (S32)tsize;
+                    if (decode_pos + field.mSize > mReceiveSize)
+                    {
+                        logRanOffEndOfPacket(sender, decode_pos, field.mSize);
+
+                        // default to 0s rather than reading past the packet
+                        field.mOffset = appendZeroes(field.mSize);
+                    }
+                    else
+                    {
+                        field.mOffset = (U32)decode_pos;
+                    }
+                    decode_pos += field.mSize;
                 }
                 else
                 {
                     // fixed!
-                    // so, copy data pointer and set data size to fixed size
-                    if ((decode_pos + mvci.getSize()) > mReceiveSize)
+                    // so, point at the data and set data size to fixed size
+                    field.mSize = var.mSize;
+                    if ((decode_pos + var.mSize) > mReceiveSize)
                     {
-                        logRanOffEndOfPacket(sender, decode_pos, mvci.getSize());
+                        logRanOffEndOfPacket(sender, decode_pos, var.mSize);
 
                         // default to 0s.
-                        U32 size = mvci.getSize();
-                        std::vector<U8> data(size, 0);
-                        cur_data_block->addData(mvci.getName(), &(data[0]),
-                                                size, mvci.getType());
+                        field.mOffset = appendZeroes(var.mSize);
                     }
                     else
                     {
-                        cur_data_block->addData(mvci.getName(),
-                                                &buffer[decode_pos],
-                                                mvci.getSize(),
-                                                mvci.getType());
+                        field.mOffset = (U32)decode_pos;
                     }
-                    decode_pos += mvci.getSize();
+                    decode_pos += var.mSize;
                 }
+                mFields.push_back(field);
             }
         }
     }
 
-    if (mCurrentRMessageData->mMemberBlocks.empty()
-        && !mCurrentRMessageTemplate->mMemberBlocks.empty())
+    mCurrentRMessagePlan = &plan;
+
+    if (!have_blocks && num_blocks)
     {
         LL_DEBUGS() << "Empty message '" << mCurrentRMessageTemplate->mName << "' (no blocks)" << LL_ENDL;
         return false;
@@ -704,25 +687,29 @@ bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
     {
         static LLTimer decode_timer;
 
-        if(LLMessageReader::getTimeDecodes() || gMessageSystem->getTimingCallback())
+        // the reader also runs without a message system, in unit tests
+        LLMessageSystem* msg_system = gMessageSystem;
+        const bool time_decode = LLMessageReader::getTimeDecodes()
+            || (msg_system && msg_system->getTimingCallback());
+        if(time_decode)
         {
             decode_timer.reset();
         }
 
-        if( !mCurrentRMessageTemplate->callHandlerFunc(gMessageSystem) )
+        if( !mCurrentRMessageTemplate->callHandlerFunc(msg_system) )
         {
             LL_WARNS() << "Message from " << sender << " with no handler function received: " << mCurrentRMessageTemplate->mName << LL_ENDL;
         }
 
-        if(LLMessageReader::getTimeDecodes() || gMessageSystem->getTimingCallback())
+        if(time_decode)
         {
             F32 decode_time = decode_timer.getElapsedTimeF32();
 
-            if (gMessageSystem->getTimingCallback())
+            if (msg_system && msg_system->getTimingCallback())
             {
-                (gMessageSystem->getTimingCallback())(mCurrentRMessageTemplate->mName,
+                (msg_system->getTimingCallback())(mCurrentRMessageTemplate->mName,
                                 decode_time,
-                                gMessageSystem->getTimingCallbackData());
+                                msg_system->getTimingCallbackData());
             }
 
             if (LLMessageReader::getTimeDecodes())
@@ -822,9 +809,35 @@ bool LLTemplateMessageReader::isUdpBanned() const
 //virtual
 void LLTemplateMessageReader::copyToBuilder(LLMessageBuilder& builder) const
 {
-    if(NULL == mCurrentRMessageTemplate)
+    if(NULL == mCurrentRMessageTemplate || NULL == mCurrentRMessagePlan)
     {
         return;
     }
-    builder.copyFromMessageData(*mCurrentRMessageData);
+
+    // Builders take the block tree the reader used to decode into. Only
+    // forwarded messages get here, so it is put together on demand.
+    const LLMessageDecodePlan& plan = *mCurrentRMessagePlan;
+    LLMsgData data(mCurrentRMessageTemplate->mName);
+    for (U32 block_index = 0; block_index < (U32)plan.mBlocks.size(); ++block_index)
+    {
+        const LLMessageDecodePlan::Block& block = plan.mBlocks[block_index];
+        const S32 repeat_number = mBlockCounts[block_index];
+        const DecodedField* field = mFields.data() + mBlockFields[block_index];
+        for (S32 i = 0; i < repeat_number; i++)
+        {
+            LLMsgBlkData* block_data = new LLMsgBlkData(block.mName, repeat_number);
+            // repeated blocks are told apart by offsetting the name
+            block_data->mName = block.mName + i;
+            data.addBlock(block_data);
+
+            for (U32 var_index = block.mFirstVariable;
+                 var_index < block.mFirstVariable + block.mNumVariables; ++var_index, ++field)
+            {
+                const LLMessageDecodePlan::Variable& var = plan.mVariables[var_index];
+                block_data->addVariable(var.mName, var.mType);
+                block_data->addData(var.mName, mDecodeBuffer.data() + field->mOffset, field->mSize, var.mType);
+            }
+        }
+    }
+    builder.copyFromMessageData(data);
 }
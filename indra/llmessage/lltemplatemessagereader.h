@@ -30,9 +30,10 @@
 #include "llmessagereader.h"
 
 #include <map>
+#include <vector>
 
+class LLMessageDecodePlan;
 class LLMessageTemplate;
-class LLMsgData;
 
 class LLTemplateMessageReader : public LLMessageReader
 {
@@ -118,10 +119,32 @@ private:
 
     bool decodeData(const U8* buffer, const LLHost& sender );
 
+    // Index into mFields of a variable of the current message, or
+    // LL_BLOCK_NOT_IN_MESSAGE / LL_VARIABLE_NOT_IN_BLOCK.
+    S32 findField(const char* blockname, S32 blocknum, const char* varname) const;
+    // Zero filled bytes past the received data, for fields that run off
+    // the end of the packet; returns their offset.
+    U32 appendZeroes(S32 size);
+
+    struct DecodedField
+    {
+        U32 mOffset;    // into mDecodeBuffer
+        S32 mSize;
+    };
+
     S32 mReceiveSize;
     LLMessageTemplate* mCurrentRMessageTemplate;
-    LLMsgData* mCurrentRMessageData;
+    // set once the current message is decoded
+    const LLMessageDecodePlan* mCurrentRMessagePlan;
     message_template_number_map_t& mMessageNumbers;
+
+    // The decoded message. Only the thread running the message system
+    // reads messages, so one set of buffers per reader is reused for every
+    // message and grows to the largest seen.
+    std::vector<U8> mDecodeBuffer;          // the packet, then zeroes
+    std::vector<DecodedField> mFields;      // for each block, every instance's variables in order
+    std::vector<S32> mBlockCounts;          // per template block, 0 when absent
+    std::vector<U32> mBlockFields;          // per template block, its first entry in mFields
 };
 
 #endif // LL_LLTEMPLATEMESSAGEREADER_H
@@ -0,0 +1,232 @@
+/**
+ * @file llzerocode.cpp
+ * @brief Zero run coding of UDP message bodies
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llzerocode.h"
+
+#if defined(__arm64__) || defined(__aarch64__)
+#include "sse2neon.h"
+#else
+#include <emmintrin.h>
+#endif
+
+#include <bit>
+
+namespace
+{
+    constexpr S32 SPAN = 16;
+    // longest run one zero and count byte can stand for
+    constexpr S32 MAX_RUN = 255;
+
+    // bit n set where byte n of the 16 at in is zero
+    LL_FORCE_INLINE U32 zero_mask(const U8* in)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)in);
+        return (U32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128()));
+    }
+
+    // Length of the span of non-zero bytes at in[i].
+    LL_FORCE_INLINE S32 literal_span(const U8* in, S32 i, S32 size)
+    {
+        const S32 start = i;
+        while (i + SPAN <= size)
+        {
+            U32 mask = zero_mask(in + i);
+            if (mask)
+            {
+                return i - start + std::countr_zero(mask);
+            }
+            i += SPAN;
+        }
+        while (i < size && in[i])
+        {
+            ++i;
+        }
+        return i - start;
+    }
+
+    // Length of the run of zeroes at in[i].
+    LL_FORCE_INLINE S32 zero_run(const U8* in, S32 i, S32 size)
+    {
+        const S32 start = i;
+        while (i + SPAN <= size)
+        {
+            U32 mask = ~zero_mask(in + i) & 0xffff;
+            if (mask)
+            {
+                return i - start + std::countr_zero(mask);
+            }
+            i += SPAN;
+        }
+        while (i < size && !in[i])
+        {
+            ++i;
+        }
+        return i - start;
+    }
+
+    // Copies a span 16 bytes at a time. The last store may run past the
+    // span, into bytes that are written again later or lie past the end of
+    // the result, as long as input and output have the room.
+    LL_FORCE_INLINE void copy_span(const U8* in, S32 length, S32 in_room, U8* out, S32 out_room)
+    {
+        S32 i = 0;
+        for (; i + SPAN <= length; i += SPAN)
+        {
+            _mm_storeu_si128((__m128i*)(out + i), _mm_loadu_si128((const __m128i*)(in + i)));
+        }
+        if (i < length)
+        {
+            if (i + SPAN <= in_room && i + SPAN <= out_room)
+            {
+                _mm_storeu_si128((__m128i*)(out + i), _mm_loadu_si128((const __m128i*)(in + i)));
+            }
+            else
+            {
+                memcpy(out + i, in + i, length - i);
+            }
+        }
+    }
+
+    template <bool WRITE>
+    S32 encode_impl(const U8* in, S32 size, U8* out, S32 out_capacity)
+    {
+        S32 i = 0;
+        S32 o = 0;
+        while (i < size)
+        {
+            S32 literal = literal_span(in, i, size);
+            if (literal)
+            {
+                if (o + literal > out_capacity)
+                {
+                    return -1;
+                }
+                if (WRITE)
+                {
+                    copy_span(in + i, literal, size - i, out + o, out_capacity - o);
+                }
+                i += literal;
+                o += literal;
+            }
+            if (i == size)
+            {
+                break;
+            }
+
+            S32 run = zero_run(in, i, size);
+            i += run;
+            S32 pairs = (run + MAX_RUN - 1) / MAX_RUN;
+            if (o + 2 * pairs > out_capacity)
+            {
+                return -1;
+            }
+            if (WRITE)
+            {
+                for (; run > MAX_RUN; run -= MAX_RUN)
+                {
+                    out[o++] = 0;
+                    out[o++] = (U8)MAX_RUN;
+                }
+                out[o++] = 0;
+                out[o++] = (U8)run;
+            }
+            else
+            {
+                o += 2 * pairs;
+            }
+        }
+        return o;
+    }
+}
+
+// static
+S32 LLZeroCode::encode(const U8* in, S32 size, U8* out, S32 out_capacity)
+{
+    return encode_impl<true>(in, size, out, out_capacity);
+}
+
+// static
+S32 LLZeroCode::encodedSize(const U8* in, S32 size)
+{
+    return encode_impl<false>(in, size, NULL, S32_MAX);
+}
+
+// static
+S32 LLZeroCode::decode(const U8* in, S32 size, U8* out, S32 out_capacity)
+{
+    S32 i = 0;
+    S32 o = 0;
+    while (i < size)
+    {
+        S32 literal = literal_span(in, i, size);
+        if (literal)
+        {
+            if (o + literal > out_capacity)
+            {
+                return -1;
+            }
+            copy_span(in + i, literal, size - i, out + o, out_capacity - o);
+            i += literal;
+            o += literal;
+        }
+        if (i == size)
+        {
+            break;
+        }
+
+        // a zero, any extra zeroes, then the count; a packet may end
+        // before the count
+        ++i;
+        S32 run = 1;
+        while (i < size && !in[i])
+        {
+            run += 256;
+            ++i;
+        }
+        if (i < size)
+        {
+            run += in[i] - 1;
+            ++i;
+        }
+
+        if (o + run > out_capacity)
+        {
+            return -1;
+        }
+        if (run <= SPAN && out_capacity - o >= SPAN)
+        {
+            _mm_storeu_si128((__m128i*)(out + o), _mm_setzero_si128());
+        }
+        else
+        {
+            memset(out + o, 0, run);
+        }
+        o += run;
+    }
+    return o;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file llzerocode.h
+ * @brief Zero run coding of UDP message bodies
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLZEROCODE_H
+#define LL_LLZEROCODE_H
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLZeroCode
+//
+// The zero coding of zerocoded template messages, applied to the body that
+// follows the packet header. Non-zero bytes are sent as they are; a run of
+// zeroes is sent as a zero followed by the run length, runs longer than
+// 255 being split. When decoding, further zeroes between a zero and its
+// count add 256 each, a form older senders produced.
+//
+// Both directions scan 16 bytes at a time for the next zero (or non-zero)
+// and copy literal spans whole.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+class LLZeroCode
+{
+public:
+    // Encodes size bytes of input into out. Returns the encoded size, or
+    // -1 if it would be more than out_capacity; passing the input size
+    // less one as the capacity stops early on data that doesn't shrink.
+    static S32 encode(const U8* in, S32 size, U8* out, S32 out_capacity);
+
+    // Size encode() would produce, without writing it.
+    static S32 encodedSize(const U8* in, S32 size);
+
+    // Decodes size bytes of input into out. Returns the decoded size, or
+    // -1 if it would be more than out_capacity.
+    static S32 decode(const U8* in, S32 size, U8* out, S32 out_capacity);
+};
+
+#endif // LL_LLZEROCODE_H
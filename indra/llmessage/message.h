@@ -420,6 +420,9 @@ public:
     // returns total number of buffered packets after the drain
     S32     drainUdpSocket();
 
+    // Moves socket reads onto a dedicated thread, see LLPacketRing
+    bool    startReceiveThread();
+
     bool    isMessageFast(const char *msg);
     bool    isMessage(const char *msg)
     {
@@ -40,6 +40,7 @@
     #include <arpa/inet.h>
     #include <fcntl.h>
     #include <errno.h>
+    #include <poll.h>
 #endif
 
 // linden library includes
@@ -332,6 +333,49 @@ S32 receive_packet(int hSocket, char * receiveBuffer)
     return nRet;
 }
 
+S32 receive_packets(int hSocket, LLReceivedDatagram* datagrams, S32 count)
+{
+    S32 received = 0;
+    while (received < count)
+    {
+        LLReceivedDatagram& dgram = datagrams[received];
+        SOCKADDR_IN src_addr;
+        int addr_size = sizeof(src_addr);
+        int nRet = recvfrom(hSocket, dgram.mData, dgram.mCapacity, 0, (struct sockaddr*)&src_addr, &addr_size);
+        if (nRet == SOCKET_ERROR)
+        {
+            int err = WSAGetLastError();
+            if (err == WSAECONNRESET)
+            {
+                // ICMP port unreachable from an earlier send, keep reading
+                continue;
+            }
+            if (err != WSAEWOULDBLOCK)
+            {
+                LL_INFOS() << "receive_packets() failed, Error: " << err << LL_ENDL;
+            }
+            break;
+        }
+        dgram.mSize = nRet;
+        dgram.mSenderIP = src_addr.sin_addr.s_addr;
+        dgram.mSenderPort = ntohs(src_addr.sin_port);
+        dgram.mReceivingIF = INVALID_HOST_IP_ADDRESS;
+        ++received;
+    }
+    return received;
+}
+
+bool wait_for_packet(int hSocket, S32 timeout_ms)
+{
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    FD_SET((SOCKET)hSocket, &read_fds);
+    timeval timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    return select(0, &read_fds, NULL, NULL, &timeout) > 0;
+}
+
 // Returns true on success.
 bool send_packet(int hSocket, const char *sendBuffer, int size, U32 recipient, int nPort)
 {
@@ -592,6 +636,96 @@ int receive_packet(int hSocket, char * receiveBuffer)
     return nRet;
 }
 
+S32 receive_packets(int hSocket, LLReceivedDatagram* datagrams, S32 count)
+{
+#if LL_LINUX
+    // Batch size for a single recvmmsg() call
+    constexpr S32 MAX_BATCH = 64;
+    struct mmsghdr msgs[MAX_BATCH];
+    struct iovec iovs[MAX_BATCH];
+    struct sockaddr_in addrs[MAX_BATCH];
+    char cmsgs[MAX_BATCH][CMSG_SPACE(sizeof(struct in_pktinfo))];
+
+    S32 received = 0;
+    while (received < count)
+    {
+        S32 batch = llmin(count - received, MAX_BATCH);
+        memset(msgs, 0, sizeof(msgs[0]) * batch);
+        for (S32 i = 0; i < batch; ++i)
+        {
+            LLReceivedDatagram& dgram = datagrams[received + i];
+            iovs[i].iov_base = dgram.mData;
+            iovs[i].iov_len = dgram.mCapacity;
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_control = cmsgs[i];
+            msgs[i].msg_hdr.msg_controllen = sizeof(cmsgs[i]);
+        }
+
+        int nRet = recvmmsg(hSocket, msgs, batch, MSG_DONTWAIT, NULL);
+        if (nRet <= 0)
+        {
+            break;
+        }
+
+        for (S32 i = 0; i < nRet; ++i)
+        {
+            LLReceivedDatagram& dgram = datagrams[received + i];
+            dgram.mSize = msgs[i].msg_len;
+            dgram.mSenderIP = addrs[i].sin_addr.s_addr;
+            dgram.mSenderPort = ntohs(addrs[i].sin_port);
+            dgram.mReceivingIF = INVALID_HOST_IP_ADDRESS;
+            for (struct cmsghdr* cmsgptr = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsgptr != NULL; cmsgptr = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsgptr))
+            {
+                if (cmsgptr->cmsg_level == SOL_IP && cmsgptr->cmsg_type == IP_PKTINFO)
+                {
+                    // see recvfrom_destip()
+                    in_pktinfo* pktinfo = (in_pktinfo*)CMSG_DATA(cmsgptr);
+                    dgram.mReceivingIF = pktinfo->ipi_spec_dst.s_addr;
+                }
+            }
+        }
+        received += nRet;
+        if (nRet < batch)
+        {
+            // socket is drained
+            break;
+        }
+    }
+    return received;
+#else
+    S32 received = 0;
+    while (received < count)
+    {
+        LLReceivedDatagram& dgram = datagrams[received];
+        struct sockaddr_in src_addr;
+        socklen_t addr_size = sizeof(src_addr);
+        int nRet = recvfrom(hSocket, dgram.mData, dgram.mCapacity, 0, (struct sockaddr*)&src_addr, &addr_size);
+        if (nRet == -1)
+        {
+            break;
+        }
+        dgram.mSize = nRet;
+        dgram.mSenderIP = src_addr.sin_addr.s_addr;
+        dgram.mSenderPort = ntohs(src_addr.sin_port);
+        dgram.mReceivingIF = INVALID_HOST_IP_ADDRESS;
+        ++received;
+    }
+    return received;
+#endif
+}
+
+bool wait_for_packet(int hSocket, S32 timeout_ms)
+{
+    struct pollfd pfd;
+    pfd.fd = hSocket;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    return poll(&pfd, 1, timeout_ms) > 0;
+}
+
 bool send_packet(int hSocket, const char * sendBuffer, int size, U32 recipient, int nPort)
 {
     int     ret;
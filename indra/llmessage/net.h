@@ -43,6 +43,27 @@ void    end_net(S32& socket_out);
 // returns size of packet or -1 in case of error
 S32     receive_packet(int hSocket, char * receiveBuffer);
 
+// One datagram slot for receive_packets(). mData/mCapacity are set by the
+// caller, the rest is filled in on receipt.
+struct LLReceivedDatagram
+{
+    char*   mData;
+    S32     mCapacity;
+    S32     mSize;
+    U32     mSenderIP;
+    U16     mSenderPort;
+    U32     mReceivingIF;
+};
+
+// Receives up to count pending datagrams in as few syscalls as the platform
+// allows (recvmmsg on Linux). Unlike receive_packet() this does not touch the
+// shared sender globals, so it is safe to call from a dedicated receive thread.
+// Returns the number of datagrams received, zero if none were pending.
+S32     receive_packets(int hSocket, LLReceivedDatagram* datagrams, S32 count);
+
+// Blocks for up to timeout_ms waiting for the socket to become readable.
+bool    wait_for_packet(int hSocket, S32 timeout_ms);
+
 bool    send_packet(int hSocket, const char *sendBuffer, int size, U32 recipient, int nPort);   // Returns true on success.
 
 //void  get_sender(char * tmp);
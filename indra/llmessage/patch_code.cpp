@@ -203,7 +203,11 @@ void    init_patch_decoding(LLBitPack &bitpack)
     bitpack.resetBitPacking();
 }
 
-void    decode_patch_group_header(LLBitPack &bitpack, LLGroupHeader *gopp)
+// The decoding below is reentrant; the functions of the older interface
+// after it keep the patch size and word bits in globals between calls.
+namespace
+{
+void    unpack_patch_group_header(LLBitPack &bitpack, LLGroupHeader *gopp)
 {
     U16 retvalu16;
 
@@ -224,11 +228,9 @@ void    decode_patch_group_header(LLBitPack &bitpack, LLGroupHeader *gopp)
     retvalu8 = 0;
     bitpack.bitUnpack(&retvalu8, 8);
     gopp->layer_type = retvalu8;
-
-    gPatchSize = gopp->patch_size;
 }
 
-void    decode_patch_header(LLBitPack &bitpack, LLPatchHeader *ph)
+void    unpack_patch_header(LLBitPack &bitpack, LLPatchHeader *ph)
 {
     U8 retvalu8;
 
@@ -276,14 +278,17 @@ void    decode_patch_header(LLBitPack &bitpack, LLPatchHeader *ph)
     bitpack.bitUnpack((U8 *)&retvalu16, 10);
 #endif
     ph->patchids = retvalu16;
+}
 
-    gWordBits = (ph->quant_wbits & 0xf) + 2;
+S32     patch_word_bits(const LLPatchHeader *ph)
+{
+    return (ph->quant_wbits & 0xf) + 2;
 }
 
-void    decode_patch(LLBitPack &bitpack, S32 *patches)
+void    unpack_patch(LLBitPack &bitpack, S32 *patches, S32 patch_size, S32 wbits)
 {
 #ifdef LL_BIG_ENDIAN
-    S32     i, j, patch_size = gPatchSize, wbits = gWordBits;
+    S32     i, j;
     U8      tempu8;
     U16     tempu16;
     U32     tempu32;
@@ -356,7 +361,7 @@ void    decode_patch(LLBitPack &bitpack, S32 *patches)
         }
     }
 #else
-    S32     i, j, patch_size = gPatchSize, wbits = gWordBits;
+    S32     i, j;
     U32     temp;
     for (i = 0; i < patch_size*patch_size; i++)
     {
@@ -404,4 +409,61 @@ void    decode_patch(LLBitPack &bitpack, S32 *patches)
     }
 #endif
 }
+} // anonymous namespace
 
+void    decode_patch_group_header(LLBitPack &bitpack, LLGroupHeader *gopp)
+{
+    unpack_patch_group_header(bitpack, gopp);
+    gPatchSize = gopp->patch_size;
+}
+
+void    decode_patch_header(LLBitPack &bitpack, LLPatchHeader *ph)
+{
+    unpack_patch_header(bitpack, ph);
+    if (END_OF_PATCHES != ph->quant_wbits)
+    {
+        gWordBits = patch_word_bits(ph);
+    }
+}
+
+void    decode_patch(LLBitPack &bitpack, S32 *patches)
+{
+    unpack_patch(bitpack, patches, gPatchSize, gWordBits);
+}
+
+bool    decode_patches(LLBitPack &bitpack, S32 patches_per_edge, LLDecodedPatches &decoded)
+{
+    decoded.mHeaders.clear();
+    decoded.mHeights.clear();
+    decoded.mStoppedOnBadPatch = false;
+
+    unpack_patch_group_header(bitpack, &decoded.mGroupHeader);
+    const S32 patch_size = decoded.mGroupHeader.patch_size;
+    // heights are kept patch by patch, not at the sender's stride
+    decoded.mGroupHeader.stride = patch_size;
+
+    LLPatchHeader ph;
+    S32 patch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+    while (1)
+    {
+        unpack_patch_header(bitpack, &ph);
+        if (ph.quant_wbits == END_OF_PATCHES)
+        {
+            return true;
+        }
+
+        if (  (patch_size != NORMAL_PATCH_SIZE && patch_size != LARGE_PATCH_SIZE)
+            ||((ph.patchids >> 5) >= patches_per_edge)
+            ||((ph.patchids & 0x1F) >= patches_per_edge))
+        {
+            decoded.mStoppedOnBadPatch = true;
+            decoded.mBadPatchHeader = ph;
+            return false;
+        }
+
+        unpack_patch(bitpack, patch, patch_size, patch_word_bits(&ph));
+        decoded.mHeaders.push_back(ph);
+        decoded.mHeights.resize(decoded.mHeights.size() + patch_size*patch_size);
+        decompress_patch(&decoded.mHeights[decoded.mHeights.size() - patch_size*patch_size], patch, &ph, &decoded.mGroupHeader);
+    }
+}
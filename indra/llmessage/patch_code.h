@@ -27,9 +27,11 @@
 #ifndef LL_PATCH_CODE_H
 #define LL_PATCH_CODE_H
 
+#include "patch_dct.h"
+
+#include <vector>
+
 class LLBitPack;
-class LLGroupHeader;
-class LLPatchHeader;
 
 void    init_patch_coding(LLBitPack &bitpack);
 void    code_patch_group_header(LLBitPack &bitpack, LLGroupHeader *gopp);
@@ -43,4 +45,30 @@ void    decode_patch_group_header(LLBitPack &bitpack, LLGroupHeader *gopp);
 void    decode_patch_header(LLBitPack &bitpack, LLPatchHeader *ph);
 void    decode_patch(LLBitPack &bitpack, S32 *patches);
 
+// The patches of one layer packet, decoded and decompressed in one go by
+// decode_patches().
+class LLDecodedPatches
+{
+public:
+    S32 getNumPatches() const                       { return (S32)mHeaders.size(); }
+    S32 getPatchSize() const                        { return mGroupHeader.patch_size; }
+    // heights of patch n, getPatchSize() squared of them, row major
+    const F32 *getHeights(S32 n) const              { return &mHeights[(size_t)n * getPatchSize() * getPatchSize()]; }
+
+    LLGroupHeader mGroupHeader;
+    std::vector<LLPatchHeader> mHeaders;            // in the order sent
+    std::vector<F32> mHeights;
+    // set if decoding stopped at a patch that doesn't fit, which is left out
+    bool mStoppedOnBadPatch;
+    LLPatchHeader mBadPatchHeader;
+};
+
+// Decodes a whole layer packet from its group header on: bit unpacking,
+// dequantization and inverse DCT of every patch up to END_OF_PATCHES.
+// Patches must be NORMAL_PATCH_SIZE or LARGE_PATCH_SIZE and their ids less
+// than patches_per_edge each way. Unlike the functions above this keeps
+// nothing in globals, so any number of packets may be decoded at once on
+// different threads. Returns false if it stopped early on a bad patch.
+bool    decode_patches(LLBitPack &bitpack, S32 patches_per_edge, LLDecodedPatches &decoded);
+
 #endif
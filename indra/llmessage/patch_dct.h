@@ -88,4 +88,8 @@ void init_patch_decompressor(S32 size);
 void decompress_patch(F32 *patch, S32 *cpatch, LLPatchHeader *ph);
 void decompress_patchv(LLVector3 *v, S32 *cpatch, LLPatchHeader *ph);
 
+// As decompress_patch(), for the given group header rather than the one last
+// set. Safe to call from several threads at once.
+void decompress_patch(F32 *patch, const S32 *cpatch, const LLPatchHeader *ph, const LLGroupHeader *gopp);
+
 #endif
@@ -30,6 +30,12 @@
 #include "v3math.h"
 #include "patch_dct.h"
 
+#if defined(__arm64__) || defined(__aarch64__)
+#include "sse2neon.h"
+#else
+#include <emmintrin.h>
+#endif
+
 LLGroupHeader   *gGOPP;
 
 void set_group_of_patch_header(LLGroupHeader *gopp)
@@ -37,599 +43,257 @@ void set_group_of_patch_header(LLGroupHeader *gopp)
     gGOPP = gopp;
 }
 
-F32 gPatchDequantizeTable[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-void build_patch_dequantize_table(S32 size)
+namespace
 {
-    S32 i, j;
-    for (j = 0; j < size; j++)
+    // Dequantization, inverse cosine and zigzag tables for one patch size.
+    // They are built once and never change, so any thread may use them.
+    struct LLPatchDecompressTables
     {
-        for (i = 0; i < size; i++)
-        {
-            gPatchDequantizeTable[j*size + i] = (1.f + 2.f*(i+j));
-        }
-    }
-}
-
-S32 gCurrentDeSize = 0;
+        LLPatchDecompressTables(S32 size);
 
-F32 gPatchICosines[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+        alignas(16) F32 mDequantize[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+        alignas(16) F32 mICosines[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+        S32 mDeCopy[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+    };
 
-void setup_patch_icosines(S32 size)
-{
-    S32 n, u;
-    F32 oosob = F_PI*0.5f/size;
-
-    for (u = 0; u < size; u++)
+    void build_patch_dequantize_table(F32 *table, S32 size)
     {
-        for (n = 0; n < size; n++)
+        S32 i, j;
+        for (j = 0; j < size; j++)
         {
-            gPatchICosines[u*size+n] = cosf((2.f*n+1.f)*u*oosob);
+            for (i = 0; i < size; i++)
+            {
+                table[j*size + i] = (1.f + 2.f*(i+j));
+            }
         }
     }
-}
-
-S32 gDeCopyMatrix[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-
-void build_decopy_matrix(S32 size)
-{
-    S32 i, j, count;
-    bool    b_diag = false;
-    bool    b_right = true;
-
-    i = 0;
-    j = 0;
-    count = 0;
 
-    while (  (i < size)
-           &&(j < size))
+    void setup_patch_icosines(F32 *icosines, S32 size)
     {
-        gDeCopyMatrix[j*size + i] = count;
+        S32 n, u;
+        F32 oosob = F_PI*0.5f/size;
 
-        count++;
-
-        if (!b_diag)
+        for (u = 0; u < size; u++)
         {
-            if (b_right)
-            {
-                if (i < size - 1)
-                    i++;
-                else
-                    j++;
-                b_right = false;
-                b_diag = true;
-            }
-            else
+            for (n = 0; n < size; n++)
             {
-                if (j < size - 1)
-                    j++;
-                else
-                    i++;
-                b_right = true;
-                b_diag = true;
+                icosines[u*size+n] = cosf((2.f*n+1.f)*u*oosob);
             }
         }
-        else
+    }
+
+    void build_decopy_matrix(S32 *decopy, S32 size)
+    {
+        S32 i, j, count;
+        bool    b_diag = false;
+        bool    b_right = true;
+
+        i = 0;
+        j = 0;
+        count = 0;
+
+        while (  (i < size)
+               &&(j < size))
         {
-            if (b_right)
+            decopy[j*size + i] = count;
+
+            count++;
+
+            if (!b_diag)
             {
-                i++;
-                j--;
-                if (  (i == size - 1)
-                    ||(j == 0))
+                if (b_right)
+                {
+                    if (i < size - 1)
+                        i++;
+                    else
+                        j++;
+                    b_right = false;
+                    b_diag = true;
+                }
+                else
                 {
-                    b_diag = false;
+                    if (j < size - 1)
+                        j++;
+                    else
+                        i++;
+                    b_right = true;
+                    b_diag = true;
                 }
             }
             else
             {
-                i--;
-                j++;
-                if (  (i == 0)
-                    ||(j == size - 1))
+                if (b_right)
+                {
+                    i++;
+                    j--;
+                    if (  (i == size - 1)
+                        ||(j == 0))
+                    {
+                        b_diag = false;
+                    }
+                }
+                else
                 {
-                    b_diag = false;
+                    i--;
+                    j++;
+                    if (  (i == 0)
+                        ||(j == size - 1))
+                    {
+                        b_diag = false;
+                    }
                 }
             }
         }
     }
-}
 
-void init_patch_decompressor(S32 size)
-{
-    if (size != gCurrentDeSize)
+    LLPatchDecompressTables::LLPatchDecompressTables(S32 size)
     {
-        gCurrentDeSize = size;
-        build_patch_dequantize_table(size);
-        setup_patch_icosines(size);
-        build_decopy_matrix(size);
+        build_patch_dequantize_table(mDequantize, size);
+        setup_patch_icosines(mICosines, size);
+        build_decopy_matrix(mDeCopy, size);
     }
-}
-
-inline void idct_line(F32 *linein, F32 *lineout, S32 line)
-{
-    S32 n;
-    F32 total;
-    F32 *pcp = gPatchICosines;
-
-#ifdef _PATCH_SIZE_16_AND_32_ONLY
-    F32 oosob = 2.f/16.f;
-    S32 line_size = line*NORMAL_PATCH_SIZE;
-    F32 *tlinein, *tpcp;
-
 
-    for (n = 0; n < NORMAL_PATCH_SIZE; n++)
+    const LLPatchDecompressTables &get_decompress_tables(S32 size)
     {
-        tpcp = pcp + n;
-        tlinein = linein + line_size;
-
-        total = OO_SQRT2*(*(tlinein++));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        *(lineout + line_size + n) = total*oosob;
+        // function statics are initialized once, even when first used from
+        // several threads at the same time
+        static const LLPatchDecompressTables normal_tables(NORMAL_PATCH_SIZE);
+        static const LLPatchDecompressTables large_tables(LARGE_PATCH_SIZE);
+        return size == NORMAL_PATCH_SIZE ? normal_tables : large_tables;
     }
-#else
-    F32 oosob = 2.f/size;
-    S32 size = gGOPP->patch_size;
-    S32 line_size = line*size;
-    S32 u;
-    for (n = 0; n < size; n++)
+
+    // In place inverse DCT of a SIZE x SIZE block, columns then rows. Each
+    // pass computes four outputs at once. The terms are added in the same
+    // order as in the old unrolled scalar code.
+    template<S32 SIZE>
+    void idct_patch(F32 *block, const F32 *icosines)
     {
-        total = OO_SQRT2*linein[line_size];
-        for (u = 1; u < size; u++)
+        constexpr S32 VECTORS = SIZE/4;
+        alignas(16) F32 temp[SIZE*SIZE];
+        __m128 total[VECTORS];
+        S32 n, u, v;
+
+        // columns: temp[n][c] is the sum over u of block[u][c]*icosines[u][n],
+        // with the first term weighted by 1/sqrt(2)
+        const __m128 oo_sqrt2 = _mm_set1_ps(OO_SQRT2);
+        for (n = 0; n < SIZE; n++)
         {
-            total += linein[line_size + u]*pcp[u*size+n];
+            for (v = 0; v < VECTORS; v++)
+            {
+                total[v] = _mm_mul_ps(oo_sqrt2, _mm_load_ps(block + 4*v));
+            }
+            for (u = 1; u < SIZE; u++)
+            {
+                const __m128 icosine = _mm_set1_ps(icosines[u*SIZE + n]);
+                const F32 *linein = block + u*SIZE;
+                for (v = 0; v < VECTORS; v++)
+                {
+                    total[v] = _mm_add_ps(total[v], _mm_mul_ps(_mm_load_ps(linein + 4*v), icosine));
+                }
+            }
+            for (v = 0; v < VECTORS; v++)
+            {
+                _mm_store_ps(temp + n*SIZE + 4*v, total[v]);
+            }
         }
-        lineout[line_size + n] = total*oosob;
-    }
-#endif
-}
-
-inline void idct_line_large_slow(F32 *linein, F32 *lineout, S32 line)
-{
-    S32 n;
-    F32 total;
-    F32 *pcp = gPatchICosines;
-
-    F32 oosob = 2.f/32.f;
-    S32 line_size = line*LARGE_PATCH_SIZE;
-    F32 *tlinein, *tpcp;
-
-
-    for (n = 0; n < LARGE_PATCH_SIZE; n++)
-    {
-        tpcp = pcp + n;
-        tlinein = linein + line_size;
-
-        total = OO_SQRT2*(*(tlinein++));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        *(lineout + line_size + n) = total*oosob;
-    }
-}
-
-// Nota Bene: assumes that coefficients beyond 128 are 0!
-
-void idct_line_large(F32 *linein, F32 *lineout, S32 line)
-{
-    S32 n;
-    F32 total;
-    F32 *pcp = gPatchICosines;
-
-    F32 oosob = 2.f/32.f;
-    S32 line_size = line*LARGE_PATCH_SIZE;
-    F32 *tlinein, *tpcp;
-    F32 *baselinein = linein + line_size;
-    F32 *baselineout = lineout + line_size;
-
-
-    for (n = 0; n < LARGE_PATCH_SIZE; n++)
-    {
-        tpcp = pcp++;
-        tlinein = baselinein;
-
-        total = OO_SQRT2*(*(tlinein++));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein)*(*(tpcp));
-
-        *baselineout++ = total*oosob;
-    }
-}
-
-inline void idct_column(F32 *linein, F32 *lineout, S32 column)
-{
-    S32 n;
-    F32 total;
-    F32 *pcp = gPatchICosines;
-
-#ifdef _PATCH_SIZE_16_AND_32_ONLY
-    F32 *tlinein, *tpcp;
 
-    for (n = 0; n < NORMAL_PATCH_SIZE; n++)
-    {
-        tpcp = pcp + n;
-        tlinein = linein + column;
-
-        total = OO_SQRT2*(*tlinein);
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        *(lineout + (n<<4) + column) = total;
-    }
-
-#else
-    S32 size = gGOPP->patch_size;
-    S32 u;
-    S32 u_size;
-
-    for (n = 0; n < size; n++)
-    {
-        total = OO_SQRT2*linein[column];
-        for (u = 1; u < size; u++)
+        // rows: the same along each line of temp, scaled by 2/SIZE
+        const __m128 oosob = _mm_set1_ps(2.f/SIZE);
+        for (S32 line = 0; line < SIZE; line++)
         {
-            u_size = u*size;
-            total += linein[u_size + column]*pcp[u_size+n];
+            const F32 *linein = temp + line*SIZE;
+            const __m128 first = _mm_set1_ps(OO_SQRT2*linein[0]);
+            for (v = 0; v < VECTORS; v++)
+            {
+                total[v] = first;
+            }
+            for (u = 1; u < SIZE; u++)
+            {
+                const __m128 coefficient = _mm_set1_ps(linein[u]);
+                const F32 *icosine = icosines + u*SIZE;
+                for (v = 0; v < VECTORS; v++)
+                {
+                    total[v] = _mm_add_ps(total[v], _mm_mul_ps(coefficient, _mm_load_ps(icosine + 4*v)));
+                }
+            }
+            for (v = 0; v < VECTORS; v++)
+            {
+                _mm_store_ps(block + line*SIZE + 4*v, _mm_mul_ps(total[v], oosob));
+            }
         }
-        lineout[size*n + column] = total;
     }
-#endif
-}
-
-inline void idct_column_large_slow(F32 *linein, F32 *lineout, S32 column)
-{
-    S32 n;
-    F32 total;
-    F32 *pcp = gPatchICosines;
-
-    F32 *tlinein, *tpcp;
 
-    for (n = 0; n < LARGE_PATCH_SIZE; n++)
+    // Dequantizes and inverse transforms cpatch into block, returning the
+    // scale and offset that turn block into heights. False for a patch size
+    // the tables don't cover.
+    bool idct_decompress(F32 *block, const S32 *cpatch, const LLPatchHeader *ph, S32 size, F32 &mult, F32 &addval)
     {
-        tpcp = pcp + n;
-        tlinein = linein + column;
-
-        total = OO_SQRT2*(*tlinein);
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        *(lineout + (n<<5) + column) = total;
-    }
-}
-
-// Nota Bene: assumes that coefficients beyond 128 are 0!
-
-void idct_column_large(F32 *linein, F32 *lineout, S32 column)
-{
-    S32 n, m;
-    F32 total;
-    F32 *pcp = gPatchICosines;
-
-    F32 *tlinein, *tpcp;
-    F32 *baselinein = linein + column;
-    F32 *baselineout = lineout + column;
+        if (size != NORMAL_PATCH_SIZE && size != LARGE_PATCH_SIZE)
+        {
+            LL_WARNS() << "Unsupported patch size " << size << LL_ENDL;
+            return false;
+        }
 
-    for (n = 0; n < LARGE_PATCH_SIZE; n++)
-    {
-        tpcp = pcp++;
-        tlinein = baselinein;
+        const LLPatchDecompressTables &tables = get_decompress_tables(size);
+        F32     range = ph->range;
+        S32     prequant = (ph->quant_wbits >> 4) + 2;
+        S32     quantize = 1<<prequant;
+        F32     hmin = ph->dc_offset;
+        F32     ooq = 1.f/(F32)quantize;
 
-        total = OO_SQRT2*(*tlinein);
-        for (m = 1; m < NORMAL_PATCH_SIZE; m++)
-            total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
+        mult = ooq*range;
+        addval = mult*(F32)(1<<(prequant - 1))+hmin;
 
-        *(baselineout + (n<<5)) = total;
-    }
-}
+        for (S32 i = 0; i < size*size; i++)
+        {
+            block[i] = cpatch[tables.mDeCopy[i]]*tables.mDequantize[i];
+        }
 
-inline void idct_patch(F32 *block)
-{
-    F32 temp[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-
-#ifdef _PATCH_SIZE_16_AND_32_ONLY
-    idct_column(block, temp, 0);
-    idct_column(block, temp, 1);
-    idct_column(block, temp, 2);
-    idct_column(block, temp, 3);
-
-    idct_column(block, temp, 4);
-    idct_column(block, temp, 5);
-    idct_column(block, temp, 6);
-    idct_column(block, temp, 7);
-
-    idct_column(block, temp, 8);
-    idct_column(block, temp, 9);
-    idct_column(block, temp, 10);
-    idct_column(block, temp, 11);
-
-    idct_column(block, temp, 12);
-    idct_column(block, temp, 13);
-    idct_column(block, temp, 14);
-    idct_column(block, temp, 15);
-
-    idct_line(temp, block, 0);
-    idct_line(temp, block, 1);
-    idct_line(temp, block, 2);
-    idct_line(temp, block, 3);
-
-    idct_line(temp, block, 4);
-    idct_line(temp, block, 5);
-    idct_line(temp, block, 6);
-    idct_line(temp, block, 7);
-
-    idct_line(temp, block, 8);
-    idct_line(temp, block, 9);
-    idct_line(temp, block, 10);
-    idct_line(temp, block, 11);
-
-    idct_line(temp, block, 12);
-    idct_line(temp, block, 13);
-    idct_line(temp, block, 14);
-    idct_line(temp, block, 15);
-#else
-    S32 i;
-    S32 size = gGOPP->patch_size;
-    for (i = 0; i < size; i++)
-    {
-        idct_column(block, temp, i);
-    }
-    for (i = 0; i < size; i++)
-    {
-        idct_line(temp, block, i);
+        if (size == NORMAL_PATCH_SIZE)
+        {
+            idct_patch<NORMAL_PATCH_SIZE>(block, tables.mICosines);
+        }
+        else
+        {
+            idct_patch<LARGE_PATCH_SIZE>(block, tables.mICosines);
+        }
+        return true;
     }
-#endif
 }
 
-inline void idct_patch_large(F32 *block)
+void init_patch_decompressor(S32 size)
 {
-    F32 temp[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-
-    idct_column_large_slow(block, temp, 0);
-    idct_column_large_slow(block, temp, 1);
-    idct_column_large_slow(block, temp, 2);
-    idct_column_large_slow(block, temp, 3);
-
-    idct_column_large_slow(block, temp, 4);
-    idct_column_large_slow(block, temp, 5);
-    idct_column_large_slow(block, temp, 6);
-    idct_column_large_slow(block, temp, 7);
-
-    idct_column_large_slow(block, temp, 8);
-    idct_column_large_slow(block, temp, 9);
-    idct_column_large_slow(block, temp, 10);
-    idct_column_large_slow(block, temp, 11);
-
-    idct_column_large_slow(block, temp, 12);
-    idct_column_large_slow(block, temp, 13);
-    idct_column_large_slow(block, temp, 14);
-    idct_column_large_slow(block, temp, 15);
-
-    idct_column_large_slow(block, temp, 16);
-    idct_column_large_slow(block, temp, 17);
-    idct_column_large_slow(block, temp, 18);
-    idct_column_large_slow(block, temp, 19);
-
-    idct_column_large_slow(block, temp, 20);
-    idct_column_large_slow(block, temp, 21);
-    idct_column_large_slow(block, temp, 22);
-    idct_column_large_slow(block, temp, 23);
-
-    idct_column_large_slow(block, temp, 24);
-    idct_column_large_slow(block, temp, 25);
-    idct_column_large_slow(block, temp, 26);
-    idct_column_large_slow(block, temp, 27);
-
-    idct_column_large_slow(block, temp, 28);
-    idct_column_large_slow(block, temp, 29);
-    idct_column_large_slow(block, temp, 30);
-    idct_column_large_slow(block, temp, 31);
-
-    idct_line_large_slow(temp, block, 0);
-    idct_line_large_slow(temp, block, 1);
-    idct_line_large_slow(temp, block, 2);
-    idct_line_large_slow(temp, block, 3);
-
-    idct_line_large_slow(temp, block, 4);
-    idct_line_large_slow(temp, block, 5);
-    idct_line_large_slow(temp, block, 6);
-    idct_line_large_slow(temp, block, 7);
-
-    idct_line_large_slow(temp, block, 8);
-    idct_line_large_slow(temp, block, 9);
-    idct_line_large_slow(temp, block, 10);
-    idct_line_large_slow(temp, block, 11);
-
-    idct_line_large_slow(temp, block, 12);
-    idct_line_large_slow(temp, block, 13);
-    idct_line_large_slow(temp, block, 14);
-    idct_line_large_slow(temp, block, 15);
-
-    idct_line_large_slow(temp, block, 16);
-    idct_line_large_slow(temp, block, 17);
-    idct_line_large_slow(temp, block, 18);
-    idct_line_large_slow(temp, block, 19);
-
-    idct_line_large_slow(temp, block, 20);
-    idct_line_large_slow(temp, block, 21);
-    idct_line_large_slow(temp, block, 22);
-    idct_line_large_slow(temp, block, 23);
-
-    idct_line_large_slow(temp, block, 24);
-    idct_line_large_slow(temp, block, 25);
-    idct_line_large_slow(temp, block, 26);
-    idct_line_large_slow(temp, block, 27);
-
-    idct_line_large_slow(temp, block, 28);
-    idct_line_large_slow(temp, block, 29);
-    idct_line_large_slow(temp, block, 30);
-    idct_line_large_slow(temp, block, 31);
+    // the tables for both patch sizes are built on first use
+    get_decompress_tables(size);
 }
 
 S32 gDitherNoise = 128;
 
 void decompress_patch(F32 *patch, S32 *cpatch, LLPatchHeader *ph)
 {
-    S32     i, j;
-
-    F32     block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE], *tblock = block;
-    F32     *tpatch;
+    decompress_patch(patch, cpatch, ph, gGOPP);
+}
 
-    LLGroupHeader   *gopp = gGOPP;
+void decompress_patch(F32 *patch, const S32 *cpatch, const LLPatchHeader *ph, const LLGroupHeader *gopp)
+{
+    alignas(16) F32 block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
     S32     size = gopp->patch_size;
-    F32     range = ph->range;
-    S32     prequant = (ph->quant_wbits >> 4) + 2;
-    S32     quantize = 1<<prequant;
-    F32     hmin = ph->dc_offset;
     S32     stride = gopp->stride;
-
-    F32     ooq = 1.f/(F32)quantize;
-    F32     *dq = gPatchDequantizeTable;
-    S32     *decopy_matrix = gDeCopyMatrix;
-
-    F32     mult = ooq*range;
-    F32     addval = mult*(F32)(1<<(prequant - 1))+hmin;
-
-    for (i = 0; i < size*size; i++)
+    F32     mult, addval;
+    if (!idct_decompress(block, cpatch, ph, size, mult, addval))
     {
-        *(tblock++) = *(cpatch + *(decopy_matrix++))*(*dq++);
+        return;
     }
 
-    if (size == 16)
+    const __m128 mult4 = _mm_set1_ps(mult);
+    const __m128 addval4 = _mm_set1_ps(addval);
+    for (S32 j = 0; j < size; j++)
     {
-        idct_patch(block);
-    }
-    else
-    {
-        idct_patch_large(block);
-    }
-
-    for (j = 0; j < size; j++)
-    {
-        tpatch = patch + j*stride;
-        tblock = block + j*size;
-        for (i = 0; i < size; i++)
+        F32 *tpatch = patch + j*stride;
+        const F32 *tblock = block + j*size;
+        for (S32 i = 0; i < size; i += 4)
         {
-            *(tpatch++) = *(tblock++)*mult+addval;
+            _mm_storeu_ps(tpatch + i, _mm_add_ps(_mm_mul_ps(_mm_load_ps(tblock + i), mult4), addval4));
         }
     }
 }
@@ -639,37 +303,18 @@ void decompress_patchv(LLVector3 *v, S32 *cpatch, LLPatchHeader *ph)
 {
     S32     i, j;
 
-    F32         block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE], *tblock = block;
+    alignas(16) F32 block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE], *tblock;
     LLVector3   *tvec;
 
     LLGroupHeader   *gopp = gGOPP;
     S32     size = gopp->patch_size;
-    F32     range = ph->range;
-    S32     prequant = (ph->quant_wbits >> 4) + 2;
-    S32     quantize = 1<<prequant;
-    F32     hmin = ph->dc_offset;
     S32     stride = gopp->stride;
-
-    F32     ooq = 1.f/(F32)quantize;
-    F32     *dq = gPatchDequantizeTable;
-    S32     *decopy_matrix = gDeCopyMatrix;
-
-    F32     mult = ooq*range;
-    F32     addval = mult*(F32)(1<<(prequant - 1))+hmin;
-
-//  bool    b_diag = false;
-//  bool    b_right = true;
-
-    for (i = 0; i < size*size; i++)
+    F32     mult, addval;
+    if (!idct_decompress(block, cpatch, ph, size, mult, addval))
     {
-        *(tblock++) = *(cpatch + *(decopy_matrix++))*(*dq++);
+        return;
     }
 
-    if (size == 16)
-        idct_patch(block);
-    else
-        idct_patch_large(block);
-
     for (j = 0; j < size; j++)
     {
         tvec = v + j*stride;
@@ -680,4 +325,3 @@ void decompress_patchv(LLVector3 *v, S32 *cpatch, LLPatchHeader *ph)
         }
     }
 }
-
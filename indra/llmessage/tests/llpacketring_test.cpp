@@ -0,0 +1,255 @@
+/**
+ * @file   llpacketring_test.cpp
+ * @brief LLPacketRing receive thread tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llpacketring.h"
+#include "../net.h"
+
+#include "lltimer.h"
+#include "llrand.h"
+
+#include <fstream>
+
+#include "../test/lltut.h"
+
+namespace
+{
+    // SL packet header: flags byte, big-endian sequence number, extra header size
+    constexpr S32 SEQUENCE_OFFSET = 1;
+    constexpr S32 MIN_PACKET_SIZE = 10;
+    // keep each burst well inside the socket receive buffer
+    constexpr S32 BURST_PACKETS = 250;
+
+    struct CapturedStream
+    {
+        std::vector<std::vector<U8> > mPackets;
+
+        // Replays a capture if LL_PACKET_CAPTURE names one (records of a
+        // little-endian U16 size followed by the datagram), otherwise builds
+        // a synthetic stream shaped like a busy region: mostly compressed
+        // object updates with acks and the odd full-MTU terse update.
+        void load(S32 synthetic_count)
+        {
+            const char* capture = getenv("LL_PACKET_CAPTURE");
+            if (capture)
+            {
+                std::ifstream in(capture, std::ios::binary);
+                U8 size_bytes[2];
+                while (in.read((char*)size_bytes, 2))
+                {
+                    S32 size = size_bytes[0] | (size_bytes[1] << 8);
+                    std::vector<U8> packet(llmax(size, MIN_PACKET_SIZE), 0);
+                    if (!in.read((char*)packet.data(), size))
+                    {
+                        break;
+                    }
+                    mPackets.push_back(std::move(packet));
+                }
+            }
+
+            if (mPackets.empty())
+            {
+                LLRandLagFib2281 rand(42);
+                for (S32 i = 0; i < synthetic_count; ++i)
+                {
+                    F64 r = rand();
+                    S32 size;
+                    if (r < 0.3)
+                    {
+                        size = MIN_PACKET_SIZE + (S32)(rand() * 30.0);
+                    }
+                    else if (r < 0.9)
+                    {
+                        size = 400 + (S32)(rand() * 700.0);
+                    }
+                    else
+                    {
+                        size = MTUBYTES;
+                    }
+                    std::vector<U8> packet(size);
+                    for (S32 j = 0; j < size; ++j)
+                    {
+                        packet[j] = (U8)(rand() * 256.0);
+                    }
+                    mPackets.push_back(std::move(packet));
+                }
+            }
+
+            // stamp sequence numbers so delivery order can be checked
+            for (size_t i = 0; i < mPackets.size(); ++i)
+            {
+                U8* seq = &mPackets[i][SEQUENCE_OFFSET];
+                seq[0] = (U8)(i >> 24);
+                seq[1] = (U8)(i >> 16);
+                seq[2] = (U8)(i >> 8);
+                seq[3] = (U8)i;
+            }
+        }
+    };
+
+    U32 read_sequence(const char* datap)
+    {
+        const U8* seq = (const U8*)datap + SEQUENCE_OFFSET;
+        return ((U32)seq[0] << 24) | ((U32)seq[1] << 16) | ((U32)seq[2] << 8) | (U32)seq[3];
+    }
+
+}
+
+namespace tut
+{
+    struct packetring_data
+    {
+        S32 mRecvSocket { -1 };
+        S32 mSendSocket { -1 };
+        int mRecvPort { NET_USE_OS_ASSIGNED_PORT };
+        int mSendPort { NET_USE_OS_ASSIGNED_PORT };
+        U32 mLoopback;
+        char mBuffer[NET_BUFFER_SIZE];
+
+        packetring_data()
+        {
+            mLoopback = ip_string_to_u32(LOOPBACK_ADDRESS_STRING);
+            start_net(mRecvSocket, mRecvPort);
+            start_net(mSendSocket, mSendPort);
+        }
+
+        ~packetring_data()
+        {
+            end_net(mSendSocket);
+            end_net(mRecvSocket);
+        }
+
+        void send(const CapturedStream& stream, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const std::vector<U8>& packet = stream.mPackets[i];
+                send_packet(mSendSocket, (const char*)packet.data(), (int)packet.size(), mLoopback, mRecvPort);
+            }
+        }
+
+        // Consumes up to count packets the way LLMessageSystem::checkMessages()
+        // does, draining whenever the ring runs dry. Returns the number received.
+        S32 consume(LLPacketRing& ring, S32 count, U32& next_sequence, bool& in_order)
+        {
+            S32 received = 0;
+            LLTimer deadline;
+            deadline.setTimerExpirySec(5.f);
+            while (received < count && !deadline.hasExpired())
+            {
+                S32 size = ring.receivePacket(mRecvSocket, mBuffer);
+                if (size > 0)
+                {
+                    in_order = in_order && (read_sequence(mBuffer) == next_sequence);
+                    ++next_sequence;
+                    ++received;
+                }
+                else
+                {
+                    ring.drainSocket(mRecvSocket);
+                }
+            }
+            return received;
+        }
+    };
+    typedef test_group<packetring_data> packetring_test;
+    typedef packetring_test::object packetring_object;
+    tut::packetring_test packetring_testcase("LLPacketRing");
+
+    template<> template<>
+    void packetring_object::test<1>()
+    {
+        set_test_name("receive thread preserves order across slot wraparound");
+        ensure("sockets opened", mRecvSocket >= 0 && mSendSocket >= 0);
+
+        CapturedStream stream;
+        stream.load(3000);
+
+        LLPacketRing ring;
+        ensure("receive thread started", ring.startReceiveThread(mRecvSocket));
+
+        U32 next_sequence = 0;
+        bool in_order = true;
+        S32 received = 0;
+        for (size_t begin = 0; begin < stream.mPackets.size(); begin += BURST_PACKETS)
+        {
+            size_t end = llmin(begin + BURST_PACKETS, stream.mPackets.size());
+            send(stream, begin, end);
+            received += consume(ring, (S32)(end - begin), next_sequence, in_order);
+        }
+        ensure_equals("all packets received", received, (S32)stream.mPackets.size());
+        ensure("packets delivered in order", in_order);
+        ensure_equals("sender port", (S32)ring.getLastSender().getPort(), (S32)mSendPort);
+        ensure("sender address", ring.getLastSender().getAddress() == mLoopback);
+
+        ring.stopReceiveThread();
+        ensure("receive thread stopped", !ring.isReceiveThreadRunning());
+    }
+
+    template<> template<>
+    void packetring_object::test<2>()
+    {
+        set_test_name("queued packets honor drops and buffer accounting");
+
+        CapturedStream stream;
+        stream.load(20);
+
+        LLPacketRing ring;
+        ensure("receive thread started", ring.startReceiveThread(mRecvSocket));
+        send(stream, 0, stream.mPackets.size());
+
+        S32 total_bytes = 0;
+        for (const std::vector<U8>& packet : stream.mPackets)
+        {
+            total_bytes += (S32)packet.size();
+        }
+
+        LLTimer deadline;
+        deadline.setTimerExpirySec(5.f);
+        while (ring.drainSocket(mRecvSocket) < 20 && !deadline.hasExpired())
+        {
+            ms_sleep(1);
+        }
+        ensure_equals("all packets queued", ring.getNumBufferedPackets(), 20);
+        ensure_equals("queued bytes", ring.getNumBufferedBytes(), total_bytes);
+
+        ring.dropPackets(5);
+        for (S32 i = 0; i < 5; ++i)
+        {
+            ensure_equals("dropped packet", ring.receivePacket(mRecvSocket, mBuffer), 0);
+        }
+        for (U32 i = 5; i < 20; ++i)
+        {
+            S32 size = ring.receivePacket(mRecvSocket, mBuffer);
+            ensure_equals("packet size", size, (S32)stream.mPackets[i].size());
+            ensure_equals("packet sequence", read_sequence(mBuffer), i);
+        }
+        ensure_equals("ring empty", ring.receivePacket(mRecvSocket, mBuffer), 0);
+        ensure_equals("nothing buffered", ring.drainSocket(mRecvSocket), 0);
+        ensure_equals("actual bytes in", ring.getActualInBytes(), total_bytes);
+    }
+}
@@ -0,0 +1,381 @@
+/**
+ * @file lltemplatemessagereader_test.cpp
+ * @brief Tests for the template message reader
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lltemplatemessagereader.h"
+#include "../lltemplatemessagebuilder.h"
+#include "../llmessagetemplate.h"
+#include "../llmessagetemplateparser.h"
+#include "../message.h"
+
+#include "lluuid.h"
+#include "v3math.h"
+
+#include <random>
+
+#include "../test/lltut.h"
+
+namespace
+{
+    // the busiest messages of a region, as in message_template.msg
+    const char* TEMPLATES =
+        "version 2.0\n"
+        "{\n"
+        "   CoarseLocationUpdate Medium 6 Trusted Unencoded\n"
+        "   { Location Variable { X U8 } { Y U8 } { Z U8 } }\n"
+        "   { Index Single { You S16 } { Prey S16 } }\n"
+        "   { AgentData Variable { AgentID LLUUID } }\n"
+        "}\n"
+        "{\n"
+        "   ObjectUpdate High 12 Trusted Zerocoded\n"
+        "   { RegionData Single { RegionHandle U64 } { TimeDilation U16 } }\n"
+        "   {\n"
+        "       ObjectData Variable\n"
+        "       { ID U32 } { State U8 } { FullID LLUUID } { CRC U32 } { PCode U8 }\n"
+        "       { Material U8 } { ClickAction U8 } { Scale LLVector3 } { ObjectData Variable 1 }\n"
+        "       { ParentID U32 } { UpdateFlags U32 }\n"
+        "       { PathCurve U8 } { ProfileCurve U8 } { PathBegin U16 } { PathEnd U16 }\n"
+        "       { PathScaleX U8 } { PathScaleY U8 } { PathShearX U8 } { PathShearY U8 }\n"
+        "       { PathTwist S8 } { PathTwistBegin S8 } { PathRadiusOffset S8 } { PathTaperX S8 }\n"
+        "       { PathTaperY S8 } { PathRevolutions U8 } { PathSkew S8 }\n"
+        "       { ProfileBegin U16 } { ProfileEnd U16 } { ProfileHollow U16 }\n"
+        "       { TextureEntry Variable 2 } { TextureAnim Variable 1 }\n"
+        "       { NameValue Variable 2 } { Data Variable 2 } { Text Variable 1 } { TextColor Fixed 4 }\n"
+        "       { MediaURL Variable 1 } { PSBlock Variable 1 } { ExtraParams Variable 1 }\n"
+        "       { Sound LLUUID } { OwnerID LLUUID } { Gain F32 } { Flags U8 } { Radius F32 }\n"
+        "       { JointType U8 } { JointPivot LLVector3 } { JointAxisOrAnchor LLVector3 }\n"
+        "   }\n"
+        "}\n"
+        "{\n"
+        "   ImprovedTerseObjectUpdate High 15 Trusted Unencoded\n"
+        "   { RegionData Single { RegionHandle U64 } { TimeDilation U16 } }\n"
+        "   { ObjectData Variable { Data Variable 1 } { TextureEntry Variable 2 } }\n"
+        "}\n";
+
+    char* prehash(const char* name)
+    {
+        return LLMessageStringTable::getInstance()->getString(name);
+    }
+
+    struct Templates
+    {
+        LLTemplateMessageBuilder::message_template_name_map_t mByName;
+        LLTemplateMessageReader::message_template_number_map_t mByNumber;
+
+        void load(const std::string& body)
+        {
+            LLTemplateTokenizer tokens(body);
+            LLTemplateParser parsed(tokens);
+            for (LLTemplateParser::message_iterator iter = parsed.getMessagesBegin();
+                 iter != parsed.getMessagesEnd(); ++iter)
+            {
+                // as LLMessageSystem::addTemplate()
+                (*iter)->buildDecodePlan();
+                mByName[(*iter)->mName] = *iter;
+                mByNumber[(*iter)->mMessageNumber] = *iter;
+            }
+        }
+
+        static Templates& instance()
+        {
+            static Templates templates;
+            if (templates.mByName.empty())
+            {
+                templates.load(TEMPLATES);
+            }
+            return templates;
+        }
+    };
+
+    // What the sim put in each field of a generated message, in wire order.
+    struct Expected
+    {
+        struct Field
+        {
+            const char* mBlock;
+            const char* mVariable;
+            S32 mBlockNumber;
+            std::vector<U8> mData;
+        };
+        std::vector<Field> mFields;
+    };
+
+    // Builds a message the way the sim would, filling every field. Fixed
+    // fields get bytes below 0x40, so the floats among them are finite;
+    // variable fields get a random length.
+    std::vector<U8> build_message(LLTemplateMessageBuilder& builder, LLMessageTemplate* msg_template,
+                                  S32 variable_blocks, std::mt19937& rng, Expected* expected = NULL)
+    {
+        builder.newMessage(msg_template->mName);
+        for (LLMessageTemplate::message_block_map_t::const_iterator iter = msg_template->mMemberBlocks.begin();
+             iter != msg_template->mMemberBlocks.end(); ++iter)
+        {
+            const LLMessageBlock* block = *iter;
+            S32 count = block->mType == MBT_SINGLE ? 1
+                : block->mType == MBT_MULTIPLE ? block->mNumber : variable_blocks;
+            for (S32 i = 0; i < count; ++i)
+            {
+                builder.nextBlock(block->mName);
+                for (LLMessageBlock::message_variable_map_t::const_iterator var_iter = block->mMemberVariables.begin();
+                     var_iter != block->mMemberVariables.end(); ++var_iter)
+                {
+                    const LLMessageVariable* var = *var_iter;
+                    S32 size = var->getSize();
+                    if (var->getType() == MVT_VARIABLE)
+                    {
+                        size = rng() % (var->getSize() == 1 ? 24 : 80);
+                    }
+                    std::vector<U8> data(size);
+                    for (S32 j = 0; j < size; ++j)
+                    {
+                        data[j] = (U8)(rng() & 0x3f);
+                    }
+                    builder.addBinaryData(var->getName(), data.data(), size);
+                    if (expected)
+                    {
+                        expected->mFields.push_back({ block->mName, var->getName(), i, data });
+                    }
+                }
+            }
+        }
+
+        std::vector<U8> packet(MAX_BUFFER_SIZE, 0);
+        U32 size = builder.buildMessage(packet.data(), MAX_BUFFER_SIZE, 0);
+        packet.resize(size);
+        return packet;
+    }
+
+    // Handlers read the fields the viewer's handlers do, through the same
+    // reader calls, and fold them into a checksum.
+    LLTemplateMessageReader* sReader = NULL;
+    U64 sChecksum = 0;
+    U32 sHandled = 0;
+
+    void fold(const void* data, S32 size)
+    {
+        const U8* bytes = (const U8*)data;
+        for (S32 i = 0; i < size; ++i)
+        {
+            sChecksum = sChecksum * 31 + bytes[i];
+        }
+    }
+
+    void process_object_update(LLMessageSystem*, void**)
+    {
+        U64 region_handle;
+        sReader->getU64(prehash("RegionData"), prehash("RegionHandle"), region_handle);
+        fold(&region_handle, sizeof(region_handle));
+
+        S32 count = sReader->getNumberOfBlocks(prehash("ObjectData"));
+        for (S32 i = 0; i < count; ++i)
+        {
+            U32 local_id;
+            LLUUID full_id;
+            LLVector3 scale;
+            U8 pcode;
+            U32 flags;
+            U8 texture_entry[MTUBYTES];
+            sReader->getU32(prehash("ObjectData"), prehash("ID"), local_id, i);
+            sReader->getUUID(prehash("ObjectData"), prehash("FullID"), full_id, i);
+            sReader->getVector3(prehash("ObjectData"), prehash("Scale"), scale, i);
+            sReader->getU8(prehash("ObjectData"), prehash("PCode"), pcode, i);
+            sReader->getU32(prehash("ObjectData"), prehash("UpdateFlags"), flags, i);
+            S32 te_size = sReader->getSize(prehash("ObjectData"), i, prehash("TextureEntry"));
+            sReader->getBinaryData(prehash("ObjectData"), prehash("TextureEntry"), texture_entry, 0, i, MTUBYTES);
+            fold(&local_id, sizeof(local_id));
+            fold(full_id.mData, UUID_BYTES);
+            fold(scale.mV, sizeof(scale.mV));
+            fold(&pcode, 1);
+            fold(&flags, sizeof(flags));
+            fold(texture_entry, te_size);
+        }
+        ++sHandled;
+    }
+
+    void process_terse_object_update(LLMessageSystem*, void**)
+    {
+        S32 count = sReader->getNumberOfBlocks(prehash("ObjectData"));
+        for (S32 i = 0; i < count; ++i)
+        {
+            U8 data[MTUBYTES];
+            S32 size = sReader->getSize(prehash("ObjectData"), i, prehash("Data"));
+            sReader->getBinaryData(prehash("ObjectData"), prehash("Data"), data, 0, i, MTUBYTES);
+            fold(data, size);
+        }
+        ++sHandled;
+    }
+
+    void process_coarse_location_update(LLMessageSystem*, void**)
+    {
+        S16 you;
+        sReader->getS16(prehash("Index"), prehash("You"), you);
+        fold(&you, sizeof(you));
+        S32 count = sReader->getNumberOfBlocks(prehash("Location"));
+        for (S32 i = 0; i < count; ++i)
+        {
+            U8 x, y, z;
+            sReader->getU8(prehash("Location"), prehash("X"), x, i);
+            sReader->getU8(prehash("Location"), prehash("Y"), y, i);
+            sReader->getU8(prehash("Location"), prehash("Z"), z, i);
+            fold(&x, 1);
+            fold(&y, 1);
+            fold(&z, 1);
+        }
+        count = sReader->getNumberOfBlocks(prehash("AgentData"));
+        for (S32 i = 0; i < count; ++i)
+        {
+            LLUUID agent_id;
+            sReader->getUUID(prehash("AgentData"), prehash("AgentID"), agent_id, i);
+            fold(agent_id.mData, UUID_BYTES);
+        }
+        ++sHandled;
+    }
+
+    void process_other(LLMessageSystem*, void**)
+    {
+        ++sHandled;
+    }
+
+    void set_handlers(Templates& templates)
+    {
+        for (LLTemplateMessageReader::message_template_number_map_t::iterator iter = templates.mByNumber.begin();
+             iter != templates.mByNumber.end(); ++iter)
+        {
+            LLMessageTemplate* msg_template = iter->second;
+            std::string name(msg_template->mName);
+            msg_template->setHandlerFunc(name == "ObjectUpdate" ? process_object_update
+                                         : name == "ImprovedTerseObjectUpdate" ? process_terse_object_update
+                                         : name == "CoarseLocationUpdate" ? process_coarse_location_update
+                                         : process_other, NULL);
+        }
+    }
+}
+
+namespace tut
+{
+    struct templatemessagereader_data
+    {
+    };
+    typedef test_group<templatemessagereader_data> templatemessagereader_group;
+    typedef templatemessagereader_group::object templatemessagereader_object;
+    tut::templatemessagereader_group templatemessagereader_test("LLTemplateMessageReader");
+
+    template<> template<>
+    void templatemessagereader_object::test<1>()
+    {
+        set_test_name("every field reads back as built");
+        Templates& templates = Templates::instance();
+        set_handlers(templates);
+        LLTemplateMessageBuilder builder(templates.mByName);
+        LLTemplateMessageReader reader(templates.mByNumber);
+        sReader = &reader;
+
+        std::mt19937 rng(1);
+        const char* names[] = { "ObjectUpdate", "ImprovedTerseObjectUpdate", "CoarseLocationUpdate" };
+        sHandled = 0;
+        for (S32 round = 0; round < 30; ++round)
+        {
+            const char* name = names[round % 3];
+            Expected expected;
+            std::vector<U8> message = build_message(builder, templates.mByName[prehash(name)], 1 + round % 5, rng, &expected);
+
+            ensure(llformat("%s %d valid", name, round), reader.validateMessage(message.data(), (S32)message.size(), LLHost()));
+            ensure(llformat("%s %d read", name, round), reader.readMessage(message.data(), LLHost()));
+            ensure_equals("name", std::string(reader.getMessageName()), std::string(name));
+
+            for (const Expected::Field& field : expected.mFields)
+            {
+                std::string what = llformat("%s %d %s #%d %s", name, round, field.mBlock, field.mBlockNumber, field.mVariable);
+                S32 size = reader.getSize(field.mBlock, field.mBlockNumber, field.mVariable);
+                ensure_equals(what + " size", size, (S32)field.mData.size());
+                std::vector<U8> data(size + 1, 0xff);
+                reader.getBinaryData(field.mBlock, field.mVariable, data.data(), 0, field.mBlockNumber, size);
+                ensure(what + " data", !memcmp(data.data(), field.mData.data(), size));
+            }
+        }
+        ensure_equals("handled", sHandled, 30U);
+    }
+
+    template<> template<>
+    void templatemessagereader_object::test<2>()
+    {
+        set_test_name("missing blocks and variables");
+        Templates& templates = Templates::instance();
+        set_handlers(templates);
+        LLTemplateMessageBuilder builder(templates.mByName);
+        LLTemplateMessageReader reader(templates.mByNumber);
+        sReader = &reader;
+
+        std::mt19937 rng(2);
+        std::vector<U8> message = build_message(builder, templates.mByName[prehash("CoarseLocationUpdate")], 3, rng);
+        reader.validateMessage(message.data(), (S32)message.size(), LLHost());
+        reader.readMessage(message.data(), LLHost());
+
+        ensure_equals("locations", reader.getNumberOfBlocks(prehash("Location")), 3);
+        ensure_equals("block not in template", reader.getNumberOfBlocks(prehash("RegionData")), 0);
+        ensure_equals("single block size", reader.getSize(prehash("Index"), prehash("You")), 2);
+        ensure_equals("past the last block", reader.getSize(prehash("Location"), 3, prehash("X")), LL_BLOCK_NOT_IN_MESSAGE);
+        ensure_equals("unknown block", reader.getSize(prehash("RegionData"), prehash("You")), LL_BLOCK_NOT_IN_MESSAGE);
+        ensure_equals("unknown variable", reader.getSize(prehash("Location"), 0, prehash("You")), LL_VARIABLE_NOT_IN_BLOCK);
+
+        // variable blocks missing from the end of a message are legal
+        const S32 agent_data_size = 1 + 3 * UUID_BYTES;
+        std::vector<U8> truncated(message.begin(), message.end() - agent_data_size);
+        ensure("truncated valid", reader.validateMessage(truncated.data(), (S32)truncated.size(), LLHost()));
+        ensure("truncated read", reader.readMessage(truncated.data(), LLHost()));
+        ensure_equals("agents", reader.getNumberOfBlocks(prehash("AgentData")), 0);
+        ensure_equals("locations kept", reader.getNumberOfBlocks(prehash("Location")), 3);
+    }
+
+    template<> template<>
+    void templatemessagereader_object::test<3>()
+    {
+        set_test_name("copyToBuilder rebuilds the same message");
+        Templates& templates = Templates::instance();
+        set_handlers(templates);
+        LLTemplateMessageBuilder builder(templates.mByName);
+        LLTemplateMessageReader reader(templates.mByNumber);
+        sReader = &reader;
+
+        std::mt19937 rng(3);
+        const char* names[] = { "ObjectUpdate", "ImprovedTerseObjectUpdate", "CoarseLocationUpdate" };
+        for (const char* name : names)
+        {
+            std::vector<U8> message = build_message(builder, templates.mByName[prehash(name)], 4, rng);
+            reader.validateMessage(message.data(), (S32)message.size(), LLHost());
+            reader.readMessage(message.data(), LLHost());
+
+            LLTemplateMessageBuilder copy(templates.mByName);
+            copy.newMessage(reader.getMessageName());
+            reader.copyToBuilder(copy);
+            std::vector<U8> rebuilt(MAX_BUFFER_SIZE, 0);
+            rebuilt.resize(copy.buildMessage(rebuilt.data(), MAX_BUFFER_SIZE, 0));
+            ensure_equals(std::string(name) + " size", rebuilt.size(), message.size());
+            ensure(std::string(name) + " bytes", rebuilt == message);
+        }
+    }
+}
@@ -0,0 +1,378 @@
+/**
+ * @file llzerocode_test.cpp
+ * @brief Tests for zero run coding of message bodies
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llzerocode.h"
+
+#include "llstring.h"
+
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include "../test/lltut.h"
+
+namespace
+{
+    // SL packet header: flags byte, sequence number, extra header size
+    constexpr S32 PACKET_ID_SIZE = 6;
+    constexpr U8 ZERO_CODE_FLAG = 0x80;
+    constexpr U8 ACK_FLAG = 0x10;
+
+    // The byte at a time loop zero_code() in lltemplatemessagebuilder.cpp
+    // used, on the body alone.
+    S32 scalar_encode(const U8* inptr, S32 count, U8* outptr)
+    {
+        U8* start = outptr;
+        U8 num_zeroes = 0;
+        while (count--)
+        {
+            if (!(*inptr))
+            {
+                if (num_zeroes)
+                {
+                    if (++num_zeroes > 254)
+                    {
+                        *outptr++ = num_zeroes;
+                        num_zeroes = 0;
+                    }
+                }
+                else
+                {
+                    *outptr++ = 0;
+                    num_zeroes = 1;
+                }
+                inptr++;
+            }
+            else
+            {
+                if (num_zeroes)
+                {
+                    *outptr++ = num_zeroes;
+                    num_zeroes = 0;
+                }
+                *outptr++ = *inptr++;
+            }
+        }
+        if (num_zeroes)
+        {
+            *outptr++ = num_zeroes;
+        }
+        return (S32)(outptr - start);
+    }
+
+    // LLMessageSystem::zeroCodeExpand()'s byte at a time loop, with a plain
+    // bounds check in place of its resets.
+    S32 scalar_decode(const U8* in, S32 size, U8* out, S32 out_capacity)
+    {
+        S32 o = 0;
+        S32 i = 0;
+        while (i < size)
+        {
+            if (in[i])
+            {
+                if (o >= out_capacity)
+                {
+                    return -1;
+                }
+                out[o++] = in[i++];
+                continue;
+            }
+            ++i;
+            S32 run = 1;
+            while (i < size && !in[i])
+            {
+                run += 256;
+                ++i;
+            }
+            if (i < size)
+            {
+                run += in[i++] - 1;
+            }
+            if (o + run > out_capacity)
+            {
+                return -1;
+            }
+            memset(out + o, 0, run);
+            o += run;
+        }
+        return o;
+    }
+
+    // Random bytes with the given percentage of zeroes, and now and then a
+    // long run of them.
+    std::vector<U8> random_body(std::mt19937& rng, S32 size, U32 zero_percent)
+    {
+        std::vector<U8> body(size);
+        for (S32 i = 0; i < size; ++i)
+        {
+            body[i] = (rng() % 100 < zero_percent) ? 0 : (U8)(1 + rng() % 255);
+        }
+        if (size > 600 && rng() % 4 == 0)
+        {
+            S32 run = 250 + rng() % 300;
+            memset(body.data() + rng() % (size - run), 0, run);
+        }
+        return body;
+    }
+
+    // RegionHandle and TimeDilation of an ObjectUpdate
+    void append_region_data(std::mt19937& rng, std::vector<U8>& body)
+    {
+        const U8 handle[] = { 0, 3, 0xe8, 0, 0, 3, 0xe5, 0 };
+        body.insert(body.end(), handle, handle + sizeof(handle));
+        body.push_back(0xff);
+        body.push_back((U8)(0xf0 + rng() % 16));
+    }
+
+    // The body of an ObjectUpdate for a prim, field by field: ids, shape
+    // parameters that are mostly zero, a texture entry, and the sound and
+    // joint fields that are almost always zero.
+    void append_object_data(std::mt19937& rng, std::vector<U8>& body)
+    {
+        auto bytes = [&](S32 count, U32 zero_percent)
+        {
+            for (S32 i = 0; i < count; ++i)
+            {
+                body.push_back((rng() % 100 < zero_percent) ? 0 : (U8)(1 + rng() % 255));
+            }
+        };
+        bytes(4, 0);        // ID
+        bytes(1, 90);       // State
+        bytes(16, 2);       // FullID
+        bytes(4, 0);        // CRC
+        bytes(3, 30);       // PCode, Material, ClickAction
+        bytes(12, 10);      // Scale
+        body.push_back(60);
+        bytes(60, 35);      // ObjectData: position, velocities, rotation
+        bytes(4, 80);       // ParentID
+        bytes(4, 40);       // UpdateFlags
+        bytes(22, 75);      // path and profile parameters
+        S32 te_size = 20 + rng() % 160;
+        body.push_back((U8)te_size);
+        body.push_back(0);
+        bytes(te_size, 25); // TextureEntry
+        body.push_back(0);  // TextureAnim
+        S32 name_value = (rng() % 4 == 0) ? 20 + rng() % 40 : 0;
+        body.push_back((U8)name_value);
+        body.push_back(0);
+        bytes(name_value, 0);
+        body.push_back(0);  // Data
+        body.push_back(0);
+        S32 text = (rng() % 8 == 0) ? 10 + rng() % 30 : 0;
+        body.push_back((U8)text);
+        bytes(text, 0);
+        bytes(4, 90);       // TextColor
+        body.push_back(0);  // MediaURL
+        body.push_back(0);  // PSBlock
+        S32 extra = (rng() % 3 == 0) ? 24 : 1;
+        body.push_back((U8)extra);
+        bytes(extra, 40);   // ExtraParams
+        bytes(16 + 16 + 4 + 1 + 4, 97); // Sound, OwnerID, Gain, Flags, Radius
+        bytes(1 + 12 + 12, 99);         // JointType, JointPivot, JointAxisOrAnchor
+    }
+
+    // Zero coded message bodies to test with. Those of LL_PACKET_CAPTURE
+    // if it names a capture (records of a little-endian U16 size followed by
+    // the datagram), otherwise ObjectUpdates of one to three prims.
+    struct Payloads
+    {
+        std::vector<std::vector<U8> > mBodies;    // as sent, zero coded
+        std::vector<std::vector<U8> > mDecoded;
+
+        void load(S32 synthetic_count)
+        {
+            const char* capture = getenv("LL_PACKET_CAPTURE");
+            if (capture)
+            {
+                std::ifstream in(capture, std::ios::binary);
+                U8 size_bytes[2];
+                while (in.read((char*)size_bytes, 2))
+                {
+                    S32 size = size_bytes[0] | (size_bytes[1] << 8);
+                    std::vector<U8> packet(size);
+                    if (!in.read((char*)packet.data(), size))
+                    {
+                        break;
+                    }
+                    if (size <= PACKET_ID_SIZE || !(packet[0] & ZERO_CODE_FLAG))
+                    {
+                        continue;
+                    }
+                    // appended acks aren't coded
+                    if (packet[0] & ACK_FLAG)
+                    {
+                        size -= 1 + 4 * packet[size - 1];
+                    }
+                    if (size > PACKET_ID_SIZE)
+                    {
+                        mBodies.emplace_back(packet.begin() + PACKET_ID_SIZE, packet.begin() + size);
+                    }
+                }
+            }
+
+            if (mBodies.empty())
+            {
+                std::mt19937 rng(7);
+                for (S32 i = 0; i < synthetic_count; ++i)
+                {
+                    std::vector<U8> body;
+                    body.push_back(12); // message number
+                    append_region_data(rng, body);
+                    S32 objects = 1 + rng() % 3;
+                    body.push_back((U8)objects);
+                    for (S32 j = 0; j < objects; ++j)
+                    {
+                        append_object_data(rng, body);
+                    }
+                    std::vector<U8> encoded(body.size() * 2);
+                    encoded.resize(scalar_encode(body.data(), (S32)body.size(), encoded.data()));
+                    mBodies.push_back(encoded);
+                }
+            }
+
+            for (const std::vector<U8>& body : mBodies)
+            {
+                std::vector<U8> decoded(8192);
+                S32 size = scalar_decode(body.data(), (S32)body.size(), decoded.data(), (S32)decoded.size());
+                decoded.resize(llmax(size, 0));
+                mDecoded.push_back(decoded);
+            }
+        }
+    };
+}
+
+namespace tut
+{
+    struct zerocode_data
+    {
+    };
+    typedef test_group<zerocode_data> zerocode_group;
+    typedef zerocode_group::object zerocode_object;
+    tut::zerocode_group zerocode_test("LLZeroCode");
+
+    template<> template<>
+    void zerocode_object::test<1>()
+    {
+        set_test_name("known encodings");
+        const U8 plain[] = { 7, 0, 0, 0, 9, 0 };
+        const U8 coded[] = { 7, 0, 3, 9, 0, 1 };
+        U8 out[64];
+        ensure_equals("encoded size", LLZeroCode::encode(plain, sizeof(plain), out, sizeof(out)), (S32)sizeof(coded));
+        ensure("encoded", !memcmp(out, coded, sizeof(coded)));
+        ensure_equals("decoded size", LLZeroCode::decode(coded, sizeof(coded), out, sizeof(out)), (S32)sizeof(plain));
+        ensure("decoded", !memcmp(out, plain, sizeof(plain)));
+
+        // runs past 255 are split
+        std::vector<U8> zeroes(300, 0);
+        std::vector<U8> long_run(16);
+        const U8 split[] = { 0, 255, 0, 45 };
+        ensure_equals("split size", LLZeroCode::encode(zeroes.data(), 300, long_run.data(), 16), 4);
+        ensure("split", !memcmp(long_run.data(), split, sizeof(split)));
+        ensure_equals("encodedSize", LLZeroCode::encodedSize(zeroes.data(), 300), 4);
+
+        // older senders wrap with extra zeroes, 256 each
+        const U8 wrapped[] = { 5, 0, 0, 4, 6 };
+        std::vector<U8> expanded(512, 0xff);
+        ensure_equals("wrapped size", LLZeroCode::decode(wrapped, sizeof(wrapped), expanded.data(), 512), 262);
+        ensure("wrapped", expanded[0] == 5 && expanded[1] == 0 && expanded[260] == 0 && expanded[261] == 6);
+
+        // a packet may end on a zero without its count
+        const U8 truncated[] = { 5, 0 };
+        ensure_equals("truncated", LLZeroCode::decode(truncated, sizeof(truncated), out, sizeof(out)), 2);
+
+        ensure_equals("too big", LLZeroCode::decode(coded, sizeof(coded), out, 5), -1);
+        ensure_equals("exact fit", LLZeroCode::encode(plain, sizeof(plain), out, sizeof(coded)), (S32)sizeof(coded));
+        ensure_equals("doesn't fit", LLZeroCode::encode(plain, sizeof(plain), out, sizeof(coded) - 1), -1);
+        const U8 literal[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+        ensure_equals("no gain", LLZeroCode::encode(literal, sizeof(literal), out, sizeof(literal) - 1), -1);
+    }
+
+    template<> template<>
+    void zerocode_object::test<2>()
+    {
+        set_test_name("fuzz against the scalar loops");
+        std::mt19937 rng(2);
+        for (S32 iter = 0; iter < 20000; ++iter)
+        {
+            S32 size = (iter % 50 == 0) ? rng() % 4000 : rng() % 700;
+            std::vector<U8> body = random_body(rng, size, rng() % 100);
+
+            std::vector<U8> expected(size * 2 + 2), actual(size * 2 + 2);
+            S32 expected_size = scalar_encode(body.data(), size, expected.data());
+            S32 actual_size = LLZeroCode::encode(body.data(), size, actual.data(), (S32)actual.size());
+            std::string what = llformat("case %d, %d bytes", iter, size);
+            ensure_equals(what + " encoded size", actual_size, expected_size);
+            ensure(what + " encoded", !memcmp(actual.data(), expected.data(), expected_size));
+            ensure_equals(what + " encodedSize", LLZeroCode::encodedSize(body.data(), size), expected_size);
+
+            S32 capacity = rng() % (expected_size + 2);
+            ensure_equals(what + " capacity", LLZeroCode::encode(body.data(), size, actual.data(), capacity),
+                          expected_size <= capacity ? expected_size : -1);
+
+            std::vector<U8> decoded(size + 1);
+            ensure_equals(what + " round trip size", LLZeroCode::decode(expected.data(), expected_size, decoded.data(), size), size);
+            ensure(what + " round trip", !size || !memcmp(decoded.data(), body.data(), size));
+
+            // whatever arrives off the wire
+            std::vector<U8> junk = random_body(rng, rng() % 400, rng() % 100);
+            S32 junk_capacity = rng() % 3000;
+            std::vector<U8> expected_junk(junk_capacity + 1), actual_junk(junk_capacity + 1);
+            S32 expected_junk_size = scalar_decode(junk.data(), (S32)junk.size(), expected_junk.data(), junk_capacity);
+            S32 actual_junk_size = LLZeroCode::decode(junk.data(), (S32)junk.size(), actual_junk.data(), junk_capacity);
+            ensure_equals(what + " decoded size", actual_junk_size, expected_junk_size);
+            ensure(what + " decoded", expected_junk_size <= 0
+                   || !memcmp(actual_junk.data(), expected_junk.data(), expected_junk_size));
+        }
+    }
+
+    template<> template<>
+    void zerocode_object::test<3>()
+    {
+        set_test_name("ObjectUpdate bodies match the scalar loops");
+        Payloads payloads;
+        payloads.load(500);
+        std::vector<U8> out(16384);
+        for (size_t i = 0; i < payloads.mBodies.size(); ++i)
+        {
+            const std::vector<U8>& body = payloads.mBodies[i];
+            const std::vector<U8>& decoded = payloads.mDecoded[i];
+            std::string what = llformat("body %u", (U32)i);
+
+            std::vector<U8> expected(out.size());
+            S32 expected_size = scalar_decode(body.data(), (S32)body.size(), expected.data(), (S32)expected.size());
+            S32 size = LLZeroCode::decode(body.data(), (S32)body.size(), out.data(), (S32)out.size());
+            ensure_equals(what + " decoded size", size, expected_size);
+            ensure(what + " decoded", expected_size <= 0 || !memcmp(out.data(), expected.data(), expected_size));
+
+            expected_size = scalar_encode(decoded.data(), (S32)decoded.size(), expected.data());
+            size = LLZeroCode::encode(decoded.data(), (S32)decoded.size(), out.data(), (S32)out.size());
+            ensure_equals(what + " encoded size", size, expected_size);
+            ensure(what + " encoded", !memcmp(out.data(), expected.data(), expected_size));
+        }
+    }
+}
@@ -0,0 +1,378 @@
+/**
+ * @file patch_code_test.cpp
+ * @brief Tests for decoding terrain patch layers
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../patch_code.h"
+#include "../patch_dct.h"
+
+#include "llbitpack.h"
+#include "llmath.h"
+#include "llstring.h"
+#include "threadpool.h"
+
+#include <vector>
+
+#include "../test/lltut.h"
+
+namespace
+{
+    const char LAND_LAYER_CODE = 'L';
+    // a 256m region: 16 patches of 16 grids each way, and the sim's stride
+    const S32 PATCHES_PER_EDGE = 16;
+    const S32 REGION_GRIDS = PATCHES_PER_EDGE * NORMAL_PATCH_SIZE;
+    // the sim sends a region's patches a few at a time
+    const S32 PATCHES_PER_PACKET = 16;
+
+    // Rolling hills with some noise, so patches have high frequencies too.
+    std::vector<F32> make_terrain(U32 seed, S32 grids)
+    {
+        std::vector<F32> terrain(grids * grids);
+        U32 noise = seed * 2654435761u + 1;
+        for (S32 y = 0; y < grids; y++)
+        {
+            for (S32 x = 0; x < grids; x++)
+            {
+                noise = noise * 1664525u + 1013904223u;
+                terrain[y * grids + x] = 40.f
+                    + 15.f * sinf(0.021f * x + seed) * cosf(0.017f * y)
+                    + 4.f * sinf(0.13f * (x + y))
+                    + (F32)(noise >> 24) / 256.f;
+            }
+        }
+        return terrain;
+    }
+
+    // A land layer packet with the given patches of terrain, coded as the
+    // sim codes them.
+    std::vector<U8> encode_layer(std::vector<F32>& terrain, S32 grids, S32 patch_size,
+                                 const std::vector<std::pair<S32, S32> >& patches)
+    {
+        std::vector<U8> buffer(64 * 1024);
+        LLBitPack bitpack(buffer.data(), (U32)buffer.size());
+        init_patch_coding(bitpack);
+        init_patch_compressor(patch_size, grids, LAND_LAYER_CODE);
+
+        LLGroupHeader group_header;
+        get_patch_group_header(&group_header);
+        code_patch_group_header(bitpack, &group_header);
+
+        S32 cpatch[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
+        for (const std::pair<S32, S32>& patch : patches)
+        {
+            F32* heights = &terrain[patch.second * patch_size * grids + patch.first * patch_size];
+            LLPatchHeader ph;
+            F32 zmax, zmin;
+            prescan_patch(heights, &ph, zmax, zmin);
+            compress_patch(heights, cpatch, &ph, 10);
+            ph.patchids = (U16)((patch.first << 5) | patch.second);
+            code_patch_header(bitpack, &ph, cpatch);
+            code_patch(bitpack, cpatch, 0);
+        }
+        code_end_of_data(bitpack);
+        buffer.resize(bitpack.flushBitPack());
+        return buffer;
+    }
+
+    // All of a region, PATCHES_PER_PACKET patches at a time.
+    std::vector<std::vector<U8> > encode_region(U32 seed)
+    {
+        std::vector<F32> terrain = make_terrain(seed, REGION_GRIDS);
+        std::vector<std::vector<U8> > packets;
+        std::vector<std::pair<S32, S32> > patches;
+        for (S32 y = 0; y < PATCHES_PER_EDGE; y++)
+        {
+            for (S32 x = 0; x < PATCHES_PER_EDGE; x++)
+            {
+                patches.emplace_back(x, y);
+                if (patches.size() == PATCHES_PER_PACKET)
+                {
+                    packets.push_back(encode_layer(terrain, REGION_GRIDS, NORMAL_PATCH_SIZE, patches));
+                    patches.clear();
+                }
+            }
+        }
+        return packets;
+    }
+
+    // The inverse DCT as plain loops, the way patch_idct.cpp spelled it out
+    // before it was vectorized.
+    void reference_decompress(F32* out, const S32* cpatch, const LLPatchHeader& ph, S32 size)
+    {
+        std::vector<F32> dequantize(size * size), icosines(size * size);
+        std::vector<S32> decopy(size * size);
+        for (S32 j = 0; j < size; j++)
+        {
+            for (S32 i = 0; i < size; i++)
+            {
+                dequantize[j * size + i] = 1.f + 2.f * (i + j);
+                icosines[j * size + i] = cosf((2.f * i + 1.f) * j * (F_PI * 0.5f / size));
+            }
+        }
+        // zigzag order, as the encoder's copy matrix
+        S32 i = 0, j = 0, count = 0;
+        bool diagonal = false, right = true;
+        while (i < size && j < size)
+        {
+            decopy[j * size + i] = count++;
+            if (!diagonal)
+            {
+                if (right) { if (i < size - 1) i++; else j++; }
+                else { if (j < size - 1) j++; else i++; }
+                right = !right;
+                diagonal = true;
+            }
+            else if (right)
+            {
+                i++; j--;
+                diagonal = !(i == size - 1 || j == 0);
+            }
+            else
+            {
+                i--; j++;
+                diagonal = !(i == 0 || j == size - 1);
+            }
+        }
+
+        std::vector<F32> block(size * size), temp(size * size);
+        for (S32 k = 0; k < size * size; k++)
+        {
+            block[k] = cpatch[decopy[k]] * dequantize[k];
+        }
+        for (S32 column = 0; column < size; column++)
+        {
+            for (S32 n = 0; n < size; n++)
+            {
+                F32 total = OO_SQRT2 * block[column];
+                for (S32 u = 1; u < size; u++)
+                {
+                    total += block[u * size + column] * icosines[u * size + n];
+                }
+                temp[n * size + column] = total;
+            }
+        }
+        for (S32 line = 0; line < size; line++)
+        {
+            for (S32 n = 0; n < size; n++)
+            {
+                F32 total = OO_SQRT2 * temp[line * size];
+                for (S32 u = 1; u < size; u++)
+                {
+                    total += temp[line * size + u] * icosines[u * size + n];
+                }
+                block[line * size + n] = total * (2.f / size);
+            }
+        }
+
+        S32 prequant = (ph.quant_wbits >> 4) + 2;
+        F32 mult = (1.f / (F32)(1 << prequant)) * ph.range;
+        F32 addval = mult * (F32)(1 << (prequant - 1)) + ph.dc_offset;
+        for (S32 k = 0; k < size * size; k++)
+        {
+            out[k] = block[k] * mult + addval;
+        }
+    }
+
+    // Decodes a packet through the older global interface and the plain
+    // inverse DCT.
+    void reference_decode(std::vector<U8>& packet, LLDecodedPatches& decoded)
+    {
+        decoded.mHeaders.clear();
+        decoded.mHeights.clear();
+        LLBitPack bitpack(packet.data(), (U32)packet.size());
+        decode_patch_group_header(bitpack, &decoded.mGroupHeader);
+        S32 size = decoded.mGroupHeader.patch_size;
+        S32 cpatch[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
+        LLPatchHeader ph;
+        while (1)
+        {
+            decode_patch_header(bitpack, &ph);
+            if (ph.quant_wbits == END_OF_PATCHES)
+            {
+                break;
+            }
+            decode_patch(bitpack, cpatch);
+            decoded.mHeaders.push_back(ph);
+            decoded.mHeights.resize(decoded.mHeights.size() + size * size);
+            reference_decompress(&decoded.mHeights[decoded.mHeights.size() - size * size], cpatch, ph, size);
+        }
+    }
+
+}
+
+namespace tut
+{
+    struct patch_code_data
+    {
+    };
+    typedef test_group<patch_code_data> patch_code_group;
+    typedef patch_code_group::object patch_code_object;
+    tut::patch_code_group patch_code_test("patch_code");
+
+    template<> template<>
+    void patch_code_object::test<1>()
+    {
+        set_test_name("decode_patches matches the scalar decoder");
+        for (S32 patch_size : { (S32)NORMAL_PATCH_SIZE, (S32)LARGE_PATCH_SIZE })
+        {
+            const S32 grids = 4 * patch_size;
+            std::vector<F32> terrain = make_terrain(patch_size, grids);
+            std::vector<std::pair<S32, S32> > patches;
+            for (S32 n = 0; n < 16; n++)
+            {
+                patches.emplace_back(n % 4, n / 4);
+            }
+            std::vector<U8> packet = encode_layer(terrain, grids, patch_size, patches);
+
+            LLDecodedPatches decoded, expected;
+            LLBitPack bitpack(packet.data(), (U32)packet.size());
+            ensure("decoded", decode_patches(bitpack, 4, decoded));
+            reference_decode(packet, expected);
+            ensure_equals("patch size", decoded.getPatchSize(), patch_size);
+            ensure_equals("patches", decoded.getNumPatches(), 16);
+            ensure_equals("reference patches", expected.getNumPatches(), 16);
+
+            for (S32 n = 0; n < 16; n++)
+            {
+                ensure_equals("patch id", decoded.mHeaders[n].patchids, patches[n].first << 5 | patches[n].second);
+                const F32* heights = decoded.getHeights(n);
+                const F32* expected_heights = expected.getHeights(n);
+                for (S32 k = 0; k < patch_size * patch_size; k++)
+                {
+                    std::string what = llformat("size %d patch %d height %d", patch_size, n, k);
+                    ensure_approximately_equals_range(what.c_str(), heights[k], expected_heights[k], 1.e-3f);
+                    // and close to what was sent
+                    S32 x = patches[n].first * patch_size + k % patch_size;
+                    S32 y = patches[n].second * patch_size + k / patch_size;
+                    ensure_approximately_equals_range(what.c_str(), heights[k], terrain[y * grids + x], 1.f);
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void patch_code_object::test<2>()
+    {
+        set_test_name("older interface decodes the same");
+        std::vector<std::vector<U8> > packets = encode_region(7);
+        for (std::vector<U8>& packet : packets)
+        {
+            LLDecodedPatches decoded;
+            LLBitPack bitpack(packet.data(), (U32)packet.size());
+            ensure("decoded", decode_patches(bitpack, PATCHES_PER_EDGE, decoded));
+
+            // as LLWind and LLSurface used to, straight into a region array
+            std::vector<F32> region(REGION_GRIDS * REGION_GRIDS, 0.f);
+            LLBitPack old_bitpack(packet.data(), (U32)packet.size());
+            LLGroupHeader group_header;
+            decode_patch_group_header(old_bitpack, &group_header);
+            init_patch_decompressor(group_header.patch_size);
+            group_header.stride = REGION_GRIDS;
+            set_group_of_patch_header(&group_header);
+            S32 cpatch[LARGE_PATCH_SIZE * LARGE_PATCH_SIZE];
+            LLPatchHeader ph;
+            S32 n = 0;
+            while (1)
+            {
+                decode_patch_header(old_bitpack, &ph);
+                if (ph.quant_wbits == END_OF_PATCHES)
+                {
+                    break;
+                }
+                decode_patch(old_bitpack, cpatch);
+                S32 x = (ph.patchids >> 5) * NORMAL_PATCH_SIZE;
+                S32 y = (ph.patchids & 0x1F) * NORMAL_PATCH_SIZE;
+                decompress_patch(&region[y * REGION_GRIDS + x], cpatch, &ph);
+
+                const F32* heights = decoded.getHeights(n++);
+                for (S32 k = 0; k < NORMAL_PATCH_SIZE * NORMAL_PATCH_SIZE; k++)
+                {
+                    ensure_equals("height", region[(y + k / NORMAL_PATCH_SIZE) * REGION_GRIDS + x + k % NORMAL_PATCH_SIZE], heights[k]);
+                }
+            }
+            ensure_equals("patches", n, decoded.getNumPatches());
+        }
+    }
+
+    template<> template<>
+    void patch_code_object::test<3>()
+    {
+        set_test_name("bad patches stop decoding");
+        std::vector<F32> terrain = make_terrain(3, 64);
+        std::vector<std::pair<S32, S32> > patches = { { 0, 0 }, { 1, 2 }, { 3, 1 }, { 2, 2 } };
+        std::vector<U8> packet = encode_layer(terrain, 64, NORMAL_PATCH_SIZE, patches);
+
+        LLDecodedPatches decoded;
+        LLBitPack bitpack(packet.data(), (U32)packet.size());
+        ensure("patch id out of range", !decode_patches(bitpack, 3, decoded));
+        ensure("stopped", decoded.mStoppedOnBadPatch);
+        ensure_equals("patches before the bad one", decoded.getNumPatches(), 2);
+        ensure_equals("bad patch", decoded.mBadPatchHeader.patchids, 3 << 5 | 1);
+
+        LLBitPack again(packet.data(), (U32)packet.size());
+        ensure("all in range", decode_patches(again, 4, decoded));
+        ensure("not stopped", !decoded.mStoppedOnBadPatch);
+        ensure_equals("all patches", decoded.getNumPatches(), 4);
+
+        // a group header patch size the tables don't cover
+        std::vector<U8> odd = packet;
+        odd[2] = 20;
+        LLBitPack odd_bitpack(odd.data(), (U32)odd.size());
+        ensure("odd patch size", !decode_patches(odd_bitpack, 4, decoded));
+        ensure_equals("no patches", decoded.getNumPatches(), 0);
+    }
+
+    template<> template<>
+    void patch_code_object::test<4>()
+    {
+        set_test_name("packets decode the same in parallel");
+        std::vector<std::vector<U8> > packets = encode_region(11);
+        std::vector<std::vector<U8> > second = encode_region(12);
+        packets.insert(packets.end(), second.begin(), second.end());
+
+        std::vector<LLDecodedPatches> serial(packets.size()), parallel(packets.size());
+        for (size_t n = 0; n < packets.size(); n++)
+        {
+            LLBitPack bitpack(packets[n].data(), (U32)packets[n].size());
+            decode_patches(bitpack, PATCHES_PER_EDGE, serial[n]);
+        }
+
+        LL::ThreadPool pool("patch_code test", 3);
+        pool.start();
+        pool.forkJoin(packets.size(), [&packets, &parallel](size_t n)
+            {
+                LLBitPack bitpack(packets[n].data(), (U32)packets[n].size());
+                decode_patches(bitpack, PATCHES_PER_EDGE, parallel[n]);
+            });
+        pool.close();
+
+        for (size_t n = 0; n < packets.size(); n++)
+        {
+            ensure_equals("patches", parallel[n].getNumPatches(), serial[n].getNumPatches());
+            ensure("heights", parallel[n].mHeights == serial[n].mHeights);
+        }
+    }
+}
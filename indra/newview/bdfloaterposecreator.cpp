@@ -2978,6 +2978,13 @@ LLKeyframeMotion* BDFloaterPoseCreator::onReadyTempMotion(std::string filename,
 		LLDataPackerBinaryBuffer dp(anim_data, anim_file_size);
 		success = mTempMotion && mTempMotion->deserialize(dp, mMotionID);
 
+		//BD - The editor works on the keys by time, unpack them out of their
+		//     compact playback storage.
+		if (success)
+		{
+			mTempMotion->getJointMotionList()->expandKeys();
+		}
+
 		if (success && eternal)
 		{
 			mTempMotion->setEternal(true);
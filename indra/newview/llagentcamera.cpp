@@ -1653,7 +1653,7 @@ void LLAgentCamera::updateCamera()
 			gAgentAvatarp->mPelvisp->setPosition(gAgentAvatarp->mPelvisp->getPosition() + diff);
 		}
 
-		gAgentAvatarp->mRoot->updateWorldMatrixChildren();
+		gAgentAvatarp->updateJointWorldMatrices();
 
 		for (LLVOAvatar::attachment_map_t::iterator iter = gAgentAvatarp->mAttachmentPoints.begin(); 
 			 iter != gAgentAvatarp->mAttachmentPoints.end(); )
@@ -2438,7 +2438,16 @@ bool LLAppViewer::initThreads()
     // a single texture blocking all other textures from decoding
     S32 image_decode_count = llclamp(cores - 6, 2, 16);
 
-    threadCounts["ImageDecode"] = image_decode_count;
+    // An entry may also be a map such as {"threads": N, "work_stealing": true}:
+    // preserve its other keys.
+    if (threadCounts["ImageDecode"].isMap())
+    {
+        threadCounts["ImageDecode"]["threads"] = image_decode_count;
+    }
+    else
+    {
+        threadCounts["ImageDecode"] = image_decode_count;
+    }
     gSavedSettings.setLLSD("ThreadPoolSizes", threadCounts);
 
     // Image decoding
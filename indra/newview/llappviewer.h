@@ -140,6 +140,7 @@ public:
     static LLImageDecodeThread* getImageDecodeThread() { return sImageDecodeThread; }
     static LLTextureFetch* getTextureFetch() { return sTextureFetch; }
     static LLPurgeDiskCacheThread* getPurgeDiskCacheThread() { return sPurgeDiskCacheThread; }
+    LL::ThreadPool* getGeneralThreadPool() const { return mGeneralThreadPool; }
 
     static U32 getTextureCacheVersion() ;
     static U32 getObjectCacheVersion() ;
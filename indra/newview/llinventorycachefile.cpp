@@ -0,0 +1,541 @@
+/**
+ * @file llinventorycachefile.cpp
+ * @brief Binary, memory mapped inventory cache file.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llinventorycachefile.h"
+
+#include "llapp.h"
+#include "llfile.h"
+#include "llinventory.h"
+
+#include <algorithm>
+
+// "INVC" when dumped, byte swapped on a machine of the other endianness
+static const U32 CACHE_FILE_MAGIC = 0x43564e49;
+// Bump when the layout of any record below changes
+static const U32 CACHE_FILE_FORMAT_VERSION = 1;
+
+static const U32 FOLDER_HAS_UNKNOWN_ITEMS = 0x1;
+
+static const char * const LOG_INV("Inventory");
+
+struct LLInventoryCacheReader::Header
+{
+    U32 mMagic;
+    U32 mFormatVersion;
+    S32 mCacheVersion;
+    U32 mCategoryCount;
+    U32 mFolderCount;
+    U32 mItemCount;
+    U64 mCategoriesOffset;
+    U64 mFoldersOffset;
+    U64 mItemIDsOffset;
+    U64 mItemsOffset;
+    U64 mStringsOffset;
+    U64 mStringsSize;
+};
+
+// Bytes of the string table, not nul terminated
+struct LLInventoryCacheReader::StringRef
+{
+    U32 mOffset;
+    U32 mLength;
+};
+
+struct LLInventoryCacheReader::CategoryRecord
+{
+    LLUUID mID;
+    LLUUID mParentID;
+    LLUUID mOwnerID;
+    LLUUID mThumbnailID;
+    StringRef mName;
+    S32 mVersion;
+    S16 mType;
+    S16 mPreferredType;
+    U8 mFavorite;
+    U8 mPad[3];
+};
+
+struct LLInventoryCacheReader::FolderRecord
+{
+    LLUUID mID;
+    U32 mFirstItem;
+    U32 mItemCount;
+    U32 mFlags;
+    U32 mPad;
+};
+
+// Everything about an item but its id, which has a table of its own so
+// that looking items up only touches ids.
+struct LLInventoryCacheReader::ItemRecord
+{
+    S64 mCreationDate;
+    LLUUID mParentID;
+    LLUUID mAssetID;
+    LLUUID mThumbnailID;
+    LLUUID mCreatorID;
+    LLUUID mOwnerID;
+    LLUUID mLastOwnerID;
+    LLUUID mGroupID;
+    U32 mMaskBase;
+    U32 mMaskOwner;
+    U32 mMaskGroup;
+    U32 mMaskEveryone;
+    U32 mMaskNextOwner;
+    U32 mFlags;
+    S32 mSalePrice;
+    StringRef mName;
+    StringRef mDescription;
+    S16 mType;
+    S16 mInventoryType;
+    U8 mSaleType;
+    U8 mFavorite;
+    U8 mPad[6];
+};
+
+// Tables start on 8 byte boundaries so that mapped records are aligned.
+static U64 align_table(U64 offset)
+{
+    return (offset + 7) & ~(U64)7;
+}
+
+//---------------------------------------------------------------------------
+// LLInventoryCacheReader
+//---------------------------------------------------------------------------
+
+LLInventoryCacheReader::LLInventoryCacheReader() :
+    mHeader(nullptr),
+    mCategories(nullptr),
+    mFolders(nullptr),
+    mItemIDs(nullptr),
+    mItems(nullptr),
+    mStrings(nullptr)
+{
+}
+
+bool LLInventoryCacheReader::open(const std::string& filename)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    // Records are written and mapped as is, so their layout must not depend on
+    // the compiler: no implicit padding anywhere.
+    static_assert(sizeof(LLUUID) == 16, "LLUUID is stored raw");
+    static_assert(sizeof(Header) == 72, "inventory cache header layout");
+    static_assert(sizeof(CategoryRecord) == 84, "inventory cache category layout");
+    static_assert(sizeof(FolderRecord) == 32, "inventory cache folder layout");
+    static_assert(sizeof(ItemRecord) == 176, "inventory cache item layout");
+
+    close();
+
+    if (!mFile.open(filename))
+    {
+        return false;
+    }
+
+    const U8* data = mFile.getData();
+    const U64 size = mFile.getSize();
+    if (size < sizeof(Header))
+    {
+        LL_WARNS(LOG_INV) << "Inventory cache " << filename << " is truncated" << LL_ENDL;
+        mFile.close();
+        return false;
+    }
+
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if (header->mMagic != CACHE_FILE_MAGIC || header->mFormatVersion != CACHE_FILE_FORMAT_VERSION)
+    {
+        LL_INFOS(LOG_INV) << "Inventory cache " << filename << " has another format" << LL_ENDL;
+        mFile.close();
+        return false;
+    }
+
+    // Every table must be aligned and lie within the file, in order
+    auto table_fits = [size](U64 offset, U64 count, U64 record_size, U64 min_offset)
+    {
+        return offset >= min_offset
+            && offset == align_table(offset)
+            && offset <= size
+            && count <= (size - offset) / record_size;
+    };
+    bool valid = table_fits(header->mCategoriesOffset, header->mCategoryCount, sizeof(CategoryRecord), sizeof(Header))
+        && table_fits(header->mFoldersOffset, header->mFolderCount, sizeof(FolderRecord),
+                      header->mCategoriesOffset + (U64)header->mCategoryCount * sizeof(CategoryRecord))
+        && table_fits(header->mItemIDsOffset, header->mItemCount, sizeof(LLUUID),
+                      header->mFoldersOffset + (U64)header->mFolderCount * sizeof(FolderRecord))
+        && table_fits(header->mItemsOffset, header->mItemCount, sizeof(ItemRecord),
+                      header->mItemIDsOffset + (U64)header->mItemCount * sizeof(LLUUID))
+        && table_fits(header->mStringsOffset, header->mStringsSize, 1,
+                      header->mItemsOffset + (U64)header->mItemCount * sizeof(ItemRecord));
+
+    const FolderRecord* folders = reinterpret_cast<const FolderRecord*>(data + header->mFoldersOffset);
+    for (U32 i = 0; valid && i < header->mFolderCount; ++i)
+    {
+        valid = folders[i].mFirstItem <= header->mItemCount
+            && folders[i].mItemCount <= header->mItemCount - folders[i].mFirstItem;
+    }
+
+    if (!valid)
+    {
+        LL_WARNS(LOG_INV) << "Inventory cache " << filename << " is damaged" << LL_ENDL;
+        mFile.close();
+        return false;
+    }
+
+    mHeader = header;
+    mCategories = reinterpret_cast<const CategoryRecord*>(data + header->mCategoriesOffset);
+    mFolders = folders;
+    mItemIDs = reinterpret_cast<const LLUUID*>(data + header->mItemIDsOffset);
+    mItems = reinterpret_cast<const ItemRecord*>(data + header->mItemsOffset);
+    mStrings = reinterpret_cast<const char*>(data + header->mStringsOffset);
+    return true;
+}
+
+void LLInventoryCacheReader::close()
+{
+    mHeader = nullptr;
+    mCategories = nullptr;
+    mFolders = nullptr;
+    mItemIDs = nullptr;
+    mItems = nullptr;
+    mStrings = nullptr;
+    mFile.close();
+}
+
+S32 LLInventoryCacheReader::getCacheVersion() const
+{
+    return mHeader ? mHeader->mCacheVersion : 0;
+}
+
+U32 LLInventoryCacheReader::getCategoryCount() const
+{
+    return mHeader ? mHeader->mCategoryCount : 0;
+}
+
+void LLInventoryCacheReader::readCategory(U32 index, LLInventoryCategory& cat) const
+{
+    llassert(index < getCategoryCount());
+    const CategoryRecord& record = mCategories[index];
+    cat.setUUID(record.mID);
+    cat.setParent(record.mParentID);
+    cat.setType((LLAssetType::EType)record.mType);
+    cat.setPreferredType((LLFolderType::EType)record.mPreferredType);
+    cat.rename(getString(record.mName));
+    cat.setThumbnailUUID(record.mThumbnailID);
+    cat.setFavorite(record.mFavorite != 0);
+}
+
+const LLUUID& LLInventoryCacheReader::getCategoryOwner(U32 index) const
+{
+    llassert(index < getCategoryCount());
+    return mCategories[index].mOwnerID;
+}
+
+S32 LLInventoryCacheReader::getCategoryVersion(U32 index) const
+{
+    llassert(index < getCategoryCount());
+    return mCategories[index].mVersion;
+}
+
+U32 LLInventoryCacheReader::getFolderCount() const
+{
+    return mHeader ? mHeader->mFolderCount : 0;
+}
+
+const LLUUID& LLInventoryCacheReader::getFolderID(U32 folder) const
+{
+    llassert(folder < getFolderCount());
+    return mFolders[folder].mID;
+}
+
+bool LLInventoryCacheReader::getFolderHasUnknownItems(U32 folder) const
+{
+    llassert(folder < getFolderCount());
+    return (mFolders[folder].mFlags & FOLDER_HAS_UNKNOWN_ITEMS) != 0;
+}
+
+void LLInventoryCacheReader::getFolderItems(U32 folder, U32& first, U32& count) const
+{
+    llassert(folder < getFolderCount());
+    first = mFolders[folder].mFirstItem;
+    count = mFolders[folder].mItemCount;
+}
+
+S32 LLInventoryCacheReader::findFolder(const LLUUID& folder_id) const
+{
+    const FolderRecord* begin = mFolders;
+    const FolderRecord* end = mFolders + getFolderCount();
+    const FolderRecord* found = std::lower_bound(begin, end, folder_id,
+                                                 [](const FolderRecord& record, const LLUUID& id) { return record.mID < id; });
+    if (found == end || found->mID != folder_id)
+    {
+        return -1;
+    }
+    return (S32)(found - begin);
+}
+
+U32 LLInventoryCacheReader::getItemCount() const
+{
+    return mHeader ? mHeader->mItemCount : 0;
+}
+
+const LLUUID& LLInventoryCacheReader::getItemID(U32 index) const
+{
+    llassert(index < getItemCount());
+    return mItemIDs[index];
+}
+
+void LLInventoryCacheReader::readItem(U32 index, LLInventoryItem& item) const
+{
+    llassert(index < getItemCount());
+    const ItemRecord& record = mItems[index];
+
+    LLPermissions perm;
+    perm.init(record.mCreatorID, record.mOwnerID, record.mLastOwnerID, record.mGroupID);
+    perm.setMaskBase(record.mMaskBase);
+    perm.setMaskOwner(record.mMaskOwner);
+    perm.setMaskGroup(record.mMaskGroup);
+    perm.setMaskEveryone(record.mMaskEveryone);
+    perm.setMaskNext(record.mMaskNextOwner);
+
+    item.setUUID(mItemIDs[index]);
+    item.setParent(record.mParentID);
+    item.setType((LLAssetType::EType)record.mType);
+    // before the permissions, which depend on it
+    item.setInventoryType((LLInventoryType::EType)record.mInventoryType);
+    item.setPermissions(perm);
+    item.setAssetUUID(record.mAssetID);
+    item.setThumbnailUUID(record.mThumbnailID);
+    item.setFavorite(record.mFavorite != 0);
+    item.rename(getString(record.mName));
+    item.setDescription(getString(record.mDescription));
+    item.setSaleInfo(LLSaleInfo((LLSaleInfo::EForSale)record.mSaleType, record.mSalePrice));
+    item.setFlags(record.mFlags);
+    item.setCreationDate((time_t)record.mCreationDate);
+}
+
+std::string LLInventoryCacheReader::getString(const StringRef& ref) const
+{
+    if (ref.mOffset > mHeader->mStringsSize || ref.mLength > mHeader->mStringsSize - ref.mOffset)
+    {
+        return std::string();
+    }
+    return std::string(mStrings + ref.mOffset, ref.mLength);
+}
+
+//---------------------------------------------------------------------------
+// LLInventoryCacheWriter
+//---------------------------------------------------------------------------
+
+void LLInventoryCacheWriter::addCategory(const LLInventoryCategory* cat, const LLUUID& owner_id, S32 version)
+{
+    mCategories.push_back({ cat, owner_id, version });
+}
+
+void LLInventoryCacheWriter::addItem(const LLInventoryItem* item)
+{
+    if (item->getUUID().isNull())
+    {
+        return;
+    }
+
+    FolderInfo& folder = mFolders[item->getParentUUID()];
+    if (item->getActualType() == LLAssetType::AT_UNKNOWN)
+    {
+        folder.mHasUnknownItems = true;
+    }
+    else
+    {
+        folder.mItems.push_back(item);
+        ++mItemCount;
+    }
+}
+
+U32 LLInventoryCacheWriter::addString(const std::string& str)
+{
+    auto inserted = mStringOffsets.emplace(str, (U32)mStrings.size());
+    if (inserted.second)
+    {
+        mStrings.append(str);
+    }
+    return inserted.first->second;
+}
+
+bool LLInventoryCacheWriter::save(const std::string& filename, S32 cache_version)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    typedef LLInventoryCacheReader::Header Header;
+    typedef LLInventoryCacheReader::StringRef StringRef;
+    typedef LLInventoryCacheReader::CategoryRecord CategoryRecord;
+    typedef LLInventoryCacheReader::FolderRecord FolderRecord;
+    typedef LLInventoryCacheReader::ItemRecord ItemRecord;
+
+    mStrings.clear();
+    mStringOffsets.clear();
+    auto make_ref = [this](const std::string& str)
+    {
+        StringRef ref = { 0, 0 };
+        if (!str.empty())
+        {
+            ref.mOffset = addString(str);
+            ref.mLength = (U32)str.size();
+        }
+        return ref;
+    };
+
+    std::vector<CategoryRecord> categories(mCategories.size());
+    for (size_t i = 0; i < mCategories.size(); ++i)
+    {
+        const LLInventoryCategory* cat = mCategories[i].mCategory;
+        CategoryRecord& record = categories[i];
+        record.mID = cat->getUUID();
+        record.mParentID = cat->getParentUUID();
+        record.mOwnerID = mCategories[i].mOwnerID;
+        record.mThumbnailID = cat->getThumbnailUUID();
+        record.mName = make_ref(cat->getName());
+        record.mVersion = mCategories[i].mVersion;
+        record.mType = (S16)cat->getActualType();
+        record.mPreferredType = (S16)cat->getPreferredType();
+        record.mFavorite = cat->getIsFavorite() ? 1 : 0;
+    }
+
+    std::vector<std::pair<LLUUID, const FolderInfo*> > sorted_folders;
+    sorted_folders.reserve(mFolders.size());
+    for (const auto& folder : mFolders)
+    {
+        sorted_folders.emplace_back(folder.first, &folder.second);
+    }
+    std::sort(sorted_folders.begin(), sorted_folders.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+    std::vector<FolderRecord> folders(sorted_folders.size());
+    std::vector<LLUUID> item_ids;
+    std::vector<ItemRecord> items(mItemCount);
+    item_ids.reserve(mItemCount);
+    for (size_t i = 0; i < sorted_folders.size(); ++i)
+    {
+        const FolderInfo& info = *sorted_folders[i].second;
+        FolderRecord& folder = folders[i];
+        folder.mID = sorted_folders[i].first;
+        folder.mFirstItem = (U32)item_ids.size();
+        folder.mItemCount = (U32)info.mItems.size();
+        folder.mFlags = info.mHasUnknownItems ? FOLDER_HAS_UNKNOWN_ITEMS : 0;
+
+        for (const LLInventoryItem* item : info.mItems)
+        {
+            ItemRecord& record = items[item_ids.size()];
+            item_ids.push_back(item->getUUID());
+
+            // LLViewerInventoryItem's getters follow links; the cache stores
+            // the item itself, as asLLSD() does, so call the base class.
+            const LLPermissions& perm = item->LLInventoryItem::getPermissions();
+            record.mCreationDate = (S64)item->LLInventoryItem::getCreationDate();
+            record.mParentID = item->getParentUUID();
+            record.mAssetID = item->LLInventoryItem::getAssetUUID();
+            record.mThumbnailID = item->LLInventoryItem::getThumbnailUUID();
+            record.mCreatorID = perm.getCreator();
+            record.mOwnerID = perm.getOwner();
+            record.mLastOwnerID = perm.getLastOwner();
+            record.mGroupID = perm.getGroup();
+            record.mMaskBase = perm.getMaskBase();
+            record.mMaskOwner = perm.getMaskOwner();
+            record.mMaskGroup = perm.getMaskGroup();
+            record.mMaskEveryone = perm.getMaskEveryone();
+            record.mMaskNextOwner = perm.getMaskNextOwner();
+            record.mFlags = item->LLInventoryItem::getFlags();
+            record.mSalePrice = item->LLInventoryItem::getSaleInfo().getSalePrice();
+            record.mName = make_ref(item->LLInventoryItem::getName());
+            record.mDescription = make_ref(item->LLInventoryItem::getDescription());
+            record.mType = (S16)item->getActualType();
+            record.mInventoryType = (S16)item->LLInventoryItem::getInventoryType();
+            record.mSaleType = (U8)item->LLInventoryItem::getSaleInfo().getSaleType();
+            record.mFavorite = item->LLInventoryItem::getIsFavorite() ? 1 : 0;
+        }
+    }
+
+    Header header = {};
+    header.mMagic = CACHE_FILE_MAGIC;
+    header.mFormatVersion = CACHE_FILE_FORMAT_VERSION;
+    header.mCacheVersion = cache_version;
+    header.mCategoryCount = (U32)categories.size();
+    header.mFolderCount = (U32)folders.size();
+    header.mItemCount = (U32)items.size();
+    header.mCategoriesOffset = align_table(sizeof(Header));
+    header.mFoldersOffset = align_table(header.mCategoriesOffset + categories.size() * sizeof(CategoryRecord));
+    header.mItemIDsOffset = align_table(header.mFoldersOffset + folders.size() * sizeof(FolderRecord));
+    header.mItemsOffset = align_table(header.mItemIDsOffset + item_ids.size() * sizeof(LLUUID));
+    header.mStringsOffset = align_table(header.mItemsOffset + items.size() * sizeof(ItemRecord));
+    header.mStringsSize = mStrings.size();
+
+    // Another viewer may be saving the same account's cache; a name of its
+    // own keeps one from writing into or renaming the other's partial file.
+    std::string temp_filename = llformat("%s.%d.tmp", filename.c_str(), LLApp::getPid());
+    LLFILE* file = LLFile::fopen(temp_filename, "wb");
+    if (!file)
+    {
+        LL_WARNS(LOG_INV) << "Unable to create " << temp_filename << LL_ENDL;
+        return false;
+    }
+
+    U64 written = 0;
+    bool success = true;
+    auto write_table = [&](U64 offset, const void* data, size_t size)
+    {
+        static const char PADDING[8] = { 0 };
+        if (success && offset > written)
+        {
+            success = fwrite(PADDING, 1, (size_t)(offset - written), file) == offset - written;
+            written = offset;
+        }
+        if (success && size)
+        {
+            success = fwrite(data, 1, size, file) == size;
+            written += size;
+        }
+    };
+    write_table(0, &header, sizeof(header));
+    write_table(header.mCategoriesOffset, categories.data(), categories.size() * sizeof(CategoryRecord));
+    write_table(header.mFoldersOffset, folders.data(), folders.size() * sizeof(FolderRecord));
+    write_table(header.mItemIDsOffset, item_ids.data(), item_ids.size() * sizeof(LLUUID));
+    write_table(header.mItemsOffset, items.data(), items.size() * sizeof(ItemRecord));
+    write_table(header.mStringsOffset, mStrings.data(), mStrings.size());
+    success = (fclose(file) == 0) && success;
+
+    if (success)
+    {
+        success = LLFile::rename(temp_filename, filename) == 0;
+    }
+    if (!success)
+    {
+        LL_WARNS(LOG_INV) << "Unable to write inventory cache " << filename << LL_ENDL;
+        LLFile::remove(temp_filename, ENOENT);
+        return false;
+    }
+
+    LL_INFOS(LOG_INV) << "Wrote inventory cache " << filename << ": " << header.mCategoryCount << " categories, "
+                          << header.mItemCount << " items in " << header.mFolderCount << " folders, "
+                          << written << " bytes." << LL_ENDL;
+    return true;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file llinventorycachefile.h
+ * @brief Binary, memory mapped inventory cache file.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYCACHEFILE_H
+#define LL_LLINVENTORYCACHEFILE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "llmappedfile.h"
+#include "lluuid.h"
+
+class LLInventoryCategory;
+class LLInventoryItem;
+
+// The inventory cache LLInventoryModel keeps between sessions.
+//
+// The file is a header followed by fixed size tables: categories, folders,
+// item ids and item records, and a string table holding names and
+// descriptions. Items are grouped by parent folder and the folder table is
+// sorted by id, so the items of one folder are a range found by binary
+// search, and nothing is parsed until it is asked for. Records are read in
+// place from a read-only mapping of the file.
+//
+// The file is in native byte order; one written on another architecture is
+// rejected like one from an older format.
+//
+// Records are fixed size and nothing is compressed, so the file is several
+// times larger than the gzipped LLSD cache it replaces: an item takes 192
+// bytes plus its strings, about 50 MB for 250k items.
+class LLInventoryCacheReader
+{
+public:
+    LLInventoryCacheReader();
+
+    // Returns false if the file is missing, truncated or of another format.
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const { return mHeader != nullptr; }
+
+    // The LLInventoryModel cache version the file was saved with
+    S32 getCacheVersion() const;
+
+    U32 getCategoryCount() const;
+    // Fills in cat from category index. The owner and version are kept by
+    // LLViewerInventoryCategory rather than LLInventoryCategory, so they
+    // are read separately.
+    void readCategory(U32 index, LLInventoryCategory& cat) const;
+    const LLUUID& getCategoryOwner(U32 index) const;
+    S32 getCategoryVersion(U32 index) const;
+
+    // Folders that items were saved under, sorted by id
+    U32 getFolderCount() const;
+    const LLUUID& getFolderID(U32 folder) const;
+    // Items of unknown type are not stored; their folders are flagged
+    // instead so the model can refetch them.
+    bool getFolderHasUnknownItems(U32 folder) const;
+    // The items of a folder are item indices [first, first + count).
+    void getFolderItems(U32 folder, U32& first, U32& count) const;
+    // Returns the folder index of folder_id, or -1.
+    S32 findFolder(const LLUUID& folder_id) const;
+
+    U32 getItemCount() const;
+    const LLUUID& getItemID(U32 index) const;
+    void readItem(U32 index, LLInventoryItem& item) const;
+
+private:
+    friend class LLInventoryCacheWriter;    // shares the record layouts
+
+    struct Header;
+    struct StringRef;
+    struct CategoryRecord;
+    struct FolderRecord;
+    struct ItemRecord;
+
+    std::string getString(const StringRef& ref) const;
+
+    LLMappedFile            mFile;
+    const Header*           mHeader;
+    const CategoryRecord*   mCategories;
+    const FolderRecord*     mFolders;
+    const LLUUID*           mItemIDs;
+    const ItemRecord*       mItems;
+    const char*             mStrings;
+};
+
+// Builds an inventory cache file from the model's categories and items.
+// Only pointers are kept, so what was added must outlive save().
+class LLInventoryCacheWriter
+{
+public:
+    void addCategory(const LLInventoryCategory* cat, const LLUUID& owner_id, S32 version);
+    // Items with a null id are skipped.
+    void addItem(const LLInventoryItem* item);
+
+    // Writes everything added so far to a temporary file next to filename,
+    // named after this process, and moves it into place, so a reader never
+    // sees a partial file.
+    bool save(const std::string& filename, S32 cache_version);
+
+private:
+    struct CategoryInfo
+    {
+        const LLInventoryCategory* mCategory;
+        LLUUID mOwnerID;
+        S32 mVersion;
+    };
+
+    struct FolderInfo
+    {
+        std::vector<const LLInventoryItem*> mItems;
+        bool mHasUnknownItems = false;
+    };
+
+    // Appends str to mStrings once, returning where it starts.
+    U32 addString(const std::string& str);
+
+    std::vector<CategoryInfo> mCategories;
+    std::unordered_map<LLUUID, FolderInfo> mFolders;
+    U32 mItemCount = 0;
+
+    std::string mStrings;
+    std::unordered_map<std::string, U32> mStringOffsets;
+};
+
+#endif // LL_LLINVENTORYCACHEFILE_H
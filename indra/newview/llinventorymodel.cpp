@@ -40,6 +40,7 @@
 #include "lldispatcher.h"
 #include "llinventorypanel.h"
 #include "llinventorybridge.h"
+#include "llinventorycachefile.h"
 #include "llinventoryfunctions.h"
 #include "llinventorymodelbackgroundfetch.h"
 #include "llinventoryobserver.h"
@@ -94,6 +95,8 @@ S32 LLInventoryModel::sPendingSystemFolders = 0;
 //bool decompress_file(const char* src_filename, const char* dst_filename);
 static const char PRODUCTION_CACHE_FORMAT_STRING[] = "%s.inv.llsd";
 static const char GRID_CACHE_FORMAT_STRING[] = "%s.%s.inv.llsd";
+static const char PRODUCTION_BINARY_CACHE_FORMAT_STRING[] = "%s.inv.bin";
+static const char GRID_BINARY_CACHE_FORMAT_STRING[] = "%s.%s.inv.bin";
 static const char * const LOG_INV("Inventory");
 
 struct InventoryIDPtrLess
@@ -2344,8 +2347,7 @@ bool LLInventoryModel::fetchDescendentsOf(const LLUUID& folder_id) const
     return cat->fetch();
 }
 
-//static
-std::string LLInventoryModel::getInvCacheAddres(const LLUUID& owner_id)
+static std::string get_inv_cache_address(const LLUUID& owner_id, const char* production_format, const char* grid_format)
 {
     std::string inventory_addr;
     std::string owner_id_str;
@@ -2353,7 +2355,7 @@ std::string LLInventoryModel::getInvCacheAddres(const LLUUID& owner_id)
     std::string path(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, owner_id_str));
     if (LLGridManager::getInstance()->isInProductionGrid())
     {
-        inventory_addr = llformat(PRODUCTION_CACHE_FORMAT_STRING, path.c_str());
+        inventory_addr = llformat(production_format, path.c_str());
     }
     else
     {
@@ -2362,11 +2364,23 @@ std::string LLInventoryModel::getInvCacheAddres(const LLUUID& owner_id)
         // if your viewer uses grid names from an untrusted source.
         const std::string& grid_id_str = LLGridManager::getInstance()->getGridId();
         const std::string& grid_id_lower = utf8str_tolower(grid_id_str);
-        inventory_addr = llformat(GRID_CACHE_FORMAT_STRING, path.c_str(), grid_id_lower.c_str());
+        inventory_addr = llformat(grid_format, path.c_str(), grid_id_lower.c_str());
     }
     return inventory_addr;
 }
 
+//static
+std::string LLInventoryModel::getInvCacheAddres(const LLUUID& owner_id)
+{
+    return get_inv_cache_address(owner_id, PRODUCTION_CACHE_FORMAT_STRING, GRID_CACHE_FORMAT_STRING);
+}
+
+//static
+std::string LLInventoryModel::getInvBinaryCacheAddres(const LLUUID& owner_id)
+{
+    return get_inv_cache_address(owner_id, PRODUCTION_BINARY_CACHE_FORMAT_STRING, GRID_BINARY_CACHE_FORMAT_STRING);
+}
+
 void LLInventoryModel::cache(
     const LLUUID& parent_folder_id,
     const LLUUID& agent_id)
@@ -2387,20 +2401,12 @@ void LLInventoryModel::cache(
         items,
         INCLUDE_TRASH,
         can_cache);
-    // Use temporary file to avoid potential conflicts with other
-    // instances (even a 'read only' instance unzips into a file)
-    std::string temp_file = gDirUtilp->getTempFilename();
-    saveToFile(temp_file, categories, items);
-    std::string gzip_filename = getInvCacheAddres(agent_id);
-    gzip_filename.append(".gz");
-    if(gzip_file(temp_file, gzip_filename))
-    {
-        LL_DEBUGS(LOG_INV) << "Successfully compressed " << temp_file << " to " << gzip_filename << LL_ENDL;
-        LLFile::remove(temp_file);
-    }
-    else
+    if (saveToCacheFile(getInvBinaryCacheAddres(agent_id), categories, items))
     {
-        LL_WARNS(LOG_INV) << "Unable to compress " << temp_file << " into " << gzip_filename << LL_ENDL;
+        // The gzipped LLSD cache of older viewers is superseded
+        std::string gzip_filename = getInvCacheAddres(agent_id);
+        gzip_filename.append(".gz");
+        LLFile::remove(gzip_filename, ENOENT);
     }
 }
 
@@ -2777,42 +2783,60 @@ bool LLInventoryModel::loadSkeleton(
 		const S32 NO_VERSION = LLViewerInventoryCategory::VERSION_UNKNOWN;
 		std::string gzip_filename(inventory_filename);
 		gzip_filename.append(".gz");
-		LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
 		bool remove_inventory_file = false;
-        if (LLAppViewer::instance()->isSecondInstance())
-        {
-            // Safeguard viewer against trying to unpack file twice
-            // ex: user logs into two accounts simultaneously, so two
-            // viewers are trying to unpack library into same file
-            //
-            // Would be better to do it in gunzip_file, but it doesn't
-            // have access to llfilesystem
-            inventory_filename = gDirUtilp->getTempFilename();
-            remove_inventory_file = true;
-        }
-		if(fp)
-		{
-			fclose(fp);
-			fp = NULL;
-
-			temp_text = "GUnzipping [FILE]";
-			temp_text.setArg("[FILE]", llformat("%s", gzip_filename));
+		bool is_cache_obsolete = false;
+		bool cache_loaded = false;
 
-			if(gunzip_file(gzip_filename, inventory_filename))
+		// The binary cache is mapped and read in place, so unlike the
+		// gzipped one it needs no unpacking, even for a second instance.
+		std::string binary_filename = getInvBinaryCacheAddres(owner_id);
+		LLInventoryCacheReader cache_reader;
+		if (LLFile::isfile(binary_filename))
+		{
+			cache_loaded = cache_reader.open(binary_filename)
+				&& loadCategoriesFromCache(cache_reader, categories, categories_to_update);
+			is_cache_obsolete = !cache_loaded;
+		}
+		else
+		{
+			// Cache of an older viewer, converted by the next cache() call
+			LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+			if (LLAppViewer::instance()->isSecondInstance())
 			{
-				// we only want to remove the inventory file if it was
-				// gzipped before we loaded, and we successfully
-				// gunziped it.
+				// Safeguard viewer against trying to unpack file twice
+				// ex: user logs into two accounts simultaneously, so two
+				// viewers are trying to unpack library into same file
+				//
+				// Would be better to do it in gunzip_file, but it doesn't
+				// have access to llfilesystem
+				inventory_filename = gDirUtilp->getTempFilename();
 				remove_inventory_file = true;
 			}
-			else
+			if(fp)
 			{
-				LL_INFOS(LOG_INV) << "Unable to gunzip " << gzip_filename << LL_ENDL;
+				fclose(fp);
+				fp = NULL;
+
+				temp_text = "GUnzipping [FILE]";
+				temp_text.setArg("[FILE]", llformat("%s", gzip_filename));
+
+				if(gunzip_file(gzip_filename, inventory_filename))
+				{
+					// we only want to remove the inventory file if it was
+					// gzipped before we loaded, and we successfully
+					// gunziped it.
+					remove_inventory_file = true;
+				}
+				else
+				{
+					LL_INFOS(LOG_INV) << "Unable to gunzip " << gzip_filename << LL_ENDL;
+				}
 			}
+
+			cache_loaded = loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete);
 		}
 
-		bool is_cache_obsolete = false;
-		if (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+		if (cache_loaded)
 		{
 			// We were able to find a cache of files. So, use what we
 			// found to generate a set of categories we should add. We
@@ -2914,6 +2938,14 @@ bool LLInventoryModel::loadSkeleton(
 				++perc_c;
 			}
 
+			// Only build the items of folders whose cached version is
+			// current, the others would be dropped below anyway.
+			if (cache_reader.isOpen())
+			{
+				loadItemsFromCache(cache_reader, cached_ids, items);
+				cache_reader.close();
+			}
+
 			//BD - Inventory Progress
 			perc_c = 0;
 			temp_text = owner_id == gAgent.getID() ? "Linking Inventory Items to Parents [COUNT] / [MAX]"
@@ -3135,7 +3167,9 @@ bool LLInventoryModel::loadSkeleton(
 
 			// If out of date, remove the gzipped file too.
 			LL_WARNS(LOG_INV) << "Inv cache out of date, removing" << LL_ENDL;
-			LLFile::remove(gzip_filename);
+			cache_reader.close();
+			LLFile::remove(gzip_filename, ENOENT);
+			LLFile::remove(binary_filename, ENOENT);
 		}
 
 		//BD - Inventory Progress
@@ -3592,84 +3626,77 @@ bool LLInventoryModel::loadFromFile(const std::string& filename,
         }
     }
 
-    LLSD inventory;
     if (!is_cache_obsolete)
     {
         LL_PROFILE_ZONE_NAMED("inventory load from file - llsd parse");
-        LLPointer<LLSDParser> parser = new LLSDBinaryParser();
-
-        if (parser->parse(file, inventory, LLSDSerialize::SIZE_UNLIMITED) == LLSDParser::PARSE_FAILURE)
-        {
-            is_cache_obsolete = true;
-            LL_WARNS(LOG_INV) << "Parsing inventory cache failed" << LL_ENDL;
-        }
-    }
-
-    if (!is_cache_obsolete)
-    {
-        {
-            LL_PROFILE_ZONE_NAMED("inventory load from file - categories");
-            const LLSD& llsd_cats = inventory["categories"];
-            if (llsd_cats.isArray())
+        // Build one category or item at a time as the cache is read rather
+        // than the whole inventory as a single LLSD first. Collect into
+        // locals so a parse failure part way leaves the outputs untouched.
+        LLInventoryModel::cat_array_t parsed_categories;
+        LLInventoryModel::item_array_t parsed_items;
+        LLInventoryModel::changed_items_t parsed_cats_to_update;
+        LLSDArrayElementHandler handler([&](const std::string& key, LLSD& element)
+        {
+            if (key == "categories")
             {
-                LLSD::array_const_iterator iter = llsd_cats.beginArray();
-                LLSD::array_const_iterator end  = llsd_cats.endArray();
-                for (; iter != end; ++iter)
+                LLPointer<LLViewerInventoryCategory> inv_cat = new LLViewerInventoryCategory(LLUUID::null);
+                if (inv_cat->importLLSDMap(element))
                 {
-                    LLPointer<LLViewerInventoryCategory> inv_cat = new LLViewerInventoryCategory(LLUUID::null);
-                    if (inv_cat->importLLSDMap(*iter))
-                    {
-                        categories.push_back(inv_cat);
-                    }
+                    parsed_categories.push_back(inv_cat);
                 }
             }
-        }
-
-        {
-            LL_PROFILE_ZONE_NAMED("inventory load from file - items");
-            const LLSD& llsd_items = inventory["items"];
-            if (llsd_items.isArray())
+            else if (key == "items")
             {
-                //BD - Inventory Progress
-                perc = (F32)(perc_c / llsd_items.size());
-                temp_text.setArg("[COUNT]", llformat("%d", perc_c));
-                LLStartUp::setStartupStatus(-0.01f ,perc, meta_text, temp_text);
-
                 LLPointer<LLViewerInventoryItem> inv_item = new LLViewerInventoryItem;
-                LLSD::array_const_iterator iter = llsd_items.beginArray();
-                LLSD::array_const_iterator end  = llsd_items.endArray();
-                for (; iter != end; ++iter)
+                if (inv_item->fromLLSD(element))
                 {
-                    LLPointer<LLViewerInventoryItem> inv_item = new LLViewerInventoryItem;
-                    if (inv_item->fromLLSD(*iter))
+                    if (inv_item->getUUID().isNull())
+                    {
+                        LL_DEBUGS(LOG_INV) << "Ignoring inventory with null item id: " << inv_item->getName() << LL_ENDL;
+                    }
+                    else
                     {
-                        if (inv_item->getUUID().isNull())
+                        if (inv_item->getType() == LLAssetType::AT_UNKNOWN)
                         {
-                            LL_DEBUGS(LOG_INV) << "Ignoring inventory with null item id: " << inv_item->getName() << LL_ENDL;
+                            parsed_cats_to_update.insert(inv_item->getParentUUID());
                         }
                         else
                         {
-                            if (inv_item->getType() == LLAssetType::AT_UNKNOWN)
-                            {
-                                cats_to_update.insert(inv_item->getParentUUID());
-                            }
-                            else
-                            {
-                                items.push_back(inv_item);
-                            }
+                            parsed_items.push_back(inv_item);
                         }
                     }
+                }
 
-                    //      TODO(brad) - figure out how to reenable this without breaking everything else
-                    //      static constexpr U64 BATCH_SIZE = 512U;
-                    //      if ((++lines_count % BATCH_SIZE) == 0)
-                    //      {
-                    //          // SL-19968 - make sure message system code gets a chance to run every so often
-                    //          pump_idle_startup_network();
-                    //      }
+                //BD - Inventory Progress
+                if ((++perc_c % 1000) == 0 && file_size > 0)
+                {
+                    perc = (F32)file.tellg() / (F32)file_size;
+                    temp_text.setArg("[COUNT]", llformat("%d", perc_c));
+                    LLStartUp::setStartupStatus(-0.01f, perc, meta_text, temp_text);
                 }
-                ++perc_c;
+
+                //      TODO(brad) - figure out how to reenable this without breaking everything else
+                //      static constexpr U64 BATCH_SIZE = 512U;
+                //      if ((++lines_count % BATCH_SIZE) == 0)
+                //      {
+                //          // SL-19968 - make sure message system code gets a chance to run every so often
+                //          pump_idle_startup_network();
+                //      }
             }
+            return true;
+        });
+
+        LLPointer<LLSDParser> parser = new LLSDBinaryParser();
+        if (parser->parse(file, handler, LLSDSerialize::SIZE_UNLIMITED) == LLSDParser::PARSE_FAILURE)
+        {
+            is_cache_obsolete = true;
+            LL_WARNS(LOG_INV) << "Parsing inventory cache failed" << LL_ENDL;
+        }
+        else
+        {
+            categories.insert(categories.end(), parsed_categories.begin(), parsed_categories.end());
+            items.insert(items.end(), parsed_items.begin(), parsed_items.end());
+            cats_to_update.insert(parsed_cats_to_update.begin(), parsed_cats_to_update.end());
         }
     }
 
@@ -3679,78 +3706,98 @@ bool LLInventoryModel::loadFromFile(const std::string& filename,
 }
 
 // static
-bool LLInventoryModel::saveToFile(const std::string& filename,
-    const cat_array_t& categories,
-    const item_array_t& items)
+bool LLInventoryModel::loadCategoriesFromCache(const LLInventoryCacheReader& reader,
+                                               LLInventoryModel::cat_array_t& categories,
+                                               LLInventoryModel::changed_items_t& cats_to_update)
 {
-    if (filename.empty())
+    LL_PROFILE_ZONE_SCOPED;
+    if (reader.getCacheVersion() != sCurrentInvCacheVersion)
     {
-        LL_ERRS(LOG_INV) << "Filename is Null!" << LL_ENDL;
+        LL_WARNS(LOG_INV) << "Inventory cache is out of date" << LL_ENDL;
         return false;
     }
 
-    LL_INFOS(LOG_INV) << "saving inventory to: (" << filename << ")" << LL_ENDL;
+    const U32 cat_count = reader.getCategoryCount();
+    categories.reserve(categories.size() + cat_count);
+    for (U32 i = 0; i < cat_count; ++i)
+    {
+        LLPointer<LLViewerInventoryCategory> inv_cat = new LLViewerInventoryCategory(reader.getCategoryOwner(i));
+        reader.readCategory(i, *inv_cat);
+        inv_cat->setVersion(reader.getCategoryVersion(i));
+        categories.push_back(inv_cat);
+    }
 
-    try
+    const U32 folder_count = reader.getFolderCount();
+    for (U32 i = 0; i < folder_count; ++i)
     {
-        llofstream fileSD(filename.c_str(), std::ios_base::out | std::ios_base::binary);
-        if (!fileSD.is_open())
+        if (reader.getFolderHasUnknownItems(i))
         {
-            LL_WARNS(LOG_INV) << "Failed to open file. Unable to save inventory to: " << filename << LL_ENDL;
-            return false;
-        }
-        U32 value_nbo = htonl(sCurrentInvCacheVersion);
-        fileSD.write((const char*)(&value_nbo), sizeof(U32));
-        if (fileSD.fail())
-        {
-            LL_WARNS(LOG_INV) << "Failed to write cache. Unable to save inventory to: " << filename << LL_ENDL;
-            return false;
+            cats_to_update.insert(reader.getFolderID(i));
         }
+    }
+    return true;
+}
 
-        LLSD inventory;
-        inventory["categories"] = LLSD::emptyArray();
-        LLSD& cat_array = inventory["categories"];
-
-        S32 cat_count = 0;
-        for (auto& cat : categories)
+// static
+void LLInventoryModel::loadItemsFromCache(const LLInventoryCacheReader& reader,
+                                          const uuid_set_t& folder_ids,
+                                          LLInventoryModel::item_array_t& items)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    const U32 folder_count = reader.getFolderCount();
+    for (U32 i = 0; i < folder_count; ++i)
+    {
+        if (folder_ids.find(reader.getFolderID(i)) == folder_ids.end())
         {
-            if (cat->getVersion() != LLViewerInventoryCategory::VERSION_UNKNOWN)
-            {
-                LLSD sd;
-                cat->exportLLSD(sd);
-                cat_array.append(sd);
-                cat_count++;
-            }
+            continue;
         }
 
-        inventory["items"] = LLSD::emptyArray();
-        LLSD& item_array = inventory["items"];
-        auto it_count = items.size();
-        for (auto& item : items)
-        {
-            LLSD sd;
-            item->asLLSD(sd);
-            item_array.append(sd);
-        }
-        fileSD << LLSDOStreamer<LLSDBinaryFormatter>(inventory) << std::endl;
-        if (fileSD.fail())
+        U32 first = 0;
+        U32 count = 0;
+        reader.getFolderItems(i, first, count);
+        for (U32 index = first; index < first + count; ++index)
         {
-            LL_WARNS(LOG_INV) << "Failed to write cache. Unable to save inventory to: " << filename << LL_ENDL;
-            return false;
+            LLPointer<LLViewerInventoryItem> inv_item = new LLViewerInventoryItem;
+            reader.readItem(index, *inv_item);
+            items.push_back(inv_item);
         }
-        fileSD.flush();
+    }
+}
+
+// static
+bool LLInventoryModel::saveToCacheFile(const std::string& filename,
+                                       const cat_array_t& categories,
+                                       const item_array_t& items)
+{
+    if (filename.empty())
+    {
+        LL_ERRS(LOG_INV) << "Filename is Null!" << LL_ENDL;
+        return false;
+    }
 
-        fileSD.close();
+    LL_INFOS(LOG_INV) << "saving inventory to: (" << filename << ")" << LL_ENDL;
 
-        LL_INFOS(LOG_INV) << "Inventory saved: " << (S32)cat_count << " categories, " << (S32)it_count << " items." << LL_ENDL;
+    LLInventoryCacheWriter writer;
+    S32 cat_count = 0;
+    for (auto& cat : categories)
+    {
+        if (cat->getVersion() != LLViewerInventoryCategory::VERSION_UNKNOWN)
+        {
+            writer.addCategory(cat, cat->getOwnerID(), cat->getVersion());
+            cat_count++;
+        }
+    }
+    for (auto& item : items)
+    {
+        writer.addItem(item);
     }
-    catch (...)
+    if (!writer.save(filename, sCurrentInvCacheVersion))
     {
-        LOG_UNHANDLED_EXCEPTION("");
-        LL_INFOS(LOG_INV) << "Failed to save inventory to: (" << filename << ")" << LL_ENDL;
+        LL_WARNS(LOG_INV) << "Failed to write cache. Unable to save inventory to: " << filename << LL_ENDL;
         return false;
     }
 
+    LL_INFOS(LOG_INV) << "Inventory saved: " << cat_count << " categories, " << (S32)items.size() << " items." << LL_ENDL;
     return true;
 }
 
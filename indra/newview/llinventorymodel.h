@@ -53,6 +53,7 @@ class LLInventoryItem;
 class LLInventoryCategory;
 class LLMessageSystem;
 class LLInventoryCollectFunctor;
+class LLInventoryCacheReader;
 
 ///----------------------------------------------------------------------------
 /// LLInventoryValidationInfo
@@ -192,6 +193,8 @@ public:
     void createCommonSystemCategories();
 
     static std::string getInvCacheAddres(const LLUUID& owner_id);
+    // The binary cache that replaced the gzipped LLSD one above
+    static std::string getInvBinaryCacheAddres(const LLUUID& owner_id);
 
     // Call on logout to save a terse representation.
     void cache(const LLUUID& parent_folder_id, const LLUUID& agent_id);
@@ -671,9 +674,19 @@ protected:
                              item_array_t& items,
                              changed_items_t& cats_to_update,
                              bool& is_cache_obsolete);
-    static bool saveToFile(const std::string& filename,
-                           const cat_array_t& categories,
-                           const item_array_t& items);
+    // Reads the categories of a binary cache, and the folders to refetch
+    // because they held items of an unknown type. Returns false if the
+    // cache is of another version.
+    static bool loadCategoriesFromCache(const LLInventoryCacheReader& reader,
+                                        cat_array_t& categories,
+                                        changed_items_t& cats_to_update);
+    // Reads the items of the given folders only.
+    static void loadItemsFromCache(const LLInventoryCacheReader& reader,
+                                   const uuid_set_t& folder_ids,
+                                   item_array_t& items);
+    static bool saveToCacheFile(const std::string& filename,
+                                const cat_array_t& categories,
+                                const item_array_t& items);
 
     //--------------------------------------------------------------------
     // Message handling functionality
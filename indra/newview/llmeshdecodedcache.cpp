@@ -0,0 +1,147 @@
+/**
+ * @file llmeshdecodedcache.cpp
+ * @brief Persistent cache of decoded mesh LODs
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llmeshdecodedcache.h"
+
+#include "lldiskcache.h"
+#include "llfilesystem.h"
+#include "llmappedfile.h"
+#include "llvolume.h"
+
+namespace
+{
+    // Precedes the LLVolume::packDecodedFaces() image in each entry.
+    struct EntryHeader
+    {
+        S32 mLodSize;
+        F32 mDecodeMs;
+        U32 mPad[2];
+    };
+}
+
+// static
+LLUUID LLMeshDecodedCache::getKey(const LLVolumeParams& params, S32 lod)
+{
+    LLUUID key;
+    key.generate(llformat("%s:decoded:%d:%u:%u",
+                          params.getSculptID().asString().c_str(),
+                          lod,
+                          (U32)params.getSculptType(),
+                          LLVolume::DECODED_FACES_VERSION));
+    return key;
+}
+
+// static
+bool LLMeshDecodedCache::exists(const LLVolumeParams& params, S32 lod)
+{
+    return LLFileSystem::getExists(getKey(params, lod), LLAssetType::AT_MESH);
+}
+
+// static
+bool LLMeshDecodedCache::load(const LLVolumeParams& params, S32 lod, S32 lod_size, LLVolume* volume, F32& decode_ms)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    const LLUUID key = getKey(params, lod);
+
+    // opening for read refreshes the entry's access time for the purge
+    LLFileSystem file(key, LLAssetType::AT_MESH, LLFileSystem::READ);
+
+    LLMappedFile mapping;
+    if (!mapping.open(LLDiskCache::metaDataToFilepath(key, LLAssetType::AT_MESH))
+        || mapping.getSize() < sizeof(EntryHeader))
+    {
+        return false;
+    }
+
+    EntryHeader header;
+    memcpy(&header, mapping.getData(), sizeof(header));
+    if (header.mLodSize != lod_size)
+    {
+        // the asset changed under the same id, or a different header is
+        // being used for it
+        return false;
+    }
+
+    if (!volume->unpackDecodedFaces(mapping.getData() + sizeof(header), mapping.getSize() - sizeof(header)))
+    {
+        LL_WARNS("MeshDecodedCache") << "Discarding damaged decoded entry for mesh " << params.getSculptID()
+                                     << " LOD " << lod << LL_ENDL;
+        return false;
+    }
+
+    decode_ms = header.mDecodeMs;
+    return true;
+}
+
+// static
+void LLMeshDecodedCache::store(const LLVolumeParams& params, S32 lod, S32 lod_size, const LLVolume* volume, F32 decode_ms)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    const LLUUID key = getKey(params, lod);
+    if (LLFileSystem::getExists(key, LLAssetType::AT_MESH))
+    {
+        // stale entries are removed when they fail to load, so whatever is
+        // here is current (and may be mapped by another thread right now)
+        return;
+    }
+
+    EntryHeader header = { lod_size, decode_ms, { 0, 0 } };
+
+    std::vector<U8> buffer(sizeof(header));
+    memcpy(buffer.data(), &header, sizeof(header));
+    if (!volume->packDecodedFaces(buffer))
+    {
+        return;
+    }
+
+    // Write under a scratch id and rename into place so a reader never maps
+    // a partially written entry.
+    LLUUID scratch;
+    scratch.generate();
+    {
+        LLFileSystem file(scratch, LLAssetType::AT_MESH, LLFileSystem::WRITE);
+        if (!file.write(buffer.data(), (S32)buffer.size()))
+        {
+            return;
+        }
+    }
+    LLFileSystem::renameFile(scratch, LLAssetType::AT_MESH, key, LLAssetType::AT_MESH);
+    if (LLFileSystem::getExists(scratch, LLAssetType::AT_MESH))
+    {
+        // lost a race with another writer for the same entry
+        LLFileSystem::removeFile(scratch, LLAssetType::AT_MESH);
+    }
+}
+
+// static
+void LLMeshDecodedCache::remove(const LLVolumeParams& params, S32 lod)
+{
+    LLFileSystem::removeFile(getKey(params, lod), LLAssetType::AT_MESH);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file llmeshdecodedcache.h
+ * @brief Persistent cache of decoded mesh LODs
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESHDECODEDCACHE_H
+#define LL_LLMESHDECODEDCACHE_H
+
+#include "lluuid.h"
+
+class LLVolume;
+class LLVolumeParams;
+
+// Keeps mesh LODs in the disk cache in the form unpackVolumeFaces() leaves
+// them (dequantized, cache optimized, with tangents), so a mesh seen in an
+// earlier session skips inflating, LLSD parsing and optimization and is
+// copied straight out of a memory mapping instead.
+//
+// Entries share the disk cache's size limit and purge policy with the
+// compressed mesh assets.  The key covers the mesh id, LOD, the sculpt flags
+// that change the decoded geometry and LLVolume::DECODED_FACES_VERSION, so a
+// format change simply misses.  Safe to call from any thread.
+class LLMeshDecodedCache
+{
+public:
+    static bool exists(const LLVolumeParams& params, S32 lod);
+
+    // Fills volume from the cached entry.  lod_size is the size of the
+    // compressed LOD block the entry must have been built from; decode_ms
+    // receives how long that original decode took.  Returns false on a
+    // missing, stale or damaged entry.
+    static bool load(const LLVolumeParams& params, S32 lod, S32 lod_size, LLVolume* volume, F32& decode_ms);
+
+    static void store(const LLVolumeParams& params, S32 lod, S32 lod_size, const LLVolume* volume, F32 decode_ms);
+
+    static void remove(const LLVolumeParams& params, S32 lod);
+
+private:
+    static LLUUID getKey(const LLVolumeParams& params, S32 lod);
+};
+
+#endif // LL_LLMESHDECODEDCACHE_H
@@ -44,11 +44,13 @@
 #include "llimagej2c.h"
 #include "llhost.h"
 #include "llmath.h"
+#include "llmeshdecodedcache.h"
 #include "llnotificationsutil.h"
 #include "llsd.h"
 #include "llsdutil_math.h"
 #include "llsdserialize.h"
 #include "llthread.h"
+#include "threadpool.h"
 #include "llfilesystem.h"
 #include "llviewercontrol.h"
 #include "llviewerinventory.h"
@@ -398,6 +400,9 @@ U32 LLMeshRepository::sCacheBytesSkins = 0;
 U32 LLMeshRepository::sCacheBytesDecomps = 0;
 U32 LLMeshRepository::sCacheReads = 0;
 std::atomic<U32> LLMeshRepository::sCacheWrites = 0;
+std::atomic<U32> LLMeshRepository::sDecodedCacheHits = 0;
+std::atomic<U32> LLMeshRepository::sDecodedCacheMisses = 0;
+std::atomic<U64> LLMeshRepository::sDecodedCacheUsecSaved = 0;
 U32 LLMeshRepository::sMaxLockHoldoffs = 0;
 
 LLDeadmanTimer LLMeshRepository::sQuiescentTimer(15.0, false);  // true -> gather cpu metrics
@@ -954,6 +959,8 @@ LLMeshRepoThread::LLMeshRepoThread()
     // and a need to do expensive cacheOptimize().
     mMeshThreadPool = std::make_unique<LL::ThreadPool>("MeshLodProcessing", 2);
     mMeshThreadPool->start();
+
+    mUseDecodedCache = gSavedSettings.getBOOL("MeshDecodedCache");
 }
 
 
@@ -2037,6 +2044,39 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
 
         if (version <= MAX_MESH_VERSION && offset >= 0 && size > 0)
         {
+            if (mUseDecodedCache && LLMeshDecodedCache::exists(mesh_params, lod))
+            {
+                const LLVolumeParams params(mesh_params);
+                bool posted = mMeshThreadPool->getQueue().post(
+                    [params, mesh_id, lod, size]
+                    ()
+                {
+                    if (gMeshRepo.mThread->isShuttingDown())
+                    {
+                        return;
+                    }
+                    if (gMeshRepo.mThread->decodedLodReceived(params, lod, size) == MESH_OK)
+                    {
+                        LL_DEBUGS(LOG_MESH) << "Mesh/Cache: Mesh body for ID " << mesh_id << " - was restored from the decoded cache." << LL_ENDL;
+                    }
+                    else
+                    {
+                        // stale or damaged, drop it and take the regular path
+                        LLMeshDecodedCache::remove(params, lod);
+
+                        LLMutexLock lock(gMeshRepo.mThread->mMutex);
+                        LODRequest req(params, lod);
+                        gMeshRepo.mThread->mLODReqQ.push(req);
+                        LLMeshRepository::sLODProcessing++;
+                    }
+                });
+
+                if (posted)
+                {
+                    return true;
+                }
+            }
+
             S32 disk_ofset = offset + CACHE_PREAMBLE_SIZE;
             //check cache for mesh asset
             LLFileSystem file(mesh_id, LLAssetType::AT_MESH);
@@ -2217,9 +2257,8 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
 
         data_size = (S32)dsize;
 
-        boost::iostreams::stream<boost::iostreams::array_source> stream(result_ptr, data_size);
-
-        if (!LLSDSerialize::fromBinary(header_data, stream, data_size))
+        size_t header_bytes = 0;
+        if (!LLSDSerialize::fromBinary(header_data, (const U8*)result_ptr, data_size, -1, &header_bytes))
         {
             LL_WARNS(LOG_MESH) << "Mesh header parse error.  Not a valid mesh asset!  ID:  " << mesh_id
                                << LL_ENDL;
@@ -2242,7 +2281,7 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
         // make sure there is at least one lod, function returns -1 and marks as 404 otherwise
         else if (LLMeshRepository::getActualMeshLOD(header, 0) >= 0)
         {
-            header.mHeaderSize = (S32)stream.tellg();
+            header.mHeaderSize = (S32)header_bytes;
             header_size += header.mHeaderSize;
             skin_offset = header.mSkinOffset;
             skin_size = header.mSkinSize;
@@ -2382,59 +2421,96 @@ EMeshProcessingResult LLMeshRepoThread::lodReceived(const LLVolumeParams& mesh_p
     }
 
     LLPointer<LLVolume> volume = new LLVolume(mesh_params, LLVolumeLODGroup::getVolumeScaleFromDetail(lod));
-    if (volume->unpackVolumeFaces(data, data_size))
-    {
-        // Use LLVolume::getNumVolumeFaces() here and not LLVolume::getNumFaces(),
-        // because setMeshAssetLoaded() has not yet been called for this volume
-        // (it is set later in LLMeshRepository::notifyMeshLoaded()), and
-        // getNumFaces() would return the number of faces in the LLProfile
-        // instead. HB
-        S32 num_faces = volume->getNumVolumeFaces();
-        if (num_faces > 0)
-        {
-            // if we have a valid SkinInfo, cache per-joint bounding boxes for this LOD
-            LLPointer<LLMeshSkinInfo> skin_info = nullptr;
-            {
-                LLMutexLock lock(mSkinMapMutex);
-                skin_map::iterator iter = mSkinMap.find(mesh_params.getSculptID());
-                if (iter != mSkinMap.end())
-                {
-                    skin_info = iter->second;
-                }
-            }
-            if (skin_info.notNull() && isAgentAvatarValid())
-            {
-                for (S32 i = 0; i < num_faces; ++i)
-                {
-                    // NOTE: no need to lock gAgentAvatarp as the state being checked is not changed after initialization
-                    LLVolumeFace& face = volume->getVolumeFace(i);
-                    LLSkinningUtil::updateRiggingInfo(skin_info, gAgentAvatarp, face);
-                }
-            }
-
-            LoadedMesh mesh(volume, mesh_params, lod);
-            {
-                LLMutexLock lock(mLoadedMutex);
-                mLoadedQ.push_back(mesh);
-                // LLPointer is not thread safe, since we added this pointer into
-                // threaded list, make sure counter gets decreased inside mutex lock
-                // and won't affect mLoadedQ processing
-                volume = NULL;
-                // might be good idea to turn mesh into pointer to avoid making a copy
-                mesh.mVolume = NULL;
-            }
-            {
-                // make sure skin info is not removed from list while we are decreasing reference count
-                LLMutexLock lock(mSkinMapMutex);
-                skin_info = nullptr;
-            }
-            return MESH_OK;
+    LLTimer decode_timer;
+    // Fan per-face cache optimization and tangent generation out across the
+    // mesh pool; this joins before returning, so the volume is complete
+    // before it is published below.
+    if (volume->unpackVolumeFaces(data, data_size, mMeshThreadPool.get()))
+    {
+        if (mUseDecodedCache && volume->getNumVolumeFaces() > 0)
+        {
+            ++LLMeshRepository::sDecodedCacheMisses;
+            LLMeshDecodedCache::store(mesh_params, lod, data_size, volume, decode_timer.getElapsedTimeF32() * 1000.f);
         }
+        return publishLOD(volume, mesh_params, lod);
     }
 
     return MESH_UNKNOWN;
 }
 
+EMeshProcessingResult LLMeshRepoThread::decodedLodReceived(const LLVolumeParams& mesh_params, S32 lod, S32 data_size)
+{
+    LLPointer<LLVolume> volume = new LLVolume(mesh_params, LLVolumeLODGroup::getVolumeScaleFromDetail(lod));
+    LLTimer load_timer;
+    F32 decode_ms = 0.f;
+    if (!LLMeshDecodedCache::load(mesh_params, lod, data_size, volume, decode_ms))
+    {
+        return MESH_UNKNOWN;
+    }
+
+    const F32 saved_ms = decode_ms - load_timer.getElapsedTimeF32() * 1000.f;
+    ++LLMeshRepository::sDecodedCacheHits;
+    if (saved_ms > 0.f)
+    {
+        LLMeshRepository::sDecodedCacheUsecSaved += (U64)(saved_ms * 1000.f);
+    }
+
+    return publishLOD(volume, mesh_params, lod);
+}
+
+EMeshProcessingResult LLMeshRepoThread::publishLOD(LLPointer<LLVolume>& volume, const LLVolumeParams& mesh_params, S32 lod)
+{
+    // Use LLVolume::getNumVolumeFaces() here and not LLVolume::getNumFaces(),
+    // because setMeshAssetLoaded() has not yet been called for this volume
+    // (it is set later in LLMeshRepository::notifyMeshLoaded()), and
+    // getNumFaces() would return the number of faces in the LLProfile
+    // instead. HB
+    S32 num_faces = volume->getNumVolumeFaces();
+    if (num_faces <= 0)
+    {
+        volume = NULL;
+        return MESH_UNKNOWN;
+    }
+
+    // if we have a valid SkinInfo, cache per-joint bounding boxes for this LOD
+    LLPointer<LLMeshSkinInfo> skin_info = nullptr;
+    {
+        LLMutexLock lock(mSkinMapMutex);
+        skin_map::iterator iter = mSkinMap.find(mesh_params.getSculptID());
+        if (iter != mSkinMap.end())
+        {
+            skin_info = iter->second;
+        }
+    }
+    if (skin_info.notNull() && isAgentAvatarValid())
+    {
+        for (S32 i = 0; i < num_faces; ++i)
+        {
+            // NOTE: no need to lock gAgentAvatarp as the state being checked is not changed after initialization
+            LLVolumeFace& face = volume->getVolumeFace(i);
+            LLSkinningUtil::updateRiggingInfo(skin_info, gAgentAvatarp, face);
+        }
+    }
+
+    LoadedMesh mesh(volume, mesh_params, lod);
+    {
+        LLMutexLock lock(mLoadedMutex);
+        mLoadedQ.push_back(mesh);
+        // LLPointer is not thread safe, since we added this pointer into
+        // threaded list, make sure counter gets decreased inside mutex lock
+        // and won't affect mLoadedQ processing
+        volume = NULL;
+        // might be good idea to turn mesh into pointer to avoid making a copy
+        mesh.mVolume = NULL;
+    }
+    {
+        // make sure skin info is not removed from list while we are decreasing reference count
+        LLMutexLock lock(mSkinMapMutex);
+        skin_info = nullptr;
+    }
+    return MESH_OK;
+}
+
 bool LLMeshRepoThread::skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 data_size)
 {
     LL_PROFILE_ZONE_SCOPED;
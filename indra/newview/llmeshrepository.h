@@ -549,6 +549,8 @@ public:
     LL::WorkQueue mWorkQueue;
     // lods have their own thread due to costly cacheOptimize() calls
     std::unique_ptr<LL::ThreadPool> mMeshThreadPool;
+    // MeshDecodedCache, sampled once so worker threads need not touch settings
+    bool mUseDecodedCache;
 
     // llcorehttp library interface objects.
     LLCore::HttpStatus                  mHttpStatus;
@@ -578,6 +580,12 @@ public:
     bool fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod);
     EMeshProcessingResult headerReceived(const LLVolumeParams& mesh_params, U8* data, S32 data_size, U32 flags = 0);
     EMeshProcessingResult lodReceived(const LLVolumeParams& mesh_params, S32 lod, U8* data, S32 data_size);
+    // Like lodReceived(), but restores the LOD from LLMeshDecodedCache;
+    // data_size is the size of the compressed LOD block from the header.
+    EMeshProcessingResult decodedLodReceived(const LLVolumeParams& mesh_params, S32 lod, S32 data_size);
+    // Attaches rigging info and queues a fully unpacked volume for the main
+    // thread.  Clears volume.
+    EMeshProcessingResult publishLOD(LLPointer<LLVolume>& volume, const LLVolumeParams& mesh_params, S32 lod);
     bool skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
     bool decompositionReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
     EMeshProcessingResult physicsShapeReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
@@ -847,6 +855,9 @@ public:
     static U32 sCacheBytesDecomps;
     static U32 sCacheReads;
     static std::atomic<U32> sCacheWrites;
+    static std::atomic<U32> sDecodedCacheHits;
+    static std::atomic<U32> sDecodedCacheMisses;
+    static std::atomic<U64> sDecodedCacheUsecSaved; // decode time avoided by hits, net of the load itself
     static U32 sMaxLockHoldoffs;                // Maximum sequential locking failures
 
     static LLDeadmanTimer sQuiescentTimer;      // Time-to-complete-mesh-downloads after significant events
@@ -0,0 +1,185 @@
+/**
+ * @file llpackedskinweights.cpp
+ * @brief Skin weights of a rigged face prepared for CPU skinning
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llpackedskinweights.h"
+
+#include "llmath.h"
+#include "threadpool.h"
+
+#include <thread>
+
+namespace
+{
+    // vertices skinned by one pool task
+    constexpr U32 SKIN_BLOCK_SIZE = 4096;
+    // below this many vertices handing out the work costs more than it saves
+    constexpr U32 PARALLEL_MIN_VERTICES = 16384;
+
+    // same steps as LLMatrix4a::affineTransformSSE()
+    LL_FORCE_INLINE LLQuad transform(const LLMatrix4a& m, const LLQuad& x, const LLQuad& y, const LLQuad& z)
+    {
+        LLQuad xy = _mm_add_ps(_mm_mul_ps(x, m.mMatrix[0]), _mm_mul_ps(y, m.mMatrix[1]));
+        return _mm_add_ps(xy, _mm_add_ps(_mm_mul_ps(z, m.mMatrix[2]), m.mMatrix[3]));
+    }
+}
+
+LLPackedSkinWeights::LLPackedSkinWeights()
+:   mSource(0),
+    mNumJoints(0)
+{
+}
+
+void LLPackedSkinWeights::clear()
+{
+    mWeights.clear();
+    mJointIndices.clear();
+    mSource = 0;
+    mNumJoints = 0;
+}
+
+void LLPackedSkinWeights::pack(const LLVector4a* weights, U32 num_vertices, U32 num_joints, U64 source)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+
+    mWeights.resize(num_vertices);
+    mJointIndices.resize(num_vertices * 4);
+    mSource = source;
+    mNumJoints = num_joints;
+
+    const S32 max_index = (S32)llmax(num_joints, 1U) - 1;
+    for (U32 i = 0; i < num_vertices; ++i)
+    {
+        const F32* w = weights[i].getF32ptr();
+        F32 wght[4];
+        F32 scale = 0.f;
+        for (U32 k = 0; k < 4; ++k)
+        {
+            F32 joint = floorf(w[k]);
+            mJointIndices[i * 4 + k] = (U8)llclamp((S32)joint, 0, max_index);
+            wght[k] = w[k] - joint;
+            scale += wght[k];
+        }
+
+        if (scale > 0.f)
+        {
+            F32 inv_scale = 1.f / scale;
+            mWeights[i].set(wght[0] * inv_scale, wght[1] * inv_scale, wght[2] * inv_scale, wght[3] * inv_scale);
+        }
+        else
+        {
+            // checkSkinWeights() should have caught this; follow the first
+            // joint rather than collapsing the vertex
+            mWeights[i].set(1.f, 0.f, 0.f, 0.f);
+        }
+    }
+}
+
+// static
+void LLPackedSkinWeights::preparePalette(const LLMatrix4a* joint_mats, U32 count, const LLMatrix4a& bind_shape, LLMatrix4a* palette)
+{
+    for (U32 i = 0; i < count; ++i)
+    {
+        matMulUnsafe(bind_shape, joint_mats[i], palette[i]);
+    }
+}
+
+void LLPackedSkinWeights::skin(const LLMatrix4a* palette, const LLVector4a* src, LLVector4a* dst,
+                               LLVector4a& min, LLVector4a& max, LL::ThreadPoolBase* pool) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    static const bool multi_core = std::thread::hardware_concurrency() > 1;
+
+    const U32 num_vertices = getNumVertices();
+    if (!num_vertices)
+    {
+        min.clear();
+        max.clear();
+        return;
+    }
+
+    if (!pool || !multi_core || num_vertices < PARALLEL_MIN_VERTICES)
+    {
+        skinRange(palette, src, dst, 0, num_vertices, min, max);
+        return;
+    }
+
+    const U32 num_blocks = (num_vertices + SKIN_BLOCK_SIZE - 1) / SKIN_BLOCK_SIZE;
+    std::vector<LLVector4a> block_bounds(num_blocks * 2);
+    pool->forkJoin(num_blocks, [&](size_t block)
+                   {
+                       const U32 begin = (U32)block * SKIN_BLOCK_SIZE;
+                       const U32 end = llmin(begin + SKIN_BLOCK_SIZE, num_vertices);
+                       skinRange(palette, src, dst, begin, end, block_bounds[block * 2], block_bounds[block * 2 + 1]);
+                   });
+
+    min = block_bounds[0];
+    max = block_bounds[1];
+    for (U32 block = 1; block < num_blocks; ++block)
+    {
+        min.setMin(min, block_bounds[block * 2]);
+        max.setMax(max, block_bounds[block * 2 + 1]);
+    }
+}
+
+// Blends the position transformed by each of the four joints, which is the
+// position transformed by the blended matrix of getPerVertexSkinMatrix()
+// with fewer operations.
+void LLPackedSkinWeights::skinRange(const LLMatrix4a* palette, const LLVector4a* src, LLVector4a* dst, U32 begin, U32 end,
+                                    LLVector4a& min, LLVector4a& max) const
+{
+    const LLVector4a* weights = mWeights.data();
+    const U8* joints = mJointIndices.data();
+
+    LLQuad bounds_min = _mm_set1_ps(F32_MAX);
+    LLQuad bounds_max = _mm_set1_ps(-F32_MAX);
+
+    for (U32 i = begin; i < end; ++i)
+    {
+        const LLQuad v = src[i];
+        const LLQuad x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+        const LLQuad y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+        const LLQuad z = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+
+        const LLQuad w = weights[i];
+        const U8* idx = joints + i * 4;
+
+        LLQuad p0 = _mm_mul_ps(transform(palette[idx[0]], x, y, z), _mm_shuffle_ps(w, w, _MM_SHUFFLE(0, 0, 0, 0)));
+        LLQuad p1 = _mm_mul_ps(transform(palette[idx[1]], x, y, z), _mm_shuffle_ps(w, w, _MM_SHUFFLE(1, 1, 1, 1)));
+        LLQuad p2 = _mm_mul_ps(transform(palette[idx[2]], x, y, z), _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 2, 2)));
+        LLQuad p3 = _mm_mul_ps(transform(palette[idx[3]], x, y, z), _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 3, 3)));
+
+        LLQuad res = _mm_add_ps(_mm_add_ps(p0, p1), _mm_add_ps(p2, p3));
+        dst[i] = res;
+
+        bounds_min = _mm_min_ps(bounds_min, res);
+        bounds_max = _mm_max_ps(bounds_max, res);
+    }
+
+    min = bounds_min;
+    max = bounds_max;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file llpackedskinweights.h
+ * @brief Skin weights of a rigged face prepared for CPU skinning
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPACKEDSKINWEIGHTS_H
+#define LL_LLPACKEDSKINWEIGHTS_H
+
+#include "llvector4a.h"
+#include "llmatrix4a.h"
+
+#include <vector>
+
+namespace LL
+{
+    class ThreadPoolBase;
+}
+
+// The skin weights of one face, decoded once from the <joint>.<weight>
+// format of LLVolumeFace::mWeights into normalized weights and clamped
+// joint indices, so that skinning a pose is only the blend and transform
+// LLSkinningUtil::getPerVertexSkinMatrix() does after its per vertex
+// decoding.
+//
+// skin() transforms positions by a palette that already has the bind
+// shape matrix folded in (see preparePalette()), a block of vertices at a
+// time, and returns their bounds.
+class LLPackedSkinWeights
+{
+public:
+    LLPackedSkinWeights();
+
+    // Decodes num_vertices weights. Joint indices are clamped below
+    // num_joints, as getPerVertexSkinMatrix() clamps them below max_joints.
+    // source identifies the weights, see LLVolumeFace::mWeightsSerial.
+    void pack(const LLVector4a* weights, U32 num_vertices, U32 num_joints, U64 source);
+    void clear();
+
+    // Whether pack() was last called with these arguments. A pointer would
+    // not do: freed weights may be reallocated at the same address.
+    bool isPackedFrom(U64 source, U32 num_vertices, U32 num_joints) const
+    {
+        return mSource == source && getNumVertices() == num_vertices && mNumJoints == num_joints;
+    }
+
+    U32 getNumVertices() const { return (U32)mWeights.size(); }
+
+    // palette[i] = bind_shape * joint_mats[i], so that one transform by
+    // the palette does what bind_shape then joint_mats[i] do.
+    static void preparePalette(const LLMatrix4a* joint_mats, U32 count, const LLMatrix4a& bind_shape, LLMatrix4a* palette);
+
+    // Skins every vertex of src into dst and sets min and max to their
+    // bounds. Large faces are split across pool, if given, with the calling
+    // thread taking part.
+    void skin(const LLMatrix4a* palette, const LLVector4a* src, LLVector4a* dst,
+              LLVector4a& min, LLVector4a& max, LL::ThreadPoolBase* pool = nullptr) const;
+
+private:
+    void skinRange(const LLMatrix4a* palette, const LLVector4a* src, LLVector4a* dst, U32 begin, U32 end,
+                   LLVector4a& min, LLVector4a& max) const;
+
+    std::vector<LLVector4a> mWeights;  // normalized, one lane per influence
+    std::vector<U8> mJointIndices;     // four per vertex
+    U64 mSource;
+    U32 mNumJoints;
+};
+
+#endif // LL_LLPACKEDSKINWEIGHTS_H
@@ -732,6 +732,11 @@ bool idle_startup()
 
             F32 dropPercent = gSavedSettings.getF32("PacketDropPercentage");
             msg->mPacketRing.setDropPercentage(dropPercent);
+
+            if (gSavedSettings.getBOOL("UDPReceiveThread"))
+            {
+                msg->startReceiveThread();
+            }
         }
 
 		LL_INFOS("AppInit") << "Message System Initialized." << LL_ENDL;
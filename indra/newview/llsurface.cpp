@@ -45,6 +45,8 @@
 #include "llviewerregion.h"
 #include "lldrawpoolterrain.h"
 #include "llworldmipmap.h"
+#include "llappviewer.h"
+#include "threadpool.h"
 
 extern LLPipeline gPipeline;
 extern bool gShiftFrame;
@@ -52,6 +54,8 @@ extern bool gShiftFrame;
 namespace
 {
     static constexpr float MIN_TEXTURE_REQUEST_INTERVAL = 5.0f;
+    // fewer dirty patches than this aren't worth the thread pool
+    static constexpr size_t MIN_PARALLEL_NORMAL_PATCHES = 16;
 }
 
 LLColor4U MAX_WATER_COLOR(0, 48, 96, 240);
@@ -597,6 +601,57 @@ void LLSurface::updatePatchVisibilities(LLAgent &agent)
     }
 }
 
+template<bool PBR>
+void LLSurface::updatePatchNormals()
+{
+    LL_PROFILE_ZONE_SCOPED;
+    static LLCachedControl<bool> parallel_update(gSavedSettings, "TerrainParallelUpdate", true);
+    LL::ThreadPool *pool = parallel_update ? LLAppViewer::instance()->getGeneralThreadPool() : nullptr;
+    if (!pool || mDirtyPatchList.size() < MIN_PARALLEL_NORMAL_PATCHES)
+    {
+        for (LLSurfacePatch *patchp : mDirtyPatchList)
+        {
+            if (patchp->updateNormals<PBR>())
+            {
+                dirtySurfacePatch(patchp);
+            }
+        }
+        return;
+    }
+
+    // A patch writes only grid points of its own: normals, and the height of
+    // its northeast corner when no patch of this surface supplies it. Its
+    // edges and that corner are shared with its neighbors, and calcNormal()
+    // reads up to two grids past them. Patches of one color of a 2x2
+    // checkerboard are a whole patch apart, so none reads or writes what
+    // another writes, and each color is done in parallel, one color after
+    // another. Other surfaces are only read; they update on this thread.
+    std::vector<LLSurfacePatch *> colors[4];
+    for (LLSurfacePatch *patchp : mDirtyPatchList)
+    {
+        const S32 index = (S32)(patchp - mPatchList);
+        llassert(index >= 0 && index < mNumberOfPatches);
+        const S32 i = index % mPatchesPerEdge;
+        const S32 j = index / mPatchesPerEdge;
+        colors[(i & 1) | ((j & 1) << 1)].push_back(patchp);
+    }
+    for (const std::vector<LLSurfacePatch *> &patches : colors)
+    {
+        std::vector<U8> updated(patches.size());
+        pool->forkJoin(patches.size(), [&patches, &updated](size_t n)
+            {
+                updated[n] = patches[n]->updateNormals<PBR>();
+            });
+        for (size_t n = 0; n < patches.size(); ++n)
+        {
+            if (updated[n])
+            {
+                dirtySurfacePatch(patches[n]);
+            }
+        }
+    }
+}
+
 template<bool PBR>
 bool LLSurface::idleUpdate(F32 max_update_time)
 {
@@ -619,21 +674,26 @@ bool LLSurface::idleUpdate(F32 max_update_time)
 
     // Always call updateNormals() / updateVerticalStats()
     //  every frame to avoid artifacts
+    updatePatchNormals<PBR>();
+    for (LLSurfacePatch *patchp : mDirtyPatchList)
+    {
+        patchp->updateVerticalStats();
+    }
+
     for(std::set<LLSurfacePatch *>::iterator iter = mDirtyPatchList.begin();
         iter != mDirtyPatchList.end(); )
     {
+        if (max_update_time != 0.f && update_timer.getElapsedTimeF32() >= max_update_time)
+        {
+            break;
+        }
         std::set<LLSurfacePatch *>::iterator curiter = iter++;
         LLSurfacePatch *patchp = *curiter;
-        patchp->updateNormals<PBR>();
-        patchp->updateVerticalStats();
-        if (max_update_time == 0.f || update_timer.getElapsedTimeF32() < max_update_time)
+        if (patchp->updateTexture())
         {
-            if (patchp->updateTexture())
-            {
-                did_update = true;
-                patchp->clearDirty();
-                mDirtyPatchList.erase(curiter);
-            }
+            did_update = true;
+            patchp->clearDirty();
+            mDirtyPatchList.erase(curiter);
         }
     }
 
@@ -646,49 +706,23 @@ bool LLSurface::idleUpdate(F32 max_update_time)
 template bool LLSurface::idleUpdate</*PBR=*/false>(F32 max_update_time);
 template bool LLSurface::idleUpdate</*PBR=*/true>(F32 max_update_time);
 
-void LLSurface::decompressDCTPatch(LLBitPack &bitpack, LLGroupHeader *gopp, bool b_large_patch)
+void LLSurface::applyDecodedPatches(const LLDecodedPatches &decoded)
 {
-
-    LLPatchHeader  ph;
-    S32 j, i;
-    S32 patch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-    LLSurfacePatch *patchp;
-
-    init_patch_decompressor(gopp->patch_size);
-    gopp->stride = mGridsPerEdge;
-    set_group_of_patch_header(gopp);
-
-    while (1)
+    const S32 patch_size = decoded.getPatchSize();
+    for (S32 n = 0; n < decoded.getNumPatches(); n++)
     {
-        decode_patch_header(bitpack, &ph);
-        if (ph.quant_wbits == END_OF_PATCHES)
+        const LLPatchHeader &ph = decoded.mHeaders[n];
+        S32 i = ph.patchids >> 5;
+        S32 j = ph.patchids & 0x1F;
+        LLSurfacePatch *patchp = &mPatchList[j*mPatchesPerEdge + i];
+
+        const F32 *heights = decoded.getHeights(n);
+        F32 *data_z = patchp->getDataZ();
+        for (S32 row = 0; row < patch_size; row++)
         {
-            break;
-        }
-
-        i = ph.patchids >> 5;
-        j = ph.patchids & 0x1F;
-
-        if ((i >= mPatchesPerEdge) || (j >= mPatchesPerEdge))
-        {
-            LL_WARNS() << "Received invalid terrain packet - patch header patch ID incorrect!"
-                << " patches per edge " << mPatchesPerEdge
-                << " i " << i
-                << " j " << j
-                << " dc_offset " << ph.dc_offset
-                << " range " << (S32)ph.range
-                << " quant_wbits " << (S32)ph.quant_wbits
-                << " patchids " << (S32)ph.patchids
-                << LL_ENDL;
-            return;
+            memcpy(data_z + row*mGridsPerEdge, heights + row*patch_size, patch_size*sizeof(F32));
         }
 
-        patchp = &mPatchList[j*mPatchesPerEdge + i];
-
-
-        decode_patch(bitpack, patch);
-        decompress_patch(patchp->getDataZ(), patch, &ph);
-
         // Update edges for neighbors.  Need to guarantee that this gets done before we generate vertical stats.
         patchp->updateNorthEdge();
         patchp->updateEastEdge();
@@ -710,6 +744,21 @@ void LLSurface::decompressDCTPatch(LLBitPack &bitpack, LLGroupHeader *gopp, bool
         patchp->dirtyZ();
         patchp->setHasReceivedData();
     }
+
+    if (decoded.mStoppedOnBadPatch)
+    {
+        const LLPatchHeader &ph = decoded.mBadPatchHeader;
+        LL_WARNS() << "Received invalid terrain packet - patch header patch ID or size incorrect!"
+            << " patches per edge " << mPatchesPerEdge
+            << " patch size " << patch_size
+            << " i " << (ph.patchids >> 5)
+            << " j " << (ph.patchids & 0x1F)
+            << " dc_offset " << ph.dc_offset
+            << " range " << (S32)ph.range
+            << " quant_wbits " << (S32)ph.quant_wbits
+            << " patchids " << (S32)ph.patchids
+            << LL_ENDL;
+    }
 }
 
 
@@ -53,8 +53,7 @@ const S32 ABOVE_WATERLINE_ALPHA = 32;  // The alpha of water when the land eleva
 
 class LLViewerRegion;
 class LLSurfacePatch;
-class LLBitPack;
-class LLGroupHeader;
+class LLDecodedPatches;
 
 class LLSurface
 {
@@ -77,7 +76,8 @@ public:
     void disconnectNeighbor(LLSurface *neighborp);
     void disconnectAllNeighbors();
 
-    virtual void decompressDCTPatch(LLBitPack &bitpack, LLGroupHeader *gopp, bool b_large_patch);
+    // Copies patches decoded by decode_patches() into the height field.
+    void applyDecodedPatches(const LLDecodedPatches &decoded);
     virtual void updatePatchVisibilities(LLAgent &agent);
 
     inline F32 getZ(const U32 k) const              { return mSurfaceZ[k]; }
@@ -170,6 +170,9 @@ private:
     void createPatchData();     // Allocates memory for patches.
     void destroyPatchData();    // Deallocates memory for patches.
 
+    template<bool PBR>
+    void updatePatchNormals();  // Recomputes the normals of dirty patches.
+
     LLVector3d  mOriginGlobal;      // In absolute frame
     LLSurfacePatch *mPatchList;     // Array of all patches
 
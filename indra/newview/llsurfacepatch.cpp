@@ -615,11 +615,11 @@ void LLSurfacePatch::updateVerticalStats()
 
 
 template<bool PBR>
-void LLSurfacePatch::updateNormals()
+bool LLSurfacePatch::updateNormals()
 {
     if (mSurfacep->mType == 'w')
     {
-        return;
+        return false;
     }
     U32 grids_per_patch_edge = mSurfacep->getGridsPerPatchEdge();
     U32 grids_per_edge = mSurfacep->getGridsPerEdge();
@@ -766,19 +766,18 @@ void LLSurfacePatch::updateNormals()
         dirty_patch = true;
     }
 
-    if (dirty_patch)
-    {
-        mSurfacep->dirtySurfacePatch(this);
-    }
-
     for (i = 0; i < 9; i++)
     {
         mNormalsInvalid[i] = false;
     }
+
+    // The surface's dirty list may be being read on other threads; leave
+    // dirtySurfacePatch() to the caller.
+    return dirty_patch;
 }
 
-template void LLSurfacePatch::updateNormals</*PBR=*/false>();
-template void LLSurfacePatch::updateNormals</*PBR=*/true>();
+template bool LLSurfacePatch::updateNormals</*PBR=*/false>();
+template bool LLSurfacePatch::updateNormals</*PBR=*/true>();
 
 void LLSurfacePatch::updateEastEdge()
 {
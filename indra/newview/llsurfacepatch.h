@@ -77,8 +77,13 @@ public:
 
     void updateVerticalStats();
     void updateCompositionStats();
+    // Recomputes invalid normals, and may set the height of the northeast
+    // corner, which the north, east and northeast neighbors share. Patches
+    // that don't touch, even at a corner, may do this at the same time.
+    // Returns true if anything was recomputed; the caller then passes the
+    // patch to LLSurface::dirtySurfacePatch().
     template<bool PBR>
-    void updateNormals();
+    bool updateNormals();
 
     void updateEastEdge();
     void updateNorthEdge();
@@ -193,8 +198,8 @@ protected:
     LLSurface *mSurfacep; // Pointer to "parent" surface
 };
 
-extern template void LLSurfacePatch::updateNormals</*PBR=*/false>();
-extern template void LLSurfacePatch::updateNormals</*PBR=*/true>();
+extern template bool LLSurfacePatch::updateNormals</*PBR=*/false>();
+extern template bool LLSurfacePatch::updateNormals</*PBR=*/true>();
 
 
 #endif // LL_LLSURFACEPATCH_H
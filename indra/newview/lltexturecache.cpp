@@ -40,10 +40,12 @@
 #include "llmemory.h"
 
 // Cache organization:
-// cache/texture.entries
-//  Unordered array of Entry structs
+// cache/texture.index
+//  Memory mapped LLTextureCacheIndex: hash table over an array of Entry structs
+// cache/texture.journal
+//  Entry changes since the index was last flushed, replayed after a crash
 // cache/texture.cache
-//  First TEXTURE_CACHE_ENTRY_SIZE bytes of each texture in texture.entries in same order
+//  First TEXTURE_CACHE_ENTRY_SIZE bytes of each texture in texture.index in same order
 // cache/textures/[0-F]/UUID.texture
 //  Actual texture body files
 
@@ -51,7 +53,7 @@
 const S32 TEXTURE_CACHE_ENTRY_SIZE = FIRST_PACKET_SIZE;//1024;
 const F32 TEXTURE_CACHE_PURGE_AMOUNT = .20f; // % amount to reduce the cache by when it exceeds its limit
 const F32 TEXTURE_CACHE_LRU_SIZE = .10f; // % amount for LRU list (low overhead to regenerate)
-const S32 TEXTURE_FAST_CACHE_ENTRY_OVERHEAD = sizeof(S32) * 4; //w, h, c, level
+const S32 TEXTURE_FAST_CACHE_ENTRY_OVERHEAD = UUID_BYTES + sizeof(S32) * 4; //id, w, h, c, level
 const S32 TEXTURE_FAST_CACHE_DATA_SIZE = 16 * 16 * 4;
 const S32 TEXTURE_FAST_CACHE_ENTRY_SIZE = TEXTURE_FAST_CACHE_DATA_SIZE + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD;
 const F32 TEXTURE_LAZY_PURGE_TIME_LIMIT = .004f; // 4ms. Would be better to autoadjust, but there is a major cache rework in progress.
@@ -794,14 +796,10 @@ LLTextureCache::LLTextureCache(bool threaded)
       mWorkersMutex(),
       mHeaderMutex(),
       mListMutex(),
-      mFastCacheMutex(),
-      mHeaderAPRFile(NULL),
       mReadOnly(true), //do not allow to change the texture cache until setReadOnly() is called.
-      mTexturesSizeTotal(0),
+      mLRUTime(0),
       mDoPurge(false),
-      mFastCachep(NULL),
-      mFastCachePoolp(NULL),
-      mFastCachePadBuffer(NULL)
+      mFastCacheSlots(0)
 {
     mHeaderAPRFilePoolp = new LLVolatileAPRPool(); // is_local = true, because this pool is for headers, headers are under own mutex
 }
@@ -809,11 +807,9 @@ LLTextureCache::LLTextureCache(bool threaded)
 LLTextureCache::~LLTextureCache()
 {
     clearDeleteList() ;
-    writeUpdatedEntries() ;
-    delete mFastCachep;
-    delete mFastCachePoolp;
+    mIndex.close();
+    closeFastCache();
     delete mHeaderAPRFilePoolp;
-    ll_aligned_free_16(mFastCachePadBuffer);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -847,7 +843,7 @@ size_t LLTextureCache::update(F32 max_time_ms)
     if(!res && timer.getElapsedTimeF32() > MAX_TIME_INTERVAL)
     {
         timer.reset() ;
-        writeUpdatedEntries() ;
+        mIndex.checkpoint();
     }
 
     return res;
@@ -875,10 +871,8 @@ std::string LLTextureCache::getTextureFileName(const LLUUID& id)
 //debug
 bool LLTextureCache::isInCache(const LLUUID& id)
 {
-    LLMutexLock lock(&mHeaderIDMapMutex);
-    id_map_t::const_iterator iter = mHeaderIDMap.find(id);
-
-    return (iter != mHeaderIDMap.end()) ;
+    Entry entry;
+    return mIndex.find(id, entry) >= 0 && entry.mImageSize >= 0;
 }
 
 //debug
@@ -923,7 +917,9 @@ bool LLTextureCache::isInLocal(const LLUUID& id)
 //////////////////////////////////////////////////////////////////////////////
 
 //static
-F32 LLTextureCache::sHeaderCacheVersion = 1.71f;
+F32 LLTextureCache::sHeaderCacheVersion = 1.8f;
+LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > LLTextureCache::sFastCacheHitRate("texture_fast_cache_hits");
+LLTrace::SampleStatHandle<F32Milliseconds> LLTextureCache::sFastCacheLockWait("texture_fast_cache_lock_wait");
 U32 LLTextureCache::sCacheMaxEntries = 1024 * 1024; //~1 million textures.
 S64 LLTextureCache::sCacheMaxTexturesSize = 0; // no limit
 std::string LLTextureCache::sHeaderCacheEncoderVersion = LLImageJ2C::getEngineInfo();
@@ -934,7 +930,9 @@ U32 LLTextureCache::sHeaderCacheAddressSize = ADDRESS_SIZE;
 U32 LLTextureCache::sHeaderCacheAddressSize = 32;
 #endif
 
-const char* entries_filename = "texture.entries";
+const char* entries_filename = "texture.entries"; // legacy
+const char* index_filename = "texture.index";
+const char* journal_filename = "texture.journal";
 const char* cache_filename = "texture.cache";
 const char* old_textures_dirname = "textures";
 //change the location of the texture cache to prevent from being deleted by old version viewers.
@@ -945,7 +943,8 @@ void LLTextureCache::setDirNames(ELLPath location)
 {
     std::string delem = gDirUtilp->getDirDelimiter();
 
-    mHeaderEntriesFileName = gDirUtilp->getExpandedFilename(location, textures_dirname, entries_filename);
+    mIndexFileName = gDirUtilp->getExpandedFilename(location, textures_dirname, index_filename);
+    mJournalFileName = gDirUtilp->getExpandedFilename(location, textures_dirname, journal_filename);
     mHeaderDataFileName = gDirUtilp->getExpandedFilename(location, textures_dirname, cache_filename);
     mTexturesDirName = gDirUtilp->getExpandedFilename(location, textures_dirname);
     mFastCacheFileName =  gDirUtilp->getExpandedFilename(location, textures_dirname, fast_cache_filename);
@@ -958,7 +957,6 @@ void LLTextureCache::purgeCache(ELLPath location, bool remove_dir)
     if (!mReadOnly)
     {
         setDirNames(location);
-        llassert_always(mHeaderAPRFile == NULL);
 
         //remove the legacy cache if exists
         std::string texture_dir = mTexturesDirName ;
@@ -1035,252 +1033,84 @@ S64 LLTextureCache::initCache(ELLPath location, S64 max_size, bool texture_cache
         }
     }
     readHeaderCache();
-    purgeTextures(true); // calc mTexturesSize and make some room in the texture cache if we need it
+    purgeTextures(true); // make some room in the texture cache if we need it
 
     llassert_always(getPending() == 0) ; //should not start accessing the texture cache before initialized.
-    openFastCache(true);
+    openFastCache();
 
     return max_size; // unused cache space
 }
 
 //----------------------------------------------------------------------------
-// mHeaderMutex must be locked for the following functions!
-
-LLAPRFile* LLTextureCache::openHeaderEntriesFile(bool readonly, S32 offset)
-{
-    llassert_always(mHeaderAPRFile == NULL);
-    apr_int32_t flags = readonly ? APR_READ|APR_BINARY : APR_READ|APR_WRITE|APR_BINARY;
-    mHeaderAPRFile = new LLAPRFile(mHeaderEntriesFileName, flags, mHeaderAPRFilePoolp);
-    if(offset > 0)
-    {
-        mHeaderAPRFile->seek(APR_SET, offset);
-    }
-    return mHeaderAPRFile;
-}
-
-void LLTextureCache::closeHeaderEntriesFile()
-{
-    if(!mHeaderAPRFile)
-    {
-        return ;
-    }
-
-    delete mHeaderAPRFile;
-    mHeaderAPRFile = NULL;
-}
-
-void LLTextureCache::readEntriesHeader()
-{
-    // mHeaderEntriesInfo initializes to default values so safe not to read it
-    llassert_always(mHeaderAPRFile == NULL);
-    if (LLAPRFile::isExist(mHeaderEntriesFileName, mHeaderAPRFilePoolp))
-    {
-        LLAPRFile::readEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
-                          mHeaderAPRFilePoolp);
-    }
-    else //create an empty entries header.
-    {
-        setEntriesHeader();
-        writeEntriesHeader() ;
-    }
-}
 
-void LLTextureCache::setEntriesHeader()
+// mHeaderMutex must be locked
+LLTextureCacheIndex::EOpenResult LLTextureCache::openIndex()
 {
-    if (sHeaderEncoderStringSize < sHeaderCacheEncoderVersion.size() + 1)
-    {
-        // For simplicity we use predefined size of header, so if version string
-        // doesn't fit, either getEngineInfo() returned malformed string or
-        // sHeaderEncoderStringSize need to be increased.
-        // Also take into accout that c_str() returns additional null character
-        LL_ERRS() << "Version string doesn't fit in header" << LL_ENDL;
-    }
-
-    mHeaderEntriesInfo.mVersion = sHeaderCacheVersion;
-    mHeaderEntriesInfo.mAdressSize = sHeaderCacheAddressSize;
-    strcpy(mHeaderEntriesInfo.mEncoderVersion, sHeaderCacheEncoderVersion.c_str());
-    mHeaderEntriesInfo.mEntries = 0;
+    std::string version_tag = llformat("%.2f:%u:%s", sHeaderCacheVersion, sHeaderCacheAddressSize,
+                                       sHeaderCacheEncoderVersion.c_str());
+    return mIndex.open(mIndexFileName, mJournalFileName, sCacheMaxEntries, version_tag, mReadOnly);
 }
 
-void LLTextureCache::writeEntriesHeader()
-{
-    llassert_always(mHeaderAPRFile == NULL);
-    if (!mReadOnly)
-    {
-        LLAPRFile::writeEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
-                           mHeaderAPRFilePoolp);
-    }
-}
-
-//mHeaderMutex is locked before calling this.
+// Lookups only lock the index shard id hashes to; mHeaderMutex is taken
+// only to evict entries when creating one in a full index.
 S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create)
 {
-    S32 idx = -1;
-
-    {
-        LLMutexLock lock(&mHeaderIDMapMutex);
-        id_map_t::iterator iter1 = mHeaderIDMap.find(id);
-        if (iter1 != mHeaderIDMap.end())
-        {
-            idx = iter1->second;
-        }
-    }
-
-    if (idx < 0)
-    {
-        if (create && !mReadOnly)
-        {
-            if (mHeaderEntriesInfo.mEntries < sCacheMaxEntries)
-            {
-                // Add an entry to the end of the list
-                idx = mHeaderEntriesInfo.mEntries++;
-
-            }
-            else if (!mFreeList.empty())
-            {
-                idx = *(mFreeList.begin());
-                mFreeList.erase(mFreeList.begin());
-            }
-            else
-            {
-                // Look for a still valid entry in the LRU
-                for (std::set<LLUUID>::iterator iter2 = mLRU.begin(); iter2 != mLRU.end();)
-                {
-                    std::set<LLUUID>::iterator curiter2 = iter2++;
-                    LLUUID oldid = *curiter2;
-                    // Erase entry from LRU regardless
-                    mLRU.erase(curiter2);
-                    // Look up entry and use it if it is valid
-
-                    S32 found_idx = -1;
-                    {
-                        LLMutexLock lock(&mHeaderIDMapMutex);
-                        id_map_t::iterator iter3 = mHeaderIDMap.find(oldid);
-                        if (iter3 != mHeaderIDMap.end() && iter3->second >= 0)
-                        {
-                            found_idx = iter3->second;
-                        }
-                    }
-                    if (found_idx >= 0)
-                    {
-                        idx = found_idx;
-                        removeCachedTexture(oldid) ;//remove the existing cached texture to release the entry index.
-                        break;
-                    }
-                }
-                // if (idx < 0) at this point, we will rebuild the LRU
-                //  and retry if called from setHeaderCacheEntry(),
-                //  otherwise this shouldn't happen and will trigger an error
-            }
-            if (idx >= 0)
-            {
-                entry.mID = id ;
-                entry.mImageSize = -1 ; //mark it is a brand-new entry.
-                entry.mBodySize = 0 ;
-            }
-        }
-    }
-    else
+    S32 idx = mIndex.find(id, entry, mReadOnly ? 0 : (U32)time(NULL));
+    if (idx >= 0)
     {
-        // Remove this entry from the LRU if it exists
-        mLRU.erase(id);
-        // Read the entry
-        idx_entry_map_t::iterator iter = mUpdatedEntryMap.find(idx) ;
-        if(iter != mUpdatedEntryMap.end())
+        if (entry.mImageSize < 0)
         {
-            entry = iter->second ;
+            // brand-new entry, not visible to readers until it is written
+            return create ? idx : -1;
         }
-        else
+        if (entry.mImageSize > entry.mBodySize)
         {
-            readEntryFromHeaderImmediately(idx, entry) ;
+            return idx;
         }
-        if(entry.mImageSize <= entry.mBodySize)//it happens on 64-bit systems, do not know why
-        {
-            LL_WARNS() << "corrupted entry: " << id << " entry image size: " << entry.mImageSize << " entry body size: " << entry.mBodySize << LL_ENDL ;
 
-            //erase this entry and the cached texture from the cache.
-            std::string tex_filename = getTextureFileName(id);
-            removeEntry(idx, entry, tex_filename) ;
-            mUpdatedEntryMap.erase(idx) ;
-            idx = -1 ;
-        }
-    }
-    return idx;
-}
+        //it happens on 64-bit systems, do not know why
+        LL_WARNS() << "corrupted entry: " << id << " entry image size: " << entry.mImageSize << " entry body size: " << entry.mBodySize << LL_ENDL ;
 
-//mHeaderMutex is locked before calling this.
-void LLTextureCache::writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool write_header)
-{
-    LLAPRFile* aprfile ;
-    S32 bytes_written ;
-    S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
-    if(write_header)
-    {
-        aprfile = openHeaderEntriesFile(false, 0);
-        bytes_written = aprfile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) ;
-        if(bytes_written != sizeof(EntriesInfo))
-        {
-            clearCorruptedCache() ; //clear the cache.
-            idx = -1 ;//mark the idx invalid.
-            return ;
-        }
-
-        mHeaderAPRFile->seek(APR_SET, offset);
-    }
-    else
-    {
-        aprfile = openHeaderEntriesFile(false, offset);
-    }
-    bytes_written = aprfile->write((void*)&entry, (S32)sizeof(Entry));
-    if(bytes_written != sizeof(Entry))
-    {
-        clearCorruptedCache() ; //clear the cache.
-        idx = -1 ;//mark the idx invalid.
-
-        return ;
-    }
-
-    closeHeaderEntriesFile();
-    mUpdatedEntryMap.erase(idx) ;
-}
-
-//mHeaderMutex is locked before calling this.
-void LLTextureCache::readEntryFromHeaderImmediately(S32& idx, Entry& entry)
-{
-    S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
-    LLAPRFile* aprfile = openHeaderEntriesFile(true, offset);
-    S32 bytes_read = aprfile->read((void*)&entry, (S32)sizeof(Entry));
-    closeHeaderEntriesFile();
-
-    if(bytes_read != sizeof(Entry))
-    {
-        clearCorruptedCache() ; //clear the cache.
-        idx = -1 ;//mark the idx invalid.
+        //erase this entry and the cached texture from the cache.
+        LLMutexLock lock(&mHeaderMutex);
+        std::string tex_filename = getTextureFileName(id);
+        removeEntry(idx, entry, tex_filename) ;
+        idx = -1 ;
     }
-}
-
-//mHeaderMutex is locked before calling this.
-//update an existing entry time stamp, delay writing.
-void LLTextureCache::updateEntryTimeStamp(S32 idx, Entry& entry)
-{
-    static const U32 MAX_ENTRIES_WITHOUT_TIME_STAMP = (U32)(LLTextureCache::sCacheMaxEntries * 0.75f) ;
 
-    if(mHeaderEntriesInfo.mEntries < MAX_ENTRIES_WITHOUT_TIME_STAMP)
+    if (!create || mReadOnly)
     {
-        return ; //there are enough empty entry index space, no need to stamp time.
+        return -1;
     }
 
-    if (idx >= 0)
+    entry.init(id, (U32)time(NULL));
+    entry.mImageSize = -1 ; //mark it is a brand-new entry.
+    idx = mIndex.insert(entry);
+    if (idx < 0)
     {
-        if (!mReadOnly)
+        LLMutexLock lock(&mHeaderMutex);
+        // Look for a still valid entry in the LRU
+        while (idx < 0 && !mLRU.empty())
         {
-            entry.mTime = (U32)time(NULL);
-            mUpdatedEntryMap[idx] = entry ;
+            LLUUID oldid = *mLRU.begin();
+            // Erase entry from LRU regardless
+            mLRU.erase(mLRU.begin());
+            // Skip it if it was used since the LRU was built
+            Entry old_entry;
+            if (mIndex.find(oldid, old_entry) >= 0 && old_entry.mTime <= mLRUTime)
+            {
+                removeCachedTexture(oldid) ;//remove the existing cached texture to release the entry index.
+                idx = mIndex.insert(entry);
+            }
         }
+        // if (idx < 0) at this point, we will rebuild the LRU
+        //  and retry if called from setHeaderCacheEntry(),
+        //  otherwise this shouldn't happen and will trigger an error
     }
+    return idx;
 }
 
-//update an existing entry, write to header file immediately.
+//update an existing entry, the index journals it immediately.
 bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32 new_data_size)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
@@ -1290,189 +1120,24 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
     {
         return true ; //nothing changed.
     }
-    else
-    {
-        bool purge = false ;
-
-        lockHeaders() ;
 
-        bool update_header = false ;
-        if(entry.mImageSize < 0) //is a brand-new entry
-        {
-            {
-                LLMutexLock lock(&mHeaderIDMapMutex);
-                mHeaderIDMap[entry.mID] = idx;
-            }
-            mTexturesSizeMap[entry.mID] = new_body_size ;
-            mTexturesSizeTotal += new_body_size ;
+    entry.mTime = (U32)time(NULL);
+    entry.mImageSize = new_image_size ;
+    entry.mBodySize = new_body_size ;
 
-            // Update Header
-            update_header = true ;
-        }
-        else if (entry.mBodySize != new_body_size)
-        {
-            //already in mHeaderIDMap.
-            mTexturesSizeMap[entry.mID] = new_body_size ;
-            mTexturesSizeTotal -= entry.mBodySize ;
-            mTexturesSizeTotal += new_body_size ;
-        }
-        entry.mTime = (U32)time(NULL);
-        entry.mImageSize = new_image_size ;
-        entry.mBodySize = new_body_size ;
-
-        writeEntryToHeaderImmediately(idx, entry, update_header) ;
-
-        if (mTexturesSizeTotal > sCacheMaxTexturesSize)
-        {
-            purge = true;
-        }
-
-        unlockHeaders() ;
-
-        if (purge)
-        {
-            mDoPurge = true;
-        }
-    }
-
-    return false ;
-}
-
-U32 LLTextureCache::openAndReadEntries(std::vector<Entry>& entries)
-{
-    LLMutexLock lock(&mHeaderIDMapMutex);
-    U32 num_entries = mHeaderEntriesInfo.mEntries;
-    mHeaderIDMap.clear();
-    mTexturesSizeMap.clear();
-    mFreeList.clear();
-    mTexturesSizeTotal = 0;
-
-    LLAPRFile* aprfile = NULL;
-    if(mUpdatedEntryMap.empty())
-    {
-        aprfile = openHeaderEntriesFile(true, (S32)sizeof(EntriesInfo));
-    }
-    else //update the header file first.
-    {
-        aprfile = openHeaderEntriesFile(false, 0);
-        updatedHeaderEntriesFile() ;
-        if(!aprfile)
-        {
-            return 0;
-        }
-        aprfile->seek(APR_SET, (S32)sizeof(EntriesInfo));
-    }
-    for (U32 idx=0; idx<num_entries; idx++)
+    if (!mIndex.update(idx, entry))
     {
-        try
-        {
-            Entry entry;
-            S32 bytes_read = aprfile->read((void*)(&entry), (S32)sizeof(Entry));
-            if (bytes_read < sizeof(Entry))
-            {
-                LL_WARNS() << "Corrupted header entries, failed at " << idx << " / " << num_entries << LL_ENDL;
-                closeHeaderEntriesFile();
-                return 0;
-            }
-            entries.push_back(entry);
-            //      LL_INFOS() << "ENTRY: " << entry.mTime << " TEX: " << entry.mID << " IDX: " << idx << " Size: " << entry.mImageSize << LL_ENDL;
-            if (entry.mImageSize > entry.mBodySize)
-            {
-                mHeaderIDMap[entry.mID] = idx;
-                mTexturesSizeMap[entry.mID] = entry.mBodySize;
-                mTexturesSizeTotal += entry.mBodySize;
-            }
-            else
-            {
-                mFreeList.insert(idx);
-            }
-        }
-        catch (std::bad_alloc&)
-        {
-            // Too little ram yet very large cache?
-            // Should this actually crash viewer?
-            entries.clear();
-            LL_WARNS() << "Bad alloc trying to read texture entries from cache, mFreeList: " << (S32)mFreeList.size()
-                << ", added entries: " << idx << ", total entries: " << num_entries << LL_ENDL;
-            closeHeaderEntriesFile();
-            purgeAllTextures(false);
-            return 0;
-        }
+        // evicted or purged while we were writing it
+        idx = -1 ;
     }
-    closeHeaderEntriesFile();
-    return num_entries;
-}
-
-void LLTextureCache::writeEntriesAndClose(const std::vector<Entry>& entries)
-{
-    auto num_entries = entries.size();
-    llassert_always(num_entries == mHeaderEntriesInfo.mEntries);
-
-    if (!mReadOnly)
+    else if (mIndex.getBodyBytes() > sCacheMaxTexturesSize)
     {
-        LLAPRFile* aprfile = openHeaderEntriesFile(false, (S32)sizeof(EntriesInfo));
-        for (size_t idx=0; idx<num_entries; idx++)
-        {
-            S32 bytes_written = aprfile->write((void*)(&entries[idx]), (S32)sizeof(Entry));
-            if(bytes_written != sizeof(Entry))
-            {
-                clearCorruptedCache() ; //clear the cache.
-                return ;
-            }
-        }
-        closeHeaderEntriesFile();
+        mDoPurge = true;
     }
-}
 
-void LLTextureCache::writeUpdatedEntries()
-{
-    lockHeaders() ;
-    if (!mReadOnly && !mUpdatedEntryMap.empty())
-    {
-        openHeaderEntriesFile(false, 0);
-        updatedHeaderEntriesFile() ;
-        closeHeaderEntriesFile();
-    }
-    unlockHeaders() ;
+    return false ;
 }
 
-//mHeaderMutex is locked and mHeaderAPRFile is created before calling this.
-void LLTextureCache::updatedHeaderEntriesFile()
-{
-    if (!mReadOnly && !mUpdatedEntryMap.empty() && mHeaderAPRFile)
-    {
-        //entriesInfo
-        mHeaderAPRFile->seek(APR_SET, 0);
-        S32 bytes_written = mHeaderAPRFile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) ;
-        if(bytes_written != sizeof(EntriesInfo))
-        {
-            clearCorruptedCache() ; //clear the cache.
-            return ;
-        }
-
-        //write each updated entry
-        S32 entry_size = (S32)sizeof(Entry) ;
-        S32 prev_idx = -1 ;
-        S32 delta_idx ;
-        for (idx_entry_map_t::iterator iter = mUpdatedEntryMap.begin(); iter != mUpdatedEntryMap.end(); ++iter)
-        {
-            delta_idx = iter->first - prev_idx - 1;
-            prev_idx = iter->first ;
-            if(delta_idx)
-            {
-                mHeaderAPRFile->seek(APR_CUR, delta_idx * entry_size);
-            }
-
-            bytes_written = mHeaderAPRFile->write((void*)(&iter->second), entry_size);
-            if(bytes_written != entry_size)
-            {
-                clearCorruptedCache() ; //clear the cache.
-                return ;
-            }
-        }
-        mUpdatedEntryMap.clear() ;
-    }
-}
 //----------------------------------------------------------------------------
 
 // Called from either the main thread or the worker thread
@@ -1482,22 +1147,27 @@ void LLTextureCache::readHeaderCache()
 
     mLRU.clear(); // always clear the LRU
 
-    readEntriesHeader();
-
-    if (mHeaderEntriesInfo.mVersion != sHeaderCacheVersion
-        || mHeaderEntriesInfo.mAdressSize != sHeaderCacheAddressSize
-        || strcmp(mHeaderEntriesInfo.mEncoderVersion, sHeaderCacheEncoderVersion.c_str()) != 0)
+    if (!mIndex.isOpen())
     {
-        if (!mReadOnly)
+        LLTextureCacheIndex::EOpenResult result = openIndex();
+        if (result == LLTextureCacheIndex::OPEN_CREATED)
         {
             LL_INFOS() << "Texture Cache version mismatch, Purging." << LL_ENDL;
             purgeAllTextures(false);
         }
+        else if (result == LLTextureCacheIndex::OPEN_FAILED && !mReadOnly)
+        {
+            LL_WARNS() << "Unable to open the texture cache index, switching to read only." << LL_ENDL;
+            setReadOnly(true);
+        }
     }
-    else
+
+    if (mIndex.isOpen())
     {
         std::vector<Entry> entries;
-        U32 num_entries = openAndReadEntries(entries);
+        mIndex.getEntries(entries);
+        mLRUTime = (U32)time(NULL);
+        U32 num_entries = (U32)entries.size();
         if (num_entries)
         {
             U32 empty_entries = 0;
@@ -1567,11 +1237,6 @@ void LLTextureCache::readHeaderCache()
                         break;
                     }
                 }
-                writeEntriesAndClose(entries);
-            }
-            else
-            {
-                //entries are not changed, nothing here.
             }
         }
     }
@@ -1585,7 +1250,6 @@ void LLTextureCache::clearCorruptedCache()
 {
     LL_WARNS() << "the texture cache is corrupted, need to be cleared." << LL_ENDL ;
 
-    closeHeaderEntriesFile();//close possible file handler
     purgeAllTextures(false) ; //clear the cache.
 
     if (!mReadOnly) //regenerate the directory tree if not exists.
@@ -1607,6 +1271,10 @@ void LLTextureCache::purgeAllTextures(bool purge_directories)
 {
     if (!mReadOnly)
     {
+        // the index lives in the directory we are about to empty
+        mIndex.close();
+        closeFastCache();
+
         const char* subdirs = "0123456789abcdef";
         std::string delem = gDirUtilp->getDirDelimiter();
         std::string mask = "*";
@@ -1635,19 +1303,14 @@ void LLTextureCache::purgeAllTextures(bool purge_directories)
             LLFile::rmdir(mTexturesDirName);
         }
     }
+    mLRU.clear();
+
+    // Start over with an empty index
+    if (!mReadOnly && !purge_directories)
     {
-        LLMutexLock lock(&mHeaderIDMapMutex);
-        mHeaderIDMap.clear();
+        openIndex();
+        openFastCache();
     }
-    mTexturesSizeMap.clear();
-    mTexturesSizeTotal = 0;
-    mFreeList.clear();
-    mTexturesSizeTotal = 0;
-    mUpdatedEntryMap.clear();
-
-    // Info with 0 entries
-    setEntriesHeader();
-    writeEntriesHeader();
 
     LL_INFOS() << "The entire texture cache is cleared." << LL_ENDL ;
 }
@@ -1671,35 +1334,24 @@ void LLTextureCache::purgeTexturesLazy(F32 time_limit_sec)
     {
         // Read the entries list and form list of textures to purge
         std::vector<Entry> entries;
-        U32 num_entries = openAndReadEntries(entries);
-        if (!num_entries)
+        mIndex.getEntries(entries);
+        if (entries.empty())
         {
             return; // nothing to purge
         }
 
-        // Use mTexturesSizeMap to collect UUIDs of textures with bodies
+        // Collect textures with bodies
         typedef std::set<std::pair<U32, S32> > time_idx_set_t;
         std::set<std::pair<U32, S32> > time_idx_set;
-        for (size_map_t::iterator iter1 = mTexturesSizeMap.begin();
-            iter1 != mTexturesSizeMap.end(); ++iter1)
+        for (S32 idx = 0; idx < (S32)entries.size(); ++idx)
         {
-            if (iter1->second > 0)
+            if (entries[idx].isValid() && entries[idx].mBodySize > 0)
             {
-                LLMutexLock lock(&mHeaderIDMapMutex);
-                id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
-                if (iter2 != mHeaderIDMap.end())
-                {
-                    S32 idx = iter2->second;
-                    time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
-                }
-                else
-                {
-                    LL_ERRS("TextureCache") << "mTexturesSizeMap / mHeaderIDMap corrupted." << LL_ENDL;
-                }
+                time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
             }
         }
 
-        S64 cache_size = mTexturesSizeTotal;
+        S64 cache_size = mIndex.getBodyBytes();
         S64 purged_cache_size = (llmax(cache_size, sCacheMaxTexturesSize) * (S64)((1.f - TEXTURE_CACHE_PURGE_AMOUNT) * 100)) / 100;
         for (time_idx_set_t::iterator iter = time_idx_set.begin();
             iter != time_idx_set.end(); ++iter)
@@ -1727,17 +1379,10 @@ void LLTextureCache::purgeTexturesLazy(F32 time_limit_sec)
             Entry entry = mPurgeEntryList.back().second;
             mPurgeEntryList.pop_back();
             // make sure record is still valid
-            bool remove_entry = false;
-            {
-                LLMutexLock lock(&mHeaderIDMapMutex);
-                id_map_t::iterator iter_header = mHeaderIDMap.find(entry.mID);
-                remove_entry = (iter_header != mHeaderIDMap.end() && iter_header->second == idx);
-            }
-            if (remove_entry)
+            if (mIndex.find(entry.mID, entry) == idx)
             {
                 std::string tex_filename = getTextureFileName(entry.mID);
                 removeEntry(idx, entry, tex_filename);
-                writeEntryToHeaderImmediately(idx, entry);
             }
         }
     }
@@ -1762,32 +1407,22 @@ void LLTextureCache::purgeTextures(bool validate)
 
     // Read the entries list
     std::vector<Entry> entries;
-    U32 num_entries = openAndReadEntries(entries);
+    mIndex.getEntries(entries);
+    U32 num_entries = (U32)entries.size();
     if (!num_entries)
     {
         return; // nothing to purge
     }
 
-    // Use mTexturesSizeMap to collect UUIDs of textures with bodies
+    // Collect textures with bodies
     typedef std::set<std::pair<U32,S32> > time_idx_set_t;
     std::set<std::pair<U32,S32> > time_idx_set;
-    for (size_map_t::iterator iter1 = mTexturesSizeMap.begin();
-         iter1 != mTexturesSizeMap.end(); ++iter1)
+    for (S32 idx = 0; idx < (S32)num_entries; ++idx)
     {
-        if (iter1->second > 0)
+        if (entries[idx].isValid() && entries[idx].mBodySize > 0)
         {
-            LLMutexLock lock(&mHeaderIDMapMutex);
-            id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
-            if (iter2 != mHeaderIDMap.end())
-            {
-                S32 idx = iter2->second;
-                time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
-//              LL_INFOS() << "TIME: " << entries[idx].mTime << " TEX: " << entries[idx].mID << " IDX: " << idx << " Size: " << entries[idx].mImageSize << LL_ENDL;
-            }
-            else
-            {
-                LL_ERRS() << "mTexturesSizeMap / mHeaderIDMap corrupted." << LL_ENDL ;
-            }
+            time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
+//          LL_INFOS() << "TIME: " << entries[idx].mTime << " TEX: " << entries[idx].mID << " IDX: " << idx << " Size: " << entries[idx].mImageSize << LL_ENDL;
         }
     }
 
@@ -1801,7 +1436,7 @@ void LLTextureCache::purgeTextures(bool validate)
         LL_DEBUGS("TextureCache") << "TEXTURE CACHE: Validating: " << validate_idx << LL_ENDL;
     }
 
-    S64 cache_size = mTexturesSizeTotal;
+    S64 cache_size = mIndex.getBodyBytes();
     S64 purged_cache_size = (llmax(cache_size, sCacheMaxTexturesSize) * (S64)((1.f - TEXTURE_CACHE_PURGE_AMOUNT) * 100)) / 100;
     S32 purge_count = 0;
     for (time_idx_set_t::iterator iter = time_idx_set.begin();
@@ -1846,17 +1481,13 @@ void LLTextureCache::purgeTextures(bool validate)
         }
     }
 
-    LL_DEBUGS("TextureCache") << "TEXTURE CACHE: Writing Entries: " << num_entries << LL_ENDL;
-
-    writeEntriesAndClose(entries);
-
     // *FIX:Mani - watchdog back on.
     LLAppViewer::instance()->resumeMainloopTimeout();
 
     LL_INFOS("TextureCache") << "TEXTURE CACHE:"
             << " PURGED: " << purge_count
             << " ENTRIES: " << num_entries
-            << " CACHE SIZE: " << mTexturesSizeTotal / (1024 * 1024) << " MB"
+            << " CACHE SIZE: " << mIndex.getBodyBytes() / (1024 * 1024) << " MB"
             << LL_ENDL;
 }
 
@@ -1894,30 +1525,20 @@ LLTextureCacheWorker* LLTextureCache::getWriter(handle_t handle)
 S32 LLTextureCache::getHeaderCacheEntry(const LLUUID& id, Entry& entry)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
-    LLMutexLock lock(&mHeaderMutex);
-    S32 idx = openAndReadEntry(id, entry, false);
-    if (idx >= 0)
-    {
-        updateEntryTimeStamp(idx, entry); // updates time
-    }
-    return idx;
+    return openAndReadEntry(id, entry, false);
 }
 
 // Writes imagesize to the header, updates timestamp
 S32 LLTextureCache::setHeaderCacheEntry(const LLUUID& id, Entry& entry, S32 imagesize, S32 datasize)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
-    mHeaderMutex.lock();
     S32 idx = openAndReadEntry(id, entry, true); // read or create
-    mHeaderMutex.unlock();
 
     if(idx < 0) // retry once
     {
         readHeaderCache(); // We couldn't write an entry, so refresh the LRU
 
-        mHeaderMutex.lock();
         idx = openAndReadEntry(id, entry, true);
-        mHeaderMutex.unlock();
     }
 
     if (idx >= 0)
@@ -2026,58 +1647,63 @@ LLTextureCache::handle_t LLTextureCache::writeToCache(const LLUUID& id,
     return handle;
 }
 
+// Waits for the lock stripe guarding slot, sampling how long that took
+std::unique_lock<std::mutex> LLTextureCache::lockFastCacheSlot(S32 slot)
+{
+    std::unique_lock<std::mutex> lock(mFastCacheStripes[slot % FAST_CACHE_STRIPES].mMutex, std::try_to_lock);
+    if (lock.owns_lock())
+    {
+        sample(sFastCacheLockWait, F32Milliseconds(0.f));
+    }
+    else
+    {
+        LLTimer wait_timer;
+        lock.lock();
+        sample(sFastCacheLockWait, F32Milliseconds(wait_timer.getElapsedTimeF32() * 1000.f));
+    }
+    return lock;
+}
+
 //called in the main thread
 LLPointer<LLImageRaw> LLTextureCache::readFromFastCache(const LLUUID& id, S32& discardlevel)
 {
-    U32 offset;
+    LL_PROFILE_ZONE_NAMED("Read fast cache");
+    Entry entry;
+    S32 idx = mIndex.find(id, entry);
+    if (idx < 0 || entry.mImageSize < 0)
     {
-        LLMutexLock lock(&mHeaderIDMapMutex);
-        id_map_t::const_iterator iter = mHeaderIDMap.find(id);
-        if(iter == mHeaderIDMap.end())
-        {
-            return NULL; //not in the cache
-        }
-
-        offset = iter->second;
+        record(sFastCacheHitRate, LLUnits::Ratio::fromValue(0));
+        return NULL; //not in the cache
     }
-    offset *= TEXTURE_FAST_CACHE_ENTRY_SIZE;
 
-    U8* data;
+    U8* data = NULL;
     S32 head[4];
     {
-        LL_PROFILE_ZONE_NAMED("Read fast cache");
-        LLMutexLock lock(&mFastCacheMutex);
-
-        openFastCache(); // only reopens if needed, lasts 10 seconds
-
-        mFastCachep->seek(APR_SET, offset);
-
-        if(mFastCachep->read(head, TEXTURE_FAST_CACHE_ENTRY_OVERHEAD) != TEXTURE_FAST_CACHE_ENTRY_OVERHEAD)
-        {
-            //cache corrupted or under thread race condition
-            closeFastCache();
-            return NULL;
-        }
-
-        S32 image_size = head[0] * head[1] * head[2];
-        if(image_size <= 0
-           || image_size > TEXTURE_FAST_CACHE_DATA_SIZE
-           || head[3] < 0) //invalid
+        std::unique_lock<std::mutex> lock = lockFastCacheSlot(idx);
+        if (idx < mFastCacheSlots)
         {
-            closeFastCache();
-            return NULL;
-        }
-        discardlevel = head[3];
-
-        data = (U8*)ll_aligned_malloc_16(image_size);
-        if(mFastCachep->read(data, image_size) != image_size)
-        {
-            ll_aligned_free_16(data);
-            closeFastCache();
-            return NULL;
+            const U8* slot = mFastCache.getData() + (size_t)idx * TEXTURE_FAST_CACHE_ENTRY_SIZE;
+            // the slot may still hold a texture that was evicted from the entry
+            if (memcmp(slot, id.mData, UUID_BYTES) == 0)
+            {
+                memcpy(head, slot + UUID_BYTES, sizeof(head));
+                S32 image_size = head[0] * head[1] * head[2];
+                if (image_size > 0
+                    && image_size <= TEXTURE_FAST_CACHE_DATA_SIZE
+                    && head[3] >= 0)
+                {
+                    discardlevel = head[3];
+                    data = (U8*)ll_aligned_malloc_16(image_size);
+                    memcpy(data, slot + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD, image_size);
+                }
+            }
         }
+    }
 
-        closeFastCache();
+    record(sFastCacheHitRate, LLUnits::Ratio::fromValue(data ? 1 : 0));
+    if (!data)
+    {
+        return NULL;
     }
 
     // directly construct image from new buffer.
@@ -2134,85 +1760,62 @@ bool LLTextureCache::writeToFastCache(LLUUID image_id, S32 id, LLPointer<LLImage
         }
     }
 
-    //copy data
-    memcpy(mFastCachePadBuffer, &w, sizeof(S32));
-    memcpy(mFastCachePadBuffer + sizeof(S32), &h, sizeof(S32));
-    memcpy(mFastCachePadBuffer + sizeof(S32) * 2, &c, sizeof(S32));
-    memcpy(mFastCachePadBuffer + sizeof(S32) * 3, &discardlevel, sizeof(S32));
-
+    S32 head[4] = { w, h, c, discardlevel };
     S32 copy_size = w * h * c;
-    if(copy_size > 0) //valid
-    {
-        copy_size = llmin(copy_size, TEXTURE_FAST_CACHE_ENTRY_SIZE - TEXTURE_FAST_CACHE_ENTRY_OVERHEAD);
-        memcpy(mFastCachePadBuffer + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD, raw->getData(), copy_size);
-    }
-    S32 offset = id * TEXTURE_FAST_CACHE_ENTRY_SIZE;
+    copy_size = llclamp(copy_size, 0, TEXTURE_FAST_CACHE_DATA_SIZE);
 
     {
-        LLMutexLock lock(&mFastCacheMutex);
-
-        openFastCache();
-
-        mFastCachep->seek(APR_SET, offset);
-
-        //no need to do this assertion check. When it fails, let it fail quietly.
-        //this failure could happen because other viewer removes the fast cache file when clearing cache.
-        //--> llassert_always(mFastCachep->write(mFastCachePadBuffer, TEXTURE_FAST_CACHE_ENTRY_SIZE) == TEXTURE_FAST_CACHE_ENTRY_SIZE);
-        mFastCachep->write(mFastCachePadBuffer, TEXTURE_FAST_CACHE_ENTRY_SIZE);
-
-        closeFastCache(true);
-    }
-
-    return true;
-}
-
-void LLTextureCache::openFastCache(bool first_time)
-{
-    if(!mFastCachep)
-    {
-        if(first_time)
+        std::unique_lock<std::mutex> slot_lock = lockFastCacheSlot(id);
+        U8* slot = mFastCache.getWritableData();
+        //no need to fail the write when the fast cache is not available,
+        //this could happen because other viewer removes the fast cache file when clearing cache.
+        if (slot && id < mFastCacheSlots)
         {
-            if(!mFastCachePadBuffer)
+            slot += (size_t)id * TEXTURE_FAST_CACHE_ENTRY_SIZE;
+            memcpy(slot, image_id.mData, UUID_BYTES);
+            memcpy(slot + UUID_BYTES, head, sizeof(head));
+            if (copy_size > 0)
             {
-                mFastCachePadBuffer = (U8*)ll_aligned_malloc_16(TEXTURE_FAST_CACHE_ENTRY_SIZE);
-            }
-            mFastCachePoolp = new LLVolatileAPRPool(); // is_local= true by default, so not thread safe by default
-            if (LLAPRFile::isExist(mFastCacheFileName, mFastCachePoolp))
-            {
-                mFastCachep = new LLAPRFile(mFastCacheFileName, APR_READ|APR_WRITE|APR_BINARY, mFastCachePoolp) ;
-            }
-            else
-            {
-                mFastCachep = new LLAPRFile(mFastCacheFileName, APR_CREATE|APR_READ|APR_WRITE|APR_BINARY, mFastCachePoolp) ;
+                memcpy(slot + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD, raw->getData(), copy_size);
             }
         }
-        else
-        {
-            mFastCachep = new LLAPRFile(mFastCacheFileName, APR_READ|APR_WRITE|APR_BINARY, mFastCachePoolp) ;
-        }
-
-        mFastCacheTimer.reset();
     }
-    return;
+
+    return true;
 }
 
-void LLTextureCache::closeFastCache(bool forced)
+// Called with no reader or writer active, i.e. from initCache() and purges
+void LLTextureCache::openFastCache()
 {
-    static const F32 timeout = 10.f ; //seconds
+    closeFastCache();
 
-    if(!mFastCachep)
+    std::unique_lock<std::mutex> locks[FAST_CACHE_STRIPES];
+    for (S32 i = 0; i < FAST_CACHE_STRIPES; ++i)
     {
-        return ;
+        locks[i] = std::unique_lock<std::mutex>(mFastCacheStripes[i].mMutex);
     }
 
-    if(!forced && mFastCacheTimer.getElapsedTimeF32() < timeout)
+    bool opened = mReadOnly ? mFastCache.open(mFastCacheFileName)
+                            : mFastCache.openWritable(mFastCacheFileName, (size_t)sCacheMaxEntries * TEXTURE_FAST_CACHE_ENTRY_SIZE);
+    if (opened)
+    {
+        mFastCacheSlots = (S32)llmin(mFastCache.getSize() / TEXTURE_FAST_CACHE_ENTRY_SIZE, (size_t)sCacheMaxEntries);
+    }
+    else if (!mReadOnly)
     {
-        return ;
+        LL_WARNS("TextureCache") << "Unable to map fast cache " << mFastCacheFileName << LL_ENDL;
     }
+}
 
-    delete mFastCachep;
-    mFastCachep = NULL;
-    return;
+void LLTextureCache::closeFastCache()
+{
+    std::unique_lock<std::mutex> locks[FAST_CACHE_STRIPES];
+    for (S32 i = 0; i < FAST_CACHE_STRIPES; ++i)
+    {
+        locks[i] = std::unique_lock<std::mutex>(mFastCacheStripes[i].mMutex);
+    }
+    mFastCacheSlots = 0;
+    mFastCache.close();
 }
 
 bool LLTextureCache::writeComplete(handle_t handle, bool abort)
@@ -2254,15 +1857,7 @@ void LLTextureCache::addCompleted(Responder* responder, bool success)
 //called after mHeaderMutex is locked.
 void LLTextureCache::removeCachedTexture(const LLUUID& id)
 {
-    if(mTexturesSizeMap.find(id) != mTexturesSizeMap.end())
-    {
-        mTexturesSizeTotal -= mTexturesSizeMap[id] ;
-        mTexturesSizeMap.erase(id);
-    }
-    {
-        LLMutexLock lock(&mHeaderIDMapMutex);
-        mHeaderIDMap.erase(id);
-    }
+    mIndex.erase(id);
     // We are inside header's mutex so mHeaderAPRFilePoolp is safe to use,
     // but getLocalAPRFilePool() is not safe, it might be in use by worker
     LLAPRFile::remove(getTextureFileName(id), mHeaderAPRFilePoolp);
@@ -2289,16 +1884,10 @@ void LLTextureCache::removeEntry(S32 idx, Entry& entry, std::string& filename)
               file_maybe_exists = false;
           }
         }
-        mTexturesSizeTotal -= entry.mBodySize;
+        mIndex.erase(entry.mID, idx);
 
         entry.mImageSize = -1;
         entry.mBodySize = 0;
-        {
-            LLMutexLock lock(&mHeaderIDMapMutex);
-            mHeaderIDMap.erase(entry.mID);
-        }
-        mTexturesSizeMap.erase(entry.mID);
-        mFreeList.insert(idx);
     }
 
     if (file_maybe_exists)
@@ -2316,14 +1905,10 @@ bool LLTextureCache::removeFromCache(const LLUUID& id)
         lockHeaders() ;
 
         Entry entry;
-        S32 idx = openAndReadEntry(id, entry, false);
+        S32 idx = mIndex.find(id, entry); // including brand-new entries
         std::string tex_filename = getTextureFileName(id);
         removeEntry(idx, entry, tex_filename) ;
-        if (idx >= 0)
-        {
-            writeEntryToHeaderImmediately(idx, entry);
-            ret = true;
-        }
+        ret = idx >= 0;
 
         unlockHeaders() ;
     }
@@ -32,8 +32,14 @@
 #include "llstring.h"
 #include "lluuid.h"
 
+#include "llmappedfile.h"
+#include "lltrace.h"
 #include "llworkerthread.h"
 
+#include "lltexturecacheindex.h"
+
+#include <mutex>
+
 class LLImageFormatted;
 class LLTextureCacheWorker;
 class LLImageRaw;
@@ -45,42 +51,7 @@ class LLTextureCache : public LLWorkerThread
     friend class LLTextureCacheLocalFileWorker;
 
 private:
-
-#if LL_WINDOWS
-#pragma pack(push,1)
-#endif
-
-    // Entries
-    static const U32 sHeaderEncoderStringSize = 32;
-    struct EntriesInfo
-    {
-        EntriesInfo() : mVersion(0.f), mAdressSize(0), mEntries(0) { memset(mEncoderVersion, 0, sHeaderEncoderStringSize); }
-        F32 mVersion;
-        U32 mAdressSize;
-        char mEncoderVersion[sHeaderEncoderStringSize];
-        U32 mEntries;
-    };
-    struct Entry
-    {
-            Entry() :
-                mBodySize(0),
-            mImageSize(0),
-            mTime(0)
-        {
-        }
-        Entry(const LLUUID& id, S32 imagesize, S32 bodysize, U32 time) :
-            mID(id), mImageSize(imagesize), mBodySize(bodysize), mTime(time) {}
-        void init(const LLUUID& id, U32 time) { mID = id, mImageSize = 0; mBodySize = 0; mTime = time; }
-        Entry& operator=(const Entry& entry) {mID = entry.mID, mImageSize = entry.mImageSize; mBodySize = entry.mBodySize; mTime = entry.mTime; return *this;}
-        LLUUID mID; // 16 bytes
-        S32 mImageSize; // total size of image if known
-        S32 mBodySize; // size of body file in body cache
-        U32 mTime; // seconds since 1/1/1970
-    };
-
-#if LL_WINDOWS
-#pragma pack(pop)
-#endif
+    typedef LLTextureCacheIndex::Entry Entry;
 
 public:
 
@@ -142,13 +113,15 @@ public:
     // debug
     S32 getNumReads() { return static_cast<S32>(mReaders.size()); }
     S32 getNumWrites() { return static_cast<S32>(mWriters.size()); }
-    S64Bytes getUsage() { return S64Bytes(mTexturesSizeTotal); }
+    S64Bytes getUsage() { return S64Bytes(mIndex.getBodyBytes()); }
     S64Bytes getMaxUsage() { return S64Bytes(sCacheMaxTexturesSize); }
-    U32 getEntries() { return mHeaderEntriesInfo.mEntries; }
+    U32 getEntries() { return mIndex.getNumEntries(); }
     U32 getMaxEntries() { return sCacheMaxEntries; };
     bool isInCache(const LLUUID& id) ;
     bool isInLocal(const LLUUID& id) ; //not thread safe at the moment
-    LLMutex* getFastCacheMutex() { return &mFastCacheMutex; }
+
+    static LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > sFastCacheHitRate;
+    static LLTrace::SampleStatHandle<F32Milliseconds> sFastCacheLockWait;
 protected:
     // Accessed by LLTextureCacheWorker
     std::string getLocalFileName(const LLUUID& id);
@@ -165,43 +138,29 @@ private:
     void purgeAllTextures(bool purge_directories);
     void purgeTexturesLazy(F32 time_limit_sec);
     void purgeTextures(bool validate);
-    LLAPRFile* openHeaderEntriesFile(bool readonly, S32 offset);
-    void closeHeaderEntriesFile();
-    void readEntriesHeader();
-    void setEntriesHeader();
-    void writeEntriesHeader();
+    LLTextureCacheIndex::EOpenResult openIndex();
     S32 openAndReadEntry(const LLUUID& id, Entry& entry, bool create);
     bool updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32 new_body_size);
-    void updateEntryTimeStamp(S32 idx, Entry& entry) ;
-    U32 openAndReadEntries(std::vector<Entry>& entries);
-    void writeEntriesAndClose(const std::vector<Entry>& entries);
-    void readEntryFromHeaderImmediately(S32& idx, Entry& entry) ;
-    void writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool write_header = false) ;
     void removeEntry(S32 idx, Entry& entry, std::string& filename);
     void removeCachedTexture(const LLUUID& id) ;
     S32 getHeaderCacheEntry(const LLUUID& id, Entry& entry);
     S32 setHeaderCacheEntry(const LLUUID& id, Entry& entry, S32 imagesize, S32 datasize);
-    void writeUpdatedEntries() ;
-    void updatedHeaderEntriesFile() ;
     void lockHeaders() { mHeaderMutex.lock(); }
     void unlockHeaders() { mHeaderMutex.unlock(); }
 
-    void openFastCache(bool first_time = false);
-    void closeFastCache(bool forced = false);
+    void openFastCache();
+    void closeFastCache();
+    std::unique_lock<std::mutex> lockFastCacheSlot(S32 slot);
     bool writeToFastCache(LLUUID image_id, S32 cache_id, LLPointer<LLImageRaw> raw, S32 discardlevel);
 
 private:
     // Internal
     LLMutex mWorkersMutex;
     LLMutex mHeaderMutex;
-    LLMutex mHeaderIDMapMutex; // To avoid deadlocks, never lock mFastCacheMutex after mHeaderIDMapMutex.
     LLMutex mListMutex;
-    LLMutex mFastCacheMutex;
-    LLAPRFile* mHeaderAPRFile;
-    LLVolatileAPRPool* mFastCachePoolp;
 
     // mLocalAPRFilePoolp is not thread safe and is meant only for workers
-    // howhever mHeaderEntriesFileName is accessed not from workers' threads
+    // howhever texture bodies are also removed outside of workers' threads
     // so it needs own pool (not thread safe by itself, relies onto header's mutex)
     LLVolatileAPRPool*   mHeaderAPRFilePoolp;
 
@@ -218,28 +177,29 @@ private:
     bool mReadOnly;
 
     // HEADERS (Include first mip)
-    std::string mHeaderEntriesFileName;
+    std::string mIndexFileName;
+    std::string mJournalFileName;
     std::string mHeaderDataFileName;
     std::string mFastCacheFileName;
-    EntriesInfo mHeaderEntriesInfo;
-    std::set<S32> mFreeList; // deleted entries
+    LLTextureCacheIndex mIndex;
     std::set<LLUUID> mLRU;
-    typedef std::map<LLUUID, S32> id_map_t;
-    id_map_t mHeaderIDMap;
+    U32 mLRUTime; // when mLRU was built, entries used since are spared
 
-    LLAPRFile*   mFastCachep;
-    LLFrameTimer mFastCacheTimer;
-    U8*          mFastCachePadBuffer;
+    // FAST CACHE: one slot per entry index, the slots are spread over lock
+    // stripes so previews can be read and written from several threads.
+    static const S32 FAST_CACHE_STRIPES = 64;
+    struct alignas(64) FastCacheStripe
+    {
+        std::mutex mMutex;
+    };
+    FastCacheStripe mFastCacheStripes[FAST_CACHE_STRIPES];
+    LLMappedFile mFastCache;    // opened and closed with every stripe held
+    S32          mFastCacheSlots;
 
     // BODIES (TEXTURES minus headers)
     std::string mTexturesDirName;
-    typedef std::map<LLUUID,S32> size_map_t;
-    size_map_t mTexturesSizeMap;
-    S64 mTexturesSizeTotal;
     LLAtomicBool mDoPurge;
 
-    typedef std::map<S32, Entry> idx_entry_map_t;
-    idx_entry_map_t mUpdatedEntryMap;
     typedef std::vector<std::pair<S32, Entry> > idx_entry_vector_t;
     idx_entry_vector_t mPurgeEntryList;
 
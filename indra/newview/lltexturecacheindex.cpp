@@ -0,0 +1,694 @@
+/**
+ * @file lltexturecacheindex.cpp
+ * @brief Memory mapped, crash safe hash index of the texture cache entries
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "lltexturecacheindex.h"
+
+#include "llfile.h"
+
+// texture.index layout:
+//  Header
+//  NUM_SHARDS * mShardBuckets U32 buckets: 0 empty, ~0 deleted, else entry index + 1
+//  mCapacity Entry structs
+// texture.journal:
+//  JournalRecord for each entry change since the last checkpoint
+
+namespace
+{
+    const char INDEX_MAGIC[8] = { 'L', 'L', 'T', 'C', 'I', 'D', 'X', '1' };
+    constexpr U32 JOURNAL_RECORD_MAGIC = 0x4c4e524a; // "JRNL"
+    // checkpoint once the journal holds this many records (~2.5MB)
+    constexpr U32 JOURNAL_CHECKPOINT_RECORDS = 65536;
+    constexpr U32 MIN_SHARD_BUCKETS = 16;
+
+    U32 fnv1a(const U8* data, size_t size)
+    {
+        U32 hash = 2166136261u;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    // texture UUIDs are random already, this just spreads the bits we use
+    inline U64 mix_id(const LLUUID& id)
+    {
+        return id.getDigest64() * 0x9e3779b97f4a7c15ULL;
+    }
+}
+
+struct LLTextureCacheIndex::Header
+{
+    char    mMagic[8];
+    char    mVersionTag[64];
+    U32     mCapacity;
+    U32     mShardBuckets;
+    U32     mNumEntries;
+    U32     mClean;         // set by close(), cleared while open
+    U8      mPad[40];
+};
+static_assert(sizeof(LLTextureCacheIndex::Entry) == 28, "texture cache entries are stored as is");
+
+struct LLTextureCacheIndex::JournalRecord
+{
+    U32     mMagic;
+    S32     mIdx;
+    Entry   mEntry;
+    U32     mChecksum;
+
+    U32 computeChecksum() const
+    {
+        return fnv1a((const U8*)this, sizeof(JournalRecord) - sizeof(mChecksum));
+    }
+};
+
+LLTextureCacheIndex::LLTextureCacheIndex()
+:   mHeader(nullptr),
+    mBuckets(nullptr),
+    mEntries(nullptr),
+    mShardBuckets(0),
+    mCapacity(0),
+    mMaxEntries(0),
+    mReadOnly(true),
+    mBodyBytes(0),
+    mJournal(nullptr),
+    mJournalRecords(0),
+    mNextEntry(0)
+{
+    static_assert(sizeof(Header) == 128, "keep the header a fixed size");
+    static_assert(NUM_SHARDS == 64, "getShard() takes the top 6 bits");
+}
+
+LLTextureCacheIndex::~LLTextureCacheIndex()
+{
+    close();
+}
+
+LLTextureCacheIndex::EOpenResult LLTextureCacheIndex::open(const std::string& index_filename,
+                                                           const std::string& journal_filename,
+                                                           U32 max_entries,
+                                                           const std::string& version_tag,
+                                                           bool read_only)
+{
+    close();
+
+    mReadOnly = read_only;
+    mJournalFileName = journal_filename;
+    mMaxEntries = max_entries;
+
+    if (read_only)
+    {
+        // Another instance owns the cache, use its index as it stands
+        if (!mFile.open(index_filename) || !attach(version_tag) || !rebuild(false))
+        {
+            detach();
+            return OPEN_FAILED;
+        }
+        return OPEN_LOADED;
+    }
+
+    EOpenResult result = OPEN_CREATED;
+    std::vector<Entry> carried; // entries kept while growing the index
+    if (LLFile::isfile(index_filename) && mFile.openWritable(index_filename, 0) && attach(version_tag))
+    {
+        if (mHeader->mClean)
+        {
+            result = OPEN_LOADED;
+        }
+        else
+        {
+            U32 replayed = replayJournal();
+            LL_WARNS("TextureCache") << "Texture cache index was not closed cleanly, replayed "
+                                     << replayed << " journal records" << LL_ENDL;
+            result = OPEN_RECOVERED;
+        }
+
+        if (mCapacity < max_entries)
+        {
+            // Entry indices address texture.cache and the fast cache, so
+            // they are carried over unchanged.
+            carried.assign(mEntries, mEntries + mHeader->mNumEntries);
+            detach();
+        }
+    }
+    else
+    {
+        detach();
+    }
+
+    if (!isOpen())
+    {
+        if (!create(index_filename, llmax(max_entries, (U32)carried.size()), version_tag))
+        {
+            LL_WARNS("TextureCache") << "Unable to create texture cache index " << index_filename << LL_ENDL;
+            detach();
+            return OPEN_FAILED;
+        }
+        if (!carried.empty())
+        {
+            std::copy(carried.begin(), carried.end(), mEntries);
+            mHeader->mNumEntries = (U32)carried.size();
+        }
+    }
+
+    rebuild(result != OPEN_LOADED || !carried.empty());
+
+    {
+        // Start the journal from the state we just loaded
+        std::lock_guard<std::mutex> lock(mJournalMutex);
+        checkpointLocked();
+    }
+    mHeader->mClean = 0;
+
+    LL_INFOS("TextureCache") << "Texture cache index: " << mHeader->mNumEntries << " entries, "
+                             << mFreeList.size() << " free, capacity " << mCapacity << LL_ENDL;
+    return result;
+}
+
+void LLTextureCacheIndex::close()
+{
+    if (isOpen() && !mReadOnly)
+    {
+        std::lock_guard<std::mutex> lock(mJournalMutex);
+        if (checkpointLocked())
+        {
+            mHeader->mClean = 1;
+            mFile.flush();
+        }
+    }
+    if (mJournal)
+    {
+        fclose(mJournal);
+        mJournal = nullptr;
+    }
+    detach();
+}
+
+bool LLTextureCacheIndex::create(const std::string& filename, U32 capacity, const std::string& version_tag)
+{
+    U32 per_shard = (2 * capacity) / NUM_SHARDS + MIN_SHARD_BUCKETS;
+    U32 shard_buckets = MIN_SHARD_BUCKETS;
+    while (shard_buckets < per_shard)
+    {
+        shard_buckets <<= 1;
+    }
+
+    LLFile::remove(filename, ENOENT);
+    if (!mFile.openWritable(filename, getFileSize(capacity, shard_buckets)))
+    {
+        return false;
+    }
+
+    // a fresh file is zero filled: every bucket empty, every entry free
+    Header* header = (Header*)mFile.getWritableData();
+    memcpy(header->mMagic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    strncpy(header->mVersionTag, version_tag.c_str(), sizeof(header->mVersionTag) - 1);
+    header->mCapacity = capacity;
+    header->mShardBuckets = shard_buckets;
+    header->mNumEntries = 0;
+    header->mClean = 0;
+    return attach(version_tag);
+}
+
+bool LLTextureCacheIndex::attach(const std::string& version_tag)
+{
+    if (mFile.getSize() < sizeof(Header))
+    {
+        return false;
+    }
+
+    Header* header = (Header*)mFile.getData();
+    U32 shard_buckets = header->mShardBuckets;
+    if (memcmp(header->mMagic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0
+        || strncmp(header->mVersionTag, version_tag.c_str(), sizeof(header->mVersionTag) - 1) != 0
+        || shard_buckets < MIN_SHARD_BUCKETS
+        || (shard_buckets & (shard_buckets - 1)) != 0
+        || mFile.getSize() < getFileSize(header->mCapacity, shard_buckets)
+        || header->mNumEntries > header->mCapacity)
+    {
+        return false;
+    }
+
+    mHeader = header;
+    mShardBuckets = shard_buckets;
+    mCapacity = header->mCapacity;
+    mBuckets = (U32*)((U8*)header + sizeof(Header));
+    mEntries = (Entry*)(mBuckets + (size_t)NUM_SHARDS * shard_buckets);
+    return true;
+}
+
+void LLTextureCacheIndex::detach()
+{
+    mHeader = nullptr;
+    mBuckets = nullptr;
+    mEntries = nullptr;
+    mShardBuckets = 0;
+    mCapacity = 0;
+    mFile.close();
+    mFreeList.clear();
+    mNextEntry = 0;
+    mBodyBytes = 0;
+    for (Shard& shard : mShards)
+    {
+        shard.mUsed = 0;
+        shard.mTombstones = 0;
+    }
+}
+
+size_t LLTextureCacheIndex::getFileSize(U32 capacity, U32 shard_buckets) const
+{
+    return sizeof(Header) + (size_t)NUM_SHARDS * shard_buckets * sizeof(U32) + (size_t)capacity * sizeof(Entry);
+}
+
+U32 LLTextureCacheIndex::replayJournal()
+{
+    LLFILE* journal = LLFile::fopen(mJournalFileName, "rb");
+    if (!journal)
+    {
+        return 0;
+    }
+
+    // Stops at the first bad record: a torn tail means we were killed while
+    // appending it, before the entry itself was touched.
+    U32 replayed = 0;
+    JournalRecord record;
+    while (fread(&record, sizeof(record), 1, journal) == 1)
+    {
+        if (record.mMagic != JOURNAL_RECORD_MAGIC
+            || record.mChecksum != record.computeChecksum()
+            || record.mIdx < 0
+            || (U32)record.mIdx >= mCapacity)
+        {
+            break;
+        }
+        mEntries[record.mIdx] = record.mEntry;
+        mHeader->mNumEntries = llmax(mHeader->mNumEntries, (U32)record.mIdx + 1);
+        ++replayed;
+    }
+    fclose(journal);
+    return replayed;
+}
+
+bool LLTextureCacheIndex::rebuild(bool rehash)
+{
+    U32 num_entries = mHeader->mNumEntries;
+    size_t num_buckets = (size_t)NUM_SHARDS * mShardBuckets;
+
+    if (!rehash)
+    {
+        // Trust the stored table, but make sure it only points at live entries
+        U32 used = 0;
+        for (size_t i = 0; i < num_buckets && !rehash; ++i)
+        {
+            U32 value = mBuckets[i];
+            if (value == TOMBSTONE_BUCKET)
+            {
+                ++mShards[i / mShardBuckets].mTombstones;
+            }
+            else if (value != EMPTY_BUCKET)
+            {
+                rehash = value > num_entries || !mEntries[value - 1].isValid();
+                ++mShards[i / mShardBuckets].mUsed;
+                ++used;
+            }
+        }
+        U32 valid = 0;
+        for (U32 idx = 0; idx < num_entries; ++idx)
+        {
+            valid += mEntries[idx].isValid() ? 1 : 0;
+        }
+        rehash = rehash || valid != used;
+    }
+
+    if (rehash)
+    {
+        if (mReadOnly)
+        {
+            return false;
+        }
+
+        memset(mBuckets, 0, num_buckets * sizeof(U32));
+        for (Shard& shard : mShards)
+        {
+            shard.mUsed = 0;
+            shard.mTombstones = 0;
+        }
+        for (U32 idx = 0; idx < num_entries; ++idx)
+        {
+            Entry& entry = mEntries[idx];
+            if (!entry.isValid())
+            {
+                continue;
+            }
+            U32 shard_index = getShard(entry.mID);
+            bool found;
+            U32* bucket = probe(entry.mID, shard_index, found);
+            if (found || !bucket)
+            {
+                // duplicate, or no room left in its shard
+                entry.mImageSize = -1;
+                entry.mBodySize = 0;
+                continue;
+            }
+            *bucket = idx + 1;
+            ++mShards[shard_index].mUsed;
+        }
+    }
+
+    S64 body_bytes = 0;
+    mFreeList.clear();
+    for (U32 idx = num_entries; idx-- > 0; )
+    {
+        const Entry& entry = mEntries[idx];
+        if (entry.isValid())
+        {
+            body_bytes += entry.mBodySize;
+        }
+        else
+        {
+            // lowest indices at the back, handed out first
+            mFreeList.push_back((S32)idx);
+        }
+    }
+    mBodyBytes = body_bytes;
+    mNextEntry = num_entries;
+    return true;
+}
+
+U32 LLTextureCacheIndex::getShard(const LLUUID& id) const
+{
+    return (U32)(mix_id(id) >> 58);
+}
+
+U32* LLTextureCacheIndex::probe(const LLUUID& id, U32 shard_index, bool& found)
+{
+    U32* buckets = mBuckets + (size_t)shard_index * mShardBuckets;
+    U32 mask = mShardBuckets - 1;
+    U32 pos = (U32)(mix_id(id) >> 20) & mask;
+    U32* insert_at = nullptr;
+    for (U32 i = 0; i < mShardBuckets; ++i, pos = (pos + 1) & mask)
+    {
+        U32 value = buckets[pos];
+        if (value == EMPTY_BUCKET)
+        {
+            found = false;
+            return insert_at ? insert_at : &buckets[pos];
+        }
+        if (value == TOMBSTONE_BUCKET)
+        {
+            if (!insert_at)
+            {
+                insert_at = &buckets[pos];
+            }
+        }
+        else if (mEntries[value - 1].mID == id)
+        {
+            found = true;
+            return &buckets[pos];
+        }
+    }
+    found = false;
+    return insert_at; // null if the shard is full
+}
+
+void LLTextureCacheIndex::rehashShard(U32 shard_index)
+{
+    U32* buckets = mBuckets + (size_t)shard_index * mShardBuckets;
+    std::vector<U32> live;
+    live.reserve(mShards[shard_index].mUsed);
+    for (U32 i = 0; i < mShardBuckets; ++i)
+    {
+        if (buckets[i] != EMPTY_BUCKET && buckets[i] != TOMBSTONE_BUCKET)
+        {
+            live.push_back(buckets[i]);
+        }
+        buckets[i] = EMPTY_BUCKET;
+    }
+    for (U32 value : live)
+    {
+        bool found;
+        U32* bucket = probe(mEntries[value - 1].mID, shard_index, found);
+        *bucket = value;
+    }
+    mShards[shard_index].mTombstones = 0;
+}
+
+S32 LLTextureCacheIndex::find(const LLUUID& id, Entry& entry, U32 touch_time)
+{
+    if (!isOpen())
+    {
+        return -1;
+    }
+
+    U32 shard_index = getShard(id);
+    std::lock_guard<std::mutex> lock(mShards[shard_index].mMutex);
+    bool found;
+    U32* bucket = probe(id, shard_index, found);
+    if (!found)
+    {
+        return -1;
+    }
+
+    S32 idx = (S32)(*bucket - 1);
+    if (touch_time && !mReadOnly)
+    {
+        // Access times only steer the LRU, they are not worth journaling.
+        // The shard lock is what keeps this apart from getEntries().
+        mEntries[idx].mTime = touch_time;
+    }
+    entry = mEntries[idx];
+    return idx;
+}
+
+S32 LLTextureCacheIndex::insert(Entry& entry)
+{
+    if (!isOpen() || mReadOnly)
+    {
+        return -1;
+    }
+
+    U32 shard_index = getShard(entry.mID);
+    Shard& shard = mShards[shard_index];
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+    bool found;
+    U32* bucket = probe(entry.mID, shard_index, found);
+    if (found)
+    {
+        S32 idx = (S32)(*bucket - 1);
+        entry = mEntries[idx];
+        return idx;
+    }
+    if (!bucket)
+    {
+        return -1;
+    }
+
+    S32 idx = -1;
+    {
+        std::lock_guard<std::mutex> alloc_lock(mAllocMutex);
+        if (!mFreeList.empty())
+        {
+            idx = mFreeList.back();
+            mFreeList.pop_back();
+        }
+        else if (mNextEntry < llmin(mMaxEntries, mCapacity))
+        {
+            idx = (S32)mNextEntry++;
+        }
+    }
+    if (idx < 0)
+    {
+        return -1;
+    }
+
+    writeEntry(idx, entry);
+    if (*bucket == TOMBSTONE_BUCKET)
+    {
+        --shard.mTombstones;
+    }
+    *bucket = idx + 1;
+    ++shard.mUsed;
+    return idx;
+}
+
+bool LLTextureCacheIndex::update(S32 idx, const Entry& entry)
+{
+    if (!isOpen() || mReadOnly)
+    {
+        return false;
+    }
+
+    U32 shard_index = getShard(entry.mID);
+    std::lock_guard<std::mutex> lock(mShards[shard_index].mMutex);
+    bool found;
+    U32* bucket = probe(entry.mID, shard_index, found);
+    if (!found || (S32)(*bucket - 1) != idx)
+    {
+        // evicted and possibly reused since it was looked up
+        return false;
+    }
+    writeEntry(idx, entry);
+    return true;
+}
+
+bool LLTextureCacheIndex::erase(const LLUUID& id, S32 idx)
+{
+    if (!isOpen() || mReadOnly)
+    {
+        return false;
+    }
+
+    U32 shard_index = getShard(id);
+    Shard& shard = mShards[shard_index];
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+    bool found;
+    U32* bucket = probe(id, shard_index, found);
+    if (!found || (idx >= 0 && (S32)(*bucket - 1) != idx))
+    {
+        return false;
+    }
+
+    idx = (S32)(*bucket - 1);
+    Entry freed = mEntries[idx];
+    freed.mImageSize = -1;
+    freed.mBodySize = 0;
+    writeEntry(idx, freed);
+
+    *bucket = TOMBSTONE_BUCKET;
+    --shard.mUsed;
+    ++shard.mTombstones;
+    if (shard.mTombstones > mShardBuckets / 4)
+    {
+        // keep probe sequences for missing ids short
+        rehashShard(shard_index);
+    }
+
+    std::lock_guard<std::mutex> alloc_lock(mAllocMutex);
+    mFreeList.push_back(idx);
+    return true;
+}
+
+void LLTextureCacheIndex::writeEntry(S32 idx, const Entry& entry)
+{
+    std::lock_guard<std::mutex> lock(mJournalMutex);
+
+    // Journal first: if we die half way through the copy below, replaying
+    // the record on the next start finishes it.
+    if (mJournal)
+    {
+        JournalRecord record;
+        record.mMagic = JOURNAL_RECORD_MAGIC;
+        record.mIdx = idx;
+        record.mEntry = entry;
+        record.mChecksum = record.computeChecksum();
+        if (fwrite(&record, sizeof(record), 1, mJournal) == 1 && fflush(mJournal) == 0)
+        {
+            ++mJournalRecords;
+        }
+        else
+        {
+            LL_WARNS_ONCE("TextureCache") << "Failed to write texture cache journal" << LL_ENDL;
+        }
+    }
+
+    const Entry& old_entry = mEntries[idx];
+    S64 delta = (entry.isValid() ? entry.mBodySize : 0) - (old_entry.isValid() ? old_entry.mBodySize : 0);
+    mEntries[idx] = entry;
+    if ((U32)idx >= mHeader->mNumEntries)
+    {
+        mHeader->mNumEntries = (U32)idx + 1;
+    }
+    mBodyBytes += delta;
+
+    if (mJournalRecords >= JOURNAL_CHECKPOINT_RECORDS)
+    {
+        checkpointLocked();
+    }
+}
+
+bool LLTextureCacheIndex::checkpoint()
+{
+    if (!isOpen() || mReadOnly)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mJournalMutex);
+    return checkpointLocked();
+}
+
+bool LLTextureCacheIndex::checkpointLocked()
+{
+    if (mJournal)
+    {
+        fclose(mJournal);
+        mJournal = nullptr;
+    }
+
+    // Only drop the journal once everything it covers is on disk
+    bool flushed = mFile.flush();
+    if (flushed)
+    {
+        LLFILE* truncated = LLFile::fopen(mJournalFileName, "wb");
+        if (truncated)
+        {
+            fclose(truncated);
+        }
+        mJournalRecords = 0;
+    }
+    else
+    {
+        LL_WARNS("TextureCache") << "Failed to flush texture cache index" << LL_ENDL;
+    }
+
+    mJournal = LLFile::fopen(mJournalFileName, "ab");
+    return flushed;
+}
+
+void LLTextureCacheIndex::getEntries(std::vector<Entry>& entries)
+{
+    entries.clear();
+    if (!isOpen())
+    {
+        return;
+    }
+    // Entries are only written with their shard's mutex held: by
+    // writeEntry() and by the access time touch in find(). Holding every
+    // shard keeps the copy consistent without putting the journal mutex on
+    // the lookup path.
+    std::unique_lock<std::mutex> shard_locks[NUM_SHARDS];
+    for (U32 i = 0; i < NUM_SHARDS; ++i)
+    {
+        shard_locks[i] = std::unique_lock<std::mutex>(mShards[i].mMutex);
+    }
+    entries.assign(mEntries, mEntries + mHeader->mNumEntries);
+}
+
+U32 LLTextureCacheIndex::getNumEntries() const
+{
+    return mHeader ? mHeader->mNumEntries : 0;
+}
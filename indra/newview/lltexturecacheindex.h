@@ -0,0 +1,181 @@
+/**
+ * @file lltexturecacheindex.h
+ * @brief Memory mapped, crash safe hash index of the texture cache entries
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXTURECACHEINDEX_H
+#define LL_LLTEXTURECACHEINDEX_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "llmappedfile.h"
+#include "lluuid.h"
+
+// Entry table of LLTextureCache, kept in a memory mapped file instead of
+// being read and rewritten wholesale.
+//
+// Entries live in a dense array so their index can keep addressing the
+// header record in texture.cache and the slot in the fast cache. In front of
+// that array sits an open addressing hash table mapping UUIDs to entry
+// indices. The table is split into shards, each probing only its own range
+// of buckets under its own mutex, so lookups from the fetch threads only
+// contend when they hash to the same shard.
+//
+// Every change to an entry is appended to a journal before it is applied to
+// the mapping. The index is marked clean on close(); if it was not, open()
+// replays the journal over the entry array and rebuilds the hash table from
+// it, so a crash loses at most the change that was being written.
+class LLTextureCacheIndex
+{
+public:
+#if LL_WINDOWS
+#pragma pack(push,1)
+#endif
+    struct Entry
+    {
+        Entry() :
+            mImageSize(0),
+            mBodySize(0),
+            mTime(0)
+        {
+        }
+        Entry(const LLUUID& id, S32 imagesize, S32 bodysize, U32 time) :
+            mID(id), mImageSize(imagesize), mBodySize(bodysize), mTime(time) {}
+        void init(const LLUUID& id, U32 time) { mID = id, mImageSize = 0; mBodySize = 0; mTime = time; }
+        // entries with no image beyond their header record are free
+        bool isValid() const { return mImageSize > mBodySize; }
+        LLUUID mID; // 16 bytes
+        S32 mImageSize; // total size of image if known
+        S32 mBodySize; // size of body file in body cache
+        U32 mTime; // seconds since 1/1/1970
+    };
+#if LL_WINDOWS
+#pragma pack(pop)
+#endif
+
+    enum EOpenResult
+    {
+        OPEN_FAILED,    // could not create or map the index
+        OPEN_CREATED,   // new empty index: none existed or it was incompatible
+        OPEN_LOADED,    // previous index reused as is
+        OPEN_RECOVERED  // previous index was not closed cleanly and was rebuilt
+    };
+
+    LLTextureCacheIndex();
+    ~LLTextureCacheIndex();
+
+    // version_tag identifies the cache format and encoder; an index written
+    // with a different tag is discarded. Up to max_entries entries may be
+    // allocated; an existing index is grown if it holds fewer.
+    EOpenResult open(const std::string& index_filename, const std::string& journal_filename,
+                     U32 max_entries, const std::string& version_tag, bool read_only);
+    // Checkpoints and marks the index clean.
+    void close();
+    bool isOpen() const { return mHeader != nullptr; }
+
+    // Returns the index of id's entry and copies it out, or -1. A non zero
+    // touch_time is stored as the entry's last access time.
+    S32 find(const LLUUID& id, Entry& entry, U32 touch_time = 0);
+
+    // Allocates an entry for entry.mID and stores entry in it. If id already
+    // has one, its index is returned and entry is set to the stored value.
+    // Returns -1 when no entry is free.
+    S32 insert(Entry& entry);
+
+    // Overwrites entry idx, provided it still belongs to entry.mID.
+    bool update(S32 idx, const Entry& entry);
+
+    // Frees id's entry, only if it is at idx when idx is given.
+    bool erase(const LLUUID& id, S32 idx = -1);
+
+    // Writes the mapping back to disk and truncates the journal.
+    bool checkpoint();
+
+    // Copies out entries [0, getNumEntries()). Lookups wait while it does.
+    void getEntries(std::vector<Entry>& entries);
+
+    U32 getNumEntries() const;  // high water mark of allocated entries
+    U32 getMaxEntries() const { return mMaxEntries; }
+    S64 getBodyBytes() const { return mBodyBytes; }
+
+private:
+    struct Header;
+    struct JournalRecord;
+
+    static constexpr U32 NUM_SHARDS = 64;
+    static constexpr U32 EMPTY_BUCKET = 0;
+    static constexpr U32 TOMBSTONE_BUCKET = 0xffffffff;
+
+    struct alignas(64) Shard
+    {
+        std::mutex mMutex;
+        U32 mUsed { 0 };
+        U32 mTombstones { 0 };
+    };
+
+    bool create(const std::string& filename, U32 capacity, const std::string& version_tag);
+    bool attach(const std::string& version_tag);
+    void detach();
+    size_t getFileSize(U32 capacity, U32 shard_buckets) const;
+
+    U32 replayJournal();
+    // Recomputes the free list and counters, rebuilding the hash table from
+    // the entries first if rehash is set or the stored table looks damaged.
+    bool rebuild(bool rehash);
+    bool checkpointLocked();
+
+    U32 getShard(const LLUUID& id) const;
+    // Probes the shard for id. Returns its bucket, or when not found the
+    // bucket an insert should use (null if the shard is full).
+    U32* probe(const LLUUID& id, U32 shard_index, bool& found);
+    void rehashShard(U32 shard_index);
+    // Journals entry and stores it at idx, keeping the body byte count in step.
+    void writeEntry(S32 idx, const Entry& entry);
+
+    LLMappedFile    mFile;
+    Header*         mHeader;
+    U32*            mBuckets;
+    Entry*          mEntries;
+    U32             mShardBuckets;  // per shard, power of two
+    U32             mCapacity;      // entry slots in the file
+    U32             mMaxEntries;    // entries we may allocate
+    bool            mReadOnly;
+    std::atomic<S64> mBodyBytes;
+
+    Shard           mShards[NUM_SHARDS];
+
+    // Guards the journal, and serializes entry writes against checkpoints
+    std::mutex      mJournalMutex;
+    std::string     mJournalFileName;
+    LLFILE*         mJournal;
+    U32             mJournalRecords;
+
+    std::mutex      mAllocMutex;
+    std::vector<S32> mFreeList;
+    U32             mNextEntry;
+};
+
+#endif // LL_LLTEXTURECACHEINDEX_H
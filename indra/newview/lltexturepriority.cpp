@@ -0,0 +1,160 @@
+/**
+ * @file lltexturepriority.cpp
+ * @brief Batched texture virtual size evaluation
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "lltexturepriority.h"
+
+#include "llsimdmath.h"
+#include "threadpool.h"
+
+#include <thread>
+
+bool LLTexturePriorityBatch::sUseVectorKernel = true;
+
+void LLTexturePriorityBatch::clear()
+{
+    mPixelArea.clear();
+    mScale.clear();
+    mImportance.clear();
+    mInFrustum.clear();
+    mFirstFace.clear();
+    mBias.clear();
+}
+
+U32 LLTexturePriorityBatch::addTexture(F32 bias)
+{
+    mFirstFace.push_back((U32)mPixelArea.size());
+    mBias.push_back(bias);
+    return (U32)mBias.size() - 1;
+}
+
+void LLTexturePriorityBatch::compute(const Params& params, LL::ThreadPoolBase* pool)
+{
+    // below this many faces handing out the work costs more than it saves
+    constexpr U32 PARALLEL_MIN_FACES = 8192;
+    static const bool multi_core = std::thread::hardware_concurrency() > 1;
+
+    const U32 num_textures = getNumTextures();
+    mMaxVirtualSize.resize(num_textures);
+    mOnScreen.resize(num_textures);
+    mFirstFace.push_back(getNumFaces()); // end of the last texture
+
+    if (!pool || !multi_core || num_textures < 2 || getNumFaces() < PARALLEL_MIN_FACES)
+    {
+        computeRange(params, 0, num_textures);
+    }
+    else
+    {
+        // a few chunks per thread, as face counts vary a lot between textures
+        const U32 chunks = llmin(num_textures, (U32)(pool->getWidth() + 1) * 4);
+        pool->forkJoin(chunks, [&](size_t chunk)
+                       {
+                           computeRange(params, U32(num_textures * chunk / chunks), U32(num_textures * (chunk + 1) / chunks));
+                       });
+    }
+
+    mFirstFace.pop_back();
+}
+
+// Same steps as the per face code this replaces in
+// LLViewerTextureList::updateImageDecodePriority(), in the same order, so
+// both loops give the same bits.
+void LLTexturePriorityBatch::computeRange(const Params& params, U32 begin, U32 end)
+{
+    const __m128 min_scale4 = _mm_set1_ps(params.mMinScaleArea);
+    const __m128 max_scale4 = _mm_set1_ps(params.mMaxScaleArea);
+    const __m128 boost4 = _mm_set1_ps(params.mCameraBoost);
+    const __m128 discard_bias4 = _mm_set1_ps(params.mDesiredDiscardBias);
+    const __m128 limit4 = _mm_set1_ps(1.9f);
+    const __m128 half4 = _mm_set1_ps(0.5f);
+    const __m128 one4 = _mm_set1_ps(1.f);
+
+    for (U32 t = begin; t < end; ++t)
+    {
+        U32 f = mFirstFace[t];
+        const U32 face_end = mFirstFace[t + 1];
+        const F32 bias = mBias[t];
+
+        F32 max_vsize = 0.f;
+        U32 on_screen = 0;
+
+        if (sUseVectorKernel)
+        {
+            const __m128 bias4 = _mm_set1_ps(bias);
+            __m128 max4 = _mm_setzero_ps();
+            __m128 on_screen4 = _mm_setzero_ps();
+            for (; f + 4 <= face_end; f += 4)
+            {
+                __m128 vsize = _mm_loadu_ps(&mPixelArea[f]);
+                __m128 scale = _mm_loadu_ps(&mScale[f]);
+                __m128 importance = _mm_loadu_ps(&mImportance[f]);
+                __m128 in_frustum = _mm_loadu_ps((const F32*)&mInFrustum[f]);
+
+                scale = _mm_min_ps(_mm_max_ps(_mm_mul_ps(scale, scale), min_scale4), max_scale4);
+                vsize = _mm_div_ps(vsize, scale);
+
+                // !in_frustum || discard bias > 1.9 + importance / 2
+                __m128 biased = _mm_or_ps(_mm_cmpgt_ps(discard_bias4, _mm_add_ps(limit4, _mm_mul_ps(importance, half4))),
+                                          _mm_andnot_ps(in_frustum, _mm_castsi128_ps(_mm_set1_epi32(-1))));
+                vsize = _mm_or_ps(_mm_and_ps(biased, _mm_div_ps(vsize, bias4)), _mm_andnot_ps(biased, vsize));
+
+                __m128 boosted = _mm_mul_ps(vsize, _mm_max_ps(_mm_mul_ps(importance, boost4), one4));
+                vsize = _mm_or_ps(_mm_and_ps(in_frustum, boosted), _mm_andnot_ps(in_frustum, vsize));
+
+                max4 = _mm_max_ps(max4, vsize);
+                on_screen4 = _mm_or_ps(on_screen4, in_frustum);
+            }
+            max4 = _mm_max_ps(max4, _mm_shuffle_ps(max4, max4, _MM_SHUFFLE(1, 0, 3, 2)));
+            max4 = _mm_max_ps(max4, _mm_shuffle_ps(max4, max4, _MM_SHUFFLE(2, 3, 0, 1)));
+            max_vsize = _mm_cvtss_f32(max4);
+            on_screen = _mm_movemask_ps(on_screen4);
+        }
+
+        for (; f < face_end; ++f)
+        {
+            F32 vsize = mPixelArea[f];
+            F32 scale = llclamp(mScale[f] * mScale[f], params.mMinScaleArea, params.mMaxScaleArea);
+            vsize /= scale;
+
+            const bool in_frustum = mInFrustum[f] != 0;
+            if (!in_frustum || params.mDesiredDiscardBias > 1.9f + mImportance[f] * 0.5f)
+            {
+                vsize /= bias;
+            }
+            if (in_frustum)
+            {
+                vsize *= llmax(mImportance[f] * params.mCameraBoost, 1.f);
+            }
+
+            max_vsize = llmax(max_vsize, vsize);
+            on_screen |= mInFrustum[f];
+        }
+
+        mMaxVirtualSize[t] = max_vsize;
+        mOnScreen[t] = on_screen != 0;
+    }
+}
@@ -0,0 +1,102 @@
+/**
+ * @file lltexturepriority.h
+ * @brief Batched texture virtual size evaluation
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXTUREPRIORITY_H
+#define LL_LLTEXTUREPRIORITY_H
+
+#include <vector>
+
+namespace LL
+{
+    class ThreadPoolBase;
+}
+
+// Inputs to texture decode priority, gathered from the faces of a run of
+// textures into flat arrays so that their maximum virtual sizes can be
+// worked out in one pass, four faces at a time, instead of while walking
+// the face lists.
+//
+// Faces are appended right after the texture they belong to, so the faces
+// of each texture are contiguous.
+class LLTexturePriorityBatch
+{
+public:
+    struct Params
+    {
+        F32 mMinScaleArea = 0.0095f;  // TextureScaleMinAreaFactor
+        F32 mMaxScaleArea = 25.f;     // TextureScaleMaxAreaFactor
+        F32 mCameraBoost = 8.f;       // TextureCameraBoost
+        F32 mDesiredDiscardBias = 0.f; // LLViewerTexture::sDesiredDiscardBias
+    };
+
+    void clear();
+
+    // Starts a texture and returns its index. Faces of off screen or
+    // unimportant textures have their virtual size divided by bias.
+    U32 addTexture(F32 bias);
+
+    // Adds a face of the last added texture. scale is the smaller of the
+    // absolute texture entry repeats, 1 if the face has no texture entry.
+    void addFace(F32 pixel_area, F32 scale, F32 importance, bool in_frustum)
+    {
+        mPixelArea.push_back(pixel_area);
+        mScale.push_back(scale);
+        mImportance.push_back(importance);
+        mInFrustum.push_back(in_frustum ? ~0U : 0U);
+    }
+
+    // Fills in the results for every texture. Large batches are split
+    // across pool, if given, with the calling thread taking part.
+    void compute(const Params& params, LL::ThreadPoolBase* pool = nullptr);
+
+    U32 getNumTextures() const { return (U32)mBias.size(); }
+    U32 getNumFaces() const { return (U32)mPixelArea.size(); }
+
+    F32 getMaxVirtualSize(U32 texture) const { return mMaxVirtualSize[texture]; }
+    bool isOnScreen(U32 texture) const { return mOnScreen[texture] != 0; }
+
+    // for tests, compares the SSE and the plain loop
+    static void setUseVectorKernel(bool enable) { sUseVectorKernel = enable; }
+
+private:
+    void computeRange(const Params& params, U32 begin, U32 end);
+
+    // per face
+    std::vector<F32> mPixelArea;
+    std::vector<F32> mScale;
+    std::vector<F32> mImportance;
+    std::vector<U32> mInFrustum; // all bits set when in frustum
+
+    // per texture
+    std::vector<U32> mFirstFace;
+    std::vector<F32> mBias;
+    std::vector<F32> mMaxVirtualSize;
+    std::vector<U8> mOnScreen;
+
+    static bool sUseVectorKernel;
+};
+
+#endif // LL_LLTEXTUREPRIORITY_H
@@ -936,6 +936,7 @@ void LLViewerObjectList::update(LLAgent &agent)
                 objectp->idleUpdate(agent, frame_time);
             }
         }
+        LLVOAvatar::finishDeferredIdleUpdates();
     }
     else
     {
@@ -947,6 +948,9 @@ void LLViewerObjectList::update(LLAgent &agent)
                 objectp->idleUpdate(agent, frame_time);
         }
 
+        // pose avatars whose motion evaluation idleUpdate() deferred
+        LLVOAvatar::finishDeferredIdleUpdates();
+
         //update flexible objects
         LLVolumeImplFlexible::updateClass();
 
@@ -72,10 +72,18 @@ F32 calc_desired_size(LLViewerCamera* camera, LLVector3 pos, LLVector2 scale)
     return llclamp(desired_size, scale.magVec()*0.5f, PART_SIM_BOX_SIDE*2);
 }
 
+// Behaviors that need the source, the region or a callback, which
+// LLViewerPartStore leaves to the group.
+static bool needs_scalar_update(const LLViewerPart* part)
+{
+    const U32 SCALAR_UPDATE_MASK = LLPartData::LL_PART_FOLLOW_SRC_MASK | LLPartData::LL_PART_WIND_MASK
+        | LLPartData::LL_PART_TARGET_POS_MASK | LLPartData::LL_PART_TARGET_LINEAR_MASK | LLPartData::LL_PART_BOUNCE_MASK;
+    return part->mVPCallback || (part->mFlags & SCALAR_UPDATE_MASK);
+}
+
 LLViewerPart::LLViewerPart() :
     mPartID(0),
     mLastUpdateTime(0.f),
-    mSkipOffset(0.f),
     mVPCallback(nullptr),
     mImagep(nullptr)
 {
@@ -117,7 +125,6 @@ void LLViewerPart::init(LLPointer<LLViewerPartSource> sourcep, LLViewerTexture *
     mFlags = 0x00f;
     mLastUpdateTime = 0.f;
     mMaxAge = 10.f;
-    mSkipOffset = 0.0f;
 
     mVPCallback = cb;
     mPartSourcep = sourcep;
@@ -267,7 +274,12 @@ bool LLViewerPartGroup::addPart(LLViewerPart* part, F32 desired_size)
     gPipeline.markRebuild(mVOPartGroupp->mDrawable, LLDrawable::REBUILD_ALL);
 
     mParticles.push_back(part);
-    part->mSkipOffset=mSkippedTime;
+    mStore.add(*part, part->mStartGlow, part->mEndGlow, part->mPosAgent, part->mVelocity, part->mAccel,
+               part->mColor, part->mScale, part->mLastUpdateTime, mSkippedTime);
+    if (needs_scalar_update(part))
+    {
+        mScalarParts.push_back((U32)mParticles.size() - 1);
+    }
     LLViewerPartSim::incPartCount(1);
     return true;
 }
@@ -275,26 +287,19 @@ bool LLViewerPartGroup::addPart(LLViewerPart* part, F32 desired_size)
 
 void LLViewerPartGroup::updateParticles(const F32 lastdt)
 {
-    F32 dt;
-
-    LLVector3 gravity(0.f, 0.f, GRAVITY);
-
     LLViewerPartSim::checkParticleCount(static_cast<U32>(mParticles.size()));
 
     LLViewerCamera* camera = LLViewerCamera::getInstance();
     LLViewerRegion *regionp = getRegion();
     S32 end = (S32) mParticles.size();
-    for (S32 i = 0 ; i < (S32)mParticles.size();)
-    {
-        LLVector3 a(0.f, 0.f, 0.f);
-        LLViewerPart* part = mParticles[i] ;
-
-        dt = lastdt + mSkippedTime - part->mSkipOffset;
-        part->mSkipOffset = 0.f;
 
-        // Update current time
-        const F32 cur_time = part->mLastUpdateTime + dt;
-        const F32 frac = cur_time / part->mMaxAge;
+    // Between updates every particle holds the same state as mStore, so
+    // what mStore can't do is done on the particle itself, before and after
+    // the store's update, and copied across.
+    for (U32 i : mScalarParts)
+    {
+        LLViewerPart* part = mParticles[i];
+        const F32 dt = mStore.getTimeStep(i, lastdt, mSkippedTime);
 
         // "Drift" the object based on the source object
         if (part->mFlags & LLPartData::LL_PART_FOLLOW_SRC_MASK)
@@ -333,21 +338,29 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
             part->mVelocity += step*delta_pos;
         }
 
+        mStore.setPosition(i, part->mPosAgent);
+        mStore.setVelocity(i, part->mVelocity);
+        mStore.setFlags(i, part->mFlags);
+    }
+
+    // Velocity, color, scale and glow interpolation and aging
+    mStore.update(lastdt, mSkippedTime);
+
+    for (U32 i : mScalarParts)
+    {
+        LLViewerPart* part = mParticles[i];
+        part->mPosAgent = mStore.getPosition(i);
+        part->mVelocity = mStore.getVelocity(i);
 
+        // Linear targets replace the velocity interpolation
         if (part->mFlags & LLPartData::LL_PART_TARGET_LINEAR_MASK)
         {
+            const F32 frac = mStore.getAge(i) / part->mMaxAge;
             LLVector3 delta_pos = part->mPartSourcep->mTargetPosAgent - part->mPartSourcep->mPosAgent;
             part->mPosAgent = part->mPartSourcep->mPosAgent;
             part->mPosAgent += frac*delta_pos;
             part->mVelocity = delta_pos;
         }
-        else
-        {
-            // Do velocity interpolation
-            part->mPosAgent += dt*part->mVelocity;
-            part->mPosAgent += 0.5f*dt*dt*part->mAccel;
-            part->mVelocity += part->mAccel*dt;
-        }
 
         // Do a bounce test
         if (part->mFlags & LLPartData::LL_PART_BOUNCE_MASK)
@@ -362,7 +375,6 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
             }
         }
 
-
         // Reset the offset from the source position
         if (part->mFlags & LLPartData::LL_PART_FOLLOW_SRC_MASK)
         {
@@ -370,54 +382,59 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
             part->mPosOffset -= part->mPartSourcep->mPosAgent;
         }
 
-        // Do color interpolation
-        if (part->mFlags & LLPartData::LL_PART_INTERP_COLOR_MASK)
-        {
-            part->mColor.setVec(part->mStartColor);
-            // note: LLColor4's v%k means multiply-alpha-only,
-            //       LLColor4's v*k means multiply-rgb-only
-            part->mColor *= 1.f - frac; // rgb*k
-            part->mColor %= 1.f - frac; // alpha*k
-            part->mColor += frac%(frac*part->mEndColor); // rgb,alpha
-        }
+        mStore.setPosition(i, part->mPosAgent);
+        mStore.setVelocity(i, part->mVelocity);
+    }
 
-        // Do scale interpolation
-        if (part->mFlags & LLPartData::LL_PART_INTERP_SCALE_MASK)
+    LLViewerPartStore::Bounds bounds;
+    bounds.mCameraOrigin = camera->getOrigin();
+    bounds.mMin = mMinObjPos;
+    bounds.mMax = mMaxObjPos;
+    bounds.mBoxRadius = mBoxRadius;
+    bounds.mMaxDesiredSize = PART_SIM_BOX_SIDE*2;
+    mStore.classify(bounds, mPartStatus);
+
+    // Copy the new state to the particles, which rendering and ribbons
+    // read, kill dead particles (either flagged dead, or too old) and take
+    // out the ones that left the group.
+    std::vector<LLViewerPart*> leaving;
+    mScalarParts.clear();
+    U32 kept = 0;
+    for (S32 i = 0; i < end; i++)
+    {
+        LLViewerPart* part = mParticles[i];
+        if (mPartStatus[i] == LLViewerPartStore::DEAD)
         {
-            part->mScale.setVec(part->mStartScale);
-            part->mScale *= 1.f - frac;
-            part->mScale += frac*part->mEndScale;
+            delete part;
+            continue;
         }
 
-        // Do glow interpolation
-        part->mGlow.mV[3] = (U8) ll_round(lerp(part->mStartGlow, part->mEndGlow, frac)*255.f);
+        part->mPosAgent = mStore.getPosition(i);
+        part->mVelocity = mStore.getVelocity(i);
+        part->mColor = mStore.getColor(i);
+        part->mScale = mStore.getScale(i);
+        part->mGlow.mV[3] = mStore.getGlow(i);
+        part->mLastUpdateTime = mStore.getAge(i);
 
-        // Set the last update time to now.
-        part->mLastUpdateTime = cur_time;
-
-
-        // Kill dead particles (either flagged dead, or too old)
-        if ((part->mLastUpdateTime > part->mMaxAge) || (LLViewerPart::LL_PART_DEAD_MASK == part->mFlags))
+        if (mPartStatus[i] == LLViewerPartStore::OUTSIDE)
         {
-            mParticles[i] = mParticles.back() ;
-            mParticles.pop_back() ;
-            delete part ;
+            leaving.push_back(part);
+            continue;
         }
-        else
+
+        if (needs_scalar_update(part))
         {
-            F32 desired_size = calc_desired_size(camera, part->mPosAgent, part->mScale);
-            if (!posInGroup(part->mPosAgent, desired_size))
-            {
-                // Transfer particles between groups
-                LLViewerPartSim::getInstance()->put(part) ;
-                mParticles[i] = mParticles.back() ;
-                mParticles.pop_back() ;
-            }
-            else
-            {
-                i++ ;
-            }
+            mScalarParts.push_back(kept);
         }
+        mParticles[kept++] = part;
+    }
+    mParticles.resize(kept);
+    mStore.compact(mPartStatus);
+
+    // Transfer particles between groups
+    for (LLViewerPart* part : leaving)
+    {
+        LLViewerPartSim::getInstance()->put(part);
     }
 
     S32 removed = end - (S32)mParticles.size();
@@ -452,6 +469,7 @@ void LLViewerPartGroup::shift(const LLVector3 &offset)
     {
         mParticles[i]->mPosAgent += offset;
     }
+    mStore.shift(offset);
 }
 
 void LLViewerPartGroup::removeParticlesByID(const U32 source_id)
@@ -461,6 +479,7 @@ void LLViewerPartGroup::removeParticlesByID(const U32 source_id)
         if(mParticles[i]->mPartSourcep->getID() == source_id)
         {
             mParticles[i]->mFlags = LLViewerPart::LL_PART_DEAD_MASK;
+            mStore.setFlags(i, LLViewerPart::LL_PART_DEAD_MASK);
         }
     }
 }
@@ -31,6 +31,7 @@
 #include "llpointer.h"
 #include "llpartdata.h"
 #include "llviewerpartsource.h"
+#include "llviewerpartstore.h"
 
 class LLViewerTexture;
 class LLViewerPart;
@@ -59,7 +60,6 @@ public:
 
     U32                 mPartID;                    // Particle ID used primarily for moving between groups
     F32                 mLastUpdateTime;            // Last time the particle was updated
-    F32                 mSkipOffset;                // Offset against current group mSkippedTime
 
     LLVPCallback        mVPCallback;                // Callback function for more complicated behaviors
     LLPointer<LLViewerPartSource> mPartSourcep;     // Particle source used for this object
@@ -107,7 +107,7 @@ public:
     F32 getBoxSide() { return mBoxSide; }
 
     typedef std::vector<LLViewerPart*>  part_list_t;
-    part_list_t mParticles;
+    part_list_t mParticles;     // simulated in mStore, at the same index
 
     const LLVector3 &getCenterAgent() const     { return mCenterAgent; }
     S32 getCount() const                    { return (S32) mParticles.size(); }
@@ -131,6 +131,10 @@ protected:
     LLVector3 mMaxObjPos;
 
     LLViewerRegion *mRegionp;
+
+    LLViewerPartStore mStore;
+    std::vector<U32> mScalarParts;  // particles needing per particle updates
+    std::vector<U8> mPartStatus;    // classify() results, kept to reuse
 };
 
 class LLViewerPartSim : public LLSingleton<LLViewerPartSim>
@@ -0,0 +1,381 @@
+/**
+ * @file llviewerpartstore.cpp
+ * @brief Flat per group particle state, updated four particles at a time
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llviewerpartstore.h"
+
+#include "llmath.h"
+#include "llpartdata.h"
+#include "llsimdmath.h"
+
+#include <algorithm>
+
+bool LLViewerPartStore::sUseVectorKernel = true;
+
+namespace
+{
+    // start * (1 - frac) + end * frac, as colors and scales were
+    // interpolated
+    LL_FORCE_INLINE __m128 interpolate(const F32* start, const F32* end, __m128 one_minus_frac, __m128 frac)
+    {
+        return _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(start), one_minus_frac), _mm_mul_ps(_mm_loadu_ps(end), frac));
+    }
+
+    // mask ? value : current
+    LL_FORCE_INLINE void select_store(F32* current, __m128 mask, __m128 value)
+    {
+        _mm_storeu_ps(current, _mm_or_ps(_mm_and_ps(mask, value), _mm_andnot_ps(mask, _mm_loadu_ps(current))));
+    }
+
+    // pos += step * vel, then half_step2 * accel; vel += accel * step
+    LL_FORCE_INLINE void integrate(F32* pos, F32* vel, const F32* accel, __m128 step, __m128 half_step2)
+    {
+        __m128 v = _mm_loadu_ps(vel);
+        __m128 a = _mm_loadu_ps(accel);
+        __m128 p = _mm_add_ps(_mm_loadu_ps(pos), _mm_mul_ps(step, v));
+        _mm_storeu_ps(pos, _mm_add_ps(p, _mm_mul_ps(half_step2, a)));
+        _mm_storeu_ps(vel, _mm_add_ps(v, _mm_mul_ps(a, step)));
+    }
+}
+
+template<typename FUNC>
+void LLViewerPartStore::forEachArray(FUNC&& func)
+{
+    func(mPosX); func(mPosY); func(mPosZ);
+    func(mVelX); func(mVelY); func(mVelZ);
+    func(mAccelX); func(mAccelY); func(mAccelZ);
+    func(mAge); func(mMaxAge); func(mSkipOffset); func(mFlags);
+    func(mColorR); func(mColorG); func(mColorB); func(mColorA);
+    func(mStartColorR); func(mStartColorG); func(mStartColorB); func(mStartColorA);
+    func(mEndColorR); func(mEndColorG); func(mEndColorB); func(mEndColorA);
+    func(mScaleX); func(mScaleY);
+    func(mStartScaleX); func(mStartScaleY);
+    func(mEndScaleX); func(mEndScaleY);
+    func(mStartGlow); func(mEndGlow); func(mGlow);
+}
+
+void LLViewerPartStore::clear()
+{
+    forEachArray([](auto& array) { array.clear(); });
+}
+
+U32 LLViewerPartStore::add(const LLPartData& data, F32 start_glow, F32 end_glow,
+                           const LLVector3& pos, const LLVector3& velocity, const LLVector3& accel,
+                           const LLColor4& color, const LLVector2& scale, F32 age, F32 skip_offset)
+{
+    mPosX.push_back(pos.mV[VX]);
+    mPosY.push_back(pos.mV[VY]);
+    mPosZ.push_back(pos.mV[VZ]);
+    mVelX.push_back(velocity.mV[VX]);
+    mVelY.push_back(velocity.mV[VY]);
+    mVelZ.push_back(velocity.mV[VZ]);
+    mAccelX.push_back(accel.mV[VX]);
+    mAccelY.push_back(accel.mV[VY]);
+    mAccelZ.push_back(accel.mV[VZ]);
+    mAge.push_back(age);
+    mMaxAge.push_back(data.mMaxAge);
+    mSkipOffset.push_back(skip_offset);
+    mFlags.push_back(data.mFlags);
+
+    mColorR.push_back(color.mV[VRED]);
+    mColorG.push_back(color.mV[VGREEN]);
+    mColorB.push_back(color.mV[VBLUE]);
+    mColorA.push_back(color.mV[VALPHA]);
+    mStartColorR.push_back(data.mStartColor.mV[VRED]);
+    mStartColorG.push_back(data.mStartColor.mV[VGREEN]);
+    mStartColorB.push_back(data.mStartColor.mV[VBLUE]);
+    mStartColorA.push_back(data.mStartColor.mV[VALPHA]);
+    mEndColorR.push_back(data.mEndColor.mV[VRED]);
+    mEndColorG.push_back(data.mEndColor.mV[VGREEN]);
+    mEndColorB.push_back(data.mEndColor.mV[VBLUE]);
+    mEndColorA.push_back(data.mEndColor.mV[VALPHA]);
+    mScaleX.push_back(scale.mV[VX]);
+    mScaleY.push_back(scale.mV[VY]);
+    mStartScaleX.push_back(data.mStartScale.mV[VX]);
+    mStartScaleY.push_back(data.mStartScale.mV[VY]);
+    mEndScaleX.push_back(data.mEndScale.mV[VX]);
+    mEndScaleY.push_back(data.mEndScale.mV[VY]);
+    mStartGlow.push_back(start_glow);
+    mEndGlow.push_back(end_glow);
+    mGlow.push_back((U8) ll_round(start_glow * 255.f));
+
+    return getCount() - 1;
+}
+
+void LLViewerPartStore::shift(const LLVector3& offset)
+{
+    const U32 count = getCount();
+    for (U32 i = 0; i < count; ++i)
+    {
+        mPosX[i] += offset.mV[VX];
+        mPosY[i] += offset.mV[VY];
+        mPosZ[i] += offset.mV[VZ];
+    }
+}
+
+void LLViewerPartStore::update(F32 dt, F32 skipped_time)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    updateRange(dt, skipped_time, 0, getCount());
+}
+
+// Same steps as the per particle code this replaces in
+// LLViewerPartGroup::updateParticles(), in the same order, so both loops
+// give the same bits. Glow is the exception: std::lerp() rounds its own
+// way, which can move the odd glow value by one step.
+void LLViewerPartStore::updateRange(F32 dt, F32 skipped_time, U32 i, U32 end)
+{
+    if (sUseVectorKernel)
+    {
+        const __m128 total4 = _mm_set1_ps(dt + skipped_time);
+        const __m128 zero4 = _mm_setzero_ps();
+        const __m128 half4 = _mm_set1_ps(0.5f);
+        const __m128 one4 = _mm_set1_ps(1.f);
+        const __m128 glow_scale4 = _mm_set1_ps(255.f);
+        const __m128i color_mask = _mm_set1_epi32(LLPartData::LL_PART_INTERP_COLOR_MASK);
+        const __m128i scale_mask = _mm_set1_epi32(LLPartData::LL_PART_INTERP_SCALE_MASK);
+        const __m128i byte_mask = _mm_set1_epi32(0xff);
+
+        for (; i + 4 <= end; i += 4)
+        {
+            const __m128 step = _mm_sub_ps(total4, _mm_loadu_ps(&mSkipOffset[i]));
+            _mm_storeu_ps(&mSkipOffset[i], zero4);
+
+            const __m128 cur_time = _mm_add_ps(_mm_loadu_ps(&mAge[i]), step);
+            const __m128 frac = _mm_div_ps(cur_time, _mm_loadu_ps(&mMaxAge[i]));
+            const __m128 one_minus_frac = _mm_sub_ps(one4, frac);
+            _mm_storeu_ps(&mAge[i], cur_time);
+
+            const __m128 half_step2 = _mm_mul_ps(_mm_mul_ps(half4, step), step);
+            integrate(&mPosX[i], &mVelX[i], &mAccelX[i], step, half_step2);
+            integrate(&mPosY[i], &mVelY[i], &mAccelY[i], step, half_step2);
+            integrate(&mPosZ[i], &mVelZ[i], &mAccelZ[i], step, half_step2);
+
+            const __m128i flags = _mm_loadu_si128((const __m128i*)&mFlags[i]);
+            const __m128 interp_color = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(flags, color_mask), color_mask));
+            if (_mm_movemask_ps(interp_color))
+            {
+                select_store(&mColorR[i], interp_color, interpolate(&mStartColorR[i], &mEndColorR[i], one_minus_frac, frac));
+                select_store(&mColorG[i], interp_color, interpolate(&mStartColorG[i], &mEndColorG[i], one_minus_frac, frac));
+                select_store(&mColorB[i], interp_color, interpolate(&mStartColorB[i], &mEndColorB[i], one_minus_frac, frac));
+                select_store(&mColorA[i], interp_color, interpolate(&mStartColorA[i], &mEndColorA[i], one_minus_frac, frac));
+            }
+            const __m128 interp_scale = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(flags, scale_mask), scale_mask));
+            if (_mm_movemask_ps(interp_scale))
+            {
+                select_store(&mScaleX[i], interp_scale, interpolate(&mStartScaleX[i], &mEndScaleX[i], one_minus_frac, frac));
+                select_store(&mScaleY[i], interp_scale, interpolate(&mStartScaleY[i], &mEndScaleY[i], one_minus_frac, frac));
+            }
+
+            // (U8) ll_round(glow * 255), with the floor done by hand
+            const __m128 start_glow = _mm_loadu_ps(&mStartGlow[i]);
+            const __m128 glow = _mm_mul_ps(_mm_add_ps(start_glow, _mm_mul_ps(frac, _mm_sub_ps(_mm_loadu_ps(&mEndGlow[i]), start_glow))), glow_scale4);
+            const __m128 rounded = _mm_add_ps(glow, half4);
+            __m128i glow_int = _mm_cvttps_epi32(rounded);
+            glow_int = _mm_add_epi32(glow_int, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(glow_int), rounded)));
+            glow_int = _mm_and_si128(glow_int, byte_mask);
+            glow_int = _mm_packus_epi16(_mm_packs_epi32(glow_int, glow_int), glow_int);
+            const S32 glow_bytes = _mm_cvtsi128_si32(glow_int);
+            memcpy(&mGlow[i], &glow_bytes, 4);
+        }
+    }
+
+    for (; i < end; ++i)
+    {
+        const F32 step = getTimeStep(i, dt, skipped_time);
+        mSkipOffset[i] = 0.f;
+
+        const F32 cur_time = mAge[i] + step;
+        const F32 frac = cur_time / mMaxAge[i];
+        mAge[i] = cur_time;
+
+        const F32 half_step2 = 0.5f * step * step;
+        mPosX[i] += step * mVelX[i];
+        mPosY[i] += step * mVelY[i];
+        mPosZ[i] += step * mVelZ[i];
+        mPosX[i] += half_step2 * mAccelX[i];
+        mPosY[i] += half_step2 * mAccelY[i];
+        mPosZ[i] += half_step2 * mAccelZ[i];
+        mVelX[i] += mAccelX[i] * step;
+        mVelY[i] += mAccelY[i] * step;
+        mVelZ[i] += mAccelZ[i] * step;
+
+        if (mFlags[i] & LLPartData::LL_PART_INTERP_COLOR_MASK)
+        {
+            mColorR[i] = mStartColorR[i] * (1.f - frac) + mEndColorR[i] * frac;
+            mColorG[i] = mStartColorG[i] * (1.f - frac) + mEndColorG[i] * frac;
+            mColorB[i] = mStartColorB[i] * (1.f - frac) + mEndColorB[i] * frac;
+            mColorA[i] = mStartColorA[i] * (1.f - frac) + mEndColorA[i] * frac;
+        }
+
+        if (mFlags[i] & LLPartData::LL_PART_INTERP_SCALE_MASK)
+        {
+            mScaleX[i] = mStartScaleX[i] * (1.f - frac) + mEndScaleX[i] * frac;
+            mScaleY[i] = mStartScaleY[i] * (1.f - frac) + mEndScaleY[i] * frac;
+        }
+
+        mGlow[i] = (U8) ll_round((mStartGlow[i] + frac * (mEndGlow[i] - mStartGlow[i])) * 255.f);
+    }
+}
+
+void LLViewerPartStore::classify(const Bounds& bounds, std::vector<U8>& status) const
+{
+    LL_PROFILE_ZONE_SCOPED;
+    status.resize(getCount());
+    classifyRange(bounds, status.data(), 0, getCount());
+}
+
+// Same tests as calc_desired_size() and LLViewerPartGroup::posInGroup().
+void LLViewerPartStore::classifyRange(const Bounds& bounds, U8* status, U32 i, U32 end) const
+{
+    const F32 min_desired_size = bounds.mBoxRadius * 0.5f;
+    const F32 max_desired_size = bounds.mBoxRadius * 2.f;
+
+    if (sUseVectorKernel)
+    {
+        const __m128 cam_x = _mm_set1_ps(bounds.mCameraOrigin.mV[VX]);
+        const __m128 cam_y = _mm_set1_ps(bounds.mCameraOrigin.mV[VY]);
+        const __m128 cam_z = _mm_set1_ps(bounds.mCameraOrigin.mV[VZ]);
+        const __m128 min_x = _mm_set1_ps(bounds.mMin.mV[VX]);
+        const __m128 min_y = _mm_set1_ps(bounds.mMin.mV[VY]);
+        const __m128 min_z = _mm_set1_ps(bounds.mMin.mV[VZ]);
+        const __m128 max_x = _mm_set1_ps(bounds.mMax.mV[VX]);
+        const __m128 max_y = _mm_set1_ps(bounds.mMax.mV[VY]);
+        const __m128 max_z = _mm_set1_ps(bounds.mMax.mV[VZ]);
+        const __m128 clamp_max = _mm_set1_ps(bounds.mMaxDesiredSize);
+        const __m128 size_min = _mm_set1_ps(min_desired_size);
+        const __m128 size_max = _mm_set1_ps(max_desired_size);
+        const __m128 quarter4 = _mm_set1_ps(0.25f);
+        const __m128 half4 = _mm_set1_ps(0.5f);
+        const __m128 zero4 = _mm_setzero_ps();
+        const __m128i dead_flags = _mm_set1_epi32((S32)LLPartData::LL_PART_DEAD_MASK);
+
+        for (; i + 4 <= end; i += 4)
+        {
+            const __m128 dead = _mm_or_ps(_mm_cmpgt_ps(_mm_loadu_ps(&mAge[i]), _mm_loadu_ps(&mMaxAge[i])),
+                                          _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)&mFlags[i]), dead_flags)));
+
+            const __m128 x = _mm_loadu_ps(&mPosX[i]);
+            const __m128 y = _mm_loadu_ps(&mPosY[i]);
+            const __m128 z = _mm_loadu_ps(&mPosZ[i]);
+            const __m128 dx = _mm_sub_ps(x, cam_x);
+            const __m128 dy = _mm_sub_ps(y, cam_y);
+            const __m128 dz = _mm_sub_ps(z, cam_z);
+            __m128 desired = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+            desired = _mm_mul_ps(desired, quarter4);
+
+            // llclamp(), where below the minimum wins over above the maximum
+            const __m128 sx = _mm_loadu_ps(&mScaleX[i]);
+            const __m128 sy = _mm_loadu_ps(&mScaleY[i]);
+            const __m128 clamp_min = _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(sx, sx), _mm_mul_ps(sy, sy))), half4);
+            const __m128 too_small = _mm_cmplt_ps(desired, clamp_min);
+            const __m128 too_big = _mm_cmpgt_ps(desired, clamp_max);
+            desired = _mm_or_ps(_mm_and_ps(too_big, clamp_max), _mm_andnot_ps(too_big, desired));
+            desired = _mm_or_ps(_mm_and_ps(too_small, clamp_min), _mm_andnot_ps(too_small, desired));
+
+            __m128 outside = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(x, min_x), _mm_cmplt_ps(y, min_y)), _mm_cmplt_ps(z, min_z));
+            outside = _mm_or_ps(outside, _mm_or_ps(_mm_or_ps(_mm_cmpgt_ps(x, max_x), _mm_cmpgt_ps(y, max_y)), _mm_cmpgt_ps(z, max_z)));
+            const __m128 wrong_size = _mm_or_ps(_mm_cmplt_ps(desired, size_min), _mm_cmpgt_ps(desired, size_max));
+            outside = _mm_or_ps(outside, _mm_and_ps(_mm_cmpgt_ps(desired, zero4), wrong_size));
+
+            const S32 dead_bits = _mm_movemask_ps(dead);
+            const S32 outside_bits = _mm_movemask_ps(outside);
+            for (U32 k = 0; k < 4; ++k)
+            {
+                status[i + k] = (dead_bits >> k) & 1 ? DEAD : (outside_bits >> k) & 1 ? OUTSIDE : ALIVE;
+            }
+        }
+    }
+
+    for (; i < end; ++i)
+    {
+        if (mAge[i] > mMaxAge[i] || LLPartData::LL_PART_DEAD_MASK == mFlags[i])
+        {
+            status[i] = DEAD;
+            continue;
+        }
+
+        const F32 dx = mPosX[i] - bounds.mCameraOrigin.mV[VX];
+        const F32 dy = mPosY[i] - bounds.mCameraOrigin.mV[VY];
+        const F32 dz = mPosZ[i] - bounds.mCameraOrigin.mV[VZ];
+        F32 desired_size = sqrtf(dx * dx + dy * dy + dz * dz) / 4;
+        const F32 min_size = sqrtf(mScaleX[i] * mScaleX[i] + mScaleY[i] * mScaleY[i]) * 0.5f;
+        desired_size = llclamp(desired_size, min_size, bounds.mMaxDesiredSize);
+
+        bool outside = mPosX[i] < bounds.mMin.mV[VX] || mPosY[i] < bounds.mMin.mV[VY] || mPosZ[i] < bounds.mMin.mV[VZ]
+            || mPosX[i] > bounds.mMax.mV[VX] || mPosY[i] > bounds.mMax.mV[VY] || mPosZ[i] > bounds.mMax.mV[VZ];
+        outside = outside || (desired_size > 0 && (desired_size < min_desired_size || desired_size > max_desired_size));
+        status[i] = outside ? OUTSIDE : ALIVE;
+    }
+}
+
+void LLViewerPartStore::compact(const std::vector<U8>& status)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    const U32 count = getCount();
+    U32 first = 0;
+    while (first < count && status[first] == ALIVE)
+    {
+        ++first;
+    }
+    if (first == count)
+    {
+        return;
+    }
+
+    // Survivors come in long runs between the few particles that go each
+    // frame, so find the runs once and move each one with a single copy per
+    // array, rather than testing every particle once per array.
+    mRuns.clear();
+    U32 kept = first;
+    for (U32 i = first + 1; i < count;)
+    {
+        if (status[i] != ALIVE)
+        {
+            ++i;
+            continue;
+        }
+        U32 run_end = i + 1;
+        while (run_end < count && status[run_end] == ALIVE)
+        {
+            ++run_end;
+        }
+        mRuns.push_back({ i, run_end - i });
+        kept += run_end - i;
+        i = run_end;
+    }
+
+    forEachArray([this, first, kept](auto& array)
+                 {
+                     auto dest = array.begin() + first;
+                     for (const Run& run : mRuns)
+                     {
+                         dest = std::copy(array.begin() + run.mBegin, array.begin() + run.mBegin + run.mCount, dest);
+                     }
+                     array.resize(kept);
+                 });
+}
@@ -0,0 +1,143 @@
+/**
+ * @file llviewerpartstore.h
+ * @brief Flat per group particle state, updated four particles at a time
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVIEWERPARTSTORE_H
+#define LL_LLVIEWERPARTSTORE_H
+
+#include "v2math.h"
+#include "v3math.h"
+#include "v4color.h"
+
+#include <vector>
+
+class LLPartData;
+
+// The simulated state of the particles of one LLViewerPartGroup, one array
+// per component, in the same order as the group's particle list.
+//
+// update() does the part of LLViewerPartGroup::updateParticles() that
+// only needs the particle itself: integrating velocity and acceleration,
+// color, scale and glow interpolation and aging. classify() then sorts
+// out the dead and the ones that left the group's box. Both work on four
+// particles at a time. Wind, targets, bounces, following the source and
+// callbacks need more than the particle and are left to the group.
+class LLViewerPartStore
+{
+public:
+    // What classify() found for a particle
+    enum EStatus : U8
+    {
+        ALIVE = 0,
+        DEAD,       // past its maximum age or flagged dead
+        OUTSIDE     // alive, but belongs in another group
+    };
+
+    // The group's box, as LLViewerPartGroup::posInGroup() tests it
+    struct Bounds
+    {
+        LLVector3 mCameraOrigin;
+        LLVector3 mMin;
+        LLVector3 mMax;
+        F32 mBoxRadius = 0.f;
+        F32 mMaxDesiredSize = 32.f;  // PART_SIM_BOX_SIDE * 2
+    };
+
+    void clear();
+
+    // Appends a particle and returns its index. Its interpolation flags,
+    // maximum age and start and end colors and scales come from data.
+    U32 add(const LLPartData& data, F32 start_glow, F32 end_glow,
+            const LLVector3& pos, const LLVector3& velocity, const LLVector3& accel,
+            const LLColor4& color, const LLVector2& scale, F32 age, F32 skip_offset);
+
+    U32 getCount() const { return (U32)mFlags.size(); }
+
+    LLVector3 getPosition(U32 i) const { return LLVector3(mPosX[i], mPosY[i], mPosZ[i]); }
+    void setPosition(U32 i, const LLVector3& pos) { mPosX[i] = pos.mV[VX]; mPosY[i] = pos.mV[VY]; mPosZ[i] = pos.mV[VZ]; }
+    LLVector3 getVelocity(U32 i) const { return LLVector3(mVelX[i], mVelY[i], mVelZ[i]); }
+    void setVelocity(U32 i, const LLVector3& vel) { mVelX[i] = vel.mV[VX]; mVelY[i] = vel.mV[VY]; mVelZ[i] = vel.mV[VZ]; }
+    LLColor4 getColor(U32 i) const { return LLColor4(mColorR[i], mColorG[i], mColorB[i], mColorA[i]); }
+    LLVector2 getScale(U32 i) const { return LLVector2(mScaleX[i], mScaleY[i]); }
+    U8 getGlow(U32 i) const { return mGlow[i]; }
+    F32 getAge(U32 i) const { return mAge[i]; }
+    U32 getFlags(U32 i) const { return mFlags[i]; }
+    void setFlags(U32 i, U32 flags) { mFlags[i] = flags; }
+
+    // The time particle i moves by in the next update(), which includes
+    // the updates its group skipped before it joined.
+    F32 getTimeStep(U32 i, F32 dt, F32 skipped_time) const { return dt + skipped_time - mSkipOffset[i]; }
+
+    void shift(const LLVector3& offset);
+
+    // Advances every particle by its time step. Particles are integrated
+    // whatever their flags; callers redo the ones with a linear target.
+    void update(F32 dt, F32 skipped_time);
+
+    // Fills status with an EStatus per particle.
+    void classify(const Bounds& bounds, std::vector<U8>& status) const;
+
+    // Drops every particle whose status isn't ALIVE, keeping the order of
+    // the rest.
+    void compact(const std::vector<U8>& status);
+
+    // for tests, compares the SSE and the plain loops
+    static void setUseVectorKernel(bool enable) { sUseVectorKernel = enable; }
+
+private:
+    template<typename FUNC>
+    void forEachArray(FUNC&& func);
+
+    void updateRange(F32 dt, F32 skipped_time, U32 begin, U32 end);
+    void classifyRange(const Bounds& bounds, U8* status, U32 begin, U32 end) const;
+
+    std::vector<F32> mPosX, mPosY, mPosZ;
+    std::vector<F32> mVelX, mVelY, mVelZ;
+    std::vector<F32> mAccelX, mAccelY, mAccelZ;
+    std::vector<F32> mAge;          // LLViewerPart::mLastUpdateTime
+    std::vector<F32> mMaxAge;
+    std::vector<F32> mSkipOffset;
+    std::vector<U32> mFlags;
+
+    std::vector<F32> mColorR, mColorG, mColorB, mColorA;
+    std::vector<F32> mStartColorR, mStartColorG, mStartColorB, mStartColorA;
+    std::vector<F32> mEndColorR, mEndColorG, mEndColorB, mEndColorA;
+    std::vector<F32> mScaleX, mScaleY;
+    std::vector<F32> mStartScaleX, mStartScaleY;
+    std::vector<F32> mEndScaleX, mEndScaleY;
+    std::vector<F32> mStartGlow, mEndGlow;
+    std::vector<U8> mGlow;          // alpha of LLViewerPart::mGlow
+
+    struct Run
+    {
+        U32 mBegin;
+        U32 mCount;
+    };
+    std::vector<Run> mRuns;         // compact() scratch, kept to reuse
+
+    static bool sUseVectorKernel;
+};
+
+#endif // LL_LLVIEWERPARTSTORE_H
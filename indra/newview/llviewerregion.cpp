@@ -211,6 +211,7 @@ public:
     LLVLComposition *mCompositionp;     // Composition layer for the surface
 
     LLVOCacheEntry::vocache_entry_map_t   mCacheMap; //all cached entries
+    LLVOCachePackEntries                  mCachePackEntries; //cached entries not looked up yet, single file cache only
     LLVOCacheEntry::vocache_entry_set_t   mActiveSet; //all active entries;
     LLVOCacheEntry::vocache_entry_set_t   mWaitingSet; //entries waiting for LLDrawable to be generated.
     std::set< LLPointer<LLViewerOctreeGroup> >      mVisibleGroups; //visible groupa
@@ -792,10 +793,10 @@ void LLViewerRegion::loadObjectCache()
     {
         LLVOCache & vocache = LLVOCache::instance();
         // Without this a "corrupted" vocache persists until a cache clear or other rewrite. Mark as dirty hereif read fails to force a rewrite.
-        mCacheDirty = !vocache.readFromCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap);
-        vocache.readGenericExtrasFromCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD, mImpl->mCacheMap);
+        mCacheDirty = !vocache.readFromCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap, &mImpl->mCachePackEntries);
+        vocache.readGenericExtrasFromCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD, mImpl->mCacheMap, &mImpl->mCachePackEntries);
 
-        if (mImpl->mCacheMap.empty())
+        if (mImpl->mCacheMap.empty() && mImpl->mCachePackEntries.empty())
         {
             mCacheDirty = true;
         }
@@ -810,7 +811,7 @@ void LLViewerRegion::saveObjectCache()
         return;
     }
 
-    if (mImpl->mCacheMap.empty())
+    if (mImpl->mCacheMap.empty() && mImpl->mCachePackEntries.empty())
     {
         return;
     }
@@ -822,11 +823,12 @@ void LLViewerRegion::saveObjectCache()
 
         LLVOCache & instance = LLVOCache::instance();
 
-        instance.writeToCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap, mCacheDirty, removal_enabled);
+        instance.writeToCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap, mCacheDirty, removal_enabled, &mImpl->mCachePackEntries);
         instance.writeGenericExtrasToCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD, mCacheDirty, removal_enabled);
         mCacheDirty = false;
     }
 
+    mImpl->mCachePackEntries.clear();
     if (LLAppViewer::instance()->isQuitting())
     {
         mImpl->mCacheMap.clear();
@@ -2813,12 +2815,19 @@ LLVOCacheEntry* LLViewerRegion::getCacheEntryForOctree(U32 local_id)
 LLVOCacheEntry* LLViewerRegion::getCacheEntry(U32 local_id, bool valid)
 {
     LLVOCacheEntry::vocache_entry_map_t::iterator iter = mImpl->mCacheMap.find(local_id);
-    if(iter != mImpl->mCacheMap.end())
+    if(iter == mImpl->mCacheMap.end())
     {
-        if(!valid || iter->second->isValid())
+        // first look up of an entry still in the object cache pack
+        LLPointer<LLVOCacheEntry> entry = mImpl->mCachePackEntries.take(local_id);
+        if(entry.isNull())
         {
-            return iter->second;
+            return NULL;
         }
+        iter = mImpl->mCacheMap.emplace(local_id, entry).first;
+    }
+    if(!valid || iter->second->isValid())
+    {
+        return iter->second;
     }
     return NULL;
 }
@@ -3003,7 +3012,7 @@ void LLViewerRegion::dumpCache()
         change_bin[changes]++;
     }
 
-    LL_INFOS() << "Count " << mImpl->mCacheMap.size() << LL_ENDL;
+    LL_INFOS() << "Count " << mImpl->mCacheMap.size() << ", not looked up " << mImpl->mCachePackEntries.size() << LL_ENDL;
     for (i = 0; i < BINS; i++)
     {
         LL_INFOS() << "Hits " << i << " " << hit_bin[i] << LL_ENDL;
@@ -3018,6 +3027,7 @@ void LLViewerRegion::dumpCache()
 void LLViewerRegion::clearVOCacheFromMemory()
 {
     mImpl->mCacheMap.clear();
+    mImpl->mCachePackEntries.clear();
 }
 
 void LLViewerRegion::unpackRegionHandshake()
@@ -3211,7 +3221,7 @@ void LLViewerRegion::unpackRegionHandshake()
     {
         flags |= 0x00000001; //set the bit 0 to be 1 to ask sim to send all cacheable objects.
     }
-    if(mImpl->mCacheMap.empty())
+    if(mImpl->mCacheMap.empty() && mImpl->mCachePackEntries.empty())
     {
         flags |= 0x00000002; //set the bit 1 to be 1 to tell sim the cache file is empty, no need to send cache probes.
     }
@@ -896,109 +896,119 @@ void LLViewerTextureList::clearFetchingRequests()
 
 extern bool gCubeSnapshot;
 
-void LLViewerTextureList::updateImageDecodePriority(LLViewerFetchedTexture* imagep, bool flush_images)
+namespace
 {
-    llassert(!gCubeSnapshot);
+    // calcPixelArea calls allowed per texture and update; faces past that
+    // keep the pixel area of their last check
+    constexpr U32 MAX_FACES_TO_REFRESH = 1024;
 
-    constexpr F32 BIAS_TRS_OUT_OF_SCREEN = 1.5f;
-    constexpr F32 BIAS_TRS_ON_SCREEN = 1.f;
+    // textures used in more places than this just get full resolution,
+    // gathering their faces is not time sliced
+    constexpr S32 MAX_FACES_TO_CHECK = 16384;
 
-    if (imagep->getBoostLevel() < LLViewerFetchedTexture::BOOST_HIGH)  // don't bother checking face list for boosted textures
+    LLTexturePriorityBatch::Params texture_priority_params()
     {
         static LLCachedControl<F32> texture_scale_min(gSavedSettings, "TextureScaleMinAreaFactor", 0.0095f);
         static LLCachedControl<F32> texture_scale_max(gSavedSettings, "TextureScaleMaxAreaFactor", 25.f);
+        static LLCachedControl<F32> texture_camera_boost(gSavedSettings, "TextureCameraBoost", 8.f);
 
-        F32 max_vsize = 0.f;
-        bool on_screen = false;
+        LLTexturePriorityBatch::Params params;
+        params.mMinScaleArea = texture_scale_min;
+        params.mMaxScaleArea = texture_scale_max;
+        params.mCameraBoost = texture_camera_boost;
+        params.mDesiredDiscardBias = LLViewerTexture::sDesiredDiscardBias;
+        return params;
+    }
+}
 
-        U32 face_count = 0;
-        U32 max_faces_to_check = 1024;
+void LLViewerTextureList::updateImageDecodePriority(LLViewerFetchedTexture* imagep, bool flush_images)
+{
+    llassert(!gCubeSnapshot);
 
-        // get adjusted bias based on image resolution
-        LLImageGL* img = imagep->getGLTexture();
-        F32 max_discard = F32(img ? img->getMaxDiscardLevel() : MAX_DISCARD_LEVEL);
-        F32 bias = llclamp(max_discard - 2.f, 1.f, LLViewerTexture::sDesiredDiscardBias);
+    mPriorityBatch.clear();
+    S32 index = gatherImageDecodePriority(imagep, mPriorityBatch);
+    mPriorityBatch.compute(texture_priority_params());
+    applyImageDecodePriority(imagep, index, flush_images);
+}
 
-        // convert bias into a vsize scaler
-        bias = (F32) llroundf(powf(4, bias - 1.f));
+S32 LLViewerTextureList::gatherImageDecodePriority(LLViewerFetchedTexture* imagep, LLTexturePriorityBatch& batch)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    if (imagep->getBoostLevel() >= LLViewerFetchedTexture::BOOST_HIGH)  // don't bother checking face list for boosted textures
+    {
+        return -1;
+    }
 
-        LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
-        for (U32 i = 0; i < LLRender::NUM_TEXTURE_CHANNELS; ++i)
-        {
-            face_count += imagep->getNumFaces(i);
-            S32 faces_to_check = (face_count > max_faces_to_check) ? 0 : imagep->getNumFaces(i);
+    // get adjusted bias based on image resolution
+    LLImageGL* img = imagep->getGLTexture();
+    F32 max_discard = F32(img ? img->getMaxDiscardLevel() : MAX_DISCARD_LEVEL);
+    F32 bias = llclamp(max_discard - 2.f, 1.f, LLViewerTexture::sDesiredDiscardBias);
+
+    // convert bias into a vsize scaler
+    bias = (F32) llroundf(powf(4, bias - 1.f));
+
+    S32 index = batch.addTexture(bias);
+    if (imagep->getTotalNumFaces() > MAX_FACES_TO_CHECK)
+    {
+        return index;
+    }
 
-            for (S32 fi = 0; fi < faces_to_check; ++fi)
+    U32 refreshed = 0;
+    for (U32 i = 0; i < LLRender::NUM_TEXTURE_CHANNELS; ++i)
+    {
+        const LLViewerTexture::ll_face_list_t& faces = *imagep->getFaceList(i);
+        const S32 num_faces = imagep->getNumFaces(i);
+        for (S32 fi = 0; fi < num_faces; ++fi)
+        {
+            LLFace* face = faces[fi];
+            LLViewerObject* objp = face ? face->getViewerObject() : nullptr;
+            if (!objp)
             {
-                LLFace* face = (*(imagep->getFaceList(i)))[fi];
-
-                if (face && face->getViewerObject())
-                {
-                    F32 radius;
-                    F32 cos_angle_to_view_dir;
-
-                    if ((gFrameCount - face->mLastTextureUpdate) > 10)
-                    { // only call calcPixelArea at most once every 10 frames for a given face
-                        // this helps eliminate redundant calls to calcPixelArea for faces that have multiple textures
-                        // assigned to them, such as is the case with GLTF materials or Blinn-Phong materials
-                        face->mInFrustum = face->calcPixelArea(cos_angle_to_view_dir, radius);
-                        face->mLastTextureUpdate = gFrameCount;
-                    }
-
-                    F32 vsize = face->getPixelArea();
-
-                    on_screen |= face->mInFrustum;
-
-                    // Scale desired texture resolution higher or lower depending on texture scale
-                    //
-                    // Minimum usage examples: a 1024x1024 texture with aplhabet (texture atlas),
-                    // runing string shows one letter at a time. If texture has ten 100px symbols
-                    // per side, minimal scale is (100/1024)^2 = 0.0095
-                    //
-                    // Maximum usage examples: huge chunk of terrain repeats texture
-                    // TODO: make this work with the GLTF texture transforms
-                    S32 te_offset = face->getTEOffset();  // offset is -1 if not inited
-                    LLViewerObject* objp = face->getViewerObject();
-                    const LLTextureEntry* te = (te_offset < 0 || te_offset >= objp->getNumTEs()) ? nullptr : objp->getTE(te_offset);
-                    F32 min_scale = te ? llmin(fabsf(te->getScaleS()), fabsf(te->getScaleT())) : 1.f;
-                    min_scale = llclamp(min_scale * min_scale, texture_scale_min(), texture_scale_max());
-                    vsize /= min_scale;
-
-                    // apply bias to offscreen faces all the time, but only to onscreen faces when bias is large
-                    // use mImportanceToCamera to make bias switch a bit more gradual
-                    if (!face->mInFrustum || LLViewerTexture::sDesiredDiscardBias > 1.9f + face->mImportanceToCamera / 2.f)
-                    {
-                        vsize /= bias;
-                    }
-
-                    // boost resolution of textures that are important to the camera
-                    if (face->mInFrustum)
-                    {
-                        static LLCachedControl<F32> texture_camera_boost(gSavedSettings, "TextureCameraBoost", 8.f);
-                        vsize *= llmax(face->mImportanceToCamera*texture_camera_boost, 1.f);
-                    }
-
-                    max_vsize = llmax(max_vsize, vsize);
-
-                    // addTextureStats limits size to sMaxVirtualSize
-                    if (max_vsize >= LLViewerFetchedTexture::sMaxVirtualSize
-                        && (on_screen || LLViewerTexture::sDesiredDiscardBias <= BIAS_TRS_ON_SCREEN))
-                    {
-                        break;
-                    }
-                }
+                continue;
             }
 
-            if (max_vsize >= LLViewerFetchedTexture::sMaxVirtualSize
-                && (on_screen || LLViewerTexture::sDesiredDiscardBias <= BIAS_TRS_ON_SCREEN))
-            {
-                break;
+            if ((gFrameCount - face->mLastTextureUpdate) > 10 && refreshed < MAX_FACES_TO_REFRESH)
+            { // only call calcPixelArea at most once every 10 frames for a given face
+                // this helps eliminate redundant calls to calcPixelArea for faces that have multiple textures
+                // assigned to them, such as is the case with GLTF materials or Blinn-Phong materials
+                F32 radius;
+                F32 cos_angle_to_view_dir;
+                face->mInFrustum = face->calcPixelArea(cos_angle_to_view_dir, radius);
+                face->mLastTextureUpdate = gFrameCount;
+                ++refreshed;
             }
+
+            // Scale desired texture resolution higher or lower depending on texture scale
+            //
+            // Minimum usage examples: a 1024x1024 texture with aplhabet (texture atlas),
+            // runing string shows one letter at a time. If texture has ten 100px symbols
+            // per side, minimal scale is (100/1024)^2 = 0.0095
+            //
+            // Maximum usage examples: huge chunk of terrain repeats texture
+            // TODO: make this work with the GLTF texture transforms
+            S32 te_offset = face->getTEOffset();  // offset is -1 if not inited
+            const LLTextureEntry* te = (te_offset < 0 || te_offset >= objp->getNumTEs()) ? nullptr : objp->getTE(te_offset);
+            F32 min_scale = te ? llmin(fabsf(te->getScaleS()), fabsf(te->getScaleT())) : 1.f;
+
+            batch.addFace(face->getPixelArea(), min_scale, face->mImportanceToCamera, face->mInFrustum);
         }
+    }
+
+    return index;
+}
+
+void LLViewerTextureList::applyImageDecodePriority(LLViewerFetchedTexture* imagep, S32 index, bool flush_images)
+{
+    constexpr F32 BIAS_TRS_OUT_OF_SCREEN = 1.5f;
+    constexpr F32 BIAS_TRS_ON_SCREEN = 1.f;
 
-        if (face_count > max_faces_to_check)
+    if (index >= 0)
+    {
+        F32 max_vsize = mPriorityBatch.getMaxVirtualSize(index);
+        bool on_screen = mPriorityBatch.isOnScreen(index);
+
+        if (imagep->getTotalNumFaces() > MAX_FACES_TO_CHECK)
         { // this texture is used in so many places we should just boost it and not bother checking its vsize
-            // this is especially important because the above is not time sliced and can hit multiple ms for a single texture
             max_vsize = MAX_IMAGE_AREA;
         }
 
@@ -1192,19 +1202,15 @@ F32 LLViewerTextureList::updateImagesLoadingFastCache(F32 max_time)
 
     LLTimer timer;
     image_list_t::iterator enditer = mFastCacheList.begin();
+    for (image_list_t::iterator iter = mFastCacheList.begin();
+        iter != mFastCacheList.end();)
     {
-        // prelock fast cache mutex to avoid waiting multiple times.
-        LLMutexLock cache_lock(LLAppViewer::getTextureCache()->getFastCacheMutex());
-        for (image_list_t::iterator iter = mFastCacheList.begin();
-            iter != mFastCacheList.end();)
-        {
-            image_list_t::iterator curiter = iter++;
-            enditer = iter;
-            LLViewerFetchedTexture* imagep = *curiter;
-            imagep->loadFromFastCache();
-            if (timer.getElapsedTimeF32() > max_time)
-                break;
-        }
+        image_list_t::iterator curiter = iter++;
+        enditer = iter;
+        LLViewerFetchedTexture* imagep = *curiter;
+        imagep->loadFromFastCache();
+        if (timer.getElapsedTimeF32() > max_time)
+            break;
     }
     mFastCacheList.erase(mFastCacheList.begin(), enditer);
     return timer.getElapsedTimeF32();
@@ -1276,19 +1282,40 @@ F32 LLViewerTextureList::updateImagesFetchTextures(F32 max_time)
 
     LLTimer timer;
 
-    for (auto& imagep : entries)
+    // Gather and evaluate a run of textures at a time, so that little is
+    // wasted when the time limit cuts the run short
+    constexpr size_t BATCH_SIZE = 64;
+    const LLTexturePriorityBatch::Params params = texture_priority_params();
+    LL::ThreadPool* pool = LLAppViewer::instance()->getGeneralThreadPool();
+    S32 indices[BATCH_SIZE];
+
+    for (size_t begin = 0; begin < entries.size(); begin += BATCH_SIZE)
     {
-        mLastUpdateKey = LLTextureKey(imagep->getID(), (ETexListType)imagep->getTextureListType());
+        const size_t end = llmin(begin + BATCH_SIZE, entries.size());
 
-        if (imagep->getNumRefs() > 1) // make sure this image hasn't been deleted before attempting to update (may happen as a side effect of some other image updating)
+        mPriorityBatch.clear();
+        for (size_t i = begin; i < end; ++i)
         {
-            updateImageDecodePriority(imagep);
-            imagep->updateFetch();
+            LLViewerFetchedTexture* imagep = entries[i];
+            indices[i - begin] = imagep->getNumRefs() > 1 ? gatherImageDecodePriority(imagep, mPriorityBatch) : -1;
         }
+        mPriorityBatch.compute(params, pool);
 
-        if (timer.getElapsedTimeF32() > max_time)
+        for (size_t i = begin; i < end; ++i)
         {
-            break;
+            LLViewerFetchedTexture* imagep = entries[i];
+            mLastUpdateKey = LLTextureKey(imagep->getID(), (ETexListType)imagep->getTextureListType());
+
+            if (imagep->getNumRefs() > 1) // make sure this image hasn't been deleted before attempting to update (may happen as a side effect of some other image updating)
+            {
+                applyImageDecodePriority(imagep, indices[i - begin], true);
+                imagep->updateFetch();
+            }
+
+            if (timer.getElapsedTimeF32() > max_time)
+            {
+                return timer.getElapsedTimeF32();
+            }
         }
     }
 
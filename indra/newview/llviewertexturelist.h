@@ -31,6 +31,7 @@
 //#include "message.h"
 #include "llgl.h"
 #include "llviewertexture.h"
+#include "lltexturepriority.h"
 #include "llui.h"
 #include <list>
 #include <unordered_set>
@@ -148,6 +149,12 @@ public:
     void updateImageDecodePriority(LLViewerFetchedTexture* imagep, bool flush_images = true);
 
 private:
+    // appends the faces of imagep to batch, returns its index there or -1
+    // for boosted textures, whose priority doesn't depend on their faces
+    S32  gatherImageDecodePriority(LLViewerFetchedTexture* imagep, LLTexturePriorityBatch& batch);
+    // the rest of updateImageDecodePriority once mPriorityBatch is computed
+    void applyImageDecodePriority(LLViewerFetchedTexture* imagep, S32 index, bool flush_images);
+
     F32  updateImagesCreateTextures(F32 max_time);
     F32  updateImagesFetchTextures(F32 max_time);
     void updateImagesUpdateStats();
@@ -230,6 +237,7 @@ private:
     typedef std::map< LLTextureKey, LLPointer<LLViewerFetchedTexture> > uuid_map_t;
     uuid_map_t mUUIDMap;
     LLTextureKey mLastUpdateKey;
+    LLTexturePriorityBatch mPriorityBatch;
 
     image_list_t mImageList;
 
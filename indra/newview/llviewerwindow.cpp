@@ -726,6 +726,13 @@ public:
                 addText(xpos, ypos, llformat("%.3f/%.3f MB Mesh Cache Read/Write ", LLMeshRepository::sCacheBytesRead/(1024.f*1024.f), LLMeshRepository::sCacheBytesWritten/(1024.f*1024.f)));
                 ypos += y_inc;
 
+                U32 decoded_hits = LLMeshRepository::sDecodedCacheHits;
+                U32 decoded_misses = LLMeshRepository::sDecodedCacheMisses;
+                addText(xpos, ypos, llformat("%d/%d Mesh Decoded Cache Hits/Misses (%.0f%%), %.1f s decode saved", decoded_hits, decoded_misses,
+                    decoded_hits + decoded_misses ? 100.f * decoded_hits / (decoded_hits + decoded_misses) : 0.f,
+                    LLMeshRepository::sDecodedCacheUsecSaved / 1000000.f));
+                ypos += y_inc;
+
                 addText(xpos, ypos, llformat("%.3f/%.3f MB Mesh Skins/Decompositions Memory", LLMeshRepository::sCacheBytesSkins / (1024.f*1024.f), LLMeshRepository::sCacheBytesDecomps / (1024.f*1024.f)));
                 ypos += y_inc;
 
@@ -35,6 +35,9 @@
 #include "llframetimer.h"
 #include "llsurface.h"
 #include "llbitpack.h"
+#include "llappviewer.h"
+#include "llviewercontrol.h"
+#include "threadpool.h"
 
 const   char    LAND_LAYER_CODE                 = 'L';
 const   char    WIND_LAYER_CODE                 = '7';
@@ -80,23 +83,57 @@ void LLVLManager::addLayerData(LLVLData *vl_datap, const S32Bytes mesg_size)
 
 void LLVLManager::unpackData(const S32 num_packets)
 {
+    LL_PROFILE_ZONE_SCOPED;
     static LLFrameTimer decode_timer;
+    static LLCachedControl<bool> parallel_update(gSavedSettings, "TerrainParallelUpdate", true);
+
+    // Land packets are decoded on the general pool, as they touch nothing
+    // but their own data; the results are then applied in arrival order.
+    std::vector<LLVLData *> land_packets;
+    for (LLVLData *datap : mPacketData)
+    {
+        if (LAND_LAYER_CODE == datap->mType)
+        {
+            land_packets.push_back(datap);
+        }
+    }
+
+    std::vector<LLDecodedPatches> land_patches(land_packets.size());
+    auto decode_land = [&land_packets, &land_patches](size_t n)
+    {
+        LLVLData *datap = land_packets[n];
+        LLBitPack bit_pack(datap->mData, datap->mSize);
+        decode_patches(bit_pack, datap->mRegionp->getLand().getPatchesPerEdge(), land_patches[n]);
+    };
+    LL::ThreadPool *pool = parallel_update ? LLAppViewer::instance()->getGeneralThreadPool() : nullptr;
+    if (pool && land_packets.size() > 1)
+    {
+        pool->forkJoin(land_packets.size(), decode_land);
+    }
+    else
+    {
+        for (size_t n = 0; n < land_packets.size(); n++)
+        {
+            decode_land(n);
+        }
+    }
 
     S32 i;
+    size_t land = 0;
     for (i = 0; i < mPacketData.size(); i++)
     {
         LLVLData *datap = mPacketData[i];
 
-        LLBitPack bit_pack(datap->mData, datap->mSize);
-        LLGroupHeader goph;
-
-        decode_patch_group_header(bit_pack, &goph);
         if (LAND_LAYER_CODE == datap->mType)
         {
-            datap->mRegionp->getLand().decompressDCTPatch(bit_pack, &goph, false);
+            datap->mRegionp->getLand().applyDecodedPatches(land_patches[land++]);
         }
         else if (WIND_LAYER_CODE == datap->mType)
         {
+            LLBitPack bit_pack(datap->mData, datap->mSize);
+            LLGroupHeader goph;
+
+            decode_patch_group_header(bit_pack, &goph);
             datap->mRegionp->mWind.decompress(bit_pack, &goph);
 
         }
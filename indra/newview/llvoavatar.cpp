@@ -100,6 +100,7 @@
 #include "llanimstatelabels.h"
 #include "lltrans.h"
 #include "llappearancemgr.h"
+#include "llappviewer.h"
 
 //BD
 #include "llfloaterreg.h"
@@ -631,6 +632,7 @@ bool LLVOAvatar::sVisibleInFirstPerson = false;
 F32 LLVOAvatar::sLODFactor = 1.f;
 F32 LLVOAvatar::sPhysicsLODFactor = 1.f;
 bool LLVOAvatar::sJointDebug            = false;
+std::vector<LLVOAvatar*> LLVOAvatar::sDeferredIdleUpdates;
 F32 LLVOAvatar::sUnbakedTime = 0.f;
 F32 LLVOAvatar::sUnbakedUpdateTime = 0.f;
 F32 LLVOAvatar::sGreyTime = 0.f;
@@ -3105,7 +3107,22 @@ void LLVOAvatar::idleUpdate(LLAgent &agent, const F64 &time)
     // store off last frame's root position to be consistent with camera position
     mLastRootPos = mRoot->getWorldPosition();
     bool detailed_update = updateCharacter(agent);
+    if (mMotionUpdateDeferred)
+    {
+        // finishDeferredIdleUpdates() continues from here
+        mDeferredDetailedUpdate = detailed_update;
+        return;
+    }
 
+    idleUpdatePostCharacter(detailed_update);
+}
+
+//-----------------------------------------------------------------------------
+// idleUpdatePostCharacter()
+// the part of idleUpdate() that depends on the evaluated pose
+//-----------------------------------------------------------------------------
+void LLVOAvatar::idleUpdatePostCharacter(bool detailed_update)
+{
     static LLUICachedControl<bool> visualizers_in_calls("ShowVoiceVisualizersInCalls", false);
     bool voice_enabled = (visualizers_in_calls || LLVoiceClient::getInstance()->inProximalChannel()) &&
                          LLVoiceClient::getInstance()->getVoiceEnabled(mID);
@@ -3281,7 +3298,7 @@ void LLVOAvatar::idleUpdateMisc(bool detailed_update)
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
     if (LLVOAvatar::sJointDebug)
     {
-        LL_INFOS() << getDebugName() << ": joint touches: " << LLJoint::sNumTouches << " updates: " << LLJoint::sNumUpdates << LL_ENDL;
+        LL_INFOS() << getDebugName() << ": joint touches: " << LLJoint::sNumTouches.CurrentValue() << " updates: " << LLJoint::sNumUpdates.CurrentValue() << LL_ENDL;
     }
 
     LLJoint::sNumUpdates = 0;
@@ -4166,7 +4183,7 @@ void LLVOAvatar::slamPosition()
     {
         gPipeline.updateMoveNormalAsync(mDrawable);
     }
-    mRoot->updateWorldMatrixChildren();
+    updateJointWorldMatrices();
 }
 
 bool LLVOAvatar::isVisuallyMuted()
@@ -5177,12 +5194,30 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
     {
         updateMotions(LLCharacter::FORCE_UPDATE);
     }
+    else if (canDeferMotionUpdate())
+    {
+        mMotionUpdateDeferred = true;
+        mDeferredMotionEvaluate = beginUpdateMotions(LLCharacter::NORMAL_UPDATE, true);
+        mDeferredWasSitGroundConstrained = was_sit_ground_constrained;
+        mDeferredVisible = visible;
+        sDeferredIdleUpdates.push_back(this);
+        return visible;
+    }
     else
     {
         // Might be better to do HIDDEN_UPDATE if cloud
         updateMotions(LLCharacter::NORMAL_UPDATE);
     }
 
+    return finishUpdateCharacter(was_sit_ground_constrained, visible);
+}
+
+//-----------------------------------------------------------------------------
+// finishUpdateCharacter()
+// the part of updateCharacter() that follows the motion update
+//-----------------------------------------------------------------------------
+bool LLVOAvatar::finishUpdateCharacter(bool was_sit_ground_constrained, bool visible)
+{
     // Special handling for sitting on ground.
     if (!getParent() && (isSitting() || was_sit_ground_constrained))
     {
@@ -5205,7 +5240,7 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
     updateFootstepSounds();
 
     // Update child joints as needed.
-    mRoot->updateWorldMatrixChildren();
+    updateJointWorldMatrices();
 
     if (visible)
     {
@@ -5216,6 +5251,59 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
     return visible;
 }
 
+//-----------------------------------------------------------------------------
+// canDeferMotionUpdate()
+//-----------------------------------------------------------------------------
+bool LLVOAvatar::canDeferMotionUpdate() const
+{
+    static LLCachedControl<bool> parallel_animation(gSavedSettings, "AvatarParallelAnimation", false);
+    // self drives agent state from its motions and control avatars may be
+    // attached to another avatar's joints; both stay on the serial path
+    return parallel_animation
+        && !isSelf()
+        && !isUIAvatar()
+        && !isControlAvatar()
+        && mSpecialRenderMode == 0;
+}
+
+//-----------------------------------------------------------------------------
+// finishDeferredIdleUpdates()
+//-----------------------------------------------------------------------------
+// static
+void LLVOAvatar::finishDeferredIdleUpdates()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    if (sDeferredIdleUpdates.empty())
+    {
+        return;
+    }
+
+    std::vector<LLCharacter*> characters;
+    characters.reserve(sDeferredIdleUpdates.size());
+    for (LLVOAvatar* avatar : sDeferredIdleUpdates)
+    {
+        if (avatar->mDeferredMotionEvaluate && !avatar->isDead())
+        {
+            characters.push_back(avatar);
+        }
+    }
+    LLCharacter::evaluateMotions(characters, LLAppViewer::instance()->getGeneralThreadPool());
+
+    for (LLVOAvatar* avatar : sDeferredIdleUpdates)
+    {
+        avatar->mMotionUpdateDeferred = false;
+        avatar->mDeferredMotionEvaluate = false;
+        if (avatar->isDead())
+        {
+            continue;
+        }
+        avatar->finishUpdateMotions();
+        avatar->finishUpdateCharacter(avatar->mDeferredWasSitGroundConstrained, avatar->mDeferredVisible);
+        avatar->idleUpdatePostCharacter(avatar->mDeferredDetailedUpdate);
+    }
+    sDeferredIdleUpdates.clear();
+}
+
 //-----------------------------------------------------------------------------
 // updateHeadOffset()
 //-----------------------------------------------------------------------------
@@ -5313,7 +5401,7 @@ void LLVOAvatar::debugBodySize() const
 //------------------------------------------------------------------------
 void LLVOAvatar::postPelvisSetRecalc()
 {
-    mRoot->updateWorldMatrixChildren();
+    updateJointWorldMatrices();
     //BD - Poser
     static LLCachedControl<bool> exp_scaling(gSavedSettings, "MouselookExperimentalHeadScaling");
     if (!(getPosing() || (gAgentCamera.cameraMouselook() && exp_scaling)))
@@ -7356,6 +7444,11 @@ void LLVOAvatar::getGround(const LLVector3 &in_pos_agent, LLVector3 &out_pos_age
         return;
     }
 
+    // motions (foot planting, ground constraints) may call this from
+    // several avatars' parallel pose evaluation at once
+    static LLMutex ground_mutex;
+    LLMutexLock lock(&ground_mutex);
+
     p0_global = gAgent.getPosGlobalFromAgent(in_pos_agent) + z_vec;
     p1_global = gAgent.getPosGlobalFromAgent(in_pos_agent) - z_vec;
     LLViewerObject *obj;
@@ -7554,7 +7647,7 @@ void LLVOAvatar::updateVisualParams()
 			computeBodySize();
 		}
         mLastSkeletonSerialNum = mSkeletonSerialNum;
-        mRoot->updateWorldMatrixChildren();
+        updateJointWorldMatrices();
     }
 
     dirtyMesh();
@@ -8310,7 +8403,7 @@ void LLVOAvatar::sitOnObject(LLViewerObject *sit_object)
     mRoot->getXform()->setParent(&sit_object->mDrawable->mXform); // LLVOAvatar::sitOnObject
     // SL-315
     mRoot->setPosition(getPosition());
-    mRoot->updateWorldMatrixChildren();
+    updateJointWorldMatrices();
 
     stopMotion(ANIM_AGENT_BODY_NOISE);
 
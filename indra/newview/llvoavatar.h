@@ -280,12 +280,14 @@ public:
     virtual void    updateDebugText();
     virtual bool    computeNeedsUpdate();
     virtual bool    updateCharacter(LLAgent &agent);
+    bool            finishUpdateCharacter(bool was_sit_ground_constrained, bool visible);
     void            updateFootstepSounds();
     void            computeUpdatePeriod();
     void            updateOrientation(LLAgent &agent, F32 speed, F32 delta_time);
     void            updateTimeStep();
     void            updateRootPositionAndRotation(LLAgent &agent, F32 speed, bool was_sit_ground_constrained);
 
+    void            idleUpdatePostCharacter(bool detailed_update);
     void            idleUpdateVoiceVisualizer(bool voice_enabled, const LLVector3 &position);
     void            idleUpdateMisc(bool detailed_update);
     virtual void    idleUpdateAppearanceAnimation();
@@ -303,6 +305,22 @@ public:
     void            addNameTagLine(const std::string& line, const LLColor4& color, S32 style, const LLFontGL* font, const bool use_ellipses = false);
     void            idleUpdateRenderComplexity();
     void            idleUpdateDebugInfo();
+
+    // With "AvatarParallelAnimation" on, updateCharacter() stops after
+    // beginning the motion update of eligible avatars and queues them;
+    // this evaluates the queued poses on the general thread pool and then
+    // runs the rest of each avatar's idle update, in queue order.
+    static void     finishDeferredIdleUpdates();
+private:
+    bool            canDeferMotionUpdate() const;
+
+    static std::vector<LLVOAvatar*> sDeferredIdleUpdates;
+    bool            mMotionUpdateDeferred = false;
+    bool            mDeferredMotionEvaluate = false;
+    bool            mDeferredWasSitGroundConstrained = false;
+    bool            mDeferredVisible = false;
+    bool            mDeferredDetailedUpdate = false;
+public:
     void            accountRenderComplexityForObject(LLViewerObject *attached_object,
                                                      const F32 max_attachment_complexity,
                                                      LLVOVolume::texture_cost_t& textures,
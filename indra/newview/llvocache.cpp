@@ -33,6 +33,7 @@
 #include "llviewerregion.h"
 #include "llagentcamera.h"
 #include "llsdserialize.h"
+#include "llmappedfile.h"
 #include "llworld.h" // For LLWorld::getInstance()
 //static variables
 U32 LLVOCacheEntry::sMinFrameRange = 0;
@@ -259,6 +260,56 @@ LLVOCacheEntry::LLVOCacheEntry(LLAPRFile* apr_file)
     }
 }
 
+LLVOCacheEntry::LLVOCacheEntry(const U8* data, S64 data_size)
+:   LLViewerOctreeEntryData(LLViewerOctreeEntry::LLVOCACHEENTRY),
+    mBuffer(NULL),
+    mUpdateFlags(-1),
+    mState(INACTIVE),
+    mSceneContrib(0.f),
+    mValid(false),
+    mParentID(0),
+    mBSphereRadius(-1.0f)
+{
+    S32 size = -1;
+    bool success = data_size >= ENTRY_HEADER_SIZE;
+
+    mDP.assignBuffer(mBuffer, 0);
+
+    if (success)
+    {
+        memcpy(&mLocalID, data, sizeof(U32));
+        memcpy(&mCRC, data + sizeof(U32), sizeof(U32));
+        memcpy(&mHitCount, data + (2 * sizeof(U32)), sizeof(S32));
+        memcpy(&mDupeCount, data + (3 * sizeof(U32)), sizeof(S32));
+        memcpy(&mCRCChangeCount, data + (4 * sizeof(U32)), sizeof(S32));
+        memcpy(&size, data + (5 * sizeof(U32)), sizeof(S32));
+
+        if ((size > MAX_ENTRY_BODY_SIZE) || (size < 1) || (size > data_size - ENTRY_HEADER_SIZE))
+        {
+            LL_WARNS() << "Bogus cache entry, size " << size << ", aborting!" << LL_ENDL;
+            success = false;
+        }
+    }
+
+    if (success)
+    {
+        // copied out, the data packer must not point into the read only mapping
+        mBuffer = new U8[size];
+        memcpy(mBuffer, data + ENTRY_HEADER_SIZE, size);
+        mDP.assignBuffer(mBuffer, size);
+    }
+    else
+    {
+        mLocalID = 0;
+        mCRC = 0;
+        mHitCount = 0;
+        mDupeCount = 0;
+        mCRCChangeCount = 0;
+        mEntry = NULL;
+        mState = INACTIVE;
+    }
+}
+
 LLVOCacheEntry::~LLVOCacheEntry()
 {
     mDP.freeBuffer();
@@ -430,6 +481,11 @@ void LLVOCacheEntry::dump() const
         << LL_ENDL;
 }
 
+S32 LLVOCacheEntry::getRecordSize() const
+{
+    return ENTRY_HEADER_SIZE + mDP.getBufferSize();
+}
+
 S32 LLVOCacheEntry::writeToBuffer(U8 *data_buffer) const
 {
     S32 size = mDP.getBufferSize();
@@ -446,7 +502,7 @@ S32 LLVOCacheEntry::writeToBuffer(U8 *data_buffer) const
     memcpy(data_buffer + (3 * sizeof(U32)), &mDupeCount, sizeof(S32));
     memcpy(data_buffer + (4 * sizeof(U32)), &mCRCChangeCount, sizeof(S32));
     memcpy(data_buffer + (5 * sizeof(U32)), &size, sizeof(S32));
-    memcpy(data_buffer + ENTRY_HEADER_SIZE, (void*)mBuffer, size);
+    memcpy(data_buffer + ENTRY_HEADER_SIZE, mBuffer, size);
 
     return ENTRY_HEADER_SIZE + size;
 }
@@ -706,6 +762,39 @@ void LLVOCacheEntry::updateParentBoundingInfo(const LLVOCacheEntry* child)
     size.mul(0.5f);
     setBinRadius(llmin(size.getLength3().getF32() * 4.f, 256.f));
 }
+
+//---------------------------------------------------------------------------
+// LLVOCachePackEntries
+//---------------------------------------------------------------------------
+
+void LLVOCachePackEntries::clear()
+{
+    mOffsets.clear();
+    mMapping.reset();
+}
+
+LLPointer<LLVOCacheEntry> LLVOCachePackEntries::take(U32 local_id)
+{
+    auto iter = mOffsets.find(local_id);
+    if (iter == mOffsets.end())
+    {
+        return NULL;
+    }
+
+    U64 offset = iter->second;
+    mOffsets.erase(iter);
+    LLPointer<LLVOCacheEntry> entry = new LLVOCacheEntry(mMapping->getData() + offset, (S64)(mMapping->getSize() - offset));
+    if (mOffsets.empty())
+    {
+        mMapping.reset();
+    }
+    if (!entry->getLocalID())
+    {
+        return NULL;
+    }
+    return entry;
+}
+
 //-------------------------------------------------------------------
 //LLVOCachePartition
 //-------------------------------------------------------------------
@@ -1148,6 +1237,11 @@ const U32 MIN_ENTRIES_TO_PURGE = 16 ;
 const U32 INVALID_TIME = 0 ;
 const char* object_cache_dirname = "objectcache";
 const char* header_filename = "object.cache";
+const char* pack_filename = "objects.pack";
+
+const U32 PACK_MAGIC = 0x4B50434F; // "OCPK"
+const U64 MAX_PACK_SIZE = 0x40000000; // LLAPRFile seeks are 32 bits, keep well below that.
+const U64 MIN_DEAD_BYTES_TO_COMPACT = 4 * 1024 * 1024;
 
 
 LLVOCache::LLVOCache(bool read_only) :
@@ -1155,10 +1249,12 @@ LLVOCache::LLVOCache(bool read_only) :
     mReadOnly(read_only),
     mNumEntries(0),
     mCacheSize(1),
-    mEnabled(true)
+    mEnabled(true),
+    mUsePack(false)
 {
 #ifndef LL_TEST
     mEnabled = gSavedSettings.getBOOL("ObjectCacheEnabled");
+    mUsePack = gSavedSettings.getBOOL("ObjectCachePackFormat");
 #endif
     mLocalAPRFilePoolp = new LLVolatileAPRPool() ;
 }
@@ -1177,6 +1273,13 @@ void LLVOCache::setDirNames(ELLPath location)
 {
     mHeaderFileName = gDirUtilp->getExpandedFilename(location, object_cache_dirname, header_filename);
     mObjectCacheDirName = gDirUtilp->getExpandedFilename(location, object_cache_dirname);
+    mPackFileName = gDirUtilp->getExpandedFilename(location, object_cache_dirname, pack_filename);
+}
+
+void LLVOCache::setPackFormat(bool use_pack)
+{
+    llassert(!mInitialized);
+    mUsePack = use_pack;
 }
 
 void LLVOCache::initCache(ELLPath location, U32 size, U32 cache_version)
@@ -1249,6 +1352,7 @@ void LLVOCache::removeCache(ELLPath location, bool started)
     std::string mask = "*";
     std::string cache_dir = gDirUtilp->getExpandedFilename(location, object_cache_dirname);
     LL_INFOS() << "Removing cache at " << cache_dir << LL_ENDL;
+    mPackMapping.reset();
     gDirUtilp->deleteFilesInDir(cache_dir, mask); //delete all files
     LLFile::rmdir(cache_dir);
 
@@ -1272,6 +1376,7 @@ void LLVOCache::removeCache()
 
     std::string mask = "*";
     LL_INFOS() << "Removing object cache at " << mObjectCacheDirName << LL_ENDL;
+    mPackMapping.reset();
     gDirUtilp->deleteFilesInDir(mObjectCacheDirName, mask);
 
     clearCacheInMemory() ;
@@ -1337,6 +1442,8 @@ void LLVOCache::clearCacheInMemory()
         mNumEntries = 0 ;
     }
 
+    mPackHeader = PackHeader();
+    mPackSlots.clear();
 }
 
 void LLVOCache::getObjectCacheFilename(U64 handle, std::string& filename)
@@ -1368,9 +1475,22 @@ void LLVOCache::removeFromCache(HeaderEntryInfo* entry)
     }
 
     std::string filename;
-    getObjectCacheFilename(entry->mHandle, filename);
-    LL_WARNS("GLTF", "VOCache") << "Removing object cache for handle " << entry->mHandle << "Filename: " << filename << LL_ENDL;
-    LLAPRFile::remove(filename, mLocalAPRFilePoolp);
+    if (mUsePack)
+    {
+        // the blob stays in the pack as dead space until the next compaction.
+        pack_slot_map_t::iterator iter = mPackSlots.find(entry->mHandle);
+        if (iter != mPackSlots.end())
+        {
+            mPackHeader.mDeadBytes += iter->second.mSize;
+            mPackSlots.erase(iter);
+        }
+    }
+    else
+    {
+        getObjectCacheFilename(entry->mHandle, filename);
+        LL_WARNS("GLTF", "VOCache") << "Removing object cache for handle " << entry->mHandle << "Filename: " << filename << LL_ENDL;
+        LLAPRFile::remove(filename, mLocalAPRFilePoolp);
+    }
 
     // Note: `removeFromCache` should take responsibility for cleaning up all cache artefacts specfic to the handle/entry.
     // as such this now includes the generic extras
@@ -1390,6 +1510,12 @@ void LLVOCache::readCacheHeader()
         return;
     }
 
+    if (mUsePack)
+    {
+        readPackIndex();
+        return;
+    }
+
     //clear stale info.
     clearCacheInMemory();
 
@@ -1479,6 +1605,12 @@ void LLVOCache::writeCacheHeader()
         return;
     }
 
+    if (mUsePack)
+    {
+        writePackIndex();
+        return;
+    }
+
     bool success = true ;
     {
         LLAPRFile apr_file(mHeaderFileName, APR_CREATE|APR_WRITE|APR_BINARY, mLocalAPRFilePoolp);
@@ -1519,6 +1651,11 @@ void LLVOCache::writeCacheHeader()
 
 bool LLVOCache::updateEntry(const HeaderEntryInfo* entry)
 {
+    if (mUsePack)
+    {
+        return updatePackSlot(entry);
+    }
+
     LLAPRFile apr_file(mHeaderFileName, APR_WRITE|APR_BINARY, mLocalAPRFilePoolp);
     apr_file.seek(APR_SET, entry->mIndex * sizeof(HeaderEntryInfo) + sizeof(HeaderMetaInfo)) ;
 
@@ -1527,7 +1664,7 @@ bool LLVOCache::updateEntry(const HeaderEntryInfo* entry)
 
 // we now return bool to trigger dirty cache
 // this in turn forces a rewrite after a partial read due to corruption.
-bool LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map)
+bool LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVOCachePackEntries* pack_entries)
 {
     if(!mEnabled)
     {
@@ -1546,6 +1683,12 @@ bool LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::voca
     bool success = true ;
     S32 num_entries = 0 ; // lifted out of inner loop.
     std::string filename; // lifted out of loop
+    if (mUsePack)
+    {
+        filename = mPackFileName;
+        success = readFromPack(handle, id, cache_entry_map, pack_entries, num_entries);
+    }
+    else
     {
         LLUUID cache_id;
         getObjectCacheFilename(handle, filename);
@@ -1596,7 +1739,7 @@ bool LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::voca
 }
 
 // We now pass in the cache entry map, so that we can remove entries from extras that are no longer in the primary cache.
-void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map)
+void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, const LLVOCachePackEntries* pack_entries)
 {
     int loaded= 0;
     int discarded = 0;
@@ -1708,7 +1851,7 @@ void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCac
         U32 local_id = entry_llsd["local_id"].asInteger();
         // only add entries that exist in the primary cache
         // this is a self-healing test that avoids us polluting the cache with entries that are no longer valid based on the main cache.
-        if(cache_entry_map.find(local_id)!= cache_entry_map.end())
+        if(cache_entry_map.find(local_id)!= cache_entry_map.end() || (pack_entries && pack_entries->has(local_id)))
         {
             // attempt to backfill a null objectId, though these shouldn't be in the persisted cache really
             if(entry.mObjectId.isNull() && pRegion)
@@ -1741,7 +1884,7 @@ void LLVOCache::purgeEntries(U32 size)
     mNumEntries = static_cast<U32>(mHandleEntryMap.size());
 }
 
-void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, bool dirty_cache, bool removal_enabled)
+void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, bool dirty_cache, bool removal_enabled, const LLVOCachePackEntries* pack_entries)
 {
     std::string filename;
     getObjectCacheFilename(handle, filename);
@@ -1770,7 +1913,8 @@ void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry:
         entry = new HeaderEntryInfo();
         entry->mHandle = handle ;
         entry->mTime = (U32)time(NULL) ;
-        entry->mIndex = mNumEntries++;
+        entry->mIndex = mUsePack ? getFreePackSlot() : mNumEntries;
+        mNumEntries++;
         mHeaderEntryQueue.insert(entry) ;
         mHandleEntryMap[handle] = entry ;
     }
@@ -1799,6 +1943,15 @@ void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry:
         return ; //nothing changed, no need to update.
     }
 
+    if (mUsePack)
+    {
+        if (!writeToPack(entry, id, cache_entry_map, pack_entries, removal_enabled))
+        {
+            removeEntry(entry);
+        }
+        return;
+    }
+
     //write to cache file
     bool success = true ;
     {
@@ -1990,3 +2143,546 @@ void LLVOCache::writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LL
     }
     LL_DEBUGS("GLTF") << "Completed writing extras cache for handle " << handle << ", " << num_entries << " entries. Total in RAM: " << inmem_entries << " skipped (no persist): " << skipped << LL_ENDL;
 }
+
+//-------------------------------------------------------------------
+// Single file object cache
+//-------------------------------------------------------------------
+//static
+U64 LLVOCache::getPackDataStart()
+{
+    return sizeof(PackHeader) + MAX_NUM_OBJECT_ENTRIES * sizeof(PackSlot);
+}
+
+void LLVOCache::readPackIndex()
+{
+    //clear stale info.
+    clearCacheInMemory();
+    mPackMapping.reset();
+
+    if (!LLAPRFile::isExist(mPackFileName, mLocalAPRFilePoolp))
+    {
+        if (!mReadOnly && LLAPRFile::isExist(mHeaderFileName, mLocalAPRFilePoolp))
+        {
+            importLegacyCache();
+        }
+        else
+        {
+            writePackIndex();
+        }
+        return;
+    }
+
+    bool success = true;
+    {
+        S32 file_size = LLAPRFile::size(mPackFileName, mLocalAPRFilePoolp);
+        LLAPRFile apr_file(mPackFileName, APR_READ|APR_BINARY, mLocalAPRFilePoolp);
+
+        success = check_read(&apr_file, &mPackHeader, sizeof(PackHeader))
+            && mPackHeader.mMagic == PACK_MAGIC
+            && mPackHeader.mNumSlots == MAX_NUM_OBJECT_ENTRIES
+            && mPackHeader.mDataEnd >= getPackDataStart()
+            && mPackHeader.mDataEnd <= (U64)file_size;
+
+        std::vector<PackSlot> slots(MAX_NUM_OBJECT_ENTRIES);
+        if (success)
+        {
+            mMetaInfo = mPackHeader.mMetaInfo;
+            success = check_read(&apr_file, slots.data(), MAX_NUM_OBJECT_ENTRIES * sizeof(PackSlot));
+        }
+
+        for (U32 i = 0; success && i < MAX_NUM_OBJECT_ENTRIES; ++i)
+        {
+            const PackSlot& slot = slots[i];
+            if (slot.mTime == INVALID_TIME)
+            {
+                continue; //an empty slot
+            }
+
+            if (slot.mOffset < getPackDataStart() || slot.mSize > mPackHeader.mDataEnd - slot.mOffset
+                || mHandleEntryMap.find(slot.mHandle) != mHandleEntryMap.end())
+            {
+                LL_WARNS() << "Bogus object cache pack slot " << i << ", handle " << slot.mHandle << LL_ENDL;
+                success = false;
+                break;
+            }
+
+            HeaderEntryInfo* entry = new HeaderEntryInfo();
+            entry->mIndex = i;
+            entry->mHandle = slot.mHandle;
+            entry->mTime = slot.mTime;
+            mHeaderEntryQueue.insert(entry);
+            mHandleEntryMap[entry->mHandle] = entry;
+            mPackSlots[slot.mHandle] = slot;
+            mNumEntries++;
+        }
+    }
+
+    if (!success)
+    {
+        LL_WARNS() << "Error reading object cache pack " << mPackFileName << ", clearing cache." << LL_ENDL;
+        removeCache(); //failed to read the index, clear the cache
+        return;
+    }
+
+    if (mNumEntries >= mCacheSize)
+    {
+        purgeEntries(mCacheSize);
+    }
+
+    // nothing views the pack yet, good time to drop the dead blobs.
+    if (mPackHeader.mDeadBytes > MIN_DEAD_BYTES_TO_COMPACT
+        && mPackHeader.mDeadBytes > mPackHeader.mDataEnd / 2)
+    {
+        compactPack();
+    }
+}
+
+void LLVOCache::writePackIndex()
+{
+    bool success = true;
+    {
+        LLAPRFile apr_file(mPackFileName, APR_CREATE|APR_WRITE|APR_BINARY, mLocalAPRFilePoolp);
+        success = writePackIndex(apr_file);
+    }
+
+    if (!success)
+    {
+        clearCacheInMemory();
+        mReadOnly = true; //disable the cache.
+    }
+}
+
+bool LLVOCache::writePackIndex(LLAPRFile& apr_file)
+{
+    mPackHeader.mMagic = PACK_MAGIC;
+    mPackHeader.mNumSlots = MAX_NUM_OBJECT_ENTRIES;
+    mPackHeader.mMetaInfo = mMetaInfo;
+    if (mPackHeader.mDataEnd < getPackDataStart())
+    {
+        mPackHeader.mDataEnd = getPackDataStart();
+    }
+
+    std::vector<PackSlot> slots(MAX_NUM_OBJECT_ENTRIES);
+    for (header_entry_queue_t::iterator iter = mHeaderEntryQueue.begin(); iter != mHeaderEntryQueue.end(); ++iter)
+    {
+        const HeaderEntryInfo* entry = *iter;
+        llassert(entry->mIndex >= 0 && entry->mIndex < (S32)MAX_NUM_OBJECT_ENTRIES);
+
+        PackSlot& slot = slots[entry->mIndex];
+        pack_slot_map_t::const_iterator slot_iter = mPackSlots.find(entry->mHandle);
+        if (slot_iter != mPackSlots.end())
+        {
+            slot = slot_iter->second;
+        }
+        slot.mHandle = entry->mHandle;
+        slot.mTime = entry->mTime;
+    }
+    mNumEntries = static_cast<U32>(mHeaderEntryQueue.size());
+
+    return apr_file.seek(APR_SET, 0) == 0
+        && check_write(&apr_file, &mPackHeader, sizeof(PackHeader))
+        && check_write(&apr_file, slots.data(), MAX_NUM_OBJECT_ENTRIES * sizeof(PackSlot));
+}
+
+bool LLVOCache::updatePackSlot(const HeaderEntryInfo* entry)
+{
+    PackSlot slot;
+    pack_slot_map_t::const_iterator iter = mPackSlots.find(entry->mHandle);
+    if (iter != mPackSlots.end())
+    {
+        slot = iter->second;
+    }
+    slot.mHandle = entry->mHandle;
+    slot.mTime = entry->mTime;
+
+    LLAPRFile apr_file(mPackFileName, APR_WRITE|APR_BINARY, mLocalAPRFilePoolp);
+    if (!check_write(&apr_file, &mPackHeader, sizeof(PackHeader)))
+    {
+        return false;
+    }
+
+    S32 offset = (S32)(sizeof(PackHeader) + entry->mIndex * sizeof(PackSlot));
+    return apr_file.seek(APR_SET, offset) == offset
+        && check_write(&apr_file, &slot, sizeof(PackSlot));
+}
+
+S32 LLVOCache::getFreePackSlot() const
+{
+    std::vector<bool> used(MAX_NUM_OBJECT_ENTRIES, false);
+    for (header_entry_queue_t::const_iterator iter = mHeaderEntryQueue.begin(); iter != mHeaderEntryQueue.end(); ++iter)
+    {
+        used[(*iter)->mIndex] = true;
+    }
+
+    for (U32 i = 0; i < MAX_NUM_OBJECT_ENTRIES; ++i)
+    {
+        if (!used[i])
+        {
+            return i;
+        }
+    }
+
+    llassert(false); // purgeEntries() keeps us below MAX_NUM_OBJECT_ENTRIES
+    return 0;
+}
+
+std::shared_ptr<LLMappedFile> LLVOCache::getPackMapping(U64 min_size)
+{
+    if (!mPackMapping || mPackMapping->getSize() < min_size)
+    {
+        // the pack grew since it was mapped, regions still reading entries from the old mapping keep it alive.
+        if (mPackMapping)
+        {
+            mRetiredPackMappings.push_back(mPackMapping);
+        }
+
+        // writeToPack() appends through the mapping, growing the file to min_size
+        mPackMapping = std::make_shared<LLMappedFile>();
+        bool mapped = mReadOnly ? mPackMapping->open(mPackFileName)
+                                : mPackMapping->openWritable(mPackFileName, min_size);
+        if (!mapped || mPackMapping->getSize() < min_size)
+        {
+            LL_WARNS() << "Failed to map object cache pack " << mPackFileName << LL_ENDL;
+            mPackMapping.reset();
+        }
+    }
+
+    return mPackMapping;
+}
+
+// Returns the size of the entry record at data, header included, or 0 if the
+// record is damaged.
+static S32 get_entry_record_size(const U8* data, S64 data_size, U32& local_id)
+{
+    if (data_size < ENTRY_HEADER_SIZE)
+    {
+        return 0;
+    }
+
+    S32 size;
+    memcpy(&local_id, data, sizeof(U32));
+    memcpy(&size, data + (5 * sizeof(U32)), sizeof(S32));
+    if (!local_id || (size > MAX_ENTRY_BODY_SIZE) || (size < 1) || (size > data_size - ENTRY_HEADER_SIZE))
+    {
+        return 0;
+    }
+    return ENTRY_HEADER_SIZE + size;
+}
+
+bool LLVOCache::readFromPack(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVOCachePackEntries* pack_entries, S32& num_entries)
+{
+    pack_slot_map_t::const_iterator iter = mPackSlots.find(handle);
+    if (iter == mPackSlots.end() || iter->second.mSize < UUID_BYTES + sizeof(S32))
+    {
+        return false;
+    }
+    const PackSlot& slot = iter->second;
+
+    std::shared_ptr<LLMappedFile> mapping = getPackMapping(slot.mOffset + slot.mSize);
+    if (!mapping)
+    {
+        return false;
+    }
+
+    const U8* data = mapping->getData() + slot.mOffset;
+    S64 data_size = (S64)slot.mSize;
+
+    LLUUID cache_id;
+    memcpy(cache_id.mData, data, UUID_BYTES);
+    if (cache_id != id)
+    {
+        LL_INFOS() << "Cache ID doesn't match for this region, discarding"<< LL_ENDL;
+        return false;
+    }
+    memcpy(&num_entries, data + UUID_BYTES, sizeof(S32));
+    data += UUID_BYTES + sizeof(S32);
+    data_size -= UUID_BYTES + sizeof(S32);
+
+    if (pack_entries)
+    {
+        pack_entries->clear();
+        pack_entries->mMapping = mapping;
+        pack_entries->mOffsets.reserve(num_entries > 0 ? num_entries : 0);
+    }
+
+    for (S32 i = 0; i < num_entries && data_size > 0; i++)
+    {
+        U32 local_id;
+        S32 record_size = get_entry_record_size(data, data_size, local_id);
+        if (!record_size)
+        {
+            LL_WARNS() << "Aborting cache pack load for handle " << handle << ", cache file corruption!" << LL_ENDL;
+            return false;
+        }
+
+        if (pack_entries)
+        {
+            pack_entries->mOffsets[local_id] = data - mapping->getData();
+        }
+        else
+        {
+            cache_entry_map[local_id] = new LLVOCacheEntry(data, record_size);
+        }
+        data += record_size;
+        data_size -= record_size;
+    }
+
+    return true;
+}
+
+bool LLVOCache::writeToPack(HeaderEntryInfo* entry, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, const LLVOCachePackEntries* pack_entries, bool removal_enabled)
+{
+    // size the region blob first, same layout as a .slc file.
+    U64 blob_size = UUID_BYTES + sizeof(S32);
+    S32 num_entries = 0;
+    for (LLVOCacheEntry::vocache_entry_map_t::const_iterator iter = cache_entry_map.begin(); iter != cache_entry_map.end(); ++iter)
+    {
+        if (!removal_enabled || iter->second->isValid())
+        {
+            S32 size = iter->second->getRecordSize();
+            if (size <= ENTRY_HEADER_SIZE || size > ENTRY_HEADER_SIZE + MAX_ENTRY_BODY_SIZE) // body is minimum of 1
+            {
+                LL_WARNS() << "Failed to write cache entry to buffer for handle " << entry->mHandle << ", entry number " << iter->second->getLocalID() << LL_ENDL;
+                return false;
+            }
+            blob_size += size;
+            num_entries++;
+        }
+    }
+
+    // Entries the region never looked up are copied as they are, unless
+    // invalid entries are being removed: like loaded entries that were
+    // never probed, they were not validated.
+    std::vector<std::pair<const U8*, S32> > pending_records;
+    if (pack_entries && pack_entries->mMapping && !removal_enabled)
+    {
+        const U8* mapping_data = pack_entries->mMapping->getData();
+        S64 mapping_size = (S64)pack_entries->mMapping->getSize();
+        pending_records.reserve(pack_entries->mOffsets.size());
+        for (const auto& pending : pack_entries->mOffsets)
+        {
+            U32 local_id;
+            S32 record_size = get_entry_record_size(mapping_data + pending.second, mapping_size - (S64)pending.second, local_id);
+            if (record_size)
+            {
+                pending_records.emplace_back(mapping_data + pending.second, record_size);
+                blob_size += record_size;
+                num_entries++;
+            }
+        }
+    }
+
+    if (mPackHeader.mDataEnd + blob_size > MAX_PACK_SIZE && canCompactPack())
+    {
+        compactPack();
+    }
+    if (mPackHeader.mDataEnd + blob_size > MAX_PACK_SIZE)
+    {
+        LL_WARNS() << "Object cache pack is full, not caching handle " << entry->mHandle << LL_ENDL;
+        return false;
+    }
+
+    // append, never overwrite: the region may still read entries from its previous blob.
+    S32 offset = (S32)mPackHeader.mDataEnd;
+    std::shared_ptr<LLMappedFile> mapping = getPackMapping(offset + blob_size);
+    U8* data = mapping ? mapping->getWritableData() : nullptr;
+    if (!data)
+    {
+        LL_WARNS() << "Failed to write cache to disk " << mPackFileName << LL_ENDL;
+        return false;
+    }
+
+    // serialize straight into the mapped pack
+    data += offset;
+    memcpy(data, id.mData, UUID_BYTES);
+    memcpy(data + UUID_BYTES, &num_entries, sizeof(S32));
+    U64 pos = UUID_BYTES + sizeof(S32);
+    for (LLVOCacheEntry::vocache_entry_map_t::const_iterator iter = cache_entry_map.begin(); iter != cache_entry_map.end(); ++iter)
+    {
+        if (!removal_enabled || iter->second->isValid())
+        {
+            pos += iter->second->writeToBuffer(data + pos);
+        }
+    }
+    for (const auto& record : pending_records)
+    {
+        memcpy(data + pos, record.first, record.second);
+        pos += record.second;
+    }
+    llassert(pos == blob_size);
+
+    PackSlot& slot = mPackSlots[entry->mHandle];
+    mPackHeader.mDeadBytes += slot.mSize;
+    mPackHeader.mDataEnd += blob_size;
+    slot.mHandle = entry->mHandle;
+    slot.mOffset = offset;
+    slot.mSize = blob_size;
+
+    LL_DEBUGS("VOCache") << "Wrote " << num_entries << " entries to the object cache pack for handle " << entry->mHandle << LL_ENDL;
+    return updatePackSlot(entry);
+}
+
+bool LLVOCache::canCompactPack()
+{
+    mRetiredPackMappings.erase(std::remove_if(mRetiredPackMappings.begin(), mRetiredPackMappings.end(),
+                                              [](const std::weak_ptr<LLMappedFile>& mapping) { return mapping.expired(); }),
+                               mRetiredPackMappings.end());
+
+    return mRetiredPackMappings.empty() && (!mPackMapping || mPackMapping.use_count() == 1);
+}
+
+void LLVOCache::compactPack()
+{
+    if (mReadOnly || !canCompactPack())
+    {
+        return;
+    }
+
+    std::shared_ptr<LLMappedFile> mapping = getPackMapping(mPackHeader.mDataEnd);
+    if (!mapping)
+    {
+        return;
+    }
+
+    const U64 old_size = mPackHeader.mDataEnd;
+    const PackHeader old_header = mPackHeader;
+    const pack_slot_map_t old_slots = mPackSlots;
+
+    std::string temp_filename = mPackFileName + ".tmp";
+    bool success = true;
+    {
+        LLAPRFile apr_file(temp_filename, APR_CREATE|APR_WRITE|APR_BINARY|APR_TRUNCATE, mLocalAPRFilePoolp);
+
+        U64 offset = getPackDataStart();
+        success = apr_file.seek(APR_SET, (S32)offset) == (S32)offset;
+        for (pack_slot_map_t::iterator iter = mPackSlots.begin(); success && iter != mPackSlots.end(); ++iter)
+        {
+            PackSlot& slot = iter->second;
+            success = check_write(&apr_file, (void*)(mapping->getData() + slot.mOffset), (S32)slot.mSize);
+            slot.mOffset = offset;
+            offset += slot.mSize;
+        }
+        mPackHeader.mDataEnd = offset;
+        mPackHeader.mDeadBytes = 0;
+
+        success = success && writePackIndex(apr_file);
+    }
+
+    // no view may be left on the old file, on Windows it can not be replaced while mapped.
+    mapping.reset();
+    mPackMapping.reset();
+
+    if (success)
+    {
+        success = LLAPRFile::rename(temp_filename, mPackFileName, mLocalAPRFilePoolp);
+    }
+
+    if (success)
+    {
+        LL_INFOS() << "Compacted object cache pack from " << old_size << " to " << mPackHeader.mDataEnd << " bytes." << LL_ENDL;
+    }
+    else
+    {
+        LL_WARNS() << "Failed to compact object cache pack " << mPackFileName << LL_ENDL;
+        LLAPRFile::remove(temp_filename, mLocalAPRFilePoolp);
+        mPackHeader = old_header;
+        mPackSlots = old_slots;
+    }
+}
+
+// Moves the per region .slc files of the old format into the pack, the blobs
+// have the same layout so this is a plain copy.
+void LLVOCache::importLegacyCache()
+{
+    const HeaderMetaInfo expected_meta_info = mMetaInfo;
+
+    mUsePack = false;
+    readCacheHeader();
+    mUsePack = true;
+
+    bool compatible = mMetaInfo.mVersion == expected_meta_info.mVersion
+        && mMetaInfo.mAddressSize == expected_meta_info.mAddressSize;
+    mMetaInfo = expected_meta_info;
+    mPackHeader = PackHeader();
+    mPackSlots.clear();
+
+    std::vector<HeaderEntryInfo*> imported;
+    std::vector<HeaderEntryInfo*> dropped;
+    bool success = true;
+    {
+        LLAPRFile apr_file(mPackFileName, APR_CREATE|APR_WRITE|APR_BINARY|APR_TRUNCATE, mLocalAPRFilePoolp);
+
+        U64 offset = getPackDataStart();
+        success = apr_file.seek(APR_SET, (S32)offset) == (S32)offset;
+
+        std::vector<U8> blob;
+        for (header_entry_queue_t::iterator iter = mHeaderEntryQueue.begin(); success && iter != mHeaderEntryQueue.end(); ++iter)
+        {
+            HeaderEntryInfo* entry = *iter;
+
+            std::string filename;
+            getObjectCacheFilename(entry->mHandle, filename);
+            S32 size = compatible ? LLAPRFile::size(filename, mLocalAPRFilePoolp) : 0;
+            if (size <= (S32)(UUID_BYTES + sizeof(S32)) || offset + size > MAX_PACK_SIZE)
+            {
+                dropped.push_back(entry);
+                continue;
+            }
+
+            blob.resize(size);
+            if (LLAPRFile::readEx(filename, blob.data(), 0, size, mLocalAPRFilePoolp) != size)
+            {
+                dropped.push_back(entry);
+                continue;
+            }
+
+            success = check_write(&apr_file, blob.data(), size);
+
+            PackSlot& slot = mPackSlots[entry->mHandle];
+            slot.mHandle = entry->mHandle;
+            slot.mTime = entry->mTime;
+            slot.mOffset = offset;
+            slot.mSize = size;
+            offset += size;
+            imported.push_back(entry);
+        }
+        mPackHeader.mDataEnd = offset;
+
+        if (success)
+        {
+            for (HeaderEntryInfo* entry : dropped)
+            {
+                mHandleEntryMap.erase(entry->mHandle);
+                mHeaderEntryQueue.erase(entry);
+                LLFile::remove(getObjectCacheExtrasFilename(entry->mHandle));
+                delete entry;
+            }
+
+            // slots are assigned in LRU order, same as writeCacheHeader() does.
+            S32 index = 0;
+            for (HeaderEntryInfo* entry : mHeaderEntryQueue)
+            {
+                entry->mIndex = index++;
+            }
+            success = writePackIndex(apr_file);
+        }
+    }
+
+    // the old files are gone either way, the pack is the cache from now on.
+    for (HeaderEntryInfo* entry : imported)
+    {
+        std::string filename;
+        getObjectCacheFilename(entry->mHandle, filename);
+        LLAPRFile::remove(filename, mLocalAPRFilePoolp);
+    }
+    LLAPRFile::remove(mHeaderFileName, mLocalAPRFilePoolp);
+
+    if (!success)
+    {
+        LL_WARNS() << "Failed to import the object cache into " << mPackFileName << LL_ENDL;
+        removeCache();
+        return;
+    }
+
+    LL_INFOS() << "Imported " << mNumEntries << " regions into the object cache pack." << LL_ENDL;
+}
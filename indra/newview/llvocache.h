@@ -39,6 +39,7 @@
 //---------------------------------------------------------------------------
 // Cache entries
 class LLCamera;
+class LLMappedFile;
 
 class LLGLTFOverrideCacheEntry
 {
@@ -103,6 +104,7 @@ protected:
 public:
     LLVOCacheEntry(U32 local_id, U32 crc, LLDataPackerBinaryBuffer &dp);
     LLVOCacheEntry(LLAPRFile* apr_file);
+    LLVOCacheEntry(const U8* data, S64 data_size); //entry record in the object cache pack
     LLVOCacheEntry();
 
     void updateEntry(U32 crc, LLDataPackerBinaryBuffer &dp);
@@ -125,6 +127,8 @@ public:
     F32 getSceneContribution() const             { return mSceneContrib;}
 
     void dump() const;
+    // Size of the record writeToBuffer() writes, header included.
+    S32 getRecordSize() const;
     S32 writeToBuffer(U8 *data_buffer) const;
     LLDataPackerBinaryBuffer *getDP();
     void recordHit();
@@ -194,6 +198,28 @@ public:
     static F32                  sRearPixelThreshold;
 };
 
+// Entries of a region read from the object cache pack that were not looked
+// up yet. Only offsets into the mapped pack are kept; LLVOCacheEntry objects
+// are created for the objects the region asks for, and the others are
+// written back as they are.
+class LLVOCachePackEntries
+{
+public:
+    bool empty() const { return mOffsets.empty(); }
+    size_t size() const { return mOffsets.size(); }
+    bool has(U32 local_id) const { return mOffsets.find(local_id) != mOffsets.end(); }
+    void clear();
+
+    // Creates the entry for local_id and forgets about it. Returns NULL if there is none.
+    LLPointer<LLVOCacheEntry> take(U32 local_id);
+
+private:
+    friend class LLVOCache;
+
+    std::shared_ptr<LLMappedFile> mMapping;
+    std::unordered_map<U32, U64>  mOffsets; //local id -> offset of the entry record in mMapping
+};
+
 class LLVOCacheGroup : public LLOcclusionCullingGroup
 {
 public:
@@ -280,15 +306,45 @@ private:
     typedef std::set<HeaderEntryInfo*, header_entry_less> header_entry_queue_t;
     typedef std::map<U64, HeaderEntryInfo*> handle_entry_map_t;
 
+    // Single file object cache ("ObjectCachePackFormat"): a PackHeader, a fixed
+    // table of MAX_NUM_OBJECT_ENTRIES PackSlots indexed by HeaderEntryInfo::mIndex,
+    // then the region blobs. A region blob has the same layout as a .slc file.
+    // Blobs are only ever appended, so regions reading entries from an older
+    // mapping of the pack stay valid until the pack gets compacted.
+    struct PackHeader
+    {
+        PackHeader() : mMagic(0), mNumSlots(0), mDataEnd(0), mDeadBytes(0) {}
+
+        U32 mMagic;
+        U32 mNumSlots;
+        HeaderMetaInfo mMetaInfo;
+        U64 mDataEnd;   //end of the last region blob
+        U64 mDeadBytes; //space taken by superseded region blobs
+    };
+
+    struct PackSlot
+    {
+        PackSlot() : mHandle(0), mTime(0), mPad(0), mOffset(0), mSize(0) {}
+
+        U64 mHandle;
+        U32 mTime;
+        U32 mPad;
+        U64 mOffset;
+        U64 mSize;
+    };
+    typedef std::map<U64, PackSlot> pack_slot_map_t;
+
 public:
     // We need this init to be separate from constructor, since we might construct cache, purge it, then init.
     void initCache(ELLPath location, U32 size, U32 cache_version);
     void removeCache(ELLPath location, bool started = false) ;
 
-    bool readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map) ;
-    void readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map);
+    // With the pack format, entries are left in pack_entries when it is given
+    // and only created on demand.
+    bool readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVOCachePackEntries* pack_entries = NULL) ;
+    void readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, const LLVOCachePackEntries* pack_entries = NULL);
 
-    void writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, bool dirty_cache, bool removal_enabled);
+    void writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, bool dirty_cache, bool removal_enabled, const LLVOCachePackEntries* pack_entries = NULL);
     void writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, bool dirty_cache, bool removal_enabled);
     void removeEntry(U64 handle) ;
     void removeGenericExtrasForHandle(U64 handle);
@@ -296,6 +352,9 @@ public:
     U32 getCacheEntries() { return mNumEntries; }
     U32 getCacheEntriesMax() { return mCacheSize; }
 
+    // Select the single file, memory mapped cache format. Must be called before initCache().
+    void setPackFormat(bool use_pack);
+
 private:
     void setDirNames(ELLPath location);
     // determine the cache filename for the region from the region handle
@@ -310,6 +369,19 @@ private:
     void purgeEntries(U32 size);
     bool updateEntry(const HeaderEntryInfo* entry);
 
+    void readPackIndex();
+    void writePackIndex();
+    bool writePackIndex(LLAPRFile& apr_file);
+    bool updatePackSlot(const HeaderEntryInfo* entry);
+    bool readFromPack(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVOCachePackEntries* pack_entries, S32& num_entries);
+    bool writeToPack(HeaderEntryInfo* entry, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, const LLVOCachePackEntries* pack_entries, bool removal_enabled);
+    void importLegacyCache();
+    bool canCompactPack();
+    void compactPack();
+    S32  getFreePackSlot() const;
+    std::shared_ptr<LLMappedFile> getPackMapping(U64 min_size);
+    static U64 getPackDataStart();
+
 private:
     bool                 mEnabled;
     bool                 mInitialized ;
@@ -322,6 +394,13 @@ private:
     LLVolatileAPRPool*   mLocalAPRFilePoolp ;
     header_entry_queue_t mHeaderEntryQueue;
     handle_entry_map_t   mHandleEntryMap;
+
+    bool                 mUsePack;
+    std::string          mPackFileName;
+    PackHeader           mPackHeader;
+    pack_slot_map_t      mPackSlots;
+    std::shared_ptr<LLMappedFile> mPackMapping;
+    std::vector<std::weak_ptr<LLMappedFile> > mRetiredPackMappings; //older mappings still used by regions
 };
 
 #endif
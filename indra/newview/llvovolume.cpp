@@ -81,6 +81,7 @@
 #include "llcontrolavatar.h"
 #include "llvoavatarself.h"
 #include "llvocache.h"
+#include "threadpool.h"
 #include "llmaterialmgr.h"
 #include "llanimationstates.h"
 #include "llinventorytype.h"
@@ -4873,7 +4874,7 @@ bool LLVOVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a&
             }
 
             // This calculates the bounding box of the skinned mesh from scratch. It's actually quite expensive, but not nearly as expensive as building a full octree.
-            // rebuild_face_octrees = false because an octree for this face will be built later only if needed for narrow phase picking.
+            // rebuild_face_octrees = false because lineSegmentIntersect refits this face's BVH only if needed for narrow phase picking.
             updateRiggedVolume(true, i, false);
             face_hit = volume->lineSegmentIntersect(local_start, local_end, i,
                                                     &p, &tc, &n, &tn);
@@ -5064,6 +5065,7 @@ void LLRiggedVolume::update(
     if (copy)
     {
         copyVolumeFaces(volume);
+        mPackedWeights.clear();
     }
     else
     {
@@ -5085,7 +5087,20 @@ void LLRiggedVolume::update(
     LLMatrix4a mat[kMaxJoints];
     U32 maxJoints = LLSkinningUtil::getMeshJointCount(skin);
     LLSkinningUtil::initSkinningMatrixPalette(mat, maxJoints, skin, avatar);
-    const LLMatrix4a bind_shape_matrix = skin->mBindShapeMatrix;
+
+    // fold the bind shape matrix into the palette, so each vertex takes one
+    // transform per joint instead of one more for the bind shape
+    LLMatrix4a palette[kMaxJoints];
+    LLPackedSkinWeights::preparePalette(mat, maxJoints, skin->mBindShapeMatrix, palette);
+    // weights past the mesh's joints would read unset palette entries
+    const U32 num_joints = llmin(maxJoints, (U32)LLSkinningUtil::getMaxJointCount());
+
+    if (mPackedWeights.size() != (size_t)volume->getNumVolumeFaces())
+    {
+        mPackedWeights.clear();
+        mPackedWeights.resize(volume->getNumVolumeFaces());
+    }
+    LL::ThreadPool* pool = LLAppViewer::instance()->getGeneralThreadPool();
 
     S32 rigged_vert_count = 0;
     S32 rigged_face_count = 0;
@@ -5121,69 +5136,29 @@ void LLRiggedVolume::update(
 
             LLVector4a* pos = dst_face.mPositions;
 
-            if (pos && dst_face.mExtents)
+            if (pos && dst_face.mExtents && dst_face.mNumVertices > 0)
             {
-                U32 max_joints = LLSkinningUtil::getMaxJointCount();
                 rigged_vert_count += dst_face.mNumVertices;
                 rigged_face_count++;
 
-            #if USE_SEPARATE_JOINT_INDICES_AND_WEIGHTS
-                if (vol_face.mJointIndices) // fast path with preconditioned joint indices
-                {
-                    LLMatrix4a src[4];
-                    U8* joint_indices_cursor = vol_face.mJointIndices;
-                    LLVector4a* just_weights = vol_face.mJustWeights;
-                    for (U32 j = 0; j < dst_face.mNumVertices; ++j)
-                    {
-                        LLMatrix4a final_mat;
-                        F32* w = just_weights[j].getF32ptr();
-                        LLSkinningUtil::getPerVertexSkinMatrixWithIndices(w, joint_indices_cursor, mat, final_mat, src);
-                        joint_indices_cursor += 4;
-
-                        LLVector4a& v = vol_face.mPositions[j];
-                        LLVector4a t;
-                        LLVector4a dst;
-                        bind_shape_matrix.affineTransform(v, t);
-                        final_mat.affineTransform(t, dst);
-                        pos[j] = dst;
-                    }
-                }
-                else
-            #endif
+                LLPackedSkinWeights& packed = mPackedWeights[i];
+                if (!packed.isPackedFrom(vol_face.mWeightsSerial, dst_face.mNumVertices, num_joints))
                 {
-                    for (S32 j = 0; j < dst_face.mNumVertices; ++j)
-                    {
-                        LLMatrix4a final_mat;
-                        LLSkinningUtil::getPerVertexSkinMatrix(weight[j].getF32ptr(), mat, false, final_mat, max_joints);
-
-                        LLVector4a& v = vol_face.mPositions[j];
-                        LLVector4a t;
-                        LLVector4a dst;
-                        bind_shape_matrix.affineTransform(v, t);
-                        final_mat.affineTransform(t, dst);
-                        pos[j] = dst;
-                    }
+                    packed.pack(weight, dst_face.mNumVertices, num_joints, vol_face.mWeightsSerial);
                 }
 
                 //update bounding box
                 // VFExtents change
                 LLVector4a& min = dst_face.mExtents[0];
                 LLVector4a& max = dst_face.mExtents[1];
+                packed.skin(palette, vol_face.mPositions, pos, min, max, pool);
 
-                min = pos[0];
-                max = pos[1];
-                if (i==0)
+                if (rigged_face_count == 1)
                 {
                     box_min = min;
                     box_max = max;
                 }
 
-                for (S32 j = 1; j < dst_face.mNumVertices; ++j)
-                {
-                    min.setMin(min, pos[j]);
-                    max.setMax(max, pos[j]);
-                }
-
                 box_min.setMin(min,box_min);
                 box_max.setMax(max,box_max);
 
@@ -5192,10 +5167,13 @@ void LLRiggedVolume::update(
 
             }
 
+            // positions moved but the triangles did not, so the next ray cast
+            // only refits the BVH; the octree is only used by debug rendering
+            // now and gets rebuilt there on demand
+            dst_face.dirtyBVH();
             if (rebuild_face_octrees)
             {
                 dst_face.destroyOctree();
-                dst_face.createOctree();
             }
         }
     }
@@ -32,6 +32,7 @@
 #include "llviewermedia.h"
 #include "llframetimer.h"
 #include "lllocalbitmaps.h"
+#include "llpackedskinweights.h"
 #include "m3math.h"     // LLMatrix3
 #include "m4math.h"     // LLMatrix4
 #include <unordered_map>
@@ -76,6 +77,10 @@ public:
         bool rebuild_face_octrees = true);
 
 	std::string mExtraDebugText;
+
+private:
+    // per face, decoded from the source volume's weights on first use
+    std::vector<LLPackedSkinWeights> mPackedWeights;
 };
 
 // Base class for implementations of the volume - Primitive, Flexible Object, etc.
@@ -427,7 +432,7 @@ public:
 
 
     // Rigged volume update (for raycasting)
-    // By default, this updates the bounding boxes of all the faces and builds an octree for precise per-triangle raycasting
+    // By default, this updates the bounding boxes of all the faces and marks their BVHs for refit before precise per-triangle raycasting
     void updateRiggedVolume(
         bool force_treat_as_rigged,
         LLRiggedVolume::FaceIndex face_index = LLRiggedVolume::UPDATE_ALL_FACES,
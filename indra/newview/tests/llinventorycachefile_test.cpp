@@ -0,0 +1,333 @@
+/**
+ * @file llinventorycachefile_test.cpp
+ * @brief Tests for the binary inventory cache file.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llinventorycachefile.h"
+
+#include "lldir.h"
+#include "llfile.h"
+#include "llinventory.h"
+#include "llsdutil.h"
+#include "lltimer.h"
+
+#include <fstream>
+
+#include "../test/lltut.h"
+
+namespace
+{
+    const S32 CACHE_VERSION = 5;
+
+    struct TestInventory
+    {
+        std::vector<LLPointer<LLInventoryCategory> > mCategories;
+        std::vector<LLUUID> mOwners;
+        std::vector<S32> mVersions;
+        std::vector<LLPointer<LLInventoryItem> > mItems;
+    };
+
+    LLUUID make_id(const char* kind, S32 i)
+    {
+        return LLUUID::generateNewID(llformat("%s %d", kind, i));
+    }
+
+    // An inventory shaped like a real one: a mix of asset types, links,
+    // restricted and full permissions, group owned items, items for sale,
+    // thumbnails, favorites and empty descriptions. Items of a folder are
+    // added interleaved with other folders' items, as collectDescendentsIf()
+    // does not return them grouped either.
+    TestInventory make_inventory(S32 folder_count, S32 items_per_folder)
+    {
+        static const LLAssetType::EType ASSET_TYPES[] = { LLAssetType::AT_OBJECT, LLAssetType::AT_NOTECARD,
+                                                          LLAssetType::AT_LINK, LLAssetType::AT_TEXTURE,
+                                                          LLAssetType::AT_LANDMARK, LLAssetType::AT_CLOTHING };
+        static const LLInventoryType::EType INV_TYPES[] = { LLInventoryType::IT_OBJECT, LLInventoryType::IT_NOTECARD,
+                                                            LLInventoryType::IT_WEARABLE, LLInventoryType::IT_TEXTURE,
+                                                            LLInventoryType::IT_LANDMARK, LLInventoryType::IT_WEARABLE };
+        const LLUUID owner = make_id("owner", 0);
+        const LLUUID group = make_id("group", 0);
+
+        TestInventory inventory;
+        for (S32 f = 0; f < folder_count; ++f)
+        {
+            LLPointer<LLInventoryCategory> cat = new LLInventoryCategory(make_id("folder", f),
+                                                                         f ? make_id("folder", (f - 1) / 4) : LLUUID::null,
+                                                                         f % 9 == 1 ? LLFolderType::FT_OUTFIT : LLFolderType::FT_NONE,
+                                                                         llformat("Folder %d", f));
+            cat->setType(LLAssetType::AT_CATEGORY);
+            if (f % 5 == 0)
+            {
+                cat->setThumbnailUUID(make_id("folder thumbnail", f));
+            }
+            cat->setFavorite(f % 7 == 3);
+            inventory.mCategories.push_back(cat);
+            inventory.mOwners.push_back(owner);
+            inventory.mVersions.push_back(f % 11 + 1);
+        }
+
+        const S32 item_count = folder_count * items_per_folder;
+        for (S32 i = 0; i < item_count; ++i)
+        {
+            const S32 kind = i % LL_ARRAY_SIZE(ASSET_TYPES);
+            const bool group_owned = i % 13 == 0;
+            LLPermissions perm;
+            perm.init(make_id("creator", i % 97), group_owned ? LLUUID::null : owner, make_id("last owner", i % 31), group);
+            if (i % 3)
+            {
+                perm.initMasks(PERM_ALL, PERM_ALL, PERM_NONE, PERM_NONE, PERM_ALL);
+            }
+            else
+            {
+                perm.initMasks(PERM_MOVE | PERM_TRANSFER, PERM_MOVE | PERM_TRANSFER, PERM_NONE, PERM_NONE, PERM_MOVE | PERM_TRANSFER);
+            }
+            LLSaleInfo sale_info = i % 11 == 0 ? LLSaleInfo(LLSaleInfo::FS_COPY, 10 + i % 500) : LLSaleInfo::DEFAULT;
+
+            LLPointer<LLInventoryItem> item = new LLInventoryItem(make_id("item", i), make_id("folder", i % folder_count), perm,
+                                                                  make_id("asset", i), ASSET_TYPES[kind], INV_TYPES[kind],
+                                                                  llformat("Item %d \xc3\xa9", i),
+                                                                  i % 3 == 1 ? std::string() : llformat("Description of item %d", i % 1000),
+                                                                  sale_info, i % 4 == 0 ? 0x1 : 0x0, 1600000000 + i);
+            if (i % 5 == 0)
+            {
+                item->setThumbnailUUID(make_id("thumbnail", i));
+            }
+            item->setFavorite(i % 17 == 0);
+            inventory.mItems.push_back(item);
+        }
+        return inventory;
+    }
+
+    void add_inventory(LLInventoryCacheWriter& writer, const TestInventory& inventory)
+    {
+        for (size_t i = 0; i < inventory.mCategories.size(); ++i)
+        {
+            writer.addCategory(inventory.mCategories[i], inventory.mOwners[i], inventory.mVersions[i]);
+        }
+        for (const LLPointer<LLInventoryItem>& item : inventory.mItems)
+        {
+            writer.addItem(item);
+        }
+    }
+
+    std::string read_file(const std::string& filename)
+    {
+        std::ifstream file(filename.c_str(), std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void write_file(const std::string& filename, const std::string& data)
+    {
+        std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+        file.write(data.data(), data.size());
+    }
+
+    template<typename T>
+    void poke(std::string& data, size_t offset, T value)
+    {
+        memcpy(&data[offset], &value, sizeof(value));
+    }
+}
+
+namespace tut
+{
+    struct inventorycachefile
+    {
+        inventorycachefile()
+        {
+            mFileName = gDirUtilp->add(LLFile::tmpdir(), llformat("llinventorycachefile_test_%d.inv.bin", (S32)LLTimer::getTotalTime()));
+        }
+
+        ~inventorycachefile()
+        {
+            LLFile::remove(mFileName, ENOENT);
+        }
+
+        std::string mFileName;
+    };
+    typedef test_group<inventorycachefile> inventorycachefile_t;
+    typedef inventorycachefile_t::object inventorycachefile_object_t;
+    tut::inventorycachefile_t tut_inventorycachefile("LLInventoryCacheFile");
+
+    template<> template<>
+    void inventorycachefile_object_t::test<1>()
+    {
+        set_test_name("categories and items read back as saved");
+
+        TestInventory inventory = make_inventory(40, 25);
+        LLInventoryCacheWriter writer;
+        add_inventory(writer, inventory);
+        ensure("save", writer.save(mFileName, CACHE_VERSION));
+        ensure("no temporary file left", !LLFile::isfile(mFileName + ".tmp"));
+
+        LLInventoryCacheReader reader;
+        ensure("open", reader.open(mFileName));
+        ensure_equals("cache version", reader.getCacheVersion(), CACHE_VERSION);
+        ensure_equals("category count", reader.getCategoryCount(), (U32)inventory.mCategories.size());
+        ensure_equals("item count", reader.getItemCount(), (U32)inventory.mItems.size());
+
+        for (U32 i = 0; i < reader.getCategoryCount(); ++i)
+        {
+            const LLInventoryCategory* expected = inventory.mCategories[i];
+            LLPointer<LLInventoryCategory> cat = new LLInventoryCategory;
+            reader.readCategory(i, *cat);
+            ensure_equals("category id", cat->getUUID(), expected->getUUID());
+            ensure_equals("category parent", cat->getParentUUID(), expected->getParentUUID());
+            ensure_equals("category name", cat->getName(), expected->getName());
+            ensure_equals("category type", cat->getType(), expected->getType());
+            ensure_equals("category preferred type", cat->getPreferredType(), expected->getPreferredType());
+            ensure_equals("category thumbnail", cat->getThumbnailUUID(), expected->getThumbnailUUID());
+            ensure_equals("category favorite", cat->getIsFavorite(), expected->getIsFavorite());
+            ensure_equals("category owner", reader.getCategoryOwner(i), inventory.mOwners[i]);
+            ensure_equals("category version", reader.getCategoryVersion(i), inventory.mVersions[i]);
+        }
+
+        std::map<LLUUID, const LLInventoryItem*> expected_items;
+        for (const LLPointer<LLInventoryItem>& item : inventory.mItems)
+        {
+            expected_items[item->getUUID()] = item;
+        }
+        for (U32 i = 0; i < reader.getItemCount(); ++i)
+        {
+            auto expected = expected_items.find(reader.getItemID(i));
+            ensure("item id was saved", expected != expected_items.end());
+
+            LLPointer<LLInventoryItem> item = new LLInventoryItem;
+            reader.readItem(i, *item);
+            ensure("item " + item->getName() + " matches", llsd_equals(item->asLLSD(), expected->second->asLLSD()));
+            expected_items.erase(expected);
+        }
+        ensure("every item read once", expected_items.empty());
+    }
+
+    template<> template<>
+    void inventorycachefile_object_t::test<2>()
+    {
+        set_test_name("items are found per folder");
+
+        TestInventory inventory = make_inventory(30, 7);
+        // not stored, but flag their folder
+        LLPointer<LLInventoryItem> unknown = new LLInventoryItem(inventory.mItems[3].get());
+        unknown->setUUID(make_id("unknown", 0));
+        unknown->setType(LLAssetType::AT_UNKNOWN);
+        inventory.mItems.push_back(unknown);
+        // not stored at all
+        LLPointer<LLInventoryItem> null_item = new LLInventoryItem(inventory.mItems[4].get());
+        null_item->setUUID(LLUUID::null);
+        inventory.mItems.push_back(null_item);
+
+        LLInventoryCacheWriter writer;
+        add_inventory(writer, inventory);
+        ensure("save", writer.save(mFileName, CACHE_VERSION));
+
+        LLInventoryCacheReader reader;
+        ensure("open", reader.open(mFileName));
+        ensure_equals("unknown and null items skipped", reader.getItemCount(), (U32)inventory.mItems.size() - 2);
+        ensure_equals("folder count", reader.getFolderCount(), 30U);
+
+        for (S32 f = 0; f < 30; ++f)
+        {
+            const LLUUID folder_id = make_id("folder", f);
+            S32 folder = reader.findFolder(folder_id);
+            ensure("folder found", folder >= 0);
+            ensure_equals("folder id", reader.getFolderID(folder), folder_id);
+            ensure_equals("unknown items flagged", reader.getFolderHasUnknownItems(folder), folder_id == unknown->getParentUUID());
+
+            U32 first = 0;
+            U32 count = 0;
+            reader.getFolderItems(folder, first, count);
+            ensure_equals("items per folder", count, 7U);
+            for (U32 i = first; i < first + count; ++i)
+            {
+                LLPointer<LLInventoryItem> item = new LLInventoryItem;
+                reader.readItem(i, *item);
+                ensure_equals("item in its folder", item->getParentUUID(), folder_id);
+            }
+            if (folder > 0)
+            {
+                ensure("folders sorted", reader.getFolderID(folder - 1) < folder_id);
+            }
+        }
+        ensure_equals("missing folder", reader.findFolder(make_id("folder", 30)), -1);
+    }
+
+    template<> template<>
+    void inventorycachefile_object_t::test<3>()
+    {
+        set_test_name("damaged files are rejected");
+
+        LLInventoryCacheWriter writer;
+        TestInventory inventory = make_inventory(10, 10);
+        add_inventory(writer, inventory);
+        ensure("save", writer.save(mFileName, CACHE_VERSION));
+        const std::string good = read_file(mFileName);
+
+        LLInventoryCacheReader reader;
+        ensure("missing file", !reader.open(mFileName + ".missing"));
+        ensure("good file", reader.open(mFileName));
+        reader.close();
+
+        std::string data = good.substr(0, 40);
+        write_file(mFileName, data);
+        ensure("truncated header", !reader.open(mFileName));
+
+        data = good.substr(0, good.size() - 200);
+        write_file(mFileName, data);
+        ensure("truncated tables", !reader.open(mFileName));
+
+        data = good;
+        data[0] ^= 0xff;
+        write_file(mFileName, data);
+        ensure("bad magic", !reader.open(mFileName));
+
+        data = good;
+        poke<U32>(data, 4, 99);
+        write_file(mFileName, data);
+        ensure("other format version", !reader.open(mFileName));
+
+        // mCategoryCount
+        data = good;
+        poke<U32>(data, 12, 0x7fffffff);
+        write_file(mFileName, data);
+        ensure("category count beyond the file", !reader.open(mFileName));
+
+        // mItemIDsOffset, overlapping the folder table
+        data = good;
+        poke<U64>(data, 40, 72);
+        write_file(mFileName, data);
+        ensure("overlapping tables", !reader.open(mFileName));
+
+        // mFirstItem of the first folder record
+        data = good;
+        U64 folders_offset = 0;
+        memcpy(&folders_offset, &good[32], sizeof(folders_offset));
+        poke<U32>(data, (size_t)folders_offset + 16, 95);
+        write_file(mFileName, data);
+        ensure("folder range beyond the items", !reader.open(mFileName));
+        ensure("closed after a failed open", !reader.isOpen());
+        ensure_equals("nothing to read", reader.getItemCount(), 0U);
+    }
+}
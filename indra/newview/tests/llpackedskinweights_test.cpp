@@ -0,0 +1,236 @@
+/**
+ * @file llpackedskinweights_test.cpp
+ * @brief Tests for packed CPU skinning
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llpackedskinweights.h"
+
+#include "llmath.h"
+#include "llquaternion.h"
+#include "m4math.h"
+#include "threadpool.h"
+
+#include <random>
+
+#include "../test/lltut.h"
+
+namespace
+{
+    const U32 NUM_JOINTS = 110; // LL_MAX_JOINTS_PER_MESH_OBJECT
+
+    struct TestMesh
+    {
+        std::vector<LLVector4a> mPositions;
+        std::vector<LLVector4a> mWeights; // <joint>.<weight>, as in LLVolumeFace
+        std::vector<LLMatrix4a> mJoints;
+        LLMatrix4a mBindShape;
+    };
+
+    LLMatrix4a random_transform(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<F32> unit(-1.f, 1.f);
+        LLQuaternion rot(unit(rng), unit(rng), unit(rng), 1.f);
+        rot.normalize();
+        LLMatrix4 mat(rot, LLVector4(unit(rng), unit(rng), unit(rng), 1.f));
+        LLMatrix4 scale;
+        scale.initScale(LLVector3(1.f + 0.2f * unit(rng), 1.f + 0.2f * unit(rng), 1.f + 0.2f * unit(rng)));
+        return LLMatrix4a(scale * mat);
+    }
+
+    // One to four influences per vertex, weights in the same encoding and
+    // limits the mesh loader produces.
+    TestMesh make_mesh(U32 num_vertices, U32 seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<F32> unit(-1.f, 1.f);
+        std::uniform_real_distribution<F32> weight(0.01f, 0.999f);
+
+        TestMesh mesh;
+        for (U32 i = 0; i < NUM_JOINTS; ++i)
+        {
+            mesh.mJoints.push_back(random_transform(rng));
+        }
+        mesh.mBindShape = random_transform(rng);
+
+        mesh.mPositions.resize(num_vertices);
+        mesh.mWeights.resize(num_vertices);
+        for (U32 i = 0; i < num_vertices; ++i)
+        {
+            mesh.mPositions[i].set(unit(rng), unit(rng), unit(rng), 1.f);
+            U32 influences = 1 + rng() % 4;
+            F32 w[4] = { 0.f, 0.f, 0.f, 0.f };
+            for (U32 k = 0; k < influences; ++k)
+            {
+                w[k] = (F32)(rng() % NUM_JOINTS) + weight(rng);
+            }
+            mesh.mWeights[i].loadua(w);
+        }
+        return mesh;
+    }
+
+    // the per vertex path LLRiggedVolume::update used before packing
+    void skin_per_vertex(const TestMesh& mesh, std::vector<LLVector4a>& out)
+    {
+        out.resize(mesh.mPositions.size());
+        for (size_t j = 0; j < mesh.mPositions.size(); ++j)
+        {
+            const F32* weights = mesh.mWeights[j].getF32ptr();
+            LLMatrix4a final_mat;
+            final_mat.clear();
+            S32 idx[4];
+            LLVector4 wght;
+            F32 scale = 0.f;
+            for (U32 k = 0; k < 4; k++)
+            {
+                F32 w = weights[k];
+                idx[k] = llclamp((S32) floorf(w), (S32)0, (S32)NUM_JOINTS-1);
+                wght[k] = w - floorf(w);
+                scale += wght[k];
+            }
+            wght *= 1.f/scale;
+            for (U32 k = 0; k < 4; k++)
+            {
+                LLMatrix4a src;
+                src.setMul(mesh.mJoints[idx[k]], wght[k]);
+                final_mat.add(src);
+            }
+
+            LLVector4a t;
+            mesh.mBindShape.affineTransform(mesh.mPositions[j], t);
+            final_mat.affineTransform(t, out[j]);
+        }
+    }
+
+    void skin_packed(const TestMesh& mesh, const LLPackedSkinWeights& packed, std::vector<LLVector4a>& out,
+                     LLVector4a& min, LLVector4a& max, LL::ThreadPoolBase* pool = nullptr)
+    {
+        LLMatrix4a palette[NUM_JOINTS];
+        LLPackedSkinWeights::preparePalette(mesh.mJoints.data(), NUM_JOINTS, mesh.mBindShape, palette);
+        out.resize(mesh.mPositions.size());
+        packed.skin(palette, mesh.mPositions.data(), out.data(), min, max, pool);
+    }
+}
+
+namespace tut
+{
+    struct packedskinweights
+    {
+    };
+    typedef test_group<packedskinweights> packedskinweights_t;
+    typedef packedskinweights_t::object packedskinweights_object_t;
+    tut::packedskinweights_t tut_packedskinweights("LLPackedSkinWeights");
+
+    template<> template<>
+    void packedskinweights_object_t::test<1>()
+    {
+        set_test_name("packed skinning matches the per vertex path");
+        TestMesh mesh = make_mesh(5000, 1);
+        LLPackedSkinWeights packed;
+        packed.pack(mesh.mWeights.data(), (U32)mesh.mWeights.size(), NUM_JOINTS, 1);
+        ensure_equals("vertices", packed.getNumVertices(), (U32)mesh.mWeights.size());
+
+        std::vector<LLVector4a> expected, actual;
+        LLVector4a min, max;
+        skin_per_vertex(mesh, expected);
+        skin_packed(mesh, packed, actual, min, max);
+
+        LLVector4a expected_min = expected[0], expected_max = expected[0];
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            // the bind shape is folded into the palette, so rounding differs
+            for (S32 c = 0; c < 3; ++c)
+            {
+                ensure_approximately_equals_range(llformat("vertex %u[%d]", (U32)i, c).c_str(), actual[i][c], expected[i][c], 1.0e-4f);
+            }
+            expected_min.setMin(expected_min, actual[i]);
+            expected_max.setMax(expected_max, actual[i]);
+        }
+        for (S32 c = 0; c < 3; ++c)
+        {
+            ensure_equals(llformat("min[%d]", c), min[c], expected_min[c]);
+            ensure_equals(llformat("max[%d]", c), max[c], expected_max[c]);
+        }
+    }
+
+    template<> template<>
+    void packedskinweights_object_t::test<2>()
+    {
+        set_test_name("pooled skinning matches serial skinning");
+        TestMesh mesh = make_mesh(100000, 2);
+        LLPackedSkinWeights packed;
+        packed.pack(mesh.mWeights.data(), (U32)mesh.mWeights.size(), NUM_JOINTS, 1);
+
+        std::vector<LLVector4a> serial, pooled;
+        LLVector4a serial_min, serial_max, pooled_min, pooled_max;
+        skin_packed(mesh, packed, serial, serial_min, serial_max);
+
+        LL::ThreadPool pool("skinning test", 3);
+        pool.start();
+        skin_packed(mesh, packed, pooled, pooled_min, pooled_max, &pool);
+        pool.close();
+
+        ensure("positions", !memcmp(serial.data(), pooled.data(), serial.size() * sizeof(LLVector4a)));
+        ensure("min", serial_min.equals4(pooled_min));
+        ensure("max", serial_max.equals4(pooled_max));
+    }
+
+    template<> template<>
+    void packedskinweights_object_t::test<3>()
+    {
+        set_test_name("packing clamps joints and tracks its source");
+        LLVector4a weights[2];
+        weights[0].set(3.25f, 200.75f, 0.f, 0.f); // second joint past the palette
+        weights[1].set(0.f, 0.f, 0.f, 0.f);       // no weight at all
+
+        LLPackedSkinWeights packed;
+        packed.pack(weights, 2, 4, 7);
+        ensure("packed from", packed.isPackedFrom(7, 2, 4));
+        ensure("other source", !packed.isPackedFrom(8, 2, 4));
+        ensure("other joint count", !packed.isPackedFrom(7, 2, 5));
+        ensure("other vertex count", !packed.isPackedFrom(7, 1, 4));
+
+        LLMatrix4a joints[4];
+        for (U32 i = 0; i < 4; ++i)
+        {
+            joints[i].setIdentity();
+            joints[i].mMatrix[3].set((F32)i, 0.f, 0.f, 1.f);
+        }
+        LLMatrix4a palette[4];
+        LLPackedSkinWeights::preparePalette(joints, 4, LLMatrix4a::identity(), palette);
+
+        LLVector4a src[2], dst[2], min, max;
+        src[0].clear();
+        src[1].clear();
+        packed.skin(palette, src, dst, min, max);
+        // joint 3 with a quarter, joint 200 clamped to 3 with three quarters
+        ensure_approximately_equals("clamped joint", dst[0][0], 3.f, 20);
+        // a vertex without weights follows joint 0
+        ensure_equals("unweighted", dst[1][0], 0.f);
+
+        packed.clear();
+        ensure_equals("cleared", packed.getNumVertices(), 0U);
+    }
+}
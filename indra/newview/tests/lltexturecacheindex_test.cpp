@@ -0,0 +1,308 @@
+/**
+ * @file lltexturecacheindex_test.cpp
+ * @brief Tests of the texture cache index
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lltexturecacheindex.h"
+
+#include "lldir.h"
+#include "llfile.h"
+#include "lltimer.h"
+
+#include <atomic>
+#include <thread>
+
+#if LL_LINUX || LL_DARWIN
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "../test/lltut.h"
+
+namespace
+{
+    const std::string VERSION_TAG("1.80:64:test encoder");
+
+    LLUUID texture_id(S32 i)
+    {
+        return LLUUID::generateNewID(llformat("texture %d", i));
+    }
+}
+
+namespace tut
+{
+    struct texturecacheindex
+    {
+        texturecacheindex()
+        {
+            std::string base = gDirUtilp->add(LLFile::tmpdir(), llformat("lltexturecacheindex_test_%d", (S32)LLTimer::getTotalTime()));
+            mIndexFileName = base + ".index";
+            mJournalFileName = base + ".journal";
+        }
+
+        ~texturecacheindex()
+        {
+            LLFile::remove(mIndexFileName, ENOENT);
+            LLFile::remove(mJournalFileName, ENOENT);
+        }
+
+        LLTextureCacheIndex::EOpenResult open(LLTextureCacheIndex& index, U32 max_entries, bool read_only = false)
+        {
+            return index.open(mIndexFileName, mJournalFileName, max_entries, VERSION_TAG, read_only);
+        }
+
+        // inserts and completes entry i the way LLTextureCache does
+        S32 add(LLTextureCacheIndex& index, S32 i)
+        {
+            LLTextureCacheIndex::Entry entry(texture_id(i), -1, 0, 0);
+            S32 idx = index.insert(entry);
+            if (idx >= 0)
+            {
+                entry = LLTextureCacheIndex::Entry(texture_id(i), 1000 + i, i, i);
+                index.update(idx, entry);
+            }
+            return idx;
+        }
+
+        std::string mIndexFileName;
+        std::string mJournalFileName;
+    };
+    typedef test_group<texturecacheindex> texturecacheindex_t;
+    typedef texturecacheindex_t::object texturecacheindex_object_t;
+    tut::texturecacheindex_t tut_texturecacheindex("LLTextureCacheIndex");
+
+    template<> template<>
+    void texturecacheindex_object_t::test<1>()
+    {
+        set_test_name("insert, update, erase and reopen");
+
+        {
+            LLTextureCacheIndex index;
+            ensure_equals("new index", open(index, 100), LLTextureCacheIndex::OPEN_CREATED);
+            for (S32 i = 0; i < 100; ++i)
+            {
+                ensure_equals("dense allocation", add(index, i), i);
+            }
+            ensure_equals("full", add(index, 100), -1);
+            ensure_equals("body bytes", index.getBodyBytes(), (S64)(99 * 100 / 2));
+
+            ensure("erase", index.erase(texture_id(10)));
+            ensure("erase with stale index", !index.erase(texture_id(11), 12));
+            ensure_equals("freed entry reused", add(index, 100), 10);
+
+            LLTextureCacheIndex::Entry entry(texture_id(12), 1, 0, 0);
+            ensure_equals("insert of a present id returns it", index.insert(entry), 12);
+            ensure_equals("and its entry", entry.mImageSize, 1012);
+            ensure("update of another id's entry", !index.update(13, entry));
+            index.close();
+        }
+
+        LLTextureCacheIndex index;
+        ensure_equals("reopened", open(index, 100), LLTextureCacheIndex::OPEN_LOADED);
+        LLTextureCacheIndex::Entry entry;
+        ensure_equals("erased entry gone", index.find(texture_id(10), entry), -1);
+        ensure_equals("find", index.find(texture_id(100), entry), 10);
+        ensure_equals("stored image size", entry.mImageSize, 1100);
+        ensure_equals("find", index.find(texture_id(99), entry), 99);
+        ensure_equals("body bytes", index.getBodyBytes(), (S64)(99 * 100 / 2 - 10 + 100));
+
+        // churn through tombstones: lookups must keep working
+        for (S32 i = 1000; i < 6000; ++i)
+        {
+            ensure("churn erase", index.erase(texture_id(i == 1000 ? 0 : i - 1)));
+            ensure_equals("churn insert", add(index, i), 0);
+        }
+        ensure_equals("churned entry", index.find(texture_id(5999), entry), 0);
+        ensure_equals("churned entry size", entry.mImageSize, 6999);
+        ensure_equals("untouched entry", index.find(texture_id(99), entry), 99);
+        index.close();
+
+        ensure_equals("other encoder", index.open(mIndexFileName, mJournalFileName, 100, "other", false),
+                      LLTextureCacheIndex::OPEN_CREATED);
+        ensure_equals("discarded", index.getNumEntries(), 0U);
+    }
+
+    template<> template<>
+    void texturecacheindex_object_t::test<2>()
+    {
+        set_test_name("grown index keeps entry indices, read only opens");
+
+        {
+            LLTextureCacheIndex index;
+            open(index, 50);
+            for (S32 i = 0; i < 50; ++i)
+            {
+                add(index, i);
+            }
+        }
+
+        LLTextureCacheIndex index;
+        ensure_equals("grown", open(index, 200), LLTextureCacheIndex::OPEN_LOADED);
+        LLTextureCacheIndex::Entry entry;
+        ensure_equals("kept index", index.find(texture_id(42), entry), 42);
+        ensure_equals("room to grow", add(index, 50), 50);
+
+        LLTextureCacheIndex reader;
+        ensure_equals("read only", open(reader, 200, true), LLTextureCacheIndex::OPEN_LOADED);
+        ensure_equals("read only find", reader.find(texture_id(7), entry), 7);
+        ensure_equals("read only insert", add(reader, 1000), -1);
+    }
+
+    template<> template<>
+    void texturecacheindex_object_t::test<3>()
+    {
+        set_test_name("lookups from 8 threads during a purge");
+
+        const S32 NUM_TEXTURES = 5000;
+        const S32 NUM_THREADS = 8;
+        const S32 LOOKUPS_PER_THREAD = 10000;
+
+        std::vector<LLUUID> ids(NUM_TEXTURES * 2);
+        for (S32 i = 0; i < NUM_TEXTURES * 2; ++i)
+        {
+            ids[i] = texture_id(i);
+        }
+
+        LLTextureCacheIndex index;
+        open(index, NUM_TEXTURES);
+        std::vector<S32> indices(NUM_TEXTURES);
+        for (S32 i = 0; i < NUM_TEXTURES; ++i)
+        {
+            indices[i] = add(index, i);
+        }
+
+        // half of the lookups miss, as for textures not yet fetched
+        std::atomic<S32> mismatches(0);
+        std::vector<std::thread> threads;
+        U32 now = (U32)time(NULL);
+        for (S32 t = 0; t < NUM_THREADS; ++t)
+        {
+            threads.emplace_back([&, t]()
+            {
+                U32 seed = 1 + t;
+                for (S32 i = 0; i < LOOKUPS_PER_THREAD; ++i)
+                {
+                    seed = seed * 1664525 + 1013904223;
+                    S32 n = (S32)((seed >> 8) % ids.size());
+                    LLTextureCacheIndex::Entry entry;
+                    S32 idx = index.find(ids[n], entry, now);
+                    bool expected = n < NUM_TEXTURES ? idx == indices[n] && entry.mImageSize == 1000 + n : idx < 0;
+                    mismatches += expected ? 0 : 1;
+                }
+            });
+        }
+        // the LRU purge reads the entries while lookups touch them
+        std::atomic<bool> done(false);
+        std::thread purge([&]()
+        {
+            std::vector<LLTextureCacheIndex::Entry> entries;
+            while (!done)
+            {
+                index.getEntries(entries);
+                mismatches += entries.size() == (size_t)NUM_TEXTURES ? 0 : 1;
+            }
+        });
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        done = true;
+        purge.join();
+        ensure_equals("lookup mismatches", mismatches.load(), 0);
+    }
+
+#if LL_LINUX || LL_DARWIN
+    template<> template<>
+    void texturecacheindex_object_t::test<4>()
+    {
+        set_test_name("recovery after being killed mid write");
+
+        const S32 MAX_ENTRIES = 100000;
+        int progress[2];
+        ensure("pipe", pipe(progress) == 0);
+
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(progress[0]);
+            LLTextureCacheIndex index;
+            open(index, MAX_ENTRIES);
+            for (S32 i = 0; i < MAX_ENTRIES; ++i)
+            {
+                add(index, i);
+                S32 done = i + 1;
+                if (write(progress[1], &done, sizeof(done)) != sizeof(done))
+                {
+                    _exit(1);
+                }
+            }
+            for (;;)
+            {
+                pause();
+            }
+        }
+        close(progress[1]);
+        ensure("fork", pid > 0);
+
+        // let it get well into the journal, then kill it
+        S32 committed = 0;
+        while (committed < 20000 && read(progress[0], &committed, sizeof(committed)) == sizeof(committed))
+        {
+        }
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+        S32 done;
+        while (read(progress[0], &done, sizeof(done)) == sizeof(done))
+        {
+            committed = done;
+        }
+        close(progress[0]);
+        ensure("child made progress", committed >= 20000);
+        committed = llmin(committed, MAX_ENTRIES);
+
+        // and as if it died half way through appending a record
+        LLFILE* journal = LLFile::fopen(mJournalFileName, "ab");
+        ensure("journal", journal != NULL);
+        const U8 torn[17] = { 0x4a, 0x52, 0x4e, 0x4c, 0x01 };
+        fwrite(torn, sizeof(torn), 1, journal);
+        fclose(journal);
+
+        LLTextureCacheIndex index;
+        ensure_equals("recovered", open(index, MAX_ENTRIES), LLTextureCacheIndex::OPEN_RECOVERED);
+        for (S32 i = 0; i < committed; ++i)
+        {
+            LLTextureCacheIndex::Entry entry;
+            S32 idx = index.find(texture_id(i), entry);
+            ensure("committed entry kept", idx >= 0);
+            ensure_equals("committed entry intact", entry.mImageSize, 1000 + i);
+        }
+        // and it is clean again after a normal close
+        index.close();
+        ensure_equals("clean", open(index, MAX_ENTRIES), LLTextureCacheIndex::OPEN_LOADED);
+    }
+#endif
+}
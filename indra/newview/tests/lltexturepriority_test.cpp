@@ -0,0 +1,211 @@
+/**
+ * @file lltexturepriority_test.cpp
+ * @brief LLTexturePriorityBatch tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lltexturepriority.h"
+
+#include "llmath.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+#include "../test/lltut.h"
+
+namespace
+{
+    // stands in for the LLFace and LLTextureEntry state the priority pass reads
+    struct TestFace
+    {
+        F32 mPixelArea;
+        F32 mImportance;
+        bool mInFrustum;
+        std::unique_ptr<F32[]> mScale; // S and T, held apart like a texture entry
+    };
+
+    struct TestScene
+    {
+        std::vector<std::unique_ptr<TestFace> > mFaces;
+        std::vector<std::vector<TestFace*> > mTextures;
+        std::vector<F32> mBias;
+    };
+
+    // faces are allocated in random order and shared by up to four
+    // textures, with a few textures used very widely
+    TestScene make_scene(U32 num_faces, U32 num_textures, U32 seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<F32> area(0.f, 512.f * 512.f);
+        std::uniform_real_distribution<F32> unit(0.f, 1.f);
+        std::uniform_real_distribution<F32> scale(-8.f, 8.f);
+
+        TestScene scene;
+        for (U32 i = 0; i < num_faces; ++i)
+        {
+            std::unique_ptr<TestFace> face(new TestFace);
+            face->mPixelArea = unit(rng) < 0.1f ? 0.f : area(rng);
+            face->mImportance = unit(rng);
+            face->mInFrustum = unit(rng) < 0.6f;
+            face->mScale.reset(new F32[2]);
+            face->mScale[0] = scale(rng);
+            face->mScale[1] = scale(rng);
+            scene.mFaces.push_back(std::move(face));
+        }
+        std::shuffle(scene.mFaces.begin(), scene.mFaces.end(), rng);
+
+        scene.mTextures.resize(num_textures);
+        for (U32 i = 0; i < num_faces; ++i)
+        {
+            U32 uses = 1 + rng() % 4;
+            for (U32 u = 0; u < uses; ++u)
+            {
+                // squaring favours low indices, those are the widely used ones
+                F32 r = unit(rng);
+                scene.mTextures[U32(r * r * num_textures) % num_textures].push_back(scene.mFaces[i].get());
+            }
+        }
+        for (U32 t = 0; t < num_textures; ++t)
+        {
+            scene.mBias.push_back((F32)(1 << (2 * (rng() % 3))));
+        }
+        return scene;
+    }
+
+    void gather(const TestScene& scene, LLTexturePriorityBatch& batch)
+    {
+        batch.clear();
+        for (size_t t = 0; t < scene.mTextures.size(); ++t)
+        {
+            batch.addTexture(scene.mBias[t]);
+            for (const TestFace* face : scene.mTextures[t])
+            {
+                batch.addFace(face->mPixelArea, llmin(fabsf(face->mScale[0]), fabsf(face->mScale[1])),
+                              face->mImportance, face->mInFrustum);
+            }
+        }
+    }
+
+    // the per face loop LLViewerTextureList used before batching
+    F32 face_loop(const std::vector<TestFace*>& faces, F32 bias, const LLTexturePriorityBatch::Params& params, bool& on_screen)
+    {
+        F32 max_vsize = 0.f;
+        on_screen = false;
+        for (const TestFace* face : faces)
+        {
+            F32 vsize = face->mPixelArea;
+            on_screen |= face->mInFrustum;
+            F32 min_scale = llmin(fabsf(face->mScale[0]), fabsf(face->mScale[1]));
+            min_scale = llclamp(min_scale * min_scale, params.mMinScaleArea, params.mMaxScaleArea);
+            vsize /= min_scale;
+            if (!face->mInFrustum || params.mDesiredDiscardBias > 1.9f + face->mImportance / 2.f)
+            {
+                vsize /= bias;
+            }
+            if (face->mInFrustum)
+            {
+                vsize *= llmax(face->mImportance * params.mCameraBoost, 1.f);
+            }
+            max_vsize = llmax(max_vsize, vsize);
+        }
+        return max_vsize;
+    }
+
+    const F32 DISCARD_BIASES[] = { 0.f, 1.f, 2.f, 3.5f, 5.f };
+}
+
+namespace tut
+{
+    struct texturepriority
+    {
+        ~texturepriority()
+        {
+            LLTexturePriorityBatch::setUseVectorKernel(true);
+        }
+    };
+    typedef test_group<texturepriority> texturepriority_t;
+    typedef texturepriority_t::object texturepriority_object_t;
+    tut::texturepriority_t tut_texturepriority("LLTexturePriorityBatch");
+
+    template<> template<>
+    void texturepriority_object_t::test<1>()
+    {
+        set_test_name("batch matches the per face loop");
+        TestScene scene = make_scene(2000, 500, 1);
+        // a texture with no faces and one with fewer faces than a vector
+        scene.mTextures[7].clear();
+        scene.mTextures[8].resize(std::min<size_t>(scene.mTextures[8].size(), 3));
+
+        LLTexturePriorityBatch batch;
+        for (F32 discard_bias : DISCARD_BIASES)
+        {
+            LLTexturePriorityBatch::Params params;
+            params.mDesiredDiscardBias = discard_bias;
+            for (bool vector : { false, true })
+            {
+                LLTexturePriorityBatch::setUseVectorKernel(vector);
+                gather(scene, batch);
+                batch.compute(params);
+                ensure_equals("textures", batch.getNumTextures(), (U32)scene.mTextures.size());
+                for (U32 t = 0; t < batch.getNumTextures(); ++t)
+                {
+                    bool on_screen;
+                    F32 expected = face_loop(scene.mTextures[t], scene.mBias[t], params, on_screen);
+                    std::string name = llformat("texture %u, bias %.1f%s", t, discard_bias, vector ? ", vector" : "");
+                    ensure_equals(name + " vsize", batch.getMaxVirtualSize(t), expected);
+                    ensure_equals(name + " on screen", batch.isOnScreen(t), on_screen);
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void texturepriority_object_t::test<2>()
+    {
+        set_test_name("pooled pass matches serial pass");
+        TestScene scene = make_scene(20000, 5000, 2);
+        LLTexturePriorityBatch::Params params;
+        params.mDesiredDiscardBias = 2.f;
+
+        LLTexturePriorityBatch serial;
+        gather(scene, serial);
+        serial.compute(params);
+
+        LL::ThreadPool pool("texture priority test", 3);
+        pool.start();
+        LLTexturePriorityBatch pooled;
+        gather(scene, pooled);
+        pooled.compute(params, &pool);
+        pool.close();
+
+        for (U32 t = 0; t < serial.getNumTextures(); ++t)
+        {
+            ensure_equals(llformat("texture %u vsize", t), pooled.getMaxVirtualSize(t), serial.getMaxVirtualSize(t));
+            ensure_equals(llformat("texture %u on screen", t), pooled.isOnScreen(t), serial.isOnScreen(t));
+        }
+    }
+}
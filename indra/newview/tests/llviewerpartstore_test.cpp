@@ -0,0 +1,326 @@
+/**
+ * @file llviewerpartstore_test.cpp
+ * @brief Tests for the flat particle store
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llviewerpartstore.h"
+
+#include "llmath.h"
+#include "llpartdata.h"
+
+#include <memory>
+#include <random>
+
+#include "../test/lltut.h"
+
+namespace
+{
+    // Flag combinations of the particle systems in the wild that the store
+    // simulates by itself: plain sprites, fades, puffs, sparks, emissive
+    // club lights and ribbons.
+    const U32 FLAG_COMBINATIONS[] =
+    {
+        0,
+        LLPartData::LL_PART_INTERP_COLOR_MASK,
+        LLPartData::LL_PART_INTERP_SCALE_MASK,
+        LLPartData::LL_PART_INTERP_COLOR_MASK | LLPartData::LL_PART_INTERP_SCALE_MASK,
+        LLPartData::LL_PART_INTERP_COLOR_MASK | LLPartData::LL_PART_INTERP_SCALE_MASK | LLPartData::LL_PART_EMISSIVE_MASK,
+        LLPartData::LL_PART_INTERP_COLOR_MASK | LLPartData::LL_PART_FOLLOW_VELOCITY_MASK,
+        LLPartData::LL_PART_INTERP_SCALE_MASK | LLPartData::LL_PART_EMISSIVE_MASK | LLPartData::LL_PART_DATA_GLOW,
+        LLPartData::LL_PART_INTERP_COLOR_MASK | LLPartData::LL_PART_RIBBON_MASK | LLPartData::LL_PART_DATA_BLEND,
+    };
+
+    // stands in for LLViewerPart, heap allocated as the viewer does
+    struct TestPart : public LLPartData
+    {
+        F32 mLastUpdateTime = 0.f;
+        F32 mSkipOffset = 0.f;
+        LLVector3 mPosAgent;
+        LLVector3 mVelocity;
+        LLVector3 mAccel;
+        LLColor4 mColor;
+        LLVector2 mScale;
+        F32 mStartGlow = 0.f;
+        F32 mEndGlow = 0.f;
+        U8 mGlow = 0;
+    };
+
+    std::vector<std::unique_ptr<TestPart> > make_parts(U32 count, U32 seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<F32> unit(0.f, 1.f);
+        std::uniform_real_distribution<F32> spread(-1.f, 1.f);
+
+        std::vector<std::unique_ptr<TestPart> > parts;
+        for (U32 i = 0; i < count; ++i)
+        {
+            std::unique_ptr<TestPart> part(new TestPart);
+            part->mFlags = FLAG_COMBINATIONS[rng() % LL_ARRAY_SIZE(FLAG_COMBINATIONS)];
+            part->mMaxAge = 0.5f + 10.f * unit(rng);
+            part->mStartColor.setVec(unit(rng), unit(rng), unit(rng), unit(rng));
+            part->mEndColor.setVec(unit(rng), unit(rng), unit(rng), unit(rng));
+            part->mStartScale.setVec(0.05f + unit(rng), 0.05f + unit(rng));
+            part->mEndScale.setVec(0.05f + 2.f * unit(rng), 0.05f + 2.f * unit(rng));
+            // glows come in 1/255 steps
+            part->mStartGlow = (F32)(rng() % 256) / 255.f;
+            part->mEndGlow = (rng() % 2) ? 0.f : (F32)(rng() % 256) / 255.f;
+
+            part->mPosAgent.setVec(8.f * spread(rng), 8.f * spread(rng), 8.f * spread(rng));
+            part->mVelocity.setVec(2.f * spread(rng), 2.f * spread(rng), 4.f * unit(rng));
+            part->mAccel.setVec(0.f, 0.5f * spread(rng), -9.8f * unit(rng));
+            part->mColor = part->mStartColor;
+            part->mScale = part->mStartScale;
+            part->mLastUpdateTime = 0.2f * unit(rng);
+            part->mSkipOffset = (rng() % 3) ? 0.f : 0.1f * unit(rng);
+            parts.push_back(std::move(part));
+        }
+        return parts;
+    }
+
+    void add_parts(const std::vector<std::unique_ptr<TestPart> >& parts, LLViewerPartStore& store)
+    {
+        store.clear();
+        for (const std::unique_ptr<TestPart>& part : parts)
+        {
+            store.add(*part, part->mStartGlow, part->mEndGlow, part->mPosAgent, part->mVelocity, part->mAccel,
+                      part->mColor, part->mScale, part->mLastUpdateTime, part->mSkipOffset);
+        }
+    }
+
+    // the per particle steps LLViewerPartGroup::updateParticles() took
+    // before the store, without those needing a source or region
+    void update_part(TestPart& part, F32 lastdt, F32 skipped_time)
+    {
+        F32 dt = lastdt + skipped_time - part.mSkipOffset;
+        part.mSkipOffset = 0.f;
+
+        const F32 cur_time = part.mLastUpdateTime + dt;
+        const F32 frac = cur_time / part.mMaxAge;
+
+        part.mPosAgent += dt*part.mVelocity;
+        part.mPosAgent += 0.5f*dt*dt*part.mAccel;
+        part.mVelocity += part.mAccel*dt;
+
+        if (part.mFlags & LLPartData::LL_PART_INTERP_COLOR_MASK)
+        {
+            part.mColor.setVec(part.mStartColor);
+            part.mColor *= 1.f - frac;
+            part.mColor %= 1.f - frac;
+            part.mColor += frac%(frac*part.mEndColor);
+        }
+
+        if (part.mFlags & LLPartData::LL_PART_INTERP_SCALE_MASK)
+        {
+            part.mScale.setVec(part.mStartScale);
+            part.mScale *= 1.f - frac;
+            part.mScale += frac*part.mEndScale;
+        }
+
+        part.mGlow = (U8) ll_round(lerp(part.mStartGlow, part.mEndGlow, frac)*255.f);
+        part.mLastUpdateTime = cur_time;
+    }
+
+    // calc_desired_size() and LLViewerPartGroup::posInGroup()
+    bool in_group(const TestPart& part, const LLViewerPartStore::Bounds& bounds)
+    {
+        F32 desired_size = (part.mPosAgent - bounds.mCameraOrigin).magVec();
+        desired_size /= 4;
+        desired_size = llclamp(desired_size, part.mScale.magVec()*0.5f, bounds.mMaxDesiredSize);
+
+        const LLVector3& pos = part.mPosAgent;
+        if (pos.mV[VX] < bounds.mMin.mV[VX] || pos.mV[VY] < bounds.mMin.mV[VY] || pos.mV[VZ] < bounds.mMin.mV[VZ]
+            || pos.mV[VX] > bounds.mMax.mV[VX] || pos.mV[VY] > bounds.mMax.mV[VY] || pos.mV[VZ] > bounds.mMax.mV[VZ])
+        {
+            return false;
+        }
+        return !(desired_size > 0 && (desired_size < bounds.mBoxRadius*0.5f || desired_size > bounds.mBoxRadius*2.f));
+    }
+
+    U8 expected_status(const TestPart& part, const LLViewerPartStore::Bounds& bounds)
+    {
+        if (part.mLastUpdateTime > part.mMaxAge || LLPartData::LL_PART_DEAD_MASK == part.mFlags)
+        {
+            return LLViewerPartStore::DEAD;
+        }
+        return in_group(part, bounds) ? LLViewerPartStore::ALIVE : LLViewerPartStore::OUTSIDE;
+    }
+
+    // a 16m group box with the camera a little way off
+    LLViewerPartStore::Bounds make_bounds(F32 box_side)
+    {
+        LLViewerPartStore::Bounds bounds;
+        bounds.mCameraOrigin.setVec(20.f, -3.f, 2.f);
+        bounds.mMin.setVec(-8.01f, -8.01f, -8.01f);
+        bounds.mMax.setVec(8.01f, 8.01f, 8.01f);
+        bounds.mBoxRadius = F_SQRT3*box_side*0.5f;
+        return bounds;
+    }
+
+    void ensure_same_part(const std::string& name, const LLViewerPartStore& store, U32 i, const TestPart& part)
+    {
+        using namespace tut;
+        ensure_equals(name + " position", store.getPosition(i), part.mPosAgent);
+        ensure_equals(name + " velocity", store.getVelocity(i), part.mVelocity);
+        ensure_equals(name + " color", store.getColor(i), part.mColor);
+        ensure_equals(name + " scale", store.getScale(i), part.mScale);
+        ensure_equals(name + " age", store.getAge(i), part.mLastUpdateTime);
+        // past their age glows extrapolate and wrap, but those particles die
+        if (part.mLastUpdateTime <= part.mMaxAge)
+        {
+            ensure(name + " glow", abs((S32)store.getGlow(i) - (S32)part.mGlow) <= 1);
+        }
+    }
+}
+
+namespace tut
+{
+    struct viewerpartstore
+    {
+        ~viewerpartstore()
+        {
+            LLViewerPartStore::setUseVectorKernel(true);
+        }
+    };
+    typedef test_group<viewerpartstore> viewerpartstore_t;
+    typedef viewerpartstore_t::object viewerpartstore_object_t;
+    tut::viewerpartstore_t tut_viewerpartstore("LLViewerPartStore");
+
+    template<> template<>
+    void viewerpartstore_object_t::test<1>()
+    {
+        set_test_name("update matches the per particle loop");
+        for (bool vector : { false, true })
+        {
+            LLViewerPartStore::setUseVectorKernel(vector);
+            // not a whole number of vectors
+            std::vector<std::unique_ptr<TestPart> > parts = make_parts(1003, 1);
+            LLViewerPartStore store;
+            add_parts(parts, store);
+            ensure_equals("count", store.getCount(), 1003U);
+
+            const F32 steps[] = { 1.f / 60.f, 0.1f, 0.f, 1.f / 15.f, 0.8f };
+            for (U32 frame = 0; frame < LL_ARRAY_SIZE(steps); ++frame)
+            {
+                // the group skipped some updates before the first
+                const F32 skipped_time = frame ? 0.f : 0.1f;
+                for (U32 i = 0; i < store.getCount(); ++i)
+                {
+                    ensure_equals("time step", store.getTimeStep(i, steps[frame], skipped_time),
+                                  steps[frame] + skipped_time - parts[i]->mSkipOffset);
+                    update_part(*parts[i], steps[frame], skipped_time);
+                }
+                store.update(steps[frame], skipped_time);
+                for (U32 i = 0; i < store.getCount(); ++i)
+                {
+                    ensure_same_part(llformat("%s frame %u particle %u", vector ? "vector" : "plain", frame, i), store, i, *parts[i]);
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void viewerpartstore_object_t::test<2>()
+    {
+        set_test_name("classify matches posInGroup");
+        for (bool vector : { false, true })
+        {
+            LLViewerPartStore::setUseVectorKernel(vector);
+            std::vector<std::unique_ptr<TestPart> > parts = make_parts(2001, 2);
+            for (U32 i = 0; i < parts.size(); ++i)
+            {
+                TestPart& part = *parts[i];
+                // some outside the box, some too large for it, a few dead
+                part.mPosAgent *= 1.25f;
+                if (i % 17 == 0)
+                {
+                    part.mScale.setVec(80.f, 90.f);
+                }
+                if (i % 23 == 0)
+                {
+                    part.mFlags = LLPartData::LL_PART_DEAD_MASK;
+                }
+                if (i % 29 == 0)
+                {
+                    part.mLastUpdateTime = part.mMaxAge + 0.01f;
+                }
+            }
+            LLViewerPartStore store;
+            add_parts(parts, store);
+
+            U32 counts[3] = { 0, 0, 0 };
+            for (F32 box_side : { 4.f, 16.f, 40.f })
+            {
+                const LLViewerPartStore::Bounds bounds = make_bounds(box_side);
+                std::vector<U8> status;
+                store.classify(bounds, status);
+                ensure_equals("statuses", status.size(), parts.size());
+                for (U32 i = 0; i < parts.size(); ++i)
+                {
+                    ensure_equals(llformat("%s box %.0f particle %u", vector ? "vector" : "plain", box_side, i),
+                                  (S32)status[i], (S32)expected_status(*parts[i], bounds));
+                    counts[status[i]]++;
+                }
+            }
+            ensure("all kinds", counts[LLViewerPartStore::ALIVE] && counts[LLViewerPartStore::DEAD] && counts[LLViewerPartStore::OUTSIDE]);
+        }
+    }
+
+    template<> template<>
+    void viewerpartstore_object_t::test<3>()
+    {
+        set_test_name("compact keeps the survivors in order");
+        std::vector<std::unique_ptr<TestPart> > parts = make_parts(997, 3);
+        LLViewerPartStore store;
+        add_parts(parts, store);
+        for (U32 frame = 0; frame < 40; ++frame)
+        {
+            const LLViewerPartStore::Bounds bounds = make_bounds(16.f);
+            store.update(0.25f, 0.f);
+            std::vector<U8> status;
+            store.classify(bounds, status);
+
+            std::vector<std::unique_ptr<TestPart> > survivors;
+            for (U32 i = 0; i < parts.size(); ++i)
+            {
+                update_part(*parts[i], 0.25f, 0.f);
+                if (status[i] == LLViewerPartStore::ALIVE)
+                {
+                    survivors.push_back(std::move(parts[i]));
+                }
+            }
+            parts.swap(survivors);
+            store.compact(status);
+
+            ensure_equals(llformat("frame %u count", frame), store.getCount(), (U32)parts.size());
+            for (U32 i = 0; i < parts.size(); ++i)
+            {
+                ensure_same_part(llformat("frame %u particle %u", frame, i), store, i, *parts[i]);
+                ensure_equals("flags", store.getFlags(i), parts[i]->mFlags);
+            }
+        }
+        ensure("everything died", store.getCount() == 0);
+    }
+}
@@ -35,6 +35,7 @@
 #include "llregionhandle.h"
 #include "llsdutil.h"
 #include "llsdserialize.h"
+#include "llrand.h"
 
 #include "../llviewerobjectlist.h"
 #include "../llviewerregion.h"
@@ -44,7 +45,45 @@
 
 namespace
 {
+    // Objects with random bodies, as a region would cache them
+    void make_entries(U32 num_objects, LLVOCacheEntry::vocache_entry_map_t& entries)
+    {
+        U8 body[512];
+        for (U32 local_id = 1; local_id <= num_objects; ++local_id)
+        {
+            S32 size = 128 + ll_rand(384);
+            for (S32 i = 0; i < size; ++i)
+            {
+                body[i] = (U8)ll_rand(256);
+            }
+            LLDataPackerBinaryBuffer dp(body, size);
+            entries[local_id] = new LLVOCacheEntry(local_id, local_id * 7919, dp);
+        }
+    }
 
+    bool same_entry(LLVOCacheEntry* expected, LLVOCacheEntry* entry)
+    {
+        LLDataPackerBinaryBuffer* expected_dp = expected->getDP();
+        LLDataPackerBinaryBuffer* dp = entry->getDP();
+        return entry->getLocalID() == expected->getLocalID()
+            && entry->getCRC() == expected->getCRC()
+            && entry->getHitCount() == expected->getHitCount()
+            && entry->getCRCChangeCount() == expected->getCRCChangeCount()
+            && expected_dp && dp
+            && dp->getBufferSize() == expected_dp->getBufferSize()
+            && memcmp(dp->getBuffer(), expected_dp->getBuffer(), dp->getBufferSize()) == 0;
+    }
+
+    void ensure_same_entries(const LLVOCacheEntry::vocache_entry_map_t& expected, const LLVOCacheEntry::vocache_entry_map_t& entries)
+    {
+        tut::ensure_equals("object count", entries.size(), expected.size());
+        for (const auto& pair : expected)
+        {
+            LLVOCacheEntry::vocache_entry_map_t::const_iterator iter = entries.find(pair.first);
+            tut::ensure("object " + std::to_string(pair.first) + " cached", iter != entries.end());
+            tut::ensure("object " + std::to_string(pair.first) + " contents", same_entry(pair.second, iter->second));
+        }
+    }
 }
 
 
@@ -144,4 +183,73 @@ namespace tut
 
         LLVOCache::instance().readGenericExtrasFromCache(region_handle, region_id, extras);
     }
+
+    template<> template<>
+    void vocacheTestObject::test<3>()
+    {
+        // A region read back from either format, one file per region or the mapped pack.
+        const U32 NUM_OBJECTS = 1500;
+
+        U64 region_handle = to_region_handle(256000, 256000);
+        LLUUID region_id = LLUUID::generateNewID();
+
+        LLVOCacheEntry::vocache_entry_map_t entries;
+        make_entries(NUM_OBJECTS, entries);
+
+        for (bool use_pack : { false, true })
+        {
+            LLVOCache::deleteSingleton();
+            LLVOCache& cache = LLVOCache::initParamSingleton(false);
+            cache.setPackFormat(use_pack);
+            cache.initCache(LL_PATH_CACHE, 128, 15);
+            cache.writeToCache(region_handle, region_id, entries, true, false);
+
+            LLVOCacheEntry::vocache_entry_map_t loaded;
+            ensure("read region from cache", cache.readFromCache(region_handle, region_id, loaded));
+            ensure_same_entries(entries, loaded);
+        }
+    }
+
+    template<> template<>
+    void vocacheTestObject::test<4>()
+    {
+        // Pack entries are created when looked up, the others are written back as they were.
+        const U32 NUM_OBJECTS = 200;
+
+        U64 region_handle = to_region_handle(256256, 256000);
+        LLUUID region_id = LLUUID::generateNewID();
+
+        LLVOCacheEntry::vocache_entry_map_t entries;
+        make_entries(NUM_OBJECTS, entries);
+
+        LLVOCache::deleteSingleton();
+        LLVOCache& cache = LLVOCache::initParamSingleton(false);
+        cache.setPackFormat(true);
+        cache.initCache(LL_PATH_CACHE, 128, 15);
+        cache.writeToCache(region_handle, region_id, entries, true, false);
+
+        LLVOCacheEntry::vocache_entry_map_t loaded;
+        LLVOCachePackEntries pack_entries;
+        ensure("read region from cache", cache.readFromCache(region_handle, region_id, loaded, &pack_entries));
+        ensure("no object created on load", loaded.empty());
+        ensure_equals("objects left in the pack", pack_entries.size(), entries.size());
+
+        for (U32 local_id = 1; local_id <= NUM_OBJECTS; local_id += 2)
+        {
+            LLPointer<LLVOCacheEntry> entry = pack_entries.take(local_id);
+            ensure("object " + std::to_string(local_id) + " looked up", entry.notNull());
+            ensure("object " + std::to_string(local_id) + " contents", same_entry(entries[local_id], entry));
+            loaded[local_id] = entry;
+        }
+        ensure("object taken once", pack_entries.take(1).isNull());
+        ensure("unknown object", pack_entries.take(NUM_OBJECTS + 1).isNull());
+        ensure_equals("objects not looked up", pack_entries.size(), (size_t)NUM_OBJECTS / 2);
+
+        cache.writeToCache(region_handle, region_id, loaded, true, false, &pack_entries);
+        pack_entries.clear();
+
+        LLVOCacheEntry::vocache_entry_map_t reloaded;
+        ensure("read region again", cache.readFromCache(region_handle, region_id, reloaded));
+        ensure_same_entries(entries, reloaded);
+    }
 }